@@ -2144,6 +2144,18 @@ public:
     CV_WRAP virtual int getMode() const = 0;
     CV_WRAP virtual void setMode(int mode) = 0;
 
+    /** @brief Per-band memory budget in bytes, 0 (the default) disables banding.
+
+    When it is positive, MODE_SGBM, MODE_HH and MODE_HH4 split the image into overlapping horizontal
+    bands that are processed in parallel, each with its own buffers of about this size. MODE_HH and
+    MODE_HH4 keep the cost volume of a band only, so the peak memory is roughly the budget times the
+    number of threads instead of O(W\*H\*numDisparities). Paths are cut at the band borders, so the
+    result is close to, but not bit-exact with, the non-banded one. MODE_SGBM_3WAY is always
+    processed in stripes and ignores this setting.
+     */
+    CV_WRAP virtual size_t getBandMemoryLimit() const = 0;
+    CV_WRAP virtual void setBandMemoryLimit(size_t bandMemoryLimit) = 0;
+
     /** @brief Creates StereoSGBM object
 
     @param minDisparity Minimum possible disparity value. Normally, it is zero but sometimes
@@ -2188,6 +2200,122 @@ public:
                                           int mode = StereoSGBM::MODE_SGBM);
 };
 
+/** @brief Rectifies frames of calibrated stereo rigs and computes their disparity with StereoBM.
+
+For every rig added with addRig() the class runs stereoRectify() once and caches the CV_16SC2 + CV_16UC1
+fixed-point maps of initUndistortRectifyMap(). compute() then rectifies the left and the right frames
+concurrently, in row stripes, and applies the StereoBM prefilter to each stripe right after it is
+remapped, so the rectified images are not written out and read back between the two steps. The
+result is the same as remap() with the cached maps followed by StereoBM::compute().
+ */
+class CV_EXPORTS_W StereoBMPipeline : public Algorithm
+{
+public:
+    /** @brief Adds a calibrated stereo rig and precomputes its rectification maps.
+
+    The parameters are the same as in stereoRectify(). The valid pixel ROIs of the rectified images
+    are passed to the matcher (StereoBM::setROI1, StereoBM::setROI2) when the rig is processed.
+    @return index of the rig to pass to compute()
+     */
+    CV_WRAP virtual int addRig( InputArray cameraMatrix1, InputArray distCoeffs1,
+                                InputArray cameraMatrix2, InputArray distCoeffs2,
+                                Size imageSize, InputArray R, InputArray T,
+                                int flags = CALIB_ZERO_DISPARITY, double alpha = -1 ) = 0;
+
+    CV_WRAP virtual int getRigCount() const = 0;
+
+    /** @brief Returns the output of stereoRectify() for the rig (see stereoRectify for the details). */
+    CV_WRAP virtual void getRectification( int rig, OutputArray R1, OutputArray R2,
+                                           OutputArray P1, OutputArray P2, OutputArray Q ) const = 0;
+
+    /** @brief Rectifies a pair of CV_8UC1 frames of the rig and computes the disparity.
+
+    @param rig index returned by addRig().
+    @param left left frame, its size must be the imageSize of the rig.
+    @param right right frame of the same size.
+    @param disparity output disparity map, see StereoMatcher::compute.
+    @param rectifiedLeft optional output rectified left frame.
+    @param rectifiedRight optional output rectified right frame.
+     */
+    CV_WRAP virtual void compute( int rig, InputArray left, InputArray right, OutputArray disparity,
+                                  OutputArray rectifiedLeft = noArray(),
+                                  OutputArray rectifiedRight = noArray() ) = 0;
+
+    /** @brief Returns the matcher used by compute(); its parameters can be changed at any time. */
+    CV_WRAP virtual Ptr<StereoBM> getMatcher() const = 0;
+
+    /** @brief Creates the pipeline.
+
+    @param matcher StereoBM instance to compute the disparity with. If it is empty, StereoBM::create()
+    with the default parameters is used.
+     */
+    CV_WRAP static Ptr<StereoBMPipeline> create( const Ptr<StereoBM>& matcher = Ptr<StereoBM>() );
+};
+
+/** @brief Levenberg-Marquardt solver for least-squares problems with block-sparse Jacobians.
+
+The parameter vector is split into blocks (addParamBlock) and the residuals are split into blocks too
+(addResidualBlock). Every residual block depends on a few parameter blocks only: a view of a calibration
+pattern depends on the intrinsics and on the pose of the view, a matched image pair of a panorama depends
+on its two cameras. The residual blocks and their Jacobians are evaluated in parallel and the normal
+equations are accumulated block by block, so neither the Jacobian nor \f$J^T J\f$ is stored densely.
+
+Parameter blocks added with eliminate=true (per-view poses, 3D points) are removed from the normal
+equations with the Schur complement; each residual block may depend on at most one of them. The reduced
+system is solved with the dense decomposition set by setDecompositionType() when it is small, and with
+the block-Jacobi preconditioned conjugate gradient method otherwise.
+
+The damping (\f$J^T J\f$ diagonal multiplied by \f$1+\lambda\f$), the update of \f$\lambda\f$ and the
+termination rules are the same as in CvLevMarq.
+ */
+class CV_EXPORTS SparseLMSolver : public Algorithm
+{
+public:
+    class CV_EXPORTS Callback
+    {
+    public:
+        virtual ~Callback() {}
+        /** @brief Computes the residuals of one residual block.
+
+        @param block index of the residual block.
+        @param param the whole parameter vector, CV_64FC1 column.
+        @param err output CV_64FC1 column of the block residuals.
+        @param J if J.needed(), the output CV_64FC1 derivatives of err with respect to the parameter
+        blocks of the residual block: one column per parameter, the blocks go in the order they were
+        passed to addResidualBlock().
+        @return false to stop the optimization.
+
+        The method is called concurrently for different blocks.
+         */
+        virtual bool compute(int block, InputArray param, OutputArray err, OutputArray J) const = 0;
+    };
+
+    /** @brief Adds a parameter block and returns its index.
+
+    The blocks are laid out in the parameter vector one after another in the order they are added.
+     */
+    virtual int addParamBlock(int size, bool eliminate = false) = 0;
+
+    /** @brief Adds a block of nerrs residuals depending on the given parameter blocks and returns its index. */
+    virtual int addResidualBlock(int nerrs, const std::vector<int>& paramBlocks) = 0;
+
+    /** @brief Sets the CV_8UC1 mask of the parameters to optimize, the parameters with zero mask are fixed. */
+    virtual void setParamMask(InputArray mask) = 0;
+
+    /** @brief Sets the method (cv::DecompTypes) to solve the reduced normal equations with when they are
+    solved directly, DECOMP_SVD by default. */
+    virtual void setDecompositionType(int method) = 0;
+
+    /** @brief Runs the optimization starting from param, a CV_64FC1 vector.
+
+    @return the number of iterations done or -1 if the callback failed.
+     */
+    virtual int run(InputOutputArray param) const = 0;
+
+    static Ptr<SparseLMSolver> create(const Ptr<Callback>& cb,
+                                      const TermCriteria& criteria = TermCriteria(TermCriteria::COUNT + TermCriteria::EPS, 30, DBL_EPSILON));
+};
+
 //! @} calib3d
 
 /** @brief The methods in this namespace use a so-called fisheye camera model.
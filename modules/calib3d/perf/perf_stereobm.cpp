@@ -0,0 +1,62 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+#include "perf_precomp.hpp"
+#include "opencv2/imgproc.hpp"
+
+namespace opencv_test
+{
+using namespace perf;
+
+typedef tuple<Size, bool> Size_Pipeline_t;
+typedef perf::TestBaseWithParam<Size_Pipeline_t> Size_Pipeline;
+
+// rectification + StereoBM of a calibrated pair: StereoBMPipeline with cached fixed-point maps
+// vs. the float maps, remap() and StereoBM::compute() done separately for every frame
+PERF_TEST_P(Size_Pipeline, StereoBM_rectified,
+            testing::Combine(testing::Values(szVGA, sz1080p), testing::Bool()))
+{
+    Size sz = get<0>(GetParam());
+    bool usePipeline = get<1>(GetParam());
+
+    RNG& rng = theRNG();
+    Mat tex(sz.height, sz.width + 32, CV_8U);
+    rng.fill(tex, RNG::UNIFORM, 0, 256);
+    GaussianBlur(tex, tex, Size(3, 3), 0);
+    Mat left = tex.colRange(0, sz.width), right = tex.colRange(16, sz.width + 16);
+
+    double f = sz.width*0.8;
+    Mat K = (Mat_<double>(3, 3) << f, 0, sz.width*0.5, 0, f, sz.height*0.5, 0, 0, 1);
+    Mat D = (Mat_<double>(1, 5) << 0.05, -0.02, 0, 0, 0);
+    Mat R, T = (Mat_<double>(3, 1) << -0.1, 0.002, 0.001);
+    cv::Rodrigues(Vec3d(0.01, -0.02, 0.005), R);
+
+    Ptr<StereoBM> bm = StereoBM::create(64, 15);
+    Ptr<StereoBMPipeline> pipeline = StereoBMPipeline::create(bm);
+    int rig = pipeline->addRig(K, D, K, D, sz, R, T);
+    Mat R1, R2, P1, P2, Q;
+    pipeline->getRectification(rig, R1, R2, P1, P2, Q);
+
+    Mat disp, map1, map2, rectLeft, rectRight;
+    declare.in(left, right);
+
+    if (usePipeline)
+    {
+        TEST_CYCLE() pipeline->compute(rig, left, right, disp);
+    }
+    else
+    {
+        TEST_CYCLE()
+        {
+            initUndistortRectifyMap(K, D, R1, P1, sz, CV_32FC1, map1, map2);
+            remap(left, rectLeft, map1, map2, INTER_LINEAR);
+            initUndistortRectifyMap(K, D, R2, P2, sz, CV_32FC1, map1, map2);
+            remap(right, rectRight, map1, map2, INTER_LINEAR);
+            bm->compute(rectLeft, rectRight, disp);
+        }
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+} // namespace
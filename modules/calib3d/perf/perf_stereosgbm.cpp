@@ -78,6 +78,39 @@ PERF_TEST_P( TestStereoCorresp, DISABLED_TooLongInDebug_SGBM, Combine(Values(Siz
     SANITY_CHECK(dst, .01, ERROR_RELATIVE);
 }
 
+CV_ENUM(SGBMBandedModes, StereoSGBM::MODE_SGBM, StereoSGBM::MODE_HH, StereoSGBM::MODE_HH4);
+typedef tuple<Size, int, SGBMBandedModes> SGBMBandedParams;
+typedef TestBaseWithParam<SGBMBandedParams> TestStereoCorrespBanded;
+
+#ifndef _DEBUG
+PERF_TEST_P( TestStereoCorrespBanded, SGBM_banded, Combine(Values(Size(1920,1080)), Values(256), SGBMBandedModes::all()) )
+#else
+PERF_TEST_P( TestStereoCorrespBanded, DISABLED_TooLongInDebug_SGBM_banded, Combine(Values(Size(1920,1080)), Values(256), SGBMBandedModes::all()) )
+#endif
+{
+    RNG rng(0);
+
+    SGBMBandedParams params = GetParam();
+
+    Size sz              = get<0>(params);
+    int num_disparities  = get<1>(params);
+    int mode             = get<2>(params);
+
+    Mat src_left(sz, CV_8UC3);
+    Mat src_right(sz, CV_8UC3);
+    Mat dst(sz, CV_16S);
+
+    MakeArtificialExample(rng,src_left,src_right);
+
+    int wsize = 3;
+    int P1 = 8*src_left.channels()*wsize*wsize;
+    Ptr<StereoSGBM> sgbm = StereoSGBM::create(0,num_disparities,wsize,P1,4*P1,1,63,25,0,0,mode);
+    sgbm->setBandMemoryLimit((size_t)64 << 20);
+    TEST_CYCLE() sgbm->compute(src_left,src_right,dst);
+
+    SANITY_CHECK_NOTHING();
+}
+
 void MakeArtificialExample(RNG rng, Mat& dst_left_view, Mat& dst_right_view)
 {
     int w = dst_left_view.cols;
@@ -1294,6 +1294,72 @@ static void subMatrix(const cv::Mat& src, cv::Mat& dst, const std::vector<uchar>
     }
 }
 
+/* Reprojection errors of one view of the calibration pattern for SparseLMSolver:
+   the parameter blocks are the NINTRINSIC intrinsics and the 6 extrinsics of the view */
+class CalibViewCallback CV_FINAL : public SparseLMSolver::Callback
+{
+public:
+    CalibViewCallback( const Mat& _objectPoints, const Mat& _imagePoints, const CvMat* npoints,
+                       int _flags, double _aspectRatio )
+        : objectPoints(_objectPoints), imagePoints(_imagePoints), flags(_flags), aspectRatio(_aspectRatio)
+    {
+        int nimages = npoints->rows*npoints->cols;
+        int npstep = npoints->rows == 1 ? 1 : npoints->step/CV_ELEM_SIZE(npoints->type);
+        viewOfs.resize(nimages + 1, 0);
+        for( int i = 0; i < nimages; i++ )
+            viewOfs[i + 1] = viewOfs[i] + npoints->data.i[i*npstep];
+    }
+
+    bool compute( int view, InputArray _param, OutputArray _err, OutputArray _J ) const CV_OVERRIDE
+    {
+        const int NINTRINSIC = CV_CALIB_NINTRINSIC;
+        const double* param = _param.getMat().ptr<double>();
+        int pos = viewOfs[view], ni = viewOfs[view + 1] - pos;
+
+        Matx33d A( param[0], 0, param[2], 0, param[1], param[3], 0, 0, 1 );
+        if( flags & CALIB_FIX_ASPECT_RATIO )
+            A(0, 0) = param[1]*aspectRatio;
+        double k[14];
+        std::copy(param + 4, param + 4 + 14, k);
+        Matx31d r( param + NINTRINSIC + view*6 ), t( param + NINTRINSIC + view*6 + 3 );
+
+        CvMat matA = cvMat(3, 3, CV_64F, A.val), _k = cvMat(14, 1, CV_64F, k);
+        CvMat _ri = cvMat(3, 1, CV_64F, r.val), _ti = cvMat(3, 1, CV_64F, t.val);
+        CvMat _Mi(objectPoints.colRange(pos, pos + ni));
+        CvMat _mi(imagePoints.colRange(pos, pos + ni));
+
+        _err.create(ni*2, 1, CV_64F);
+        Mat err = _err.getMat();
+        CvMat _mp(err.reshape(2, 1));
+
+        if( _J.needed() )
+        {
+            _J.create(ni*2, NINTRINSIC + 6, CV_64F);
+            Mat J = _J.getMat();
+            J.setTo(Scalar::all(0));
+            CvMat _dpdf(J.colRange(0, 2));
+            CvMat _dpdc(J.colRange(2, 4));
+            CvMat _dpdk(J.colRange(4, NINTRINSIC));
+            CvMat _dpdr(J.colRange(NINTRINSIC, NINTRINSIC + 3));
+            CvMat _dpdt(J.colRange(NINTRINSIC + 3, NINTRINSIC + 6));
+            cvProjectPoints2( &_Mi, &_ri, &_ti, &matA, &_k, &_mp, &_dpdr, &_dpdt,
+                              (flags & CALIB_FIX_FOCAL_LENGTH) ? 0 : &_dpdf,
+                              (flags & CALIB_FIX_PRINCIPAL_POINT) ? 0 : &_dpdc, &_dpdk,
+                              (flags & CALIB_FIX_ASPECT_RATIO) ? aspectRatio : 0);
+        }
+        else
+            cvProjectPoints2( &_Mi, &_ri, &_ti, &matA, &_k, &_mp );
+
+        cvSub( &_mp, &_mi, &_mp );
+        return true;
+    }
+
+    Mat objectPoints, imagePoints;
+    std::vector<int> viewOfs;
+    int flags;
+    double aspectRatio;
+};
+
 static double cvCalibrateCamera2Internal( const CvMat* objectPoints,
                     const CvMat* imagePoints, const CvMat* npoints,
                     CvSize imageSize, CvMat* cameraMatrix, CvMat* distCoeffs,
@@ -1432,7 +1498,7 @@ static double cvCalibrateCamera2Internal( const CvMat* objectPoints,
     const double minValidAspectRatio = 0.01;
     const double maxValidAspectRatio = 100.0;
 
-    // 1. initialize intrinsic parameters & LM solver
+    // 1. initialize intrinsic parameters & the parameter mask
     if( flags & CALIB_USE_INTRINSIC_GUESS )
     {
         cvConvert( cameraMatrix, &matA );
@@ -1482,18 +1548,12 @@ static double cvCalibrateCamera2Internal( const CvMat* objectPoints,
         cvInitIntrinsicParams2D( &_matM, &m, npoints, imageSize, &matA, aspectRatio );
     }
 
-    CvLevMarq solver( nparams, 0, termCrit );
-
-    if(flags & CALIB_USE_LU) {
-        solver.solveMethod = DECOMP_LU;
-    }
-    else if(flags & CALIB_USE_QR) {
-        solver.solveMethod = DECOMP_QR;
-    }
+    Mat _param( nparams, 1, CV_64F, Scalar(0) ), _mask( nparams, 1, CV_8U, Scalar(1) );
+    CvMat matParam(_param);
 
     {
-    double* param = solver.param->data.db;
-    uchar* mask = solver.mask->data.ptr;
+    double* param = _param.ptr<double>();
+    uchar* mask = _mask.ptr();
 
     param[0] = A(0, 0); param[1] = A(1, 1); param[2] = A(0, 2); param[3] = A(1, 2);
     std::copy(k, k + 14, param + 4);
@@ -1547,8 +1607,8 @@ static double cvCalibrateCamera2Internal( const CvMat* objectPoints,
         CvMat _ri, _ti;
         ni = npoints->data.i[i*npstep];
 
-        cvGetRows( solver.param, &_ri, NINTRINSIC + i*6, NINTRINSIC + i*6 + 3 );
-        cvGetRows( solver.param, &_ti, NINTRINSIC + i*6 + 3, NINTRINSIC + i*6 + 6 );
+        cvGetRows( &matParam, &_ri, NINTRINSIC + i*6, NINTRINSIC + i*6 + 3 );
+        cvGetRows( &matParam, &_ti, NINTRINSIC + i*6 + 3, NINTRINSIC + i*6 + 6 );
 
         CvMat _Mi(matM.colRange(pos, pos + ni));
         CvMat _mi(_m.colRange(pos, pos + ni));
@@ -1557,116 +1617,111 @@ static double cvCalibrateCamera2Internal( const CvMat* objectPoints,
     }
 
     // 3. run the optimization
-    for(;;)
     {
-        const CvMat* _param = 0;
-        CvMat *_JtJ = 0, *_JtErr = 0;
-        double* _errNorm = 0;
-        bool proceed = solver.updateAlt( _param, _JtJ, _JtErr, _errNorm );
-        double *param = solver.param->data.db, *pparam = solver.prevParam->data.db;
-        bool calcJ = solver.state == CvLevMarq::CALC_J || (!proceed && stdDevs);
-
-        if( flags & CALIB_FIX_ASPECT_RATIO )
-        {
-            param[0] = param[1]*aspectRatio;
-            pparam[0] = pparam[1]*aspectRatio;
-        }
-
-        A(0, 0) = param[0]; A(1, 1) = param[1]; A(0, 2) = param[2]; A(1, 2) = param[3];
-        std::copy(param + 4, param + 4 + 14, k);
-
-        if ( !proceed && !stdDevs && !perViewErrors )
-            break;
-        else if ( !proceed && stdDevs )
-            cvZero(_JtJ);
-
-        reprojErr = 0;
+    Mat param = _param;
+    Ptr<SparseLMSolver> sparseSolver = SparseLMSolver::create(
+        makePtr<CalibViewCallback>(matM, _m, npoints, flags, aspectRatio), termCrit );
+    sparseSolver->addParamBlock( NINTRINSIC );
+    for( i = 0, pos = 0; i < nimages; i++, pos += ni )
+    {
+        ni = npoints->data.i[i*npstep];
+        sparseSolver->addParamBlock( 6, true );
+        sparseSolver->addResidualBlock( ni*2, std::vector<int>{ 0, i + 1 } );
+    }
+    sparseSolver->setParamMask( _mask );
+    if( flags & CALIB_USE_LU )
+        sparseSolver->setDecompositionType( DECOMP_LU );
+    else if( flags & CALIB_USE_QR )
+        sparseSolver->setDecompositionType( DECOMP_QR );
+    sparseSolver->run( param );
 
-        for( i = 0, pos = 0; i < nimages; i++, pos += ni )
-        {
-            CvMat _ri, _ti;
-            ni = npoints->data.i[i*npstep];
+    if( flags & CALIB_FIX_ASPECT_RATIO )
+        param.at<double>(0) = param.at<double>(1)*aspectRatio;
+    A(0, 0) = param.at<double>(0); A(1, 1) = param.at<double>(1);
+    A(0, 2) = param.at<double>(2); A(1, 2) = param.at<double>(3);
+    std::copy(param.ptr<double>() + 4, param.ptr<double>() + 4 + 14, k);
+    }
 
-            cvGetRows( solver.param, &_ri, NINTRINSIC + i*6, NINTRINSIC + i*6 + 3 );
-            cvGetRows( solver.param, &_ti, NINTRINSIC + i*6 + 3, NINTRINSIC + i*6 + 6 );
+    // the final errors and, if needed, J^T J for the standard deviations
+    {
+    Mat JtJ;
+    if( stdDevs )
+        JtJ = Mat::zeros(nparams, nparams, CV_64F);
 
-            CvMat _Mi(matM.colRange(pos, pos + ni));
-            CvMat _mi(_m.colRange(pos, pos + ni));
-            CvMat _me(allErrors.colRange(pos, pos + ni));
+    for( i = 0, pos = 0; i < nimages; i++, pos += ni )
+    {
+        CvMat _ri, _ti;
+        ni = npoints->data.i[i*npstep];
 
-            _Je.resize(ni*2); _Ji.resize(ni*2); _err.resize(ni*2);
-            CvMat _dpdr(_Je.colRange(0, 3));
-            CvMat _dpdt(_Je.colRange(3, 6));
-            CvMat _dpdf(_Ji.colRange(0, 2));
-            CvMat _dpdc(_Ji.colRange(2, 4));
-            CvMat _dpdk(_Ji.colRange(4, NINTRINSIC));
-            CvMat _mp(_err.reshape(2, 1));
+        cvGetRows( &matParam, &_ri, NINTRINSIC + i*6, NINTRINSIC + i*6 + 3 );
+        cvGetRows( &matParam, &_ti, NINTRINSIC + i*6 + 3, NINTRINSIC + i*6 + 6 );
 
-            if( calcJ )
-            {
-                 cvProjectPoints2( &_Mi, &_ri, &_ti, &matA, &_k, &_mp, &_dpdr, &_dpdt,
-                                  (flags & CALIB_FIX_FOCAL_LENGTH) ? 0 : &_dpdf,
-                                  (flags & CALIB_FIX_PRINCIPAL_POINT) ? 0 : &_dpdc, &_dpdk,
-                                  (flags & CALIB_FIX_ASPECT_RATIO) ? aspectRatio : 0);
-            }
-            else
-                cvProjectPoints2( &_Mi, &_ri, &_ti, &matA, &_k, &_mp );
+        CvMat _Mi(matM.colRange(pos, pos + ni));
+        CvMat _mi(_m.colRange(pos, pos + ni));
+        CvMat _me(allErrors.colRange(pos, pos + ni));
 
-            cvSub( &_mp, &_mi, &_mp );
-            if (perViewErrors || stdDevs)
-                cvCopy(&_mp, &_me);
+        _Je.resize(ni*2); _Ji.resize(ni*2); _err.resize(ni*2);
+        CvMat _dpdr(_Je.colRange(0, 3));
+        CvMat _dpdt(_Je.colRange(3, 6));
+        CvMat _dpdf(_Ji.colRange(0, 2));
+        CvMat _dpdc(_Ji.colRange(2, 4));
+        CvMat _dpdk(_Ji.colRange(4, NINTRINSIC));
+        CvMat _mp(_err.reshape(2, 1));
 
-            if( calcJ )
-            {
-                Mat JtJ(cvarrToMat(_JtJ)), JtErr(cvarrToMat(_JtErr));
+        if( stdDevs )
+        {
+             cvProjectPoints2( &_Mi, &_ri, &_ti, &matA, &_k, &_mp, &_dpdr, &_dpdt,
+                              (flags & CALIB_FIX_FOCAL_LENGTH) ? 0 : &_dpdf,
+                              (flags & CALIB_FIX_PRINCIPAL_POINT) ? 0 : &_dpdc, &_dpdk,
+                              (flags & CALIB_FIX_ASPECT_RATIO) ? aspectRatio : 0);
+        }
+        else
+            cvProjectPoints2( &_Mi, &_ri, &_ti, &matA, &_k, &_mp );
 
-                // see HZ: (A6.14) for details on the structure of the Jacobian
-                JtJ(Rect(0, 0, NINTRINSIC, NINTRINSIC)) += _Ji.t() * _Ji;
-                JtJ(Rect(NINTRINSIC + i * 6, NINTRINSIC + i * 6, 6, 6)) = _Je.t() * _Je;
-                JtJ(Rect(NINTRINSIC + i * 6, 0, 6, NINTRINSIC)) = _Ji.t() * _Je;
+        cvSub( &_mp, &_mi, &_mp );
+        if (perViewErrors || stdDevs)
+            cvCopy(&_mp, &_me);
 
-                JtErr.rowRange(0, NINTRINSIC) += _Ji.t() * _err;
-                JtErr.rowRange(NINTRINSIC + i * 6, NINTRINSIC + (i + 1) * 6) = _Je.t() * _err;
-            }
+        if( stdDevs )
+        {
+            // see HZ: (A6.14) for details on the structure of the Jacobian
+            JtJ(Rect(0, 0, NINTRINSIC, NINTRINSIC)) += _Ji.t() * _Ji;
+            JtJ(Rect(NINTRINSIC + i * 6, NINTRINSIC + i * 6, 6, 6)) = _Je.t() * _Je;
+            JtJ(Rect(NINTRINSIC + i * 6, 0, 6, NINTRINSIC)) = _Ji.t() * _Je;
+        }
 
-            double viewErr = norm(_err, NORM_L2SQR);
+        double viewErr = norm(_err, NORM_L2SQR);
 
-            if( perViewErrors )
-                perViewErrors->data.db[i] = std::sqrt(viewErr / ni);
+        if( perViewErrors )
+            perViewErrors->data.db[i] = std::sqrt(viewErr / ni);
 
-            reprojErr += viewErr;
-        }
-        if( _errNorm )
-            *_errNorm = reprojErr;
+        reprojErr += viewErr;
+    }
 
-        if( !proceed )
-        {
-            if( stdDevs )
+    if( stdDevs )
+    {
+        const Mat& mask = _mask;
+        int nparams_nz = countNonZero(mask);
+        Mat JtJinv, JtJN;
+        JtJN.create(nparams_nz, nparams_nz, CV_64F);
+        subMatrix(JtJ, JtJN, mask, mask);
+        completeSymm(JtJN, false);
+        cv::invert(JtJN, JtJinv, DECOMP_SVD);
+        //sigma2 is deviation of the noise
+        //see any papers about variance of the least squares estimator for
+        //detailed description of the variance estimation methods
+        double sigma2 = norm(allErrors, NORM_L2SQR) / (total - nparams_nz);
+        Mat stdDevsM = cvarrToMat(stdDevs);
+        int j = 0;
+        for ( int s = 0; s < nparams; s++ )
+            if( mask.data[s] )
             {
-                Mat mask = cvarrToMat(solver.mask);
-                int nparams_nz = countNonZero(mask);
-                Mat JtJinv, JtJN;
-                JtJN.create(nparams_nz, nparams_nz, CV_64F);
-                subMatrix(cvarrToMat(_JtJ), JtJN, mask, mask);
-                completeSymm(JtJN, false);
-                cv::invert(JtJN, JtJinv, DECOMP_SVD);
-                //sigma2 is deviation of the noise
-                //see any papers about variance of the least squares estimator for
-                //detailed description of the variance estimation methods
-                double sigma2 = norm(allErrors, NORM_L2SQR) / (total - nparams_nz);
-                Mat stdDevsM = cvarrToMat(stdDevs);
-                int j = 0;
-                for ( int s = 0; s < nparams; s++ )
-                    if( mask.data[s] )
-                    {
-                        stdDevsM.at<double>(s) = std::sqrt(JtJinv.at<double>(j,j) * sigma2);
-                        j++;
-                    }
-                    else
-                        stdDevsM.at<double>(s) = 0.;
+                stdDevsM.at<double>(s) = std::sqrt(JtJinv.at<double>(j,j) * sigma2);
+                j++;
             }
-            break;
-        }
+            else
+                stdDevsM.at<double>(s) = 0.;
+    }
     }
 
     // 4. store the results
@@ -1679,7 +1734,7 @@ static double cvCalibrateCamera2Internal( const CvMat* objectPoints,
 
         if( rvecs )
         {
-            src = cvMat( 3, 1, CV_64F, solver.param->data.db + NINTRINSIC + i*6 );
+            src = cvMat( 3, 1, CV_64F, _param.ptr<double>() + NINTRINSIC + i*6 );
             if( rvecs->rows == nimages && rvecs->cols*CV_MAT_CN(rvecs->type) == 9 )
             {
                 dst = cvMat( 3, 3, CV_MAT_DEPTH(rvecs->type),
@@ -1697,7 +1752,7 @@ static double cvCalibrateCamera2Internal( const CvMat* objectPoints,
         }
         if( tvecs )
         {
-            src = cvMat( 3, 1, CV_64F, solver.param->data.db + NINTRINSIC + i*6 + 3 );
+            src = cvMat( 3, 1, CV_64F, _param.ptr<double>() + NINTRINSIC + i*6 + 3 );
             dst = cvMat( 3, 1, CV_MAT_DEPTH(tvecs->type), tvecs->rows == 1 ?
                     tvecs->data.ptr + i*CV_ELEM_SIZE(tvecs->type) :
                     tvecs->data.ptr + tvecs->step*i );
@@ -115,6 +115,14 @@ CV_EXPORTS Ptr<PointSetRegistrator> createRANSACPointSetRegistrator(const Ptr<Po
 CV_EXPORTS Ptr<PointSetRegistrator> createLMeDSPointSetRegistrator(const Ptr<PointSetRegistrator::Callback>& cb,
                                                                    int modelPoints, double confidence=0.99, int maxIters=1000 );
 
+// fused rectification and StereoBM prefiltering of a stereo pair, see stereobm.cpp
+void remapPrefilterStereoBM( const Ptr<StereoBM>& matcher, const Mat* src[2],
+                             const Mat* map1[2], const Mat* map2[2],
+                             Mat* dst[2], Mat* rectified[2] );
+// StereoBM::compute() for images produced by remapPrefilterStereoBM()
+void computeStereoBMPrefiltered( const Ptr<StereoBM>& matcher, const Mat& left, const Mat& right,
+                                 OutputArray disparity );
+
 template<typename T> inline int compressElems( T* ptr, const uchar* mask, int mstep, int count )
 {
     int i, j;
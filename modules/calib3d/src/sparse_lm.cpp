@@ -0,0 +1,712 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#include "precomp.hpp"
+#include <map>
+
+namespace cv
+{
+
+// y += A*x or y += A^T*x for a small dense CV_64F block
+static void addMulBlock( const Mat& A, const double* x, double* y, bool transposed )
+{
+    if( !transposed )
+    {
+        for( int i = 0; i < A.rows; i++ )
+        {
+            const double* a = A.ptr<double>(i);
+            double s = 0;
+            for( int j = 0; j < A.cols; j++ )
+                s += a[j]*x[j];
+            y[i] += s;
+        }
+    }
+    else
+    {
+        for( int i = 0; i < A.rows; i++ )
+        {
+            const double* a = A.ptr<double>(i);
+            double xi = x[i];
+            for( int j = 0; j < A.cols; j++ )
+                y[j] += a[j]*xi;
+        }
+    }
+}
+
+// the Levenberg-Marquardt damping of CvLevMarq; the parameters that do not affect
+// the residuals (fixed by the mask or not observed) get zero step
+static void dampDiagonal( Mat& A, double lambda )
+{
+    for( int i = 0; i < A.rows; i++ )
+    {
+        double& d = A.at<double>(i, i);
+        d = d > 0 ? d*(1. + lambda) : 1.;
+    }
+}
+
+static void invertSymmetric( const Mat& A, Mat& Ainv )
+{
+    if( invert(A, Ainv, DECOMP_CHOLESKY) == 0 )
+        invert(A, Ainv, DECOMP_SVD);
+}
+
+/*
+ All the state of one SparseLMSolver::run() call. The parameter blocks are split into
+ the kept ones, that form the reduced system, and the eliminated ones. All the sums of
+ the normal equations are gathered per output block from the precomputed lists of
+ contributions, so that every parallel loop below writes to its own blocks only.
+ */
+struct SparseLMWorkspace
+{
+    // reduced systems up to this size are solved directly
+    enum { DENSE_MAX = 256 };
+
+    struct Contrib
+    {
+        Contrib( int _i, int _a, int _b ) : i(_i), a(_a), b(_b) {}
+        int i, a, b;
+    };
+
+    struct ElimBlock
+    {
+        int block;
+        // residual blocks with the column of this block in their Jacobians
+        std::vector<Contrib> residuals;
+        // kept blocks connected to this one and (slot, residual block, column) of each link
+        std::vector<int> neighbors;
+        std::vector<Contrib> links;
+        Mat V, Vinv, g, z;
+        std::vector<Mat> W, Y;
+    };
+
+    SparseLMWorkspace( const SparseLMSolver::Callback& _cb, const std::vector<int>& _paramOfs,
+                       const std::vector<int>& _paramSize, const std::vector<bool>& _paramElim,
+                       const std::vector<int>& _resErrs, const std::vector<std::vector<int> >& _resBlocks,
+                       const Mat& _mask, int _decompType );
+
+    int findSBlock( std::map<std::pair<int, int>, int>& sIndex, int a, int b );
+    bool evaluate( const Mat& param, bool calcJ, double& errNorm );
+    void buildNormalEquations();
+    void step( double _lambda, Mat& delta );
+
+    // parallel parts
+    void evalResiduals( int r );
+    void accumulateElim( int e );
+    void accumulateKept( int s );
+    void accumulateGradient( int a );
+    void eliminate( int e );
+    void reduceKept( int s );
+    void reduceGradient( int a );
+    void backSubstitute( int e );
+    void mulReduced( int a );
+    void invertPreconditioner( int a );
+
+    void solveReduced();
+    void solvePCG();
+
+    const SparseLMSolver::Callback& cb;
+    const std::vector<int>& paramOfs;
+    const std::vector<int>& paramSize;
+    const std::vector<int>& resErrs;
+    const std::vector<std::vector<int> >& resBlocks;
+    const uchar* mask;
+    int decompType;
+
+    std::vector<std::vector<int> > resColOfs;
+    std::vector<int> keptOf, elimOf;
+    std::vector<int> keptBlocks, keptOfs;
+    int nreduced;
+    std::vector<ElimBlock> elims;
+
+    // blocks of the upper triangle of the reduced matrix
+    std::vector<Point> sPairs;
+    std::vector<std::vector<Contrib> > sResiduals, sElims;
+    // for each kept block: (S block, 0 if the kept block is its row, 1 if its column)
+    std::vector<std::vector<Point> > keptRow;
+    std::vector<std::vector<Contrib> > keptResiduals, keptElims;
+    std::vector<Mat> U, S, gc, Pinv;
+    Mat rhs, dc;
+
+    // per residual block
+    std::vector<Mat> err, J;
+    const Mat* curParam;
+    bool calcJ;
+    // the current damping factor
+    double lambda;
+    std::vector<uchar> failed;
+
+    // PCG temporaries
+    Mat pcgP, pcgQ;
+};
+
+typedef void (SparseLMWorkspace::*SparseLMFunc)( int );
+
+struct SparseLMInvoker : public ParallelLoopBody
+{
+    SparseLMInvoker( SparseLMWorkspace& _ws, SparseLMFunc _func ) : ws(_ws), func(_func) {}
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        for( int i = range.start; i < range.end; i++ )
+            (ws.*func)(i);
+    }
+
+    SparseLMWorkspace& ws;
+    SparseLMFunc func;
+};
+
+static void runParallel( SparseLMWorkspace& ws, int n, SparseLMFunc func )
+{
+    if( n > 0 )
+        parallel_for_(Range(0, n), SparseLMInvoker(ws, func));
+}
+
+SparseLMWorkspace::SparseLMWorkspace( const SparseLMSolver::Callback& _cb, const std::vector<int>& _paramOfs,
+                                      const std::vector<int>& _paramSize, const std::vector<bool>& paramElim,
+                                      const std::vector<int>& _resErrs, const std::vector<std::vector<int> >& _resBlocks,
+                                      const Mat& _mask, int _decompType )
+    : cb(_cb), paramOfs(_paramOfs), paramSize(_paramSize), resErrs(_resErrs), resBlocks(_resBlocks),
+      mask(_mask.ptr()), decompType(_decompType), nreduced(0), curParam(0), calcJ(false), lambda(0)
+{
+    int nblocks = (int)paramSize.size(), nres = (int)resErrs.size();
+
+    keptOf.assign(nblocks, -1);
+    elimOf.assign(nblocks, -1);
+    for( int b = 0; b < nblocks; b++ )
+    {
+        if( paramElim[b] )
+        {
+            elimOf[b] = (int)elims.size();
+            elims.push_back(ElimBlock());
+            elims.back().block = b;
+        }
+        else
+        {
+            keptOf[b] = (int)keptBlocks.size();
+            keptBlocks.push_back(b);
+            keptOfs.push_back(nreduced);
+            nreduced += paramSize[b];
+        }
+    }
+    int nkept = (int)keptBlocks.size();
+    keptResiduals.resize(nkept);
+    keptElims.resize(nkept);
+    keptRow.resize(nkept);
+
+    std::map<std::pair<int, int>, int> sIndex;
+    resColOfs.resize(nres);
+    for( int r = 0; r < nres; r++ )
+    {
+        const std::vector<int>& blocks = resBlocks[r];
+        int nb = (int)blocks.size(), col = 0, e = -1, ecol = 0;
+        resColOfs[r].resize(nb);
+        for( int i = 0; i < nb; i++ )
+        {
+            resColOfs[r][i] = col;
+            if( elimOf[blocks[i]] >= 0 )
+            {
+                e = elimOf[blocks[i]];
+                ecol = col;
+            }
+            col += paramSize[blocks[i]];
+        }
+        if( resErrs[r] == 0 )
+            continue;
+
+        if( e >= 0 )
+            elims[e].residuals.push_back(Contrib(r, ecol, 0));
+
+        for( int i = 0; i < nb; i++ )
+        {
+            int a = keptOf[blocks[i]];
+            if( a < 0 )
+                continue;
+            keptResiduals[a].push_back(Contrib(r, resColOfs[r][i], 0));
+            if( e >= 0 )
+            {
+                std::vector<int>& nbs = elims[e].neighbors;
+                int slot = (int)(std::find(nbs.begin(), nbs.end(), a) - nbs.begin());
+                if( slot == (int)nbs.size() )
+                    nbs.push_back(a);
+                elims[e].links.push_back(Contrib(slot, r, resColOfs[r][i]));
+            }
+            for( int j = 0; j < nb; j++ )
+            {
+                int b = keptOf[blocks[j]];
+                if( b < a )
+                    continue;
+                int s = findSBlock(sIndex, a, b);
+                sResiduals[s].push_back(Contrib(r, resColOfs[r][i], resColOfs[r][j]));
+            }
+        }
+    }
+
+    // fill-in of the Schur complement: every pair of kept blocks linked to the same eliminated one
+    for( int e = 0; e < (int)elims.size(); e++ )
+    {
+        const std::vector<int>& nbs = elims[e].neighbors;
+        for( int i = 0; i < (int)nbs.size(); i++ )
+        {
+            keptElims[nbs[i]].push_back(Contrib(e, i, 0));
+            for( int j = 0; j < (int)nbs.size(); j++ )
+            {
+                int a = nbs[i], b = nbs[j];
+                if( b < a )
+                    continue;
+                int s = findSBlock(sIndex, a, b);
+                sElims[s].push_back(Contrib(e, i, j));
+            }
+        }
+    }
+
+    // every kept block has a diagonal block, even if nothing depends on it
+    for( int a = 0; a < nkept; a++ )
+        findSBlock(sIndex, a, a);
+
+    for( int s = 0; s < (int)sPairs.size(); s++ )
+    {
+        keptRow[sPairs[s].x].push_back(Point(s, 0));
+        if( sPairs[s].y != sPairs[s].x )
+            keptRow[sPairs[s].y].push_back(Point(s, 1));
+    }
+
+    U.resize(sPairs.size());
+    S.resize(sPairs.size());
+    gc.resize(nkept);
+    Pinv.resize(nkept);
+    err.resize(nres);
+    J.resize(nres);
+    failed.assign(nres, (uchar)0);
+}
+
+int SparseLMWorkspace::findSBlock( std::map<std::pair<int, int>, int>& sIndex, int a, int b )
+{
+    std::pair<int, int> key(a, b);
+    std::map<std::pair<int, int>, int>::iterator it = sIndex.find(key);
+    if( it != sIndex.end() )
+        return it->second;
+    int s = (int)sPairs.size();
+    sIndex[key] = s;
+    sPairs.push_back(Point(a, b));
+    sResiduals.push_back(std::vector<Contrib>());
+    sElims.push_back(std::vector<Contrib>());
+    return s;
+}
+
+void SparseLMWorkspace::evalResiduals( int r )
+{
+    int ncols = resColOfs[r].empty() ? 0 : resColOfs[r].back() + paramSize[resBlocks[r].back()];
+    if( resErrs[r] == 0 )
+        return;
+
+    if( calcJ )
+    {
+        if( !cb.compute(r, *curParam, err[r], J[r]) )
+        {
+            failed[r] = 1;
+            return;
+        }
+        CV_Assert( J[r].type() == CV_64FC1 && J[r].rows == resErrs[r] && J[r].cols == ncols );
+
+        // fixed parameters do not take part in the normal equations
+        const std::vector<int>& blocks = resBlocks[r];
+        for( size_t i = 0; i < blocks.size(); i++ )
+        {
+            int ofs = paramOfs[blocks[i]];
+            for( int k = 0; k < paramSize[blocks[i]]; k++ )
+                if( !mask[ofs + k] )
+                    J[r].col(resColOfs[r][i] + k).setTo(Scalar::all(0));
+        }
+    }
+    else if( !cb.compute(r, *curParam, err[r], noArray()) )
+    {
+        failed[r] = 1;
+        return;
+    }
+
+    CV_Assert( err[r].type() == CV_64FC1 && (int)err[r].total() == resErrs[r] );
+    err[r] = err[r].reshape(1, resErrs[r]);
+}
+
+bool SparseLMWorkspace::evaluate( const Mat& param, bool _calcJ, double& errNorm )
+{
+    curParam = &param;
+    calcJ = _calcJ;
+    runParallel(*this, (int)resErrs.size(), &SparseLMWorkspace::evalResiduals);
+
+    errNorm = 0;
+    for( size_t r = 0; r < err.size(); r++ )
+    {
+        if( failed[r] )
+            return false;
+        if( resErrs[r] > 0 )
+            errNorm += norm(err[r], NORM_L2SQR);
+    }
+    return true;
+}
+
+void SparseLMWorkspace::accumulateElim( int e )
+{
+    ElimBlock& eb = elims[e];
+    int n = paramSize[eb.block];
+
+    eb.V = Mat::zeros(n, n, CV_64F);
+    eb.g = Mat::zeros(n, 1, CV_64F);
+    for( size_t i = 0; i < eb.residuals.size(); i++ )
+    {
+        int r = eb.residuals[i].i;
+        Mat Je = J[r].colRange(eb.residuals[i].a, eb.residuals[i].a + n);
+        gemm(Je, Je, 1, eb.V, 1, eb.V, GEMM_1_T);
+        gemm(Je, err[r], 1, eb.g, 1, eb.g, GEMM_1_T);
+    }
+
+    eb.W.resize(eb.neighbors.size());
+    for( size_t k = 0; k < eb.neighbors.size(); k++ )
+        eb.W[k] = Mat::zeros(paramSize[keptBlocks[eb.neighbors[k]]], n, CV_64F);
+
+    // each link knows its residual block; find the column of the eliminated block in it
+    for( size_t i = 0; i < eb.links.size(); i++ )
+    {
+        const Contrib& l = eb.links[i];
+        int r = l.a, ecol = 0;
+        const std::vector<int>& blocks = resBlocks[r];
+        for( size_t j = 0; j < blocks.size(); j++ )
+            if( blocks[j] == eb.block )
+                ecol = resColOfs[r][j];
+        Mat& W = eb.W[l.i];
+        gemm(J[r].colRange(l.b, l.b + W.rows), J[r].colRange(ecol, ecol + n), 1, W, 1, W, GEMM_1_T);
+    }
+}
+
+void SparseLMWorkspace::accumulateKept( int s )
+{
+    int na = paramSize[keptBlocks[sPairs[s].x]], nb = paramSize[keptBlocks[sPairs[s].y]];
+    Mat& Us = U[s];
+    Us = Mat::zeros(na, nb, CV_64F);
+    for( size_t i = 0; i < sResiduals[s].size(); i++ )
+    {
+        const Contrib& c = sResiduals[s][i];
+        gemm(J[c.i].colRange(c.a, c.a + na), J[c.i].colRange(c.b, c.b + nb), 1, Us, 1, Us, GEMM_1_T);
+    }
+}
+
+void SparseLMWorkspace::accumulateGradient( int a )
+{
+    int n = paramSize[keptBlocks[a]];
+    gc[a] = Mat::zeros(n, 1, CV_64F);
+    for( size_t i = 0; i < keptResiduals[a].size(); i++ )
+    {
+        const Contrib& c = keptResiduals[a][i];
+        gemm(J[c.i].colRange(c.a, c.a + n), err[c.i], 1, gc[a], 1, gc[a], GEMM_1_T);
+    }
+}
+
+void SparseLMWorkspace::buildNormalEquations()
+{
+    runParallel(*this, (int)elims.size(), &SparseLMWorkspace::accumulateElim);
+    runParallel(*this, (int)sPairs.size(), &SparseLMWorkspace::accumulateKept);
+    runParallel(*this, (int)keptBlocks.size(), &SparseLMWorkspace::accumulateGradient);
+}
+
+void SparseLMWorkspace::eliminate( int e )
+{
+    ElimBlock& eb = elims[e];
+    Mat V = eb.V.clone();
+    dampDiagonal(V, lambda);
+    invertSymmetric(V, eb.Vinv);
+    eb.z = eb.Vinv*eb.g;
+    eb.Y.resize(eb.W.size());
+    for( size_t k = 0; k < eb.W.size(); k++ )
+        eb.Y[k] = eb.W[k]*eb.Vinv;
+}
+
+void SparseLMWorkspace::reduceKept( int s )
+{
+    Mat& Ss = S[s];
+    U[s].copyTo(Ss);
+    // the kept part of the damped normal matrix, as CvLevMarq damps the full one
+    if( sPairs[s].x == sPairs[s].y )
+        dampDiagonal(Ss, lambda);
+    for( size_t i = 0; i < sElims[s].size(); i++ )
+    {
+        const Contrib& c = sElims[s][i];
+        const ElimBlock& eb = elims[c.i];
+        gemm(eb.Y[c.a], eb.W[c.b], -1, Ss, 1, Ss, GEMM_2_T);
+    }
+}
+
+void SparseLMWorkspace::reduceGradient( int a )
+{
+    double* y = rhs.ptr<double>() + keptOfs[a];
+    int n = gc[a].rows;
+    const double* g = gc[a].ptr<double>();
+    for( int k = 0; k < n; k++ )
+        y[k] = g[k];
+    for( size_t i = 0; i < keptElims[a].size(); i++ )
+    {
+        const Contrib& c = keptElims[a][i];
+        const ElimBlock& eb = elims[c.i];
+        Mat t = -eb.W[c.a]*eb.z;
+        for( int k = 0; k < n; k++ )
+            y[k] += t.at<double>(k);
+    }
+}
+
+void SparseLMWorkspace::backSubstitute( int e )
+{
+    ElimBlock& eb = elims[e];
+    Mat t = eb.g.clone();
+    for( size_t k = 0; k < eb.neighbors.size(); k++ )
+    {
+        int a = eb.neighbors[k];
+        Mat dca = dc.rowRange(keptOfs[a], keptOfs[a] + eb.W[k].rows);
+        gemm(eb.W[k], dca, -1, t, 1, t, GEMM_1_T);
+    }
+    eb.z = eb.Vinv*t;
+}
+
+void SparseLMWorkspace::mulReduced( int a )
+{
+    double* q = pcgQ.ptr<double>() + keptOfs[a];
+    const double* p = pcgP.ptr<double>();
+    int n = paramSize[keptBlocks[a]];
+    for( int k = 0; k < n; k++ )
+        q[k] = 0;
+    for( size_t i = 0; i < keptRow[a].size(); i++ )
+    {
+        int s = keptRow[a][i].x;
+        if( keptRow[a][i].y == 0 )
+            addMulBlock(S[s], p + keptOfs[sPairs[s].y], q, false);
+        else
+            addMulBlock(S[s], p + keptOfs[sPairs[s].x], q, true);
+    }
+}
+
+void SparseLMWorkspace::invertPreconditioner( int a )
+{
+    for( size_t i = 0; i < keptRow[a].size(); i++ )
+    {
+        int s = keptRow[a][i].x;
+        if( sPairs[s].x == a && sPairs[s].y == a )
+            invertSymmetric(S[s], Pinv[a]);
+    }
+}
+
+void SparseLMWorkspace::solvePCG()
+{
+    const double tol = 1e-10;
+    int nkept = (int)keptBlocks.size(), maxIters = std::max(nreduced, 100);
+    runParallel(*this, nkept, &SparseLMWorkspace::invertPreconditioner);
+
+    dc = Mat::zeros(nreduced, 1, CV_64F);
+    Mat r = rhs.clone(), z(nreduced, 1, CV_64F);
+    double bnorm = norm(rhs);
+    if( bnorm == 0 )
+        return;
+
+    pcgQ.create(nreduced, 1, CV_64F);
+    z.setTo(Scalar::all(0));
+    for( int a = 0; a < nkept; a++ )
+        addMulBlock(Pinv[a], r.ptr<double>() + keptOfs[a], z.ptr<double>() + keptOfs[a], false);
+    z.copyTo(pcgP);
+    double rz = r.dot(z);
+
+    for( int iter = 0; iter < maxIters; iter++ )
+    {
+        runParallel(*this, nkept, &SparseLMWorkspace::mulReduced);
+        double pq = pcgP.dot(pcgQ);
+        if( pq <= 0 )
+            break;
+        double alpha = rz/pq;
+        scaleAdd(pcgP, alpha, dc, dc);
+        scaleAdd(pcgQ, -alpha, r, r);
+        if( norm(r) <= tol*bnorm )
+            break;
+        z.setTo(Scalar::all(0));
+        for( int a = 0; a < nkept; a++ )
+            addMulBlock(Pinv[a], r.ptr<double>() + keptOfs[a], z.ptr<double>() + keptOfs[a], false);
+        double rz1 = r.dot(z);
+        scaleAdd(pcgP, rz1/rz, z, pcgP);
+        rz = rz1;
+    }
+}
+
+void SparseLMWorkspace::solveReduced()
+{
+    if( nreduced == 0 )
+    {
+        dc.release();
+        return;
+    }
+    if( nreduced > DENSE_MAX )
+    {
+        solvePCG();
+        return;
+    }
+
+    Mat A(nreduced, nreduced, CV_64F);
+    for( size_t s = 0; s < sPairs.size(); s++ )
+    {
+        int a = sPairs[s].x, b = sPairs[s].y;
+        S[s].copyTo(A(Rect(keptOfs[b], keptOfs[a], S[s].cols, S[s].rows)));
+        if( a != b )
+            transpose(S[s], A(Rect(keptOfs[a], keptOfs[b], S[s].rows, S[s].cols)));
+    }
+    // the blocks not linked by any residual are zero
+    Mat filled = Mat::zeros(nreduced, nreduced, CV_8U);
+    for( size_t s = 0; s < sPairs.size(); s++ )
+    {
+        int a = sPairs[s].x, b = sPairs[s].y;
+        filled(Rect(keptOfs[b], keptOfs[a], S[s].cols, S[s].rows)).setTo(1);
+        filled(Rect(keptOfs[a], keptOfs[b], S[s].rows, S[s].cols)).setTo(1);
+    }
+    A.setTo(Scalar::all(0), filled == 0);
+
+    if( !solve(A, rhs, dc, decompType) )
+        solve(A, rhs, dc, DECOMP_SVD);
+}
+
+void SparseLMWorkspace::step( double _lambda, Mat& delta )
+{
+    this->lambda = _lambda;
+    runParallel(*this, (int)elims.size(), &SparseLMWorkspace::eliminate);
+    runParallel(*this, (int)sPairs.size(), &SparseLMWorkspace::reduceKept);
+    rhs.create(nreduced, 1, CV_64F);
+    runParallel(*this, (int)keptBlocks.size(), &SparseLMWorkspace::reduceGradient);
+
+    solveReduced();
+    runParallel(*this, (int)elims.size(), &SparseLMWorkspace::backSubstitute);
+
+    delta = Mat::zeros((int)(paramOfs.empty() ? 0 : paramOfs.back() + paramSize.back()), 1, CV_64F);
+    for( size_t a = 0; a < keptBlocks.size(); a++ )
+    {
+        int b = keptBlocks[a];
+        dc.rowRange(keptOfs[a], keptOfs[a] + paramSize[b]).copyTo(delta.rowRange(paramOfs[b], paramOfs[b] + paramSize[b]));
+    }
+    for( size_t e = 0; e < elims.size(); e++ )
+    {
+        int b = elims[e].block;
+        elims[e].z.copyTo(delta.rowRange(paramOfs[b], paramOfs[b] + paramSize[b]));
+    }
+    for( int i = 0; i < delta.rows; i++ )
+        if( !mask[i] )
+            delta.at<double>(i) = 0;
+}
+
+class SparseLMSolverImpl CV_FINAL : public SparseLMSolver
+{
+public:
+    SparseLMSolverImpl( const Ptr<SparseLMSolver::Callback>& _cb, const TermCriteria& _criteria )
+        : cb(_cb), criteria(_criteria), nparams(0), decompType(DECOMP_SVD)
+    {
+    }
+
+    int addParamBlock( int size, bool eliminate ) CV_OVERRIDE
+    {
+        CV_Assert( size > 0 );
+        paramOfs.push_back(nparams);
+        paramSize.push_back(size);
+        paramElim.push_back(eliminate);
+        nparams += size;
+        return (int)paramSize.size() - 1;
+    }
+
+    int addResidualBlock( int nerrs, const std::vector<int>& blocks ) CV_OVERRIDE
+    {
+        CV_Assert( nerrs >= 0 && !blocks.empty() );
+        int nelim = 0;
+        for( size_t i = 0; i < blocks.size(); i++ )
+        {
+            CV_Assert( 0 <= blocks[i] && blocks[i] < (int)paramSize.size() );
+            nelim += paramElim[blocks[i]] ? 1 : 0;
+        }
+        if( nelim > 1 )
+            CV_Error( Error::StsBadArg, "A residual block may depend on one eliminated parameter block at most" );
+        resErrs.push_back(nerrs);
+        resBlocks.push_back(blocks);
+        return (int)resErrs.size() - 1;
+    }
+
+    void setParamMask( InputArray _mask ) CV_OVERRIDE
+    {
+        Mat m = _mask.getMat();
+        CV_Assert( m.empty() || (m.type() == CV_8UC1 && (m.rows == 1 || m.cols == 1)) );
+        m.reshape(1, (int)m.total()).copyTo(mask);
+    }
+
+    void setDecompositionType( int method ) CV_OVERRIDE { decompType = method; }
+
+    int run( InputOutputArray _param ) const CV_OVERRIDE
+    {
+        CV_INSTRUMENT_REGION()
+
+        CV_Assert( cb );
+        Mat param0 = _param.getMat();
+        CV_Assert( param0.type() == CV_64FC1 && (int)param0.total() == nparams );
+        Mat param = param0.reshape(1, nparams).clone(), prevParam, delta;
+
+        Mat m = mask.empty() ? Mat(nparams, 1, CV_8U, Scalar::all(1)) : mask;
+        CV_Assert( (int)m.total() == nparams );
+
+        int maxIters = criteria.type & TermCriteria::COUNT ? std::min(std::max(criteria.maxCount, 1), 1000) : 30;
+        double eps = criteria.type & TermCriteria::EPS ? std::max(criteria.epsilon, 0.) : DBL_EPSILON;
+
+        SparseLMWorkspace ws(*cb, paramOfs, paramSize, paramElim, resErrs, resBlocks, m, decompType);
+
+        double errNorm = 0, prevErrNorm = 0;
+        if( !ws.evaluate(param, true, prevErrNorm) )
+            return -1;
+
+        int lambdaLg10 = -3, iters = 0;
+        for(;;)
+        {
+            ws.buildNormalEquations();
+            param.copyTo(prevParam);
+
+            for(;;)
+            {
+                ws.step(std::pow(10., lambdaLg10), delta);
+                subtract(prevParam, delta, param);
+                if( !ws.evaluate(param, false, errNorm) )
+                    return -1;
+                if( errNorm <= prevErrNorm || ++lambdaLg10 > 16 )
+                    break;
+            }
+            if( errNorm > prevErrNorm )
+            {
+                // no step decreases the error
+                prevParam.copyTo(param);
+                errNorm = prevErrNorm;
+            }
+
+            lambdaLg10 = std::max(lambdaLg10 - 1, -16);
+            if( ++iters >= maxIters || norm(param, prevParam, NORM_RELATIVE | NORM_L2) < eps )
+                break;
+
+            prevErrNorm = errNorm;
+            if( !ws.evaluate(param, true, errNorm) )
+                return -1;
+        }
+
+        param.reshape(1, param0.rows).copyTo(param0);
+        return iters;
+    }
+
+    Ptr<SparseLMSolver::Callback> cb;
+    TermCriteria criteria;
+    int nparams;
+    int decompType;
+    std::vector<int> paramOfs, paramSize;
+    std::vector<bool> paramElim;
+    std::vector<int> resErrs;
+    std::vector<std::vector<int> > resBlocks;
+    Mat mask;
+};
+
+Ptr<SparseLMSolver> SparseLMSolver::create( const Ptr<SparseLMSolver::Callback>& cb, const TermCriteria& criteria )
+{
+    return makePtr<SparseLMSolverImpl>(cb, criteria);
+}
+
+}
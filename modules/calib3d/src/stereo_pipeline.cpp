@@ -0,0 +1,109 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#include "precomp.hpp"
+
+namespace cv
+{
+
+class StereoBMPipelineImpl CV_FINAL : public StereoBMPipeline
+{
+public:
+    struct Rig
+    {
+        Size imageSize;
+        Mat R1, R2, P1, P2, Q;
+        Rect roi1, roi2;
+        // CV_16SC2 integer coordinates and CV_16UC1 interpolation table indices
+        Mat map1[2], map2[2];
+    };
+
+    explicit StereoBMPipelineImpl( const Ptr<StereoBM>& _matcher )
+        : matcher(_matcher.empty() ? StereoBM::create() : _matcher)
+    {
+    }
+
+    int addRig( InputArray cameraMatrix1, InputArray distCoeffs1,
+                InputArray cameraMatrix2, InputArray distCoeffs2,
+                Size imageSize, InputArray R, InputArray T,
+                int flags, double alpha ) CV_OVERRIDE
+    {
+        CV_INSTRUMENT_REGION()
+
+        Rig rig;
+        rig.imageSize = imageSize;
+        stereoRectify( cameraMatrix1, distCoeffs1, cameraMatrix2, distCoeffs2, imageSize, R, T,
+                       rig.R1, rig.R2, rig.P1, rig.P2, rig.Q, flags, alpha, imageSize,
+                       &rig.roi1, &rig.roi2 );
+        initUndistortRectifyMap( cameraMatrix1, distCoeffs1, rig.R1, rig.P1, imageSize,
+                                 CV_16SC2, rig.map1[0], rig.map2[0] );
+        initUndistortRectifyMap( cameraMatrix2, distCoeffs2, rig.R2, rig.P2, imageSize,
+                                 CV_16SC2, rig.map1[1], rig.map2[1] );
+        rigs.push_back(rig);
+        return (int)rigs.size() - 1;
+    }
+
+    int getRigCount() const CV_OVERRIDE { return (int)rigs.size(); }
+
+    void getRectification( int rig, OutputArray R1, OutputArray R2,
+                           OutputArray P1, OutputArray P2, OutputArray Q ) const CV_OVERRIDE
+    {
+        CV_Assert( 0 <= rig && rig < (int)rigs.size() );
+        const Rig& r = rigs[rig];
+        r.R1.copyTo(R1);
+        r.R2.copyTo(R2);
+        r.P1.copyTo(P1);
+        r.P2.copyTo(P2);
+        r.Q.copyTo(Q);
+    }
+
+    void compute( int rig, InputArray left, InputArray right, OutputArray disparity,
+                  OutputArray rectifiedLeft, OutputArray rectifiedRight ) CV_OVERRIDE
+    {
+        CV_INSTRUMENT_REGION()
+
+        CV_Assert( 0 <= rig && rig < (int)rigs.size() );
+        const Rig& r = rigs[rig];
+
+        Mat src[2] = { left.getMat(), right.getMat() };
+        for( int k = 0; k < 2; k++ )
+            CV_Assert( src[k].type() == CV_8UC1 && src[k].size() == r.imageSize );
+
+        Mat rectified[2];
+        const _OutputArray* rectifiedArr[2] = { &rectifiedLeft, &rectifiedRight };
+        for( int k = 0; k < 2; k++ )
+        {
+            if( rectifiedArr[k]->needed() )
+            {
+                rectifiedArr[k]->create( r.imageSize, CV_8UC1 );
+                rectified[k] = rectifiedArr[k]->getMat();
+            }
+        }
+
+        const Mat* srcPtr[2] = { &src[0], &src[1] };
+        const Mat* map1Ptr[2] = { &r.map1[0], &r.map1[1] };
+        const Mat* map2Ptr[2] = { &r.map2[0], &r.map2[1] };
+        Mat* filteredPtr[2] = { &filtered[0], &filtered[1] };
+        Mat* rectifiedPtr[2] = { rectified[0].empty() ? 0 : &rectified[0],
+                                 rectified[1].empty() ? 0 : &rectified[1] };
+        remapPrefilterStereoBM( matcher, srcPtr, map1Ptr, map2Ptr, filteredPtr, rectifiedPtr );
+
+        matcher->setROI1( r.roi1 );
+        matcher->setROI2( r.roi2 );
+        computeStereoBMPrefiltered( matcher, filtered[0], filtered[1], disparity );
+    }
+
+    Ptr<StereoBM> getMatcher() const CV_OVERRIDE { return matcher; }
+
+    Ptr<StereoBM> matcher;
+    std::vector<Rig> rigs;
+    Mat filtered[2];
+};
+
+Ptr<StereoBMPipeline> StereoBMPipeline::create( const Ptr<StereoBM>& matcher )
+{
+    return makePtr<StereoBMPipelineImpl>(matcher);
+}
+
+}
@@ -1103,6 +1103,12 @@ public:
     {
         CV_INSTRUMENT_REGION()
 
+        computeImpl( leftarr, rightarr, disparr, false );
+    }
+
+    // if prefiltered is true, leftarr and rightarr are the output of remapPrefilterStereoBM()
+    void computeImpl( InputArray leftarr, InputArray rightarr, OutputArray disparr, bool prefiltered )
+    {
         int dtype = disparr.fixedType() ? disparr.type() : params.dispType;
         Size leftsize = leftarr.size();
 
@@ -1147,7 +1153,7 @@ public:
         int FILTERED = (params.minDisparity - 1) << disp_shift;
 
 #ifdef HAVE_OPENCL
-        if(ocl::isOpenCLActivated() && disparr.isUMat() && params.textureThreshold == 0)
+        if(!prefiltered && ocl::isOpenCLActivated() && disparr.isUMat() && params.textureThreshold == 0)
         {
             UMat left, right;
             if(ocl_prefiltering(leftarr, rightarr, left, right, &params))
@@ -1172,11 +1178,14 @@ public:
         disparr.create(left0.size(), dtype);
         Mat disp0 = disparr.getMat();
 
-        preFilteredImg0.create( left0.size(), CV_8U );
-        preFilteredImg1.create( left0.size(), CV_8U );
+        if( !prefiltered )
+        {
+            preFilteredImg0.create( left0.size(), CV_8U );
+            preFilteredImg1.create( left0.size(), CV_8U );
+        }
         cost.create( left0.size(), CV_16S );
 
-        Mat left = preFilteredImg0, right = preFilteredImg1;
+        Mat left = prefiltered ? left0 : preFilteredImg0, right = prefiltered ? right0 : preFilteredImg1;
 
         int mindisp = params.minDisparity;
         int ndisp = params.numDisparities;
@@ -1223,7 +1232,8 @@ public:
 
         uchar *_buf = slidingSumBuf.ptr();
 
-        parallel_for_(Range(0, 2), PrefilterInvoker(left0, right0, left, right, _buf, _buf + bufSize1, &params), 1);
+        if( !prefiltered )
+            parallel_for_(Range(0, 2), PrefilterInvoker(left0, right0, left, right, _buf, _buf + bufSize1, &params), 1);
 
         Rect validDisparityRect(0, 0, width, height), R1 = params.roi1, R2 = params.roi2;
         validDisparityRect = getValidDisparityROI(R1.area() > 0 ? R1 : validDisparityRect,
@@ -1334,6 +1344,110 @@ Ptr<StereoBM> StereoBM::create(int _numDisparities, int _SADWindowSize)
     return makePtr<StereoBMImpl>(_numDisparities, _SADWindowSize);
 }
 
+/*
+ Rectifies both images row stripe by row stripe and runs the StereoBM prefilter on each
+ stripe while it is still in cache. The stripes overlap by the prefilter support (and start
+ on even rows for the x-Sobel prefilter that processes rows in pairs), so the result is
+ the same as remap() followed by the prefilter of StereoBM::compute().
+ */
+struct RemapPrefilterInvoker : public ParallelLoopBody
+{
+    RemapPrefilterInvoker( const StereoBMParams& _params, const Mat** _src, const Mat** _map1, const Mat** _map2,
+                           Mat** _dst, Mat** _rectified, int _stripeSize, int _halo ) :
+        params(_params), stripeSize(_stripeSize), halo(_halo)
+    {
+        for( int k = 0; k < 2; k++ )
+        {
+            src[k] = _src[k]; map1[k] = _map1[k]; map2[k] = _map2[k];
+            dst[k] = _dst[k]; rectified[k] = _rectified[k];
+        }
+    }
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        int width = dst[0]->cols, height = dst[0]->rows;
+        Mat rectBuf, filtBuf;
+        AutoBuffer<uchar> normBuf((width + params.preFilterSize + 2)*sizeof(int) + 256);
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            // the left and the right stripes are interleaved to process both images concurrently
+            int k = i & 1;
+            int y0 = (i >> 1)*stripeSize, y1 = std::min(y0 + stripeSize, height);
+            int ys = std::max(y0 - halo, 0), ye = std::min(y1 + halo, height);
+
+            remap( *src[k], rectBuf, map1[k]->rowRange(ys, ye), map2[k]->rowRange(ys, ye),
+                   INTER_LINEAR, BORDER_CONSTANT );
+            filtBuf.create( rectBuf.size(), CV_8U );
+            if( params.preFilterType == StereoBM::PREFILTER_NORMALIZED_RESPONSE )
+                prefilterNorm( rectBuf, filtBuf, params.preFilterSize, params.preFilterCap, normBuf.data() );
+            else
+                prefilterXSobel( rectBuf, filtBuf, params.preFilterCap );
+
+            filtBuf.rowRange(y0 - ys, y1 - ys).copyTo( dst[k]->rowRange(y0, y1) );
+            if( rectified[k] )
+                rectBuf.rowRange(y0 - ys, y1 - ys).copyTo( rectified[k]->rowRange(y0, y1) );
+        }
+    }
+
+    const StereoBMParams& params;
+    const Mat* src[2];
+    const Mat* map1[2];
+    const Mat* map2[2];
+    Mat* dst[2];
+    Mat* rectified[2];
+    int stripeSize;
+    int halo;
+};
+
+void remapPrefilterStereoBM( const Ptr<StereoBM>& matcher, const Mat* src[2],
+                             const Mat* map1[2], const Mat* map2[2],
+                             Mat* dst[2], Mat* rectified[2] )
+{
+    CV_INSTRUMENT_REGION()
+
+    StereoBMImpl* bm = dynamic_cast<StereoBMImpl*>(matcher.get());
+    CV_Assert( bm != NULL );
+    const StereoBMParams& params = bm->params;
+
+    if( params.preFilterType != StereoBM::PREFILTER_NORMALIZED_RESPONSE &&
+        params.preFilterType != StereoBM::PREFILTER_XSOBEL )
+        CV_Error( Error::StsOutOfRange, "preFilterType must be = CV_STEREO_BM_NORMALIZED_RESPONSE" );
+
+    if( params.preFilterSize < 5 || params.preFilterSize > 255 || params.preFilterSize % 2 == 0 )
+        CV_Error( Error::StsOutOfRange, "preFilterSize must be odd and be within 5..255" );
+
+    if( params.preFilterCap < 1 || params.preFilterCap > 63 )
+        CV_Error( Error::StsOutOfRange, "preFilterCap must be within 1..63" );
+
+    Size size = map1[0]->size();
+    for( int k = 0; k < 2; k++ )
+    {
+        CV_Assert( src[k]->type() == CV_8UC1 );
+        CV_Assert( map1[k]->type() == CV_16SC2 && map2[k]->type() == CV_16UC1 &&
+                   map1[k]->size() == size && map2[k]->size() == size );
+        dst[k]->create( size, CV_8U );
+        if( rectified[k] )
+            rectified[k]->create( size, CV_8U );
+    }
+
+    // x-Sobel processes pairs of rows, so the stripes must start on even rows
+    int halo = params.preFilterType == StereoBM::PREFILTER_XSOBEL ? 2 : params.preFilterSize/2 + 1;
+    int stripeSize = (std::max(64, halo*4) + 1) & -2;
+    int nstripes = (size.height + stripeSize - 1)/stripeSize;
+
+    parallel_for_( Range(0, nstripes*2),
+                   RemapPrefilterInvoker(params, src, map1, map2, dst, rectified, stripeSize, halo) );
+}
+
+void computeStereoBMPrefiltered( const Ptr<StereoBM>& matcher, const Mat& left, const Mat& right,
+                                 OutputArray disparity )
+{
+    StereoBMImpl* bm = dynamic_cast<StereoBMImpl*>(matcher.get());
+    CV_Assert( bm != NULL );
+    bm->computeImpl( left, right, disparity, true );
+}
+
 }
 
 /* End of file. */
@@ -77,6 +77,7 @@ struct StereoSGBMParams
         speckleWindowSize = 0;
         speckleRange = 0;
         mode = StereoSGBM::MODE_SGBM;
+        bandMemoryLimit = 0;
     }
 
     StereoSGBMParams( int _minDisparity, int _numDisparities, int _SADWindowSize,
@@ -95,6 +96,7 @@ struct StereoSGBMParams
         speckleWindowSize = _speckleWindowSize;
         speckleRange = _speckleRange;
         mode = _mode;
+        bandMemoryLimit = 0;
     }
 
     int minDisparity;
@@ -108,6 +110,7 @@ struct StereoSGBMParams
     int speckleRange;
     int disp12MaxDiff;
     int mode;
+    size_t bandMemoryLimit;
 };
 
 static const int DEFAULT_RIGHT_BORDER = -1;
@@ -379,8 +382,8 @@ static void computeDisparitySGBM( const Mat& img1, const Mat& img2,
     PixType* tempBuf = (PixType*)(disp2ptr + width);
 
     // add P2 to every C(x,y). it saves a few operations in the inner loops
-    for(k = 0; k < (int)CSBufSize; k++ )
-        Cbuf[k] = (CostType)P2;
+    for( size_t i = 0; i < CSBufSize; i++ )
+        Cbuf[i] = (CostType)P2;
 
     for( int pass = 1; pass <= npasses; pass++ )
     {
@@ -1492,14 +1495,14 @@ static void computeDisparitySGBM_HH4( const Mat& img1, const Mat& img2,
 
     if( buffer.empty() || !buffer.isContinuous() ||
         buffer.cols*buffer.rows*buffer.elemSize() < totalBufSize )
-        buffer.create(1, (int)totalBufSize, CV_8U);
+        buffer.reserveBuffer(totalBufSize);
 
     // summary cost over different (nDirs) directions
     CostType* Cbuf = (CostType*)alignPtr(buffer.ptr(), ALIGN);
 
     // add P2 to every C(x,y). it saves a few operations in the inner loops
-    for(k = 0; k < (int)CSBufSize; k++ )
-        Cbuf[k] = (CostType)P2;
+    for( size_t i = 0; i < CSBufSize; i++ )
+        Cbuf[i] = (CostType)P2;
 
     parallel_for_(Range(0,width1),CalcVerticalSums(img1, img2, params, Cbuf, clipTab),8);
     parallel_for_(Range(0,height),CalcHorizontalSums(img1, img2, disp1, params, Cbuf),8);
@@ -2128,6 +2131,107 @@ static void computeDisparity3WaySGBM( const Mat& img1, const Mat& img2,
     delete[] dst_disp;
 }
 
+/*
+ Estimates the number of bytes computeDisparitySGBM() / computeDisparitySGBM_HH4() need
+ to process a band of the given height: a part that does not depend on the band height
+ (Lr, minLr, hsumBuf, per-row temporaries) and, for the full-DP modes, the C and S cost volumes.
+ */
+static void calcSGBMBandBufSize( const StereoSGBMParams& params, int width, int cn,
+                                 size_t& fixedSize, size_t& rowSize )
+{
+    int minD = params.minDisparity, maxD = minD + params.numDisparities;
+    int SH2 = (params.SADWindowSize > 0 ? params.SADWindowSize : 5)/2;
+    int minX1 = std::max(maxD, 0), maxX1 = width + std::min(minD, 0);
+    size_t D = params.numDisparities, D2 = D + 16;
+    size_t width1 = (size_t)std::max(maxX1 - minX1, 0);
+    size_t costBufSize = width1*D;
+    size_t minLrSize = (width1 + 2)*NR2;
+
+    fixedSize = (minLrSize*D2 + minLrSize)*2*sizeof(CostType) +
+                costBufSize*(SH2*2 + 3)*sizeof(CostType) +
+                width*16*cn*sizeof(PixType) +
+                width*(sizeof(CostType) + sizeof(DispType)) + 1024;
+    // disparity of the band, C and S
+    rowSize = width*sizeof(DispType);
+    if( params.mode == StereoSGBM::MODE_HH || params.mode == StereoSGBM::MODE_HH4 )
+        rowSize += costBufSize*2*sizeof(CostType);
+}
+
+struct SGBMBandInvoker : public ParallelLoopBody
+{
+    SGBMBandInvoker( const Mat& _img1, const Mat& _img2, Mat& _disp1, const StereoSGBMParams& _params,
+                     int _band_sz, int _band_overlap ) :
+        img1(_img1), img2(_img2), disp1(_disp1), params(_params),
+        band_sz(_band_sz), band_overlap(_band_overlap)
+    {
+    }
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        // one buffer per chunk of bands, so that the peak memory is bounded
+        // by the number of worker threads rather than by the number of bands
+        Mat buffer, bandDisp;
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int y0 = i*band_sz, y1 = std::min(y0 + band_sz, img1.rows);
+            int ys = std::max(y0 - band_overlap, 0), ye = std::min(y1 + band_overlap, img1.rows);
+
+            Mat left = img1.rowRange(ys, ye), right = img2.rowRange(ys, ye);
+            bandDisp.create(ye - ys, img1.cols, CV_16S);
+            if( params.mode == StereoSGBM::MODE_HH4 )
+                computeDisparitySGBM_HH4( left, right, bandDisp, params, buffer );
+            else
+                computeDisparitySGBM( left, right, bandDisp, params, buffer );
+
+            bandDisp.rowRange(y0 - ys, y1 - ys).copyTo(disp1.rowRange(y0, y1));
+        }
+    }
+
+    const Mat& img1;
+    const Mat& img2;
+    Mat& disp1;
+    const StereoSGBMParams& params;
+    int band_sz;
+    int band_overlap;
+};
+
+/*
+ Splits the image into overlapping horizontal bands, sized so that each band
+ fits into params.bandMemoryLimit bytes, and processes the bands in parallel.
+ The band layout depends only on the image size and the parameters,
+ not on the number of threads, so the results are reproducible.
+ */
+static void computeDisparityBandedSGBM( const Mat& img1, const Mat& img2,
+                                        Mat& disp1, const StereoSGBMParams& params )
+{
+    // the same as in computeDisparity3WaySGBM, to have some parallelism even
+    // if the whole image fits into the memory limit
+    const int MIN_BANDS = 4, MIN_BAND_SIZE = 16;
+    int height = img1.rows;
+    int SH2 = (params.SADWindowSize > 0 ? params.SADWindowSize : 5)/2;
+
+    size_t fixedSize = 0, rowSize = 0;
+    calcSGBMBandBufSize( params, img1.cols, img1.channels(), fixedSize, rowSize );
+
+    int nbands = MIN_BANDS;
+    if( params.bandMemoryLimit > fixedSize )
+    {
+        // band rows are band_sz + 2*(SH2 + 1 + 0.1*band_sz)
+        double maxRows = std::min((double)(params.bandMemoryLimit - fixedSize)/rowSize, height*2.);
+        int band_sz = std::max(cvFloor((maxRows - 2*(SH2 + 2))/1.2), MIN_BAND_SIZE);
+        nbands = std::max(nbands, (height + band_sz - 1)/band_sz);
+    }
+    else
+        nbands = std::max(nbands, height/MIN_BAND_SIZE);
+    nbands = std::max(std::min(nbands, height/MIN_BAND_SIZE), 1);
+
+    int band_sz = (height + nbands - 1)/nbands;
+    int band_overlap = (SH2 + 1) + (int)ceil(0.1*band_sz);
+    nbands = (height + band_sz - 1)/band_sz;
+
+    parallel_for_(Range(0, nbands), SGBMBandInvoker(img1, img2, disp1, params, band_sz, band_overlap));
+}
+
 class StereoSGBMImpl CV_FINAL : public StereoSGBM
 {
 public:
@@ -2160,6 +2264,8 @@ public:
 
         if(params.mode==MODE_SGBM_3WAY)
             computeDisparity3WaySGBM( left, right, disp, params, buffers, num_stripes );
+        else if(params.bandMemoryLimit > 0)
+            computeDisparityBandedSGBM( left, right, disp, params );
         else if(params.mode==MODE_HH4)
             computeDisparitySGBM_HH4( left, right, disp, params, buffer );
         else
@@ -2205,6 +2311,9 @@ public:
     int getMode() const CV_OVERRIDE { return params.mode; }
     void setMode(int mode) CV_OVERRIDE { params.mode = mode; }
 
+    size_t getBandMemoryLimit() const CV_OVERRIDE { return params.bandMemoryLimit; }
+    void setBandMemoryLimit(size_t bandMemoryLimit) CV_OVERRIDE { params.bandMemoryLimit = bandMemoryLimit; }
+
     void write(FileStorage& fs) const CV_OVERRIDE
     {
         writeFormat(fs);
@@ -2219,7 +2328,8 @@ public:
         << "uniquenessRatio" << params.uniquenessRatio
         << "P1" << params.P1
         << "P2" << params.P2
-        << "mode" << params.mode;
+        << "mode" << params.mode
+        << "bandMemoryLimit" << (double)params.bandMemoryLimit;
     }
 
     void read(const FileNode& fn) CV_OVERRIDE
@@ -2237,6 +2347,7 @@ public:
         params.P1 = (int)fn["P1"];
         params.P2 = (int)fn["P2"];
         params.mode = (int)fn["mode"];
+        params.bandMemoryLimit = (size_t)(double)fn["bandMemoryLimit"];
     }
 
     StereoSGBMParams params;
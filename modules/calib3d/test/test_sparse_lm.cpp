@@ -0,0 +1,226 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#include "test_precomp.hpp"
+#include "opencv2/calib3d/calib3d_c.h"
+
+namespace opencv_test { namespace {
+
+// bundle adjustment of a row of pinhole cameras (6 parameters each) looking at 3D points
+// (3 parameters each, eliminated); every point is seen by the cameras close to it
+class BundleAdjustmentCallback : public SparseLMSolver::Callback
+{
+public:
+    BundleAdjustmentCallback(int _ncameras, double _f) : ncameras(_ncameras), f(_f) {}
+
+    bool compute(int block, InputArray _param, OutputArray err, OutputArray J) const CV_OVERRIDE
+    {
+        const double* param = _param.getMat().ptr<double>();
+        int cam = observations[block].x, pt = observations[block].y;
+        Mat rvec(3, 1, CV_64F, (void*)(param + cam*6)), tvec(3, 1, CV_64F, (void*)(param + cam*6 + 3));
+        Mat X(1, 1, CV_64FC3, (void*)(param + ncameras*6 + pt*3));
+        Mat K = (Mat_<double>(3, 3) << f, 0, 0, 0, f, 0, 0, 0, 1);
+
+        Mat proj, dproj;
+        projectPoints(X, rvec, tvec, K, noArray(), proj, J.needed() ? dproj : noArray());
+        Mat e = proj.reshape(1, 2) - Mat(points2d[block]).reshape(1, 2);
+        e.copyTo(err);
+
+        if (J.needed())
+        {
+            J.create(2, 9, CV_64F);
+            Mat Jm = J.getMat();
+            dproj.colRange(0, 6).copyTo(Jm.colRange(0, 6));
+
+            // d(proj)/dX = f/z*(R.row(0/1) - x/z*R.row(2))
+            Mat R;
+            cv::Rodrigues(rvec, R);
+            Mat Xc = R*Mat(3, 1, CV_64F, (void*)(param + ncameras*6 + pt*3)) + tvec;
+            double z = Xc.at<double>(2);
+            for (int k = 0; k < 2; k++)
+            {
+                Mat d = f/z*(R.row(k) - Xc.at<double>(k)/z*R.row(2));
+                d.reshape(1, 3).copyTo(Jm.row(k).colRange(6, 9).reshape(1, 3));
+            }
+        }
+        return true;
+    }
+
+    int ncameras;
+    double f;
+    std::vector<Point> observations;
+    std::vector<Point2d> points2d;
+};
+
+// the solver of a random problem and its ground truth, the gauge is fixed by the mask
+static Ptr<SparseLMSolver> makeBundleAdjustment(int ncameras, int npoints, const TermCriteria& criteria,
+                                                Ptr<BundleAdjustmentCallback>& cb, Mat& gt, Mat& mask)
+{
+    RNG& rng = theRNG();
+    const double f = 500;
+    cb = makePtr<BundleAdjustmentCallback>(ncameras, f);
+
+    int nparams = ncameras*6 + npoints*3;
+    gt.create(nparams, 1, CV_64F);
+    for (int i = 0; i < ncameras; i++)
+    {
+        double* p = gt.ptr<double>() + i*6;
+        p[0] = rng.uniform(-0.05, 0.05); p[1] = rng.uniform(-0.05, 0.05); p[2] = rng.uniform(-0.05, 0.05);
+        p[3] = -i; p[4] = rng.uniform(-0.2, 0.2); p[5] = 10 + rng.uniform(-0.2, 0.2);
+    }
+    for (int j = 0; j < npoints; j++)
+    {
+        double* p = gt.ptr<double>() + ncameras*6 + j*3;
+        p[0] = rng.uniform(-2., ncameras + 1.); p[1] = rng.uniform(-3., 3.); p[2] = rng.uniform(-1., 1.);
+    }
+
+    Ptr<SparseLMSolver> solver = SparseLMSolver::create(cb, criteria);
+    for (int i = 0; i < ncameras; i++)
+        solver->addParamBlock(6);
+    for (int j = 0; j < npoints; j++)
+        solver->addParamBlock(3, true);
+
+    for (int i = 0; i < ncameras; i++)
+        for (int j = 0; j < npoints; j++)
+        {
+            double px = gt.at<double>(ncameras*6 + j*3);
+            if (std::abs(px - i) > 5)
+                continue;
+            cb->observations.push_back(Point(i, j));
+            Mat proj;
+            Mat K = (Mat_<double>(3, 3) << f, 0, 0, 0, f, 0, 0, 0, 1);
+            projectPoints(gt.rowRange(ncameras*6 + j*3, ncameras*6 + j*3 + 3).reshape(3, 1),
+                          gt.rowRange(i*6, i*6 + 3), gt.rowRange(i*6 + 3, i*6 + 6), K, noArray(), proj);
+            cb->points2d.push_back(proj.at<Point2d>(0));
+            solver->addResidualBlock(2, std::vector<int>{ i, ncameras + j });
+        }
+
+    // the gauge: the first camera and the scale (x of the second camera) are fixed
+    mask.create(nparams, 1, CV_8U);
+    mask.setTo(Scalar(1));
+    mask.rowRange(0, 6).setTo(Scalar(0));
+    mask.at<uchar>(9) = 0;
+    solver->setParamMask(mask);
+    return solver;
+}
+
+static void testBundleAdjustment(int ncameras, int npoints)
+{
+    Ptr<BundleAdjustmentCallback> cb;
+    Mat gt, mask;
+    Ptr<SparseLMSolver> solver = makeBundleAdjustment(ncameras, npoints,
+        TermCriteria(TermCriteria::COUNT + TermCriteria::EPS, 100, DBL_EPSILON), cb, gt, mask);
+
+    RNG& rng = theRNG();
+    int nparams = gt.rows;
+    Mat param = gt.clone(), noise(nparams, 1, CV_64F);
+    rng.fill(noise, RNG::UNIFORM, -0.02, 0.02);
+    noise.setTo(Scalar(0), mask == 0);
+    param += noise;
+
+    int iters = solver->run(param);
+    EXPECT_GT(iters, 0);
+    EXPECT_LE(cvtest::norm(param, gt, NORM_INF), 1e-6);
+}
+
+TEST(Calib3d_SparseLMSolver, bundle_adjustment_dense_reduced)
+{
+    testBundleAdjustment(8, 100);
+}
+
+TEST(Calib3d_SparseLMSolver, bundle_adjustment_pcg)
+{
+    // 300 kept parameters: the reduced system is solved with PCG
+    testBundleAdjustment(50, 400);
+}
+
+TEST(Calib3d_SparseLMSolver, same_steps_as_CvLevMarq)
+{
+    const int ncameras = 4, npoints = 30, niters = 3;
+    Ptr<BundleAdjustmentCallback> cb;
+    Mat gt, mask;
+    Ptr<SparseLMSolver> solver = makeBundleAdjustment(ncameras, npoints,
+        TermCriteria(TermCriteria::COUNT, niters, 0), cb, gt, mask);
+
+    int nparams = gt.rows, nerrs = (int)cb->observations.size()*2;
+    Mat param0 = gt.clone(), noise(nparams, 1, CV_64F);
+    theRNG().fill(noise, RNG::UNIFORM, -0.1, 0.1);
+    noise.setTo(Scalar(0), mask == 0);
+    param0 += noise;
+
+    // the dense Jacobian of all the residual blocks for CvLevMarq
+    CvLevMarq levmarq(nparams, nerrs, cvTermCriteria(CV_TERMCRIT_ITER, niters, 0));
+    Mat(param0).copyTo(cvarrToMat(levmarq.param));
+    mask.copyTo(cvarrToMat(levmarq.mask));
+    for (;;)
+    {
+        const CvMat* _param = 0;
+        CvMat *_J = 0, *_err = 0;
+        if (!levmarq.update(_param, _J, _err))
+            break;
+        Mat p = cvarrToMat(_param);
+        if (_J)
+            cvarrToMat(_J).setTo(Scalar(0));
+        for (size_t r = 0; r < cb->observations.size(); r++)
+        {
+            Mat e, Jr;
+            if (_J)
+                cb->compute((int)r, p, e, Jr);
+            else
+                cb->compute((int)r, p, e, noArray());
+            if (_err)
+                e.copyTo(cvarrToMat(_err).rowRange((int)r*2, (int)r*2 + 2));
+            if (_J)
+            {
+                Mat J = cvarrToMat(_J).rowRange((int)r*2, (int)r*2 + 2);
+                int cam = cb->observations[r].x, pt = cb->observations[r].y;
+                Jr.colRange(0, 6).copyTo(J.colRange(cam*6, cam*6 + 6));
+                Jr.colRange(6, 9).copyTo(J.colRange(ncameras*6 + pt*3, ncameras*6 + pt*3 + 3));
+            }
+        }
+    }
+
+    Mat param = param0.clone();
+    EXPECT_EQ(niters, solver->run(param));
+    EXPECT_LE(cvtest::norm(param, cvarrToMat(levmarq.param), NORM_INF), 1e-9);
+    EXPECT_GT(cvtest::norm(param, param0, NORM_INF), 1e-3);
+}
+
+TEST(Calib3d_SparseLMSolver, fixed_and_unobserved_params)
+{
+    // a line fit y = a*x + b split into residual blocks; c is not observed, b is fixed
+    class LineCallback : public SparseLMSolver::Callback
+    {
+    public:
+        bool compute(int block, InputArray _param, OutputArray err, OutputArray J) const CV_OVERRIDE
+        {
+            const double* p = _param.getMat().ptr<double>();
+            double x = block;
+            err.create(1, 1, CV_64F);
+            err.getMat().at<double>(0) = p[0]*x + p[1] - (2*x + 1);
+            if (J.needed())
+            {
+                J.create(1, 3, CV_64F);
+                Mat Jm = J.getMat();
+                Jm.at<double>(0) = x; Jm.at<double>(1) = 1; Jm.at<double>(2) = 0;
+            }
+            return true;
+        }
+    };
+
+    Ptr<SparseLMSolver> solver = SparseLMSolver::create(makePtr<LineCallback>());
+    solver->addParamBlock(3);
+    for (int i = 0; i < 10; i++)
+        solver->addResidualBlock(1, std::vector<int>(1, 0));
+    Mat mask = (Mat_<uchar>(3, 1) << 1, 0, 1);
+    solver->setParamMask(mask);
+
+    Mat param = (Mat_<double>(3, 1) << 0, 1, 5);
+    EXPECT_GT(solver->run(param), 0);
+    EXPECT_NEAR(param.at<double>(0), 2, 1e-9);
+    EXPECT_EQ(param.at<double>(1), 1);
+    EXPECT_EQ(param.at<double>(2), 5);
+}
+
+}} // namespace
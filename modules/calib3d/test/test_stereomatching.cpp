@@ -895,4 +895,127 @@ TEST(Calib3d_StereoSGBM_HH4, regression)
     CV_Assert( countNonZero(diff)==0);
 }
 
+
+static void makeSyntheticStereoPair(Size sz, Mat& left, Mat& right, Mat& gtDisp)
+{
+    RNG rng(12345);
+    const int maxDisp = 32;
+    Mat tex(sz.height, sz.width + maxDisp, CV_8U);
+    rng.fill(tex, RNG::UNIFORM, 0, 256);
+    GaussianBlur(tex, tex, Size(3, 3), 0);
+
+    // the upper half of the scene is farther away than the lower one
+    left = tex.colRange(0, sz.width).clone();
+    right.create(sz, CV_8U);
+    gtDisp.create(sz, CV_16S);
+    for (int y = 0; y < sz.height; y++)
+    {
+        int d = y < sz.height / 2 ? 12 : 24;
+        tex.row(y).colRange(d, d + sz.width).copyTo(right.row(y));
+        gtDisp.row(y).setTo(d * StereoMatcher::DISP_SCALE);
+    }
+}
+
+typedef testing::TestWithParam<int> Calib3d_StereoSGBM_Banded;
+
+TEST_P(Calib3d_StereoSGBM_Banded, close_to_full_image)
+{
+    const int mode = GetParam();
+    Mat left, right, gtDisp;
+    makeSyntheticStereoPair(Size(320, 240), left, right, gtDisp);
+
+    Ptr<StereoSGBM> sgbm = StereoSGBM::create(0, 48, 5, 200, 800, 1, 63, 10, 0, 0, mode);
+    Mat fullDisp, bandDisp;
+    sgbm->compute(left, right, fullDisp);
+
+    // smallest possible bands
+    sgbm->setBandMemoryLimit(1);
+    EXPECT_EQ((size_t)1, sgbm->getBandMemoryLimit());
+    sgbm->compute(left, right, bandDisp);
+    ASSERT_EQ(CV_16S, bandDisp.type());
+    ASSERT_EQ(left.size(), bandDisp.size());
+
+    Rect inner(64, 8, left.cols - 72, left.rows - 16);
+    Mat diff;
+    absdiff(fullDisp(inner), bandDisp(inner), diff);
+    EXPECT_LE(countNonZero(diff > StereoMatcher::DISP_SCALE), inner.area() / 100);
+    absdiff(gtDisp(inner), bandDisp(inner), diff);
+    EXPECT_LE(countNonZero(diff > StereoMatcher::DISP_SCALE), inner.area() / 20);
+
+    // the band layout does not depend on the number of threads
+    int nthreads = getNumThreads();
+    setNumThreads(1);
+    Mat serialDisp;
+    sgbm->compute(left, right, serialDisp);
+    setNumThreads(nthreads);
+    EXPECT_EQ(0, cvtest::norm(bandDisp, serialDisp, NORM_INF));
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Calib3d_StereoSGBM_Banded,
+                        testing::Values((int)StereoSGBM::MODE_SGBM, (int)StereoSGBM::MODE_HH, (int)StereoSGBM::MODE_HH4));
+
+TEST(Calib3d_StereoSGBM, band_memory_limit_read_write)
+{
+    Ptr<StereoSGBM> sgbm = StereoSGBM::create(0, 48, 5);
+    sgbm->setBandMemoryLimit((size_t)3 << 30);
+    FileStorage fs("sgbm.yml", FileStorage::WRITE + FileStorage::MEMORY);
+    sgbm->write(fs);
+    std::string str = fs.releaseAndGetString();
+
+    Ptr<StereoSGBM> loaded = StereoSGBM::create();
+    FileStorage fs_read(str, FileStorage::READ + FileStorage::MEMORY);
+    loaded->read(fs_read.root());
+    EXPECT_EQ(sgbm->getBandMemoryLimit(), loaded->getBandMemoryLimit());
+    EXPECT_EQ(48, loaded->getNumDisparities());
+}
+
+
+typedef testing::TestWithParam<int> Calib3d_StereoBMPipeline;
+
+TEST_P(Calib3d_StereoBMPipeline, same_as_remap_and_compute)
+{
+    // odd height to check the row pairing of the x-Sobel prefilter
+    Size sz(320, 237);
+    Mat left, right, gtDisp;
+    makeSyntheticStereoPair(sz, left, right, gtDisp);
+
+    Mat K = (Mat_<double>(3, 3) << 300, 0, 160, 0, 300, 118, 0, 0, 1);
+    Mat D1 = (Mat_<double>(1, 5) << 0.05, -0.02, 0, 0, 0);
+    Mat D2 = (Mat_<double>(1, 5) << -0.03, 0.01, 0, 0, 0);
+    Mat R, T = (Mat_<double>(3, 1) << -0.1, 0.002, 0.001);
+    cv::Rodrigues(Vec3d(0.01, -0.02, 0.005), R);
+
+    Ptr<StereoBM> bm = StereoBM::create(48, 9);
+    bm->setPreFilterType(GetParam());
+    Ptr<StereoBMPipeline> pipeline = StereoBMPipeline::create(bm);
+    Mat T0 = (Mat_<double>(3, 1) << -0.1, 0, 0);
+    pipeline->addRig(K, D1, K, D2, sz, Mat::eye(3, 3, CV_64F), T0);
+    int rig = pipeline->addRig(K, D1, K, D2, sz, R, T);
+    ASSERT_EQ(2, pipeline->getRigCount());
+    ASSERT_EQ(bm, pipeline->getMatcher());
+
+    Mat disp, rectLeft, rectRight;
+    pipeline->compute(rig, left, right, disp, rectLeft, rectRight);
+
+    Mat R1, R2, P1, P2, Q, map1, map2, refLeft, refRight, refDisp;
+    pipeline->getRectification(rig, R1, R2, P1, P2, Q);
+    initUndistortRectifyMap(K, D1, R1, P1, sz, CV_16SC2, map1, map2);
+    remap(left, refLeft, map1, map2, INTER_LINEAR);
+    initUndistortRectifyMap(K, D2, R2, P2, sz, CV_16SC2, map1, map2);
+    remap(right, refRight, map1, map2, INTER_LINEAR);
+    EXPECT_EQ(0, cvtest::norm(refLeft, rectLeft, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(refRight, rectRight, NORM_INF));
+
+    // the pipeline has set the valid ROIs of the rig to the matcher
+    bm->compute(refLeft, refRight, refDisp);
+    EXPECT_EQ(0, cvtest::norm(refDisp, disp, NORM_INF));
+
+    Mat disp2;
+    pipeline->compute(rig, left, right, disp2);
+    EXPECT_EQ(0, cvtest::norm(disp, disp2, NORM_INF));
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Calib3d_StereoBMPipeline,
+                        testing::Values((int)StereoBM::PREFILTER_XSOBEL, (int)StereoBM::PREFILTER_NORMALIZED_RESPONSE));
+
 }} // namespace
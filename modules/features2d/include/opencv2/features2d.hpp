@@ -136,6 +136,10 @@ public:
 /************************************ Base Classes ************************************/
 
 /** @brief Abstract base class for 2D image feature detectors and descriptor extractors
+
+The image set variants of detect, compute and detectAndCompute call the single image variants for the
+images one by one. The built-in detectors that support concurrent calls on one object, ORB, AKAZE,
+BRISK, FastFeatureDetector and GFTTDetector, process the images of a set concurrently instead.
 */
 class CV_EXPORTS_W Feature2D : public virtual Algorithm
 {
@@ -200,6 +204,25 @@ public:
                                            OutputArray descriptors,
                                            bool useProvidedKeypoints=false );
 
+    /** @overload
+
+    Detects keypoints and computes the descriptors for an image set.
+
+    @param images Image set.
+    @param masks Masks for each input image specifying where to look for keypoints (optional).
+    masks[i] is a mask for images[i].
+    @param keypoints The detected keypoints. keypoints[i] is a set of keypoints detected in images[i] .
+    If useProvidedKeypoints is true, keypoints[i] are the input keypoints for images[i] .
+    @param descriptors Computed descriptors, descriptors[i] are descriptors computed for keypoints[i] .
+    @param useProvidedKeypoints If true, the keypoints are not detected but only used as an input.
+
+    The outputs are allocated once for the whole set and every image writes its results in place.
+    */
+    CV_WRAP void detectAndCompute( InputArrayOfArrays images, InputArrayOfArrays masks,
+                                   CV_OUT std::vector<std::vector<KeyPoint> >& keypoints,
+                                   OutputArrayOfArrays descriptors,
+                                   bool useProvidedKeypoints=false );
+
     CV_WRAP virtual int descriptorSize() const;
     CV_WRAP virtual int descriptorType() const;
     CV_WRAP virtual int defaultNorm() const;
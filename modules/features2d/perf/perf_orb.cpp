@@ -0,0 +1,39 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+#include "opencv2/imgproc.hpp"
+
+namespace opencv_test
+{
+using namespace perf;
+
+typedef tuple<Size, int> Size_NFeatures_t;
+typedef perf::TestBaseWithParam<Size_NFeatures_t> Size_NFeatures;
+
+PERF_TEST_P(Size_NFeatures, ORB_detectAndCompute,
+            testing::Combine(testing::Values(sz1080p, Size(3840, 2160)),
+                             testing::Values(500, 5000)))
+{
+    Size sz = get<0>(GetParam());
+    int nfeatures = get<1>(GetParam());
+
+    Mat src = imread(getDataPath("stitching/a3.png"), IMREAD_GRAYSCALE);
+    ASSERT_FALSE(src.empty());
+    Mat img;
+    resize(src, img, sz, 0, 0, INTER_LINEAR_EXACT);
+
+    Ptr<ORB> orb = ORB::create(nfeatures);
+    declare.in(img);
+    vector<KeyPoint> points;
+    Mat descriptors;
+
+    TEST_CYCLE() orb->detectAndCompute(img, noArray(), points, descriptors, false);
+
+    EXPECT_GT(points.size(), 20u);
+    EXPECT_EQ((size_t)descriptors.rows, points.size());
+    SANITY_CHECK_NOTHING();
+}
+
+} // namespace
@@ -57,7 +57,7 @@ namespace cv
 {
     using namespace std;
 
-    class AKAZE_Impl : public AKAZE
+    class AKAZE_Impl : public AKAZE, public ReentrantFeature2D
     {
     public:
         AKAZE_Impl(int _descriptor_type, int _descriptor_size, int _descriptor_channels,
@@ -182,7 +182,11 @@ namespace cv
             options.nsublevels = sublevels;
             options.diffusivity = diffusivity;
 
-            AKAZEFeatures impl(options);
+            // reuse the scale space of the previous call, unless another thread is using it;
+            // concurrent calls build their own scale space, which is released when they return
+            std::unique_lock<Mutex> scaleSpaceLock(scaleSpaceMutex, std::try_to_lock);
+            AKAZEScaleSpaceBuffers localBuffers;
+            AKAZEFeatures impl(options, scaleSpaceLock.owns_lock() ? scaleSpaceBuffers : localBuffers);
             impl.Create_Nonlinear_Scale_Space(image);
 
             if (!useProvidedKeypoints)
@@ -234,6 +238,9 @@ namespace cv
         int octaves;
         int sublevels;
         int diffusivity;
+        // scale space reused by the next image of the same size
+        AKAZEScaleSpaceBuffers scaleSpaceBuffers;
+        Mutex scaleSpaceMutex;
     };
 
     Ptr<AKAZE> AKAZE::create(int descriptor_type,
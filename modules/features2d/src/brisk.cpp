@@ -51,7 +51,7 @@
 namespace cv
 {
 
-class BRISK_Impl CV_FINAL : public BRISK
+class BRISK_Impl CV_FINAL : public BRISK, public ReentrantFeature2D
 {
 public:
     explicit BRISK_Impl(int thresh=30, int octaves=3, float patternScale=1.0f);
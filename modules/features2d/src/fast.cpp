@@ -511,7 +511,7 @@ void FAST(InputArray _img, std::vector<KeyPoint>& keypoints, int threshold, bool
 }
 
 
-class FastFeatureDetector_Impl CV_FINAL : public FastFeatureDetector
+class FastFeatureDetector_Impl CV_FINAL : public FastFeatureDetector, public ReentrantFeature2D
 {
 public:
     FastFeatureDetector_Impl( int _threshold, bool _nonmaxSuppression, int _type )
@@ -71,29 +71,92 @@ void Feature2D::detect( InputArray image,
 }
 
 
-void Feature2D::detect( InputArrayOfArrays _images,
-                        std::vector<std::vector<KeyPoint> >& keypoints,
-                        InputArrayOfArrays _masks )
+/*
+ * Runs one of the single image methods on every image of a set.
+ * The outputs are allocated by the caller, so every image writes its results in place.
+ */
+class Feature2DBatchInvoker CV_FINAL : public ParallelLoopBody
 {
-    CV_INSTRUMENT_REGION()
+public:
+    enum Mode { DETECT, COMPUTE, DETECT_AND_COMPUTE };
 
-    vector<Mat> images, masks;
+    Feature2DBatchInvoker(Feature2D* _feature2d, Mode _mode, const vector<Mat>& _images,
+                          const vector<Mat>& _masks, vector<vector<KeyPoint> >& _keypoints,
+                          vector<Mat>* _descriptors, bool _useProvidedKeypoints) :
+        feature2d(_feature2d), mode(_mode), images(_images), masks(_masks), keypoints(_keypoints),
+        descriptors(_descriptors), useProvidedKeypoints(_useProvidedKeypoints)
+    {}
 
-    _images.getMatVector(images);
-    size_t i, nimages = images.size();
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            Mat mask = masks.empty() ? Mat() : masks[i];
+            if( mode == DETECT )
+                feature2d->detect(images[i], keypoints[i], mask);
+            else if( mode == COMPUTE )
+                feature2d->compute(images[i], keypoints[i], (*descriptors)[i]);
+            else if( descriptors )
+                feature2d->detectAndCompute(images[i], mask, keypoints[i], (*descriptors)[i], useProvidedKeypoints);
+            else
+                feature2d->detectAndCompute(images[i], mask, keypoints[i], noArray(), useProvidedKeypoints);
+        }
+    }
+
+private:
+    Feature2D* feature2d;
+    Mode mode;
+    const vector<Mat>& images;
+    const vector<Mat>& masks;
+    vector<vector<KeyPoint> >& keypoints;
+    vector<Mat>* descriptors;
+    bool useProvidedKeypoints;
+};
+
+// the images are processed concurrently only by the detectors that declare it safe
+static void runBatch(const Feature2D* feature2d, const Feature2DBatchInvoker& body, size_t nimages)
+{
+    if( dynamic_cast<const ReentrantFeature2D*>(feature2d) != NULL )
+        parallel_for_(Range(0, (int)nimages), body);
+    else
+        body(Range(0, (int)nimages));
+}
 
+static void getImageSet(InputArrayOfArrays _images, InputArrayOfArrays _masks,
+                        vector<Mat>& images, vector<Mat>& masks)
+{
+    _images.getMatVector(images);
     if( !_masks.empty() )
     {
         _masks.getMatVector(masks);
-        CV_Assert(masks.size() == nimages);
+        CV_Assert(masks.size() == images.size());
     }
+}
 
-    keypoints.resize(nimages);
+static vector<Mat>* getDescriptorSet(OutputArrayOfArrays _descriptors, size_t nimages)
+{
+    if( !_descriptors.needed() )
+        return NULL;
+    CV_Assert( _descriptors.kind() == _InputArray::STD_VECTOR_MAT );
 
-    for( i = 0; i < nimages; i++ )
-    {
-        detect(images[i], keypoints[i], masks.empty() ? Mat() : masks[i] );
-    }
+    vector<Mat>* descriptors = (vector<Mat>*)_descriptors.getObj();
+    descriptors->resize(nimages);
+    return descriptors;
+}
+
+void Feature2D::detect( InputArrayOfArrays _images,
+                        std::vector<std::vector<KeyPoint> >& keypoints,
+                        InputArrayOfArrays _masks )
+{
+    CV_INSTRUMENT_REGION()
+
+    vector<Mat> images, masks;
+    getImageSet(_images, _masks, images, masks);
+
+    keypoints.resize(images.size());
+
+    runBatch(this, Feature2DBatchInvoker(this, Feature2DBatchInvoker::DETECT, images, masks,
+                                         keypoints, NULL, false), images.size());
 }
 
 /*
@@ -125,23 +188,35 @@ void Feature2D::compute( InputArrayOfArrays _images,
     if( !_descriptors.needed() )
         return;
 
-    vector<Mat> images;
+    vector<Mat> images, masks;
+    getImageSet(_images, noArray(), images, masks);
+
+    CV_Assert( keypoints.size() == images.size() );
+    vector<Mat>* descriptors = getDescriptorSet(_descriptors, images.size());
 
-    _images.getMatVector(images);
-    size_t i, nimages = images.size();
+    runBatch(this, Feature2DBatchInvoker(this, Feature2DBatchInvoker::COMPUTE, images, masks,
+                                         keypoints, descriptors, true), images.size());
+}
 
-    CV_Assert( keypoints.size() == nimages );
-    CV_Assert( _descriptors.kind() == _InputArray::STD_VECTOR_MAT );
+void Feature2D::detectAndCompute( InputArrayOfArrays _images, InputArrayOfArrays _masks,
+                                  std::vector<std::vector<KeyPoint> >& keypoints,
+                                  OutputArrayOfArrays _descriptors,
+                                  bool useProvidedKeypoints )
+{
+    CV_INSTRUMENT_REGION()
 
-    vector<Mat>& descriptors = *(vector<Mat>*)_descriptors.getObj();
-    descriptors.resize(nimages);
+    vector<Mat> images, masks;
+    getImageSet(_images, _masks, images, masks);
 
-    for( i = 0; i < nimages; i++ )
-    {
-        compute(images[i], keypoints[i], descriptors[i]);
-    }
-}
+    if( useProvidedKeypoints )
+        CV_Assert( keypoints.size() == images.size() );
+    else
+        keypoints.resize(images.size());
+    vector<Mat>* descriptors = getDescriptorSet(_descriptors, images.size());
 
+    runBatch(this, Feature2DBatchInvoker(this, Feature2DBatchInvoker::DETECT_AND_COMPUTE, images, masks,
+                                         keypoints, descriptors, useProvidedKeypoints), images.size());
+}
 
 /* Detects keypoints and computes the descriptors */
 void Feature2D::detectAndCompute( InputArray, InputArray,
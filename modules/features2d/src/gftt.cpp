@@ -44,7 +44,7 @@
 namespace cv
 {
 
-class GFTTDetector_Impl CV_FINAL : public GFTTDetector
+class GFTTDetector_Impl CV_FINAL : public GFTTDetector, public ReentrantFeature2D
 {
 public:
     GFTTDetector_Impl( int _nfeatures, double _qualityLevel,
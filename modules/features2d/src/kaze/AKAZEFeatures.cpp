@@ -12,6 +12,8 @@
 #include "nldiffusion_functions.h"
 #include "utils.h"
 #include "opencl_kernels_features2d.hpp"
+#include "opencv2/core/hal/hal.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 #include <iostream>
 
@@ -24,9 +26,11 @@ using namespace std;
 /**
  * @brief AKAZEFeatures constructor with input options
  * @param options AKAZEFeatures configuration options
+ * @param buffers Storage of the nonlinear scale space, reused from a previous image when possible
  * @note This constructor allocates memory for the nonlinear scale space
  */
-AKAZEFeatures::AKAZEFeatures(const AKAZEOptions& options) : options_(options) {
+AKAZEFeatures::AKAZEFeatures(const AKAZEOptions& options, AKAZEScaleSpaceBuffers& buffers)
+  : options_(options), evolution_(buffers.evolution), buffers_(buffers) {
 
   ncycles_ = 0;
   reordering_ = true;
@@ -59,6 +63,7 @@ void AKAZEFeatures::Allocate_Memory_Evolution(void) {
   }
 
   // Allocate the dimension of the matrices for the evolution
+  size_t nlevels = 0;
   for (int i = 0, power = 1; i <= options_.omax - 1; i++, power *= 2) {
     rfactor = 1.0f / power;
     level_height = (int)(options_.img_height*rfactor);
@@ -71,7 +76,10 @@ void AKAZEFeatures::Allocate_Memory_Evolution(void) {
     }
 
     for (int j = 0; j < options_.nsublevels; j++) {
-      MEvolution step;
+      // keep the matrices of a previous image, they are reallocated only if the size differs
+      if (nlevels == evolution_.size())
+        evolution_.push_back(MEvolution());
+      MEvolution &step = evolution_[nlevels++];
       step.size = Size(level_width, level_height);
       step.esigma = options_.soffset*pow(2.f, (float)(j) / (float)(options_.nsublevels) + i);
       step.sigma_size = cvRound(step.esigma * options_.derivative_factor / power);  // In fact sigma_size only depends on j
@@ -80,10 +88,9 @@ void AKAZEFeatures::Allocate_Memory_Evolution(void) {
       step.sublevel = j;
       step.octave_ratio = (float)power;
       step.border = cvRound(smax * step.sigma_size) + 1;
-
-      evolution_.push_back(step);
     }
   }
+  evolution_.resize(nlevels);
 
   // Allocate memory for the number of cycles and time steps
   for (size_t i = 1; i < evolution_.size(); i++) {
@@ -117,15 +124,17 @@ static inline int getGaussianKernelSize(float sigma) {
 * @param Lt Base image in the evolution
 * @param Lf Conductivity image
 * @param Lstep Output image that gives the difference between the current
-* Ld and the next Ld being evolved
+* Ld and the next Ld being evolved, or the next Ld itself if accumulate is set
 * @param row_begin row where to start
 * @param row_end last row to fill exclusive. the range is [row_begin, row_end).
+* @param accumulate add the difference to Lt, so that Lt + Lstep is computed in one pass
 * @note Forward Euler Scheme 3x3 stencil
 * The function c is a scalar value that depends on the gradient norm
 * dL_by_ds = d(c dL_by_dx)_by_dx + d(c dL_by_dy)_by_dy
 */
 static inline void
-nld_step_scalar_one_lane(const Mat& Lt, const Mat& Lf, Mat& Lstep, float step_size, int row_begin, int row_end)
+nld_step_scalar_one_lane(const Mat& Lt, const Mat& Lf, Mat& Lstep, float step_size, int row_begin, int row_end,
+                         bool accumulate)
 {
   CV_INSTRUMENT_REGION()
   /* The labeling scheme for this five star stencil:
@@ -152,18 +161,18 @@ nld_step_scalar_one_lane(const Mat& Lt, const Mat& Lf, Mat& Lstep, float step_si
 
     // fill the corner to prevent uninitialized values
     dst = Lstep.ptr<float>(0);
-    dst[0] = 0.0f;
+    dst[0] = accumulate ? lt_c[-1] : 0.0f;
     ++dst;
 
     for (int j = 0; j < cols; j++) {
       step_r = (lf_c[j] + lf_c[j + 1])*(lt_c[j + 1] - lt_c[j]) +
                (lf_c[j] + lf_c[j - 1])*(lt_c[j - 1] - lt_c[j]) +
                (lf_c[j] + lf_b[j    ])*(lt_b[j    ] - lt_c[j]);
-      dst[j] = step_r * step_size;
+      dst[j] = accumulate ? lt_c[j] + step_r * step_size : step_r * step_size;
     }
 
     // fill the corner to prevent uninitialized values
-    dst[cols] = 0.0f;
+    dst[cols] = accumulate ? lt_c[cols] : 0.0f;
     ++row;
   }
 
@@ -183,27 +192,45 @@ nld_step_scalar_one_lane(const Mat& Lt, const Mat& Lf, Mat& Lstep, float step_si
     step_r = (lf_c[0] + lf_c[1])*(lt_c[1] - lt_c[0]) +
              (lf_c[0] + lf_b[0])*(lt_b[0] - lt_c[0]) +
              (lf_c[0] + lf_a[0])*(lt_a[0] - lt_c[0]);
-    dst[0] = step_r * step_size;
+    dst[0] = accumulate ? lt_c[0] + step_r * step_size : step_r * step_size;
 
     lt_a++; lt_c++; lt_b++;
     lf_a++; lf_c++; lf_b++;
     dst++;
 
     // The middle columns
-    for (int j = 0; j < cols; j++)
+    int j = 0;
+#if CV_SIMD128
+    if (hasSIMD128())
+    {
+      // same operation order as the scalar code, results are bit-exact
+      v_float32x4 v_step_size = v_setall_f32(step_size);
+      for (; j <= cols - 4; j += 4)
+      {
+        v_float32x4 v_lf_c = v_load(lf_c + j), v_lt_c = v_load(lt_c + j);
+        v_float32x4 v_step = (v_lf_c + v_load(lf_c + j + 1))*(v_load(lt_c + j + 1) - v_lt_c) +
+                             (v_lf_c + v_load(lf_c + j - 1))*(v_load(lt_c + j - 1) - v_lt_c) +
+                             (v_lf_c + v_load(lf_b + j    ))*(v_load(lt_b + j    ) - v_lt_c) +
+                             (v_lf_c + v_load(lf_a + j    ))*(v_load(lt_a + j    ) - v_lt_c);
+        v_step = v_step * v_step_size;
+        v_store(dst + j, accumulate ? v_lt_c + v_step : v_step);
+      }
+    }
+#endif
+    for (; j < cols; j++)
     {
       step_r = (lf_c[j] + lf_c[j + 1])*(lt_c[j + 1] - lt_c[j]) +
                (lf_c[j] + lf_c[j - 1])*(lt_c[j - 1] - lt_c[j]) +
                (lf_c[j] + lf_b[j    ])*(lt_b[j    ] - lt_c[j]) +
                (lf_c[j] + lf_a[j    ])*(lt_a[j    ] - lt_c[j]);
-      dst[j] = step_r * step_size;
+      dst[j] = accumulate ? lt_c[j] + step_r * step_size : step_r * step_size;
     }
 
     // The right-most column
     step_r = (lf_c[cols] + lf_c[cols - 1])*(lt_c[cols - 1] - lt_c[cols]) +
              (lf_c[cols] + lf_b[cols    ])*(lt_b[cols    ] - lt_c[cols]) +
              (lf_c[cols] + lf_a[cols    ])*(lt_a[cols    ] - lt_c[cols]);
-    dst[cols] = step_r * step_size;
+    dst[cols] = accumulate ? lt_c[cols] + step_r * step_size : step_r * step_size;
   }
 
   // Process the bottom row (row == Lt.rows - 1)
@@ -215,31 +242,31 @@ nld_step_scalar_one_lane(const Mat& Lt, const Mat& Lf, Mat& Lstep, float step_si
 
     // fill the corner to prevent uninitialized values
     dst = Lstep.ptr<float>(row);
-    dst[0] = 0.0f;
+    dst[0] = accumulate ? lt_c[-1] : 0.0f;
     ++dst;
 
     for (int j = 0; j < cols; j++) {
       step_r = (lf_c[j] + lf_c[j + 1])*(lt_c[j + 1] - lt_c[j]) +
                (lf_c[j] + lf_c[j - 1])*(lt_c[j - 1] - lt_c[j]) +
                (lf_c[j] + lf_a[j    ])*(lt_a[j    ] - lt_c[j]);
-      dst[j] = step_r * step_size;
+      dst[j] = accumulate ? lt_c[j] + step_r * step_size : step_r * step_size;
     }
 
     // fill the corner to prevent uninitialized values
-    dst[cols] = 0.0f;
+    dst[cols] = accumulate ? lt_c[cols] : 0.0f;
   }
 }
 
 class NonLinearScalarDiffusionStep : public ParallelLoopBody
 {
 public:
-  NonLinearScalarDiffusionStep(const Mat& Lt, const Mat& Lf, Mat& Lstep, float step_size)
-    : Lt_(&Lt), Lf_(&Lf), Lstep_(&Lstep), step_size_(step_size)
+  NonLinearScalarDiffusionStep(const Mat& Lt, const Mat& Lf, Mat& Lstep, float step_size, bool accumulate = false)
+    : Lt_(&Lt), Lf_(&Lf), Lstep_(&Lstep), step_size_(step_size), accumulate_(accumulate)
   {}
 
   void operator()(const Range& range) const CV_OVERRIDE
   {
-    nld_step_scalar_one_lane(*Lt_, *Lf_, *Lstep_, step_size_, range.start, range.end);
+    nld_step_scalar_one_lane(*Lt_, *Lf_, *Lstep_, step_size_, range.start, range.end, accumulate_);
   }
 
 private:
@@ -247,6 +274,7 @@ private:
   const Mat* Lf_;
   Mat* Lstep_;
   float step_size_;
+  bool accumulate_;
 };
 
 #ifdef HAVE_OPENCL
@@ -290,6 +318,32 @@ non_linear_diffusion_step(InputArray Lt_, InputArray Lf_, OutputArray Lstep_, fl
   parallel_for_(Range(0, Lt.rows), NonLinearScalarDiffusionStep(Lt, Lf, Lstep, step_size));
 }
 
+/**
+ * @brief Performs one explicit diffusion step, Lt = Lt + Lstep
+ * @details OCL version, computes the step and adds it in two passes
+ */
+static inline void
+fed_step(UMat& Lt, const UMat& Lf, UMat& Lstep, float step_size)
+{
+  non_linear_diffusion_step(Lt, Lf, Lstep, step_size);
+  add(Lt, Lstep, Lt);
+}
+
+/**
+ * @brief Performs one explicit diffusion step, Lt = Lt + Lstep
+ * @details CPU version, the evolved image is written to Lnext in a single pass
+ * and swapped with Lt, so Lt and Lnext exchange their buffers
+ */
+static inline void
+fed_step(Mat& Lt, const Mat& Lf, Mat& Lnext, float step_size)
+{
+  CV_INSTRUMENT_REGION()
+
+  Lnext.create(Lt.size(), Lt.type());
+  parallel_for_(Range(0, Lt.rows), NonLinearScalarDiffusionStep(Lt, Lf, Lnext, step_size, true));
+  std::swap(Lt, Lnext);
+}
+
 /**
  * @brief This function computes a good empirical value for the k contrast factor
  * given two gradient images, the percentile (0-1), the temporal storage to hold
@@ -403,6 +457,161 @@ compute_diffusivity(InputArray Lx, InputArray Ly, OutputArray Lflow, float kcont
   }
 }
 
+/**
+ * @brief Computes Scharr derivatives and the conductivity image in one pass
+ * @details Lx and Ly are evaluated row by row with the same separable kernels
+ * and BORDER_REFLECT_101 as cv::Scharr, and are consumed immediately by the
+ * diffusivity function, so the derivative images are never written to memory
+ */
+class NonLinearDiffusivity : public ParallelLoopBody
+{
+public:
+  NonLinearDiffusivity(const Mat& Lsmooth, Mat& Lflow, float kcontrast, int diffusivity)
+    : Lsmooth_(&Lsmooth), Lflow_(&Lflow), kcontrast_(kcontrast), diffusivity_(diffusivity)
+  {}
+
+  void operator()(const Range& range) const CV_OVERRIDE
+  {
+    const Mat& src = *Lsmooth_;
+    const int cols = src.cols;
+    AutoBuffer<float> buf(cols * 2);
+    float *lx = buf.data(), *ly = lx + cols;
+
+    for (int y = range.start; y < range.end; y++)
+    {
+      const float *a = src.ptr<float>(borderInterpolate(y - 1, src.rows, BORDER_REFLECT_101));
+      const float *c = src.ptr<float>(y);
+      const float *b = src.ptr<float>(borderInterpolate(y + 1, src.rows, BORDER_REFLECT_101));
+
+      // border columns
+      scharr(a, c, b, 0, borderInterpolate(-1, cols, BORDER_REFLECT_101),
+             borderInterpolate(1, cols, BORDER_REFLECT_101), lx, ly);
+      if (cols > 1)
+        scharr(a, c, b, cols - 1, cols - 2, borderInterpolate(cols, cols, BORDER_REFLECT_101), lx, ly);
+
+      int x = 1;
+#if CV_SIMD128
+      if (hasSIMD128())
+      {
+        v_float32x4 v3 = v_setall_f32(3.f), v10 = v_setall_f32(10.f);
+        for (; x <= cols - 5; x += 4)
+        {
+          v_float32x4 a_l = v_load(a + x - 1), a_c = v_load(a + x), a_r = v_load(a + x + 1);
+          v_float32x4 c_l = v_load(c + x - 1), c_r = v_load(c + x + 1);
+          v_float32x4 b_l = v_load(b + x - 1), b_c = v_load(b + x), b_r = v_load(b + x + 1);
+          v_store(lx + x, ((a_r - a_l) + (b_r - b_l)) * v3 + (c_r - c_l) * v10);
+          v_store(ly + x, ((b_l + b_r) * v3 + b_c * v10) - ((a_l + a_r) * v3 + a_c * v10));
+        }
+      }
+#endif
+      for (; x < cols - 1; x++)
+        scharr(a, c, b, x, x - 1, x + 1, lx, ly);
+
+      conductivity(lx, ly, Lflow_->ptr<float>(y), cols);
+    }
+  }
+
+private:
+  static inline void scharr(const float* a, const float* c, const float* b, int x, int xl, int xr,
+                            float* lx, float* ly)
+  {
+    lx[x] = ((a[xr] - a[xl]) + (b[xr] - b[xl])) * 3.f + (c[xr] - c[xl]) * 10.f;
+    ly[x] = ((b[xl] + b[xr]) * 3.f + b[x] * 10.f) - ((a[xl] + a[xr]) * 3.f + a[x] * 10.f);
+  }
+
+  /// Same formulas as pm_g1, pm_g2, weickert_diffusivity and charbonnier_diffusivity
+  void conductivity(const float* lx, const float* ly, float* dst, int n) const
+  {
+    const float inv_k = 1.0f / (kcontrast_ * kcontrast_);
+    int x = 0;
+    switch (diffusivity_) {
+      case KAZE::DIFF_PM_G1:
+        for (; x < n; x++)
+          dst[x] = -inv_k * (lx[x] * lx[x] + ly[x] * ly[x]);
+        hal::exp32f(dst, dst, n);
+      break;
+      case KAZE::DIFF_PM_G2:
+#if CV_SIMD128
+        if (hasSIMD128())
+        {
+          v_float32x4 v_inv_k = v_setall_f32(inv_k), v_one = v_setall_f32(1.0f);
+          for (; x <= n - 4; x += 4)
+          {
+            v_float32x4 v_lx = v_load(lx + x), v_ly = v_load(ly + x);
+            v_store(dst + x, v_one / (v_one + ((v_lx * v_lx + v_ly * v_ly) * v_inv_k)));
+          }
+        }
+#endif
+        for (; x < n; x++)
+          dst[x] = 1.0f / (1.0f + ((lx[x] * lx[x] + ly[x] * ly[x]) * inv_k));
+      break;
+      case KAZE::DIFF_WEICKERT:
+        for (; x < n; x++) {
+          float dL = inv_k * (lx[x] * lx[x] + ly[x] * ly[x]);
+          dst[x] = -3.315f / (dL * dL * dL * dL);
+        }
+        hal::exp32f(dst, dst, n);
+        for (x = 0; x < n; x++)
+          dst[x] = 1.0f - dst[x];
+      break;
+      case KAZE::DIFF_CHARBONNIER:
+#if CV_SIMD128
+        if (hasSIMD128())
+        {
+          v_float32x4 v_inv_k = v_setall_f32(inv_k), v_one = v_setall_f32(1.0f);
+          for (; x <= n - 4; x += 4)
+          {
+            v_float32x4 v_lx = v_load(lx + x), v_ly = v_load(ly + x);
+            v_store(dst + x, v_one / v_sqrt(v_one + v_inv_k * (v_lx * v_lx + v_ly * v_ly)));
+          }
+        }
+#endif
+        for (; x < n; x++)
+          dst[x] = 1.0f / std::sqrt(1.0f + inv_k * (lx[x] * lx[x] + ly[x] * ly[x]));
+      break;
+      default:
+        CV_Error(diffusivity_, "Diffusivity is not supported");
+      break;
+    }
+  }
+
+  const Mat* Lsmooth_;
+  Mat* Lflow_;
+  float kcontrast_;
+  int diffusivity_;
+};
+
+/**
+ * @brief Computes the conductivity image of the smoothed level
+ * @details OCL version, Lx and Ly are used as temporary derivative images
+ */
+static inline void
+compute_flow(const UMat& Lsmooth, UMat& Lx, UMat& Ly, UMat& Lflow, float kcontrast, int diffusivity)
+{
+  Scharr(Lsmooth, Lx, CV_32F, 1, 0, 1.0, 0, BORDER_DEFAULT);
+  Scharr(Lsmooth, Ly, CV_32F, 0, 1, 1.0, 0, BORDER_DEFAULT);
+  compute_diffusivity(Lx, Ly, Lflow, kcontrast, diffusivity);
+}
+
+/**
+ * @brief Computes the conductivity image of the smoothed level
+ * @details CPU version, derivatives and diffusivity are fused in one parallel pass
+ */
+void
+compute_fused_flow(const Mat& Lsmooth, Mat& Lflow, float kcontrast, int diffusivity)
+{
+  CV_INSTRUMENT_REGION()
+
+  Lflow.create(Lsmooth.size(), CV_32F);
+  parallel_for_(Range(0, Lsmooth.rows), NonLinearDiffusivity(Lsmooth, Lflow, kcontrast, diffusivity));
+}
+
+static inline void
+compute_flow(const Mat& Lsmooth, Mat& /*Lx*/, Mat& /*Ly*/, Mat& Lflow, float kcontrast, int diffusivity)
+{
+  compute_fused_flow(Lsmooth, Lflow, kcontrast, diffusivity);
+}
+
 /**
  * @brief Converts input image to grayscale float image
  *
@@ -430,7 +639,8 @@ static inline void prepareInputImage(InputArray image, OutputArray dst)
 template<typename MatType>
 static inline void
 create_nonlinear_scale_space(InputArray image, const AKAZEOptions &options,
-  const std::vector<std::vector<float > > &tsteps_evolution, std::vector<Evolution<MatType> > &evolution)
+  const std::vector<std::vector<float > > &tsteps_evolution, std::vector<Evolution<MatType> > &evolution,
+  MatType &Lflow, MatType &Lstep)
 {
   CV_INSTRUMENT_REGION()
   CV_Assert(evolution.size() > 0);
@@ -450,8 +660,8 @@ create_nonlinear_scale_space(InputArray image, const AKAZEOptions &options,
     return;
   }
 
-  // derivatives, flow and diffusion step
-  MatType Lx, Ly, Lsmooth, Lflow, Lstep;
+  // derivatives
+  MatType Lx, Ly, Lsmooth;
 
   // compute derivatives for computing k contrast
   GaussianBlur(img, Lsmooth, Size(5, 5), 1.0f, 1.0f, BORDER_REPLICATE);
@@ -476,19 +686,13 @@ create_nonlinear_scale_space(InputArray image, const AKAZEOptions &options,
 
     GaussianBlur(e.Lt, e.Lsmooth, Size(5, 5), 1.0f, 1.0f, BORDER_REPLICATE);
 
-    // Compute the Gaussian derivatives Lx and Ly
-    Scharr(e.Lsmooth, Lx, CV_32F, 1, 0, 1.0, 0, BORDER_DEFAULT);
-    Scharr(e.Lsmooth, Ly, CV_32F, 0, 1, 1.0, 0, BORDER_DEFAULT);
-
-    // Compute the conductivity equation
-    compute_diffusivity(Lx, Ly, Lflow, kcontrast, options.diffusivity);
+    // Compute the Gaussian derivatives Lx, Ly and the conductivity equation
+    compute_flow(e.Lsmooth, Lx, Ly, Lflow, kcontrast, options.diffusivity);
 
     // Perform Fast Explicit Diffusion on Lt
     const std::vector<float> &tsteps = tsteps_evolution[i - 1];
     for (size_t j = 0; j < tsteps.size(); j++) {
-      const float step_size = tsteps[j] * 0.5f;
-      non_linear_diffusion_step(e.Lt, Lflow, Lstep, step_size);
-      add(e.Lt, Lstep, e.Lt);
+      fed_step(e.Lt, Lflow, Lstep, tsteps[j] * 0.5f);
     }
   }
 
@@ -523,14 +727,19 @@ void AKAZEFeatures::Create_Nonlinear_Scale_Space(InputArray image)
   if (ocl::isOpenCLActivated() && image.isUMat()) {
     // will run OCL version of scale space pyramid
     UMatPyramid uPyr;
-    // init UMat pyramid with sizes
+    UMat Lflow, Lstep;
+    // init UMat pyramid with sizes, the buffers of a previous image are not uploaded
+    for (size_t i = 0; i < evolution_.size(); ++i) {
+      MEvolution &e = evolution_[i];
+      e.Lx.release(); e.Ly.release(); e.Lt.release(); e.Lsmooth.release(); e.Ldet.release();
+    }
     convertScalePyramid(evolution_, uPyr);
-    create_nonlinear_scale_space(image, options_, tsteps_, uPyr);
+    create_nonlinear_scale_space(image, options_, tsteps_, uPyr, Lflow, Lstep);
     // download pyramid from GPU
     convertScalePyramid(uPyr, evolution_);
   } else {
     // CPU version
-    create_nonlinear_scale_space(image, options_, tsteps_, evolution_);
+    create_nonlinear_scale_space(image, options_, tsteps_, evolution_, buffers_.Lflow, buffers_.Lstep);
   }
 }
 
@@ -588,7 +797,17 @@ static inline void compute_determinant(InputArray Lxx_, InputArray Lxy_, InputAr
   float *lyy = Lyy.ptr<float>();
   float *ldet = Ldet.ptr<float>();
   const int total = Lxx.cols * Lxx.rows;
-  for (int j = 0; j < total; j++) {
+  int j = 0;
+#if CV_SIMD128
+  if (hasSIMD128()) {
+    v_float32x4 v_sigma = v_setall_f32(sigma);
+    for (; j <= total - 4; j += 4) {
+      v_float32x4 v_lxy = v_load(lxy + j);
+      v_store(ldet + j, (v_load(lxx + j) * v_load(lyy + j) - v_lxy * v_lxy) * v_sigma);
+    }
+  }
+#endif
+  for (; j < total; j++) {
     ldet[j] = (lxx[j] * lyy[j] - lxy[j] * lxy[j]) * sigma;
   }
 
@@ -50,7 +50,7 @@ struct Evolution
 
   MatType Lx, Ly;           ///< First order spatial derivatives
   MatType Lt;               ///< Evolution image
-  MatType Lsmooth;          ///< Smoothed image, used only for computing determinant, released afterwards
+  MatType Lsmooth;          ///< Smoothed image, used only for computing determinant
   MatType Ldet;             ///< Detector response
 
   Size size;                ///< Size of the layer
@@ -68,6 +68,14 @@ typedef Evolution<UMat> UEvolution;
 typedef std::vector<MEvolution> Pyramid;
 typedef std::vector<UEvolution> UMatPyramid;
 
+/// Storage of the nonlinear scale space, kept between images to reuse the allocated levels
+struct AKAZEScaleSpaceBuffers
+{
+  Pyramid evolution;        ///< Vector of nonlinear diffusion evolution
+  Mat Lflow;                ///< Conductivity image of the level being evolved
+  Mat Lstep;                ///< Second buffer of the explicit diffusion steps
+};
+
 /* ************************************************************************* */
 // AKAZE Class Declaration
 class AKAZEFeatures {
@@ -75,7 +83,8 @@ class AKAZEFeatures {
 private:
 
   AKAZEOptions options_;                ///< Configuration options for AKAZE
-  Pyramid evolution_;        ///< Vector of nonlinear diffusion evolution
+  Pyramid& evolution_;       ///< Vector of nonlinear diffusion evolution
+  AKAZEScaleSpaceBuffers& buffers_;     ///< Storage of the nonlinear scale space
 
   /// FED parameters
   int ncycles_;                  ///< Number of cycles
@@ -99,7 +108,7 @@ private:
 
 public:
   /// Constructor with input arguments
-  AKAZEFeatures(const AKAZEOptions& options);
+  AKAZEFeatures(const AKAZEOptions& options, AKAZEScaleSpaceBuffers& buffers);
   void Create_Nonlinear_Scale_Space(InputArray img);
   void Feature_Detection(std::vector<cv::KeyPoint>& kpts);
   void Compute_Descriptors(std::vector<cv::KeyPoint>& kpts, OutputArray desc);
@@ -110,6 +119,10 @@ public:
 void generateDescriptorSubsample(cv::Mat& sampleList, cv::Mat& comparisons,
                                  int nbits, int pattern_size, int nchannels);
 
+/// Computes the conductivity image of a smoothed level with the fused Scharr derivatives,
+/// exported for the accuracy tests
+CV_EXPORTS void compute_fused_flow(const Mat& Lsmooth, Mat& Lflow, float kcontrast, int diffusivity);
+
 }
 
 #endif
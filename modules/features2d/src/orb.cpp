@@ -36,6 +36,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_features2d.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 #include <iterator>
 
 #ifndef CV_IMPL_ADD
@@ -48,6 +49,10 @@ namespace cv
 {
 
 const float HARRIS_K = 0.04f;
+// granularity of the per-keypoint parallel loops
+const int ORB_KEYPOINTS_PER_STRIPE = 256;
+// height of the row bands FAST detection is split into on large pyramid levels
+const int ORB_FAST_BAND_HEIGHT = 128;
 
 template<typename _Tp> inline void copyVectorToUMat(const std::vector<_Tp>& v, OutputArray um)
 {
@@ -127,221 +132,364 @@ ocl_computeOrbDescriptors(const UMat& imgbuf, const UMat& layerInfo,
  * Function that computes the Harris responses in a
  * blockSize x blockSize patch at given points in the image
  */
-static void
-HarrisResponses(const Mat& img, const std::vector<Rect>& layerinfo,
-                std::vector<KeyPoint>& pts, int blockSize, float harris_k)
+class HarrisResponsesInvoker CV_FINAL : public ParallelLoopBody
 {
-    CV_Assert( img.type() == CV_8UC1 && blockSize*blockSize <= 2048 );
-
-    size_t ptidx, ptsize = pts.size();
-
-    const uchar* ptr00 = img.ptr<uchar>();
-    int step = (int)(img.step/img.elemSize1());
-    int r = blockSize/2;
-
-    float scale = 1.f/((1 << 2) * blockSize * 255.f);
-    float scale_sq_sq = scale * scale * scale * scale;
-
-    AutoBuffer<int> ofsbuf(blockSize*blockSize);
-    int* ofs = ofsbuf.data();
-    for( int i = 0; i < blockSize; i++ )
-        for( int j = 0; j < blockSize; j++ )
-            ofs[i*blockSize + j] = (int)(i*step + j);
-
-    for( ptidx = 0; ptidx < ptsize; ptidx++ )
+public:
+    HarrisResponsesInvoker(const Mat& _img, const std::vector<Rect>& _layerinfo,
+                           std::vector<KeyPoint>& _pts, int _blockSize, float _harris_k) :
+        img(_img), layerinfo(_layerinfo), pts(_pts), blockSize(_blockSize), harris_k(_harris_k)
     {
-        int x0 = cvRound(pts[ptidx].pt.x);
-        int y0 = cvRound(pts[ptidx].pt.y);
-        int z = pts[ptidx].octave;
+        CV_Assert( img.type() == CV_8UC1 && blockSize*blockSize <= 2048 );
+    }
 
-        const uchar* ptr0 = ptr00 + (y0 - r + layerinfo[z].y)*step + x0 - r + layerinfo[z].x;
-        int a = 0, b = 0, c = 0;
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        const uchar* ptr00 = img.ptr<uchar>();
+        int step = (int)(img.step/img.elemSize1());
+        int r = blockSize/2;
+
+        float scale = 1.f/((1 << 2) * blockSize * 255.f);
+        float scale_sq_sq = scale * scale * scale * scale;
+
+        AutoBuffer<int> ofsbuf(blockSize*blockSize);
+        int* ofs = ofsbuf.data();
+        for( int i = 0; i < blockSize; i++ )
+            for( int j = 0; j < blockSize; j++ )
+                ofs[i*blockSize + j] = (int)(i*step + j);
+
+#if CV_SIMD128
+        // one block row per vector, the lanes past blockSize are masked out
+        bool useSIMD = blockSize <= v_int16x8::nlanes && hasSIMD128();
+        short CV_DECL_ALIGNED(16) maskbuf[v_int16x8::nlanes];
+        for( int j = 0; j < v_int16x8::nlanes; j++ )
+            maskbuf[j] = (short)(j < blockSize ? -1 : 0);
+        v_int16x8 lanemask = v_load_aligned(maskbuf);
+#endif
 
-        for( int k = 0; k < blockSize*blockSize; k++ )
+        for( int ptidx = range.start; ptidx < range.end; ptidx++ )
         {
-            const uchar* ptr = ptr0 + ofs[k];
-            int Ix = (ptr[1] - ptr[-1])*2 + (ptr[-step+1] - ptr[-step-1]) + (ptr[step+1] - ptr[step-1]);
-            int Iy = (ptr[step] - ptr[-step])*2 + (ptr[step-1] - ptr[-step-1]) + (ptr[step+1] - ptr[-step+1]);
-            a += Ix*Ix;
-            b += Iy*Iy;
-            c += Ix*Iy;
+            int x0 = cvRound(pts[ptidx].pt.x);
+            int y0 = cvRound(pts[ptidx].pt.y);
+            int z = pts[ptidx].octave;
+
+            const uchar* ptr0 = ptr00 + (y0 - r + layerinfo[z].y)*step + x0 - r + layerinfo[z].x;
+            int a = 0, b = 0, c = 0;
+
+#if CV_SIMD128
+            if( useSIMD )
+            {
+                v_int32x4 va = v_setzero_s32(), vb = v_setzero_s32(), vc = v_setzero_s32();
+                for( int i = 0; i < blockSize; i++ )
+                {
+                    const uchar* ptr = ptr0 + i*step;
+                    v_int16x8 ul = v_reinterpret_as_s16(v_load_expand(ptr - step - 1));
+                    v_int16x8 u  = v_reinterpret_as_s16(v_load_expand(ptr - step));
+                    v_int16x8 ur = v_reinterpret_as_s16(v_load_expand(ptr - step + 1));
+                    v_int16x8 l  = v_reinterpret_as_s16(v_load_expand(ptr - 1));
+                    v_int16x8 rr = v_reinterpret_as_s16(v_load_expand(ptr + 1));
+                    v_int16x8 dl = v_reinterpret_as_s16(v_load_expand(ptr + step - 1));
+                    v_int16x8 d  = v_reinterpret_as_s16(v_load_expand(ptr + step));
+                    v_int16x8 dr = v_reinterpret_as_s16(v_load_expand(ptr + step + 1));
+
+                    v_int16x8 Ix = (rr - l) + (rr - l) + (ur - ul) + (dr - dl);
+                    v_int16x8 Iy = (d - u) + (d - u) + (dl - ul) + (dr - ur);
+                    Ix &= lanemask;
+                    Iy &= lanemask;
+
+                    va += v_dotprod(Ix, Ix);
+                    vb += v_dotprod(Iy, Iy);
+                    vc += v_dotprod(Ix, Iy);
+                }
+                a = v_reduce_sum(va);
+                b = v_reduce_sum(vb);
+                c = v_reduce_sum(vc);
+            }
+            else
+#endif
+            {
+                for( int k = 0; k < blockSize*blockSize; k++ )
+                {
+                    const uchar* ptr = ptr0 + ofs[k];
+                    int Ix = (ptr[1] - ptr[-1])*2 + (ptr[-step+1] - ptr[-step-1]) + (ptr[step+1] - ptr[step-1]);
+                    int Iy = (ptr[step] - ptr[-step])*2 + (ptr[step-1] - ptr[-step-1]) + (ptr[step+1] - ptr[-step+1]);
+                    a += Ix*Ix;
+                    b += Iy*Iy;
+                    c += Ix*Iy;
+                }
+            }
+            pts[ptidx].response = ((float)a * b - (float)c * c -
+                                   harris_k * ((float)a + b) * ((float)a + b))*scale_sq_sq;
         }
-        pts[ptidx].response = ((float)a * b - (float)c * c -
-                               harris_k * ((float)a + b) * ((float)a + b))*scale_sq_sq;
     }
+
+private:
+    const Mat& img;
+    const std::vector<Rect>& layerinfo;
+    std::vector<KeyPoint>& pts;
+    int blockSize;
+    float harris_k;
+};
+
+static void
+HarrisResponses(const Mat& img, const std::vector<Rect>& layerinfo,
+                std::vector<KeyPoint>& pts, int blockSize, float harris_k)
+{
+    parallel_for_(Range(0, (int)pts.size()),
+                  HarrisResponsesInvoker(img, layerinfo, pts, blockSize, harris_k),
+                  pts.size()/(double)ORB_KEYPOINTS_PER_STRIPE);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-static void ICAngles(const Mat& img, const std::vector<Rect>& layerinfo,
-                     std::vector<KeyPoint>& pts, const std::vector<int> & u_max, int half_k)
+class ICAnglesInvoker CV_FINAL : public ParallelLoopBody
 {
-    int step = (int)img.step1();
-    size_t ptidx, ptsize = pts.size();
+public:
+    ICAnglesInvoker(const Mat& _img, const std::vector<Rect>& _layerinfo,
+                    std::vector<KeyPoint>& _pts, const std::vector<int>& _u_max, int _half_k) :
+        img(_img), layerinfo(_layerinfo), pts(_pts), u_max(_u_max), half_k(_half_k)
+    {}
 
-    for( ptidx = 0; ptidx < ptsize; ptidx++ )
+    void operator()(const Range& range) const CV_OVERRIDE
     {
-        const Rect& layer = layerinfo[pts[ptidx].octave];
-        const uchar* center = &img.at<uchar>(cvRound(pts[ptidx].pt.y) + layer.y, cvRound(pts[ptidx].pt.x) + layer.x);
+        int step = (int)img.step1();
 
-        int m_01 = 0, m_10 = 0;
+        for( int ptidx = range.start; ptidx < range.end; ptidx++ )
+        {
+            const Rect& layer = layerinfo[pts[ptidx].octave];
+            const uchar* center = &img.at<uchar>(cvRound(pts[ptidx].pt.y) + layer.y, cvRound(pts[ptidx].pt.x) + layer.x);
 
-        // Treat the center line differently, v=0
-        for (int u = -half_k; u <= half_k; ++u)
-            m_10 += u * center[u];
+            int m_01 = 0, m_10 = 0;
 
-        // Go line by line in the circular patch
-        for (int v = 1; v <= half_k; ++v)
-        {
-            // Proceed over the two lines
-            int v_sum = 0;
-            int d = u_max[v];
-            for (int u = -d; u <= d; ++u)
+            // Treat the center line differently, v=0
+            for (int u = -half_k; u <= half_k; ++u)
+                m_10 += u * center[u];
+
+            // Go line by line in the circular patch
+            for (int v = 1; v <= half_k; ++v)
             {
-                int val_plus = center[u + v*step], val_minus = center[u - v*step];
-                v_sum += (val_plus - val_minus);
-                m_10 += u * (val_plus + val_minus);
+                // Proceed over the two lines
+                int v_sum = 0;
+                int d = u_max[v];
+                for (int u = -d; u <= d; ++u)
+                {
+                    int val_plus = center[u + v*step], val_minus = center[u - v*step];
+                    v_sum += (val_plus - val_minus);
+                    m_10 += u * (val_plus + val_minus);
+                }
+                m_01 += v * v_sum;
             }
-            m_01 += v * v_sum;
-        }
 
-        pts[ptidx].angle = fastAtan2((float)m_01, (float)m_10);
+            pts[ptidx].angle = fastAtan2((float)m_01, (float)m_10);
+        }
     }
+
+private:
+    const Mat& img;
+    const std::vector<Rect>& layerinfo;
+    std::vector<KeyPoint>& pts;
+    const std::vector<int>& u_max;
+    int half_k;
+};
+
+static void ICAngles(const Mat& img, const std::vector<Rect>& layerinfo,
+                     std::vector<KeyPoint>& pts, const std::vector<int> & u_max, int half_k)
+{
+    parallel_for_(Range(0, (int)pts.size()),
+                  ICAnglesInvoker(img, layerinfo, pts, u_max, half_k),
+                  pts.size()/(double)ORB_KEYPOINTS_PER_STRIPE);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-static void
-computeOrbDescriptors( const Mat& imagePyramid, const std::vector<Rect>& layerInfo,
-                       const std::vector<float>& layerScale, std::vector<KeyPoint>& keypoints,
-                       Mat& descriptors, const std::vector<Point>& _pattern, int dsize, int wta_k )
+/**
+ * Rotates the sampling pattern by the keypoint angle and converts it to offsets
+ * from the keypoint center in an image with the given step
+ */
+static void rotatePatternOffsets(const float* patternX, const float* patternY, int npoints,
+                                 float a, float b, int step, int* ofs)
 {
-    int step = (int)imagePyramid.step;
-    int j, i, nkeypoints = (int)keypoints.size();
+    int i = 0;
+#if CV_SIMD128
+    if( hasSIMD128() )
+    {
+        v_float32x4 va = v_setall_f32(a), vb = v_setall_f32(b);
+        v_int32x4 vstep = v_setall_s32(step);
+        for( ; i <= npoints - v_float32x4::nlanes; i += v_float32x4::nlanes )
+        {
+            v_float32x4 px = v_load(patternX + i), py = v_load(patternY + i);
+            v_int32x4 ix = v_round(px*va - py*vb);
+            v_int32x4 iy = v_round(px*vb + py*va);
+            v_store(ofs + i, iy*vstep + ix);
+        }
+    }
+#endif
+    for( ; i < npoints; i++ )
+    {
+        float x = patternX[i]*a - patternY[i]*b;
+        float y = patternX[i]*b + patternY[i]*a;
+        ofs[i] = cvRound(y)*step + cvRound(x);
+    }
+}
 
-    for( j = 0; j < nkeypoints; j++ )
+class ORBDescriptorsInvoker CV_FINAL : public ParallelLoopBody
+{
+public:
+    ORBDescriptorsInvoker(const Mat& _imagePyramid, const std::vector<Rect>& _layerInfo,
+                          const std::vector<float>& _layerScale, const std::vector<KeyPoint>& _keypoints,
+                          Mat& _descriptors, const std::vector<float>& _patternX,
+                          const std::vector<float>& _patternY, int _dsize, int _wta_k) :
+        imagePyramid(_imagePyramid), layerInfo(_layerInfo), layerScale(_layerScale),
+        keypoints(_keypoints), descriptors(_descriptors), patternX(_patternX), patternY(_patternY),
+        dsize(_dsize), wta_k(_wta_k)
+    {}
+
+    void operator()(const Range& range) const CV_OVERRIDE
     {
-        const KeyPoint& kpt = keypoints[j];
-        const Rect& layer = layerInfo[kpt.octave];
-        float scale = 1.f/layerScale[kpt.octave];
-        float angle = kpt.angle;
-
-        angle *= (float)(CV_PI/180.f);
-        float a = (float)cos(angle), b = (float)sin(angle);
-
-        const uchar* center = &imagePyramid.at<uchar>(cvRound(kpt.pt.y*scale) + layer.y,
-                                                      cvRound(kpt.pt.x*scale) + layer.x);
-        float x, y;
-        int ix, iy;
-        const Point* pattern = &_pattern[0];
-        uchar* desc = descriptors.ptr<uchar>(j);
-
-    #if 1
-        #define GET_VALUE(idx) \
-               (x = pattern[idx].x*a - pattern[idx].y*b, \
-                y = pattern[idx].x*b + pattern[idx].y*a, \
-                ix = cvRound(x), \
-                iy = cvRound(y), \
-                *(center + iy*step + ix) )
-    #else
-        #define GET_VALUE(idx) \
-            (x = pattern[idx].x*a - pattern[idx].y*b, \
-            y = pattern[idx].x*b + pattern[idx].y*a, \
-            ix = cvFloor(x), iy = cvFloor(y), \
-            x -= ix, y -= iy, \
-            cvRound(center[iy*step + ix]*(1-x)*(1-y) + center[(iy+1)*step + ix]*(1-x)*y + \
-                    center[iy*step + ix+1]*x*(1-y) + center[(iy+1)*step + ix+1]*x*y))
-    #endif
+        int step = (int)imagePyramid.step;
+        int npoints = (int)patternX.size();
+        AutoBuffer<int> ofsbuf(npoints);
 
-        if( wta_k == 2 )
+        for( int j = range.start; j < range.end; j++ )
         {
-            for (i = 0; i < dsize; ++i, pattern += 16)
+            const KeyPoint& kpt = keypoints[j];
+            const Rect& layer = layerInfo[kpt.octave];
+            float scale = 1.f/layerScale[kpt.octave];
+            float angle = kpt.angle;
+
+            angle *= (float)(CV_PI/180.f);
+            float a = (float)cos(angle), b = (float)sin(angle);
+
+            const uchar* center = &imagePyramid.at<uchar>(cvRound(kpt.pt.y*scale) + layer.y,
+                                                          cvRound(kpt.pt.x*scale) + layer.x);
+            const int* ofs = ofsbuf.data();
+            uchar* desc = descriptors.ptr<uchar>(j);
+            int i;
+
+            rotatePatternOffsets(&patternX[0], &patternY[0], npoints, a, b, step, ofsbuf.data());
+
+            #define GET_VALUE(idx) center[ofs[idx]]
+
+            if( wta_k == 2 )
             {
-                int t0, t1, val;
-                t0 = GET_VALUE(0); t1 = GET_VALUE(1);
-                val = t0 < t1;
-                t0 = GET_VALUE(2); t1 = GET_VALUE(3);
-                val |= (t0 < t1) << 1;
-                t0 = GET_VALUE(4); t1 = GET_VALUE(5);
-                val |= (t0 < t1) << 2;
-                t0 = GET_VALUE(6); t1 = GET_VALUE(7);
-                val |= (t0 < t1) << 3;
-                t0 = GET_VALUE(8); t1 = GET_VALUE(9);
-                val |= (t0 < t1) << 4;
-                t0 = GET_VALUE(10); t1 = GET_VALUE(11);
-                val |= (t0 < t1) << 5;
-                t0 = GET_VALUE(12); t1 = GET_VALUE(13);
-                val |= (t0 < t1) << 6;
-                t0 = GET_VALUE(14); t1 = GET_VALUE(15);
-                val |= (t0 < t1) << 7;
-
-                desc[i] = (uchar)val;
+                for (i = 0; i < dsize; ++i, ofs += 16)
+                {
+                    int t0, t1, val;
+                    t0 = GET_VALUE(0); t1 = GET_VALUE(1);
+                    val = t0 < t1;
+                    t0 = GET_VALUE(2); t1 = GET_VALUE(3);
+                    val |= (t0 < t1) << 1;
+                    t0 = GET_VALUE(4); t1 = GET_VALUE(5);
+                    val |= (t0 < t1) << 2;
+                    t0 = GET_VALUE(6); t1 = GET_VALUE(7);
+                    val |= (t0 < t1) << 3;
+                    t0 = GET_VALUE(8); t1 = GET_VALUE(9);
+                    val |= (t0 < t1) << 4;
+                    t0 = GET_VALUE(10); t1 = GET_VALUE(11);
+                    val |= (t0 < t1) << 5;
+                    t0 = GET_VALUE(12); t1 = GET_VALUE(13);
+                    val |= (t0 < t1) << 6;
+                    t0 = GET_VALUE(14); t1 = GET_VALUE(15);
+                    val |= (t0 < t1) << 7;
+
+                    desc[i] = (uchar)val;
+                }
             }
-        }
-        else if( wta_k == 3 )
-        {
-            for (i = 0; i < dsize; ++i, pattern += 12)
+            else if( wta_k == 3 )
             {
-                int t0, t1, t2, val;
-                t0 = GET_VALUE(0); t1 = GET_VALUE(1); t2 = GET_VALUE(2);
-                val = t2 > t1 ? (t2 > t0 ? 2 : 0) : (t1 > t0);
+                for (i = 0; i < dsize; ++i, ofs += 12)
+                {
+                    int t0, t1, t2, val;
+                    t0 = GET_VALUE(0); t1 = GET_VALUE(1); t2 = GET_VALUE(2);
+                    val = t2 > t1 ? (t2 > t0 ? 2 : 0) : (t1 > t0);
 
-                t0 = GET_VALUE(3); t1 = GET_VALUE(4); t2 = GET_VALUE(5);
-                val |= (t2 > t1 ? (t2 > t0 ? 2 : 0) : (t1 > t0)) << 2;
+                    t0 = GET_VALUE(3); t1 = GET_VALUE(4); t2 = GET_VALUE(5);
+                    val |= (t2 > t1 ? (t2 > t0 ? 2 : 0) : (t1 > t0)) << 2;
 
-                t0 = GET_VALUE(6); t1 = GET_VALUE(7); t2 = GET_VALUE(8);
-                val |= (t2 > t1 ? (t2 > t0 ? 2 : 0) : (t1 > t0)) << 4;
+                    t0 = GET_VALUE(6); t1 = GET_VALUE(7); t2 = GET_VALUE(8);
+                    val |= (t2 > t1 ? (t2 > t0 ? 2 : 0) : (t1 > t0)) << 4;
 
-                t0 = GET_VALUE(9); t1 = GET_VALUE(10); t2 = GET_VALUE(11);
-                val |= (t2 > t1 ? (t2 > t0 ? 2 : 0) : (t1 > t0)) << 6;
+                    t0 = GET_VALUE(9); t1 = GET_VALUE(10); t2 = GET_VALUE(11);
+                    val |= (t2 > t1 ? (t2 > t0 ? 2 : 0) : (t1 > t0)) << 6;
 
-                desc[i] = (uchar)val;
+                    desc[i] = (uchar)val;
+                }
             }
-        }
-        else if( wta_k == 4 )
-        {
-            for (i = 0; i < dsize; ++i, pattern += 16)
+            else if( wta_k == 4 )
             {
-                int t0, t1, t2, t3, u, v, k, val;
-                t0 = GET_VALUE(0); t1 = GET_VALUE(1);
-                t2 = GET_VALUE(2); t3 = GET_VALUE(3);
-                u = 0, v = 2;
-                if( t1 > t0 ) t0 = t1, u = 1;
-                if( t3 > t2 ) t2 = t3, v = 3;
-                k = t0 > t2 ? u : v;
-                val = k;
-
-                t0 = GET_VALUE(4); t1 = GET_VALUE(5);
-                t2 = GET_VALUE(6); t3 = GET_VALUE(7);
-                u = 0, v = 2;
-                if( t1 > t0 ) t0 = t1, u = 1;
-                if( t3 > t2 ) t2 = t3, v = 3;
-                k = t0 > t2 ? u : v;
-                val |= k << 2;
-
-                t0 = GET_VALUE(8); t1 = GET_VALUE(9);
-                t2 = GET_VALUE(10); t3 = GET_VALUE(11);
-                u = 0, v = 2;
-                if( t1 > t0 ) t0 = t1, u = 1;
-                if( t3 > t2 ) t2 = t3, v = 3;
-                k = t0 > t2 ? u : v;
-                val |= k << 4;
-
-                t0 = GET_VALUE(12); t1 = GET_VALUE(13);
-                t2 = GET_VALUE(14); t3 = GET_VALUE(15);
-                u = 0, v = 2;
-                if( t1 > t0 ) t0 = t1, u = 1;
-                if( t3 > t2 ) t2 = t3, v = 3;
-                k = t0 > t2 ? u : v;
-                val |= k << 6;
-
-                desc[i] = (uchar)val;
+                for (i = 0; i < dsize; ++i, ofs += 16)
+                {
+                    int t0, t1, t2, t3, u, v, k, val;
+                    t0 = GET_VALUE(0); t1 = GET_VALUE(1);
+                    t2 = GET_VALUE(2); t3 = GET_VALUE(3);
+                    u = 0, v = 2;
+                    if( t1 > t0 ) t0 = t1, u = 1;
+                    if( t3 > t2 ) t2 = t3, v = 3;
+                    k = t0 > t2 ? u : v;
+                    val = k;
+
+                    t0 = GET_VALUE(4); t1 = GET_VALUE(5);
+                    t2 = GET_VALUE(6); t3 = GET_VALUE(7);
+                    u = 0, v = 2;
+                    if( t1 > t0 ) t0 = t1, u = 1;
+                    if( t3 > t2 ) t2 = t3, v = 3;
+                    k = t0 > t2 ? u : v;
+                    val |= k << 2;
+
+                    t0 = GET_VALUE(8); t1 = GET_VALUE(9);
+                    t2 = GET_VALUE(10); t3 = GET_VALUE(11);
+                    u = 0, v = 2;
+                    if( t1 > t0 ) t0 = t1, u = 1;
+                    if( t3 > t2 ) t2 = t3, v = 3;
+                    k = t0 > t2 ? u : v;
+                    val |= k << 4;
+
+                    t0 = GET_VALUE(12); t1 = GET_VALUE(13);
+                    t2 = GET_VALUE(14); t3 = GET_VALUE(15);
+                    u = 0, v = 2;
+                    if( t1 > t0 ) t0 = t1, u = 1;
+                    if( t3 > t2 ) t2 = t3, v = 3;
+                    k = t0 > t2 ? u : v;
+                    val |= k << 6;
+
+                    desc[i] = (uchar)val;
+                }
             }
+            else
+                CV_Error( Error::StsBadSize, "Wrong wta_k. It can be only 2, 3 or 4." );
+            #undef GET_VALUE
         }
-        else
-            CV_Error( Error::StsBadSize, "Wrong wta_k. It can be only 2, 3 or 4." );
-        #undef GET_VALUE
     }
+
+private:
+    const Mat& imagePyramid;
+    const std::vector<Rect>& layerInfo;
+    const std::vector<float>& layerScale;
+    const std::vector<KeyPoint>& keypoints;
+    Mat& descriptors;
+    const std::vector<float>& patternX;
+    const std::vector<float>& patternY;
+    int dsize;
+    int wta_k;
+};
+
+static void
+computeOrbDescriptors( const Mat& imagePyramid, const std::vector<Rect>& layerInfo,
+                       const std::vector<float>& layerScale, std::vector<KeyPoint>& keypoints,
+                       Mat& descriptors, const std::vector<Point>& _pattern, int dsize, int wta_k )
+{
+    // the pattern is kept as float coordinates so that it can be rotated a vector at a time
+    int npoints = (int)_pattern.size();
+    std::vector<float> patternX(npoints), patternY(npoints);
+    for( int i = 0; i < npoints; i++ )
+    {
+        patternX[i] = (float)_pattern[i].x;
+        patternY[i] = (float)_pattern[i].y;
+    }
+
+    parallel_for_(Range(0, (int)keypoints.size()),
+                  ORBDescriptorsInvoker(imagePyramid, layerInfo, layerScale, keypoints, descriptors,
+                                        patternX, patternY, dsize, wta_k),
+                  keypoints.size()/(double)ORB_KEYPOINTS_PER_STRIPE);
 }
 
 
@@ -651,7 +799,7 @@ static inline float getScale(int level, int firstLevel, double scaleFactor)
 }
 
 
-class ORB_Impl CV_FINAL : public ORB
+class ORB_Impl CV_FINAL : public ORB, public ReentrantFeature2D
 {
 public:
     explicit ORB_Impl(int _nfeatures, float _scaleFactor, int _nlevels, int _edgeThreshold,
@@ -710,6 +858,10 @@ protected:
     int scoreType;
     int patchSize;
     int fastThreshold;
+
+    // pyramid buffers reused by consecutive calls on images of the same size
+    Mat imagePyramidBuf, maskPyramidBuf;
+    Mutex pyramidBufMutex;
 };
 
 int ORB_Impl::descriptorSize() const
@@ -762,6 +914,130 @@ static void uploadORBKeypoints(const std::vector<KeyPoint>& src,
 }
 #endif
 
+/**
+ * Detects FAST features on every level of the pyramid. The levels are split into row bands
+ * overlapping by the FAST radius plus the non-maximum suppression neighbourhood, so that the
+ * result, including the keypoint order, is the same as when detecting on whole levels.
+ */
+class FASTPyramidInvoker CV_FINAL : public ParallelLoopBody
+{
+public:
+    FASTPyramidInvoker(const Mat& _imagePyramid, const std::vector<Rect>& _layerInfo,
+                       const std::vector<Vec3i>& _bands, std::vector<std::vector<KeyPoint> >& _bandKeypoints,
+                       int _fastThreshold) :
+        imagePyramid(_imagePyramid), layerInfo(_layerInfo), bands(_bands),
+        bandKeypoints(_bandKeypoints), fastThreshold(_fastThreshold)
+    {}
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        const int overlap = 4;
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const Vec3i& band = bands[i];
+            const Rect& linfo = layerInfo[band[0]];
+            int y0 = band[1], y1 = band[2];
+            int by0 = std::max(y0 - overlap, 0), by1 = std::min(y1 + overlap, linfo.height);
+
+            Mat img = imagePyramid(Rect(linfo.x, linfo.y + by0, linfo.width, by1 - by0));
+            std::vector<KeyPoint>& keypoints = bandKeypoints[i];
+            FAST(img, keypoints, fastThreshold, true);
+
+            size_t j, k = 0;
+            for( j = 0; j < keypoints.size(); j++ )
+            {
+                KeyPoint kpt = keypoints[j];
+                kpt.pt.y += by0;
+                if( kpt.pt.y >= y0 && kpt.pt.y < y1 )
+                    keypoints[k++] = kpt;
+            }
+            keypoints.resize(k);
+        }
+    }
+
+private:
+    const Mat& imagePyramid;
+    const std::vector<Rect>& layerInfo;
+    const std::vector<Vec3i>& bands;
+    std::vector<std::vector<KeyPoint> >& bandKeypoints;
+    int fastThreshold;
+};
+
+static void detectFASTPyramid(const Mat& imagePyramid, const std::vector<Rect>& layerInfo,
+                              int fastThreshold, std::vector<std::vector<KeyPoint> >& levelKeypoints)
+{
+    int nlevels = (int)layerInfo.size();
+    std::vector<Vec3i> bands;
+    for( int level = 0; level < nlevels; level++ )
+    {
+        int height = layerInfo[level].height;
+        for( int y = 0; y < height; y += ORB_FAST_BAND_HEIGHT )
+            bands.push_back(Vec3i(level, y, std::min(y + ORB_FAST_BAND_HEIGHT, height)));
+    }
+
+    std::vector<std::vector<KeyPoint> > bandKeypoints(bands.size());
+    parallel_for_(Range(0, (int)bands.size()),
+                  FASTPyramidInvoker(imagePyramid, layerInfo, bands, bandKeypoints, fastThreshold));
+
+    for( size_t i = 0; i < bands.size(); i++ )
+    {
+        std::vector<KeyPoint>& keypoints = levelKeypoints[bands[i][0]];
+        keypoints.insert(keypoints.end(), bandKeypoints[i].begin(), bandKeypoints[i].end());
+    }
+}
+
+/**
+ * Applies the mask and the border filter to the FAST features of every level and keeps
+ * the best ones
+ */
+class ORBLevelFilterInvoker CV_FINAL : public ParallelLoopBody
+{
+public:
+    ORBLevelFilterInvoker(const Mat& _maskPyramid, const std::vector<Rect>& _layerInfo,
+                          const std::vector<float>& _layerScale, const std::vector<int>& _nfeaturesPerLevel,
+                          std::vector<std::vector<KeyPoint> >& _levelKeypoints,
+                          int _edgeThreshold, int _patchSize, int _scoreType) :
+        maskPyramid(_maskPyramid), layerInfo(_layerInfo), layerScale(_layerScale),
+        nfeaturesPerLevel(_nfeaturesPerLevel), levelKeypoints(_levelKeypoints),
+        edgeThreshold(_edgeThreshold), patchSize(_patchSize), scoreType(_scoreType)
+    {}
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        for( int level = range.start; level < range.end; level++ )
+        {
+            int featuresNum = nfeaturesPerLevel[level];
+            std::vector<KeyPoint>& keypoints = levelKeypoints[level];
+
+            if( !maskPyramid.empty() )
+                KeyPointsFilter::runByPixelsMask(keypoints, maskPyramid(layerInfo[level]));
+
+            // Remove keypoints very close to the border
+            KeyPointsFilter::runByImageBorder(keypoints, layerInfo[level].size(), edgeThreshold);
+
+            // Keep more points than necessary as FAST does not give amazing corners
+            KeyPointsFilter::retainBest(keypoints, scoreType == ORB::HARRIS_SCORE ? 2 * featuresNum : featuresNum);
+
+            float sf = layerScale[level];
+            for( size_t i = 0; i < keypoints.size(); i++ )
+            {
+                keypoints[i].octave = level;
+                keypoints[i].size = patchSize*sf;
+            }
+        }
+    }
+
+private:
+    const Mat& maskPyramid;
+    const std::vector<Rect>& layerInfo;
+    const std::vector<float>& layerScale;
+    const std::vector<int>& nfeaturesPerLevel;
+    std::vector<std::vector<KeyPoint> >& levelKeypoints;
+    int edgeThreshold;
+    int patchSize;
+    int scoreType;
+};
+
 /** Compute the ORB_Impl keypoints on an image
  * @param image_pyramid the image pyramid to compute the features and descriptors on
  * @param mask_pyramid the masks to apply at every level
@@ -822,37 +1098,24 @@ static void computeKeyPoints(const Mat& imagePyramid,
     allKeypoints.clear();
     std::vector<KeyPoint> keypoints;
     std::vector<int> counters(nlevels);
-    keypoints.reserve(nfeaturesPerLevel[0]*2);
+    std::vector<std::vector<KeyPoint> > levelKeypoints(nlevels);
 
-    for( level = 0; level < nlevels; level++ )
-    {
-        int featuresNum = nfeaturesPerLevel[level];
-        Mat img = imagePyramid(layerInfo[level]);
-        Mat mask = maskPyramid.empty() ? Mat() : maskPyramid(layerInfo[level]);
-
-        // Detect FAST features, 20 is a good threshold
-        {
-        Ptr<FastFeatureDetector> fd = FastFeatureDetector::create(fastThreshold, true);
-        fd->detect(img, keypoints, mask);
-        }
+    // Detect FAST features, 20 is a good threshold
+    detectFASTPyramid(imagePyramid, layerInfo, fastThreshold, levelKeypoints);
 
-        // Remove keypoints very close to the border
-        KeyPointsFilter::runByImageBorder(keypoints, img.size(), edgeThreshold);
+    parallel_for_(Range(0, nlevels), ORBLevelFilterInvoker(maskPyramid, layerInfo, layerScale,
+                                                           nfeaturesPerLevel, levelKeypoints,
+                                                           edgeThreshold, patchSize, scoreType));
 
-        // Keep more points than necessary as FAST does not give amazing corners
-        KeyPointsFilter::retainBest(keypoints, scoreType == ORB_Impl::HARRIS_SCORE ? 2 * featuresNum : featuresNum);
-
-        nkeypoints = (int)keypoints.size();
-        counters[level] = nkeypoints;
-
-        float sf = layerScale[level];
-        for( i = 0; i < nkeypoints; i++ )
-        {
-            keypoints[i].octave = level;
-            keypoints[i].size = patchSize*sf;
-        }
+    size_t totalKeypoints = 0;
+    for( level = 0; level < nlevels; level++ )
+        totalKeypoints += levelKeypoints[level].size();
+    allKeypoints.reserve(totalKeypoints);
 
-        std::copy(keypoints.begin(), keypoints.end(), std::back_inserter(allKeypoints));
+    for( level = 0; level < nlevels; level++ )
+    {
+        counters[level] = (int)levelKeypoints[level].size();
+        std::copy(levelKeypoints[level].begin(), levelKeypoints[level].end(), std::back_inserter(allKeypoints));
     }
 
     std::vector<Vec3i> ukeypoints_buf;
@@ -1012,6 +1275,15 @@ void ORB_Impl::detectAndCompute( InputArray _image, InputArray _mask,
     Mat imagePyramid, maskPyramid;
     UMat uimagePyramid, ulayerInfo;
 
+    // reuse the pyramid buffers of the previous call, unless another thread is using them;
+    // concurrent calls allocate their own pyramids, which are released when they return
+    std::unique_lock<Mutex> pyramidBufLock(pyramidBufMutex, std::try_to_lock);
+    if( pyramidBufLock.owns_lock() )
+    {
+        imagePyramid = imagePyramidBuf;
+        maskPyramid = maskPyramidBuf;
+    }
+
     int level_dy = image.rows + border*2;
     Point level_ofs(0,0);
     Size bufSize((cvRound(image.cols/getScale(0, firstLevel, scaleFactor)) + border*2 + 15) & -16, 0);
@@ -1038,6 +1310,15 @@ void ORB_Impl::detectAndCompute( InputArray _image, InputArray _mask,
     imagePyramid.create(bufSize, CV_8U);
     if( !mask.empty() )
         maskPyramid.create(bufSize, CV_8U);
+    else
+        maskPyramid = Mat();
+
+    if( pyramidBufLock.owns_lock() )
+    {
+        imagePyramidBuf = imagePyramid;
+        if( !mask.empty() )
+            maskPyramidBuf = maskPyramid;
+    }
 
     Mat prevImg = image, prevMask = mask;
 
@@ -1156,14 +1437,16 @@ void ORB_Impl::detectAndCompute( InputArray _image, InputArray _mask,
             initializeOrbPattern(pattern0, pattern, ntuples, wta_k, npoints);
         }
 
-        for( level = 0; level < nLevels; level++ )
-        {
-            // preprocess the resized image
-            Mat workingMat = imagePyramid(layerInfo[level]);
+        // preprocess the resized images, the levels do not overlap so they are blurred in parallel
+        parallel_for_(Range(0, nLevels), [&](const Range& range) {
+            for( int l = range.start; l < range.end; l++ )
+            {
+                Mat workingMat = imagePyramid(layerInfo[l]);
 
-            //boxFilter(working_mat, working_mat, working_mat.depth(), Size(5,5), Point(-1,-1), true, BORDER_REFLECT_101);
-            GaussianBlur(workingMat, workingMat, Size(7, 7), 2, 2, BORDER_REFLECT_101);
-        }
+                //boxFilter(working_mat, working_mat, working_mat.depth(), Size(5,5), Point(-1,-1), true, BORDER_REFLECT_101);
+                GaussianBlur(workingMat, workingMat, Size(7, 7), 2, 2, BORDER_REFLECT_101);
+            }
+        });
 
 #ifdef HAVE_OPENCL
         if( useOCL )
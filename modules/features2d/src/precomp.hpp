@@ -53,4 +53,18 @@
 
 #include <algorithm>
 
+namespace cv
+{
+
+/* Marks the detectors whose single image methods may run concurrently on one object.
+   The image set methods of Feature2D process the images of such detectors in parallel,
+   and the images of all the other ones one by one. */
+class ReentrantFeature2D
+{
+public:
+    virtual ~ReentrantFeature2D() {}
+};
+
+}
+
 #endif
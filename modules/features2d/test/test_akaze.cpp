@@ -3,6 +3,8 @@
 // of this distribution and at http://opencv.org/license.html
 
 #include "test_precomp.hpp"
+#include "opencv2/imgproc.hpp"
+#include "../src/kaze/AKAZEFeatures.h"
 
 namespace opencv_test { namespace {
 
@@ -26,6 +28,81 @@ TEST(Features2d_AKAZE, detect_and_compute_split)
         ASSERT_EQ(detKps[i].hash(), detAndCompKps[i].hash());
 }
 
+TEST(Features2d_AKAZE, reuse_scale_space_buffers)
+{
+    Mat img1(240, 320, CV_8U), img2(180, 200, CV_8U);
+    RNG rng(102);
+    rng.fill(img1, RNG::UNIFORM, Scalar(0), Scalar(255), true);
+    rng.fill(img2, RNG::UNIFORM, Scalar(0), Scalar(255), true);
+    GaussianBlur(img1, img1, Size(5, 5), 1.5);
+    GaussianBlur(img2, img2, Size(5, 5), 1.5);
+
+    const int diffusivities[] = { KAZE::DIFF_PM_G1, KAZE::DIFF_PM_G2, KAZE::DIFF_WEICKERT, KAZE::DIFF_CHARBONNIER };
+    for (size_t d = 0; d < sizeof(diffusivities) / sizeof(diffusivities[0]); d++)
+    {
+        SCOPED_TRACE(diffusivities[d]);
+        Ptr<Feature2D> fresh = AKAZE::create(AKAZE::DESCRIPTOR_MLDB, 0, 3, 0.001f, 4, 4, diffusivities[d]);
+        vector<KeyPoint> expectedKps;
+        Mat expectedDesc;
+        fresh->detectAndCompute(img1, noArray(), expectedKps, expectedDesc);
+        ASSERT_FALSE(expectedKps.empty());
+
+        // the second image resizes the buffers, the third call reuses them
+        Ptr<Feature2D> reused = AKAZE::create(AKAZE::DESCRIPTOR_MLDB, 0, 3, 0.001f, 4, 4, diffusivities[d]);
+        vector<KeyPoint> kps;
+        Mat desc;
+        reused->detectAndCompute(img1, noArray(), kps, desc);
+        reused->detectAndCompute(img2, noArray(), kps, desc);
+        reused->detectAndCompute(img1, noArray(), kps, desc);
+
+        ASSERT_EQ(expectedKps.size(), kps.size());
+        for (size_t i = 0; i < kps.size(); i++)
+            ASSERT_EQ(expectedKps[i].hash(), kps[i].hash());
+        EXPECT_EQ(0, cvtest::norm(expectedDesc, desc, NORM_INF));
+    }
+}
+
+TEST(Features2d_AKAZE, fused_scharr_flow)
+{
+    Mat noise(97, 131, CV_32F), Lsmooth;
+    RNG rng(7);
+    rng.fill(noise, RNG::UNIFORM, 0.f, 1.f);
+    GaussianBlur(noise, Lsmooth, Size(5, 5), 1.0);
+
+    // the separable Scharr derivatives and the diffusivity functions used before the fused pass
+    Mat Lx, Ly;
+    Scharr(Lsmooth, Lx, CV_32F, 1, 0, 1.0, 0, BORDER_DEFAULT);
+    Scharr(Lsmooth, Ly, CV_32F, 0, 1, 1.0, 0, BORDER_DEFAULT);
+
+    const float k = 0.3f;
+    const int diffusivities[] = { KAZE::DIFF_PM_G1, KAZE::DIFF_PM_G2, KAZE::DIFF_WEICKERT, KAZE::DIFF_CHARBONNIER };
+    for (size_t d = 0; d < sizeof(diffusivities) / sizeof(diffusivities[0]); d++)
+    {
+        SCOPED_TRACE(diffusivities[d]);
+        Mat expected(Lsmooth.size(), CV_32F);
+        for (int y = 0; y < expected.rows; y++)
+            for (int x = 0; x < expected.cols; x++)
+            {
+                float dL = (Lx.at<float>(y, x) * Lx.at<float>(y, x) + Ly.at<float>(y, x) * Ly.at<float>(y, x)) / (k * k);
+                float& g = expected.at<float>(y, x);
+                if (diffusivities[d] == KAZE::DIFF_PM_G1)
+                    g = std::exp(-dL);
+                else if (diffusivities[d] == KAZE::DIFF_PM_G2)
+                    g = 1.f / (1.f + dL);
+                else if (diffusivities[d] == KAZE::DIFF_WEICKERT)
+                    g = 1.f - std::exp(-3.315f / (dL * dL * dL * dL));
+                else
+                    g = 1.f / std::sqrt(1.f + dL);
+            }
+
+        Mat Lflow;
+        compute_fused_flow(Lsmooth, Lflow, k, diffusivities[d]);
+
+        // the derivatives are summed in a different order, the conductivities stay in [0, 1]
+        EXPECT_LE(cvtest::norm(expected, Lflow, NORM_INF), 1e-5);
+    }
+}
+
 /**
  * This test is here to guard propagation of NaNs that happens on this image. NaNs are guarded
  * by debug asserts in AKAZE, which should fire for you if you are lucky.
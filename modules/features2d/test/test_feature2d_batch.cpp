@@ -0,0 +1,211 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+
+#include "test_precomp.hpp"
+#include "opencv2/imgproc.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace opencv_test { namespace {
+
+static vector<Mat> makeImageSet(int count)
+{
+    RNG rng(12345);
+    vector<Mat> images;
+    for (int i = 0; i < count; i++)
+    {
+        Size sz(160 + 16 * i, 120 + 8 * i);
+        Mat img(sz, CV_8U, Scalar::all(rng.uniform(0, 64)));
+        for (int j = 0; j < 20; j++)
+        {
+            Point p1(rng.uniform(0, sz.width), rng.uniform(0, sz.height));
+            Point p2(rng.uniform(0, sz.width), rng.uniform(0, sz.height));
+            rectangle(img, p1, p2, Scalar::all(rng.uniform(64, 256)), FILLED);
+        }
+        images.push_back(img);
+    }
+    return images;
+}
+
+static void expectSameKeypoints(const vector<KeyPoint>& expected, const vector<KeyPoint>& actual)
+{
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        EXPECT_EQ(expected[i].pt, actual[i].pt);
+        EXPECT_EQ(expected[i].size, actual[i].size);
+        EXPECT_EQ(expected[i].angle, actual[i].angle);
+        EXPECT_EQ(expected[i].response, actual[i].response);
+        EXPECT_EQ(expected[i].octave, actual[i].octave);
+    }
+}
+
+typedef testing::TestWithParam<string> Features2d_Batch;
+
+static Ptr<Feature2D> createFeature2D(const string& name)
+{
+    if (name == "ORB")
+        return ORB::create();
+    if (name == "AKAZE")
+        return AKAZE::create();
+    if (name == "BRISK")
+        return BRISK::create();
+    if (name == "FAST")
+        return FastFeatureDetector::create();
+    if (name == "GFTT")
+        return GFTTDetector::create();
+    return Ptr<Feature2D>();
+}
+
+TEST_P(Features2d_Batch, same_as_single_image)
+{
+    Ptr<Feature2D> feature2d = createFeature2D(GetParam());
+    ASSERT_TRUE(feature2d);
+    bool hasDescriptors = GetParam() != "FAST" && GetParam() != "GFTT";
+
+    vector<Mat> images = makeImageSet(6);
+    vector<Mat> masks(images.size());
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        masks[i] = Mat::zeros(images[i].size(), CV_8U);
+        masks[i](Rect(0, 0, images[i].cols * 3 / 4, images[i].rows)).setTo(255);
+    }
+
+    vector<vector<KeyPoint> > keypoints;
+    feature2d->detect(images, keypoints, masks);
+    ASSERT_EQ(images.size(), keypoints.size());
+
+    vector<vector<KeyPoint> > keypoints2;
+    vector<Mat> descriptors;
+    if (hasDescriptors)
+        feature2d->detectAndCompute(images, masks, keypoints2, descriptors);
+
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        vector<KeyPoint> expected;
+        feature2d->detect(images[i], expected, masks[i]);
+        expectSameKeypoints(expected, keypoints[i]);
+
+        if (hasDescriptors)
+        {
+            Mat expectedDesc;
+            feature2d->detectAndCompute(images[i], masks[i], expected, expectedDesc);
+            expectSameKeypoints(expected, keypoints2[i]);
+            EXPECT_EQ(0, cvtest::norm(expectedDesc, descriptors[i], NORM_INF));
+        }
+    }
+
+    if (hasDescriptors)
+    {
+        feature2d->compute(images, keypoints, descriptors);
+        ASSERT_EQ(images.size(), descriptors.size());
+        for (size_t i = 0; i < images.size(); i++)
+            EXPECT_EQ(keypoints[i].size(), (size_t)descriptors[i].rows);
+    }
+}
+
+// records the threads that allocate matrices, the first allocation of a thread waits for another thread
+class ThreadRecordingAllocator CV_FINAL : public MatAllocator
+{
+public:
+    ThreadRecordingAllocator() : timedOut(false) {}
+
+    UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                       int flags, UMatUsageFlags usageFlags) const CV_OVERRIDE
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (threads.insert(std::this_thread::get_id()).second)
+            {
+                changed.notify_all();
+                if (!timedOut)
+                    timedOut = !changed.wait_for(lock, std::chrono::seconds(2), [this] { return threads.size() > 1; });
+            }
+        }
+        return Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+
+    bool allocate(UMatData* data, int accessflags, UMatUsageFlags usageFlags) const CV_OVERRIDE
+    {
+        return Mat::getStdAllocator()->allocate(data, accessflags, usageFlags);
+    }
+
+    void deallocate(UMatData* data) const CV_OVERRIDE
+    {
+        Mat::getStdAllocator()->deallocate(data);
+    }
+
+    mutable std::mutex mutex;
+    mutable std::condition_variable changed;
+    mutable std::set<std::thread::id> threads;
+    mutable bool timedOut;
+};
+
+TEST_P(Features2d_Batch, runs_images_concurrently)
+{
+    Ptr<Feature2D> feature2d = createFeature2D(GetParam());
+    ASSERT_TRUE(feature2d);
+
+    // the color images are converted to grayscale in the thread that processes them
+    vector<Mat> images = makeImageSet(6);
+    for (size_t i = 0; i < images.size(); i++)
+        cvtColor(images[i], images[i], COLOR_GRAY2BGR);
+
+    ThreadRecordingAllocator allocator;
+    MatAllocator* defaultAllocator = Mat::getDefaultAllocator();
+    int threads = getNumThreads();
+    setNumThreads(4);
+    Mat::setDefaultAllocator(&allocator);
+    vector<vector<KeyPoint> > keypoints;
+    feature2d->detect(images, keypoints);
+    Mat::setDefaultAllocator(defaultAllocator);
+    setNumThreads(threads);
+
+    ASSERT_EQ(images.size(), keypoints.size());
+    EXPECT_FALSE(allocator.timedOut);
+    EXPECT_LT(1u, allocator.threads.size());
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Features2d_Batch, testing::Values("ORB", "AKAZE", "BRISK", "FAST", "GFTT"));
+
+// a detector that keeps per-call state in the object
+class SequentialDetector CV_FINAL : public Feature2D
+{
+public:
+    SequentialDetector() : active(0) {}
+
+    using Feature2D::detect;
+
+    void detect(InputArray image, std::vector<KeyPoint>& keypoints, InputArray) CV_OVERRIDE
+    {
+        EXPECT_EQ(0, active++);
+        keypoints.assign(1, KeyPoint(0.f, 0.f, (float)image.cols()));
+        calls.push_back(image.cols());
+        active--;
+    }
+
+    int active;
+    vector<int> calls;
+};
+
+TEST(Features2d_BatchSequential, custom_detector)
+{
+    Ptr<SequentialDetector> detector = makePtr<SequentialDetector>();
+    vector<Mat> images = makeImageSet(8);
+
+    vector<vector<KeyPoint> > keypoints;
+    detector->detect(images, keypoints);
+
+    ASSERT_EQ(images.size(), detector->calls.size());
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        EXPECT_EQ(images[i].cols, detector->calls[i]);
+        ASSERT_EQ(1u, keypoints[i].size());
+        EXPECT_EQ((float)images[i].cols, keypoints[i][0].size);
+    }
+}
+
+}} // namespace
@@ -177,6 +177,25 @@ public:
                 unsigned int multi_probe_level );
         };
         @endcode
+        - **IvfPqIndexParams** When passing an object of this type the index constructed will be an
+        inverted file with product quantization (IVFADC). The dataset is split into nlists inverted
+        lists by a coarse k-means quantizer and the residuals are stored as compact PQ codes of one
+        byte per sub-quantizer, so the index is suited to very large datasets. Queries visit the
+        nprobe closest lists and optionally re-rank the best rerank candidates with exact
+        distances. nprobe and rerank can also be overridden by the search parameters. Only
+        distances that are additive over the vector components (L1, L2) are supported. :
+        @code
+        struct IvfPqIndexParams : public IndexParams
+        {
+            IvfPqIndexParams(
+                int nlists = 256,
+                int subquantizers = 8,
+                int iterations = 10,
+                int nprobe = 8,
+                int rerank = 0,
+                int train_size = 100000 );
+        };
+        @endcode
         - **AutotunedIndexParams** When passing an object of this type the index created is
         automatically tuned to offer the best performance, by choosing the optimal index type
         (randomized kd-trees, hierarchical kmeans, linear) and parameters for the dataset provided. :
@@ -0,0 +1,448 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef OPENCV_FLANN_IVFPQ_INDEX_H_
+#define OPENCV_FLANN_IVFPQ_INDEX_H_
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <utility>
+
+#include "general.h"
+#include "nn_index.h"
+#include "dist.h"
+#include "matrix.h"
+#include "result_set.h"
+#include "saving.h"
+
+namespace cvflann
+{
+
+struct IvfPqIndexParams : public IndexParams
+{
+    IvfPqIndexParams(int nlists = 256, int subquantizers = 8, int iterations = 10,
+                     int nprobe = 8, int rerank = 0, int train_size = 100000)
+    {
+        (*this)["algorithm"] = FLANN_INDEX_IVFPQ;
+        // number of inverted lists (coarse quantizer centroids)
+        (*this)["nlists"] = nlists;
+        // number of sub-vectors each residual is split into, one byte of code per sub-vector
+        (*this)["subquantizers"] = subquantizers;
+        // max iterations of cv::kmeans when training the quantizers
+        (*this)["iterations"] = iterations;
+        // default number of inverted lists visited per query
+        (*this)["nprobe"] = nprobe;
+        // default number of candidates re-ranked with exact distances (0 to disable)
+        (*this)["rerank"] = rerank;
+        // max number of dataset points used to train the quantizers
+        (*this)["train_size"] = train_size;
+    }
+};
+
+
+/**
+ * Inverted file index with product quantization (IVFADC).
+ *
+ * The dataset is partitioned by a coarse k-means quantizer into inverted lists.
+ * The residual of every point to its list centroid is split into subquantizers
+ * sub-vectors, each one encoded as the byte index of the nearest centroid of a
+ * per-subspace codebook. Queries visit the nprobe closest lists and estimate
+ * distances from a per-list lookup table, optionally re-ranking the best
+ * candidates with exact distances over the original dataset.
+ *
+ * The distance must be additive over the vector components, which is the case
+ * for all kd-tree capable distances.
+ */
+template <typename Distance>
+class IvfPqIndex : public NNIndex<Distance>
+{
+public:
+    typedef typename Distance::ElementType ElementType;
+    typedef typename Distance::ResultType DistanceType;
+
+    /** Number of centroids of each sub-quantizer, so that a code fits in one byte */
+    enum { MAX_SUBCENTROIDS = 256 };
+
+    IvfPqIndex(const Matrix<ElementType>& inputData, const IndexParams& params = IvfPqIndexParams(),
+               Distance d = Distance()) :
+        dataset_(inputData), index_params_(params), distance_(d)
+    {
+        size_ = dataset_.rows;
+        veclen_ = dataset_.cols;
+
+        nlists_ = get_param(params, "nlists", 256);
+        subquantizers_ = get_param(params, "subquantizers", 8);
+        iterations_ = get_param(params, "iterations", 10);
+        nprobe_ = get_param(params, "nprobe", 8);
+        rerank_ = get_param(params, "rerank", 0);
+        train_size_ = get_param(params, "train_size", 100000);
+        subcentroids_ = 0;
+        dsub_ = 0;
+    }
+
+    flann_algorithm_t getType() const CV_OVERRIDE
+    {
+        return FLANN_INDEX_IVFPQ;
+    }
+
+    size_t size() const CV_OVERRIDE
+    {
+        return size_;
+    }
+
+    size_t veclen() const CV_OVERRIDE
+    {
+        return veclen_;
+    }
+
+    int usedMemory() const CV_OVERRIDE
+    {
+        return (int)(coarse_.size()*sizeof(float) + codebooks_.size()*sizeof(float) +
+                     list_offsets_.size()*sizeof(int) + ids_.size()*sizeof(int) + codes_.size());
+    }
+
+    void buildIndex() CV_OVERRIDE
+    {
+        if (subquantizers_ <= 0 || veclen_ % subquantizers_ != 0) {
+            throw FLANNException("IVF-PQ: the vector length must be a multiple of the number of subquantizers");
+        }
+        if (nlists_ <= 0 || iterations_ <= 0) {
+            throw FLANNException("IVF-PQ: nlists and iterations must be positive");
+        }
+        if (size_ == 0) {
+            throw FLANNException("IVF-PQ: cannot build an index over an empty dataset");
+        }
+        dsub_ = (int)veclen_ / subquantizers_;
+
+        cv::Mat samples = trainingSamples();
+        cv::TermCriteria criteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, iterations_, 1e-4);
+
+        // coarse quantizer
+        nlists_ = std::min(nlists_, samples.rows);
+        index_params_["nlists"] = nlists_;
+        cv::Mat labels, centers;
+        cv::kmeans(samples, nlists_, labels, criteria, 1, cv::KMEANS_PP_CENTERS, centers);
+        coarse_.assign(centers.ptr<float>(), centers.ptr<float>() + centers.total());
+
+        // residuals of the training samples to their coarse centroids
+        for (int i = 0; i < samples.rows; ++i) {
+            float* row = samples.ptr<float>(i);
+            const float* c = &coarse_[labels.at<int>(i)*veclen_];
+            for (size_t k = 0; k < veclen_; ++k) {
+                row[k] -= c[k];
+            }
+        }
+
+        // one codebook per subspace, trained on the residuals
+        subcentroids_ = std::min((int)MAX_SUBCENTROIDS, samples.rows);
+        codebooks_.resize((size_t)subquantizers_*subcentroids_*dsub_);
+        for (int j = 0; j < subquantizers_; ++j) {
+            cv::Mat sub = samples.colRange(j*dsub_, (j+1)*dsub_).clone();
+            cv::Mat sublabels, subcenters;
+            cv::kmeans(sub, subcentroids_, sublabels, criteria, 1, cv::KMEANS_PP_CENTERS, subcenters);
+            std::copy(subcenters.ptr<float>(), subcenters.ptr<float>() + subcenters.total(),
+                      &codebooks_[(size_t)j*subcentroids_*dsub_]);
+        }
+
+        encodeDataset();
+    }
+
+    void saveIndex(FILE* stream) CV_OVERRIDE
+    {
+        save_value(stream, nlists_);
+        save_value(stream, subquantizers_);
+        save_value(stream, subcentroids_);
+        save_value(stream, iterations_);
+        save_value(stream, nprobe_);
+        save_value(stream, rerank_);
+        save_value(stream, train_size_);
+        save_value(stream, coarse_);
+        save_value(stream, codebooks_);
+        save_value(stream, list_offsets_);
+        save_value(stream, ids_);
+        save_value(stream, codes_);
+    }
+
+    void loadIndex(FILE* stream) CV_OVERRIDE
+    {
+        load_value(stream, nlists_);
+        load_value(stream, subquantizers_);
+        load_value(stream, subcentroids_);
+        load_value(stream, iterations_);
+        load_value(stream, nprobe_);
+        load_value(stream, rerank_);
+        load_value(stream, train_size_);
+        load_value(stream, coarse_);
+        load_value(stream, codebooks_);
+        load_value(stream, list_offsets_);
+        load_value(stream, ids_);
+        load_value(stream, codes_);
+        dsub_ = (int)veclen_ / subquantizers_;
+
+        index_params_["algorithm"] = getType();
+        index_params_["nlists"] = nlists_;
+        index_params_["subquantizers"] = subquantizers_;
+        index_params_["iterations"] = iterations_;
+        index_params_["nprobe"] = nprobe_;
+        index_params_["rerank"] = rerank_;
+        index_params_["train_size"] = train_size_;
+    }
+
+    /**
+     * Find set of nearest neighbors to vec. Their indices are stored inside
+     * the result object.
+     *
+     * Params:
+     *     result = the result object in which the indices of the nearest-neighbors are stored
+     *     vec = the vector for which to search the nearest neighbors
+     *     searchParams = "nprobe" and "rerank" override the values given at build time
+     */
+    void findNeighbors(ResultSet<DistanceType>& result, const ElementType* vec, const SearchParams& searchParams) CV_OVERRIDE
+    {
+        int nprobe = std::max(1, std::min(get_param(searchParams, "nprobe", nprobe_), nlists_));
+        int rerank = get_param(searchParams, "rerank", rerank_);
+
+        // closest inverted lists
+        std::vector<std::pair<DistanceType, int> > lists(nlists_);
+        for (int l = 0; l < nlists_; ++l) {
+            lists[l] = std::make_pair(distance_(vec, &coarse_[l*veclen_], veclen_), l);
+        }
+        std::partial_sort(lists.begin(), lists.begin() + nprobe, lists.end());
+
+        // candidates kept for re-ranking, as a max-heap on the approximate distance
+        std::vector<std::pair<DistanceType, int> > candidates;
+        if (rerank > 0) candidates.reserve(rerank + 1);
+
+        std::vector<DistanceType> lut((size_t)subquantizers_*subcentroids_);
+        std::vector<DistanceType> dists;
+        for (int p = 0; p < nprobe; ++p) {
+            int l = lists[p].second;
+            int begin = list_offsets_[l], count = list_offsets_[l+1] - begin;
+            if (count == 0) continue;
+
+            computeLookupTable(vec, l, &lut[0]);
+            dists.resize(count);
+            scanCodes(&lut[0], &codes_[(size_t)begin*subquantizers_], count, &dists[0]);
+
+            for (int i = 0; i < count; ++i) {
+                int id = ids_[begin + i];
+                if (rerank <= 0) {
+                    result.addPoint(dists[i], id);
+                }
+                else if ((int)candidates.size() < rerank || dists[i] < candidates.front().first) {
+                    candidates.push_back(std::make_pair(dists[i], id));
+                    std::push_heap(candidates.begin(), candidates.end());
+                    if ((int)candidates.size() > rerank) {
+                        std::pop_heap(candidates.begin(), candidates.end());
+                        candidates.pop_back();
+                    }
+                }
+            }
+        }
+
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            int id = candidates[i].second;
+            result.addPoint(distance_(vec, dataset_[id], veclen_), id);
+        }
+    }
+
+    IndexParams getParameters() const CV_OVERRIDE
+    {
+        return index_params_;
+    }
+
+private:
+    /**
+     * Returns at most train_size_ dataset rows, evenly spread over the dataset and
+     * converted to float.
+     */
+    cv::Mat trainingSamples() const
+    {
+        int count = (int)size_;
+        if (train_size_ > 0 && train_size_ < count) count = train_size_;
+
+        cv::Mat samples(count, (int)veclen_, CV_32F);
+        for (int i = 0; i < count; ++i) {
+            const ElementType* src = dataset_[(size_t)i*size_/count];
+            float* dst = samples.ptr<float>(i);
+            for (size_t k = 0; k < veclen_; ++k) {
+                dst[k] = (float)src[k];
+            }
+        }
+        return samples;
+    }
+
+    /**
+     * Assigns every dataset point to its inverted list and stores the PQ code of its residual.
+     * The lists are kept contiguous: ids_ and codes_ are ordered by list, list_offsets_
+     * holds the start of every list.
+     */
+    void encodeDataset()
+    {
+        std::vector<int> assign(size_);
+        std::vector<uchar> codes(size_*subquantizers_);
+
+        cv::parallel_for_(cv::Range(0, (int)size_), [&](const cv::Range& range) {
+            std::vector<float> residual(veclen_);
+            for (int i = range.start; i < range.end; ++i) {
+                const ElementType* vec = dataset_[i];
+
+                int best = 0;
+                DistanceType best_dist = distance_(vec, &coarse_[0], veclen_);
+                for (int l = 1; l < nlists_; ++l) {
+                    DistanceType dist = distance_(vec, &coarse_[l*veclen_], veclen_, best_dist);
+                    if (dist < best_dist) {
+                        best_dist = dist;
+                        best = l;
+                    }
+                }
+                assign[i] = best;
+
+                const float* c = &coarse_[best*veclen_];
+                for (size_t k = 0; k < veclen_; ++k) {
+                    residual[k] = (float)vec[k] - c[k];
+                }
+                for (int j = 0; j < subquantizers_; ++j) {
+                    const float* sub = &residual[j*dsub_];
+                    const float* codebook = &codebooks_[(size_t)j*subcentroids_*dsub_];
+                    int best_code = 0;
+                    float best_code_dist = std::numeric_limits<float>::max();
+                    for (int c2 = 0; c2 < subcentroids_; ++c2) {
+                        float dist = (float)cv::normL2Sqr(sub, codebook + c2*dsub_, dsub_);
+                        if (dist < best_code_dist) {
+                            best_code_dist = dist;
+                            best_code = c2;
+                        }
+                    }
+                    codes[(size_t)i*subquantizers_ + j] = (uchar)best_code;
+                }
+            }
+        });
+
+        list_offsets_.assign(nlists_ + 1, 0);
+        for (size_t i = 0; i < size_; ++i) {
+            list_offsets_[assign[i] + 1]++;
+        }
+        for (int l = 0; l < nlists_; ++l) {
+            list_offsets_[l + 1] += list_offsets_[l];
+        }
+
+        std::vector<int> pos(list_offsets_.begin(), list_offsets_.end() - 1);
+        ids_.resize(size_);
+        codes_.resize(size_*subquantizers_);
+        for (size_t i = 0; i < size_; ++i) {
+            int p = pos[assign[i]]++;
+            ids_[p] = (int)i;
+            std::copy(&codes[i*subquantizers_], &codes[i*subquantizers_] + subquantizers_,
+                      &codes_[(size_t)p*subquantizers_]);
+        }
+    }
+
+    /**
+     * Fills lut with the distance of every query sub-vector to every reconstructed
+     * sub-vector (coarse centroid plus codeword) of list l. Since the distance is
+     * additive, the approximate distance to an encoded point is the sum of one table
+     * entry per subspace.
+     */
+    void computeLookupTable(const ElementType* vec, int l, DistanceType* lut) const
+    {
+        std::vector<float> reconstructed(dsub_);
+        const float* c = &coarse_[l*veclen_];
+        for (int j = 0; j < subquantizers_; ++j) {
+            const float* codebook = &codebooks_[(size_t)j*subcentroids_*dsub_];
+            for (int c2 = 0; c2 < subcentroids_; ++c2) {
+                const float* codeword = codebook + c2*dsub_;
+                for (int k = 0; k < dsub_; ++k) {
+                    reconstructed[k] = c[j*dsub_ + k] + codeword[k];
+                }
+                lut[j*subcentroids_ + c2] = distance_(vec + j*dsub_, &reconstructed[0], dsub_);
+            }
+        }
+    }
+
+    /**
+     * Computes the approximate distances of count encoded points from the lookup table.
+     */
+    void scanCodes(const DistanceType* lut, const uchar* codes, int count, DistanceType* dists) const
+    {
+        scanCodes_(lut, codes, count, dists, subquantizers_, subcentroids_);
+    }
+
+    template <typename T>
+    static void scanCodes_(const T* lut, const uchar* codes, int count, T* dists, int m, int ksub)
+    {
+        for (int i = 0; i < count; ++i, codes += m) {
+            T dist = T();
+            for (int j = 0; j < m; ++j) {
+                dist += lut[j*ksub + codes[j]];
+            }
+            dists[i] = dist;
+        }
+    }
+
+    static void scanCodes_(const float* lut, const uchar* codes, int count, float* dists, int m, int ksub)
+    {
+        int i = 0;
+#if CV_SIMD128
+        // four points at a time, gathering one table entry per point and subspace
+        for (; i <= count - 4; i += 4, codes += 4*m) {
+            cv::v_float32x4 acc = cv::v_setzero_f32();
+            for (int j = 0; j < m; ++j) {
+                int base = j*ksub;
+                cv::v_int32x4 idx(base + codes[j], base + codes[m + j],
+                                  base + codes[2*m + j], base + codes[3*m + j]);
+                acc += cv::v_lut(lut, idx);
+            }
+            cv::v_store(dists + i, acc);
+        }
+#endif
+        for (; i < count; ++i, codes += m) {
+            float dist = 0;
+            for (int j = 0; j < m; ++j) {
+                dist += lut[j*ksub + codes[j]];
+            }
+            dists[i] = dist;
+        }
+    }
+
+private:
+    /** Copying is not supported */
+    IvfPqIndex(const IvfPqIndex&);
+    IvfPqIndex& operator=(const IvfPqIndex&);
+
+    /** The dataset, used for re-ranking */
+    const Matrix<ElementType> dataset_;
+    /** Index parameters */
+    IndexParams index_params_;
+    /** Index distance */
+    Distance distance_;
+
+    size_t size_;
+    size_t veclen_;
+
+    int nlists_;
+    int subquantizers_;
+    int subcentroids_;
+    int dsub_;
+    int iterations_;
+    int nprobe_;
+    int rerank_;
+    int train_size_;
+
+    /** Coarse centroids, nlists_ x veclen_ */
+    std::vector<float> coarse_;
+    /** Sub-quantizer codebooks, subquantizers_ x subcentroids_ x dsub_ */
+    std::vector<float> codebooks_;
+    /** Start of every inverted list in ids_ and codes_, nlists_ + 1 entries */
+    std::vector<int> list_offsets_;
+    /** Dataset indices, grouped by inverted list */
+    std::vector<int> ids_;
+    /** PQ codes, subquantizers_ bytes per point, in the same order as ids_ */
+    std::vector<uchar> codes_;
+};
+
+}
+
+#endif // OPENCV_FLANN_IVFPQ_INDEX_H_
@@ -119,6 +119,12 @@ struct CV_EXPORTS LshIndexParams : public IndexParams
     LshIndexParams(int table_number, int key_size, int multi_probe_level);
 };
 
+struct CV_EXPORTS IvfPqIndexParams : public IndexParams
+{
+    IvfPqIndexParams(int nlists = 256, int subquantizers = 8, int iterations = 10,
+                     int nprobe = 8, int rerank = 0, int train_size = 100000);
+};
+
 struct CV_EXPORTS SavedIndexParams : public IndexParams
 {
     SavedIndexParams(const String& filename);
@@ -285,6 +285,25 @@ LshIndexParams::LshIndexParams(int table_number, int key_size, int multi_probe_l
     p["multi_probe_level"] = multi_probe_level;
 }
 
+IvfPqIndexParams::IvfPqIndexParams(int nlists, int subquantizers, int iterations,
+                                   int nprobe, int rerank, int train_size)
+{
+    ::cvflann::IndexParams& p = get_params(*this);
+    p["algorithm"] = FLANN_INDEX_IVFPQ;
+    // number of inverted lists (coarse quantizer centroids)
+    p["nlists"] = nlists;
+    // number of sub-vectors each residual is split into, one byte of code per sub-vector
+    p["subquantizers"] = subquantizers;
+    // max iterations of cv::kmeans when training the quantizers
+    p["iterations"] = iterations;
+    // default number of inverted lists visited per query
+    p["nprobe"] = nprobe;
+    // default number of candidates re-ranked with exact distances (0 to disable)
+    p["rerank"] = rerank;
+    // max number of dataset points used to train the quantizers
+    p["train_size"] = train_size;
+}
+
 SavedIndexParams::SavedIndexParams(const String& _filename)
 {
     String filename = _filename;
@@ -0,0 +1,109 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+// clustered data, so that the coarse quantizer has some structure to learn
+static Mat makeClusteredData(RNG& rng, int rows, int cols, int clusters)
+{
+    Mat centers(clusters, cols, CV_32F), data(rows, cols, CV_32F);
+    rng.fill(centers, RNG::UNIFORM, 0, 100);
+    for (int i = 0; i < rows; i++)
+    {
+        Mat row = data.row(i);
+        rng.fill(row, RNG::NORMAL, 0, 5);
+        row += centers.row(rng.uniform(0, clusters));
+    }
+    return data;
+}
+
+static double recallAt1(const Mat& indices, const Mat& gt)
+{
+    int hits = 0;
+    for (int i = 0; i < gt.rows; i++)
+        hits += indices.at<int>(i, 0) == gt.at<int>(i, 0);
+    return (double)hits / gt.rows;
+}
+
+TEST(Flann_IvfPq, knnSearch_accuracy)
+{
+    RNG& rng = TS::ptr()->get_rng();
+    Mat data = makeClusteredData(rng, 5000, 32, 20);
+    Mat queries = makeClusteredData(rng, 200, 32, 20);
+
+    Mat gtIndices, gtDists;
+    flann::Index linear(data, flann::LinearIndexParams());
+    linear.knnSearch(queries, gtIndices, gtDists, 1);
+
+    flann::Index ivfpq(data, flann::IvfPqIndexParams(32, 8, 10, 8, 0));
+    EXPECT_EQ(cvflann::FLANN_INDEX_IVFPQ, ivfpq.getAlgorithm());
+
+    Mat indices, dists;
+    ivfpq.knnSearch(queries, indices, dists, 1);
+    double recallApprox = recallAt1(indices, gtIndices);
+    EXPECT_GT(recallApprox, 0.3);
+
+    flann::SearchParams rerank;
+    rerank.setInt("rerank", 64);
+    ivfpq.knnSearch(queries, indices, dists, 1, rerank);
+    double recallRerank = recallAt1(indices, gtIndices);
+    EXPECT_GT(recallRerank, 0.9);
+    EXPECT_GE(recallRerank, recallApprox);
+
+    // re-ranked distances are exact
+    for (int i = 0; i < queries.rows; i++)
+    {
+        int idx = indices.at<int>(i, 0);
+        ASSERT_GE(idx, 0);
+        EXPECT_NEAR(cvtest::norm(queries.row(i), data.row(idx), NORM_L2SQR), dists.at<float>(i, 0), 1e-2);
+    }
+}
+
+TEST(Flann_IvfPq, save_load)
+{
+    RNG& rng = TS::ptr()->get_rng();
+    Mat data = makeClusteredData(rng, 2000, 16, 10);
+    Mat queries = makeClusteredData(rng, 50, 16, 10);
+
+    flann::Index ivfpq(data, flann::IvfPqIndexParams(16, 4, 10, 4, 16));
+    Mat indices, dists;
+    ivfpq.knnSearch(queries, indices, dists, 5);
+
+    string filename = tempfile("ivfpq.flann");
+    ivfpq.save(filename);
+
+    flann::Index loaded;
+    ASSERT_TRUE(loaded.load(data, filename));
+    EXPECT_EQ(cvflann::FLANN_INDEX_IVFPQ, loaded.getAlgorithm());
+
+    Mat indices2, dists2;
+    loaded.knnSearch(queries, indices2, dists2, 5);
+    EXPECT_EQ(0, cvtest::norm(indices, indices2, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(dists, dists2, NORM_INF));
+
+    remove(filename.c_str());
+}
+
+TEST(Flann_IvfPq, badarg)
+{
+    Mat data(100, 10, CV_32F, Scalar::all(1));
+    // 10 is not a multiple of 4 subquantizers
+    EXPECT_ANY_THROW(flann::Index(data, flann::IvfPqIndexParams(4, 4)));
+}
+
+TEST(Flann_IvfPq, nlists_clamped)
+{
+    RNG& rng = TS::ptr()->get_rng();
+    Mat data = makeClusteredData(rng, 50, 8, 4);
+    cvflann::Matrix<float> dataset(data.ptr<float>(), data.rows, data.cols);
+
+    // there are fewer training samples than requested lists
+    cvflann::IvfPqIndex<cvflann::L2<float> > index(dataset, cvflann::IvfPqIndexParams(256, 4));
+    index.buildIndex();
+    EXPECT_EQ(50, cvflann::get_param<int>(index.getParameters(), "nlists"));
+}
+
+}} // namespace
@@ -94,7 +94,8 @@ enum ImwriteFlags {
        IMWRITE_PAM_TUPLETYPE       = 128,//!< For PAM, sets the TUPLETYPE field to the corresponding string value that is defined for the format
        IMWRITE_TIFF_RESUNIT = 256,//!< For TIFF, use to specify which DPI resolution unit to set; see libtiff documentation for valid values
        IMWRITE_TIFF_XDPI = 257,//!< For TIFF, use to specify the X direction DPI
-       IMWRITE_TIFF_YDPI = 258 //!< For TIFF, use to specify the Y direction DPI
+       IMWRITE_TIFF_YDPI = 258,//!< For TIFF, use to specify the Y direction DPI
+       IMWRITE_THREADS   = 512 //!< For PNG and TIFF, number of threads compressing the image data. Default value is 1, 0 or a negative value means cv::getNumThreads(). Multithreaded PNG output is compressed in independent chunks and may be slightly larger.
      };
 
 enum ImwriteEXRTypeFlags {
@@ -175,6 +176,24 @@ Currently, the following file formats are supported:
 */
 CV_EXPORTS_W Mat imread( const String& filename, int flags = IMREAD_COLOR );
 
+/** @brief Loads a region of an image from a file.
+
+The result is the same as imread(filename, flags)(roi), but decoders that support it read only the
+part of the file covering the region: JPEG skips the rows above the region and stops below it (with
+libjpeg-turbo, only the iMCU columns intersecting the region are decoded), TIFF reads only the strips
+or tiles intersecting the region. Other formats decode the whole image and crop it.
+
+@param filename Name of file to be loaded.
+@param roi Region to load, in the coordinates of the image returned by imread(filename, flags), so it
+is scaled down together with the image by the @ref IMREAD_REDUCED_GRAYSCALE_2 "IMREAD_REDUCED_*" modes.
+It is clipped to the image, an empty matrix is returned if it doesn't intersect the image.
+@param flags Flag that can take values of cv::ImreadModes
+
+@note With the IMREAD_REDUCED_* modes, the formats without native downscaling (all except JPEG) resize
+the decoded region, so the pixels near its border may slightly differ from the cropped reduced image.
+*/
+CV_EXPORTS_W Mat imread( const String& filename, const Rect& roi, int flags = IMREAD_COLOR );
+
 /** @brief Loads a multi-page image from a file.
 
 The function imreadmulti loads a multi-page image from the specified file into a vector of Mat objects.
@@ -229,6 +248,45 @@ reallocations when the function is called repeatedly for images of the same size
 */
 CV_EXPORTS Mat imdecode( InputArray buf, int flags, Mat* dst);
 
+/** @brief Reads a region of an image from a buffer in memory.
+
+See the imread overload with a region of interest for the details.
+
+@param buf Input array or vector of bytes.
+@param roi Region to decode, in the coordinates of the image returned by imdecode(buf, flags).
+@param flags The same flags as in cv::imread, see cv::ImreadModes.
+*/
+CV_EXPORTS_W Mat imdecode( InputArray buf, const Rect& roi, int flags );
+
+/** @brief Decodes a batch of images from buffers in memory.
+
+The images are decoded in parallel. Each thread keeps its own decoders and reuses them for the
+consecutive images of the same format. A JPEG decoder keeps its libjpeg decompressor with its
+memory pools and table storage, a PNG decoder only keeps the decoder object, libpng state is still
+created for each image. The format of every image is detected from its signature as in cv::imdecode.
+The output vector is resized to the number of buffers; the output images that already have the
+right size and type are decoded in place.
+
+An image that cannot be decoded doesn't interrupt the batch, the corresponding output is left empty.
+
+@param bufs Input vector of buffers, one per image.
+@param dst Output vector of decoded images.
+@param flags The same flags as in cv::imread, see cv::ImreadModes.
+@return Number of successfully decoded images.
+*/
+CV_EXPORTS_W int imdecodeBatch( InputArrayOfArrays bufs, CV_IN_OUT std::vector<Mat>& dst, int flags = IMREAD_COLOR );
+
+/** @brief Loads a batch of images from files.
+
+See cv::imdecodeBatch for the details.
+
+@param filenames Names of the files to be loaded.
+@param dst Output vector of loaded images.
+@param flags The same flags as in cv::imread, see cv::ImreadModes.
+@return Number of successfully loaded images.
+*/
+CV_EXPORTS_W int imreadBatch( const std::vector<String>& filenames, CV_IN_OUT std::vector<Mat>& dst, int flags = IMREAD_COLOR );
+
 /** @brief Encodes an image into a memory buffer.
 
 The function imencode compresses the image and stores it in the memory buffer that is resized to fit the
@@ -243,6 +301,113 @@ CV_EXPORTS_W bool imencode( const String& ext, InputArray img,
                             CV_OUT std::vector<uchar>& buf,
                             const std::vector<int>& params = std::vector<int>());
 
+/** @brief Writes an image to a file incrementally, for images that don't fit in memory.
+
+The image is passed to the encoder from top to bottom, either in bands of full rows or in tiles
+given in row-major order. All the tiles of a row of tiles must have the same height; only the row
+of tiles being assembled is kept in memory. Streaming is supported by the PNG, JPEG and TIFF
+encoders. TIFF files are written in strips, or in tiles when the TIFFTAG_TILEWIDTH and
+TIFFTAG_TILELENGTH parameters are set (rounded up to multiples of 16). Images larger than 2GB are
+written in the BigTIFF format.
+
+@code
+    ImageWriter writer("panorama.tif", Size(200000, 100000), CV_8UC3);
+    for (int y = 0; y < 100000; y += band.rows)
+        writer.write(renderBand(y)); // band.cols == 200000
+    writer.release();
+@endcode
+ */
+class CV_EXPORTS_W ImageWriter
+{
+public:
+    CV_WRAP ImageWriter();
+
+    /** @overload
+    @param filename Name of the file, the format is chosen by the extension.
+    @param size Size of the whole image.
+    @param type Type of the image, 8-bit or 16-bit (PNG and TIFF) with 1, 3 or 4 channels.
+    @param params Format-specific parameters, see cv::imwrite and cv::ImwriteFlags.
+    */
+    CV_WRAP ImageWriter( const String& filename, Size size, int type,
+                         const std::vector<int>& params = std::vector<int>() );
+
+    virtual ~ImageWriter();
+
+    /** @brief Starts writing an image, see the constructor parameters.
+
+    @return false if the file can't be created or the format doesn't support streaming or the type.
+    */
+    CV_WRAP virtual bool open( const String& filename, Size size, int type,
+                               const std::vector<int>& params = std::vector<int>() );
+
+    CV_WRAP virtual bool isOpened() const;
+
+    /** @brief Writes the next band of rows or the next tile.
+
+    @param part Band of rows as wide as the image, or tile. Its type must be the one of the image.
+    @return false if the encoder failed, the writer is closed then.
+    */
+    CV_WRAP virtual bool write( InputArray part );
+
+    /** @brief Completes the file and closes the writer.
+
+    @return true if all the rows were written successfully.
+    */
+    CV_WRAP virtual bool release();
+
+private:
+    struct Impl;
+    Ptr<Impl> p;
+};
+
+/** @brief Reads an image from a file incrementally, in bands of rows from top to bottom.
+
+The PNG (non-interlaced), JPEG and TIFF decoders read only the rows of the requested band,
+so the memory use doesn't depend on the image size. The other formats are decoded at once
+when the first band is read. The reduced modes and the EXIF orientation are not supported.
+ */
+class CV_EXPORTS_W ImageReader
+{
+public:
+    CV_WRAP ImageReader();
+
+    /** @overload
+    @param filename Name of the file to be loaded.
+    @param flags The same flags as in cv::imread, see cv::ImreadModes.
+    */
+    CV_WRAP ImageReader( const String& filename, int flags = IMREAD_COLOR );
+
+    virtual ~ImageReader();
+
+    /** @brief Opens an image, see the constructor parameters.
+
+    @return false if the file can't be read or isn't a supported image.
+    */
+    CV_WRAP virtual bool open( const String& filename, int flags = IMREAD_COLOR );
+
+    CV_WRAP virtual bool isOpened() const;
+
+    //! Size of the whole image
+    CV_WRAP Size size() const;
+
+    //! Type of the bands, as selected by the flags
+    CV_WRAP int type() const;
+
+    /** @brief Reads the next band of rows.
+
+    @param band Output band, it has less rows than requested at the bottom of the image.
+    @param rows Number of rows to read.
+    @return false at the end of the image or if decoding failed.
+    */
+    CV_WRAP virtual bool read( OutputArray band, int rows );
+
+    CV_WRAP virtual void release();
+
+private:
+    struct Impl;
+    Ptr<Impl> p;
+};
+
 //! @} imgcodecs
 
 } // cv
@@ -0,0 +1,45 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html
+#include "perf_precomp.hpp"
+#include "opencv2/imgproc.hpp"
+
+namespace opencv_test
+{
+using namespace perf;
+
+typedef tuple<string, MatType, int> Ext_Type_Threads_t;
+typedef perf::TestBaseWithParam<Ext_Type_Threads_t> Ext_Type_Threads;
+
+// 8K depth maps and color frames
+PERF_TEST_P(Ext_Type_Threads, imencode_8K,
+            testing::Combine(testing::Values(".png", ".tiff"),
+                             testing::Values(CV_16UC1, CV_8UC3),
+                             testing::Values(1, 4, 0)))
+{
+    const string ext = get<0>(GetParam());
+    const int type = get<1>(GetParam());
+    const int threads = get<2>(GetParam());
+
+    // smooth gradient with noise, roughly the statistics of a depth map
+    Mat img(Size(7680, 4320), type);
+    Mat noise(img.size(), type);
+    for (int y = 0; y < img.rows; y++)
+        img.row(y).setTo(Scalar::all(CV_MAT_DEPTH(type) == CV_8U ? y * 255 / img.rows : y * 65535 / img.rows));
+    randu(noise, Scalar::all(0), Scalar::all(16));
+    cv::add(img, noise, img);
+    GaussianBlur(img, img, Size(5, 5), 0);
+
+    vector<int> params;
+    params.push_back(IMWRITE_THREADS);
+    params.push_back(threads);
+    vector<uchar> buf;
+
+    declare.in(img);
+    TEST_CYCLE() imencode(ext, img, buf, params);
+
+    EXPECT_FALSE(buf.empty());
+    SANITY_CHECK_NOTHING();
+}
+
+} // namespace
@@ -53,12 +53,16 @@ BaseImageDecoder::BaseImageDecoder()
     m_type = -1;
     m_buf_supported = false;
     m_scale_denom = 1;
+    m_rows_read = 0;
 }
 
 bool BaseImageDecoder::setSource( const String& filename )
 {
     m_filename = filename;
     m_buf.release();
+    m_roi = Rect();
+    m_rows_read = 0;
+    m_rows_cache.release();
     return true;
 }
 
@@ -68,6 +72,9 @@ bool BaseImageDecoder::setSource( const Mat& buf )
         return false;
     m_filename = String();
     m_buf = buf;
+    m_roi = Rect();
+    m_rows_read = 0;
+    m_rows_cache.release();
     return true;
 }
 
@@ -82,6 +89,32 @@ bool BaseImageDecoder::checkSignature( const String& signature ) const
     return signature.size() >= len && memcmp( signature.c_str(), m_signature.c_str(), len ) == 0;
 }
 
+bool BaseImageDecoder::setROI( const Rect& )
+{
+    return false;
+}
+
+bool BaseImageDecoder::readRows( Mat& rows )
+{
+    if( m_rows_read == 0 )
+    {
+        m_rows_cache.create( m_height, m_width, rows.type() );
+        if( !readData( m_rows_cache ) )
+        {
+            m_rows_cache.release();
+            return false;
+        }
+    }
+    if( m_rows_cache.empty() || m_rows_read + rows.rows > m_height || rows.type() != m_rows_cache.type() )
+        return false;
+
+    m_rows_cache.rowRange( m_rows_read, m_rows_read + rows.rows ).copyTo( rows );
+    m_rows_read += rows.rows;
+    if( m_rows_read == m_height )
+        m_rows_cache.release();
+    return true;
+}
+
 int BaseImageDecoder::setScale( const int& scale_denom )
 {
     int temp = m_scale_denom;
@@ -132,6 +165,21 @@ bool BaseImageEncoder::writemulti(const std::vector<Mat>&, const std::vector<int
     return false;
 }
 
+bool BaseImageEncoder::writeHeader( Size, int, const std::vector<int>& )
+{
+    return false;
+}
+
+bool BaseImageEncoder::writeRows( const Mat& )
+{
+    return false;
+}
+
+bool BaseImageEncoder::writeEnd()
+{
+    return false;
+}
+
 ImageEncoder BaseImageEncoder::newEncoder() const
 {
     return ImageEncoder();
@@ -71,6 +71,14 @@ public:
     virtual bool readHeader() = 0;
     virtual bool readData( Mat& img ) = 0;
 
+    /// Called after readHeader to restrict readData to a region of the image.
+    /// Returns false if the decoder can only read the whole image.
+    virtual bool setROI( const Rect& roi );
+
+    /// Called after readHeader instead of readData to read the image in bands of rows,
+    /// from top to bottom. The default implementation decodes the whole image on the first call.
+    virtual bool readRows( Mat& rows );
+
     /// Called after readData to advance to the next page, if any.
     virtual bool nextPage() { return false; }
 
@@ -78,11 +86,18 @@ public:
     virtual bool checkSignature( const String& signature ) const;
     virtual ImageDecoder newDecoder() const;
 
+    /// Returns true if readHeader restarts the decoder on a new source,
+    /// so that one instance can decode a sequence of images
+    virtual bool isReusable() const { return false; }
+
 protected:
     int  m_width;  // width  of the image ( filled by readHeader )
     int  m_height; // height of the image ( filled by readHeader )
     int  m_type;
     int  m_scale_denom;
+    Rect m_roi;    // region read by readData ( set by setROI ), empty for the whole image
+    int  m_rows_read; // number of rows returned by readRows
+    Mat  m_rows_cache; // whole image decoded by the default readRows
     String m_filename;
     String m_signature;
     Mat m_buf;
@@ -103,6 +118,13 @@ public:
     virtual bool write( const Mat& img, const std::vector<int>& params ) = 0;
     virtual bool writemulti(const std::vector<Mat>& img_vec, const std::vector<int>& params);
 
+    /// Streaming interface: writeHeader starts an image of the given size and type, writeRows
+    /// appends bands of rows from top to bottom and writeEnd completes the file.
+    /// writeHeader returns false if the encoder can only write whole images.
+    virtual bool writeHeader( Size size, int type, const std::vector<int>& params );
+    virtual bool writeRows( const Mat& rows );
+    virtual bool writeEnd();
+
     virtual String getDescription() const;
     virtual ImageEncoder newEncoder() const;
 
@@ -75,6 +75,11 @@ extern "C" {
 #include "jpeglib.h"
 }
 
+// libjpeg-turbo 1.5+ can skip scanlines and decode a horizontal part of them
+#if defined(LIBJPEG_TURBO_VERSION_NUMBER) && LIBJPEG_TURBO_VERSION_NUMBER >= 1005000
+#define JPEG_CROP_SUPPORTED 1
+#endif
+
 namespace cv
 {
 
@@ -95,6 +100,7 @@ struct JpegState
     jpeg_decompress_struct cinfo; // IJG JPEG codec structure
     JpegErrorMgr jerr; // error processing manager state
     JpegSource source; // memory buffer source
+    JSAMPARRAY rows_buffer; // scanline buffer of readRows
 };
 
 /////////////////////// Error processing /////////////////////
@@ -204,19 +210,64 @@ ImageDecoder JpegDecoder::newDecoder() const
     return makePtr<JpegDecoder>();
 }
 
+static bool isHuffTableEmpty( const JHUFF_TBL* table )
+{
+    if( !table )
+        return true;
+    for( int i = 1; i <= 16; i++ )
+        if( table->bits[i] )
+            return false;
+    return true;
+}
+
+// a quantization table cleared by a reused decompressor, a DQT marker never gives all zero values
+static bool isQuantTableCleared( const JQUANT_TBL* table )
+{
+    for( int i = 0; i < DCTSIZE2; i++ )
+        if( table->quantval[i] )
+            return false;
+    return true;
+}
+
 bool  JpegDecoder::readHeader()
 {
     volatile bool result = false;
-    close();
 
-    JpegState* state = new JpegState;
-    m_state = state;
-    state->cinfo.err = jpeg_std_error(&state->jerr.pub);
-    state->jerr.pub.error_exit = error_exit;
+    // the decompressor of the previous memory buffer is reused. Its tables are kept allocated but
+    // cleared: the cleared Huffman tables get the default ones in prepareDecompress, as the tables a new
+    // decompressor misses, and a stream that relies on a cleared quantization table is rejected
+    JpegState* volatile state = (JpegState*)m_state;
+    const bool reuse = state && !m_buf.empty() && !m_f && state->cinfo.src == &state->source.pub;
+    if( reuse )
+    {
+        jpeg_decompress_struct* cinfo = &state->cinfo;
+        jpeg_abort_decompress( cinfo );
+        for( int i = 0; i < NUM_QUANT_TBLS; i++ )
+            if( cinfo->quant_tbl_ptrs[i] )
+                memset( cinfo->quant_tbl_ptrs[i]->quantval, 0, sizeof(cinfo->quant_tbl_ptrs[i]->quantval) );
+        for( int i = 0; i < NUM_HUFF_TBLS; i++ )
+        {
+            if( cinfo->ac_huff_tbl_ptrs[i] )
+                memset( cinfo->ac_huff_tbl_ptrs[i]->bits, 0, sizeof(cinfo->ac_huff_tbl_ptrs[i]->bits) );
+            if( cinfo->dc_huff_tbl_ptrs[i] )
+                memset( cinfo->dc_huff_tbl_ptrs[i]->bits, 0, sizeof(cinfo->dc_huff_tbl_ptrs[i]->bits) );
+        }
+    }
+    else
+    {
+        close();
+
+        state = new JpegState;
+        m_state = state;
+        state->cinfo.err = jpeg_std_error(&state->jerr.pub);
+        state->jerr.pub.error_exit = error_exit;
+        state->cinfo.src = 0;
+    }
 
     if( setjmp( state->jerr.setjmp_buffer ) == 0 )
     {
-        jpeg_create_decompress( &state->cinfo );
+        if( !state->cinfo.src )
+            jpeg_create_decompress( &state->cinfo );
 
         if( !m_buf.empty() )
         {
@@ -233,7 +284,17 @@ bool  JpegDecoder::readHeader()
 
         if (state->cinfo.src != 0)
         {
-            jpeg_read_header( &state->cinfo, TRUE );
+            // the components of a suspended header are the freed ones of the previous image.
+            // Only the Huffman tables 0 and 1 have defaults, see prepareDecompress
+            bool tables = jpeg_read_header( &state->cinfo, TRUE ) == JPEG_HEADER_OK;
+            for( int i = 0; tables && i < state->cinfo.num_components; i++ )
+            {
+                const jpeg_component_info* comp = &state->cinfo.comp_info[i];
+                const JQUANT_TBL* table = state->cinfo.quant_tbl_ptrs[comp->quant_tbl_no];
+                tables = !( table && isQuantTableCleared( table ) ) &&
+                    !( comp->dc_tbl_no >= 2 && isHuffTableEmpty( state->cinfo.dc_huff_tbl_ptrs[comp->dc_tbl_no] ) ) &&
+                    !( comp->ac_tbl_no >= 2 && isHuffTableEmpty( state->cinfo.ac_huff_tbl_ptrs[comp->ac_tbl_no] ) );
+            }
 
             state->cinfo.scale_num=1;
             state->cinfo.scale_denom = m_scale_denom;
@@ -242,7 +303,7 @@ bool  JpegDecoder::readHeader()
             m_width = state->cinfo.output_width;
             m_height = state->cinfo.output_height;
             m_type = state->cinfo.num_components > 1 ? CV_8UC3 : CV_8UC1;
-            result = true;
+            result = tables;
         }
     }
 
@@ -252,6 +313,13 @@ bool  JpegDecoder::readHeader()
     return result;
 }
 
+bool  JpegDecoder::setROI( const Rect& roi )
+{
+    // rows outside of the region are skipped, columns are cropped when libjpeg supports it
+    m_roi = roi & Rect( 0, 0, m_width, m_height );
+    return true;
+}
+
 /***************************************************************************
  * following code is for supporting MJPEG image files
  * based on a message of Laurent Pinchart on the video4linux mailing list
@@ -386,6 +454,89 @@ int my_jpeg_load_dht (struct jpeg_decompress_struct *info, unsigned char *dht,
  * based on a message of Laurent Pinchart on the video4linux mailing list
  ***************************************************************************/
 
+/// selects the output color space and loads the default Huffman tables of MJPEG frames
+static void prepareDecompress( jpeg_decompress_struct* cinfo, bool color )
+{
+    /* check if this is a mjpeg image format */
+    if ( isHuffTableEmpty( cinfo->ac_huff_tbl_ptrs[0] ) &&
+        isHuffTableEmpty( cinfo->ac_huff_tbl_ptrs[1] ) &&
+        isHuffTableEmpty( cinfo->dc_huff_tbl_ptrs[0] ) &&
+        isHuffTableEmpty( cinfo->dc_huff_tbl_ptrs[1] ) )
+    {
+        /* yes, this is a mjpeg image format, so load the correct
+        huffman table */
+        my_jpeg_load_dht( cinfo,
+            my_jpeg_odml_dht,
+            cinfo->ac_huff_tbl_ptrs,
+            cinfo->dc_huff_tbl_ptrs );
+    }
+    else
+    {
+        /* the tables cleared by a reused decompressor get the default ones,
+        as libjpeg does for the tables a new decompressor misses */
+        JHUFF_TBL scratch[4], *ac_tables[NUM_HUFF_TBLS], *dc_tables[NUM_HUFF_TBLS];
+        bool cleared = false;
+        for( int i = 0; i < NUM_HUFF_TBLS; i++ )
+        {
+            JHUFF_TBL* ac = cinfo->ac_huff_tbl_ptrs[i];
+            JHUFF_TBL* dc = cinfo->dc_huff_tbl_ptrs[i];
+            bool clear_ac = i < 2 && ac && isHuffTableEmpty( ac );
+            bool clear_dc = i < 2 && dc && isHuffTableEmpty( dc );
+            ac_tables[i] = clear_ac ? ac : i < 2 ? &scratch[i] : 0;
+            dc_tables[i] = clear_dc ? dc : i < 2 ? &scratch[i + 2] : 0;
+            cleared = cleared || clear_ac || clear_dc;
+        }
+        if( cleared )
+            my_jpeg_load_dht( cinfo, my_jpeg_odml_dht, ac_tables, dc_tables );
+    }
+
+    if( color )
+    {
+        if( cinfo->num_components != 4 )
+        {
+            cinfo->out_color_space = JCS_RGB;
+            cinfo->out_color_components = 3;
+        }
+        else
+        {
+            cinfo->out_color_space = JCS_CMYK;
+            cinfo->out_color_components = 4;
+        }
+    }
+    else
+    {
+        if( cinfo->num_components != 4 )
+        {
+            cinfo->out_color_space = JCS_GRAYSCALE;
+            cinfo->out_color_components = 1;
+        }
+        else
+        {
+            cinfo->out_color_space = JCS_CMYK;
+            cinfo->out_color_components = 4;
+        }
+    }
+}
+
+/// converts a decoded scanline to BGR or grayscale
+static void convertScanline( const jpeg_decompress_struct* cinfo, const uchar* src, uchar* data, int width, bool color )
+{
+    if( color )
+    {
+        if( cinfo->out_color_components == 3 )
+            icvCvt_RGB2BGR_8u_C3R( src, 0, data, 0, cvSize(width,1) );
+        else
+            icvCvt_CMYK2BGR_8u_C4C3R( src, 0, data, 0, cvSize(width,1) );
+    }
+    else
+    {
+        if( cinfo->out_color_components == 1 )
+            memcpy( data, src, width );
+        else
+            icvCvt_CMYK2Gray_8u_C4C1R( src, 0, data, 0, cvSize(width,1) );
+    }
+}
+
 bool  JpegDecoder::readData( Mat& img )
 {
     volatile bool result = false;
@@ -400,74 +551,92 @@ bool  JpegDecoder::readData( Mat& img )
 
         if( setjmp( jerr->setjmp_buffer ) == 0 )
         {
-            /* check if this is a mjpeg image format */
-            if ( cinfo->ac_huff_tbl_ptrs[0] == NULL &&
-                cinfo->ac_huff_tbl_ptrs[1] == NULL &&
-                cinfo->dc_huff_tbl_ptrs[0] == NULL &&
-                cinfo->dc_huff_tbl_ptrs[1] == NULL )
-            {
-                /* yes, this is a mjpeg image format, so load the correct
-                huffman table */
-                my_jpeg_load_dht( cinfo,
-                    my_jpeg_odml_dht,
-                    cinfo->ac_huff_tbl_ptrs,
-                    cinfo->dc_huff_tbl_ptrs );
-            }
+            prepareDecompress( cinfo, color );
+            jpeg_start_decompress( cinfo );
 
-            if( color )
+            // region of the image to read, the whole image by default
+            Rect roi = m_roi.area() > 0 ? m_roi : Rect( 0, 0, m_width, m_height );
+            JDIMENSION xoffset = 0, xwidth = m_width;
+#ifdef JPEG_CROP_SUPPORTED
+            if( roi.width < m_width )
             {
-                if( cinfo->num_components != 4 )
-                {
-                    cinfo->out_color_space = JCS_RGB;
-                    cinfo->out_color_components = 3;
-                }
-                else
-                {
-                    cinfo->out_color_space = JCS_CMYK;
-                    cinfo->out_color_components = 4;
-                }
-            }
-            else
-            {
-                if( cinfo->num_components != 4 )
-                {
-                    cinfo->out_color_space = JCS_GRAYSCALE;
-                    cinfo->out_color_components = 1;
-                }
-                else
-                {
-                    cinfo->out_color_space = JCS_CMYK;
-                    cinfo->out_color_components = 4;
-                }
+                // keep one pixel around the region, libjpeg replicates the crop borders
+                // when upsampling chroma, so pixels inside match the full decoding
+                xoffset = std::max( roi.x - 1, 0 );
+                xwidth = std::min( roi.x + roi.width + 1, m_width ) - xoffset;
+                jpeg_crop_scanline( cinfo, &xoffset, &xwidth ); // aligns the part to iMCU columns
             }
-
-            jpeg_start_decompress( cinfo );
+            if( roi.y > 0 )
+                jpeg_skip_scanlines( cinfo, roi.y );
+#endif
 
             buffer = (*cinfo->mem->alloc_sarray)((j_common_ptr)cinfo,
-                                              JPOOL_IMAGE, m_width*4, 1 );
+                                              JPOOL_IMAGE, xwidth*4, 1 );
+
+#ifndef JPEG_CROP_SUPPORTED
+            while( (int)cinfo->output_scanline < roi.y )
+                jpeg_read_scanlines( cinfo, buffer, 1 );
+#endif
 
             uchar* data = img.ptr();
-            for( ; m_height--; data += step )
+            for( int i = 0; i < roi.height; i++, data += step )
             {
                 jpeg_read_scanlines( cinfo, buffer, 1 );
-                if( color )
-                {
-                    if( cinfo->out_color_components == 3 )
-                        icvCvt_RGB2BGR_8u_C3R( buffer[0], 0, data, 0, cvSize(m_width,1) );
-                    else
-                        icvCvt_CMYK2BGR_8u_C4C3R( buffer[0], 0, data, 0, cvSize(m_width,1) );
-                }
-                else
-                {
-                    if( cinfo->out_color_components == 1 )
-                        memcpy( data, buffer[0], m_width );
-                    else
-                        icvCvt_CMYK2Gray_8u_C4C1R( buffer[0], 0, data, 0, cvSize(m_width,1) );
-                }
+                uchar* src = buffer[0] + (roi.x - (int)xoffset) * cinfo->out_color_components;
+                convertScanline( cinfo, src, data, roi.width, color );
             }
 
             result = true;
+            // the rows below the region are never decoded
+            if( cinfo->output_scanline < cinfo->output_height )
+                jpeg_abort_decompress( cinfo );
+            else
+                jpeg_finish_decompress( cinfo );
+        }
+    }
+
+    if( result && !m_f )
+    {
+        // keep the decompressor for the next memory buffer, see readHeader
+        m_width = m_height = 0;
+        m_type = -1;
+    }
+    else
+        close();
+    return result;
+}
+
+bool  JpegDecoder::readRows( Mat& rows )
+{
+    volatile bool result = false;
+    bool color = rows.channels() > 1;
+
+    if( m_state && m_width && m_height && m_rows_read + rows.rows <= m_height )
+    {
+        JpegState* state = (JpegState*)m_state;
+        jpeg_decompress_struct* cinfo = &state->cinfo;
+
+        if( setjmp( state->jerr.setjmp_buffer ) == 0 )
+        {
+            if( m_rows_read == 0 )
+            {
+                prepareDecompress( cinfo, color );
+                jpeg_start_decompress( cinfo );
+                state->rows_buffer = (*cinfo->mem->alloc_sarray)((j_common_ptr)cinfo,
+                                                                 JPOOL_IMAGE, m_width*4, 1 );
+            }
+
+            for( int i = 0; i < rows.rows; i++ )
+            {
+                jpeg_read_scanlines( cinfo, state->rows_buffer, 1 );
+                convertScanline( cinfo, state->rows_buffer[0], rows.ptr(i), m_width, color );
+            }
+            m_rows_read += rows.rows;
+
+            if( m_rows_read < m_height )
+                return true;
             jpeg_finish_decompress( cinfo );
+            result = true;
         }
     }
 
@@ -524,15 +693,30 @@ static void jpeg_buffer_dest(j_compress_ptr cinfo, JpegDestination* destination)
 }
 
 
+struct JpegEncoderState
+{
+    jpeg_compress_struct cinfo; // IJG JPEG codec structure
+    JpegErrorMgr jerr; // error processing manager state
+    JpegDestination dest; // memory buffer destination
+    std::vector<uchar> out_buf;
+    FILE* f;
+    int channels; // channels of the written rows
+    AutoBuffer<uchar> buffer; // converted scanline
+
+    JpegEncoderState() : out_buf(1 << 12), f(0), channels(0) {}
+};
+
 JpegEncoder::JpegEncoder()
 {
     m_description = "JPEG files (*.jpeg;*.jpg;*.jpe)";
     m_buf_supported = true;
+    m_state = 0;
 }
 
 
 JpegEncoder::~JpegEncoder()
 {
+    close( false );
 }
 
 ImageEncoder JpegEncoder::newEncoder() const
@@ -540,60 +724,74 @@ ImageEncoder JpegEncoder::newEncoder() const
     return makePtr<JpegEncoder>();
 }
 
-bool JpegEncoder::write( const Mat& img, const std::vector<int>& params )
+void JpegEncoder::close( bool failed )
 {
-    m_last_error.clear();
+    JpegEncoderState* state = (JpegEncoderState*)m_state;
+    if( !state )
+        return;
 
-    struct fileWrapper
+    if( failed )
     {
-        FILE* f;
+        char jmsg_buf[JMSG_LENGTH_MAX];
+        state->jerr.pub.format_message((j_common_ptr)&state->cinfo, jmsg_buf);
+        m_last_error = jmsg_buf;
+    }
 
-        fileWrapper() : f(0) {}
-        ~fileWrapper() { if(f) fclose(f); }
-    };
-    volatile bool result = false;
-    fileWrapper fw;
-    int width = img.cols, height = img.rows;
+    jpeg_destroy_compress( &state->cinfo );
+    if( state->f )
+        fclose( state->f );
+    delete state;
+    m_state = 0;
+}
 
-    std::vector<uchar> out_buf(1 << 12);
-    AutoBuffer<uchar> _buffer;
-    uchar* buffer;
+bool JpegEncoder::writeHeader( Size size, int type, const std::vector<int>& params )
+{
+    m_last_error.clear();
+    close( false );
 
-    struct jpeg_compress_struct cinfo;
-    JpegErrorMgr jerr;
-    JpegDestination dest;
+    if( CV_MAT_DEPTH(type) != CV_8U )
+        return false;
+
+    JpegEncoderState* state = new JpegEncoderState;
+    m_state = state;
+    jpeg_compress_struct& cinfo = state->cinfo;
 
     jpeg_create_compress(&cinfo);
-    cinfo.err = jpeg_std_error(&jerr.pub);
-    jerr.pub.error_exit = error_exit;
+    cinfo.err = jpeg_std_error(&state->jerr.pub);
+    state->jerr.pub.error_exit = error_exit;
 
     if( !m_buf )
     {
-        fw.f = fopen( m_filename.c_str(), "wb" );
-        if( !fw.f )
-            goto _exit_;
-        jpeg_stdio_dest( &cinfo, fw.f );
+        state->f = fopen( m_filename.c_str(), "wb" );
+        if( !state->f )
+        {
+            close( true );
+            return false;
+        }
+        jpeg_stdio_dest( &cinfo, state->f );
     }
     else
     {
+        JpegDestination& dest = state->dest;
         dest.dst = m_buf;
-        dest.buf = &out_buf;
+        dest.buf = &state->out_buf;
 
         jpeg_buffer_dest( &cinfo, &dest );
 
-        dest.pub.next_output_byte = &out_buf[0];
-        dest.pub.free_in_buffer = out_buf.size();
+        dest.pub.next_output_byte = &state->out_buf[0];
+        dest.pub.free_in_buffer = state->out_buf.size();
     }
 
-    if( setjmp( jerr.setjmp_buffer ) == 0 )
+    if( setjmp( state->jerr.setjmp_buffer ) == 0 )
     {
-        cinfo.image_width = width;
-        cinfo.image_height = height;
+        cinfo.image_width = size.width;
+        cinfo.image_height = size.height;
 
-        int _channels = img.channels();
+        int _channels = CV_MAT_CN(type);
         int channels = _channels > 1 ? 3 : 1;
         cinfo.input_components = channels;
         cinfo.in_color_space = channels > 1 ? JCS_RGB : JCS_GRAYSCALE;
+        state->channels = _channels;
 
         int quality = 95;
         int progressive = 0;
@@ -680,10 +878,26 @@ bool JpegEncoder::write( const Mat& img, const std::vector<int>& params )
         jpeg_start_compress( &cinfo, TRUE );
 
         if( channels > 1 )
-            _buffer.allocate(width*channels);
-        buffer = _buffer.data();
+            state->buffer.allocate(size.width*channels);
+        return true;
+    }
+
+    close( true );
+    return false;
+}
+
+bool JpegEncoder::writeRows( const Mat& img )
+{
+    JpegEncoderState* state = (JpegEncoderState*)m_state;
+    if( !state )
+        return false;
 
-        for( int y = 0; y < height; y++ )
+    if( setjmp( state->jerr.setjmp_buffer ) == 0 )
+    {
+        int width = img.cols, _channels = state->channels;
+        uchar* buffer = state->buffer.data();
+
+        for( int y = 0; y < img.rows; y++ )
         {
             uchar *data = img.data + img.step*y, *ptr = data;
 
@@ -698,25 +912,35 @@ bool JpegEncoder::write( const Mat& img, const std::vector<int>& params )
                 ptr = buffer;
             }
 
-            jpeg_write_scanlines( &cinfo, &ptr, 1 );
+            jpeg_write_scanlines( &state->cinfo, &ptr, 1 );
         }
-
-        jpeg_finish_compress( &cinfo );
-        result = true;
+        return true;
     }
 
-_exit_:
+    close( true );
+    return false;
+}
 
-    if(!result)
+bool JpegEncoder::writeEnd()
+{
+    JpegEncoderState* state = (JpegEncoderState*)m_state;
+    if( !state )
+        return false;
+
+    if( setjmp( state->jerr.setjmp_buffer ) == 0 )
     {
-        char jmsg_buf[JMSG_LENGTH_MAX];
-        jerr.pub.format_message((j_common_ptr)&cinfo, jmsg_buf);
-        m_last_error = jmsg_buf;
+        jpeg_finish_compress( &state->cinfo );
+        close( false );
+        return true;
     }
 
-    jpeg_destroy_compress( &cinfo );
+    close( true );
+    return false;
+}
 
-    return result;
+bool JpegEncoder::write( const Mat& img, const std::vector<int>& params )
+{
+    return writeHeader( img.size(), img.type(), params ) && writeRows( img ) && writeEnd();
 }
 
 }
@@ -62,9 +62,12 @@ public:
 
     bool  readData( Mat& img ) CV_OVERRIDE;
     bool  readHeader() CV_OVERRIDE;
+    bool  setROI( const Rect& roi ) CV_OVERRIDE;
+    bool  readRows( Mat& rows ) CV_OVERRIDE;
     void  close();
 
     ImageDecoder newDecoder() const CV_OVERRIDE;
+    bool isReusable() const CV_OVERRIDE { return true; }
 
 protected:
 
@@ -84,7 +87,19 @@ public:
     virtual ~JpegEncoder();
 
     bool  write( const Mat& img, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  writeHeader( Size size, int type, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  writeRows( const Mat& rows ) CV_OVERRIDE;
+    bool  writeEnd() CV_OVERRIDE;
+    void  close( bool failed );
+
     ImageEncoder newEncoder() const CV_OVERRIDE;
+
+protected:
+    void* m_state;
+
+private:
+    JpegEncoder(const JpegEncoder &); // copy disabled
+    JpegEncoder& operator=(const JpegEncoder &); // assign disabled
 };
 
 }
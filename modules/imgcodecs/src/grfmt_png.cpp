@@ -221,15 +221,60 @@ bool  PngDecoder::readHeader()
 }
 
 
+void  PngDecoder::setTransforms( const Mat& img )
+{
+    png_structp png_ptr = (png_structp)m_png_ptr;
+    png_infop info_ptr = (png_infop)m_info_ptr;
+    int color = img.channels() > 1;
+
+    if( img.depth() == CV_8U && m_bit_depth == 16 )
+        png_set_strip_16( png_ptr );
+    else if( !isBigEndian() )
+        png_set_swap( png_ptr );
+
+    if(img.channels() < 4)
+    {
+        /* observation: png_read_image() writes 400 bytes beyond
+         * end of data when reading a 400x118 color png
+         * "mpplus_sand.png".  OpenCV crashes even with demo
+         * programs.  Looking at the loaded image I'd say we get 4
+         * bytes per pixel instead of 3 bytes per pixel.  Test
+         * indicate that it is a good idea to always ask for
+         * stripping alpha..  18.11.2004 Axel Walthelm
+         */
+         png_set_strip_alpha( png_ptr );
+    } else
+        png_set_tRNS_to_alpha( png_ptr );
+
+    if( m_color_type == PNG_COLOR_TYPE_PALETTE )
+        png_set_palette_to_rgb( png_ptr );
+
+    if( (m_color_type & PNG_COLOR_MASK_COLOR) == 0 && m_bit_depth < 8 )
+#if (PNG_LIBPNG_VER_MAJOR*10000 + PNG_LIBPNG_VER_MINOR*100 + PNG_LIBPNG_VER_RELEASE >= 10209) || \
+    (PNG_LIBPNG_VER_MAJOR == 1 && PNG_LIBPNG_VER_MINOR == 0 && PNG_LIBPNG_VER_RELEASE >= 18)
+        png_set_expand_gray_1_2_4_to_8( png_ptr );
+#else
+        png_set_gray_1_2_4_to_8( png_ptr );
+#endif
+
+    if( (m_color_type & PNG_COLOR_MASK_COLOR) && color )
+        png_set_bgr( png_ptr ); // convert RGB to BGR
+    else if( color )
+        png_set_gray_to_rgb( png_ptr ); // Gray->RGB
+    else
+        png_set_rgb_to_gray( png_ptr, 1, 0.299, 0.587 ); // RGB->Gray
+
+    png_set_interlace_handling( png_ptr );
+    png_read_update_info( png_ptr, info_ptr );
+}
+
 bool  PngDecoder::readData( Mat& img )
 {
     volatile bool result = false;
     AutoBuffer<uchar*> _buffer(m_height);
     uchar** buffer = _buffer.data();
-    int color = img.channels() > 1;
 
     png_structp png_ptr = (png_structp)m_png_ptr;
-    png_infop info_ptr = (png_infop)m_info_ptr;
     png_infop end_info = (png_infop)m_end_info;
 
     if( m_png_ptr && m_info_ptr && m_end_info && m_width && m_height )
@@ -238,45 +283,7 @@ bool  PngDecoder::readData( Mat& img )
         {
             int y;
 
-            if( img.depth() == CV_8U && m_bit_depth == 16 )
-                png_set_strip_16( png_ptr );
-            else if( !isBigEndian() )
-                png_set_swap( png_ptr );
-
-            if(img.channels() < 4)
-            {
-                /* observation: png_read_image() writes 400 bytes beyond
-                 * end of data when reading a 400x118 color png
-                 * "mpplus_sand.png".  OpenCV crashes even with demo
-                 * programs.  Looking at the loaded image I'd say we get 4
-                 * bytes per pixel instead of 3 bytes per pixel.  Test
-                 * indicate that it is a good idea to always ask for
-                 * stripping alpha..  18.11.2004 Axel Walthelm
-                 */
-                 png_set_strip_alpha( png_ptr );
-            } else
-                png_set_tRNS_to_alpha( png_ptr );
-
-            if( m_color_type == PNG_COLOR_TYPE_PALETTE )
-                png_set_palette_to_rgb( png_ptr );
-
-            if( (m_color_type & PNG_COLOR_MASK_COLOR) == 0 && m_bit_depth < 8 )
-#if (PNG_LIBPNG_VER_MAJOR*10000 + PNG_LIBPNG_VER_MINOR*100 + PNG_LIBPNG_VER_RELEASE >= 10209) || \
-    (PNG_LIBPNG_VER_MAJOR == 1 && PNG_LIBPNG_VER_MINOR == 0 && PNG_LIBPNG_VER_RELEASE >= 18)
-                png_set_expand_gray_1_2_4_to_8( png_ptr );
-#else
-                png_set_gray_1_2_4_to_8( png_ptr );
-#endif
-
-            if( (m_color_type & PNG_COLOR_MASK_COLOR) && color )
-                png_set_bgr( png_ptr ); // convert RGB to BGR
-            else if( color )
-                png_set_gray_to_rgb( png_ptr ); // Gray->RGB
-            else
-                png_set_rgb_to_gray( png_ptr, 1, 0.299, 0.587 ); // RGB->Gray
-
-            png_set_interlace_handling( png_ptr );
-            png_read_update_info( png_ptr, info_ptr );
+            setTransforms( img );
 
             for( y = 0; y < m_height; y++ )
                 buffer[y] = img.data + y*img.step;
@@ -292,6 +299,40 @@ bool  PngDecoder::readData( Mat& img )
     return result;
 }
 
+bool  PngDecoder::readRows( Mat& rows )
+{
+    png_structp png_ptr = (png_structp)m_png_ptr;
+    volatile bool result = false;
+
+    // all passes of an interlaced image are needed for any row, so it is decoded at once
+    bool interlaced = png_ptr && m_info_ptr &&
+        png_get_interlace_type( png_ptr, (png_infop)m_info_ptr ) != PNG_INTERLACE_NONE;
+    if( m_rows_read == 0 ? interlaced : !m_rows_cache.empty() )
+        return BaseImageDecoder::readRows( rows );
+
+    if( png_ptr && m_info_ptr && m_end_info && m_width && m_height &&
+        m_rows_read + rows.rows <= m_height )
+    {
+        if( setjmp( png_jmpbuf ( png_ptr ) ) == 0 )
+        {
+            if( m_rows_read == 0 )
+                setTransforms( rows );
+
+            for( int y = 0; y < rows.rows; y++ )
+                png_read_row( png_ptr, rows.ptr(y), NULL );
+            m_rows_read += rows.rows;
+
+            if( m_rows_read < m_height )
+                return true;
+            png_read_end( png_ptr, (png_infop)m_end_info );
+            result = true;
+        }
+    }
+
+    close();
+    return result;
+}
+
 
 /////////////////////// PngEncoder ///////////////////
 
@@ -300,11 +341,18 @@ PngEncoder::PngEncoder()
 {
     m_description = "Portable Network Graphics files (*.png)";
     m_buf_supported = true;
+    m_png_ptr = m_info_ptr = 0;
+    m_f = 0;
+    m_nstripes = 1;
+    m_compression_level = Z_BEST_SPEED;
+    m_compression_strategy = IMWRITE_PNG_STRATEGY_RLE;
+    m_adaptive_filter = false;
 }
 
 
 PngEncoder::~PngEncoder()
 {
+    close();
 }
 
 
@@ -336,111 +384,420 @@ void PngEncoder::flushBuf(void*)
 {
 }
 
-bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
+/////////////////////// Multithreaded PNG encoding ///////////////////
+
+// The image data of a PNG file is one zlib stream. It is split into horizontal stripes
+// that are filtered and deflated independently, each stripe is primed with the last 32K
+// of the previous one, so the compression ratio stays close to the single-threaded one.
+// The raw deflate streams of the stripes are byte-aligned by a sync flush and concatenated,
+// the adler32 checksum of the whole stream is combined from the checksums of the stripes.
+
+static const int PNG_MIN_STRIPE_SIZE = 1 << 17;
+static const int PNG_MAX_IDAT_SIZE = 1 << 20;
+
+/// converts a row to the PNG layout: RGB(A) channel order and big endian 16-bit samples
+static void pngConvertRow( const Mat& img, int y, uchar* dst )
 {
-    png_structp png_ptr = png_create_write_struct( PNG_LIBPNG_VER_STRING, 0, 0, 0 );
-    png_infop info_ptr = 0;
-    FILE * volatile f = 0;
-    int y, width = img.cols, height = img.rows;
-    int depth = img.depth(), channels = img.channels();
-    volatile bool result = false;
-    AutoBuffer<uchar*> buffer;
+    int width = img.cols, cn = img.channels();
+    if( img.depth() == CV_8U )
+    {
+        if( cn == 3 )
+            icvCvt_BGR2RGB_8u_C3R( img.ptr(y), 0, dst, 0, cvSize(width, 1) );
+        else if( cn == 4 )
+            icvCvt_BGRA2RGBA_8u_C4R( img.ptr(y), 0, dst, 0, cvSize(width, 1) );
+        else
+            memcpy( dst, img.ptr(y), width*cn );
+    }
+    else
+    {
+        ushort* d = (ushort*)dst;
+        if( cn == 3 )
+            icvCvt_BGR2RGB_16u_C3R( img.ptr<ushort>(y), 0, d, 0, cvSize(width, 1) );
+        else if( cn == 4 )
+            icvCvt_BGRA2RGBA_16u_C4R( img.ptr<ushort>(y), 0, d, 0, cvSize(width, 1) );
+        else
+            memcpy( d, img.ptr(y), width*cn*sizeof(d[0]) );
+        if( !isBigEndian() )
+            for( int i = 0; i < width*cn; i++ )
+                d[i] = (ushort)((d[i] >> 8) | (d[i] << 8));
+    }
+}
 
-    if( depth != CV_8U && depth != CV_16U )
-        return false;
+static inline int pngPaethPredictor( int a, int b, int c )
+{
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
 
-    if( png_ptr )
+/// writes the filter type byte followed by the filtered row, prev is the previous unfiltered row
+static void pngFilterRow( int filter, const uchar* row, const uchar* prev, uchar* dst, int rowbytes, int bpp )
+{
+    int i = 0;
+    *dst++ = (uchar)filter;
+    switch( filter )
     {
-        info_ptr = png_create_info_struct( png_ptr );
+    case PNG_FILTER_VALUE_SUB:
+        for( ; i < bpp; i++ )
+            dst[i] = row[i];
+        for( ; i < rowbytes; i++ )
+            dst[i] = (uchar)(row[i] - row[i - bpp]);
+        break;
+    case PNG_FILTER_VALUE_UP:
+        for( ; i < rowbytes; i++ )
+            dst[i] = (uchar)(row[i] - prev[i]);
+        break;
+    case PNG_FILTER_VALUE_AVG:
+        for( ; i < bpp; i++ )
+            dst[i] = (uchar)(row[i] - (prev[i] >> 1));
+        for( ; i < rowbytes; i++ )
+            dst[i] = (uchar)(row[i] - ((row[i - bpp] + prev[i]) >> 1));
+        break;
+    case PNG_FILTER_VALUE_PAETH:
+        for( ; i < bpp; i++ )
+            dst[i] = (uchar)(row[i] - prev[i]);
+        for( ; i < rowbytes; i++ )
+            dst[i] = (uchar)(row[i] - pngPaethPredictor(row[i - bpp], prev[i], prev[i - bpp]));
+        break;
+    default:
+        memcpy( dst, row, rowbytes );
+    }
+}
 
-        if( info_ptr )
-        {
-            if( setjmp( png_jmpbuf ( png_ptr ) ) == 0 )
-            {
-                if( m_buf )
-                {
-                    png_set_write_fn(png_ptr, this,
-                        (png_rw_ptr)writeDataToBuf, (png_flush_ptr)flushBuf);
-                }
-                else
-                {
-                    f = fopen( m_filename.c_str(), "wb" );
-                    if( f )
-                        png_init_io( png_ptr, (png_FILE_p)f );
-                }
+/// sum of the absolute values of the filtered bytes, the heuristic libpng uses to select a filter
+static unsigned pngFilterCost( const uchar* filtered, int rowbytes )
+{
+    unsigned cost = 0;
+    for( int i = 1; i <= rowbytes; i++ )
+        cost += filtered[i] < 128 ? filtered[i] : 256 - filtered[i];
+    return cost;
+}
 
-                int compression_level = -1; // Invalid value to allow setting 0-9 as valid
-                int compression_strategy = IMWRITE_PNG_STRATEGY_RLE; // Default strategy
-                bool isBilevel = false;
+class PngFilterInvoker : public ParallelLoopBody
+{
+public:
+    PngFilterInvoker( const Mat& img, Mat& filtered, bool adaptive )
+        : img_(img), filtered_(filtered), adaptive_(adaptive)
+    {}
 
-                for( size_t i = 0; i < params.size(); i += 2 )
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        const int rowbytes = filtered_.cols - 1;
+        const int bpp = (int)img_.elemSize();
+        AutoBuffer<uchar> _buf( rowbytes*2 + filtered_.cols*PNG_FILTER_VALUE_LAST );
+        uchar* row = _buf.data();
+        uchar* prev = row + rowbytes;
+        uchar* candidates = prev + rowbytes;
+
+        if( range.start > 0 )
+            pngConvertRow( img_, range.start - 1, prev );
+        else
+            memset( prev, 0, rowbytes );
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            uchar* dst = filtered_.ptr(y);
+            pngConvertRow( img_, y, row );
+            if( !adaptive_ )
+                pngFilterRow( PNG_FILTER_VALUE_SUB, row, prev, dst, rowbytes, bpp );
+            else
+            {
+                int best = 0;
+                unsigned bestCost = UINT_MAX;
+                for( int f = PNG_FILTER_VALUE_NONE; f < PNG_FILTER_VALUE_LAST; f++ )
                 {
-                    if( params[i] == IMWRITE_PNG_COMPRESSION )
-                    {
-                        compression_strategy = IMWRITE_PNG_STRATEGY_DEFAULT; // Default strategy
-                        compression_level = params[i+1];
-                        compression_level = MIN(MAX(compression_level, 0), Z_BEST_COMPRESSION);
-                    }
-                    if( params[i] == IMWRITE_PNG_STRATEGY )
-                    {
-                        compression_strategy = params[i+1];
-                        compression_strategy = MIN(MAX(compression_strategy, 0), Z_FIXED);
-                    }
-                    if( params[i] == IMWRITE_PNG_BILEVEL )
+                    uchar* candidate = candidates + f*filtered_.cols;
+                    pngFilterRow( f, row, prev, candidate, rowbytes, bpp );
+                    unsigned cost = pngFilterCost( candidate, rowbytes );
+                    if( cost < bestCost )
                     {
-                        isBilevel = params[i+1] != 0;
+                        bestCost = cost;
+                        best = f;
                     }
                 }
+                memcpy( dst, candidates + best*filtered_.cols, filtered_.cols );
+            }
+            std::swap( row, prev );
+        }
+    }
 
-                if( m_buf || f )
-                {
-                    if( compression_level >= 0 )
-                    {
-                        png_set_compression_level( png_ptr, compression_level );
-                    }
-                    else
-                    {
-                        // tune parameters for speed
-                        // (see http://wiki.linuxquestions.org/wiki/Libpng)
-                        png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_SUB);
-                        png_set_compression_level(png_ptr, Z_BEST_SPEED);
-                    }
-                    png_set_compression_strategy(png_ptr, compression_strategy);
+private:
+    const Mat& img_;
+    Mat& filtered_;
+    bool adaptive_;
+};
 
-                    png_set_IHDR( png_ptr, info_ptr, width, height, depth == CV_8U ? isBilevel?1:8 : 16,
-                        channels == 1 ? PNG_COLOR_TYPE_GRAY :
-                        channels == 3 ? PNG_COLOR_TYPE_RGB : PNG_COLOR_TYPE_RGBA,
-                        PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
-                        PNG_FILTER_TYPE_DEFAULT );
+class PngDeflateInvoker : public ParallelLoopBody
+{
+public:
+    PngDeflateInvoker( const Mat& filtered, int nstripes, int level, int strategy,
+                       std::vector<std::vector<uchar> >& streams, std::vector<uLong>& checksums )
+        : filtered_(filtered), nstripes_(nstripes), level_(level), strategy_(strategy),
+          streams_(streams), checksums_(checksums)
+    {}
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        const size_t linebytes = filtered_.cols;
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int y0 = (int)((int64)filtered_.rows*i/nstripes_), y1 = (int)((int64)filtered_.rows*(i + 1)/nstripes_);
+            const uchar* src = filtered_.ptr(y0);
+            size_t size = linebytes*(y1 - y0);
+            bool last = i == nstripes_ - 1;
+            std::vector<uchar>& stream = streams_[i];
+            stream.clear();
+            checksums_[i] = adler32( adler32(0L, Z_NULL, 0), src, (uInt)size );
+
+            z_stream strm;
+            memset( &strm, 0, sizeof(strm) );
+            // raw deflate, the zlib header and trailer are written once for the whole image
+            if( deflateInit2( &strm, level_, Z_DEFLATED, -MAX_WBITS, 8, strategy_ ) != Z_OK )
+                continue;
+            if( y0 > 0 )
+            {
+                size_t dictSize = std::min( (size_t)(1 << MAX_WBITS), linebytes*y0 );
+                deflateSetDictionary( &strm, src - dictSize, (uInt)dictSize );
+            }
+            // the sync flush of the intermediate stripes appends an empty stored block
+            stream.resize( deflateBound( &strm, (uLong)size ) + 16 );
+            strm.next_in = (Bytef*)src;
+            strm.avail_in = (uInt)size;
+            strm.next_out = &stream[0];
+            strm.avail_out = (uInt)stream.size();
+            int ret = deflate( &strm, last ? Z_FINISH : Z_SYNC_FLUSH );
+            if( ret == (last ? Z_STREAM_END : Z_OK) && strm.avail_in == 0 )
+                stream.resize( strm.total_out );
+            else
+                stream.clear();
+            deflateEnd( &strm );
+        }
+    }
 
-                    png_write_info( png_ptr, info_ptr );
+private:
+    const Mat& filtered_;
+    int nstripes_, level_, strategy_;
+    std::vector<std::vector<uchar> >& streams_;
+    std::vector<uLong>& checksums_;
+};
 
-                    if (isBilevel)
-                        png_set_packing(png_ptr);
+/// writes the IDAT chunks of the image compressed by nstripes threads
+static bool pngWriteImageParallel( png_structp png_ptr, const Mat& img, int nstripes, int level, bool adaptive, int strategy )
+{
+    int rowbytes = img.cols*(int)img.elemSize();
+    Mat filtered( img.rows, rowbytes + 1, CV_8U );
+    parallel_for_( Range(0, img.rows), PngFilterInvoker(img, filtered, adaptive), nstripes );
+
+    std::vector<std::vector<uchar> > streams(nstripes);
+    std::vector<uLong> checksums(nstripes);
+    parallel_for_( Range(0, nstripes), PngDeflateInvoker(filtered, nstripes, level, strategy, streams, checksums), nstripes );
+
+    // zlib header: deflate with 32K window, FLEVEL as zlib would set it, no preset dictionary
+    int flevel = strategy >= Z_HUFFMAN_ONLY || level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+    int cmf = 0x78, flg = flevel << 6;
+    flg += 31 - (cmf*256 + flg) % 31;
+
+    std::vector<uchar> idat;
+    idat.push_back( (uchar)cmf );
+    idat.push_back( (uchar)flg );
+    uLong adler = 1;
+    for( int i = 0; i < nstripes; i++ )
+    {
+        if( streams[i].empty() )
+            return false;
+        idat.insert( idat.end(), streams[i].begin(), streams[i].end() );
+        int y0 = (int)((int64)img.rows*i/nstripes), y1 = (int)((int64)img.rows*(i + 1)/nstripes);
+        adler = i == 0 ? checksums[i] : adler32_combine( adler, checksums[i], (z_off_t)filtered.cols*(y1 - y0) );
+    }
+    for( int shift = 24; shift >= 0; shift -= 8 )
+        idat.push_back( (uchar)(adler >> shift) );
+
+    static const png_byte png_IDAT[5] = { 'I', 'D', 'A', 'T', '\0' };
+    static const png_byte png_IEND[5] = { 'I', 'E', 'N', 'D', '\0' };
+    for( size_t ofs = 0; ofs < idat.size(); ofs += PNG_MAX_IDAT_SIZE )
+        png_write_chunk( png_ptr, png_IDAT, &idat[ofs], std::min(idat.size() - ofs, (size_t)PNG_MAX_IDAT_SIZE) );
+    png_write_chunk( png_ptr, png_IEND, NULL, 0 );
+    return true;
+}
 
-                    png_set_bgr( png_ptr );
-                    if( !isBigEndian() )
-                        png_set_swap( png_ptr );
+bool  PngEncoder::writeHeader( Size size, int type, const std::vector<int>& params )
+{
+    int width = size.width, height = size.height;
+    int depth = CV_MAT_DEPTH(type), channels = CV_MAT_CN(type);
 
-                    buffer.allocate(height);
-                    for( y = 0; y < height; y++ )
-                        buffer[y] = img.data + y*img.step;
+    if( depth != CV_8U && depth != CV_16U )
+        return false;
 
-                    png_write_image( png_ptr, buffer.data() );
-                    png_write_end( png_ptr, info_ptr );
+    close();
+    png_structp png_ptr = png_create_write_struct( PNG_LIBPNG_VER_STRING, 0, 0, 0 );
+    if( !png_ptr )
+        return false;
+    png_infop info_ptr = png_create_info_struct( png_ptr );
+    m_png_ptr = png_ptr;
+    m_info_ptr = info_ptr;
+    if( !info_ptr )
+    {
+        close();
+        return false;
+    }
 
-                    result = true;
-                }
+    if( setjmp( png_jmpbuf ( png_ptr ) ) == 0 )
+    {
+        if( m_buf )
+        {
+            png_set_write_fn(png_ptr, this,
+                (png_rw_ptr)writeDataToBuf, (png_flush_ptr)flushBuf);
+        }
+        else
+        {
+            m_f = fopen( m_filename.c_str(), "wb" );
+            if( m_f )
+                png_init_io( png_ptr, (png_FILE_p)m_f );
+        }
+
+        int compression_level = -1; // Invalid value to allow setting 0-9 as valid
+        int compression_strategy = IMWRITE_PNG_STRATEGY_RLE; // Default strategy
+        bool isBilevel = false;
+        int threads = 1;
+
+        for( size_t i = 0; i < params.size(); i += 2 )
+        {
+            if( params[i] == IMWRITE_PNG_COMPRESSION )
+            {
+                compression_strategy = IMWRITE_PNG_STRATEGY_DEFAULT; // Default strategy
+                compression_level = params[i+1];
+                compression_level = MIN(MAX(compression_level, 0), Z_BEST_COMPRESSION);
+            }
+            if( params[i] == IMWRITE_PNG_STRATEGY )
+            {
+                compression_strategy = params[i+1];
+                compression_strategy = MIN(MAX(compression_strategy, 0), Z_FIXED);
+            }
+            if( params[i] == IMWRITE_PNG_BILEVEL )
+            {
+                isBilevel = params[i+1] != 0;
+            }
+            if( params[i] == IMWRITE_THREADS )
+            {
+                threads = params[i+1] > 0 ? params[i+1] : getNumThreads();
             }
         }
+
+        // every thread compresses a stripe of at least PNG_MIN_STRIPE_SIZE bytes
+        m_nstripes = 1;
+        if( threads > 1 && !isBilevel && (channels == 1 || channels == 3 || channels == 4) )
+            m_nstripes = (int)std::min( (size_t)threads, (size_t)size.area()*CV_ELEM_SIZE(type)/PNG_MIN_STRIPE_SIZE );
+        m_compression_level = compression_level >= 0 ? compression_level : Z_BEST_SPEED;
+        m_adaptive_filter = compression_level >= 0;
+        m_compression_strategy = compression_strategy;
+
+        if( m_buf || m_f )
+        {
+            if( compression_level >= 0 )
+            {
+                png_set_compression_level( png_ptr, compression_level );
+            }
+            else
+            {
+                // tune parameters for speed
+                // (see http://wiki.linuxquestions.org/wiki/Libpng)
+                png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_SUB);
+                png_set_compression_level(png_ptr, Z_BEST_SPEED);
+            }
+            png_set_compression_strategy(png_ptr, compression_strategy);
+
+            png_set_IHDR( png_ptr, info_ptr, width, height, depth == CV_8U ? isBilevel?1:8 : 16,
+                channels == 1 ? PNG_COLOR_TYPE_GRAY :
+                channels == 3 ? PNG_COLOR_TYPE_RGB : PNG_COLOR_TYPE_RGBA,
+                PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
+                PNG_FILTER_TYPE_DEFAULT );
+
+            png_write_info( png_ptr, info_ptr );
+
+            if (isBilevel)
+                png_set_packing(png_ptr);
+
+            png_set_bgr( png_ptr );
+            if( !isBigEndian() )
+                png_set_swap( png_ptr );
+
+            return true;
+        }
+    }
+
+    close();
+    return false;
+}
+
+bool  PngEncoder::writeRows( const Mat& rows )
+{
+    png_structp png_ptr = (png_structp)m_png_ptr;
+    if( !png_ptr )
+        return false;
+
+    if( setjmp( png_jmpbuf ( png_ptr ) ) == 0 )
+    {
+        for( int y = 0; y < rows.rows; y++ )
+            png_write_row( png_ptr, rows.ptr(y) );
+        return true;
     }
 
-    png_destroy_write_struct( &png_ptr, &info_ptr );
-    if(f) fclose( (FILE*)f );
+    close();
+    return false;
+}
+
+bool  PngEncoder::writeEnd()
+{
+    png_structp png_ptr = (png_structp)m_png_ptr;
+    volatile bool result = false;
+    if( !png_ptr )
+        return false;
+
+    if( setjmp( png_jmpbuf ( png_ptr ) ) == 0 )
+    {
+        png_write_end( png_ptr, (png_infop)m_info_ptr );
+        result = true;
+    }
 
+    close();
     return result;
 }
 
+void  PngEncoder::close()
+{
+    if( m_png_ptr )
+    {
+        png_structp png_ptr = (png_structp)m_png_ptr;
+        png_infop info_ptr = (png_infop)m_info_ptr;
+        png_destroy_write_struct( &png_ptr, &info_ptr );
+        m_png_ptr = m_info_ptr = 0;
+    }
+    if( m_f )
+    {
+        fclose( m_f );
+        m_f = 0;
+    }
+}
+
+bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
+{
+    if( !writeHeader( img.size(), img.type(), params ) )
+        return false;
+
+    if( m_nstripes > 1 )
+    {
+        png_structp png_ptr = (png_structp)m_png_ptr;
+        volatile bool result = false;
+        if( setjmp( png_jmpbuf ( png_ptr ) ) == 0 )
+            result = pngWriteImageParallel( png_ptr, img, m_nstripes, m_compression_level,
+                                            m_adaptive_filter, m_compression_strategy );
+        close();
+        return result;
+    }
+
+    return writeRows( img ) && writeEnd();
+}
+
 }
 
 #endif
@@ -60,13 +60,16 @@ public:
 
     bool  readData( Mat& img ) CV_OVERRIDE;
     bool  readHeader() CV_OVERRIDE;
+    bool  readRows( Mat& rows ) CV_OVERRIDE;
     void  close();
 
     ImageDecoder newDecoder() const CV_OVERRIDE;
+    bool isReusable() const CV_OVERRIDE { return true; }
 
 protected:
 
     static void readDataFromBuf(void* png_ptr, uchar* dst, size_t size);
+    void  setTransforms( const Mat& img );
 
     int   m_bit_depth;
     void* m_png_ptr;  // pointer to decompression structure
@@ -86,12 +89,24 @@ public:
 
     bool  isFormatSupported( int depth ) const CV_OVERRIDE;
     bool  write( const Mat& img, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  writeHeader( Size size, int type, const std::vector<int>& params ) CV_OVERRIDE;
+    bool  writeRows( const Mat& rows ) CV_OVERRIDE;
+    bool  writeEnd() CV_OVERRIDE;
+    void  close();
 
     ImageEncoder newEncoder() const CV_OVERRIDE;
 
 protected:
     static void writeDataToBuf(void* png_ptr, uchar* src, size_t size);
     static void flushBuf(void* png_ptr);
+
+    void* m_png_ptr;  // pointer to compression structure
+    void* m_info_ptr; // pointer to image information structure
+    FILE* m_f;
+    int   m_nstripes; // number of stripes compressed in parallel by write
+    int   m_compression_level;
+    int   m_compression_strategy;
+    bool  m_adaptive_filter;
 };
 
 }
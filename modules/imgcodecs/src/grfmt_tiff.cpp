@@ -287,8 +287,50 @@ bool TiffDecoder::nextPage()
            readHeader();
 }
 
+bool  TiffDecoder::setROI( const Rect& roi )
+{
+    // only the strips or tiles intersecting the region are read
+    m_roi = roi & Rect( 0, 0, m_width, m_height );
+    return true;
+}
+
+bool  TiffDecoder::readRows( Mat& rows )
+{
+    uint16 img_orientation = ORIENTATION_TOPLEFT;
+    if( m_tif )
+        TIFFGetField( (TIFF*)m_tif, TIFFTAG_ORIENTATION, &img_orientation );
+    if( !m_tif || m_hdr || rows.type() == CV_32FC1 || img_orientation != ORIENTATION_TOPLEFT )
+        return BaseImageDecoder::readRows( rows );
+
+    // a band is read like a region, only from the strips or tiles intersecting it
+    if( m_rows_read + rows.rows > m_height )
+        return false;
+    m_roi = Rect( 0, m_rows_read, m_width, rows.rows );
+    bool result = readData( rows );
+    m_roi = Rect();
+    m_rows_read += rows.rows;
+    return result;
+}
+
 bool  TiffDecoder::readData( Mat& img )
 {
+    if( m_roi.area() > 0 && m_tif )
+    {
+        uint16 img_orientation = ORIENTATION_TOPLEFT;
+        TIFFGetField( (TIFF*)m_tif, TIFFTAG_ORIENTATION, &img_orientation );
+        if( m_hdr || img.type() == CV_32FC1 || img_orientation != ORIENTATION_TOPLEFT )
+        {
+            // these layouts are read as a whole, crop the region afterwards
+            Rect roi = m_roi;
+            m_roi = Rect();
+            Mat full( m_height, m_width, img.type() );
+            if( !readData( full ) )
+                return false;
+            full( roi ).copyTo( img );
+            return true;
+        }
+    }
+
     if(m_hdr && img.type() == CV_32FC3)
     {
         return readData_32FC3(img);
@@ -358,20 +400,36 @@ bool  TiffDecoder::readData( Mat& img )
             ushort* buffer16 = (ushort*)buffer;
             float* buffer32 = (float*)buffer;
             double* buffer64 = (double*)buffer;
-            int tileidx = 0;
+            const int tiles_per_row = ((int)m_width + (int)tile_width0 - 1) / (int)tile_width0;
 
-            for( y = 0; y < m_height; y += tile_height0 )
+            // a region is decoded into a canvas covering the tiles intersecting it,
+            // the whole image is decoded directly into img
+            int x0 = 0, y0 = 0, x1 = m_width, y1 = m_height;
+            Mat canvas = img;
+            if( m_roi.area() > 0 )
+            {
+                x0 = m_roi.x - m_roi.x % (int)tile_width0;
+                y0 = m_roi.y - m_roi.y % (int)tile_height0;
+                // tile sizes are not necessarily powers of 2, so alignSize() can't be used
+                x1 = std::min( (m_roi.x + m_roi.width + (int)tile_width0 - 1) / (int)tile_width0 * (int)tile_width0, m_width );
+                y1 = std::min( (m_roi.y + m_roi.height + (int)tile_height0 - 1) / (int)tile_height0 * (int)tile_height0, m_height );
+                canvas.create( y1 - y0, x1 - x0, img.type() );
+            }
+
+            for( y = y0; y < y1; y += tile_height0 )
             {
                 int tile_height = tile_height0;
 
                 if( y + tile_height > m_height )
                     tile_height = m_height - y;
 
-                uchar* data = img.ptr(vert_flip ? m_height - y - tile_height : y);
+                uchar* data = canvas.ptr(vert_flip ? m_height - y - tile_height : y - y0);
+                int tileidx = (y / (int)tile_height0) * tiles_per_row + x0 / (int)tile_width0;
 
-                for( x = 0; x < m_width; x += tile_width0, tileidx++ )
+                for( x = x0; x < x1; x += tile_width0, tileidx++ )
                 {
                     int tile_width = tile_width0, ok;
+                    const int dx = x - x0;
 
                     if( x + tile_width > m_width )
                         tile_width = m_width - x;
@@ -401,19 +459,19 @@ bool  TiffDecoder::readData( Mat& img )
                                     if (wanted_channels == 4)
                                     {
                                         icvCvt_BGRA2RGBA_8u_C4R( bstart + i*tile_width0*4, 0,
-                                                             data + x*4 + img.step*(tile_height - i - 1), 0,
+                                                             data + dx*4 + canvas.step*(tile_height - i - 1), 0,
                                                              cvSize(tile_width,1) );
                                     }
                                     else
                                     {
                                         icvCvt_BGRA2BGR_8u_C4C3R( bstart + i*tile_width0*4, 0,
-                                                             data + x*3 + img.step*(tile_height - i - 1), 0,
+                                                             data + dx*3 + canvas.step*(tile_height - i - 1), 0,
                                                              cvSize(tile_width,1), 2 );
                                     }
                                 }
                                 else
                                     icvCvt_BGRA2Gray_8u_C4C1R( bstart + i*tile_width0*4, 0,
-                                                              data + x + img.step*(tile_height - i - 1), 0,
+                                                              data + dx + canvas.step*(tile_height - i - 1), 0,
                                                               cvSize(tile_width,1), 2 );
                             break;
                         }
@@ -438,13 +496,13 @@ bool  TiffDecoder::readData( Mat& img )
                                     if( ncn == 1 )
                                     {
                                         icvCvt_Gray2BGR_16u_C1C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                                  (ushort*)(data + img.step*i) + x*3, 0,
+                                                                  (ushort*)(data + canvas.step*i) + dx*3, 0,
                                                                   cvSize(tile_width,1) );
                                     }
                                     else if( ncn == 3 )
                                     {
                                         icvCvt_RGB2BGR_16u_C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x*3, 0,
+                                                               (ushort*)(data + canvas.step*i) + dx*3, 0,
                                                                cvSize(tile_width,1) );
                                     }
                                     else if (ncn == 4)
@@ -452,20 +510,20 @@ bool  TiffDecoder::readData( Mat& img )
                                         if (wanted_channels == 4)
                                         {
                                             icvCvt_BGRA2RGBA_16u_C4R(buffer16 + i*tile_width0*ncn, 0,
-                                                (ushort*)(data + img.step*i) + x * 4, 0,
+                                                (ushort*)(data + canvas.step*i) + dx * 4, 0,
                                                 cvSize(tile_width, 1));
                                         }
                                         else
                                         {
                                             icvCvt_BGRA2BGR_16u_C4C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                (ushort*)(data + img.step*i) + x * 3, 0,
+                                                (ushort*)(data + canvas.step*i) + dx * 3, 0,
                                                 cvSize(tile_width, 1), 2);
                                         }
                                     }
                                     else
                                     {
                                         icvCvt_BGRA2BGR_16u_C4C3R(buffer16 + i*tile_width0*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x*3, 0,
+                                                               (ushort*)(data + canvas.step*i) + dx*3, 0,
                                                                cvSize(tile_width,1), 2 );
                                     }
                                 }
@@ -473,14 +531,14 @@ bool  TiffDecoder::readData( Mat& img )
                                 {
                                     if( ncn == 1 )
                                     {
-                                        memcpy((ushort*)(data + img.step*i)+x,
+                                        memcpy((ushort*)(data + canvas.step*i)+dx,
                                                buffer16 + i*tile_width0*ncn,
                                                tile_width*sizeof(buffer16[0]));
                                     }
                                     else
                                     {
                                         icvCvt_BGRA2Gray_16u_CnC1R(buffer16 + i*tile_width0*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x, 0,
+                                                               (ushort*)(data + canvas.step*i) + dx, 0,
                                                                cvSize(tile_width,1), ncn, 2 );
                                     }
                                 }
@@ -506,13 +564,13 @@ bool  TiffDecoder::readData( Mat& img )
                             {
                                 if(dst_bpp == 32)
                                 {
-                                    memcpy((float*)(data + img.step*i)+x,
+                                    memcpy((float*)(data + canvas.step*i)+dx,
                                            buffer32 + i*tile_width0*ncn,
                                            tile_width*sizeof(buffer32[0]));
                                 }
                                 else
                                 {
-                                    memcpy((double*)(data + img.step*i)+x,
+                                    memcpy((double*)(data + canvas.step*i)+dx,
                                          buffer64 + i*tile_width0*ncn,
                                          tile_width*sizeof(buffer64[0]));
                                 }
@@ -529,6 +587,9 @@ bool  TiffDecoder::readData( Mat& img )
                 }
             }
 
+            if( m_roi.area() > 0 )
+                canvas( Rect( m_roi.x - x0, m_roi.y - y0, m_roi.width, m_roi.height ) ).copyTo( img );
+
             result = true;
         }
     }
@@ -616,6 +677,7 @@ TiffEncoder::TiffEncoder()
 
 TiffEncoder::~TiffEncoder()
 {
+    m_stream.release();
 }
 
 ImageEncoder TiffEncoder::newEncoder() const
@@ -646,9 +708,9 @@ public:
             : m_buf(buf), m_buf_pos(0)
     {}
 
-    TIFF* open ()
+    TIFF* open ( const char* mode = "w" )
     {
-        return TIFFClientOpen( "", "w", reinterpret_cast<thandle_t>(this), &TiffEncoderBufHelper::read,
+        return TIFFClientOpen( "", mode, reinterpret_cast<thandle_t>(this), &TiffEncoderBufHelper::read,
                                &TiffEncoderBufHelper::write, &TiffEncoderBufHelper::seek,
                                &TiffEncoderBufHelper::close, &TiffEncoderBufHelper::size,
                                /*map=*/0, /*unmap=*/0 );
@@ -723,6 +785,109 @@ static void readParam(const std::vector<int>& params, int key, int& value)
         }
 }
 
+/// converts a row of the image to the TIFF layout, RGB(A) channel order
+static void convertTiffRow( const Mat& img, int y, uchar* buffer, size_t scanlineSize )
+{
+    int width = img.cols;
+    switch (img.channels())
+    {
+        case 3:
+        {
+            if (img.depth() == CV_8U)
+                icvCvt_BGR2RGB_8u_C3R( img.ptr(y), 0, buffer, 0, cvSize(width, 1));
+            else
+                icvCvt_BGR2RGB_16u_C3R( img.ptr<ushort>(y), 0, (ushort*)buffer, 0, cvSize(width, 1));
+            break;
+        }
+
+        case 4:
+        {
+            if (img.depth() == CV_8U)
+                icvCvt_BGRA2RGBA_8u_C4R( img.ptr(y), 0, buffer, 0, cvSize(width, 1));
+            else
+                icvCvt_BGRA2RGBA_16u_C4R( img.ptr<ushort>(y), 0, (ushort*)buffer, 0, cvSize(width, 1));
+            break;
+        }
+
+        default:
+        {
+            memcpy(buffer, img.ptr(y), scanlineSize);
+            break;
+        }
+    }
+}
+
+/**
+ * Compresses the strips of an image in parallel
+ *
+ * The strips of a TIFF file are compressed independently, so each thread encodes its strips
+ * with libtiff into an in-memory file set up like the output one, and the compressed strips
+ * are then copied to the output file with TIFFWriteRawStrip. The output is identical to the
+ * one of the single-threaded encoder.
+ */
+class TiffStripEncoder : public ParallelLoopBody
+{
+public:
+    TiffStripEncoder( const Mat& img, int rowsPerStrip, int bitsPerChannel, int compression, int predictor,
+                      std::vector<std::vector<uchar> >& strips )
+        : img_(img), rowsPerStrip_(rowsPerStrip), bitsPerChannel_(bitsPerChannel),
+          compression_(compression), predictor_(predictor), strips_(strips)
+    {}
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        int y0 = range.start*rowsPerStrip_, y1 = std::min(range.end*rowsPerStrip_, img_.rows);
+        int channels = img_.channels();
+
+        std::vector<uchar> file;
+        TiffEncoderBufHelper buf_helper(&file);
+        TIFF* tif = buf_helper.open();
+        if (!tif)
+            return;
+
+        if (TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, img_.cols)
+            && TIFFSetField(tif, TIFFTAG_IMAGELENGTH, y1 - y0)
+            && TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, bitsPerChannel_)
+            && TIFFSetField(tif, TIFFTAG_COMPRESSION, compression_)
+            && TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, channels > 1 ? PHOTOMETRIC_RGB : PHOTOMETRIC_MINISBLACK)
+            && TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, channels)
+            && TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG)
+            && TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, rowsPerStrip_)
+            && (compression_ == COMPRESSION_NONE || TIFFSetField(tif, TIFFTAG_PREDICTOR, predictor_)))
+        {
+            // strip buffer, because the encoder modifies the data
+            size_t scanlineSize = TIFFScanlineSize(tif);
+            AutoBuffer<uchar> _buffer(scanlineSize*rowsPerStrip_ + 32);
+            uchar* buffer = _buffer.data();
+
+            for (int strip = range.start; strip < range.end; strip++)
+            {
+                int sy0 = strip*rowsPerStrip_, sy1 = std::min(sy0 + rowsPerStrip_, img_.rows);
+                for (int y = sy0; y < sy1; y++)
+                    convertTiffRow(img_, y, buffer + scanlineSize*(y - sy0), scanlineSize);
+
+                uint32 localStrip = (uint32)(strip - range.start);
+                if (TIFFWriteEncodedStrip(tif, localStrip, buffer, (tmsize_t)(scanlineSize*(sy1 - sy0))) < 0)
+                    break;
+
+                uint64 *offsets = 0, *sizes = 0;
+                if (!TIFFGetField(tif, TIFFTAG_STRIPOFFSETS, &offsets) ||
+                    !TIFFGetField(tif, TIFFTAG_STRIPBYTECOUNTS, &sizes) ||
+                    offsets[localStrip] + sizes[localStrip] > file.size())
+                    break;
+                strips_[strip].assign(file.begin() + (size_t)offsets[localStrip],
+                                      file.begin() + (size_t)(offsets[localStrip] + sizes[localStrip]));
+            }
+        }
+        TIFFClose(tif);
+    }
+
+private:
+    const Mat& img_;
+    int rowsPerStrip_, bitsPerChannel_, compression_, predictor_;
+    std::vector<std::vector<uchar> >& strips_;
+};
+
 bool TiffEncoder::writeLibTiff( const std::vector<Mat>& img_vec, const std::vector<int>& params)
 {
     // do NOT put "wb" as the mode, because the b means "big endian" mode, not "binary" mode.
@@ -755,6 +920,11 @@ bool TiffEncoder::writeLibTiff( const std::vector<Mat>& img_vec, const std::vect
     readParam(params, IMWRITE_TIFF_XDPI, dpiX);
     readParam(params, IMWRITE_TIFF_YDPI, dpiY);
 
+    int threads = 1;
+    readParam(params, IMWRITE_THREADS, threads);
+    if (threads <= 0)
+        threads = getNumThreads();
+
     //Iterate through each image in the vector and write them out as Tiff directories
     for (size_t page = 0; page < img_vec.size(); page++)
     {
@@ -830,57 +1000,53 @@ bool TiffEncoder::writeLibTiff( const std::vector<Mat>& img_vec, const std::vect
         }
 
 
-        // row buffer, because TIFFWriteScanline modifies the original data!
-        size_t scanlineSize = TIFFScanlineSize(pTiffHandle);
-        AutoBuffer<uchar> _buffer(scanlineSize + 32);
-        uchar* buffer = _buffer.data();
-        if (!buffer)
+        if (channels != 1 && channels != 3 && channels != 4)
         {
             TIFFClose(pTiffHandle);
             return false;
         }
 
-        for (int y = 0; y < height; ++y)
+        int nstrips = (height + rowsPerStrip - 1) / rowsPerStrip;
+        if (threads > 1 && compression != COMPRESSION_NONE && nstrips > 1)
         {
-            switch (channels)
-            {
-                case 1:
-                {
-                    memcpy(buffer, img.ptr(y), scanlineSize);
-                    break;
-                }
-
-                case 3:
-                {
-                    if (depth == CV_8U)
-                        icvCvt_BGR2RGB_8u_C3R( img.ptr(y), 0, buffer, 0, cvSize(width, 1));
-                    else
-                        icvCvt_BGR2RGB_16u_C3R( img.ptr<ushort>(y), 0, (ushort*)buffer, 0, cvSize(width, 1));
-                    break;
-                }
+            std::vector<std::vector<uchar> > strips(nstrips);
+            parallel_for_(Range(0, nstrips),
+                          TiffStripEncoder(img, rowsPerStrip, bitsPerChannel, compression, predictor, strips),
+                          std::min(threads, nstrips));
 
-                case 4:
-                {
-                    if (depth == CV_8U)
-                        icvCvt_BGRA2RGBA_8u_C4R( img.ptr(y), 0, buffer, 0, cvSize(width, 1));
-                    else
-                        icvCvt_BGRA2RGBA_16u_C4R( img.ptr<ushort>(y), 0, (ushort*)buffer, 0, cvSize(width, 1));
-                    break;
-                }
-
-                default:
+            for (int strip = 0; strip < nstrips; strip++)
+            {
+                if (strips[strip].empty() ||
+                    TIFFWriteRawStrip(pTiffHandle, (uint32)strip, &strips[strip][0], (tmsize_t)strips[strip].size()) < 0)
                 {
                     TIFFClose(pTiffHandle);
                     return false;
                 }
             }
-
-            int writeResult = TIFFWriteScanline(pTiffHandle, buffer, y, 0);
-            if (writeResult != 1)
+        }
+        else
+        {
+            // row buffer, because TIFFWriteScanline modifies the original data!
+            size_t scanlineSize = TIFFScanlineSize(pTiffHandle);
+            AutoBuffer<uchar> _buffer(scanlineSize + 32);
+            uchar* buffer = _buffer.data();
+            if (!buffer)
             {
                 TIFFClose(pTiffHandle);
                 return false;
             }
+
+            for (int y = 0; y < height; ++y)
+            {
+                convertTiffRow(img, y, buffer, scanlineSize);
+
+                int writeResult = TIFFWriteScanline(pTiffHandle, buffer, y, 0);
+                if (writeResult != 1)
+                {
+                    TIFFClose(pTiffHandle);
+                    return false;
+                }
+            }
         }
 
         TIFFWriteDirectory(pTiffHandle);
@@ -976,6 +1142,164 @@ bool TiffEncoder::writemulti(const std::vector<Mat>& img_vec, const std::vector<
     return writeLibTiff(img_vec, params);
 }
 
+/// state of an image written by writeHeader/writeRows/writeEnd
+struct TiffEncoderStream
+{
+    TiffEncoderStream( std::vector<uchar>* buf ) : helper(buf), tif(0), row(0), tileWidth(0), tileHeight(0) {}
+    ~TiffEncoderStream()
+    {
+        if( tif )
+            TIFFClose( tif );
+    }
+
+    TiffEncoderBufHelper helper;
+    TIFF* tif;
+    Size size;
+    int type;
+    int row;          // number of rows written
+    int tileWidth, tileHeight; // tile size, 0 for strips
+    Mat band;         // converted rows of the current row of tiles
+    AutoBuffer<uchar> buffer;
+};
+
+bool  TiffEncoder::writeHeader( Size size, int type, const std::vector<int>& params )
+{
+    m_stream.release();
+
+    int depth = CV_MAT_DEPTH(type), channels = CV_MAT_CN(type);
+    if( (depth != CV_8U && depth != CV_16U) || (channels != 1 && channels != 3 && channels != 4) )
+        return false;
+
+    int bitsPerChannel = depth == CV_8U ? 8 : 16;
+    int compression = COMPRESSION_LZW;
+    int predictor = PREDICTOR_HORIZONTAL;
+    int resUnit = -1, dpiX = -1, dpiY = -1;
+    int tileWidth = 0, tileHeight = 0;
+    size_t fileStep = (size_t)size.width * channels * bitsPerChannel / 8;
+    int rowsPerStrip = (int)((1 << 13) / fileStep);
+
+    readParam(params, TIFFTAG_COMPRESSION, compression);
+    readParam(params, TIFFTAG_PREDICTOR, predictor);
+    readParam(params, IMWRITE_TIFF_RESUNIT, resUnit);
+    readParam(params, IMWRITE_TIFF_XDPI, dpiX);
+    readParam(params, IMWRITE_TIFF_YDPI, dpiY);
+    readParam(params, TIFFTAG_ROWSPERSTRIP, rowsPerStrip);
+    readParam(params, TIFFTAG_TILEWIDTH, tileWidth);
+    readParam(params, TIFFTAG_TILELENGTH, tileHeight);
+    rowsPerStrip = std::max(std::min(rowsPerStrip, size.height), 1);
+
+    Ptr<TiffEncoderStream> stream = makePtr<TiffEncoderStream>(m_buf);
+    // the classic format uses 32-bit offsets, larger images are written as BigTIFF
+    const uint64 bigTiffSize = (uint64)1 << 31;
+    const char* mode = (uint64)fileStep * size.height >= bigTiffSize ? "w8" : "w";
+    stream->tif = m_buf ? stream->helper.open(mode) : TIFFOpen(m_filename.c_str(), mode);
+    TIFF* tif = stream->tif;
+    if (!tif)
+        return false;
+
+    if (!TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, size.width)
+        || !TIFFSetField(tif, TIFFTAG_IMAGELENGTH, size.height)
+        || !TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, bitsPerChannel)
+        || !TIFFSetField(tif, TIFFTAG_COMPRESSION, compression)
+        || !TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, channels > 1 ? PHOTOMETRIC_RGB : PHOTOMETRIC_MINISBLACK)
+        || !TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, channels)
+        || !TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG)
+        || (compression != COMPRESSION_NONE && !TIFFSetField(tif, TIFFTAG_PREDICTOR, predictor))
+        || ((resUnit >= RESUNIT_NONE && resUnit <= RESUNIT_CENTIMETER) && !TIFFSetField(tif, TIFFTAG_RESOLUTIONUNIT, resUnit))
+        || (dpiX >= 0 && !TIFFSetField(tif, TIFFTAG_XRESOLUTION, (float)dpiX))
+        || (dpiY >= 0 && !TIFFSetField(tif, TIFFTAG_YRESOLUTION, (float)dpiY)))
+        return false;
+
+    if (tileWidth > 0 || tileHeight > 0)
+    {
+        // tile dimensions must be multiples of 16
+        stream->tileWidth = (int)alignSize(std::max(tileWidth > 0 ? tileWidth : tileHeight, 16), 16);
+        stream->tileHeight = (int)alignSize(std::max(tileHeight > 0 ? tileHeight : tileWidth, 16), 16);
+        if (!TIFFSetField(tif, TIFFTAG_TILEWIDTH, stream->tileWidth)
+            || !TIFFSetField(tif, TIFFTAG_TILELENGTH, stream->tileHeight))
+            return false;
+        int tilesPerRow = (size.width + stream->tileWidth - 1) / stream->tileWidth;
+        stream->band.create(stream->tileHeight, tilesPerRow * stream->tileWidth, type);
+        stream->band = Scalar::all(0);
+        stream->buffer.allocate(TIFFTileSize(tif));
+    }
+    else
+    {
+        if (!TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, rowsPerStrip))
+            return false;
+        stream->buffer.allocate(TIFFScanlineSize(tif) + 32);
+    }
+
+    stream->size = size;
+    stream->type = type;
+    m_stream = stream;
+    return true;
+}
+
+bool  TiffEncoder::writeRows( const Mat& rows )
+{
+    if (!m_stream)
+        return false;
+    TiffEncoderStream& stream = *m_stream;
+    if (rows.type() != stream.type || rows.cols != stream.size.width || stream.row + rows.rows > stream.size.height)
+    {
+        m_stream.release();
+        return false;
+    }
+
+    TIFF* tif = stream.tif;
+    uchar* buffer = stream.buffer.data();
+    if (stream.tileWidth == 0)
+    {
+        // row buffer, because TIFFWriteScanline modifies the original data!
+        size_t scanlineSize = TIFFScanlineSize(tif);
+        for (int y = 0; y < rows.rows; y++, stream.row++)
+        {
+            convertTiffRow(rows, y, buffer, scanlineSize);
+            if (TIFFWriteScanline(tif, buffer, stream.row, 0) != 1)
+            {
+                m_stream.release();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // rows are collected until a row of tiles is complete
+    size_t bandStep = (size_t)stream.size.width * stream.band.elemSize();
+    size_t tileStep = (size_t)stream.tileWidth * stream.band.elemSize();
+    for (int y = 0; y < rows.rows; y++)
+    {
+        int bandRow = stream.row % stream.tileHeight;
+        convertTiffRow(rows, y, stream.band.ptr(bandRow), bandStep);
+        stream.row++;
+
+        if (bandRow == stream.tileHeight - 1 || stream.row == stream.size.height)
+        {
+            int y0 = stream.row - bandRow - 1;
+            for (int x = 0; x < stream.size.width; x += stream.tileWidth)
+            {
+                for (int i = 0; i < stream.tileHeight; i++)
+                    memcpy(buffer + tileStep*i, stream.band.ptr(i) + x*stream.band.elemSize(), tileStep);
+                if (TIFFWriteTile(tif, buffer, x, y0, 0, 0) < 0)
+                {
+                    m_stream.release();
+                    return false;
+                }
+            }
+            stream.band = Scalar::all(0);
+        }
+    }
+    return true;
+}
+
+bool  TiffEncoder::writeEnd()
+{
+    bool result = m_stream && m_stream->row == m_stream->size.height;
+    m_stream.release();
+    return result;
+}
+
 bool  TiffEncoder::write( const Mat& img, const std::vector<int>& params)
 {
     int depth = img.depth();
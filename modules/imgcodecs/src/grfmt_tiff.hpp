@@ -98,6 +98,8 @@ public:
 
     bool  readHeader() CV_OVERRIDE;
     bool  readData( Mat& img ) CV_OVERRIDE;
+    bool  setROI( const Rect& roi ) CV_OVERRIDE;
+    bool  readRows( Mat& rows ) CV_OVERRIDE;
     void  close();
     bool  nextPage() CV_OVERRIDE;
 
@@ -118,6 +120,8 @@ private:
     TiffDecoder& operator=(const TiffDecoder &); // assign disabled
 };
 
+struct TiffEncoderStream;
+
 // ... and writer
 class TiffEncoder CV_FINAL : public BaseImageEncoder
 {
@@ -131,6 +135,10 @@ public:
 
     bool writemulti(const std::vector<Mat>& img_vec, const std::vector<int>& params) CV_OVERRIDE;
 
+    bool writeHeader( Size size, int type, const std::vector<int>& params ) CV_OVERRIDE;
+    bool writeRows( const Mat& rows ) CV_OVERRIDE;
+    bool writeEnd() CV_OVERRIDE;
+
     ImageEncoder newEncoder() const CV_OVERRIDE;
 
 protected:
@@ -142,6 +150,8 @@ protected:
     bool write_32FC3( const Mat& img );
     bool write_32FC1( const Mat& img );
 
+    Ptr<TiffEncoderStream> m_stream; // image written by writeRows
+
 private:
     TiffEncoder(const TiffEncoder &); // copy disabled
     TiffEncoder& operator=(const TiffEncoder &); // assign disabled
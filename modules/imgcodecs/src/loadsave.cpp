@@ -188,23 +188,66 @@ struct ImageCodecInitializer
 
 static ImageCodecInitializer codecs;
 
+/// Decoders of a thread, reused by the batch functions for the images of the same format
+struct DecoderCache
+{
+    std::vector<ImageDecoder> decoders; ///< decoder instances, indexed like codecs.decoders
+};
+
+static TLSData<DecoderCache>& getDecoderCache()
+{
+    static TLSData<DecoderCache>* instance = new TLSData<DecoderCache>();
+    return *instance;
+}
+
+static size_t maxSignatureLength()
+{
+    size_t maxlen = 0;
+    for( size_t i = 0; i < codecs.decoders.size(); i++ )
+        maxlen = std::max(maxlen, codecs.decoders[i]->signatureLength());
+    return maxlen;
+}
+
+/**
+ * Find the decoder recognizing the signature
+ *
+ * @param[in] signature First bytes of the image
+ * @param[in] cache Decoders to reuse, if null a new decoder is created
+ *
+ * @return Image decoder to parse the image.
+*/
+static ImageDecoder findDecoderBySignature( const String& signature, DecoderCache* cache )
+{
+    /// compare signature against all decoders
+    for( size_t i = 0; i < codecs.decoders.size(); i++ )
+    {
+        if( !codecs.decoders[i]->checkSignature(signature) )
+            continue;
+        if( !cache || !codecs.decoders[i]->isReusable() )
+            return codecs.decoders[i]->newDecoder();
+
+        cache->decoders.resize(codecs.decoders.size());
+        ImageDecoder& decoder = cache->decoders[i];
+        if( !decoder )
+            decoder = codecs.decoders[i]->newDecoder();
+        return decoder;
+    }
+
+    /// If no decoder was found, return base type
+    return ImageDecoder();
+}
+
 /**
  * Find the decoders
  *
  * @param[in] filename File to search
+ * @param[in] cache Decoders to reuse, if null a new decoder is created
  *
  * @return Image decoder to parse image file.
 */
-static ImageDecoder findDecoder( const String& filename ) {
+static ImageDecoder findDecoder( const String& filename, DecoderCache* cache = 0 ) {
 
-    size_t i, maxlen = 0;
-
-    /// iterate through list of registered codecs
-    for( i = 0; i < codecs.decoders.size(); i++ )
-    {
-        size_t len = codecs.decoders[i]->signatureLength();
-        maxlen = std::max(maxlen, len);
-    }
+    size_t maxlen = maxSignatureLength();
 
     /// Open the file
     FILE* f= fopen( filename.c_str(), "rb" );
@@ -219,42 +262,21 @@ static ImageDecoder findDecoder( const String& filename ) {
     fclose(f);
     signature = signature.substr(0, maxlen);
 
-    /// compare signature against all decoders
-    for( i = 0; i < codecs.decoders.size(); i++ )
-    {
-        if( codecs.decoders[i]->checkSignature(signature) )
-            return codecs.decoders[i]->newDecoder();
-    }
-
-    /// If no decoder was found, return base type
-    return ImageDecoder();
+    return findDecoderBySignature( signature, cache );
 }
 
-static ImageDecoder findDecoder( const Mat& buf )
+static ImageDecoder findDecoder( const Mat& buf, DecoderCache* cache = 0 )
 {
-    size_t i, maxlen = 0;
-
     if( buf.rows*buf.cols < 1 || !buf.isContinuous() )
         return ImageDecoder();
 
-    for( i = 0; i < codecs.decoders.size(); i++ )
-    {
-        size_t len = codecs.decoders[i]->signatureLength();
-        maxlen = std::max(maxlen, len);
-    }
-
+    size_t maxlen = maxSignatureLength();
     String signature(maxlen, ' ');
     size_t bufSize = buf.rows*buf.cols*buf.elemSize();
     maxlen = std::min(maxlen, bufSize);
     memcpy( (void*)signature.c_str(), buf.data, maxlen );
 
-    for( i = 0; i < codecs.decoders.size(); i++ )
-    {
-        if( codecs.decoders[i]->checkSignature(signature) )
-            return codecs.decoders[i]->newDecoder();
-    }
-
-    return ImageDecoder();
+    return findDecoderBySignature( signature, cache );
 }
 
 static ImageEncoder findEncoder( const String& _ext )
@@ -336,7 +358,7 @@ static void ExifTransform(int orientation, Mat& img)
     }
 }
 
-static void ApplyExifOrientation(const String& filename, Mat& img)
+static int GetExifOrientation(const String& filename)
 {
     int orientation = IMAGE_ORIENTATION_TL;
 
@@ -355,10 +377,15 @@ static void ApplyExifOrientation(const String& filename, Mat& img)
         stream.close();
     }
 
-    ExifTransform(orientation, img);
+    return orientation;
 }
 
-static void ApplyExifOrientation(const Mat& buf, Mat& img)
+static void ApplyExifOrientation(const String& filename, Mat& img)
+{
+    ExifTransform(GetExifOrientation(filename), img);
+}
+
+static int GetExifOrientation(const Mat& buf)
 {
     int orientation = IMAGE_ORIENTATION_TL;
 
@@ -377,7 +404,35 @@ static void ApplyExifOrientation(const Mat& buf, Mat& img)
         }
     }
 
-    ExifTransform(orientation, img);
+    return orientation;
+}
+
+static void ApplyExifOrientation(const Mat& buf, Mat& img)
+{
+    ExifTransform(GetExifOrientation(buf), img);
+}
+
+/**
+ * Select the part of the image to decode for a region of interest
+ *
+ * @param[in] decoder Decoder with the header read
+ * @param[in] scale_denom Requested scale, applied by the decoder itself or by resizing afterwards
+ * @param[in,out] roi Region in the coordinates of the (reduced) output image, clipped to it
+ * @param[out] region Region in the coordinates of the image produced by the decoder
+ * @return true if the decoder reads only the region, false if the whole image has to be read
+ */
+static bool
+selectRegion_( ImageDecoder& decoder, int scale_denom, Rect& roi, Rect& region )
+{
+    // setScale returns the scale left to imread (JPEG scales by itself), keep it for later
+    int scale = decoder->setScale( scale_denom );
+    decoder->setScale( scale );
+    scale = std::max( scale, 1 );
+
+    Size size( decoder->width(), decoder->height() );
+    roi &= Rect( 0, 0, size.width / scale, size.height / scale );
+    region = Rect( roi.x * scale, roi.y * scale, roi.width * scale, roi.height * scale );
+    return !roi.empty() && decoder->setROI( region );
 }
 
 /**
@@ -390,11 +445,12 @@ static void ApplyExifOrientation(const Mat& buf, Mat& img)
  *                      LOAD_MAT=2
  *                    }
  * @param[in] mat Reference to C++ Mat object (If LOAD_MAT)
- * @param[in] scale_denom Scale value
+ * @param[in] roi Region of the image to read (If LOAD_MAT), the whole image if null
+ * @param[in] cache Decoders to reuse, if null a new decoder is created
  *
 */
 static void*
-imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
+imread_( const String& filename, int flags, int hdrtype, Mat* mat=0, const Rect* roi=0, DecoderCache* cache=0 )
 {
     IplImage* image = 0;
     CvMat *matrix = 0;
@@ -408,7 +464,7 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
         decoder = GdalDecoder().newDecoder();
     }else{
 #endif
-        decoder = findDecoder( filename );
+        decoder = findDecoder( filename, cache );
 #ifdef HAVE_GDAL
     }
 #endif
@@ -470,6 +526,20 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
             type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
     }
 
+    // select the part of the image to decode
+    Rect dst_roi, region;
+    bool decoder_crops = false;
+    if( roi )
+    {
+        CV_Assert( hdrtype == LOAD_MAT );
+        dst_roi = *roi;
+        decoder_crops = selectRegion_( decoder, scale_denom, dst_roi, region );
+        if( dst_roi.empty() )
+            return 0;
+        if( decoder_crops )
+            size = region.size();
+    }
+
     if( hdrtype == LOAD_CVMAT || hdrtype == LOAD_MAT )
     {
         if( hdrtype == LOAD_CVMAT )
@@ -513,7 +583,14 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
         return 0;
     }
 
-    if( decoder->setScale( scale_denom ) > 1 ) // if decoder is JpegDecoder then decoder->setScale always returns 1
+    if( roi )
+    {
+        if( !decoder_crops )
+            *mat = (*mat)( region ).clone();
+        if( mat->size() != dst_roi.size() )
+            resize( *mat, *mat, dst_roi.size(), 0, 0, INTER_LINEAR_EXACT );
+    }
+    else if( decoder->setScale( scale_denom ) > 1 ) // if decoder is JpegDecoder then decoder->setScale always returns 1
     {
         resize( *mat, *mat, Size( size.width / scale_denom, size.height / scale_denom ), 0, 0, INTER_LINEAR_EXACT);
     }
@@ -656,6 +733,30 @@ Mat imread( const String& filename, int flags )
     return img;
 }
 
+/**
+ * Read a region of an image
+ *
+ * @param[in] filename File to load
+ * @param[in] roi Region of the image returned by imread(filename, flags)
+ * @param[in] flags Flags you wish to set.
+*/
+Mat imread( const String& filename, const Rect& roi, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    Mat img;
+    if( (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED &&
+        GetExifOrientation(filename) != IMAGE_ORIENTATION_TL )
+    {
+        // the region refers to the rotated image, read it as a whole
+        img = imread( filename, flags );
+        return img.empty() ? img : img( roi & Rect( Point(), img.size() ) ).clone();
+    }
+
+    imread_( filename, flags, LOAD_MAT, &img, &roi );
+    return img;
+}
+
 /**
 * Read a multi-page image
 *
@@ -731,8 +832,230 @@ bool imwrite( const String& filename, InputArray _img,
     return imwrite_(filename, img_vec, params, false);
 }
 
+/////////////////////// ImageWriter ///////////////////
+
+struct ImageWriter::Impl
+{
+    Impl() : type(-1), rows(0), tilesCols(0) {}
+
+    ImageEncoder encoder;
+    Size size;
+    int type;
+    int rows;      //!< number of rows passed to the encoder
+    Mat tiles;     //!< row of tiles being assembled
+    int tilesCols; //!< number of columns of tiles filled
+};
+
+ImageWriter::ImageWriter() : p(makePtr<Impl>())
+{}
+
+ImageWriter::ImageWriter( const String& filename, Size size, int type, const std::vector<int>& params )
+    : p(makePtr<Impl>())
+{
+    open( filename, size, type, params );
+}
+
+ImageWriter::~ImageWriter()
+{
+    release();
+}
+
+bool ImageWriter::open( const String& filename, Size size, int type, const std::vector<int>& params )
+{
+    CV_TRACE_FUNCTION();
+
+    release();
+    CV_Assert( size.width > 0 && size.height > 0 );
+    CV_Assert( CV_MAT_CN(type) == 1 || CV_MAT_CN(type) == 3 || CV_MAT_CN(type) == 4 );
+    CV_Assert( params.size() <= CV_IO_MAX_IMAGE_PARAMS*2 );
+
+    ImageEncoder enc = findEncoder( filename );
+    if( !enc )
+        CV_Error( CV_StsError, "could not find a writer for the specified extension" );
+    if( !enc->isFormatSupported( CV_MAT_DEPTH(type) ) )
+        return false;
+
+    enc->setDestination( filename );
+    if( !enc->writeHeader( size, type, params ) )
+        return false;
+
+    p->encoder = enc;
+    p->size = size;
+    p->type = type;
+    p->rows = p->tilesCols = 0;
+    return true;
+}
+
+bool ImageWriter::isOpened() const
+{
+    return !p->encoder.empty();
+}
+
+bool ImageWriter::write( InputArray _part )
+{
+    CV_TRACE_FUNCTION();
+
+    if( !isOpened() )
+        return false;
+
+    Mat part = _part.getMat();
+    CV_Assert( part.type() == p->type && !part.empty() && p->rows + part.rows <= p->size.height );
+
+    const Mat* rows = &part;
+    if( p->tilesCols > 0 || part.cols < p->size.width )
+    {
+        // a tile, the row of tiles is written once complete
+        if( p->tilesCols == 0 )
+            p->tiles.create( part.rows, p->size.width, p->type );
+        CV_Assert( part.rows == p->tiles.rows && p->tilesCols + part.cols <= p->size.width );
+        part.copyTo( p->tiles.colRange( p->tilesCols, p->tilesCols + part.cols ) );
+        p->tilesCols += part.cols;
+        if( p->tilesCols < p->size.width )
+            return true;
+        p->tilesCols = 0;
+        rows = &p->tiles;
+    }
+    CV_Assert( rows->cols == p->size.width );
+
+    if( !p->encoder->writeRows( *rows ) )
+    {
+        p->encoder.release();
+        return false;
+    }
+    p->rows += rows->rows;
+    return true;
+}
+
+bool ImageWriter::release()
+{
+    bool result = isOpened() && p->rows == p->size.height && p->tilesCols == 0 && p->encoder->writeEnd();
+    p->encoder.release();
+    p->tiles.release();
+    return result;
+}
+
+/////////////////////// ImageReader ///////////////////
+
+struct ImageReader::Impl
+{
+    Impl() : type(-1), rows(0) {}
+
+    ImageDecoder decoder;
+    Size size;
+    int type;
+    int rows; //!< number of rows read
+};
+
+ImageReader::ImageReader() : p(makePtr<Impl>())
+{}
+
+ImageReader::ImageReader( const String& filename, int flags ) : p(makePtr<Impl>())
+{
+    open( filename, flags );
+}
+
+ImageReader::~ImageReader()
+{
+    release();
+}
+
+bool ImageReader::open( const String& filename, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    release();
+    CV_Assert( flags == IMREAD_UNCHANGED ||
+               (flags & (IMREAD_LOAD_GDAL | IMREAD_REDUCED_GRAYSCALE_2 |
+                         IMREAD_REDUCED_GRAYSCALE_4 | IMREAD_REDUCED_GRAYSCALE_8)) == 0 );
+
+    ImageDecoder dec = findDecoder( filename );
+    if( !dec )
+        return false;
+
+    dec->setSource( filename );
+    CV_TRY
+    {
+        if( !dec->readHeader() )
+            return false;
+    }
+    CV_CATCH_ALL
+    {
+        return false;
+    }
+
+    int type = dec->type();
+    if( flags != IMREAD_UNCHANGED )
+    {
+        if( (flags & CV_LOAD_IMAGE_ANYDEPTH) == 0 )
+            type = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
+
+        if( (flags & CV_LOAD_IMAGE_COLOR) != 0 ||
+           ((flags & CV_LOAD_IMAGE_ANYCOLOR) != 0 && CV_MAT_CN(type) > 1) )
+            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 3);
+        else
+            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
+    }
+
+    p->decoder = dec;
+    p->size = validateInputImageSize( Size( dec->width(), dec->height() ) );
+    p->type = type;
+    p->rows = 0;
+    return true;
+}
+
+bool ImageReader::isOpened() const
+{
+    return !p->decoder.empty();
+}
+
+Size ImageReader::size() const
+{
+    return p->size;
+}
+
+int ImageReader::type() const
+{
+    return p->type;
+}
+
+bool ImageReader::read( OutputArray _band, int rows )
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert( rows > 0 );
+
+    if( !isOpened() || p->rows >= p->size.height )
+        return false;
+
+    _band.create( std::min( rows, p->size.height - p->rows ), p->size.width, p->type );
+    Mat band = _band.getMat();
+    bool result = false;
+    CV_TRY
+    {
+        result = p->decoder->readRows( band );
+    }
+    CV_CATCH_ALL
+    {
+        result = false;
+    }
+    if( !result )
+    {
+        p->decoder.release();
+        return false;
+    }
+    p->rows += band.rows;
+    return true;
+}
+
+void ImageReader::release()
+{
+    p->decoder.release();
+    p->size = Size();
+    p->type = -1;
+    p->rows = 0;
+}
+
 static void*
-imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
+imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0, const Rect* roi=0, DecoderCache* cache=0 )
 {
     CV_Assert(!buf.empty() && buf.isContinuous());
     IplImage* image = 0;
@@ -740,10 +1063,13 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
     Mat temp, *data = &temp;
     String filename;
 
-    ImageDecoder decoder = findDecoder(buf);
+    ImageDecoder decoder = findDecoder(buf, cache);
     if( !decoder )
         return 0;
 
+    // a reused decoder may keep the scale of a previous imread
+    decoder->setScale( 1 );
+
     if( !decoder->setSource(buf) )
     {
         filename = tempfile();
@@ -779,6 +1105,8 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
     }
     if (!success)
     {
+        if (cache)
+            decoder->setSource(String()); // drop the buffer, the decoder stays in the cache
         decoder.release();
         if (!filename.empty())
         {
@@ -806,6 +1134,18 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
             type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
     }
 
+    // select the part of the image to decode
+    Rect dst_roi, region;
+    bool decoder_crops = false;
+    if( roi )
+    {
+        CV_Assert( hdrtype == LOAD_MAT );
+        dst_roi = *roi;
+        decoder_crops = selectRegion_( decoder, 1, dst_roi, region );
+        if( decoder_crops || dst_roi.empty() )
+            size = region.size();
+    }
+
     if( hdrtype == LOAD_CVMAT || hdrtype == LOAD_MAT )
     {
         if( hdrtype == LOAD_CVMAT )
@@ -828,7 +1168,8 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
     success = false;
     CV_TRY
     {
-        if (decoder->readData(*data))
+        // an empty region doesn't intersect the image, there is nothing to read
+        if ((!roi || !dst_roi.empty()) && decoder->readData(*data))
             success = true;
     }
     CV_CATCH (cv::Exception, e)
@@ -839,6 +1180,8 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
     {
         std::cerr << "imdecode_('" << filename << "'): can't read data: unknown exception" << std::endl << std::flush;
     }
+    if (cache)
+        decoder->setSource(String()); // drop the buffer, the decoder stays in the cache
     decoder.release();
     if (!filename.empty())
     {
@@ -857,6 +1200,9 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
         return 0;
     }
 
+    if( roi && !decoder_crops )
+        *mat = (*mat)( region ).clone();
+
     return hdrtype == LOAD_CVMAT ? (void*)matrix :
         hdrtype == LOAD_IMAGE ? (void*)image : (void*)mat;
 }
@@ -895,6 +1241,104 @@ Mat imdecode( InputArray _buf, int flags, Mat* dst )
     return *dst;
 }
 
+Mat imdecode( InputArray _buf, const Rect& roi, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    Mat buf = _buf.getMat(), img;
+    if( (flags & IMREAD_IGNORE_ORIENTATION) == 0 && flags != IMREAD_UNCHANGED &&
+        GetExifOrientation(buf) != IMAGE_ORIENTATION_TL )
+    {
+        // the region refers to the rotated image, decode it as a whole
+        img = imdecode( buf, flags );
+        return img.empty() ? img : img( roi & Rect( Point(), img.size() ) ).clone();
+    }
+
+    imdecode_( buf, flags, LOAD_MAT, &img, &roi );
+    return img;
+}
+
+/**
+ * Decode the images of a batch, each thread of the pool reuses its own decoders
+ */
+class ImageBatchDecoder : public ParallelLoopBody
+{
+public:
+    ImageBatchDecoder( const std::vector<String>* filenames, const std::vector<Mat>* bufs,
+                       std::vector<Mat>& dst, int flags )
+        : filenames_(filenames), bufs_(bufs), dst_(&dst), flags_(flags)
+    {}
+
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        DecoderCache& cache = getDecoderCache().getRef();
+        const bool orient = (flags_ & IMREAD_IGNORE_ORIENTATION) == 0 && flags_ != IMREAD_UNCHANGED;
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            Mat& img = (*dst_)[i];
+            CV_TRY
+            {
+                if( filenames_ )
+                {
+                    const String& filename = (*filenames_)[i];
+                    if( !imread_( filename, flags_, LOAD_MAT, &img, 0, &cache ) )
+                        img.release();
+                    else if( orient )
+                        ApplyExifOrientation( filename, img );
+                }
+                else
+                {
+                    const Mat& buf = (*bufs_)[i];
+                    if( buf.empty() || !buf.isContinuous() || !imdecode_( buf, flags_, LOAD_MAT, &img, 0, &cache ) )
+                        img.release();
+                    else if( orient )
+                        ApplyExifOrientation( buf, img );
+                }
+            }
+            CV_CATCH_ALL
+            {
+                // a broken image is reported by an empty output, the other images are still decoded
+                img.release();
+            }
+        }
+    }
+
+private:
+    const std::vector<String>* filenames_;
+    const std::vector<Mat>* bufs_;
+    std::vector<Mat>* dst_;
+    int flags_;
+};
+
+static int countDecoded( const std::vector<Mat>& dst )
+{
+    int count = 0;
+    for( size_t i = 0; i < dst.size(); i++ )
+        count += !dst[i].empty();
+    return count;
+}
+
+int imreadBatch( const std::vector<String>& filenames, std::vector<Mat>& dst, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    dst.resize( filenames.size() );
+    parallel_for_( Range( 0, (int)filenames.size() ), ImageBatchDecoder( &filenames, 0, dst, flags ) );
+    return countDecoded( dst );
+}
+
+int imdecodeBatch( InputArrayOfArrays _bufs, std::vector<Mat>& dst, int flags )
+{
+    CV_TRACE_FUNCTION();
+
+    std::vector<Mat> bufs;
+    _bufs.getMatVector( bufs );
+    dst.resize( bufs.size() );
+    parallel_for_( Range( 0, (int)bufs.size() ), ImageBatchDecoder( 0, &bufs, dst, flags ) );
+    return countDecoded( dst );
+}
+
 bool imencode( const String& ext, InputArray _image,
                std::vector<uchar>& buf, const std::vector<int>& params )
 {
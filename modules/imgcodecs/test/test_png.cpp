@@ -35,6 +35,42 @@ TEST(Imgcodecs_Png, encode)
     EXPECT_PRED_FORMAT2(cvtest::MatComparator(0, 0), img, img_gt);
 }
 
+TEST(Imgcodecs_Png, encode_multithreaded)
+{
+    RNG rng(12345);
+    const int types[] = { CV_8UC1, CV_8UC3, CV_8UC4, CV_16UC1, CV_16UC3 };
+    const int levels[] = { -1, 0, 6 };
+    for (size_t t = 0; t < sizeof(types)/sizeof(types[0]); t++)
+    {
+        // smooth data, so that the stripes have something to compress
+        Mat img(768, 1024, types[t]);
+        rng.fill(img, RNG::UNIFORM, Scalar::all(0), Scalar::all(CV_MAT_DEPTH(types[t]) == CV_8U ? 256 : 65536));
+        blur(img, img, Size(7, 7));
+        for (size_t l = 0; l < sizeof(levels)/sizeof(levels[0]); l++)
+        {
+            SCOPED_TRACE(cv::format("type=%d level=%d", types[t], levels[l]));
+            vector<int> params;
+            if (levels[l] >= 0)
+            {
+                params.push_back(IMWRITE_PNG_COMPRESSION);
+                params.push_back(levels[l]);
+            }
+            vector<uchar> serial, parallel;
+            ASSERT_TRUE(imencode(".png", img, serial, params));
+            params.push_back(IMWRITE_THREADS);
+            params.push_back(4);
+            ASSERT_TRUE(imencode(".png", img, parallel, params));
+            EXPECT_NE(serial, parallel);
+
+            Mat decoded = imdecode(parallel, IMREAD_UNCHANGED);
+            ASSERT_FALSE(decoded.empty());
+            EXPECT_EQ(0, cvtest::norm(img, decoded, NORM_INF));
+            if (levels[l] != 0)
+                EXPECT_LT(parallel.size(), serial.size() * 11 / 10);
+        }
+    }
+}
+
 TEST(Imgcodecs_Png, regression_ImreadVSCvtColor)
 {
     const string root = cvtest::TS::ptr()->get_data_path();
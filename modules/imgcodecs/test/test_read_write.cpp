@@ -122,6 +122,303 @@ const string exts[] = {
 
 INSTANTIATE_TEST_CASE_P(imgcodecs, Imgcodecs_Image, testing::ValuesIn(exts));
 
+typedef testing::TestWithParam<Ext> Imgcodecs_Image_ROI;
+
+TEST_P(Imgcodecs_Image_ROI, read_region)
+{
+    const string ext = GetParam();
+    RNG rng(123);
+    Mat image(389, 517, CV_8UC3);
+    rng.fill(image, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    GaussianBlur(image, image, Size(9, 9), 3);
+
+    vector<uchar> buf;
+    ASSERT_TRUE(imencode("." + ext, image, buf));
+
+    const Rect rois[] = {
+        Rect(100, 50, 200, 120), Rect(0, 0, 33, 17), Rect(480, 370, 100, 100),
+        Rect(-10, 200, 50, 50), Rect(17, 0, 500, 389)
+    };
+    const int modes[] = { IMREAD_COLOR, IMREAD_GRAYSCALE };
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+    {
+        Mat full = imdecode(buf, modes[m]);
+        ASSERT_FALSE(full.empty());
+        for (size_t i = 0; i < sizeof(rois) / sizeof(rois[0]); i++)
+        {
+            SCOPED_TRACE(rois[i]);
+            Mat region = imdecode(buf, rois[i], modes[m]);
+            Rect clipped = rois[i] & Rect(Point(), full.size());
+            ASSERT_EQ(clipped.size(), region.size());
+            EXPECT_EQ(0, cvtest::norm(full(clipped), region, NORM_INF));
+        }
+        EXPECT_TRUE(imdecode(buf, Rect(600, 10, 20, 20), modes[m]).empty());
+    }
+
+    const string filename = cv::tempfile(("." + ext).c_str());
+    ASSERT_TRUE(imwrite(filename, image));
+    const Rect roi(41, 33, 77, 65);
+    EXPECT_EQ(0, cvtest::norm(imread(filename)(roi), imread(filename, roi), NORM_INF));
+    if (ext == "jpg")
+    {
+        // JPEG scales natively, so the reduced region is exact too
+        Mat reduced = imread(filename, IMREAD_REDUCED_COLOR_2);
+        EXPECT_EQ(0, cvtest::norm(reduced(roi), imread(filename, roi, IMREAD_REDUCED_COLOR_2), NORM_INF));
+    }
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
+INSTANTIATE_TEST_CASE_P(imgcodecs, Imgcodecs_Image_ROI, testing::ValuesIn(exts));
+
+TEST(Imgcodecs_Image, decode_batch)
+{
+    RNG rng(321);
+    vector<Mat> images, bufs;
+    const char* batch_exts[] = { ".jpg", ".png", ".bmp", ".jpg", ".png", ".jpg" };
+    for (size_t i = 0; i < sizeof(batch_exts)/sizeof(batch_exts[0]); i++)
+    {
+        Mat image(64 + 16 * (int)i, 48 + 8 * (int)i, CV_8UC3);
+        rng.fill(image, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+        vector<uchar> buf;
+        ASSERT_TRUE(imencode(batch_exts[i], image, buf));
+        images.push_back(image);
+        bufs.push_back(Mat(buf, true));
+    }
+    // broken entries are reported as empty images
+    bufs.push_back(Mat());
+    Mat garbage(1, 100, CV_8U);
+    rng.fill(garbage, RNG::UNIFORM, 0, 256);
+    bufs.push_back(garbage);
+    Mat truncated = bufs[0].rowRange(0, 20).clone();
+    truncated.at<uchar>(0) = 0xff; truncated.at<uchar>(1) = 0xd8;
+    bufs.push_back(truncated);
+
+    for (int flags = IMREAD_COLOR; flags >= IMREAD_GRAYSCALE; flags--)
+    {
+        vector<Mat> dst;
+        EXPECT_EQ((int)images.size(), imdecodeBatch(bufs, dst, flags));
+        ASSERT_EQ(bufs.size(), dst.size());
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            Mat expected = imdecode(bufs[i], flags);
+            ASSERT_FALSE(expected.empty());
+            EXPECT_EQ(0, cvtest::norm(expected, dst[i], NORM_INF)) << "index=" << i;
+        }
+        for (size_t i = images.size(); i < bufs.size(); i++)
+            EXPECT_TRUE(dst[i].empty()) << "index=" << i;
+
+        // the output images of the same size are decoded in place
+        const uchar* data0 = dst[0].data;
+        EXPECT_EQ((int)images.size(), imdecodeBatch(bufs, dst, flags));
+        EXPECT_EQ(data0, dst[0].data);
+    }
+
+    vector<String> filenames;
+    for (size_t i = 0; i < 3; i++)
+    {
+        filenames.push_back(cv::tempfile(batch_exts[i]));
+        ASSERT_TRUE(imwrite(filenames.back(), images[i]));
+    }
+    filenames.push_back(cv::tempfile(".png")); // missing file
+    vector<Mat> dst;
+    EXPECT_EQ(3, imreadBatch(filenames, dst));
+    ASSERT_EQ(filenames.size(), dst.size());
+    for (size_t i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(0, cvtest::norm(imread(filenames[i]), dst[i], NORM_INF)) << "index=" << i;
+        EXPECT_EQ(0, remove(filenames[i].c_str()));
+    }
+    EXPECT_TRUE(dst[3].empty());
+}
+
+// the same stream without its segments of the given marker, e.g. 0xdb (DQT) or 0xc4 (DHT)
+static Mat removeJpegSegments(const vector<uchar>& jpeg, uchar marker)
+{
+    vector<uchar> out(jpeg.begin(), jpeg.begin() + 2);
+    size_t pos = 2;
+    while (pos + 4 <= jpeg.size() && jpeg[pos] == 0xff && jpeg[pos + 1] != 0xda)
+    {
+        size_t len = 2 + (jpeg[pos + 2] << 8) + jpeg[pos + 3];
+        if (jpeg[pos + 1] != marker)
+            out.insert(out.end(), jpeg.begin() + pos, jpeg.begin() + pos + len);
+        pos += len;
+    }
+    out.insert(out.end(), jpeg.begin() + pos, jpeg.end());
+    return Mat(out, true);
+}
+
+TEST(Imgcodecs_Image, decode_batch_abbreviated_jpeg)
+{
+    Mat image(48, 64, CV_8UC3);
+    theRNG().fill(image, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    vector<uchar> jpeg;
+    ASSERT_TRUE(imencode(".jpg", image, jpeg));
+    Mat no_dqt = removeJpegSegments(jpeg, 0xdb);
+    ASSERT_LT(no_dqt.total(), jpeg.size());
+    EXPECT_TRUE(imdecode(no_dqt, IMREAD_COLOR).empty());
+    // a MJPEG frame, decoded with the default Huffman tables
+    Mat no_dht = removeJpegSegments(jpeg, 0xc4);
+    ASSERT_LT(no_dht.total(), jpeg.size());
+    Mat expected_no_dht = imdecode(no_dht, IMREAD_COLOR);
+    ASSERT_FALSE(expected_no_dht.empty());
+
+    // one thread decodes all streams, the tables of an image must not be used for the next ones
+    vector<Mat> bufs, dst;
+    bufs.push_back(Mat(jpeg, true));
+    bufs.push_back(no_dqt);
+    bufs.push_back(Mat(jpeg, true));
+    bufs.push_back(no_dht);
+    bufs.push_back(Mat(jpeg, true));
+    int threads = getNumThreads();
+    setNumThreads(1);
+    int decoded = imdecodeBatch(bufs, dst, IMREAD_COLOR);
+    setNumThreads(threads);
+    EXPECT_EQ(4, decoded);
+    ASSERT_EQ(5u, dst.size());
+    Mat expected = imdecode(bufs[0], IMREAD_COLOR);
+    EXPECT_EQ(0, cvtest::norm(expected, dst[0], NORM_INF));
+    EXPECT_TRUE(dst[1].empty());
+    EXPECT_EQ(0, cvtest::norm(expected, dst[2], NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(expected_no_dht, dst[3], NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(expected, dst[4], NORM_INF));
+}
+
+static vector<uchar> readFileBytes(const string& filename)
+{
+    vector<uchar> bytes;
+    FILE* f = fopen(filename.c_str(), "rb");
+    if (!f)
+        return bytes;
+    fseek(f, 0, SEEK_END);
+    bytes.resize((size_t)ftell(f));
+    fseek(f, 0, SEEK_SET);
+    bytes.resize(fread(bytes.empty() ? NULL : &bytes[0], 1, bytes.size(), f));
+    fclose(f);
+    return bytes;
+}
+
+typedef testing::TestWithParam<Ext> Imgcodecs_Image_Stream;
+
+TEST_P(Imgcodecs_Image_Stream, write_bands_and_tiles)
+{
+    const string ext = GetParam();
+    RNG rng(777);
+    Mat image(301, 257, CV_8UC3);
+    rng.fill(image, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    GaussianBlur(image, image, Size(5, 5), 2);
+
+    vector<int> tiled;
+    if (ext == "tiff")
+    {
+        tiled.push_back(322); // TIFFTAG_TILEWIDTH
+        tiled.push_back(64);
+        tiled.push_back(323); // TIFFTAG_TILELENGTH
+        tiled.push_back(48);
+    }
+    const string filename = cv::tempfile(("." + ext).c_str());
+    for (int mode = 0; mode < 2; mode++)
+    {
+        SCOPED_TRACE(mode == 0 ? "bands" : "tiles");
+        ImageWriter writer(filename, image.size(), image.type(), mode == 0 ? vector<int>() : tiled);
+        ASSERT_TRUE(writer.isOpened());
+        for (int y = 0; y < image.rows; )
+        {
+            int h = std::min(7 + y % 13, image.rows - y);
+            if (mode == 0)
+                ASSERT_TRUE(writer.write(image.rowRange(y, y + h)));
+            else
+                for (int x = 0; x < image.cols; x += 100)
+                    ASSERT_TRUE(writer.write(image(Rect(x, y, std::min(100, image.cols - x), h))));
+            y += h;
+        }
+        ASSERT_TRUE(writer.release());
+        EXPECT_FALSE(writer.isOpened());
+
+        vector<uchar> buf;
+        ASSERT_TRUE(imencode("." + ext, image, buf));
+        if (ext != "tiff")
+            EXPECT_EQ(buf, readFileBytes(filename));
+        EXPECT_EQ(0, cvtest::norm(imdecode(buf, IMREAD_COLOR), imread(filename), NORM_INF));
+    }
+
+    // incomplete images are reported
+    {
+        ImageWriter writer(filename, image.size(), image.type());
+        ASSERT_TRUE(writer.write(image.rowRange(0, 10)));
+        EXPECT_FALSE(writer.release());
+    }
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
+TEST_P(Imgcodecs_Image_Stream, read_bands)
+{
+    const string ext = GetParam();
+    RNG rng(778);
+    Mat image(203, 171, CV_8UC3);
+    rng.fill(image, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    GaussianBlur(image, image, Size(5, 5), 2);
+    const string filename = cv::tempfile(("." + ext).c_str());
+    ASSERT_TRUE(imwrite(filename, image));
+
+    const int modes[] = { IMREAD_COLOR, IMREAD_GRAYSCALE, IMREAD_UNCHANGED };
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++)
+    {
+        SCOPED_TRACE(modes[m]);
+        Mat expected = imread(filename, modes[m]);
+        ASSERT_FALSE(expected.empty());
+
+        ImageReader reader(filename, modes[m]);
+        ASSERT_TRUE(reader.isOpened());
+        EXPECT_EQ(expected.size(), reader.size());
+        EXPECT_EQ(expected.type(), reader.type());
+        Mat band;
+        int y = 0;
+        while (reader.read(band, 9 + y % 11))
+        {
+            ASSERT_LE(y + band.rows, expected.rows);
+            EXPECT_EQ(0, cvtest::norm(expected.rowRange(y, y + band.rows), band, NORM_INF)) << "y=" << y;
+            y += band.rows;
+        }
+        EXPECT_EQ(expected.rows, y);
+    }
+    EXPECT_FALSE(ImageReader(filename + ".missing").isOpened());
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
+const string stream_exts[] = {
+#ifdef HAVE_PNG
+    "png",
+#endif
+#ifdef HAVE_TIFF
+    "tiff",
+#endif
+#ifdef HAVE_JPEG
+    "jpg",
+#endif
+};
+
+INSTANTIATE_TEST_CASE_P(imgcodecs, Imgcodecs_Image_Stream, testing::ValuesIn(stream_exts));
+
+TEST(Imgcodecs_Image, stream_read_fallback_bmp)
+{
+    Mat image(45, 67, CV_8UC3);
+    RNG(779).fill(image, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    const string filename = cv::tempfile(".bmp");
+    ASSERT_TRUE(imwrite(filename, image));
+
+    ImageReader reader(filename);
+    Mat band;
+    ASSERT_TRUE(reader.read(band, 40));
+    EXPECT_EQ(0, cvtest::norm(image.rowRange(0, 40), band, NORM_INF));
+    ASSERT_TRUE(reader.read(band, 40));
+    EXPECT_EQ(0, cvtest::norm(image.rowRange(40, 45), band, NORM_INF));
+    EXPECT_FALSE(reader.read(band, 40));
+
+    // bmp can't be written incrementally
+    EXPECT_FALSE(ImageWriter(filename, image.size(), image.type()).isOpened());
+    EXPECT_EQ(0, remove(filename.c_str()));
+}
+
 TEST(Imgcodecs_Image, regression_9376)
 {
     String path = findDataFile("readwrite/regression_9376.bmp");
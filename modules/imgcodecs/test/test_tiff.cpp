@@ -240,6 +240,36 @@ TEST(Imgcodecs_Tiff_Modes, write_multipage)
 
 //==================================================================================================
 
+TEST(Imgcodecs_Tiff, encode_multithreaded)
+{
+    RNG rng(12345);
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16UC1, CV_16UC4 };
+    const int compressions[] = { COMPRESSION_LZW, COMPRESSION_ADOBE_DEFLATE };
+    for (size_t t = 0; t < sizeof(types)/sizeof(types[0]); t++)
+    {
+        Mat img(301, 257, types[t]);
+        rng.fill(img, RNG::UNIFORM, Scalar::all(0), Scalar::all(CV_MAT_DEPTH(types[t]) == CV_8U ? 256 : 65536));
+        for (size_t c = 0; c < sizeof(compressions)/sizeof(compressions[0]); c++)
+        {
+            SCOPED_TRACE(cv::format("type=%d compression=%d", types[t], compressions[c]));
+            vector<int> params;
+            params.push_back(TIFFTAG_COMPRESSION);
+            params.push_back(compressions[c]);
+            vector<uchar> serial, parallel;
+            ASSERT_TRUE(imencode(".tiff", img, serial, params));
+            params.push_back(IMWRITE_THREADS);
+            params.push_back(4);
+            ASSERT_TRUE(imencode(".tiff", img, parallel, params));
+
+            // strips are compressed independently, so the files are the same
+            EXPECT_EQ(serial, parallel);
+            Mat decoded = imdecode(parallel, IMREAD_UNCHANGED);
+            ASSERT_FALSE(decoded.empty());
+            EXPECT_EQ(0, cvtest::norm(img, decoded, NORM_INF));
+        }
+    }
+}
+
 TEST(Imgcodecs_Tiff, imdecode_no_exception_temporary_file_removed)
 {
     const string root = cvtest::TS::ptr()->get_data_path();
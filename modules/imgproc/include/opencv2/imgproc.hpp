@@ -3844,6 +3844,31 @@ CV_EXPORTS_W void findContours( InputOutputArray image, OutputArrayOfArrays cont
 CV_EXPORTS void findContours( InputOutputArray image, OutputArrayOfArrays contours,
                               int mode, int method, Point offset = Point());
 
+/** @brief Finds contours in a binary image and stores the points of all of them in one array.
+
+The function retrieves the same contours in the same order as findContours does, but without allocating
+an array per contour: the points of the i-th contour are the elements from starts[i] to starts[i+1]-1
+of points. The borders are found from the connected components of the image and of its background and
+are traced in parallel, so the result does not depend on the number of threads.
+
+The only difference from findContours is with #RETR_TREE and more than 127 borders: findContours may then
+report a parent that does not enclose the contour, while this function always reports the enclosing one.
+The labels of the components take two 32-bit images of the size of the image (8 bytes per pixel) in
+addition to the copy of the image with a border of 1 pixel, so on a single thread or when memory is
+short findContours may be preferable.
+
+@param image Source, an 8-bit single-channel image. Non-zero pixels are treated as 1's, see findContours.
+@param points Output array of the points of all the contours (e.g. std::vector<cv::Point>).
+@param starts Output array of the indices of the first points of the contours in points, followed by
+the total number of points (e.g. std::vector<int>).
+@param hierarchy Optional output vector of the topology of the contours, see findContours.
+@param mode Contour retrieval mode, one of #RETR_EXTERNAL, #RETR_LIST, #RETR_CCOMP and #RETR_TREE.
+@param method Contour approximation method, #CHAIN_APPROX_NONE or #CHAIN_APPROX_SIMPLE.
+@param offset Optional offset by which every contour point is shifted.
+ */
+CV_EXPORTS_W void findContoursFlat( InputArray image, OutputArray points, OutputArray starts,
+                                    OutputArray hierarchy, int mode, int method, Point offset = Point());
+
 /** @brief Approximates a polygonal curve(s) with the specified precision.
 
 The function cv::approxPolyDP approximates a curve or a polygon with another curve/polygon with less
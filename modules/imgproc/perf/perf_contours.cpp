@@ -0,0 +1,65 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+#include "perf_precomp.hpp"
+
+namespace opencv_test {
+
+CV_ENUM(RetrMode, RETR_EXTERNAL, RETR_LIST, RETR_CCOMP, RETR_TREE)
+CV_ENUM(ApproxMode, CHAIN_APPROX_NONE, CHAIN_APPROX_SIMPLE)
+
+typedef tuple<Size, RetrMode, ApproxMode> TestFindContours_t;
+typedef perf::TestBaseWithParam<TestFindContours_t> TestFindContours;
+
+// a mask with thousands of blobs, most of them with holes
+static Mat makeBlobMask(Size size)
+{
+    Mat noise(size, CV_32F);
+    RNG rng(0);
+    rng.fill(noise, RNG::UNIFORM, 0, 1);
+    GaussianBlur(noise, noise, Size(), 3);
+    return noise > 0.5;
+}
+
+PERF_TEST_P(TestFindContours, findContours,
+            testing::Combine(
+                testing::Values(szVGA, sz1080p),
+                RetrMode::all(),
+                ApproxMode::all()
+                )
+            )
+{
+    Size size = get<0>(GetParam());
+    int mode = get<1>(GetParam());
+    int method = get<2>(GetParam());
+    Mat img = makeBlobMask(size);
+    std::vector<std::vector<Point> > contours;
+    std::vector<Vec4i> hierarchy;
+
+    TEST_CYCLE() findContours(img, contours, hierarchy, mode, method);
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(TestFindContours, findContoursFlat,
+            testing::Combine(
+                testing::Values(szVGA, sz1080p),
+                RetrMode::all(),
+                ApproxMode::all()
+                )
+            )
+{
+    Size size = get<0>(GetParam());
+    int mode = get<1>(GetParam());
+    int method = get<2>(GetParam());
+    Mat img = makeBlobMask(size);
+    std::vector<Point> points;
+    std::vector<int> starts;
+    std::vector<Vec4i> hierarchy;
+
+    TEST_CYCLE() findContoursFlat(img, points, starts, hierarchy, mode, method);
+
+    SANITY_CHECK_NOTHING();
+}
+
+} // namespace
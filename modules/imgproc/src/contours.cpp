@@ -1930,6 +1930,311 @@ cvFindContours( void*  img,  CvMemStorage*  storage,
     return cvFindContours_Impl(img, storage, firstContour, cntHeaderSize, mode, method, offset, 1);
 }
 
+namespace cv
+{
+
+// a border found by the raster scan of the Suzuki algorithm. The scan meets an outer border at the first pixel
+// of its foreground component (8-connected) and a hole border at the first pixel of its hole (a 4-connected
+// background component), the hole border is traced from the pixel to the left of it.
+struct ContourBorder
+{
+    size_t pos;         // position of the scan that finds the border
+    Point origin;       // pixel the border is traced from
+    int is_hole;
+    int label;          // label of the foreground component or of the hole
+    int parent;         // index of the parent border, -1 for the frame of the image
+
+    bool operator < (const ContourBorder& other) const { return pos < other.pos; }
+};
+
+// follows the border from its origin the same way as icvFetchContour does
+static void traceBorder( const uchar* ptr, int step, Point pt, int is_hole, bool simple,
+                         std::vector<Point>& points )
+{
+    int deltas[MAX_SIZE];
+    const uchar *i0 = ptr, *i1, *i3, *i4 = 0;
+    int prev_s = -1, s, s_end;
+
+    CV_INIT_3X3_DELTAS( deltas, step, 1 );
+    memcpy( deltas + 8, deltas, 8 * sizeof( deltas[0] ));
+
+    s_end = s = is_hole ? 0 : 4;
+    do
+    {
+        s = (s - 1) & 7;
+        i1 = i0 + deltas[s];
+    }
+    while( *i1 == 0 && s != s_end );
+
+    if( s == s_end )            /* single pixel domain */
+    {
+        points.push_back(pt);
+        return;
+    }
+
+    i3 = i0;
+    prev_s = s ^ 4;
+    for( ;; )
+    {
+        while( s < MAX_SIZE - 1 )
+        {
+            i4 = i3 + deltas[++s];
+            if( *i4 != 0 )
+                break;
+        }
+        s &= 7;
+
+        if( s != prev_s || !simple )
+        {
+            points.push_back(pt);
+            prev_s = s;
+        }
+        pt.x += icvCodeDeltas[s].x;
+        pt.y += icvCodeDeltas[s].y;
+
+        if( i4 == i0 && i3 == i1 )
+            break;
+
+        i3 = i4;
+        s = (s + 4) & 7;
+    }
+}
+
+// the first pixel of every label in the raster order, found in parallel stripes of rows. Only the pixels
+// that differ from their left neighbors are checked, as the first pixel of a component always does.
+static void findFirstPixels( const Mat& image, const Mat& fg_labels, int nfg, const Mat& bg_labels, int nbg,
+                             std::vector<size_t>& fg_first, std::vector<size_t>& bg_first )
+{
+    const size_t none = (size_t)-1;
+    int nstripes = std::max(1, std::min(image.rows, getNumThreads()));
+    std::vector<std::vector<std::pair<int, size_t> > > stripe_fg(nstripes), stripe_bg(nstripes);
+
+    parallel_for_(Range(0, nstripes), [&](const Range& range)
+    {
+        std::vector<uchar> fg_seen(nfg), bg_seen(nbg);
+        for( int k = range.start; k < range.end; k++ )
+        {
+            int y0 = (int)((int64)image.rows * k / nstripes), y1 = (int)((int64)image.rows * (k + 1) / nstripes);
+            std::fill(fg_seen.begin(), fg_seen.end(), (uchar)0);
+            std::fill(bg_seen.begin(), bg_seen.end(), (uchar)0);
+            for( int y = y0; y < y1; y++ )
+            {
+                const uchar* row = image.ptr<uchar>(y);
+                const int* fg_row = fg_labels.ptr<int>(y);
+                const int* bg_row = bg_labels.ptr<int>(y);
+                size_t row_pos = (size_t)y * image.cols;
+                for( int x = 1; x < image.cols; x++ )
+                {
+                    if( (row[x] != 0) == (row[x - 1] != 0) )
+                        continue;
+                    if( row[x] != 0 )
+                    {
+                        int l = fg_row[x];
+                        if( !fg_seen[l] )
+                        {
+                            fg_seen[l] = 1;
+                            stripe_fg[k].push_back(std::make_pair(l, row_pos + x));
+                        }
+                    }
+                    else
+                    {
+                        int l = bg_row[x];
+                        if( !bg_seen[l] )
+                        {
+                            bg_seen[l] = 1;
+                            stripe_bg[k].push_back(std::make_pair(l, row_pos + x));
+                        }
+                    }
+                }
+            }
+        }
+    });
+
+    fg_first.assign(nfg, none);
+    bg_first.assign(nbg, none);
+    for( int k = 0; k < nstripes; k++ )
+    {
+        for( size_t i = 0; i < stripe_fg[k].size(); i++ )
+            if( fg_first[stripe_fg[k][i].first] == none )
+                fg_first[stripe_fg[k][i].first] = stripe_fg[k][i].second;
+        for( size_t i = 0; i < stripe_bg[k].size(); i++ )
+            if( bg_first[stripe_bg[k][i].first] == none )
+                bg_first[stripe_bg[k][i].first] = stripe_bg[k][i].second;
+    }
+}
+
+// Retrieves the contours of a binary image with a zero border of at least one pixel. The borders are found
+// from the connected components of the image and of its background, so they are traced in parallel, and the
+// points of all the contours are stored one after another. The contours, their order and the hierarchy are the
+// same as the ones of cvFindNextContour and cvTreeToNodeSeq: siblings go from the last found border to the first
+// one, and every contour is followed by its children. Only the parents are always exact here, while the scan
+// may pick a wrong one when its 7-bit border marks wrap around. The labels of the image and of its background
+// take two CV_32S images of the size of the image.
+static void findContoursFlat_( const Mat& image, int mode, int method, Point offset,
+                               OutputArray _points, OutputArray _starts, std::vector<Vec4i>& hierarchy )
+{
+    CV_Assert( image.type() == CV_8UC1 );
+    CV_Assert( mode == RETR_EXTERNAL || mode == RETR_LIST || mode == RETR_CCOMP || mode == RETR_TREE );
+    CV_Assert( method == CHAIN_APPROX_NONE || method == CHAIN_APPROX_SIMPLE );
+
+    Mat fg_labels, bg_labels;
+    int nfg = connectedComponents(image, fg_labels, 8, CV_32S);
+    int nbg = connectedComponents(image == 0, bg_labels, 4, CV_32S);
+    int outer_bg = bg_labels.at<int>(0, 0);
+
+    std::vector<size_t> fg_first, bg_first;
+    findFirstPixels(image, fg_labels, nfg, bg_labels, nbg, fg_first, bg_first);
+
+    std::vector<ContourBorder> borders;
+    borders.reserve(nfg + nbg);
+    for( int l = 1; l < nfg; l++ )
+    {
+        ContourBorder b;
+        b.pos = fg_first[l];
+        b.origin = Point((int)(b.pos % image.cols), (int)(b.pos / image.cols));
+        b.is_hole = 0;
+        b.label = l;
+        b.parent = -1;
+        borders.push_back(b);
+    }
+    for( int l = 1; l < nbg; l++ )
+    {
+        if( l == outer_bg || mode == RETR_EXTERNAL )
+            continue;
+        ContourBorder b;
+        b.pos = bg_first[l];
+        b.origin = Point((int)(b.pos % image.cols) - 1, (int)(b.pos / image.cols));
+        b.is_hole = 1;
+        b.label = l;
+        b.parent = -1;
+        borders.push_back(b);
+    }
+    std::sort(borders.begin(), borders.end());
+
+    int nborders = (int)borders.size();
+    if( mode != RETR_LIST )
+    {
+        std::vector<int> fg_border(nfg, -1), bg_border(nbg, -1);
+        for( int i = 0; i < nborders; i++ )
+            (borders[i].is_hole ? bg_border : fg_border)[borders[i].label] = i;
+
+        // a hole belongs to the outer border of the component around it, and an outer border belongs to the
+        // hole it lies in, unless it lies in the background of the whole image
+        int n = 0;
+        for( int i = 0; i < nborders; i++ )
+        {
+            ContourBorder& b = borders[i];
+            if( b.is_hole )
+                b.parent = fg_border[fg_labels.at<int>(b.origin)];
+            else
+            {
+                int bg = bg_labels.at<int>(b.origin.y, b.origin.x - 1);
+                if( bg != outer_bg )
+                {
+                    if( mode == RETR_EXTERNAL )
+                        continue;
+                    if( mode == RETR_TREE )
+                        b.parent = bg_border[bg];
+                }
+            }
+            borders[n++] = b;
+        }
+        if( n < nborders )
+        {
+            // only the contours in the background of the whole image are left, they have no parents
+            borders.resize(n);
+            nborders = n;
+        }
+    }
+
+    // the children are prepended to the lists of their parents, as cvInsertNodeIntoTree does
+    std::vector<int> first_child(nborders + 1, -1), next(nborders, -1), prev(nborders, -1);
+    for( int i = 0; i < nborders; i++ )
+    {
+        int p = borders[i].parent < 0 ? nborders : borders[i].parent;
+        next[i] = first_child[p];
+        if( next[i] >= 0 )
+            prev[next[i]] = i;
+        first_child[p] = i;
+    }
+
+    std::vector<int> order, index(nborders);
+    order.reserve(nborders);
+    for( int i = first_child[nborders]; i >= 0; )
+    {
+        index[i] = (int)order.size();
+        order.push_back(i);
+        if( first_child[i] >= 0 )
+        {
+            i = first_child[i];
+            continue;
+        }
+        while( i >= 0 && next[i] < 0 )
+            i = borders[i].parent;
+        if( i >= 0 )
+            i = next[i];
+    }
+
+    hierarchy.resize(nborders);
+    for( int k = 0; k < nborders; k++ )
+    {
+        int i = order[k];
+        hierarchy[k] = Vec4i(next[i] >= 0 ? index[next[i]] : -1,
+                             prev[i] >= 0 ? index[prev[i]] : -1,
+                             first_child[i] >= 0 ? index[first_child[i]] : -1,
+                             borders[i].parent >= 0 ? index[borders[i].parent] : -1);
+    }
+
+    // the contours are traced in chunks of consecutive ones, whose points are then put one after another
+    int nchunks = std::max(1, std::min(nborders, getNumThreads() * 8));
+    std::vector<std::vector<Point> > chunk_points(nchunks);
+    _starts.create(nborders + 1, 1, CV_32S);
+    Mat starts_mat = _starts.getMat();
+    CV_Assert( starts_mat.isContinuous() );
+    int* starts = starts_mat.ptr<int>();
+    starts[0] = 0;
+    parallel_for_(Range(0, nchunks), [&](const Range& range)
+    {
+        for( int c = range.start; c < range.end; c++ )
+        {
+            int k0 = (int)((int64)nborders * c / nchunks), k1 = (int)((int64)nborders * (c + 1) / nchunks);
+            std::vector<Point>& pts = chunk_points[c];
+            for( int k = k0; k < k1; k++ )
+            {
+                const ContourBorder& b = borders[order[k]];
+                traceBorder(image.ptr<uchar>(b.origin.y, b.origin.x), (int)image.step, b.origin + offset,
+                            b.is_hole, method == CHAIN_APPROX_SIMPLE, pts);
+                starts[k + 1] = (int)pts.size();
+            }
+        }
+    });
+
+    std::vector<size_t> chunk_starts(nchunks + 1, 0);
+    for( int c = 0; c < nchunks; c++ )
+    {
+        int k0 = (int)((int64)nborders * c / nchunks), k1 = (int)((int64)nborders * (c + 1) / nchunks);
+        for( int k = k0; k < k1; k++ )
+            starts[k + 1] += (int)chunk_starts[c];
+        chunk_starts[c + 1] = chunk_starts[c] + chunk_points[c].size();
+    }
+    _points.create((int)chunk_starts[nchunks], 1, CV_32SC2);
+    if( chunk_starts[nchunks] == 0 )
+        return;
+    Mat points_mat = _points.getMat();
+    CV_Assert( points_mat.isContinuous() );
+    Point* points = points_mat.ptr<Point>();
+    parallel_for_(Range(0, nchunks), [&](const Range& range)
+    {
+        for( int c = range.start; c < range.end; c++ )
+        {
+            std::copy(chunk_points[c].begin(), chunk_points[c].end(), points + chunk_starts[c]);
+            std::vector<Point>().swap(chunk_points[c]);
+        }
+    });
+}
+
+}
+
 void cv::findContours( InputOutputArray _image, OutputArrayOfArrays _contours,
                    OutputArray _hierarchy, int mode, int method, Point offset )
 {
@@ -2003,4 +2308,27 @@ void cv::findContours( InputOutputArray _image, OutputArrayOfArrays _contours,
     findContours(_image, _contours, noArray(), mode, method, offset);
 }
 
+void cv::findContoursFlat( InputArray _image, OutputArray _points, OutputArray _starts,
+                           OutputArray _hierarchy, int mode, int method, Point offset )
+{
+    CV_INSTRUMENT_REGION()
+
+    CV_Assert( _image.type() == CV_8UC1 );
+    CV_Assert( mode == RETR_EXTERNAL || mode == RETR_LIST || mode == RETR_CCOMP || mode == RETR_TREE );
+    CV_Assert( method == CHAIN_APPROX_NONE || method == CHAIN_APPROX_SIMPLE );
+
+    Mat image0 = _image.getMat(), image;
+    copyMakeBorder(image0, image, 1, 1, 1, 1, BORDER_CONSTANT | BORDER_ISOLATED, Scalar(0));
+
+    std::vector<Vec4i> hierarchy;
+    findContoursFlat_(image, mode, method, offset - Point(1, 1), _points, _starts, hierarchy);
+
+    if( _hierarchy.needed() )
+    {
+        _hierarchy.create(1, (int)hierarchy.size(), CV_32SC4, -1, true);
+        if( !hierarchy.empty() )
+            memcpy(_hierarchy.getMat().ptr(), &hierarchy[0], hierarchy.size() * sizeof(Vec4i));
+    }
+}
+
 /* End of file. */
@@ -485,6 +485,104 @@ TEST(Imgproc_FindContours, border)
     ASSERT_EQ(0, cvtest::norm(img, img_draw_contours, NORM_INF));
 }
 
+// blobs with holes and blobs in the holes, fewer than the 127 borders the sequential scan tells apart
+static Mat makeNestedBlobs(RNG& rng, Size size)
+{
+    Mat img = Mat::zeros(size, CV_8U);
+    for (int i = 0; i < 20; i++)
+    {
+        Point center(rng.uniform(0, size.width), rng.uniform(0, size.height));
+        int radius = rng.uniform(5, 40);
+        circle(img, center, radius, Scalar(255), FILLED);
+        circle(img, center, radius * 2 / 3, Scalar(0), FILLED);
+        circle(img, center, radius / 3, Scalar(i % 2 ? 255 : 7), rng.uniform(1, 3));
+    }
+    img.row(0).colRange(0, size.width / 2).setTo(255);
+    img.col(size.width - 1).setTo(255);
+    return img;
+}
+
+TEST(Imgproc_FindContours, parallel_borders)
+{
+    RNG& rng = theRNG();
+    int threads = getNumThreads();
+    const int modes[] = { RETR_EXTERNAL, RETR_LIST, RETR_CCOMP, RETR_TREE };
+    for (int iter = 0; iter < 5; iter++)
+    {
+        Mat img = makeNestedBlobs(rng, Size(rng.uniform(200, 400), rng.uniform(200, 400)));
+        for (int m = 0; m < 4; m++)
+            for (int method = CHAIN_APPROX_NONE; method <= CHAIN_APPROX_SIMPLE; method++)
+            {
+                std::vector<std::vector<Point> > expected;
+                std::vector<Vec4i> expected_hierarchy, flat_hierarchy, flat_hierarchy1;
+                std::vector<Point> points, points1;
+                std::vector<int> starts, starts1;
+
+                findContours(img, expected, expected_hierarchy, modes[m], method, Point(3, -2));
+                setNumThreads(1);
+                findContoursFlat(img, points1, starts1, flat_hierarchy1, modes[m], method, Point(3, -2));
+                setNumThreads(std::max(threads, 4));
+                findContoursFlat(img, points, starts, flat_hierarchy, modes[m], method, Point(3, -2));
+                setNumThreads(threads);
+
+                EXPECT_TRUE(expected_hierarchy == flat_hierarchy) << "mode " << modes[m] << ", method " << method;
+                EXPECT_TRUE(points1 == points);
+                EXPECT_TRUE(starts1 == starts);
+                EXPECT_TRUE(flat_hierarchy1 == flat_hierarchy);
+                ASSERT_EQ(expected.size() + 1, starts.size());
+                for (size_t i = 0; i < expected.size(); i++)
+                    EXPECT_TRUE(expected[i] == std::vector<Point>(points.begin() + starts[i], points.begin() + starts[i + 1]))
+                        << "contour " << i;
+            }
+    }
+}
+
+TEST(Imgproc_FindContours, parallel_borders_tree)
+{
+    // thousands of nested borders, every contour must lie inside its parent
+    Mat noise(400, 400, CV_32F), img;
+    theRNG().fill(noise, RNG::UNIFORM, 0, 1);
+    GaussianBlur(noise, noise, Size(), 1.5);
+    img = noise > 0.5;
+
+    int threads = getNumThreads();
+    std::vector<Point> points, points1;
+    std::vector<int> starts, starts1;
+    std::vector<Vec4i> hierarchy, hierarchy1;
+    setNumThreads(1);
+    findContoursFlat(img, points1, starts1, hierarchy1, RETR_TREE, CHAIN_APPROX_NONE);
+    setNumThreads(std::max(threads, 4));
+    findContoursFlat(img, points, starts, hierarchy, RETR_TREE, CHAIN_APPROX_NONE);
+    setNumThreads(threads);
+
+    EXPECT_TRUE(points1 == points);
+    EXPECT_TRUE(starts1 == starts);
+    EXPECT_TRUE(hierarchy1 == hierarchy);
+    ASSERT_EQ(starts.size(), hierarchy.size() + 1);
+    ASSERT_GT(hierarchy.size(), 500u);
+    for (size_t i = 0; i < hierarchy.size(); i++)
+    {
+        int parent = hierarchy[i][3];
+        if (parent < 0)
+            continue;
+        EXPECT_EQ((int)i, hierarchy[i][1] >= 0 ? hierarchy[hierarchy[i][1]][0] : hierarchy[parent][2]);
+        std::vector<Point> parent_contour(points.begin() + starts[parent], points.begin() + starts[parent + 1]);
+        EXPECT_GE(pointPolygonTest(parent_contour, points[starts[i]], false), 0) << "contour " << i;
+    }
+
+    // the outputs are written in place, whatever their kind
+    Mat points_mat, starts_mat;
+    findContoursFlat(img, points_mat, starts_mat, noArray(), RETR_TREE, CHAIN_APPROX_NONE);
+    EXPECT_EQ(0, cvtest::norm(Mat(points), points_mat, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(Mat(starts), starts_mat, NORM_INF));
+
+    findContoursFlat(Mat::zeros(10, 10, CV_8U), points, starts, hierarchy, RETR_TREE, CHAIN_APPROX_NONE);
+    EXPECT_TRUE(points.empty());
+    ASSERT_EQ(1u, starts.size());
+    EXPECT_EQ(0, starts[0]);
+    EXPECT_TRUE(hierarchy.empty());
+}
+
 TEST(Imgproc_PointPolygonTest, regression_10222)
 {
     vector<Point> contour;
@@ -670,6 +670,55 @@ public:
     void groupRectangles(std::vector<cv::Rect>& rectList, std::vector<double>& weights, int groupThreshold, double eps) const;
 };
 
+/** @brief Multi-scale HOG detector for video streams.
+
+The block histograms are computed exactly at two levels per octave of the scale pyramid, the levels
+in between take the nearest block histograms of the closest finer exact level (feature pyramid
+approximation). The windows of the exact levels get the same scores as in
+HOGDescriptor::detectMultiScale.
+
+The block histograms of the exact levels are kept between the calls. When a motion mask is passed
+with a frame of the same size as the previous one, only the blocks overlapping the moving pixels are
+computed again.
+
+The window stride must be a multiple of the block stride.
+*/
+class CV_EXPORTS HOGVideoDetector
+{
+public:
+    /** @brief Creates the detector.
+    @param hog Descriptor parameters and SVM coefficients, they are copied.
+    */
+    explicit HOGVideoDetector(const HOGDescriptor& hog);
+    ~HOGVideoDetector();
+
+    /** @brief Detects objects of different sizes in a video frame.
+    @param frame Matrix of the type CV_8U or CV_8UC3.
+    @param foundLocations Detected objects boundaries.
+    @param foundWeights Confidences of the detected objects.
+    @param motionMask Optional CV_8UC1 mask of the frame size, non-zero where the frame changed since
+    the previous call. Without it all the blocks are computed.
+    @param hitThreshold See HOGDescriptor::detectMultiScale.
+    @param winStride Window stride, a multiple of the block stride. Defaults to the block stride.
+    @param padding See HOGDescriptor::detectMultiScale.
+    @param scale Coefficient of the detection window increase.
+    @param finalThreshold See HOGDescriptor::detectMultiScale.
+    @param useMeanshiftGrouping See HOGDescriptor::detectMultiScale.
+    */
+    void detectMultiScale(InputArray frame, std::vector<Rect>& foundLocations,
+                          std::vector<double>& foundWeights, InputArray motionMask = noArray(),
+                          double hitThreshold = 0, Size winStride = Size(), Size padding = Size(),
+                          double scale = 1.05, double finalThreshold = 2.0,
+                          bool useMeanshiftGrouping = false);
+
+    //! Drops the block histograms kept from the previous frame
+    void reset();
+
+protected:
+    struct Impl;
+    Ptr<Impl> p;
+};
+
 class CV_EXPORTS QRCodeDetector
 {
 public:
@@ -680,6 +729,28 @@ public:
     void setEpsY(double epsY);
 
     bool detect(InputArray in, OutputArray points) const;
+
+    /** @brief Detects all the QR codes in the image.
+
+    The finder patterns of images with the smaller side of 960 pixels or more are searched at the half
+    resolution, so the codes there need modules of 3 pixels at least. The candidates are verified at
+    the full resolution, grouped into codes by three, and the quadrangles of the codes are computed in
+    parallel. The row scans of the finder patterns use the tolerance set by setEpsX, the cross checks
+    use the one set by setEpsY. At most 256 finder patterns, the ones confirmed by the most rows, are
+    grouped into codes.
+    @param img Matrix of the type CV_8UC1 containing the image.
+    @param points Output vector of the quadrangle vertices, 4 consecutive points per found code.
+    @return true if at least one code is found.
+    */
+    bool detectMulti(InputArray img, OutputArray points) const;
+
+    /** @brief Detects all the QR codes in each image of the batch.
+
+    The images are processed in parallel.
+    @param imgs Images of the type CV_8UC1.
+    @param points Output quadrangle vertices for each image, see detectMulti.
+    */
+    void detectMultiBatch(InputArrayOfArrays imgs, std::vector<std::vector<Point2f> >& points) const;
 protected:
     struct Impl;
     Ptr<Impl> p;
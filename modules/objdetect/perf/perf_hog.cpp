@@ -0,0 +1,43 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+#include "opencv2/imgproc.hpp"
+
+namespace opencv_test
+{
+using namespace perf;
+
+typedef perf::TestBaseWithParam<bool> HOGVideo_Motion;
+
+PERF_TEST_P(HOGVideo_Motion, detectMultiScale_1080p, testing::Bool())
+{
+    bool useMask = GetParam();
+    Mat src = imread(getDataPath("gpu/hog/road.png"));
+    ASSERT_FALSE(src.empty());
+    Mat frame;
+    resize(src, frame, sz1080p, 0, 0, INTER_LINEAR_EXACT);
+
+    HOGDescriptor hog;
+    hog.setSVMDetector(HOGDescriptor::getDefaultPeopleDetector());
+    HOGVideoDetector detector(hog);
+    vector<Rect> found;
+    vector<double> weights;
+
+    // a moving object covering a few percent of the frame
+    Mat mask;
+    if (useMask)
+    {
+        mask = Mat::zeros(frame.size(), CV_8U);
+        mask(Rect(800, 400, 240, 320)).setTo(255);
+    }
+    detector.detectMultiScale(frame, found, weights);
+
+    declare.in(frame);
+    TEST_CYCLE() detector.detectMultiScale(frame, found, weights, mask);
+
+    SANITY_CHECK_NOTHING();
+}
+
+} // namespace
@@ -0,0 +1,78 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+#include "opencv2/imgproc.hpp"
+
+namespace opencv_test
+{
+using namespace perf;
+
+// a grid of codes with random data modules, versions 1-10 and modules of 3-6 pixels
+static Mat makeQRCodesFrame(Size size, int cols, int rows, int seed)
+{
+    RNG rng(seed);
+    Mat img(size, CV_8UC1, Scalar::all(255));
+    Size cell(size.width / cols, size.height / rows);
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            int module_size = rng.uniform(3, 7);
+            int max_version = (std::min(cell.width, cell.height) / module_size - 8 - 17) / 4;
+            if (max_version < 1) { continue; }
+            int n = 17 + 4 * rng.uniform(1, std::min(max_version, 10) + 1);
+            Mat code(n, n, CV_8UC1);
+            rng.fill(code, RNG::UNIFORM, 0, 2);
+            code *= 255;
+            for (int i = 8; i < n - 8; i++)
+                code.at<uchar>(6, i) = code.at<uchar>(i, 6) = i % 2 ? 255 : 0;
+            Point finders[] = { Point(0, 0), Point(n - 7, 0), Point(0, n - 7) };
+            for (int i = 0; i < 3; i++)
+            {
+                code(Rect(finders[i].x - 1, finders[i].y - 1, 9, 9) & Rect(0, 0, n, n)).setTo(255);
+                code(Rect(finders[i].x, finders[i].y, 7, 7)).setTo(0);
+                code(Rect(finders[i].x + 1, finders[i].y + 1, 5, 5)).setTo(255);
+                code(Rect(finders[i].x + 2, finders[i].y + 2, 3, 3)).setTo(0);
+            }
+            int side = n * module_size;
+            Rect roi(x * cell.width + (cell.width - side) / 2, y * cell.height + (cell.height - side) / 2, side, side);
+            resize(code, img(roi), roi.size(), 0, 0, INTER_NEAREST);
+        }
+    }
+    GaussianBlur(img, img, Size(3, 3), 0);
+    return img;
+}
+
+typedef perf::TestBaseWithParam<Size> Size_QRCodes;
+
+PERF_TEST_P(Size_QRCodes, detectMulti, testing::Values(szVGA, sz1080p))
+{
+    Size sz = GetParam();
+    Mat img = makeQRCodesFrame(sz, sz.width / 240, sz.height / 240, 0);
+    QRCodeDetector detector;
+    vector<Point2f> corners;
+
+    declare.in(img);
+    TEST_CYCLE() detector.detectMulti(img, corners);
+
+    EXPECT_GT(corners.size(), 0u);
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST(QRCodes, detectMultiBatch_1080p)
+{
+    vector<Mat> frames;
+    for (int i = 0; i < 8; i++)
+        frames.push_back(makeQRCodesFrame(sz1080p, 8, 4, i));
+    QRCodeDetector detector;
+    vector<vector<Point2f> > corners;
+
+    TEST_CYCLE() detector.detectMultiBatch(frames, corners);
+
+    ASSERT_EQ(frames.size(), corners.size());
+    SANITY_CHECK_NOTHING();
+}
+
+} // namespace
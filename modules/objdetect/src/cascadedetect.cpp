@@ -46,6 +46,7 @@
 #include "cascadedetect.hpp"
 #include "opencv2/objdetect/objdetect_c.h"
 #include "opencl_kernels_objdetect.hpp"
+#include "opencv2/core/hal/intrin.hpp"
 
 namespace cv
 {
@@ -727,6 +728,17 @@ bool HaarEvaluator::setWindow( Point pt, int scaleIdx )
     }
 }
 
+int HaarEvaluator::setWindows( Point pt, int step, int n, int scaleIdx, float* normFactors )
+{
+    int count = 0;
+    for( int k = n - 1; k >= 0; k-- )
+    {
+        bool ok = setWindow( Point(pt.x + k*step, pt.y), scaleIdx );
+        normFactors[k] = ok ? varianceNormFactor : 0.f;
+        count += ok;
+    }
+    return count;
+}
 
 void HaarEvaluator::OptFeature::setOffsets( const Feature& _f, int step, int _tofs )
 {
@@ -958,6 +970,114 @@ int CascadeClassifierImpl::runAt( Ptr<FeatureEvaluator>& evaluator, Point pt, in
     }
 }
 
+#if CV_SIMD && CV_SIMD_64F
+// integral image values of the windows p + k*step
+static inline v_int32 loadWindows( const int* p, int step )
+{
+    if( step == 1 )
+        return vx_load(p);
+    v_uint32 a, b;
+    v_load_deinterleave((const unsigned*)p, a, b);
+    return v_reinterpret_as_s32(a);
+}
+
+static inline v_int32 calcSumWindows( const int* ofs, const int* p, int step )
+{
+    return loadWindows(p + ofs[0], step) - loadWindows(p + ofs[1], step) -
+           loadWindows(p + ofs[2], step) + loadWindows(p + ofs[3], step);
+}
+
+static inline v_float32 calcHaarWindows( const HaarEvaluator::OptFeature& f, const int* p, int step )
+{
+    v_float32 val = vx_setall_f32(f.weight[0]) * v_cvt_f32(calcSumWindows(f.ofs[0], p, step)) +
+                    vx_setall_f32(f.weight[1]) * v_cvt_f32(calcSumWindows(f.ofs[1], p, step));
+    if( f.weight[2] != 0.0f )
+        val += vx_setall_f32(f.weight[2]) * v_cvt_f32(calcSumWindows(f.ofs[2], p, step));
+    return val;
+}
+
+// Marks the windows rejected by the stage si, returns the number of remaining windows
+static inline int rejectWindows( const double* sums, float threshold, int si,
+                                 int* results, double* weights, int nlanes )
+{
+    int count = 0;
+    for( int k = 0; k < nlanes; k++ )
+    {
+        if( results[k] != 1 )
+            continue;
+        weights[k] = sums[k];
+        if( sums[k] < threshold )
+            results[k] = -si;
+        else
+            count++;
+    }
+    return count;
+}
+
+void predictOrderedStumpBatch( CascadeClassifierImpl& cascade, Ptr<FeatureEvaluator>& _featureEvaluator,
+                               Point pt, int step, int scaleIdx, int* results, double* weights )
+{
+    CV_INSTRUMENT_REGION()
+
+    const int nlanes = v_float32::nlanes;
+    HaarEvaluator& evaluator = (HaarEvaluator&)*_featureEvaluator;
+    const std::vector<CascadeClassifierImpl::Data::Stage>& stages = cascade.data.stages;
+    const CascadeClassifierImpl::Data::Stump* stumps = &cascade.data.stumps[0];
+    float CV_DECL_ALIGNED(CV_SIMD_WIDTH) normFactors[nlanes];
+    double CV_DECL_ALIGNED(CV_SIMD_WIDTH) sums[nlanes];
+
+    int count = evaluator.setWindows(pt, step, nlanes, scaleIdx, normFactors);
+    for( int k = 0; k < nlanes; k++ )
+        results[k] = normFactors[k] > 0.f ? 1 : -1;
+
+    const int* p = evaluator.getWindowPtr();
+    const HaarEvaluator::OptFeature* features = evaluator.getOptFeatures();
+    v_float32 vnorm = vx_load_aligned(normFactors);
+
+    for( int si = 0; count > 0 && si < (int)stages.size(); si++ )
+    {
+        int ntrees = stages[si].ntrees;
+        v_float64 s0 = vx_setzero_f64(), s1 = vx_setzero_f64();
+        for( int i = 0; i < ntrees; i++ )
+        {
+            const CascadeClassifierImpl::Data::Stump& stump = stumps[i];
+            v_float32 value = calcHaarWindows(features[stump.featureIdx], p, step) * vnorm;
+            v_float32 leaf = v_select(value < vx_setall_f32(stump.threshold),
+                                      vx_setall_f32(stump.left), vx_setall_f32(stump.right));
+            s0 += v_cvt_f64(leaf);
+            s1 += v_cvt_f64_high(leaf);
+        }
+        stumps += ntrees;
+
+        v_store_aligned(sums, s0);
+        v_store_aligned(sums + v_float64::nlanes, s1);
+        count = rejectWindows(sums, stages[si].threshold, si, results, weights, nlanes);
+    }
+}
+#endif
+
+int CascadeClassifierImpl::getBatchSize() const
+{
+#if CV_SIMD && CV_SIMD_64F
+    // LBP features are looked up in the per-stump category subsets, batching them doesn't pay off
+    if( data.maxNodesPerTree == 1 && !data.stumps.empty() && data.featureType == FeatureEvaluator::HAAR )
+        return v_float32::nlanes;
+#endif
+    return 0;
+}
+
+void CascadeClassifierImpl::runAtBatch( Ptr<FeatureEvaluator>& evaluator, Point pt, int step, int scaleIdx,
+                                        int* results, double* weights )
+{
+    CV_DbgAssert( getBatchSize() > 0 && (step == 1 || step == 2) );
+#if CV_SIMD && CV_SIMD_64F
+    predictOrderedStumpBatch( *this, evaluator, pt, step, scaleIdx, results, weights );
+#else
+    CV_UNUSED(evaluator); CV_UNUSED(pt); CV_UNUSED(step); CV_UNUSED(scaleIdx);
+    CV_UNUSED(results); CV_UNUSED(weights);
+#endif
+}
+
 void CascadeClassifierImpl::setMaskGenerator(const Ptr<MaskGenerator>& _maskGenerator)
 {
     maskGenerator=_maskGenerator;
@@ -1000,6 +1120,11 @@ public:
         Ptr<FeatureEvaluator> evaluator = classifier->featureEvaluator->clone();
         double gypWeight = 0.;
         Size origWinSize = classifier->data.origWinSize;
+        const int batchSize = classifier->getBatchSize();
+        AutoBuffer<int> resultsBuf(std::max(batchSize, 1));
+        AutoBuffer<double> weightsBuf(std::max(batchSize, 1));
+        int* results = resultsBuf.data();
+        double* weights = weightsBuf.data();
 
         for( int scaleIdx = 0; scaleIdx < nscales; scaleIdx++ )
         {
@@ -1015,39 +1140,66 @@ public:
 
             for( int y = y0; y < y1; y += yStep )
             {
-                for( int x = 0; x < szw.width; x += yStep )
+                // the window next to the one rejected by the first stage is skipped
+                bool skip = false;
+                int x = 0;
+                if( batchSize > 0 )
                 {
-                    int result = classifier->runAt(evaluator, Point(x, y), scaleIdx, gypWeight);
-                    if( rejectLevels )
+                    for( ; x + (batchSize - 1)*yStep < szw.width; x += batchSize*yStep )
                     {
-                        if( result == 1 )
-                            result = -(int)classifier->data.stages.size();
-                        if( classifier->data.stages.size() + result == 0 )
+                        classifier->runAtBatch(evaluator, Point(x, y), yStep, scaleIdx, results, weights);
+                        for( int k = 0; k < batchSize; k++ )
                         {
-                            mtx->lock();
-                            rectangles->push_back(Rect(cvRound(x*scalingFactor),
-                                                       cvRound(y*scalingFactor),
-                                                       winSize.width, winSize.height));
-                            rejectLevels->push_back(-result);
-                            levelWeights->push_back(gypWeight);
-                            mtx->unlock();
+                            if( skip )
+                                skip = false;
+                            else
+                                skip = addResult(x + k*yStep, y, results[k], weights[k], scalingFactor, winSize);
                         }
                     }
-                    else if( result > 0 )
+                }
+                for( ; x < szw.width; x += yStep )
+                {
+                    if( skip )
                     {
-                        mtx->lock();
-                        rectangles->push_back(Rect(cvRound(x*scalingFactor),
-                                                   cvRound(y*scalingFactor),
-                                                   winSize.width, winSize.height));
-                        mtx->unlock();
+                        skip = false;
+                        continue;
                     }
-                    if( result == 0 )
-                        x += yStep;
+                    int result = classifier->runAt(evaluator, Point(x, y), scaleIdx, gypWeight);
+                    skip = addResult(x, y, result, gypWeight, scalingFactor, winSize);
                 }
             }
         }
     }
 
+    // returns true if the next window is to be skipped
+    bool addResult( int x, int y, int result, double weight, float scalingFactor, Size winSize ) const
+    {
+        if( rejectLevels )
+        {
+            if( result == 1 )
+                result = -(int)classifier->data.stages.size();
+            if( classifier->data.stages.size() + result == 0 )
+            {
+                mtx->lock();
+                rectangles->push_back(Rect(cvRound(x*scalingFactor),
+                                           cvRound(y*scalingFactor),
+                                           winSize.width, winSize.height));
+                rejectLevels->push_back(-result);
+                levelWeights->push_back(weight);
+                mtx->unlock();
+            }
+        }
+        else if( result > 0 )
+        {
+            mtx->lock();
+            rectangles->push_back(Rect(cvRound(x*scalingFactor),
+                                       cvRound(y*scalingFactor),
+                                       winSize.width, winSize.height));
+            mtx->unlock();
+        }
+        return result == 0;
+    }
+
     CascadeClassifierImpl* classifier;
     std::vector<Rect>* rectangles;
     int nscales, nstripes;
@@ -1315,11 +1467,17 @@ void CascadeClassifierImpl::detectMultiScaleNoGrouping( InputArray _image, std::
     _InputArray gray;
 
     if (_image.channels() > 1)
-        cvtColor(_image, grayImage, COLOR_BGR2GRAY);
+    {
+        cvtColor(_image, grayBuf, COLOR_BGR2GRAY);
+        grayImage = grayBuf;
+    }
     else if (_image.isMat())
         grayImage = _image.getMat();
     else
-        _image.copyTo(grayImage);
+    {
+        _image.copyTo(grayBuf);
+        grayImage = grayBuf;
+    }
     gray = grayImage;
 
     if( !featureEvaluator->setImage(gray, scales) )
@@ -157,7 +157,15 @@ protected:
     template<class FEval>
     friend int predictCategoricalStump( CascadeClassifierImpl& cascade, Ptr<FeatureEvaluator> &featureEvaluator, double& weight);
 
+    friend void predictOrderedStumpBatch( CascadeClassifierImpl& cascade, Ptr<FeatureEvaluator> &featureEvaluator,
+                                          Point pt, int step, int scaleIdx, int* results, double* weights );
+
     int runAt( Ptr<FeatureEvaluator>& feval, Point pt, int scaleIdx, double& weight );
+    // Evaluates the windows pt + (k*step, 0), k < getBatchSize(), at once with SIMD;
+    // the results are the same as the ones of runAt
+    void runAtBatch( Ptr<FeatureEvaluator>& feval, Point pt, int step, int scaleIdx,
+                     int* results, double* weights );
+    int getBatchSize() const;
 
     class Data
     {
@@ -217,6 +225,7 @@ protected:
     Ptr<CvHaarClassifierCascade> oldCascade;
 
     Ptr<MaskGenerator> maskGenerator;
+    Mat grayBuf; // reused by the video frames of the same size
     UMat ugrayImage;
     UMat ufacepos, ustages, unodes, uleaves, usubsets;
 #ifdef HAVE_OPENCL
@@ -349,6 +358,11 @@ public:
     virtual int getFeatureType() const CV_OVERRIDE { return FeatureEvaluator::HAAR; }
 
     virtual bool setWindow(Point p, int scaleIdx) CV_OVERRIDE;
+    // Sets the windows p + (k*step, 0), k < n, the normalization factors of the
+    // windows with a low variance are set to 0. Returns the number of remaining windows.
+    int setWindows(Point p, int step, int n, int scaleIdx, float* normFactors);
+    const int* getWindowPtr() const { return pwin; }
+    const OptFeature* getOptFeatures() const { return optfeaturesPtr; }
     Rect getNormRect() const;
     int getSquaresOffset() const;
 
@@ -480,6 +494,9 @@ inline int LBPEvaluator::OptFeature :: calc( const int* p ) const
 
 //----------------------------------------------  predictor functions -------------------------------------
 
+void predictOrderedStumpBatch( CascadeClassifierImpl& cascade, Ptr<FeatureEvaluator> &featureEvaluator,
+                               Point pt, int step, int scaleIdx, int* results, double* weights );
+
 template<class FEval>
 inline int predictOrdered( CascadeClassifierImpl& cascade,
                            Ptr<FeatureEvaluator> &_featureEvaluator, double& sum )
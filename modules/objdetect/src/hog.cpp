@@ -2349,6 +2349,360 @@ void HOGDescriptor::detectMultiScale(InputArray img, std::vector<Rect>& foundLoc
                 padding, scale0, finalThreshold, useMeanshiftGrouping);
 }
 
+//////////////////////////////////////// HOGVideoDetector ////////////////////////////////////////
+
+struct HOGPyramidLevel
+{
+    double scale;
+    Size imgSize;
+    Size gridSize;  // number of block positions in the padded level image
+    int exact;      // the level the block histograms are resampled from, -1 if computed exactly
+    Mat paddedImg;
+    Mat_<float> blocks; // gridSize.height x gridSize.width*blockHistogramSize
+};
+
+struct HOGVideoDetector::Impl
+{
+    HOGDescriptor hog;
+    std::vector<HOGPyramidLevel> levels;
+
+    // parameters of the cached block histograms
+    Size frameSize, padding;
+    int frameType;
+    double scale0;
+    int nlevels;
+};
+
+HOGVideoDetector::HOGVideoDetector(const HOGDescriptor& hog) : p(makePtr<Impl>())
+{
+    CV_Assert( !hog.svmDetector.empty() && hog.checkDetectorSize() );
+    hog.copyTo(p->hog);
+    reset();
+}
+
+HOGVideoDetector::~HOGVideoDetector() {}
+
+void HOGVideoDetector::reset()
+{
+    p->levels.clear();
+    p->frameSize = p->padding = Size();
+    p->frameType = -1;
+    p->scale0 = 0;
+    p->nlevels = 0;
+}
+
+static inline double dotBlockHistogram(const float* vec, const float* svmVec, int n)
+{
+    double s = 0;
+    int k = 0;
+#if CV_SIMD128
+    if( n >= 4 )
+    {
+        v_float32x4 sum = v_load(vec) * v_load(svmVec);
+        for( k = 4; k <= n - 4; k += 4 )
+            sum += v_load(vec + k) * v_load(svmVec + k);
+
+        float partSum[4];
+        v_store(partSum, sum);
+        double t0 = partSum[0] + partSum[1];
+        double t1 = partSum[2] + partSum[3];
+        s = t0 + t1;
+    }
+#endif
+    for( ; k < n; k++ )
+        s += vec[k]*svmVec[k];
+    return s;
+}
+
+// Computes the block histograms of the tiles of the exact levels
+class HOGTileInvoker : public ParallelLoopBody
+{
+public:
+    HOGTileInvoker(const HOGDescriptor& _hog, std::vector<HOGPyramidLevel>& _levels,
+                   const std::vector<std::pair<int, Rect> >& _tiles) :
+        hog(_hog), levels(_levels), tiles(_tiles)
+    {}
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        int blockHistogramSize = (int)getBlockHistogramSize(hog.blockSize, hog.cellSize, hog.nbins);
+        for( int t = range.start; t < range.end; t++ )
+        {
+            HOGPyramidLevel& level = levels[tiles[t].first];
+            Rect r = tiles[t].second;
+
+            // the padded image has one more pixel of border for the gradients
+            Rect roi(r.x*hog.blockStride.width + 1, r.y*hog.blockStride.height + 1,
+                     (r.width - 1)*hog.blockStride.width + hog.blockSize.width,
+                     (r.height - 1)*hog.blockStride.height + hog.blockSize.height);
+            HOGCache cache(&hog, level.paddedImg(roi), Size(), Size(), false, Size());
+
+            for( int y = 0; y < r.height; y++ )
+            {
+                float* dst = level.blocks.ptr<float>(r.y + y) + r.x*blockHistogramSize;
+                for( int x = 0; x < r.width; x++, dst += blockHistogramSize )
+                    cache.getBlock(Point(x*hog.blockStride.width, y*hog.blockStride.height), dst);
+            }
+        }
+    }
+
+private:
+    const HOGDescriptor& hog;
+    std::vector<HOGPyramidLevel>& levels;
+    const std::vector<std::pair<int, Rect> >& tiles;
+};
+
+// Resamples the block histograms of the approximated levels and scans the windows
+class HOGLevelInvoker : public ParallelLoopBody
+{
+public:
+    HOGLevelInvoker(const HOGDescriptor& _hog, std::vector<HOGPyramidLevel>& _levels,
+                    double _hitThreshold, Size _winStride, Size _padding,
+                    std::vector<Rect>* _vec, std::vector<double>* _weights,
+                    std::vector<double>* _scales, Mutex* _mtx) :
+        hog(_hog), levels(_levels), hitThreshold(_hitThreshold), winStride(_winStride),
+        padding(_padding), vec(_vec), weights(_weights), scales(_scales), mtx(_mtx)
+    {}
+
+    // Takes the block of the exact level whose center is nearest to the mapped block center.
+    // Bilinear blending of the normalized histograms smooths out the gradient structure the
+    // SVM responds to and costs noticeably more score than the half-block position error.
+    void resample(HOGPyramidLevel& level) const
+    {
+        const HOGPyramidLevel& src = levels[level.exact];
+        int blockHistogramSize = (int)getBlockHistogramSize(hog.blockSize, hog.cellSize, hog.nbins);
+        double rx = (double)src.imgSize.width/level.imgSize.width;
+        double ry = (double)src.imgSize.height/level.imgSize.height;
+        Size bs = hog.blockStride;
+        double bw = hog.blockSize.width*0.5, bh = hog.blockSize.height*0.5;
+
+        AutoBuffer<int> xofs(level.gridSize.width);
+        for( int x = 0; x < level.gridSize.width; x++ )
+        {
+            int u = cvRound(((x*bs.width - padding.width + bw)*rx + padding.width - bw)/bs.width);
+            xofs[x] = std::min(std::max(u, 0), src.gridSize.width - 1)*blockHistogramSize;
+        }
+
+        level.blocks.create(level.gridSize.height, level.gridSize.width*blockHistogramSize);
+        for( int y = 0; y < level.gridSize.height; y++ )
+        {
+            int v = cvRound(((y*bs.height - padding.height + bh)*ry + padding.height - bh)/bs.height);
+            const float* srow = src.blocks.ptr<float>(std::min(std::max(v, 0), src.gridSize.height - 1));
+            float* dst = level.blocks.ptr<float>(y);
+            for( int x = 0; x < level.gridSize.width; x++, dst += blockHistogramSize )
+                memcpy(dst, srow + xofs[x], blockHistogramSize*sizeof(float));
+        }
+    }
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        int blockHistogramSize = (int)getBlockHistogramSize(hog.blockSize, hog.cellSize, hog.nbins);
+        Size nblocks((hog.winSize.width - hog.blockSize.width)/hog.blockStride.width + 1,
+                     (hog.winSize.height - hog.blockSize.height)/hog.blockStride.height + 1);
+        size_t dsize = hog.getDescriptorSize();
+        double rho = hog.svmDetector.size() > dsize ? hog.svmDetector[dsize] : 0;
+        int xstep = winStride.width/hog.blockStride.width, ystep = winStride.height/hog.blockStride.height;
+        std::vector<Point> locations;
+        std::vector<double> hitsWeights;
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            HOGPyramidLevel& level = levels[i];
+            if( level.exact >= 0 )
+                resample(level);
+
+            Size paddedImgSize(level.imgSize.width + padding.width*2, level.imgSize.height + padding.height*2);
+            int nwindowsX = (paddedImgSize.width - hog.winSize.width)/winStride.width + 1;
+            int nwindowsY = (paddedImgSize.height - hog.winSize.height)/winStride.height + 1;
+            locations.clear();
+            hitsWeights.clear();
+
+            for( int wy = 0; wy < nwindowsY; wy++ )
+                for( int wx = 0; wx < nwindowsX; wx++ )
+                {
+                    double s = rho;
+                    const float* svmVec = &hog.svmDetector[0];
+                    for( int j = 0; j < nblocks.width; j++ )
+                    {
+                        const float* hist = level.blocks.ptr<float>(wy*ystep) + (wx*xstep + j)*blockHistogramSize;
+                        for( int k = 0; k < nblocks.height; k++, svmVec += blockHistogramSize,
+                             hist += level.blocks.step1() )
+                            s += dotBlockHistogram(hist, svmVec, blockHistogramSize);
+                    }
+                    if( s >= hitThreshold )
+                    {
+                        locations.push_back(Point(wx*winStride.width - padding.width,
+                                                  wy*winStride.height - padding.height));
+                        hitsWeights.push_back(s);
+                    }
+                }
+
+            double scale = level.scale;
+            Size scaledWinSize(cvRound(hog.winSize.width*scale), cvRound(hog.winSize.height*scale));
+            AutoLock lock(*mtx);
+            for( size_t j = 0; j < locations.size(); j++ )
+            {
+                vec->push_back(Rect(cvRound(locations[j].x*scale), cvRound(locations[j].y*scale),
+                                    scaledWinSize.width, scaledWinSize.height));
+                weights->push_back(hitsWeights[j]);
+                scales->push_back(scale);
+            }
+        }
+    }
+
+private:
+    const HOGDescriptor& hog;
+    std::vector<HOGPyramidLevel>& levels;
+    double hitThreshold;
+    Size winStride, padding;
+    std::vector<Rect>* vec;
+    std::vector<double>* weights;
+    std::vector<double>* scales;
+    Mutex* mtx;
+};
+
+// Pixels of the frame the tile of blocks r of the level depends on
+static Rect getTileFootprint(const HOGDescriptor& hog, Size imgSize, Size frameSize, Size padding, Rect r)
+{
+    // one more pixel for the gradients
+    int x0 = r.x*hog.blockStride.width - padding.width - 1;
+    int y0 = r.y*hog.blockStride.height - padding.height - 1;
+    int x1 = x0 + (r.width - 1)*hog.blockStride.width + hog.blockSize.width + 2;
+    int y1 = y0 + (r.height - 1)*hog.blockStride.height + hog.blockSize.height + 2;
+
+    // the padding reflects the pixels at the image borders
+    if( x0 < 0 )
+        x1 = std::max(x1, 1 - x0);
+    if( x1 > imgSize.width )
+        x0 = std::min(x0, 2*imgSize.width - x1 - 1);
+    if( y0 < 0 )
+        y1 = std::max(y1, 1 - y0);
+    if( y1 > imgSize.height )
+        y0 = std::min(y0, 2*imgSize.height - y1 - 1);
+
+    // and the interpolation of the level image from the frame
+    double sx = (double)frameSize.width/imgSize.width, sy = (double)frameSize.height/imgSize.height;
+    Rect footprint(Point(cvFloor(x0*sx) - 1, cvFloor(y0*sy) - 1),
+                   Point(cvCeil(x1*sx) + 1, cvCeil(y1*sy) + 1));
+    return footprint & Rect(Point(), frameSize);
+}
+
+void HOGVideoDetector::detectMultiScale(InputArray _frame, std::vector<Rect>& foundLocations,
+                                        std::vector<double>& foundWeights, InputArray _motionMask,
+                                        double hitThreshold, Size winStride, Size padding,
+                                        double scale0, double finalThreshold, bool useMeanshiftGrouping)
+{
+    CV_INSTRUMENT_REGION()
+
+    const HOGDescriptor& hog = p->hog;
+    Mat frame = _frame.getMat(), motionMask = _motionMask.getMat();
+    CV_Assert( frame.type() == CV_8UC1 || frame.type() == CV_8UC3 );
+    CV_Assert( motionMask.empty() || (motionMask.type() == CV_8UC1 && motionMask.size() == frame.size()) );
+
+    if( winStride == Size() )
+        winStride = hog.blockStride;
+    CV_Assert( winStride.width % hog.blockStride.width == 0 && winStride.height % hog.blockStride.height == 0 );
+    padding.width = (int)alignSize(std::max(padding.width, 0), hog.blockStride.width);
+    padding.height = (int)alignSize(std::max(padding.height, 0), hog.blockStride.height);
+
+    // the levels are the ones of HOGDescriptor::detectMultiScale
+    std::vector<double> levelScale;
+    double scale = 1.;
+    Size frameSize = frame.size();
+    int nlevels = 0;
+    for( ; nlevels < hog.nlevels; nlevels++ )
+    {
+        levelScale.push_back(scale);
+        if( cvRound(frameSize.width/scale) < hog.winSize.width ||
+            cvRound(frameSize.height/scale) < hog.winSize.height ||
+            scale0 <= 1 )
+            break;
+        scale *= scale0;
+    }
+    levelScale.resize(std::max(nlevels, 1));
+
+    bool reuse = !motionMask.empty() && frameSize == p->frameSize && frame.type() == p->frameType &&
+                 padding == p->padding && scale0 == p->scale0 && hog.nlevels == p->nlevels;
+    std::vector<HOGPyramidLevel>& levels = p->levels;
+    if( !reuse )
+    {
+        levels.resize(levelScale.size());
+        int exact = 0;
+        for( size_t i = 0; i < levels.size(); i++ )
+        {
+            HOGPyramidLevel& level = levels[i];
+            level.scale = levelScale[i];
+            level.imgSize = Size(cvRound(frameSize.width/level.scale), cvRound(frameSize.height/level.scale));
+            level.gridSize = Size((level.imgSize.width + padding.width*2 - hog.blockSize.width)/hog.blockStride.width + 1,
+                                  (level.imgSize.height + padding.height*2 - hog.blockSize.height)/hog.blockStride.height + 1);
+            if( i == 0 || level.scale >= levelScale[exact]*std::sqrt(2.) - 1e-9 )
+            {
+                exact = (int)i;
+                level.exact = -1;
+            }
+            else
+                level.exact = exact;
+        }
+        p->frameSize = frameSize;
+        p->frameType = frame.type();
+        p->padding = padding;
+        p->scale0 = scale0;
+        p->nlevels = hog.nlevels;
+    }
+
+    Mat motionSum;
+    if( reuse )
+        integral(motionMask != 0, motionSum, CV_32S);
+
+    // the tiles of blocks of the exact levels to compute
+    const int TILE_SIZE = 8;
+    int blockHistogramSize = (int)getBlockHistogramSize(hog.blockSize, hog.cellSize, hog.nbins);
+    std::vector<std::pair<int, Rect> > tiles;
+    for( size_t i = 0; i < levels.size(); i++ )
+    {
+        HOGPyramidLevel& level = levels[i];
+        if( level.exact >= 0 )
+            continue;
+
+        Mat img = frame;
+        if( level.imgSize != frameSize )
+            resize(frame, img, level.imgSize, 0, 0, INTER_LINEAR_EXACT);
+        copyMakeBorder(img, level.paddedImg, padding.height + 1, padding.height + 1,
+                       padding.width + 1, padding.width + 1, BORDER_REFLECT_101);
+        level.blocks.create(level.gridSize.height, level.gridSize.width*blockHistogramSize);
+
+        for( int y = 0; y < level.gridSize.height; y += TILE_SIZE )
+            for( int x = 0; x < level.gridSize.width; x += TILE_SIZE )
+            {
+                Rect r(x, y, std::min(TILE_SIZE, level.gridSize.width - x),
+                       std::min(TILE_SIZE, level.gridSize.height - y));
+                if( reuse )
+                {
+                    Rect f = getTileFootprint(hog, level.imgSize, frameSize, padding, r);
+                    if( f.empty() || motionSum.at<int>(f.y, f.x) - motionSum.at<int>(f.y, f.x + f.width) -
+                        motionSum.at<int>(f.y + f.height, f.x) + motionSum.at<int>(f.y + f.height, f.x + f.width) == 0 )
+                        continue;
+                }
+                tiles.push_back(std::make_pair((int)i, r));
+            }
+    }
+    parallel_for_(Range(0, (int)tiles.size()), HOGTileInvoker(hog, levels, tiles));
+
+    std::vector<double> foundScales;
+    Mutex mtx;
+    foundLocations.clear();
+    foundWeights.clear();
+    parallel_for_(Range(0, (int)levels.size()),
+                  HOGLevelInvoker(hog, levels, hitThreshold, winStride, padding,
+                                  &foundLocations, &foundWeights, &foundScales, &mtx));
+
+    if( useMeanshiftGrouping )
+        groupRectangles_meanshift(foundLocations, foundWeights, foundScales, finalThreshold, hog.winSize);
+    else
+        hog.groupRectangles(foundLocations, foundWeights, (int)finalThreshold, 0.2);
+    clipObjects(frameSize, foundLocations, 0, &foundWeights);
+}
+
 template<typename _ClsName> struct RTTIImpl
 {
 public:
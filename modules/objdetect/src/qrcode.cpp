@@ -24,6 +24,7 @@ public:
     void binarization();
     bool localization();
     bool transformation();
+    bool computeCorners(const Mat& bin, const vector<Point2f>& centers);
     Mat getBinBarcode() { return bin_barcode; }
     Mat getStraightBarcode() { return straight_barcode; }
     vector<Point2f> getTransformationPoints() { return transformation_points; }
@@ -741,6 +742,452 @@ bool QRDecode::transformation()
     return true;
 }
 
+bool QRDecode::computeCorners(const Mat& bin, const vector<Point2f>& centers)
+{
+    bin_barcode = bin;
+    localization_points = centers;
+    coeff_expansion = 1.0;
+    fixationPoints(localization_points);
+    return computeTransformationPoints();
+}
+
+// ----------------------------- Several codes ----------------------------- //
+
+struct QRFinderPattern
+{
+    Point2f center;
+    float module_size;
+    int count;
+    int hits;
+};
+
+// checks the lengths of the black-white-black-white-black runs against the 1:1:3:1:1 proportion,
+// eps bounds the sum of the deviations of the run fractions as in QRDecode::searchHorizontalLines,
+// less the one pixel each run may lose or gain by the sampling of the small modules
+static bool checkFinderRuns(const int runs[5], double eps, float &module_size)
+{
+    int total = runs[0] + runs[1] + runs[2] + runs[3] + runs[4];
+    if (total < 7) { return false; }
+    float module = total / 7.f, max_deviation = module * 0.5f + 1.f;
+    if (std::abs(runs[0] - module) >= max_deviation ||
+        std::abs(runs[1] - module) >= max_deviation ||
+        std::abs(runs[2] - module * 3) >= max_deviation * 3 ||
+        std::abs(runs[3] - module) >= max_deviation ||
+        std::abs(runs[4] - module) >= max_deviation) { return false; }
+    double weight = 0.0;
+    for (int i = 0; i < 5; i++)
+        weight += std::max(std::abs(runs[i] - (i == 2 ? 3.0 : 1.0) * module) - 1.0, 0.0) / total;
+    if (weight >= eps) { return false; }
+    module_size = module;
+    return true;
+}
+
+// measures the finder pattern runs that cross the black pixel c along dir,
+// offset is the position of the middle of the center run relative to c
+static bool crossCheckFinder(const Mat &bin, Point c, Point dir, int max_run, double eps,
+                             float &offset, float &module_size)
+{
+    Rect bounds(0, 0, bin.cols, bin.rows);
+    if (!bounds.contains(c) || bin.at<uint8_t>(c) != 0) { return false; }
+
+    int runs[5] = { 0, 0, 0, 0, 0 };
+    int i = 2;
+    Point pnt = c;
+    for (; bounds.contains(pnt); pnt -= dir)
+    {
+        if ((bin.at<uint8_t>(pnt) == 0) != (i % 2 == 0) && --i < 0) { break; }
+        if (++runs[i] > max_run) { return false; }
+    }
+    if (i >= 0) { return false; }
+    int back_center = runs[2];
+
+    i = 2;
+    for (pnt = c + dir; bounds.contains(pnt); pnt += dir)
+    {
+        if ((bin.at<uint8_t>(pnt) == 0) != (i % 2 == 0) && ++i > 4) { break; }
+        if (++runs[i] > max_run) { return false; }
+    }
+    if (i <= 4) { return false; }
+
+    offset = (runs[2] - 2 * back_center + 1) / 2.f;
+    return checkFinderRuns(runs, eps, module_size);
+}
+
+// scans the rows of the binary image for the finder pattern proportion
+// and confirms the hits with a vertical cross check
+class QRFinderSearchInvoker : public ParallelLoopBody
+{
+public:
+    QRFinderSearchInvoker(const Mat &bin_, double eps_x_, double eps_y_,
+                          vector<QRFinderPattern> &hits_, Mutex &mtx_)
+        : bin(bin_), eps_x(eps_x_), eps_y(eps_y_), hits(hits_), mtx(mtx_) {}
+
+    void operator()(const Range &range) const CV_OVERRIDE
+    {
+        vector<QRFinderPattern> local_hits;
+        vector<int> starts;
+        for (int y = range.start; y < range.end; y++)
+        {
+            const uint8_t *row = bin.ptr<uint8_t>(y);
+            starts.clear();
+            for (int x = 0; x < bin.cols; x++)
+            {
+                if (x == 0 || row[x] != row[x - 1]) { starts.push_back(x); }
+            }
+            starts.push_back(bin.cols);
+
+            int first_black = row[0] == 0 ? 0 : 1;
+            for (int i = first_black; i + 5 < (int)starts.size(); i += 2)
+            {
+                int runs[5];
+                for (int k = 0; k < 5; k++) { runs[k] = starts[i + k + 1] - starts[i + k]; }
+                float module_size, offset, vertical_module_size;
+                if (!checkFinderRuns(runs, eps_x, module_size)) { continue; }
+
+                float cx = starts[i + 2] + runs[2] * 0.5f;
+                if (!crossCheckFinder(bin, Point(cvFloor(cx), y), Point(0, 1),
+                                      cvCeil(module_size * 4) + 2, eps_y, offset, vertical_module_size)) { continue; }
+
+                QRFinderPattern hit;
+                hit.center = Point2f(cx, y + offset);
+                hit.module_size = (module_size + vertical_module_size) * 0.5f;
+                hit.count = 1;
+                hit.hits = 1;
+                local_hits.push_back(hit);
+            }
+        }
+        AutoLock lock(mtx);
+        hits.insert(hits.end(), local_hits.begin(), local_hits.end());
+    }
+
+private:
+    const Mat &bin;
+    double eps_x, eps_y;
+    vector<QRFinderPattern> &hits;
+    Mutex &mtx;
+};
+
+static bool lessFinderPattern(const QRFinderPattern &a, const QRFinderPattern &b)
+{
+    return a.center.y != b.center.y ? a.center.y < b.center.y : a.center.x < b.center.x;
+}
+
+// merges the hits belonging to the same finder pattern
+static vector<QRFinderPattern> clusterFinderPatterns(vector<QRFinderPattern> &hits)
+{
+    std::sort(hits.begin(), hits.end(), lessFinderPattern);
+    vector<QRFinderPattern> patterns;
+    for (size_t i = 0; i < hits.size(); i++)
+    {
+        const QRFinderPattern &hit = hits[i];
+        size_t j = 0;
+        for (; j < patterns.size(); j++)
+        {
+            QRFinderPattern &pattern = patterns[j];
+            if (norm(pattern.center - hit.center) < pattern.module_size * 2 &&
+                std::abs(pattern.module_size - hit.module_size) < pattern.module_size * 0.5f)
+            {
+                float w = 1.f / (pattern.count + 1);
+                pattern.center += (hit.center - pattern.center) * w;
+                pattern.module_size += (hit.module_size - pattern.module_size) * w;
+                pattern.count++;
+                pattern.hits += hit.hits;
+                break;
+            }
+        }
+        if (j == patterns.size()) { patterns.push_back(hit); }
+    }
+    return patterns;
+}
+
+// refines the finder pattern candidates of the coarse pass in the full resolution image
+class QRFinderVerifyInvoker : public ParallelLoopBody
+{
+public:
+    QRFinderVerifyInvoker(const Mat &bin_, double eps_, vector<QRFinderPattern> &patterns_)
+        : bin(bin_), eps(eps_), patterns(patterns_) {}
+
+    void operator()(const Range &range) const CV_OVERRIDE
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            QRFinderPattern &pattern = patterns[i];
+            pattern.count = 0;
+            int max_run = cvCeil(pattern.module_size * 4) + 2;
+            Point2f c = pattern.center;
+            float offset, horizontal_module_size, vertical_module_size, diagonal_module_size[2];
+            if (!crossCheckFinder(bin, Point(cvFloor(c.x), cvFloor(c.y)), Point(1, 0), max_run, eps,
+                                  offset, horizontal_module_size)) { continue; }
+            c.x = cvFloor(c.x) + offset;
+            if (!crossCheckFinder(bin, Point(cvFloor(c.x), cvFloor(c.y)), Point(0, 1), max_run, eps,
+                                  offset, vertical_module_size)) { continue; }
+            c.y = cvFloor(c.y) + offset;
+            if (!crossCheckFinder(bin, Point(cvFloor(c.x), cvFloor(c.y)), Point(1, 0), max_run, eps,
+                                  offset, horizontal_module_size)) { continue; }
+            c.x = cvFloor(c.x) + offset;
+            if (!crossCheckFinder(bin, Point(cvFloor(c.x), cvFloor(c.y)), Point(1, 1), max_run, eps,
+                                  offset, diagonal_module_size[0]) ||
+                !crossCheckFinder(bin, Point(cvFloor(c.x), cvFloor(c.y)), Point(1, -1), max_run, eps,
+                                  offset, diagonal_module_size[1])) { continue; }
+
+            // the runs along the axes are longer than 7 modules for the rotated codes, the runs
+            // along the diagonals are longer for the codes that are not rotated
+            pattern.center = c;
+            pattern.module_size = std::min((horizontal_module_size + vertical_module_size) * 0.5f,
+                                           std::min(diagonal_module_size[0], diagonal_module_size[1]) *
+                                           (float)std::sqrt(2.));
+            pattern.count = 1;
+        }
+    }
+
+private:
+    const Mat &bin;
+    double eps;
+    vector<QRFinderPattern> &patterns;
+};
+
+struct QRFinderTriple
+{
+    int corner, first, second;
+    double score;
+};
+
+static bool moreFinderHits(const QRFinderPattern &a, const QRFinderPattern &b)
+{
+    return a.hits > b.hits;
+}
+
+// at most this many finder patterns, the ones confirmed by the most rows, are grouped into codes,
+// the side tables of the grouping are quadratic in the number of patterns
+static const int QR_MAX_FINDER_PATTERNS = 256;
+
+static bool lessFinderTriple(const QRFinderTriple &a, const QRFinderTriple &b)
+{
+    return a.score < b.score;
+}
+
+// counts the modules of the timing pattern that runs between the finder patterns a and b
+// on the side of c, and compares it with the distance between a and b
+static bool checkTimingPattern(const Mat &bin, const QRFinderPattern &a, const QRFinderPattern &b,
+                               const QRFinderPattern &c)
+{
+    float module_size = (a.module_size + b.module_size) * 0.5f;
+    Point2f ab = b.center - a.center, ac = c.center - a.center;
+    float len = (float)norm(ab);
+    Point2f dir = ab * (1.f / len), shift = ac * (module_size * 3 / (float)norm(ac));
+    Point2f start = a.center + shift + dir * (module_size * 4.5f);
+    Point2f finish = b.center + shift - dir * (module_size * 4.5f);
+    int expected = cvRound(len / module_size) - 9;
+    if (expected < 3) { return false; }
+
+    LineIterator line_iter(bin, Point(cvRound(start.x), cvRound(start.y)),
+                           Point(cvRound(finish.x), cvRound(finish.y)));
+    int runs = 0;
+    uint8_t prev = 0;
+    for (int i = 0; i < line_iter.count; i++, ++line_iter)
+    {
+        uint8_t value = **line_iter;
+        if (i == 0 || value != prev) { runs++; }
+        prev = value;
+    }
+    return runs >= expected * 0.75 && runs <= expected * 1.25 + 1;
+}
+
+// groups the finder patterns by three into right isosceles triangles of similar module sizes,
+// with the timing patterns between them
+static vector<QRFinderTriple> groupFinderPatterns(const Mat &bin, vector<QRFinderPattern> &patterns)
+{
+    if ((int)patterns.size() > QR_MAX_FINDER_PATTERNS)
+    {
+        std::stable_sort(patterns.begin(), patterns.end(), moreFinderHits);
+        patterns.resize(QR_MAX_FINDER_PATTERNS);
+    }
+    int count = (int)patterns.size();
+
+    // the patterns of similar module sizes at a distance that fits a code side,
+    // version 1 has the centers 14 modules apart, version 40 has them 170 modules apart
+    vector<Point2f> sides(count * count);
+    vector<float> lengths(count * count, 0.f);
+    for (int a = 0; a < count; a++)
+    {
+        for (int b = 0; b < count; b++)
+        {
+            float module_a = patterns[a].module_size, module_b = patterns[b].module_size;
+            if (b == a || std::max(module_a, module_b) > std::min(module_a, module_b) * 1.5f) { continue; }
+            Point2f side = patterns[b].center - patterns[a].center;
+            float len = (float)norm(side), mean_module = (module_a + module_b) * 0.5f;
+            if (len < mean_module * 10 || len > mean_module * 180) { continue; }
+            sides[a * count + b] = side;
+            lengths[a * count + b] = len;
+        }
+    }
+
+    vector<QRFinderTriple> triples;
+    for (int a = 0; a < count; a++)
+    {
+        const Point2f *side = &sides[a * count];
+        const float *len = &lengths[a * count];
+        for (int b = 0; b < count; b++)
+        {
+            if (len[b] == 0.f) { continue; }
+            for (int c = b + 1; c < count; c++)
+            {
+                if (len[c] == 0.f || lengths[b * count + c] == 0.f) { continue; }
+                float min_len = std::min(len[b], len[c]), max_len = std::max(len[b], len[c]);
+                if (max_len > min_len * 1.3f) { continue; }
+                float cos_angle = side[b].dot(side[c]) / (len[b] * len[c]);
+                if (std::abs(cos_angle) > 0.3f) { continue; }
+
+                QRFinderTriple triple;
+                triple.corner = a; triple.first = b; triple.second = c;
+                triple.score = (max_len - min_len) / max_len + std::abs(cos_angle);
+                triples.push_back(triple);
+            }
+        }
+    }
+    std::stable_sort(triples.begin(), triples.end(), lessFinderTriple);
+
+    vector<QRFinderTriple> result;
+    vector<uchar> used(count, 0);
+    for (size_t i = 0; i < triples.size(); i++)
+    {
+        const QRFinderTriple &triple = triples[i];
+        if (used[triple.corner] || used[triple.first] || used[triple.second]) { continue; }
+        const QRFinderPattern &corner = patterns[triple.corner];
+        if (!checkTimingPattern(bin, corner, patterns[triple.first], patterns[triple.second]) ||
+            !checkTimingPattern(bin, corner, patterns[triple.second], patterns[triple.first])) { continue; }
+        used[triple.corner] = used[triple.first] = used[triple.second] = 1;
+        result.push_back(triple);
+    }
+    return result;
+}
+
+// computes the quadrangle of each code in the neighborhood of its finder patterns
+class QRCornersInvoker : public ParallelLoopBody
+{
+public:
+    QRCornersInvoker(const Mat &bin_, const vector<QRFinderPattern> &patterns_,
+                     const vector<QRFinderTriple> &triples_, vector<vector<Point2f> > &corners_)
+        : bin(bin_), patterns(patterns_), triples(triples_), corners(corners_) {}
+
+    void operator()(const Range &range) const CV_OVERRIDE
+    {
+        for (int i = range.start; i < range.end; i++)
+        {
+            const QRFinderTriple &triple = triples[i];
+            vector<Point2f> centers(3);
+            centers[0] = patterns[triple.corner].center;
+            centers[1] = patterns[triple.first].center;
+            centers[2] = patterns[triple.second].center;
+            float module_size = (patterns[triple.corner].module_size + patterns[triple.first].module_size +
+                                 patterns[triple.second].module_size) / 3.f;
+
+            vector<Point2f> bounds(centers);
+            bounds.push_back(centers[1] + centers[2] - centers[0]);
+            Rect roi = boundingRect(bounds);
+            int margin = cvCeil(module_size * 6);
+            roi.x -= margin; roi.y -= margin;
+            roi.width += margin * 2; roi.height += margin * 2;
+            roi &= Rect(0, 0, bin.cols, bin.rows);
+
+            Point2f offset((float)roi.x, (float)roi.y);
+            for (size_t j = 0; j < centers.size(); j++) { centers[j] -= offset; }
+
+            QRDecode qrdec;
+            if (!qrdec.computeCorners(bin(roi), centers)) { continue; }
+            vector<Point2f> pnts = qrdec.getTransformationPoints();
+            for (size_t j = 0; j < pnts.size(); j++) { pnts[j] += offset; }
+            corners[i] = pnts;
+        }
+    }
+
+private:
+    const Mat &bin;
+    const vector<QRFinderPattern> &patterns;
+    const vector<QRFinderTriple> &triples;
+    vector<vector<Point2f> > &corners;
+};
+
+static bool lessQuadrangle(const vector<Point2f> &a, const vector<Point2f> &b)
+{
+    return a[1].y != b[1].y ? a[1].y < b[1].y : a[1].x < b[1].x;
+}
+
+// images with the smaller side of at least this size are searched at the half resolution first
+static const int QR_COARSE_MIN_SIDE = 960;
+
+static void detectQRCodes(const Mat &img, double eps_x, double eps_y, vector<Point2f> &result)
+{
+    CV_INSTRUMENT_REGION();
+
+    result.clear();
+    // no smoothing, it merges the one module wide runs of small codes with their neighbors
+    Mat coarse, coarse_bin, bin;
+    int scale = std::min(img.cols, img.rows) >= QR_COARSE_MIN_SIDE ? 2 : 1;
+    if (scale > 1)
+        resize(img, coarse, Size(img.cols / scale, img.rows / scale), 0, 0, INTER_AREA);
+    else
+        coarse = img;
+    double thresh = threshold(coarse, coarse_bin, 0, 255, THRESH_BINARY + THRESH_OTSU);
+
+    vector<QRFinderPattern> hits;
+    Mutex mtx;
+    parallel_for_(Range(0, coarse_bin.rows), QRFinderSearchInvoker(coarse_bin, eps_x, eps_y, hits, mtx),
+                  coarse_bin.total() / (double)(1 << 16));
+    vector<QRFinderPattern> patterns = clusterFinderPatterns(hits);
+
+    if (scale > 1)
+    {
+        threshold(img, bin, thresh, 255, THRESH_BINARY);
+        for (size_t i = 0; i < patterns.size(); i++)
+        {
+            patterns[i].center = (patterns[i].center + Point2f(0.5f, 0.5f)) * (float)scale - Point2f(0.5f, 0.5f);
+            patterns[i].module_size *= scale;
+        }
+    }
+    else
+        bin = coarse_bin;
+
+    parallel_for_(Range(0, (int)patterns.size()), QRFinderVerifyInvoker(bin, eps_y, patterns));
+    vector<QRFinderPattern> verified;
+    for (size_t i = 0; i < patterns.size(); i++)
+    {
+        if (patterns[i].count > 0) { verified.push_back(patterns[i]); }
+    }
+    patterns = clusterFinderPatterns(verified);
+
+    vector<QRFinderTriple> triples = groupFinderPatterns(bin, patterns);
+    vector<vector<Point2f> > corners(triples.size());
+    parallel_for_(Range(0, (int)triples.size()), QRCornersInvoker(bin, patterns, triples, corners));
+
+    vector<vector<Point2f> > found;
+    for (size_t i = 0; i < corners.size(); i++)
+    {
+        if (corners[i].size() == 4) { found.push_back(corners[i]); }
+    }
+    std::sort(found.begin(), found.end(), lessQuadrangle);
+    for (size_t i = 0; i < found.size(); i++)
+        result.insert(result.end(), found[i].begin(), found[i].end());
+}
+
+class QRBatchInvoker : public ParallelLoopBody
+{
+public:
+    QRBatchInvoker(const vector<Mat> &imgs_, double eps_x_, double eps_y_, vector<vector<Point2f> > &points_)
+        : imgs(imgs_), eps_x(eps_x_), eps_y(eps_y_), points(points_) {}
+
+    void operator()(const Range &range) const CV_OVERRIDE
+    {
+        for (int i = range.start; i < range.end; i++)
+            detectQRCodes(imgs[i], eps_x, eps_y, points[i]);
+    }
+
+private:
+    const vector<Mat> &imgs;
+    double eps_x, eps_y;
+    vector<vector<Point2f> > &points;
+};
+
 
 struct QRCodeDetector::Impl
 {
@@ -772,6 +1219,33 @@ bool QRCodeDetector::detect(InputArray in, OutputArray points) const
     return true;
 }
 
+bool QRCodeDetector::detectMulti(InputArray img, OutputArray points) const
+{
+    Mat inarr = img.getMat();
+    CV_Assert(!inarr.empty());
+    CV_Assert(inarr.type() == CV_8UC1);
+    vector<Point2f> pnts2f;
+    detectQRCodes(inarr, p->epsX, p->epsY, pnts2f);
+    if (pnts2f.empty()) { points.release(); return false; }
+    Mat(pnts2f).convertTo(points, points.fixedType() ? points.type() : CV_32FC2);
+    return true;
+}
+
+void QRCodeDetector::detectMultiBatch(InputArrayOfArrays imgs, std::vector<std::vector<Point2f> >& points) const
+{
+    CV_INSTRUMENT_REGION();
+
+    vector<Mat> images;
+    imgs.getMatVector(images);
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        CV_Assert(!images[i].empty());
+        CV_Assert(images[i].type() == CV_8UC1);
+    }
+    points.resize(images.size());
+    parallel_for_(Range(0, (int)images.size()), QRBatchInvoker(images, p->epsX, p->epsY, points));
+}
+
 CV_EXPORTS bool detectQRCode(InputArray in, std::vector<Point> &points, double eps_x, double eps_y)
 {
     QRCodeDetector qrdetector;
@@ -1373,4 +1373,149 @@ TEST(Objdetect_CascadeDetector, small_img)
     }
 }
 
+static Mat makeHOGTestFrame(Size sz, int seed)
+{
+    RNG rng(seed);
+    Mat frame(sz, CV_8UC3);
+    rng.fill(frame, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    GaussianBlur(frame, frame, Size(0, 0), 6);
+    for (int i = 0; i < 40; i++)
+    {
+        Point c(rng.uniform(0, sz.width), rng.uniform(0, sz.height));
+        ellipse(frame, c, Size(rng.uniform(4, 30), rng.uniform(10, 60)), rng.uniform(0, 180), 0, 360,
+                Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256)), FILLED);
+    }
+    return frame;
+}
+
+struct HOGHitLess
+{
+    bool operator()(const pair<Rect, double>& a, const pair<Rect, double>& b) const
+    {
+        const Rect &r1 = a.first, &r2 = b.first;
+        return r1.y != r2.y ? r1.y < r2.y : r1.x != r2.x ? r1.x < r2.x : r1.width < r2.width;
+    }
+};
+
+// the hits sorted by position, of all the levels or of the windows of the given size only
+static vector<pair<Rect, double> > getHOGHits(const vector<Rect>& rects, const vector<double>& weights,
+                                              Size winSize = Size())
+{
+    vector<pair<Rect, double> > hits;
+    for (size_t i = 0; i < rects.size(); i++)
+        if (winSize == Size() || rects[i].size() == winSize)
+            hits.push_back(make_pair(rects[i], weights[i]));
+    std::sort(hits.begin(), hits.end(), HOGHitLess());
+    return hits;
+}
+
+TEST(Objdetect_HOGVideoDetector, exact_level_and_motion)
+{
+    HOGDescriptor hog;
+    hog.setSVMDetector(HOGDescriptor::getDefaultPeopleDetector());
+    Mat frame = makeHOGTestFrame(Size(320, 240), 1);
+    const double hitThreshold = -2;
+
+    vector<Rect> expected, rects;
+    vector<double> expectedWeights, weights;
+    hog.detectMultiScale(frame, expected, expectedWeights, hitThreshold, Size(8, 8), Size(16, 16), 1.1, 0);
+    HOGVideoDetector detector(hog);
+    detector.detectMultiScale(frame, rects, weights, noArray(), hitThreshold, Size(8, 8), Size(16, 16), 1.1, 0);
+
+    vector<pair<Rect, double> > expectedHits = getHOGHits(expected, expectedWeights, hog.winSize);
+    vector<pair<Rect, double> > hits = getHOGHits(rects, weights, hog.winSize);
+    ASSERT_FALSE(expectedHits.empty());
+    ASSERT_EQ(expectedHits.size(), hits.size());
+    for (size_t i = 0; i < hits.size(); i++)
+    {
+        EXPECT_EQ(expectedHits[i].first, hits[i].first);
+        EXPECT_NEAR(expectedHits[i].second, hits[i].second, 1e-4);
+    }
+
+    // a moving object, only its neighborhood is computed again
+    Mat frame2 = frame.clone(), motion = Mat::zeros(frame.size(), CV_8U);
+    Rect moved(200, 60, 30, 80);
+    frame2(moved).setTo(Scalar(40, 200, 90));
+    motion(moved).setTo(255);
+
+    vector<Rect> rects2, fresh;
+    vector<double> weights2, freshWeights;
+    detector.detectMultiScale(frame2, rects2, weights2, motion, hitThreshold, Size(8, 8), Size(16, 16), 1.1, 0);
+    HOGVideoDetector(hog).detectMultiScale(frame2, fresh, freshWeights, noArray(), hitThreshold,
+                                           Size(8, 8), Size(16, 16), 1.1, 0);
+    EXPECT_TRUE(getHOGHits(fresh, freshWeights) == getHOGHits(rects2, weights2));
+}
+
+TEST(Objdetect_HOGVideoDetector, approximated_levels)
+{
+    Mat img = imread(cvtest::findDataFile("cascadeandhog/images/karen-and-rob.png"));
+    ASSERT_FALSE(img.empty());
+
+    HOGDescriptor hog;
+    hog.setSVMDetector(HOGDescriptor::getDefaultPeopleDetector());
+    vector<Rect> expected, found;
+    vector<double> expectedWeights, weights;
+    hog.detectMultiScale(img, expected, expectedWeights, 0, Size(8, 8), Size(32, 32), 1.05, 2);
+    // raw hits, the approximated levels give fewer neighbors to group
+    HOGVideoDetector(hog).detectMultiScale(img, found, weights, noArray(), 0, Size(8, 8), Size(32, 32), 1.05, 0);
+
+    // each object is found by the approximated pyramid too
+    ASSERT_FALSE(expected.empty());
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        double best = 0;
+        for (size_t j = 0; j < found.size(); j++)
+            best = std::max(best, (double)(expected[i] & found[j]).area()/(expected[i] | found[j]).area());
+        EXPECT_GT(best, 0.5) << expected[i];
+    }
+}
+
+typedef testing::TestWithParam<string> Objdetect_CascadeDetector_Frames;
+
+TEST_P(Objdetect_CascadeDetector_Frames, reuse)
+{
+    const string cascadePath = findDataFile("cascadeandhog/cascades/" + GetParam(), false);
+    Mat frame0 = imread(findDataFile("cascadeandhog/images/karen-and-rob.png", false));
+    ASSERT_FALSE(frame0.empty());
+
+    // a sequence of frames of the same size, and a frame of another size
+    vector<Mat> frames;
+    frames.push_back(frame0);
+    Mat frame;
+    flip(frame0, frame, 1);
+    frames.push_back(frame);
+    warpAffine(frame0, frame, getRotationMatrix2D(Point2f(frame0.cols*0.5f, frame0.rows*0.5f), 3, 1.05), frame0.size());
+    frames.push_back(frame);
+    resize(frame0, frame, Size(), 0.7, 0.7);
+    frames.push_back(frame);
+    frames.push_back(frame0);
+
+    CascadeClassifier video(cascadePath);
+    ASSERT_FALSE(video.empty());
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        SCOPED_TRACE(cv::format("frame=%d", (int)i));
+        CascadeClassifier single(cascadePath);
+        vector<Rect> expected, objects;
+        single.detectMultiScale(frames[i], expected, 1.1, 3, 0, Size(20, 20));
+        video.detectMultiScale(frames[i], objects, 1.1, 3, 0, Size(20, 20));
+        EXPECT_EQ(expected, objects);
+
+        vector<int> expectedLevels, levels;
+        vector<double> expectedWeights, weights;
+        single.detectMultiScale(frames[i], expected, expectedLevels, expectedWeights, 1.2, 3, 0, Size(), Size(), true);
+        video.detectMultiScale(frames[i], objects, levels, weights, 1.2, 3, 0, Size(), Size(), true);
+        EXPECT_EQ(expected, objects);
+        EXPECT_EQ(expectedLevels, levels);
+        EXPECT_EQ(expectedWeights, weights);
+        if (i == 0)
+        {
+            EXPECT_FALSE(expected.empty());
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Objdetect_CascadeDetector_Frames,
+    testing::Values("haarcascade_frontalface_alt.xml", "lbpcascade_frontalface.xml"));
+
 }} // namespace
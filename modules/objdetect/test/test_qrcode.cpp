@@ -108,7 +108,179 @@ TEST(Objdetect_QRCode_basic, not_found_qrcode)
     EXPECT_FALSE(detectQRCode(zero_image, corners));
 }
 
+// draws a code with random data modules on the white image, returns its corners
+static std::vector<Point2f> drawSyntheticQRCode(Mat &img, Point tl, int version, int module_size, RNG &rng)
+{
+    int n = 17 + 4 * version;
+    Mat code(n, n, CV_8UC1);
+    rng.fill(code, RNG::UNIFORM, 0, 2);
+    code *= 255;
+    for (int i = 8; i < n - 8; i++)
+    {
+        code.at<uchar>(6, i) = code.at<uchar>(i, 6) = i % 2 ? 255 : 0;
+    }
+    Point finders[] = { Point(0, 0), Point(n - 7, 0), Point(0, n - 7) };
+    for (int i = 0; i < 3; i++)
+    {
+        Rect finder(finders[i], Size(7, 7));
+        code(Rect(finder.x - 1, finder.y - 1, 9, 9) & Rect(0, 0, n, n)).setTo(255);
+        code(finder).setTo(0);
+        code(Rect(finder.x + 1, finder.y + 1, 5, 5)).setTo(255);
+        code(Rect(finder.x + 2, finder.y + 2, 3, 3)).setTo(0);
+    }
+    Mat scaled;
+    resize(code, scaled, Size(n * module_size, n * module_size), 0, 0, INTER_NEAREST);
+    scaled.copyTo(img(Rect(tl, scaled.size())));
+
+    std::vector<Point2f> corners;
+    float side = (float)scaled.cols;
+    corners.push_back(Point2f((float)tl.x, (float)tl.y));
+    corners.push_back(Point2f(tl.x + side, (float)tl.y));
+    corners.push_back(Point2f(tl.x + side, tl.y + side));
+    corners.push_back(Point2f((float)tl.x, tl.y + side));
+    return corners;
+}
+
+// an image with a grid of codes of random versions and module sizes
+static Mat makeSyntheticQRCodes(Size size, int cols, int rows, int min_module_size, int max_module_size, int seed,
+                                std::vector<std::vector<Point2f> > &codes)
+{
+    RNG rng(seed);
+    Mat img(size, CV_8UC1, Scalar::all(255));
+    Size cell(size.width / cols, size.height / rows);
+    codes.clear();
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < cols; x++)
+        {
+            int module_size = rng.uniform(min_module_size, max_module_size + 1);
+            int max_version = std::min((cell.width - 8 * module_size) / module_size,
+                                       (cell.height - 8 * module_size) / module_size);
+            max_version = std::min((max_version - 17) / 4, 10);
+            if (max_version < 1) { continue; }
+            int version = rng.uniform(1, max_version + 1);
+            int side = (17 + 4 * version) * module_size;
+            Point tl(x * cell.width + rng.uniform(4 * module_size, cell.width - side - 4 * module_size + 1),
+                     y * cell.height + rng.uniform(4 * module_size, cell.height - side - 4 * module_size + 1));
+            codes.push_back(drawSyntheticQRCode(img, tl, version, module_size, rng));
+        }
+    }
+    return img;
+}
+
+// checks that each code is found once with the corners close to the expected ones
+static void checkQRCodes(const std::vector<std::vector<Point2f> > &codes, const std::vector<Point2f> &corners,
+                         float max_error)
+{
+    ASSERT_EQ(0u, corners.size() % 4);
+    EXPECT_EQ(codes.size(), corners.size() / 4);
+    for (size_t i = 0; i < codes.size(); i++)
+    {
+        int matches = 0;
+        for (size_t j = 0; j + 4 <= corners.size(); j += 4)
+        {
+            float error = 0;
+            for (size_t k = 0; k < 4; k++)
+            {
+                float min_dist = FLT_MAX;
+                for (size_t l = 0; l < 4; l++)
+                    min_dist = std::min(min_dist, (float)cv::norm(codes[i][k] - corners[j + l]));
+                error = std::max(error, min_dist);
+            }
+            if (error <= max_error) { matches++; }
+        }
+        EXPECT_EQ(1, matches) << "code " << i << ": " << codes[i][0];
+    }
+}
+
+TEST(Objdetect_QRCode_multi, synthetic)
+{
+    std::vector<std::vector<Point2f> > codes;
+    Mat img = makeSyntheticQRCodes(Size(800, 600), 4, 3, 2, 4, 1, codes);
+    ASSERT_FALSE(codes.empty());
+
+    QRCodeDetector detector;
+    std::vector<Point2f> corners;
+    EXPECT_TRUE(detector.detectMulti(img, corners));
+    checkQRCodes(codes, corners, 3);
 
+    EXPECT_FALSE(detector.detectMulti(Mat::zeros(256, 256, CV_8UC1), corners));
+    EXPECT_TRUE(corners.empty());
+}
+
+TEST(Objdetect_QRCode_multi, eps)
+{
+    std::vector<std::vector<Point2f> > codes;
+    Mat img = makeSyntheticQRCodes(Size(800, 600), 4, 3, 2, 4, 1, codes);
+    ASSERT_FALSE(codes.empty());
+
+    // no run proportion is within a zero tolerance
+    QRCodeDetector detector;
+    detector.setEpsX(0);
+    std::vector<Point2f> corners;
+    EXPECT_FALSE(detector.detectMulti(img, corners));
+    std::vector<std::vector<Point2f> > points;
+    detector.detectMultiBatch(std::vector<Mat>(1, img), points);
+    ASSERT_EQ(1u, points.size());
+    EXPECT_TRUE(points[0].empty());
+
+    detector.setEpsX(0.2);
+    detector.setEpsY(0);
+    EXPECT_FALSE(detector.detectMulti(img, corners));
+}
+
+TEST(Objdetect_QRCode_multi, clutter)
+{
+    // a field of finder patterns with no code among them, only the best candidates are grouped
+    Mat img(900, 900, CV_8UC1, Scalar(255));
+    for (int y = 10; y + 14 < img.rows; y += 20)
+    {
+        for (int x = 10; x + 14 < img.cols; x += 20)
+        {
+            rectangle(img, Rect(x, y, 14, 14), Scalar(0), FILLED);
+            rectangle(img, Rect(x + 2, y + 2, 10, 10), Scalar(255), FILLED);
+            rectangle(img, Rect(x + 4, y + 4, 6, 6), Scalar(0), FILLED);
+        }
+    }
+    std::vector<Point2f> corners;
+    EXPECT_NO_THROW(QRCodeDetector().detectMulti(img, corners));
+    EXPECT_EQ(0u, corners.size() % 4);
+}
+
+TEST(Objdetect_QRCode_multi, coarse_pass)
+{
+    std::vector<std::vector<Point2f> > codes;
+    // the finder patterns are searched at the half resolution, with the modules of 1.5 pixels at least
+    Mat img = makeSyntheticQRCodes(Size(1920, 1080), 8, 4, 3, 6, 2, codes);
+    ASSERT_FALSE(codes.empty());
+
+    std::vector<Point2f> corners;
+    QRCodeDetector().detectMulti(img, corners);
+    checkQRCodes(codes, corners, 4);
+}
+
+TEST(Objdetect_QRCode_multi, batch)
+{
+    std::vector<Mat> imgs;
+    for (int i = 0; i < 5; i++)
+    {
+        std::vector<std::vector<Point2f> > codes;
+        imgs.push_back(makeSyntheticQRCodes(Size(640 + 64 * i, 480), 3, 2, 2, 4, 10 + i, codes));
+    }
+    imgs.push_back(Mat::zeros(100, 100, CV_8UC1));
+
+    QRCodeDetector detector;
+    std::vector<std::vector<Point2f> > points;
+    detector.detectMultiBatch(imgs, points);
+    ASSERT_EQ(imgs.size(), points.size());
+    for (size_t i = 0; i < imgs.size(); i++)
+    {
+        std::vector<Point2f> expected;
+        detector.detectMulti(imgs[i], expected);
+        EXPECT_EQ(expected, points[i]) << "image " << i;
+    }
+    EXPECT_TRUE(points.back().empty());
+}
 
 #endif // UPDATE_QRCODE_TEST_DATA
 
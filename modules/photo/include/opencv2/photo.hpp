@@ -247,6 +247,60 @@ CV_EXPORTS_W void fastNlMeansDenoisingMulti( InputArrayOfArrays srcImgs, OutputA
                                              int templateWindowSize = 7, int searchWindowSize = 21,
                                              int normType = NORM_L2);
 
+/** @brief Modification of fastNlMeansDenoisingMulti function that denoises every image of a sequence
+that has temporalWindowSize / 2 images before and after it. Each image gives the same result as
+fastNlMeansDenoisingMulti, but the template patch distances between two images of the sequence are
+computed once for both of them instead of once per denoised image.
+
+@param srcImgs Input 8-bit 1-channel, 2-channel, 3-channel or
+4-channel images sequence. All images should have the same type and
+size.
+@param dst Output images, dst[i] is srcImgs[i + temporalWindowSize / 2] denoised. There are
+srcImgs.size() - temporalWindowSize + 1 images with the same size and type as srcImgs images.
+@param temporalWindowSize Number of surrounding images to use for each image denoising. Should
+be odd.
+@param templateWindowSize Size in pixels of the template patch that is used to compute weights.
+Should be odd. Recommended value 7 pixels
+@param searchWindowSize Size in pixels of the window that is used to compute weighted average for
+given pixel. Should be odd. Affect performance linearly: greater searchWindowsSize - greater
+denoising time. Recommended value 21 pixels
+@param h Parameter regulating filter strength. Bigger h value
+perfectly removes noise but also removes image details, smaller h
+value preserves details but also preserves some noise
+
+The sums of all the output images are kept for each processed part of the images, so the memory
+used grows with the length of the sequence. Long videos can be denoised by chunks overlapping by
+temporalWindowSize - 1 images.
+ */
+CV_EXPORTS_W void fastNlMeansDenoisingSequence( InputArrayOfArrays srcImgs, OutputArrayOfArrays dst,
+        int temporalWindowSize, float h = 3, int templateWindowSize = 7, int searchWindowSize = 21);
+
+/** @brief Modification of fastNlMeansDenoisingMulti function that denoises every image of a sequence
+that has temporalWindowSize / 2 images before and after it, see the function above.
+
+@param srcImgs Input 8-bit or 16-bit (only with NORM_L1) 1-channel,
+2-channel, 3-channel or 4-channel images sequence. All images should
+have the same type and size.
+@param dst Output images, dst[i] is srcImgs[i + temporalWindowSize / 2] denoised. There are
+srcImgs.size() - temporalWindowSize + 1 images with the same size and type as srcImgs images.
+@param temporalWindowSize Number of surrounding images to use for each image denoising. Should
+be odd.
+@param templateWindowSize Size in pixels of the template patch that is used to compute weights.
+Should be odd. Recommended value 7 pixels
+@param searchWindowSize Size in pixels of the window that is used to compute weighted average for
+given pixel. Should be odd. Affect performance linearly: greater searchWindowsSize - greater
+denoising time. Recommended value 21 pixels
+@param h Array of parameters regulating filter strength, either one
+parameter applied to all channels or one per channel in dst. Big h value
+perfectly removes noise but also removes image details, smaller h
+value preserves details but also preserves some noise
+@param normType Type of norm used for weight calculation. Can be either NORM_L2 or NORM_L1
+ */
+CV_EXPORTS_W void fastNlMeansDenoisingSequence( InputArrayOfArrays srcImgs, OutputArrayOfArrays dst,
+                                                int temporalWindowSize, const std::vector<float>& h,
+                                                int templateWindowSize = 7, int searchWindowSize = 21,
+                                                int normType = NORM_L2);
+
 /** @brief Modification of fastNlMeansDenoisingMulti function for colored images sequences
 
 @param srcImgs Input 8-bit 3-channel images sequence. All images should have the same type and
@@ -648,6 +702,22 @@ public:
     CV_WRAP virtual void process(InputArrayOfArrays src, OutputArray dst,
                                  InputArray times, InputArray response) CV_OVERRIDE = 0;
     CV_WRAP virtual void process(InputArrayOfArrays src, OutputArray dst, InputArray times) = 0;
+
+    /** @brief Adds one image of a burst to the merge, so the images don't have to be kept in memory.
+
+    The result is the same as the one of process with all the images of the burst.
+
+    @param src 8-bit image, all the images of a burst have the same size and number of channels
+    @param time exposure time of the image
+    @param response 256x1 matrix with inverse camera response function, the linear response is used
+    when it is empty
+     */
+    CV_WRAP virtual void feed(InputArray src, float time, InputArray response = noArray()) = 0;
+    /** @brief Returns the HDR image of the images fed since the last call and starts a new burst.
+
+    @param dst result image
+     */
+    CV_WRAP virtual void finish(OutputArray dst) = 0;
 };
 
 /** @brief Creates MergeDebevec object
@@ -757,6 +827,22 @@ one object by alternative features.
 CV_EXPORTS_W void seamlessClone( InputArray src, InputArray dst, InputArray mask, Point p,
         OutputArray blend, int flags);
 
+/** @brief Clones several patches into one destination image.
+
+The result is the same as the one of consecutive calls of seamlessClone, each of them cloning the next
+patch into the result of the previous one. The patches whose regions in the destination image do not
+overlap are cloned in parallel.
+
+@param src Input 8-bit 3-channel images of the patches.
+@param dst Input 8-bit 3-channel image.
+@param mask Input 8-bit 1 or 3-channel images, one per patch.
+@param p Points in dst image where the patches are placed.
+@param blend Output image with the same size and type as dst.
+@param flags Cloning method, see seamlessClone.
+ */
+CV_EXPORTS_W void seamlessCloneMulti( InputArrayOfArrays src, InputArray dst, InputArrayOfArrays mask,
+        const std::vector<Point>& p, OutputArray blend, int flags);
+
 /** @brief Given an original color image, two differently colored versions of this image can be mixed
 seamlessly.
 
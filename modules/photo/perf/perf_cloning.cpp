@@ -0,0 +1,59 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+namespace opencv_test
+{
+using namespace perf;
+
+static Mat smoothNoise(Size size, RNG& rng)
+{
+    Mat noise(size / 16, CV_8UC3), image;
+    rng.fill(noise, RNG::UNIFORM, 0, 255);
+    resize(noise, image, size, 0, 0, INTER_CUBIC);
+    return image;
+}
+
+PERF_TEST(seamlessClone, ellipse_1080p)
+{
+    RNG rng(0);
+    Mat destination = smoothNoise(Size(1920, 1080), rng);
+    Mat source = smoothNoise(Size(1920, 1080), rng);
+    Mat mask(destination.size(), CV_8U, Scalar(0));
+    ellipse(mask, Point(960, 540), Size(400, 300), 0, 0, 360, Scalar(255), -1);
+    Mat result;
+
+    declare.in(source, destination, mask).time(60);
+
+    TEST_CYCLE() seamlessClone(source, destination, mask, Point(900, 500), result, NORMAL_CLONE);
+
+    SANITY_CHECK_NOTHING();
+}
+
+// 12 patches of 240x180 pixels in one 1080p image
+PERF_TEST(seamlessCloneMulti, patches_1080p)
+{
+    RNG rng(0);
+    Mat destination = smoothNoise(Size(1920, 1080), rng);
+    Mat mask(Size(240, 180), CV_8U, Scalar(0));
+    ellipse(mask, Point(120, 90), Size(100, 75), 0, 0, 360, Scalar(255), -1);
+    std::vector<Mat> sources, masks;
+    std::vector<Point> points;
+    for (int i = 0; i < 12; i++)
+    {
+        sources.push_back(smoothNoise(mask.size(), rng));
+        masks.push_back(mask);
+        points.push_back(Point(240 + (i % 4) * 480, 180 + (i / 4) * 360));
+    }
+    Mat result;
+
+    declare.in(destination).time(60);
+
+    TEST_CYCLE() seamlessCloneMulti(sources, destination, masks, points, result, NORMAL_CLONE);
+
+    SANITY_CHECK_NOTHING();
+}
+
+} // namespace
@@ -0,0 +1,100 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+namespace opencv_test
+{
+using namespace perf;
+
+// blurred random frames of 640x360 pixels with gaussian noise
+static void makeNoisyFrames(int type, int count, std::vector<Mat>& frames)
+{
+    RNG rng(0);
+    Mat clean(Size(640, 360), type);
+    rng.fill(clean, RNG::UNIFORM, 0, 255);
+    GaussianBlur(clean, clean, Size(9, 9), 3);
+
+    frames.clear();
+    for (int i = 0; i < count; i++)
+    {
+        Mat noise(clean.size(), CV_MAKETYPE(CV_16S, clean.channels())), frame;
+        rng.fill(noise, RNG::NORMAL, 0, 10);
+        cv::add(clean, noise, frame, noArray(), CV_8U);
+        frames.push_back(frame);
+    }
+}
+
+typedef TestBaseWithParam<int> fastNlMeansDenoising_Frames;
+
+PERF_TEST_P(fastNlMeansDenoising_Frames, grayscale, testing::Values(1, 3))
+{
+    int temporalWindowSize = GetParam();
+    std::vector<Mat> frames;
+    makeNoisyFrames(CV_8UC1, temporalWindowSize, frames);
+    Mat dst;
+
+    declare.in(frames[0]).time(60);
+
+    if (temporalWindowSize == 1)
+    {
+        TEST_CYCLE() fastNlMeansDenoising(frames[0], dst, 10, 7, 21);
+    }
+    else
+    {
+        TEST_CYCLE() fastNlMeansDenoisingMulti(frames, dst, temporalWindowSize / 2, temporalWindowSize, 10, 7, 21);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+PERF_TEST_P(fastNlMeansDenoising_Frames, colored, testing::Values(1, 3))
+{
+    int temporalWindowSize = GetParam();
+    std::vector<Mat> frames;
+    makeNoisyFrames(CV_8UC3, temporalWindowSize, frames);
+    Mat dst;
+
+    declare.in(frames[0]).time(60);
+
+    if (temporalWindowSize == 1)
+    {
+        TEST_CYCLE() fastNlMeansDenoisingColored(frames[0], dst, 10, 10, 7, 21);
+    }
+    else
+    {
+        TEST_CYCLE() fastNlMeansDenoisingColoredMulti(frames, dst, temporalWindowSize / 2, temporalWindowSize,
+                                                      10, 10, 7, 21);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+// 8 frames denoised with the temporal window of 3 frames, at once or frame by frame
+PERF_TEST_P(fastNlMeansDenoising_Frames, sequence, testing::Values(0, 1))
+{
+    bool at_once = GetParam() != 0;
+    const int temporalWindowSize = 3, count = 8;
+    std::vector<Mat> frames, dst(count);
+    makeNoisyFrames(CV_8UC1, count + temporalWindowSize - 1, frames);
+
+    declare.in(frames[0]).time(120);
+
+    if (at_once)
+    {
+        TEST_CYCLE() fastNlMeansDenoisingSequence(frames, dst, temporalWindowSize, 10, 7, 21);
+    }
+    else
+    {
+        TEST_CYCLE()
+        {
+            for (int i = 0; i < count; i++)
+                fastNlMeansDenoisingMulti(frames, dst[i], i + temporalWindowSize / 2, temporalWindowSize, 10, 7, 21);
+        }
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+} // namespace
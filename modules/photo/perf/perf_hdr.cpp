@@ -0,0 +1,73 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+namespace opencv_test
+{
+using namespace perf;
+
+// a burst of 8 exposures of one textured scene
+static void makeBurst(Size size, std::vector<Mat>& images, std::vector<float>& times)
+{
+    RNG rng(0);
+    Mat scene(size / 16, CV_32FC3);
+    rng.fill(scene, RNG::UNIFORM, 0.05, 1.0);
+    resize(scene, scene, size, 0, 0, INTER_CUBIC);
+    images.clear();
+    times.clear();
+    for (int i = 0; i < 8; i++)
+    {
+        float time = 0.125f * (float)(1 << i);
+        Mat img;
+        scene.convertTo(img, CV_8U, 64 * time);
+        images.push_back(img);
+        times.push_back(time);
+    }
+}
+
+PERF_TEST(Merge, MergeMertens_burst)
+{
+    std::vector<Mat> images;
+    std::vector<float> times;
+    makeBurst(Size(1920, 1080), images, times);
+    Ptr<MergeMertens> merge = createMergeMertens();
+    Mat result;
+
+    declare.time(60);
+
+    TEST_CYCLE() merge->process(images, result);
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef TestBaseWithParam<bool> MergeStreaming;
+
+PERF_TEST_P(MergeStreaming, MergeDebevec_burst, testing::Bool())
+{
+    std::vector<Mat> images;
+    std::vector<float> times;
+    makeBurst(Size(1920, 1080), images, times);
+    bool streaming = GetParam();
+    Ptr<MergeDebevec> merge = createMergeDebevec();
+    Mat result;
+
+    declare.time(60);
+
+    TEST_CYCLE()
+    {
+        if (streaming)
+        {
+            for (size_t i = 0; i < images.size(); i++)
+                merge->feed(images[i], times[i]);
+            merge->finish(result);
+        }
+        else
+            merge->process(images, result, times);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+} // namespace
@@ -34,4 +34,30 @@ PERF_TEST_P(InpaintArea_InpaintingMethod, inpaint,
     SANITY_CHECK(inpaintedArea);
 }
 
+typedef perf::TestBaseWithParam<InpaintingMethod> InpaintingMethodOnly;
+
+// many small defects, as left by scratches and dust on a scanned photo
+PERF_TEST_P(InpaintingMethodOnly, inpaint_defects, InpaintingMethod::all())
+{
+    RNG rng(0);
+    Mat src(1080, 1920, CV_8UC3), mask = Mat::zeros(src.size(), CV_8U);
+    rng.fill(src, RNG::UNIFORM, 0, 255);
+    GaussianBlur(src, src, Size(9, 9), 3);
+    for (int k = 0; k < 200; k++)
+    {
+        Point p(rng.uniform(0, src.cols), rng.uniform(0, src.rows));
+        if (k % 2)
+            line(mask, p, p + Point(rng.uniform(-60, 60), rng.uniform(-60, 60)), Scalar(255), 2);
+        else
+            circle(mask, p, rng.uniform(1, 8), Scalar(255), -1);
+    }
+    Mat result;
+
+    declare.in(src, mask).time(120);
+
+    TEST_CYCLE() inpaint(src, mask, result, 3.0, GetParam());
+
+    SANITY_CHECK_NOTHING();
+}
+
 } // namespace
@@ -41,59 +41,55 @@
 
 #include "precomp.hpp"
 
-#include "fast_nlmeans_denoising_invoker.hpp"
-#include "fast_nlmeans_multi_denoising_invoker.hpp"
+#include "fast_nlmeans_tiled_invoker.hpp"
 #include "fast_nlmeans_denoising_opencl.hpp"
 
+template<typename T, typename IT, typename UIT, typename D, typename WT>
+static void fastNlMeansDenoisingTiles_( const std::vector<Mat>& srcImgs, std::vector<Mat>& dst,
+                                        int imgToDenoiseIndex, int temporalWindowSize, const float *h,
+                                        int templateWindowSize, int searchWindowSize)
+{
+    FastNlMeansTiledInvoker<T, IT, UIT, D, WT> invoker(srcImgs, imgToDenoiseIndex, temporalWindowSize,
+                                                       dst, templateWindowSize, searchWindowSize, h);
+    parallel_for_(cv::Range(0, invoker.tilesCount()), invoker);
+}
+
 template<typename ST, typename IT, typename UIT, typename D>
-static void fastNlMeansDenoising_( const Mat& src, Mat& dst, const std::vector<float>& h,
-                                   int templateWindowSize, int searchWindowSize)
+static void fastNlMeansDenoisingMulti_( const std::vector<Mat>& srcImgs, std::vector<Mat>& dst,
+                                        int imgToDenoiseIndex, int temporalWindowSize,
+                                        const std::vector<float>& h,
+                                        int templateWindowSize, int searchWindowSize)
 {
     int hn = (int)h.size();
-    double granularity = (double)std::max(1., (double)dst.total()/(1 << 17));
 
-    switch (CV_MAT_CN(src.type())) {
+    switch (srcImgs[0].channels()) {
         case 1:
-            parallel_for_(cv::Range(0, src.rows),
-                          FastNlMeansDenoisingInvoker<ST, IT, UIT, D, int>(
-                              src, dst, templateWindowSize, searchWindowSize, &h[0]),
-                          granularity);
+            fastNlMeansDenoisingTiles_<ST, IT, UIT, D, int>(srcImgs, dst, imgToDenoiseIndex, temporalWindowSize,
+                                                            &h[0], templateWindowSize, searchWindowSize);
             break;
         case 2:
             if (hn == 1)
-                parallel_for_(cv::Range(0, src.rows),
-                              FastNlMeansDenoisingInvoker<Vec<ST, 2>, IT, UIT, D, int>(
-                                  src, dst, templateWindowSize, searchWindowSize, &h[0]),
-                              granularity);
+                fastNlMeansDenoisingTiles_<Vec<ST, 2>, IT, UIT, D, int>(srcImgs, dst, imgToDenoiseIndex, temporalWindowSize,
+                                                                        &h[0], templateWindowSize, searchWindowSize);
             else
-                parallel_for_(cv::Range(0, src.rows),
-                              FastNlMeansDenoisingInvoker<Vec<ST, 2>, IT, UIT, D, Vec2i>(
-                                  src, dst, templateWindowSize, searchWindowSize, &h[0]),
-                              granularity);
+                fastNlMeansDenoisingTiles_<Vec<ST, 2>, IT, UIT, D, Vec2i>(srcImgs, dst, imgToDenoiseIndex, temporalWindowSize,
+                                                                          &h[0], templateWindowSize, searchWindowSize);
             break;
         case 3:
             if (hn == 1)
-                parallel_for_(cv::Range(0, src.rows),
-                              FastNlMeansDenoisingInvoker<Vec<ST, 3>, IT, UIT, D, int>(
-                                  src, dst, templateWindowSize, searchWindowSize, &h[0]),
-                              granularity);
+                fastNlMeansDenoisingTiles_<Vec<ST, 3>, IT, UIT, D, int>(srcImgs, dst, imgToDenoiseIndex, temporalWindowSize,
+                                                                        &h[0], templateWindowSize, searchWindowSize);
             else
-                parallel_for_(cv::Range(0, src.rows),
-                              FastNlMeansDenoisingInvoker<Vec<ST, 3>, IT, UIT, D, Vec3i>(
-                                  src, dst, templateWindowSize, searchWindowSize, &h[0]),
-                              granularity);
+                fastNlMeansDenoisingTiles_<Vec<ST, 3>, IT, UIT, D, Vec3i>(srcImgs, dst, imgToDenoiseIndex, temporalWindowSize,
+                                                                          &h[0], templateWindowSize, searchWindowSize);
             break;
         case 4:
             if (hn == 1)
-                parallel_for_(cv::Range(0, src.rows),
-                              FastNlMeansDenoisingInvoker<Vec<ST, 4>, IT, UIT, D, int>(
-                                  src, dst, templateWindowSize, searchWindowSize, &h[0]),
-                              granularity);
+                fastNlMeansDenoisingTiles_<Vec<ST, 4>, IT, UIT, D, int>(srcImgs, dst, imgToDenoiseIndex, temporalWindowSize,
+                                                                        &h[0], templateWindowSize, searchWindowSize);
             else
-                parallel_for_(cv::Range(0, src.rows),
-                              FastNlMeansDenoisingInvoker<Vec<ST, 4>, IT, UIT, D, Vec4i>(
-                                  src, dst, templateWindowSize, searchWindowSize, &h[0]),
-                              granularity);
+                fastNlMeansDenoisingTiles_<Vec<ST, 4>, IT, UIT, D, Vec4i>(srcImgs, dst, imgToDenoiseIndex, temporalWindowSize,
+                                                                          &h[0], templateWindowSize, searchWindowSize);
             break;
         default:
             CV_Error(Error::StsBadArg,
@@ -101,6 +97,15 @@ static void fastNlMeansDenoising_( const Mat& src, Mat& dst, const std::vector<f
     }
 }
 
+template<typename ST, typename IT, typename UIT, typename D>
+static void fastNlMeansDenoising_( const Mat& src, Mat& dst, const std::vector<float>& h,
+                                   int templateWindowSize, int searchWindowSize)
+{
+    std::vector<Mat> dsts(1, dst);
+    fastNlMeansDenoisingMulti_<ST, IT, UIT, D>(std::vector<Mat>(1, src), dsts, 0, 1, h,
+                                               templateWindowSize, searchWindowSize);
+}
+
 void cv::fastNlMeansDenoising( InputArray _src, OutputArray _dst, float h,
                                int templateWindowSize, int searchWindowSize)
 {
@@ -240,72 +245,6 @@ static void fastNlMeansDenoisingMultiCheckPreconditions(
         }
 }
 
-template<typename ST, typename IT, typename UIT, typename D>
-static void fastNlMeansDenoisingMulti_( const std::vector<Mat>& srcImgs, Mat& dst,
-                                        int imgToDenoiseIndex, int temporalWindowSize,
-                                        const std::vector<float>& h,
-                                        int templateWindowSize, int searchWindowSize)
-{
-    int hn = (int)h.size();
-    double granularity = (double)std::max(1., (double)dst.total()/(1 << 16));
-
-    switch (srcImgs[0].type())
-    {
-        case CV_8U:
-            parallel_for_(cv::Range(0, srcImgs[0].rows),
-                          FastNlMeansMultiDenoisingInvoker<uchar, IT, UIT, D, int>(
-                              srcImgs, imgToDenoiseIndex, temporalWindowSize,
-                              dst, templateWindowSize, searchWindowSize, &h[0]),
-                          granularity);
-            break;
-        case CV_8UC2:
-            if (hn == 1)
-                parallel_for_(cv::Range(0, srcImgs[0].rows),
-                              FastNlMeansMultiDenoisingInvoker<Vec<ST, 2>, IT, UIT, D, int>(
-                                  srcImgs, imgToDenoiseIndex, temporalWindowSize,
-                                  dst, templateWindowSize, searchWindowSize, &h[0]),
-                              granularity);
-            else
-                parallel_for_(cv::Range(0, srcImgs[0].rows),
-                              FastNlMeansMultiDenoisingInvoker<Vec<ST, 2>, IT, UIT, D, Vec2i>(
-                                  srcImgs, imgToDenoiseIndex, temporalWindowSize,
-                                  dst, templateWindowSize, searchWindowSize, &h[0]),
-                              granularity);
-            break;
-        case CV_8UC3:
-            if (hn == 1)
-                parallel_for_(cv::Range(0, srcImgs[0].rows),
-                              FastNlMeansMultiDenoisingInvoker<Vec<ST, 3>, IT, UIT, D, int>(
-                                  srcImgs, imgToDenoiseIndex, temporalWindowSize,
-                                  dst, templateWindowSize, searchWindowSize, &h[0]),
-                              granularity);
-            else
-                parallel_for_(cv::Range(0, srcImgs[0].rows),
-                              FastNlMeansMultiDenoisingInvoker<Vec<ST, 3>, IT, UIT, D, Vec3i>(
-                                  srcImgs, imgToDenoiseIndex, temporalWindowSize,
-                                  dst, templateWindowSize, searchWindowSize, &h[0]),
-                              granularity);
-            break;
-        case CV_8UC4:
-            if (hn == 1)
-                parallel_for_(cv::Range(0, srcImgs[0].rows),
-                              FastNlMeansMultiDenoisingInvoker<Vec<ST, 4>, IT, UIT, D, int>(
-                                  srcImgs, imgToDenoiseIndex, temporalWindowSize,
-                                  dst, templateWindowSize, searchWindowSize, &h[0]),
-                              granularity);
-            else
-                parallel_for_(cv::Range(0, srcImgs[0].rows),
-                              FastNlMeansMultiDenoisingInvoker<Vec<ST, 4>, IT, UIT, D, Vec4i>(
-                                  srcImgs, imgToDenoiseIndex, temporalWindowSize,
-                                  dst, templateWindowSize, searchWindowSize, &h[0]),
-                              granularity);
-            break;
-        default:
-            CV_Error(Error::StsBadArg,
-                "Unsupported image format! Only CV_8U, CV_8UC2, CV_8UC3 and CV_8UC4 are supported");
-    }
-}
-
 void cv::fastNlMeansDenoisingMulti( InputArrayOfArrays _srcImgs, OutputArray _dst,
                                     int imgToDenoiseIndex, int temporalWindowSize,
                                     float h, int templateWindowSize, int searchWindowSize)
@@ -316,27 +255,16 @@ void cv::fastNlMeansDenoisingMulti( InputArrayOfArrays _srcImgs, OutputArray _ds
                               std::vector<float>(1, h), templateWindowSize, searchWindowSize);
 }
 
-void cv::fastNlMeansDenoisingMulti( InputArrayOfArrays _srcImgs, OutputArray _dst,
-                                    int imgToDenoiseIndex, int temporalWindowSize,
-                                    const std::vector<float>& h,
-                                    int templateWindowSize, int searchWindowSize, int normType)
+// denoises srcImgs[imgToDenoiseIndex + i] into dst[i] for all the images of dst
+static void fastNlMeansDenoisingFrames( const std::vector<Mat>& srcImgs, std::vector<Mat>& dst,
+                                        int imgToDenoiseIndex, int temporalWindowSize,
+                                        const std::vector<float>& h,
+                                        int templateWindowSize, int searchWindowSize, int normType)
 {
-    CV_INSTRUMENT_REGION()
-
-    std::vector<Mat> srcImgs;
-    _srcImgs.getMatVector(srcImgs);
-
-    fastNlMeansDenoisingMultiCheckPreconditions(
-        srcImgs, imgToDenoiseIndex,
-        temporalWindowSize, templateWindowSize, searchWindowSize);
-
     int hn = (int)h.size();
     int type = srcImgs[0].type(), depth = CV_MAT_DEPTH(type), cn = CV_MAT_CN(type);
     CV_Assert(hn == 1 || hn == cn);
 
-    _dst.create(srcImgs[0].size(), srcImgs[0].type());
-    Mat dst = _dst.getMat();
-
     switch (normType) {
         case NORM_L2:
             switch (depth) {
@@ -379,6 +307,64 @@ void cv::fastNlMeansDenoisingMulti( InputArrayOfArrays _srcImgs, OutputArray _ds
     }
 }
 
+void cv::fastNlMeansDenoisingMulti( InputArrayOfArrays _srcImgs, OutputArray _dst,
+                                    int imgToDenoiseIndex, int temporalWindowSize,
+                                    const std::vector<float>& h,
+                                    int templateWindowSize, int searchWindowSize, int normType)
+{
+    CV_INSTRUMENT_REGION()
+
+    std::vector<Mat> srcImgs;
+    _srcImgs.getMatVector(srcImgs);
+
+    fastNlMeansDenoisingMultiCheckPreconditions(
+        srcImgs, imgToDenoiseIndex,
+        temporalWindowSize, templateWindowSize, searchWindowSize);
+
+    _dst.create(srcImgs[0].size(), srcImgs[0].type());
+    std::vector<Mat> dst(1, _dst.getMat());
+
+    fastNlMeansDenoisingFrames(srcImgs, dst, imgToDenoiseIndex, temporalWindowSize, h,
+                               templateWindowSize, searchWindowSize, normType);
+}
+
+void cv::fastNlMeansDenoisingSequence( InputArrayOfArrays _srcImgs, OutputArrayOfArrays _dst,
+                                       int temporalWindowSize, float h,
+                                       int templateWindowSize, int searchWindowSize)
+{
+    CV_INSTRUMENT_REGION()
+
+    fastNlMeansDenoisingSequence(_srcImgs, _dst, temporalWindowSize, std::vector<float>(1, h),
+                                 templateWindowSize, searchWindowSize);
+}
+
+void cv::fastNlMeansDenoisingSequence( InputArrayOfArrays _srcImgs, OutputArrayOfArrays _dst,
+                                       int temporalWindowSize, const std::vector<float>& h,
+                                       int templateWindowSize, int searchWindowSize, int normType)
+{
+    CV_INSTRUMENT_REGION()
+
+    std::vector<Mat> srcImgs;
+    _srcImgs.getMatVector(srcImgs);
+
+    int temporalWindowHalfSize = temporalWindowSize / 2;
+    fastNlMeansDenoisingMultiCheckPreconditions(
+        srcImgs, temporalWindowHalfSize,
+        temporalWindowSize, templateWindowSize, searchWindowSize);
+
+    int count = (int)srcImgs.size() - 2 * temporalWindowHalfSize;
+    _dst.create(count, 1, srcImgs[0].type(), -1, true);
+    std::vector<Mat> dst(count);
+    for (int i = 0; i < count; i++)
+    {
+        _dst.create(srcImgs[0].size(), srcImgs[0].type(), i, true);
+        dst[i] = _dst.getMat(i);
+    }
+
+    fastNlMeansDenoisingFrames(srcImgs, dst, temporalWindowHalfSize, temporalWindowSize, h,
+                               templateWindowSize, searchWindowSize, normType);
+}
+
 void cv::fastNlMeansDenoisingColoredMulti( InputArrayOfArrays _srcImgs, OutputArray _dst,
                                            int imgToDenoiseIndex, int temporalWindowSize,
                                            float h, float hForColorComponents,
@@ -0,0 +1,569 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef __OPENCV_FAST_NLMEANS_TILED_INVOKER_HPP__
+#define __OPENCV_FAST_NLMEANS_TILED_INVOKER_HPP__
+
+#include "precomp.hpp"
+#include <limits>
+
+#include "fast_nlmeans_denoising_invoker_commons.hpp"
+#include "opencv2/core/hal/intrin.hpp"
+
+using namespace cv;
+
+// distances of the pixels a[x] and b[x]
+template <typename D, typename T> struct nlmPixelDists_
+{
+    static inline void f(const T* a, const T* b, int* dists, int n)
+    {
+        for (int x = 0; x < n; x++)
+            dists[x] = D::template calcDist<T>(a[x], b[x]);
+    }
+};
+
+// adds the weighted pixels of a row to the estimations, the weight of the pixel p[x + k]
+// for the estimation x is weights[k * wstep + x]
+template <typename T, typename IT, typename WT> struct nlmIncRowWithWeights_
+{
+    static inline void f(IT* estimation, IT* weights_sum, const WT* weights, int wstep,
+                         const T* p, int noffsets, int n, bool)
+    {
+        const int cn = pixelInfo<T>::channels, wcn = pixelInfo<WT>::channels;
+        for (int x = 0; x < n; x++)
+        {
+            IT est[cn], wsum[wcn];
+            for (int c = 0; c < cn; c++)
+                est[c] = estimation[x * cn + c];
+            for (int c = 0; c < wcn; c++)
+                wsum[c] = weights_sum[x * wcn + c];
+            for (int k = 0; k < noffsets; k++)
+                incWithWeight<T, IT, WT>(est, wsum, weights[k * wstep + x], p[x + k]);
+            for (int c = 0; c < cn; c++)
+                estimation[x * cn + c] = est[c];
+            for (int c = 0; c < wcn; c++)
+                weights_sum[x * wcn + c] = wsum[c];
+        }
+    }
+};
+
+#if CV_SIMD128
+template <int cn> struct nlmInterleave_;
+
+template <> struct nlmInterleave_<1>
+{
+    static inline void load(const uchar* ptr, v_uint8x16* v) { v[0] = v_load(ptr); }
+};
+
+template <> struct nlmInterleave_<2>
+{
+    static inline void load(const uchar* ptr, v_uint8x16* v) { v_load_deinterleave(ptr, v[0], v[1]); }
+};
+
+template <> struct nlmInterleave_<3>
+{
+    static inline void load(const uchar* ptr, v_uint8x16* v) { v_load_deinterleave(ptr, v[0], v[1], v[2]); }
+};
+
+template <> struct nlmInterleave_<4>
+{
+    static inline void load(const uchar* ptr, v_uint8x16* v) { v_load_deinterleave(ptr, v[0], v[1], v[2], v[3]); }
+};
+
+template <typename D> struct nlmIsDistSquared_ { enum { value = 0 }; };
+template <> struct nlmIsDistSquared_<DistSquared> { enum { value = 1 }; };
+
+// 16 pixels of 8-bit images at a time
+template <typename D, typename T> struct nlmPixelDists8u_
+{
+    static inline void f(const T* a, const T* b, int* dists, int n)
+    {
+        const int cn = pixelInfo<T>::channels;
+        const uchar* a8 = (const uchar*)a;
+        const uchar* b8 = (const uchar*)b;
+        int x = 0;
+        for (; x <= n - 16; x += 16)
+        {
+            v_uint8x16 va[cn], vb[cn];
+            nlmInterleave_<cn>::load(a8 + x * cn, va);
+            nlmInterleave_<cn>::load(b8 + x * cn, vb);
+
+            v_uint32x4 s0 = v_setzero_u32(), s1 = v_setzero_u32(), s2 = v_setzero_u32(), s3 = v_setzero_u32();
+            for (int c = 0; c < cn; c++)
+            {
+                v_uint16x8 d0, d1;
+                v_uint32x4 q0, q1, q2, q3;
+                v_expand(v_absdiff(va[c], vb[c]), d0, d1);
+                if (nlmIsDistSquared_<D>::value)
+                {
+                    v_mul_expand(d0, d0, q0, q1);
+                    v_mul_expand(d1, d1, q2, q3);
+                }
+                else
+                {
+                    v_expand(d0, q0, q1);
+                    v_expand(d1, q2, q3);
+                }
+                s0 += q0; s1 += q1; s2 += q2; s3 += q3;
+            }
+            v_store(dists + x, v_reinterpret_as_s32(s0));
+            v_store(dists + x + 4, v_reinterpret_as_s32(s1));
+            v_store(dists + x + 8, v_reinterpret_as_s32(s2));
+            v_store(dists + x + 12, v_reinterpret_as_s32(s3));
+        }
+        for (; x < n; x++)
+            dists[x] = D::template calcDist<T>(a[x], b[x]);
+    }
+};
+
+template <typename D> struct nlmPixelDists_<D, uchar> : nlmPixelDists8u_<D, uchar> {};
+template <typename D, int cn> struct nlmPixelDists_<D, Vec<uchar, cn> > : nlmPixelDists8u_<D, Vec<uchar, cn> > {};
+
+// w * p of the non-negative weights and pixels, 16-bit multiplications are enough for weights below 2^15
+static inline v_int32x4 nlmMulWeight(const v_int32x4& w, const v_uint32x4& p, bool short_weights)
+{
+    v_int32x4 p32 = v_reinterpret_as_s32(p);
+    return short_weights ? v_dotprod(v_reinterpret_as_s16(w), v_reinterpret_as_s16(p32)) : w * p32;
+}
+
+// adds 4 weighted pixels to the interleaved estimations e
+template <int cn> struct nlmAccumulate8u_;
+
+template <> struct nlmAccumulate8u_<1>
+{
+    static inline void f(v_int32x4* e, const v_int32x4& w, const uchar* p, bool short_weights)
+    {
+        e[0] += nlmMulWeight(w, v_load_expand_q(p), short_weights);
+    }
+};
+
+template <> struct nlmAccumulate8u_<2>
+{
+    static inline void f(v_int32x4* e, const v_int32x4& w, const uchar* p, bool short_weights)
+    {
+        v_uint32x4 p0, p1;
+        v_int32x4 w0, w1;
+        v_expand(v_load_expand(p), p0, p1);
+        v_zip(w, w, w0, w1);
+        e[0] += nlmMulWeight(w0, p0, short_weights);
+        e[1] += nlmMulWeight(w1, p1, short_weights);
+    }
+};
+
+template <> struct nlmAccumulate8u_<4>
+{
+    static inline void f(v_int32x4* e, const v_int32x4& w, const uchar* p, bool short_weights)
+    {
+        v_uint16x8 p01, p23;
+        v_uint32x4 p0, p1, p2, p3;
+        v_int32x4 w01, w23, w0, w1, w2, w3;
+        v_expand(v_load(p), p01, p23);
+        v_expand(p01, p0, p1);
+        v_expand(p23, p2, p3);
+        v_zip(w, w, w01, w23);
+        v_zip(w01, w01, w0, w1);
+        v_zip(w23, w23, w2, w3);
+        e[0] += nlmMulWeight(w0, p0, short_weights);
+        e[1] += nlmMulWeight(w1, p1, short_weights);
+        e[2] += nlmMulWeight(w2, p2, short_weights);
+        e[3] += nlmMulWeight(w3, p3, short_weights);
+    }
+};
+
+// 4 estimations of 8-bit images with a common weight of all the channels at a time
+template <typename T> struct nlmIncRowWithWeights8u_
+{
+    static inline void f(int* estimation, int* weights_sum, const int* weights, int wstep,
+                         const T* p, int noffsets, int n, bool short_weights)
+    {
+        const int cn = pixelInfo<T>::channels;
+        const uchar* p8 = (const uchar*)p;
+        int x = 0;
+        for (; x <= n - 4; x += 4)
+        {
+            v_int32x4 e[cn], wsum = v_load(weights_sum + x);
+            for (int c = 0; c < cn; c++)
+                e[c] = v_load(estimation + x * cn + c * 4);
+            for (int k = 0; k < noffsets; k++)
+            {
+                v_int32x4 w = v_load(weights + k * wstep + x);
+                wsum += w;
+                nlmAccumulate8u_<cn>::f(e, w, p8 + (x + k) * cn, short_weights);
+            }
+            for (int c = 0; c < cn; c++)
+                v_store(estimation + x * cn + c * 4, e[c]);
+            v_store(weights_sum + x, wsum);
+        }
+        for (; x < n; x++)
+            for (int k = 0; k < noffsets; k++)
+                incWithWeight<T, int, int>(estimation + x * cn, weights_sum + x, weights[k * wstep + x], p[x + k]);
+    }
+};
+
+template <> struct nlmIncRowWithWeights_<uchar, int, int> : nlmIncRowWithWeights8u_<uchar> {};
+template <> struct nlmIncRowWithWeights_<Vec2b, int, int> : nlmIncRowWithWeights8u_<Vec2b> {};
+template <> struct nlmIncRowWithWeights_<Vec4b, int, int> : nlmIncRowWithWeights8u_<Vec4b> {};
+#endif
+// Non-local means over tiles of the output images. For every pair of frames and every vertical offset of
+// the search window the tile is processed row by row. The sums of the pixel distances down the columns of
+// the template windows are kept for all the horizontal offsets and updated with the rows entering and
+// leaving the windows, so the distances of the template windows of a row come out for all of its pixels at
+// once and the weighted pixels of all the horizontal offsets are added to the estimations of the row in one
+// pass. All the data of a tile stay in the cache.
+//
+// Several consecutive frames can be denoised at once. The distance between the template windows of the
+// pixel p of the frame a and of the pixel p + o of the frame b is the one between the pixel p + o of b and
+// the pixel p of a, so the distances of a pair of frames are computed once over the rows and columns the
+// tile needs for both of them and give the weights of the offset o for a and of the offset -o for b.
+//
+// All the sums are integer, so the results depend neither on the tiling nor on the order of the frames and
+// the offsets and are identical to the ones of the former pixel by pixel implementation.
+template <typename T, typename IT, typename UIT, typename D, typename WT>
+struct FastNlMeansTiledInvoker :
+        public ParallelLoopBody
+{
+public:
+    enum { TILE_ROWS = 64, TILE_COLS = 64 };
+
+    //! denoises srcImgs[imgToDenoiseIndex + i] into dst[i] for all the images of dst
+    FastNlMeansTiledInvoker(const std::vector<Mat>& srcImgs, int imgToDenoiseIndex, int temporalWindowSize,
+                            std::vector<Mat>& dst, int template_window_size, int search_window_size, const float *h);
+
+    //! the number of tiles to process
+    int tilesCount() const { return tiles_x_ * tiles_y_; }
+
+    void operator() (const Range& range) const CV_OVERRIDE;
+
+private:
+    void operator= (const FastNlMeansTiledInvoker&);
+
+    // the frames a and b of the extended images, a is denoised and b too if denoise_b is set
+    struct FramePair
+    {
+        int a, b;
+        bool denoise_b;
+    };
+
+    struct TileBuffers
+    {
+        std::vector<int> dists, col_sums, window_dists;
+        std::vector<WT> weights_a, weights_b;
+        std::vector<IT> estimation, weights_sum;
+    };
+
+    void processTile(Rect tile, TileBuffers& buf) const;
+
+    void processRows(Rect tile, int a, int b, int oy, IT* estimation_a, IT* weights_sum_a,
+                     IT* estimation_b, IT* weights_sum_b, int row_begin, int row_end, TileBuffers& buf) const;
+
+    std::vector<Mat>& dst_;
+
+    std::vector<Mat> extended_srcs_;
+    std::vector<FramePair> pairs_;
+    int temporal_window_half_size_;
+    int border_size_;
+    int tiles_x_, tiles_y_;
+
+    int template_window_size_;
+    int search_window_size_;
+
+    int template_window_half_size_;
+    int search_window_half_size_;
+
+    typename pixelInfo<WT>::sampleType fixed_point_mult_;
+    int almost_template_window_size_sq_bin_shift_;
+    std::vector<WT> almost_dist2weight_;
+};
+
+template <typename T, typename IT, typename UIT, typename D, typename WT>
+FastNlMeansTiledInvoker<T, IT, UIT, D, WT>::FastNlMeansTiledInvoker(
+    const std::vector<Mat>& srcImgs,
+    int imgToDenoiseIndex,
+    int temporalWindowSize,
+    std::vector<Mat>& dst,
+    int template_window_size,
+    int search_window_size,
+    const float *h) :
+    dst_(dst)
+{
+    CV_Assert(srcImgs.size() > 0 && dst.size() > 0);
+    CV_Assert(srcImgs[0].channels() == pixelInfo<T>::channels);
+
+    const Mat& src = srcImgs[imgToDenoiseIndex];
+    temporal_window_half_size_ = temporalWindowSize / 2;
+    int temporal_window_size = temporal_window_half_size_ * 2 + 1;
+
+    template_window_half_size_ = template_window_size / 2;
+    search_window_half_size_   = search_window_size   / 2;
+    template_window_size_      = template_window_half_size_ * 2 + 1;
+    search_window_size_        = search_window_half_size_   * 2 + 1;
+
+    // the denoised frames with the ones of their temporal windows
+    int frames = (int)dst_.size() + 2 * temporal_window_half_size_;
+    border_size_ = search_window_half_size_ + template_window_half_size_;
+    extended_srcs_.resize(frames);
+    for (int i = 0; i < frames; i++)
+        copyMakeBorder(srcImgs[imgToDenoiseIndex - temporal_window_half_size_ + i], extended_srcs_[i],
+                       border_size_, border_size_, border_size_, border_size_, BORDER_DEFAULT);
+
+    // every pair of frames within a temporal window of a denoised frame, with a denoised frame first
+    for (int i = 0; i < frames; i++)
+    {
+        bool denoise_i = i >= temporal_window_half_size_ && i < frames - temporal_window_half_size_;
+        for (int j = i; j <= std::min(i + temporal_window_half_size_, frames - 1); j++)
+        {
+            bool denoise_j = j != i && j >= temporal_window_half_size_ && j < frames - temporal_window_half_size_;
+            FramePair pair = { i, j, denoise_j };
+            if (!denoise_i)
+            {
+                if (!denoise_j)
+                    continue;
+                pair.a = j;
+                pair.b = i;
+                pair.denoise_b = false;
+            }
+            pairs_.push_back(pair);
+        }
+    }
+
+    tiles_x_ = (src.cols + TILE_COLS - 1) / TILE_COLS;
+    tiles_y_ = (src.rows + TILE_ROWS - 1) / TILE_ROWS;
+
+    const IT max_estimate_sum_value =
+        (IT)temporal_window_size * (IT)search_window_size_ * (IT)search_window_size_ * (IT)pixelInfo<T>::sampleMax();
+    fixed_point_mult_ = (int)std::min<IT>(std::numeric_limits<IT>::max() / max_estimate_sum_value,
+                                          pixelInfo<WT>::sampleMax());
+
+    // precalc weight for every possible l2 dist between blocks
+    // additional optimization of precalced weights to replace division(averaging) by binary shift
+    CV_Assert(template_window_size_ <= 46340); // sqrt(INT_MAX)
+    int template_window_size_sq = template_window_size_ * template_window_size_;
+    almost_template_window_size_sq_bin_shift_ = 0;
+    while (1 << almost_template_window_size_sq_bin_shift_ < template_window_size_sq)
+        almost_template_window_size_sq_bin_shift_++;
+    double almost_dist2actual_dist_multiplier =
+        ((double)(1 << almost_template_window_size_sq_bin_shift_)) / template_window_size_sq;
+
+    int max_dist = D::template maxDist<T>();
+    int almost_max_dist = (int)(max_dist / almost_dist2actual_dist_multiplier + 1);
+    almost_dist2weight_.resize(almost_max_dist);
+
+    for (int almost_dist = 0; almost_dist < almost_max_dist; almost_dist++)
+    {
+        double dist = almost_dist * almost_dist2actual_dist_multiplier;
+        almost_dist2weight_[almost_dist] =
+            D::template calcWeight<T, WT>(dist, h, fixed_point_mult_);
+    }
+
+    for (size_t i = 0; i < dst_.size(); i++)
+        if (dst_[i].empty())
+            dst_[i] = Mat::zeros(src.size(), src.type());
+}
+
+template <typename T, typename IT, typename UIT, typename D, typename WT>
+void FastNlMeansTiledInvoker<T, IT, UIT, D, WT>::operator() (const Range& range) const
+{
+    TileBuffers buf;
+    for (int t = range.start; t < range.end; t++)
+    {
+        int tx = t % tiles_x_, ty = t / tiles_x_;
+        Rect tile(tx * TILE_COLS, ty * TILE_ROWS, TILE_COLS, TILE_ROWS);
+        processTile(tile & Rect(0, 0, dst_[0].cols, dst_[0].rows), buf);
+    }
+}
+
+template <typename T, typename IT, typename UIT, typename D, typename WT>
+void FastNlMeansTiledInvoker<T, IT, UIT, D, WT>::processTile(Rect tile, TileBuffers& buf) const
+{
+    const int cn = pixelInfo<T>::channels, wcn = pixelInfo<WT>::channels;
+    const int shalf = search_window_half_size_;
+    const int area = tile.area();
+
+    buf.estimation.assign(dst_.size() * area * cn, (IT)0);
+    buf.weights_sum.assign(dst_.size() * area * wcn, (IT)0);
+
+    for (size_t i = 0; i < pairs_.size(); i++)
+    {
+        const FramePair& pair = pairs_[i];
+        int a = pair.a - temporal_window_half_size_, b = pair.b - temporal_window_half_size_;
+        IT* est_a = &buf.estimation[a * area * cn];
+        IT* wsum_a = &buf.weights_sum[a * area * wcn];
+        IT* est_b = pair.denoise_b ? &buf.estimation[b * area * cn] : 0;
+        IT* wsum_b = pair.denoise_b ? &buf.weights_sum[b * area * wcn] : 0;
+
+        for (int oy = -shalf; oy <= shalf; oy++)
+        {
+            // the rows of the tile for a and the rows of the tile shifted by -oy for b, at once if they overlap
+            if (!est_b)
+                processRows(tile, pair.a, pair.b, oy, est_a, wsum_a, 0, 0,
+                            tile.y, tile.y + tile.height, buf);
+            else if (std::abs(oy) >= tile.height)
+            {
+                processRows(tile, pair.a, pair.b, oy, est_a, wsum_a, 0, 0,
+                            tile.y, tile.y + tile.height, buf);
+                processRows(tile, pair.a, pair.b, oy, 0, 0, est_b, wsum_b,
+                            tile.y - oy, tile.y - oy + tile.height, buf);
+            }
+            else
+                processRows(tile, pair.a, pair.b, oy, est_a, wsum_a, est_b, wsum_b,
+                            tile.y + std::min(0, -oy), tile.y + tile.height + std::max(0, -oy), buf);
+        }
+    }
+
+    for (size_t i = 0; i < dst_.size(); i++)
+    {
+        for (int y = 0; y < tile.height; y++)
+        {
+            T* dst_row = dst_[i].ptr<T>(tile.y + y) + tile.x;
+            IT* est = &buf.estimation[(i * area + y * tile.width) * cn];
+            IT* wsum = &buf.weights_sum[(i * area + y * tile.width) * wcn];
+            for (int x = 0; x < tile.width; x++)
+            {
+                divByWeightsSum<IT, UIT, pixelInfo<T>::channels, pixelInfo<WT>::channels>(est + x * cn, wsum + x * wcn);
+                dst_row[x] = saturateCastFromArray<T, IT>(est + x * cn);
+            }
+        }
+    }
+}
+
+// The weights of the horizontal offset k for the frame a are the ones of the template windows of the
+// columns [shalf, shalf + tile.width) relative to tile.x - shalf, the weights of the offset 2 * shalf - k
+// (the opposite offset) for the frame b are the ones of the columns [2 * shalf - k, 2 * shalf - k + tile.width).
+template <typename T, typename IT, typename UIT, typename D, typename WT>
+void FastNlMeansTiledInvoker<T, IT, UIT, D, WT>::processRows(
+    Rect tile, int a, int b, int oy, IT* estimation_a, IT* weights_sum_a,
+    IT* estimation_b, IT* weights_sum_b, int row_begin, int row_end, TileBuffers& buf) const
+{
+    const int cn = pixelInfo<T>::channels, wcn = pixelInfo<WT>::channels;
+    const int twin = template_window_size_, thalf = template_window_half_size_;
+    const int swin = search_window_size_, shalf = search_window_half_size_;
+    const int shift = almost_template_window_size_sq_bin_shift_;
+    const WT* dist2weight = &almost_dist2weight_[0];
+    const bool short_weights = fixed_point_mult_ < (1 << 15);
+
+    // the columns of the template windows of both frames, with their borders
+    const int ext_cols = tile.width + shalf + 2 * thalf;
+    buf.dists.resize(2 * ext_cols);
+    buf.col_sums.resize(swin * ext_cols);
+    buf.window_dists.resize(tile.width + shalf);
+    buf.weights_a.resize(swin * tile.width);
+    buf.weights_b.resize(swin * tile.width);
+
+    int* up = &buf.dists[0];
+    int* down = &buf.dists[ext_cols];
+    const Mat& src_a = extended_srcs_[a];
+    const Mat& src_b = extended_srcs_[b];
+    for (int y = row_begin; y < row_end; y++)
+    {
+        bool row_a = estimation_a && y >= tile.y && y < tile.y + tile.height;
+        bool row_b = estimation_b && y + oy >= tile.y && y + oy < tile.y + tile.height;
+
+        // the first row of the template windows, relative to the extended images
+        int ay = border_size_ + y - thalf;
+
+        for (int k = 0; k < swin; k++)
+        {
+            int* cs = &buf.col_sums[k * ext_cols];
+            int ox = k - shalf;
+            int begin_a = shalf, begin_b = 2 * shalf - k;
+            int begin = estimation_a ? begin_a : begin_b, end = begin + tile.width;
+            if (estimation_a && estimation_b)
+            {
+                begin = std::min(begin_a, begin_b);
+                end = std::max(begin_a, begin_b) + tile.width;
+            }
+            int cols = end - begin + 2 * thalf;
+            int ax = border_size_ + tile.x - shalf + begin - thalf;
+
+            if (y == row_begin)
+            {
+                // sums of the columns of the template windows for the first row
+                for (int x = 0; x < cols; x++)
+                    cs[x] = 0;
+                for (int r = 0; r < twin; r++)
+                {
+                    nlmPixelDists_<D, T>::f(src_a.ptr<T>(ay + r) + ax,
+                                            src_b.ptr<T>(ay + r + oy) + ax + ox, down, cols);
+                    for (int x = 0; x < cols; x++)
+                        cs[x] += down[x];
+                }
+            }
+            else
+            {
+                nlmPixelDists_<D, T>::f(src_a.ptr<T>(ay - 1) + ax,
+                                        src_b.ptr<T>(ay - 1 + oy) + ax + ox, up, cols);
+                nlmPixelDists_<D, T>::f(src_a.ptr<T>(ay + twin - 1) + ax,
+                                        src_b.ptr<T>(ay + twin - 1 + oy) + ax + ox, down, cols);
+                int x = 0;
+#if CV_SIMD128
+                for (; x <= cols - 4; x += 4)
+                    v_store(cs + x, v_load(cs + x) + (v_load(down + x) - v_load(up + x)));
+#endif
+                for (; x < cols; x++)
+                    cs[x] += down[x] - up[x];
+            }
+
+            if (!row_a && !row_b)
+                continue;
+
+            // template window distances are the sums of the neighbouring column sums, only for the columns
+            // of the frames the row is used for
+            int wd_begin = row_a && row_b ? begin : row_a ? begin_a : begin_b;
+            int wd_end = row_a && row_b ? end : wd_begin + tile.width;
+            const int* wcs = cs + wd_begin - begin;
+            int* wd = &buf.window_dists[0];
+            int n = wd_end - wd_begin, x = 0;
+#if CV_SIMD128
+            for (; x <= n - 4; x += 4)
+            {
+                v_int32x4 s = v_load(wcs + x);
+                for (int j = 1; j < twin; j++)
+                    s += v_load(wcs + x + j);
+                v_store(wd + x, s >> shift);
+            }
+#endif
+            for (; x < n; x++)
+            {
+                int s = 0;
+                for (int j = 0; j < twin; j++)
+                    s += wcs[x + j];
+                wd[x] = s >> shift;
+            }
+
+            if (row_a)
+            {
+                WT* w = &buf.weights_a[k * tile.width];
+                const int* d = wd + begin_a - wd_begin;
+                for (x = 0; x < tile.width; x++)
+                    w[x] = dist2weight[d[x]];
+            }
+            if (row_b)
+            {
+                WT* w = &buf.weights_b[(swin - 1 - k) * tile.width];
+                const int* d = wd + begin_b - wd_begin;
+                for (x = 0; x < tile.width; x++)
+                    w[x] = dist2weight[d[x]];
+            }
+        }
+
+        if (row_a)
+        {
+            int ty = y - tile.y;
+            const T* p = src_b.ptr<T>(border_size_ + y + oy) + border_size_ + tile.x - shalf;
+            nlmIncRowWithWeights_<T, IT, WT>::f(estimation_a + ty * tile.width * cn,
+                                                weights_sum_a + ty * tile.width * wcn,
+                                                &buf.weights_a[0], tile.width, p, swin, tile.width, short_weights);
+        }
+        if (row_b)
+        {
+            int ty = y + oy - tile.y;
+            const T* p = src_a.ptr<T>(border_size_ + y) + border_size_ + tile.x - shalf;
+            nlmIncRowWithWeights_<T, IT, WT>::f(estimation_b + ty * tile.width * cn,
+                                                weights_sum_b + ty * tile.width * wcn,
+                                                &buf.weights_b[0], tile.width, p, swin, tile.width, short_weights);
+        }
+    }
+}
+
+#endif
@@ -67,56 +67,44 @@ min4( float a, float b, float c, float d )
 #define INSIDE 2  //unknown
 #define CHANGE 3  //servise
 
-typedef struct CvHeapElem
-{
-    float T;
-    int i,j;
-    struct CvHeapElem* prev;
-    struct CvHeapElem* next;
-}
-CvHeapElem;
-
-
+// the narrow band ordered by the distances, the pixels at the same distance are taken in the order
+// they were pushed
 class CvPriorityQueueFloat
 {
 private:
     CvPriorityQueueFloat(const CvPriorityQueueFloat & ); // copy disabled
     CvPriorityQueueFloat& operator=(const CvPriorityQueueFloat &); // assign disabled
 
+    struct Elem
+    {
+        float T;
+        unsigned seq;
+        int i,j;
+    };
+
+    struct Later
+    {
+        bool operator()(const Elem& a, const Elem& b) const
+        {
+            return a.T > b.T || (a.T == b.T && a.seq > b.seq);
+        }
+    };
+
 protected:
-    CvHeapElem *mem,*empty,*head,*tail;
-    int num,in;
+    std::vector<Elem> heap;
+    unsigned seq;
 
 public:
     bool Init( const CvMat* f )
     {
-        int i,j;
+        int i,j,num;
         for( i = num = 0; i < f->rows; i++ )
         {
             for( j = 0; j < f->cols; j++ )
                 num += CV_MAT_ELEM(*f,uchar,i,j)!=0;
         }
         if (num<=0) return false;
-        mem = (CvHeapElem*)cvAlloc((num+2)*sizeof(CvHeapElem));
-        if (mem==NULL) return false;
-
-        head       = mem;
-        head->i    = head->j = -1;
-        head->prev = NULL;
-        head->next = mem+1;
-        head->T    = -FLT_MAX;
-        empty      = mem+1;
-        for (i=1; i<=num; i++) {
-            mem[i].prev   = mem+i-1;
-            mem[i].next   = mem+i+1;
-            mem[i].i      = -1;
-            mem[i].T      = FLT_MAX;
-        }
-        tail       = mem+i;
-        tail->i    = tail->j = -1;
-        tail->prev = mem+i-1;
-        tail->next = NULL;
-        tail->T    = FLT_MAX;
+        heap.reserve(num);
         return true;
     }
 
@@ -133,72 +121,41 @@ public:
     }
 
     bool Push(int i, int j, float T) {
-        CvHeapElem *tmp=empty,*add=empty;
-        if (empty==tail) return false;
-        while (tmp->prev->T>T) tmp = tmp->prev;
-        if (tmp!=empty) {
-            add->prev->next = add->next;
-            add->next->prev = add->prev;
-            empty = add->next;
-            add->prev = tmp->prev;
-            add->next = tmp;
-            add->prev->next = add;
-            add->next->prev = add;
-        } else {
-            empty = empty->next;
-        }
-        add->i = i;
-        add->j = j;
-        add->T = T;
-        in++;
-        //      printf("push i %3d  j %3d  T %12.4e  in %4d\n",i,j,T,in);
+        Elem add;
+        add.T = T;
+        add.seq = seq++;
+        add.i = i;
+        add.j = j;
+        heap.push_back(add);
+        std::push_heap(heap.begin(), heap.end(), Later());
         return true;
     }
 
     bool Pop(int *i, int *j) {
-        CvHeapElem *tmp=head->next;
-        if (empty==tmp) return false;
-        *i = tmp->i;
-        *j = tmp->j;
-        tmp->prev->next = tmp->next;
-        tmp->next->prev = tmp->prev;
-        tmp->prev = empty->prev;
-        tmp->next = empty;
-        tmp->prev->next = tmp;
-        tmp->next->prev = tmp;
-        empty = tmp;
-        in--;
-        //      printf("pop  i %3d  j %3d  T %12.4e  in %4d\n",tmp->i,tmp->j,tmp->T,in);
-        return true;
+        float T;
+        return Pop(i, j, &T);
     }
 
     bool Pop(int *i, int *j, float *T) {
-        CvHeapElem *tmp=head->next;
-        if (empty==tmp) return false;
-        *i = tmp->i;
-        *j = tmp->j;
-        *T = tmp->T;
-        tmp->prev->next = tmp->next;
-        tmp->next->prev = tmp->prev;
-        tmp->prev = empty->prev;
-        tmp->next = empty;
-        tmp->prev->next = tmp;
-        tmp->next->prev = tmp;
-        empty = tmp;
-        in--;
-        //      printf("pop  i %3d  j %3d  T %12.4e  in %4d\n",tmp->i,tmp->j,tmp->T,in);
+        if (heap.empty()) return false;
+        std::pop_heap(heap.begin(), heap.end(), Later());
+        *i = heap.back().i;
+        *j = heap.back().j;
+        *T = heap.back().T;
+        heap.pop_back();
         return true;
     }
 
     CvPriorityQueueFloat(void) {
-        num=in=0;
-        mem=empty=head=tail=NULL;
+        seq=0;
     }
+};
 
-    ~CvPriorityQueueFloat(void)
-    {
-        cvFree( &mem );
-    }
+// an unknown pixel reached by the fast marching and its distance to the initial band
+struct CvInpaintStep
+{
+    int i,j;
+    float T;
 };
 
 inline float VectorScalMult(CvPoint2D32f v1,CvPoint2D32f v2) {
@@ -281,420 +238,368 @@ icvCalcFMM(const CvMat *f, CvMat *t, CvPriorityQueueFloat *Heap, bool negate) {
    }
 }
 
-template <typename data_type>
+// the fast marching of the unknown pixels from the narrow band. The order of the pixels and their
+// distances to the band only depend on the mask, the images are inpainted in this order afterwards.
 static void
-icvTeleaInpaintFMM(const CvMat *f, CvMat *t, CvMat *out, int range, CvPriorityQueueFloat *Heap ) {
-   int i = 0, j = 0, ii = 0, jj = 0, k, l, q, color = 0;
+icvCalcInpaintOrder(CvMat *f, CvMat *t, CvPriorityQueueFloat *Heap, std::vector<CvInpaintStep>& order) {
+   int i = 0, j = 0, ii = 0, jj = 0, q;
    float dist;
 
-   if (CV_MAT_CN(out->type)==3) {
+   while (Heap->Pop(&ii,&jj)) {
 
-      while (Heap->Pop(&ii,&jj)) {
-
-         CV_MAT_ELEM(*f,uchar,ii,jj) = KNOWN;
-         for(q=0; q<4; q++) {
-            if     (q==0) {i=ii-1; j=jj;}
-            else if(q==1) {i=ii;   j=jj-1;}
-            else if(q==2) {i=ii+1; j=jj;}
-            else if(q==3) {i=ii;   j=jj+1;}
-            if ((i<=1)||(j<=1)||(i>t->rows-1)||(j>t->cols-1)) continue;
-
-            if (CV_MAT_ELEM(*f,uchar,i,j)==INSIDE) {
-               dist = min4(FastMarching_solve(i-1,j,i,j-1,f,t),
-                           FastMarching_solve(i+1,j,i,j-1,f,t),
-                           FastMarching_solve(i-1,j,i,j+1,f,t),
-                           FastMarching_solve(i+1,j,i,j+1,f,t));
-               CV_MAT_ELEM(*t,float,i,j) = dist;
-
-               for (color=0; color<=2; color++) {
-                  CvPoint2D32f gradI,gradT,r;
-                  float Ia=0,Jx=0,Jy=0,s=1.0e-20f,w,dst,lev,dir,sat;
-
-                  if (CV_MAT_ELEM(*f,uchar,i,j+1)!=INSIDE) {
-                     if (CV_MAT_ELEM(*f,uchar,i,j-1)!=INSIDE) {
-                        gradT.x=(float)((CV_MAT_ELEM(*t,float,i,j+1)-CV_MAT_ELEM(*t,float,i,j-1)))*0.5f;
-                     } else {
-                        gradT.x=(float)((CV_MAT_ELEM(*t,float,i,j+1)-CV_MAT_ELEM(*t,float,i,j)));
-                     }
-                  } else {
-                     if (CV_MAT_ELEM(*f,uchar,i,j-1)!=INSIDE) {
-                        gradT.x=(float)((CV_MAT_ELEM(*t,float,i,j)-CV_MAT_ELEM(*t,float,i,j-1)));
-                     } else {
-                        gradT.x=0;
-                     }
-                  }
-                  if (CV_MAT_ELEM(*f,uchar,i+1,j)!=INSIDE) {
-                     if (CV_MAT_ELEM(*f,uchar,i-1,j)!=INSIDE) {
-                        gradT.y=(float)((CV_MAT_ELEM(*t,float,i+1,j)-CV_MAT_ELEM(*t,float,i-1,j)))*0.5f;
+      CV_MAT_ELEM(*f,uchar,ii,jj) = KNOWN;
+      for(q=0; q<4; q++) {
+         if     (q==0) {i=ii-1; j=jj;}
+         else if(q==1) {i=ii;   j=jj-1;}
+         else if(q==2) {i=ii+1; j=jj;}
+         else if(q==3) {i=ii;   j=jj+1;}
+         if ((i<=1)||(j<=1)||(i>t->rows-1)||(j>t->cols-1)) continue;
+
+         if (CV_MAT_ELEM(*f,uchar,i,j)==INSIDE) {
+            dist = min4(FastMarching_solve(i-1,j,i,j-1,f,t),
+                        FastMarching_solve(i+1,j,i,j-1,f,t),
+                        FastMarching_solve(i-1,j,i,j+1,f,t),
+                        FastMarching_solve(i+1,j,i,j+1,f,t));
+            CV_MAT_ELEM(*t,float,i,j) = dist;
+            CV_MAT_ELEM(*f,uchar,i,j) = BAND;
+            Heap->Push(i,j,dist);
+
+            CvInpaintStep step = { i, j, dist };
+            order.push_back(step);
+         }
+      }
+   }
+}
+
+template <typename data_type>
+static void
+icvTeleaInpaintPoint(const CvMat *f, const CvMat *t, CvMat *out, int range, int i, int j) {
+   int k, l, color = 0;
+
+   if (CV_MAT_CN(out->type)==3) {
+      for (color=0; color<=2; color++) {
+         CvPoint2D32f gradI,gradT,r;
+         float Ia=0,Jx=0,Jy=0,s=1.0e-20f,w,dst,lev,dir,sat;
+
+         if (CV_MAT_ELEM(*f,uchar,i,j+1)!=INSIDE) {
+            if (CV_MAT_ELEM(*f,uchar,i,j-1)!=INSIDE) {
+               gradT.x=(float)((CV_MAT_ELEM(*t,float,i,j+1)-CV_MAT_ELEM(*t,float,i,j-1)))*0.5f;
+            } else {
+               gradT.x=(float)((CV_MAT_ELEM(*t,float,i,j+1)-CV_MAT_ELEM(*t,float,i,j)));
+            }
+         } else {
+            if (CV_MAT_ELEM(*f,uchar,i,j-1)!=INSIDE) {
+               gradT.x=(float)((CV_MAT_ELEM(*t,float,i,j)-CV_MAT_ELEM(*t,float,i,j-1)));
+            } else {
+               gradT.x=0;
+            }
+         }
+         if (CV_MAT_ELEM(*f,uchar,i+1,j)!=INSIDE) {
+            if (CV_MAT_ELEM(*f,uchar,i-1,j)!=INSIDE) {
+               gradT.y=(float)((CV_MAT_ELEM(*t,float,i+1,j)-CV_MAT_ELEM(*t,float,i-1,j)))*0.5f;
+            } else {
+               gradT.y=(float)((CV_MAT_ELEM(*t,float,i+1,j)-CV_MAT_ELEM(*t,float,i,j)));
+            }
+         } else {
+            if (CV_MAT_ELEM(*f,uchar,i-1,j)!=INSIDE) {
+               gradT.y=(float)((CV_MAT_ELEM(*t,float,i,j)-CV_MAT_ELEM(*t,float,i-1,j)));
+            } else {
+               gradT.y=0;
+            }
+         }
+         for (k=i-range; k<=i+range; k++) {
+            int km=k-1+(k==1),kp=k-1-(k==t->rows-2);
+            for (l=j-range; l<=j+range; l++) {
+               int lm=l-1+(l==1),lp=l-1-(l==t->cols-2);
+               if (k>0&&l>0&&k<t->rows-1&&l<t->cols-1) {
+                  if ((CV_MAT_ELEM(*f,uchar,k,l)!=INSIDE)&&
+                      ((l-j)*(l-j)+(k-i)*(k-i)<=range*range)) {
+                     r.y     = (float)(i-k);
+                     r.x     = (float)(j-l);
+
+                     dst = (float)(1./(VectorLength(r)*sqrt((double)VectorLength(r))));
+                     lev = (float)(1./(1+fabs(CV_MAT_ELEM(*t,float,k,l)-CV_MAT_ELEM(*t,float,i,j))));
+
+                     dir=VectorScalMult(r,gradT);
+                     if (fabs(dir)<=0.01) dir=0.000001f;
+                     w = (float)fabs(dst*lev*dir);
+
+                     if (CV_MAT_ELEM(*f,uchar,k,l+1)!=INSIDE) {
+                        if (CV_MAT_ELEM(*f,uchar,k,l-1)!=INSIDE) {
+                           gradI.x=(float)((CV_MAT_3COLOR_ELEM(*out,uchar,km,lp+1,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km,lm-1,color)))*2.0f;
+                        } else {
+                           gradI.x=(float)((CV_MAT_3COLOR_ELEM(*out,uchar,km,lp+1,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km,lm,color)));
+                        }
                      } else {
-                        gradT.y=(float)((CV_MAT_ELEM(*t,float,i+1,j)-CV_MAT_ELEM(*t,float,i,j)));
+                        if (CV_MAT_ELEM(*f,uchar,k,l-1)!=INSIDE) {
+                           gradI.x=(float)((CV_MAT_3COLOR_ELEM(*out,uchar,km,lp,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km,lm-1,color)));
+                        } else {
+                           gradI.x=0;
+                        }
                      }
-                  } else {
-                     if (CV_MAT_ELEM(*f,uchar,i-1,j)!=INSIDE) {
-                        gradT.y=(float)((CV_MAT_ELEM(*t,float,i,j)-CV_MAT_ELEM(*t,float,i-1,j)));
+                     if (CV_MAT_ELEM(*f,uchar,k+1,l)!=INSIDE) {
+                        if (CV_MAT_ELEM(*f,uchar,k-1,l)!=INSIDE) {
+                           gradI.y=(float)((CV_MAT_3COLOR_ELEM(*out,uchar,kp+1,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km-1,lm,color)))*2.0f;
+                        } else {
+                           gradI.y=(float)((CV_MAT_3COLOR_ELEM(*out,uchar,kp+1,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km,lm,color)));
+                        }
                      } else {
-                        gradT.y=0;
-                     }
-                  }
-                  for (k=i-range; k<=i+range; k++) {
-                     int km=k-1+(k==1),kp=k-1-(k==t->rows-2);
-                     for (l=j-range; l<=j+range; l++) {
-                        int lm=l-1+(l==1),lp=l-1-(l==t->cols-2);
-                        if (k>0&&l>0&&k<t->rows-1&&l<t->cols-1) {
-                           if ((CV_MAT_ELEM(*f,uchar,k,l)!=INSIDE)&&
-                               ((l-j)*(l-j)+(k-i)*(k-i)<=range*range)) {
-                              r.y     = (float)(i-k);
-                              r.x     = (float)(j-l);
-
-                              dst = (float)(1./(VectorLength(r)*sqrt((double)VectorLength(r))));
-                              lev = (float)(1./(1+fabs(CV_MAT_ELEM(*t,float,k,l)-CV_MAT_ELEM(*t,float,i,j))));
-
-                              dir=VectorScalMult(r,gradT);
-                              if (fabs(dir)<=0.01) dir=0.000001f;
-                              w = (float)fabs(dst*lev*dir);
-
-                              if (CV_MAT_ELEM(*f,uchar,k,l+1)!=INSIDE) {
-                                 if (CV_MAT_ELEM(*f,uchar,k,l-1)!=INSIDE) {
-                                    gradI.x=(float)((CV_MAT_3COLOR_ELEM(*out,uchar,km,lp+1,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km,lm-1,color)))*2.0f;
-                                 } else {
-                                    gradI.x=(float)((CV_MAT_3COLOR_ELEM(*out,uchar,km,lp+1,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km,lm,color)));
-                                 }
-                              } else {
-                                 if (CV_MAT_ELEM(*f,uchar,k,l-1)!=INSIDE) {
-                                    gradI.x=(float)((CV_MAT_3COLOR_ELEM(*out,uchar,km,lp,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km,lm-1,color)));
-                                 } else {
-                                    gradI.x=0;
-                                 }
-                              }
-                              if (CV_MAT_ELEM(*f,uchar,k+1,l)!=INSIDE) {
-                                 if (CV_MAT_ELEM(*f,uchar,k-1,l)!=INSIDE) {
-                                    gradI.y=(float)((CV_MAT_3COLOR_ELEM(*out,uchar,kp+1,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km-1,lm,color)))*2.0f;
-                                 } else {
-                                    gradI.y=(float)((CV_MAT_3COLOR_ELEM(*out,uchar,kp+1,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km,lm,color)));
-                                 }
-                              } else {
-                                 if (CV_MAT_ELEM(*f,uchar,k-1,l)!=INSIDE) {
-                                    gradI.y=(float)((CV_MAT_3COLOR_ELEM(*out,uchar,kp,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km-1,lm,color)));
-                                 } else {
-                                    gradI.y=0;
-                                 }
-                              }
-                              Ia += (float)w * (float)(CV_MAT_3COLOR_ELEM(*out,uchar,km,lm,color));
-                              Jx -= (float)w * (float)(gradI.x*r.x);
-                              Jy -= (float)w * (float)(gradI.y*r.y);
-                              s  += w;
-                           }
+                        if (CV_MAT_ELEM(*f,uchar,k-1,l)!=INSIDE) {
+                           gradI.y=(float)((CV_MAT_3COLOR_ELEM(*out,uchar,kp,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km-1,lm,color)));
+                        } else {
+                           gradI.y=0;
                         }
                      }
-                  }
-                  sat = (float)((Ia/s+(Jx+Jy)/(sqrt(Jx*Jx+Jy*Jy)+1.0e-20f)+0.5f));
-                  {
-                  CV_MAT_3COLOR_ELEM(*out,uchar,i-1,j-1,color) = cv::saturate_cast<uchar>(sat);
+                     Ia += (float)w * (float)(CV_MAT_3COLOR_ELEM(*out,uchar,km,lm,color));
+                     Jx -= (float)w * (float)(gradI.x*r.x);
+                     Jy -= (float)w * (float)(gradI.y*r.y);
+                     s  += w;
                   }
                }
-
-               CV_MAT_ELEM(*f,uchar,i,j) = BAND;
-               Heap->Push(i,j,dist);
             }
          }
+         sat = (float)((Ia/s+(Jx+Jy)/(sqrt(Jx*Jx+Jy*Jy)+1.0e-20f)+0.5f));
+         {
+         CV_MAT_3COLOR_ELEM(*out,uchar,i-1,j-1,color) = cv::saturate_cast<uchar>(sat);
+         }
       }
-
    } else if (CV_MAT_CN(out->type)==1) {
-
-      while (Heap->Pop(&ii,&jj)) {
-
-         CV_MAT_ELEM(*f,uchar,ii,jj) = KNOWN;
-         for(q=0; q<4; q++) {
-            if     (q==0) {i=ii-1; j=jj;}
-            else if(q==1) {i=ii;   j=jj-1;}
-            else if(q==2) {i=ii+1; j=jj;}
-            else if(q==3) {i=ii;   j=jj+1;}
-            if ((i<=1)||(j<=1)||(i>t->rows-1)||(j>t->cols-1)) continue;
-
-            if (CV_MAT_ELEM(*f,uchar,i,j)==INSIDE) {
-               dist = min4(FastMarching_solve(i-1,j,i,j-1,f,t),
-                           FastMarching_solve(i+1,j,i,j-1,f,t),
-                           FastMarching_solve(i-1,j,i,j+1,f,t),
-                           FastMarching_solve(i+1,j,i,j+1,f,t));
-               CV_MAT_ELEM(*t,float,i,j) = dist;
-
-               for (color=0; color<=0; color++) {
-                  CvPoint2D32f gradI,gradT,r;
-                  float Ia=0,Jx=0,Jy=0,s=1.0e-20f,w,dst,lev,dir,sat;
-
-                  if (CV_MAT_ELEM(*f,uchar,i,j+1)!=INSIDE) {
-                     if (CV_MAT_ELEM(*f,uchar,i,j-1)!=INSIDE) {
-                        gradT.x=(float)((CV_MAT_ELEM(*t,float,i,j+1)-CV_MAT_ELEM(*t,float,i,j-1)))*0.5f;
-                     } else {
-                        gradT.x=(float)((CV_MAT_ELEM(*t,float,i,j+1)-CV_MAT_ELEM(*t,float,i,j)));
-                     }
-                  } else {
-                     if (CV_MAT_ELEM(*f,uchar,i,j-1)!=INSIDE) {
-                        gradT.x=(float)((CV_MAT_ELEM(*t,float,i,j)-CV_MAT_ELEM(*t,float,i,j-1)));
-                     } else {
-                        gradT.x=0;
-                     }
-                  }
-                  if (CV_MAT_ELEM(*f,uchar,i+1,j)!=INSIDE) {
-                     if (CV_MAT_ELEM(*f,uchar,i-1,j)!=INSIDE) {
-                        gradT.y=(float)((CV_MAT_ELEM(*t,float,i+1,j)-CV_MAT_ELEM(*t,float,i-1,j)))*0.5f;
+      for (color=0; color<=0; color++) {
+         CvPoint2D32f gradI,gradT,r;
+         float Ia=0,Jx=0,Jy=0,s=1.0e-20f,w,dst,lev,dir,sat;
+
+         if (CV_MAT_ELEM(*f,uchar,i,j+1)!=INSIDE) {
+            if (CV_MAT_ELEM(*f,uchar,i,j-1)!=INSIDE) {
+               gradT.x=(float)((CV_MAT_ELEM(*t,float,i,j+1)-CV_MAT_ELEM(*t,float,i,j-1)))*0.5f;
+            } else {
+               gradT.x=(float)((CV_MAT_ELEM(*t,float,i,j+1)-CV_MAT_ELEM(*t,float,i,j)));
+            }
+         } else {
+            if (CV_MAT_ELEM(*f,uchar,i,j-1)!=INSIDE) {
+               gradT.x=(float)((CV_MAT_ELEM(*t,float,i,j)-CV_MAT_ELEM(*t,float,i,j-1)));
+            } else {
+               gradT.x=0;
+            }
+         }
+         if (CV_MAT_ELEM(*f,uchar,i+1,j)!=INSIDE) {
+            if (CV_MAT_ELEM(*f,uchar,i-1,j)!=INSIDE) {
+               gradT.y=(float)((CV_MAT_ELEM(*t,float,i+1,j)-CV_MAT_ELEM(*t,float,i-1,j)))*0.5f;
+            } else {
+               gradT.y=(float)((CV_MAT_ELEM(*t,float,i+1,j)-CV_MAT_ELEM(*t,float,i,j)));
+            }
+         } else {
+            if (CV_MAT_ELEM(*f,uchar,i-1,j)!=INSIDE) {
+               gradT.y=(float)((CV_MAT_ELEM(*t,float,i,j)-CV_MAT_ELEM(*t,float,i-1,j)));
+            } else {
+               gradT.y=0;
+            }
+         }
+         for (k=i-range; k<=i+range; k++) {
+            int km=k-1+(k==1),kp=k-1-(k==t->rows-2);
+            for (l=j-range; l<=j+range; l++) {
+               int lm=l-1+(l==1),lp=l-1-(l==t->cols-2);
+               if (k>0&&l>0&&k<t->rows-1&&l<t->cols-1) {
+                  if ((CV_MAT_ELEM(*f,uchar,k,l)!=INSIDE)&&
+                      ((l-j)*(l-j)+(k-i)*(k-i)<=range*range)) {
+                     r.y     = (float)(i-k);
+                     r.x     = (float)(j-l);
+
+                     dst = (float)(1./(VectorLength(r)*sqrt(VectorLength(r))));
+                     lev = (float)(1./(1+fabs(CV_MAT_ELEM(*t,float,k,l)-CV_MAT_ELEM(*t,float,i,j))));
+
+                     dir=VectorScalMult(r,gradT);
+                     if (fabs(dir)<=0.01) dir=0.000001f;
+                     w = (float)fabs(dst*lev*dir);
+
+                     if (CV_MAT_ELEM(*f,uchar,k,l+1)!=INSIDE) {
+                        if (CV_MAT_ELEM(*f,uchar,k,l-1)!=INSIDE) {
+                           gradI.x=(float)((CV_MAT_ELEM(*out,data_type,km,lp+1)-CV_MAT_ELEM(*out,data_type,km,lm-1)))*2.0f;
+                        } else {
+                           gradI.x=(float)((CV_MAT_ELEM(*out,data_type,km,lp+1)-CV_MAT_ELEM(*out,data_type,km,lm)));
+                        }
                      } else {
-                        gradT.y=(float)((CV_MAT_ELEM(*t,float,i+1,j)-CV_MAT_ELEM(*t,float,i,j)));
+                        if (CV_MAT_ELEM(*f,uchar,k,l-1)!=INSIDE) {
+                           gradI.x=(float)((CV_MAT_ELEM(*out,data_type,km,lp)-CV_MAT_ELEM(*out,data_type,km,lm-1)));
+                        } else {
+                           gradI.x=0;
+                        }
                      }
-                  } else {
-                     if (CV_MAT_ELEM(*f,uchar,i-1,j)!=INSIDE) {
-                        gradT.y=(float)((CV_MAT_ELEM(*t,float,i,j)-CV_MAT_ELEM(*t,float,i-1,j)));
+                     if (CV_MAT_ELEM(*f,uchar,k+1,l)!=INSIDE) {
+                        if (CV_MAT_ELEM(*f,uchar,k-1,l)!=INSIDE) {
+                           gradI.y=(float)((CV_MAT_ELEM(*out,data_type,kp+1,lm)-CV_MAT_ELEM(*out,data_type,km-1,lm)))*2.0f;
+                        } else {
+                           gradI.y=(float)((CV_MAT_ELEM(*out,data_type,kp+1,lm)-CV_MAT_ELEM(*out,data_type,km,lm)));
+                        }
                      } else {
-                        gradT.y=0;
-                     }
-                  }
-                  for (k=i-range; k<=i+range; k++) {
-                     int km=k-1+(k==1),kp=k-1-(k==t->rows-2);
-                     for (l=j-range; l<=j+range; l++) {
-                        int lm=l-1+(l==1),lp=l-1-(l==t->cols-2);
-                        if (k>0&&l>0&&k<t->rows-1&&l<t->cols-1) {
-                           if ((CV_MAT_ELEM(*f,uchar,k,l)!=INSIDE)&&
-                               ((l-j)*(l-j)+(k-i)*(k-i)<=range*range)) {
-                              r.y     = (float)(i-k);
-                              r.x     = (float)(j-l);
-
-                              dst = (float)(1./(VectorLength(r)*sqrt(VectorLength(r))));
-                              lev = (float)(1./(1+fabs(CV_MAT_ELEM(*t,float,k,l)-CV_MAT_ELEM(*t,float,i,j))));
-
-                              dir=VectorScalMult(r,gradT);
-                              if (fabs(dir)<=0.01) dir=0.000001f;
-                              w = (float)fabs(dst*lev*dir);
-
-                              if (CV_MAT_ELEM(*f,uchar,k,l+1)!=INSIDE) {
-                                 if (CV_MAT_ELEM(*f,uchar,k,l-1)!=INSIDE) {
-                                    gradI.x=(float)((CV_MAT_ELEM(*out,data_type,km,lp+1)-CV_MAT_ELEM(*out,data_type,km,lm-1)))*2.0f;
-                                 } else {
-                                    gradI.x=(float)((CV_MAT_ELEM(*out,data_type,km,lp+1)-CV_MAT_ELEM(*out,data_type,km,lm)));
-                                 }
-                              } else {
-                                 if (CV_MAT_ELEM(*f,uchar,k,l-1)!=INSIDE) {
-                                    gradI.x=(float)((CV_MAT_ELEM(*out,data_type,km,lp)-CV_MAT_ELEM(*out,data_type,km,lm-1)));
-                                 } else {
-                                    gradI.x=0;
-                                 }
-                              }
-                              if (CV_MAT_ELEM(*f,uchar,k+1,l)!=INSIDE) {
-                                 if (CV_MAT_ELEM(*f,uchar,k-1,l)!=INSIDE) {
-                                    gradI.y=(float)((CV_MAT_ELEM(*out,data_type,kp+1,lm)-CV_MAT_ELEM(*out,data_type,km-1,lm)))*2.0f;
-                                 } else {
-                                    gradI.y=(float)((CV_MAT_ELEM(*out,data_type,kp+1,lm)-CV_MAT_ELEM(*out,data_type,km,lm)));
-                                 }
-                              } else {
-                                 if (CV_MAT_ELEM(*f,uchar,k-1,l)!=INSIDE) {
-                                    gradI.y=(float)((CV_MAT_ELEM(*out,data_type,kp,lm)-CV_MAT_ELEM(*out,data_type,km-1,lm)));
-                                 } else {
-                                    gradI.y=0;
-                                 }
-                              }
-                              Ia += (float)w * (float)(CV_MAT_ELEM(*out,data_type,km,lm));
-                              Jx -= (float)w * (float)(gradI.x*r.x);
-                              Jy -= (float)w * (float)(gradI.y*r.y);
-                              s  += w;
-                           }
+                        if (CV_MAT_ELEM(*f,uchar,k-1,l)!=INSIDE) {
+                           gradI.y=(float)((CV_MAT_ELEM(*out,data_type,kp,lm)-CV_MAT_ELEM(*out,data_type,km-1,lm)));
+                        } else {
+                           gradI.y=0;
                         }
                      }
-                  }
-                  sat = (float)((Ia/s+(Jx+Jy)/(sqrt(Jx*Jx+Jy*Jy)+1.0e-20f)+0.5f));
-                  {
-                  CV_MAT_ELEM(*out,data_type,i-1,j-1) = cv::saturate_cast<data_type>(sat);
+                     Ia += (float)w * (float)(CV_MAT_ELEM(*out,data_type,km,lm));
+                     Jx -= (float)w * (float)(gradI.x*r.x);
+                     Jy -= (float)w * (float)(gradI.y*r.y);
+                     s  += w;
                   }
                }
-
-               CV_MAT_ELEM(*f,uchar,i,j) = BAND;
-               Heap->Push(i,j,dist);
             }
          }
+         sat = (float)((Ia/s+(Jx+Jy)/(sqrt(Jx*Jx+Jy*Jy)+1.0e-20f)+0.5f));
+         {
+         CV_MAT_ELEM(*out,data_type,i-1,j-1) = cv::saturate_cast<data_type>(sat);
+         }
       }
    }
 }
 
 template <typename data_type>
 static void
-icvNSInpaintFMM(const CvMat *f, CvMat *t, CvMat *out, int range, CvPriorityQueueFloat *Heap) {
-   int i = 0, j = 0, ii = 0, jj = 0, k, l, q, color = 0;
-   float dist;
+icvNSInpaintPoint(const CvMat *f, const CvMat *t, CvMat *out, int range, int i, int j) {
+   int k, l, color = 0;
 
    if (CV_MAT_CN(out->type)==3) {
-
-      while (Heap->Pop(&ii,&jj)) {
-
-         CV_MAT_ELEM(*f,uchar,ii,jj) = KNOWN;
-         for(q=0; q<4; q++) {
-            if     (q==0) {i=ii-1; j=jj;}
-            else if(q==1) {i=ii;   j=jj-1;}
-            else if(q==2) {i=ii+1; j=jj;}
-            else if(q==3) {i=ii;   j=jj+1;}
-            if ((i<=1)||(j<=1)||(i>t->rows-1)||(j>t->cols-1)) continue;
-
-            if (CV_MAT_ELEM(*f,uchar,i,j)==INSIDE) {
-               dist = min4(FastMarching_solve(i-1,j,i,j-1,f,t),
-                           FastMarching_solve(i+1,j,i,j-1,f,t),
-                           FastMarching_solve(i-1,j,i,j+1,f,t),
-                           FastMarching_solve(i+1,j,i,j+1,f,t));
-               CV_MAT_ELEM(*t,float,i,j) = dist;
-
-               for (color=0; color<=2; color++) {
-                  CvPoint2D32f gradI,r;
-                  float Ia=0,s=1.0e-20f,w,dst,dir;
-
-                  for (k=i-range; k<=i+range; k++) {
-                     int km=k-1+(k==1),kp=k-1-(k==f->rows-2);
-                     for (l=j-range; l<=j+range; l++) {
-                        int lm=l-1+(l==1),lp=l-1-(l==f->cols-2);
-                        if (k>0&&l>0&&k<f->rows-1&&l<f->cols-1) {
-                           if ((CV_MAT_ELEM(*f,uchar,k,l)!=INSIDE)&&
-                               ((l-j)*(l-j)+(k-i)*(k-i)<=range*range)) {
-                              r.y=(float)(k-i);
-                              r.x=(float)(l-j);
-
-                              dst = 1/(VectorLength(r)*VectorLength(r)+1);
-
-                              if (CV_MAT_ELEM(*f,uchar,k+1,l)!=INSIDE) {
-                                 if (CV_MAT_ELEM(*f,uchar,k-1,l)!=INSIDE) {
-                                    gradI.x=(float)(abs(CV_MAT_3COLOR_ELEM(*out,uchar,kp+1,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,kp,lm,color))+
-                                                    abs(CV_MAT_3COLOR_ELEM(*out,uchar,kp,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km-1,lm,color)));
-                                 } else {
-                                    gradI.x=(float)(abs(CV_MAT_3COLOR_ELEM(*out,uchar,kp+1,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,kp,lm,color)))*2.0f;
-                                 }
-                              } else {
-                                 if (CV_MAT_ELEM(*f,uchar,k-1,l)!=INSIDE) {
-                                    gradI.x=(float)(abs(CV_MAT_3COLOR_ELEM(*out,uchar,kp,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km-1,lm,color)))*2.0f;
-                                 } else {
-                                    gradI.x=0;
-                                 }
-                              }
-                              if (CV_MAT_ELEM(*f,uchar,k,l+1)!=INSIDE) {
-                                 if (CV_MAT_ELEM(*f,uchar,k,l-1)!=INSIDE) {
-                                    gradI.y=(float)(abs(CV_MAT_3COLOR_ELEM(*out,uchar,km,lp+1,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km,lm,color))+
-                                                    abs(CV_MAT_3COLOR_ELEM(*out,uchar,km,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km,lm-1,color)));
-                                 } else {
-                                    gradI.y=(float)(abs(CV_MAT_3COLOR_ELEM(*out,uchar,km,lp+1,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km,lm,color)))*2.0f;
-                                 }
-                              } else {
-                                 if (CV_MAT_ELEM(*f,uchar,k,l-1)!=INSIDE) {
-                                    gradI.y=(float)(abs(CV_MAT_3COLOR_ELEM(*out,uchar,km,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km,lm-1,color)))*2.0f;
-                                 } else {
-                                    gradI.y=0;
-                                 }
-                              }
-
-                              gradI.x=-gradI.x;
-                              dir=VectorScalMult(r,gradI);
-
-                              if (fabs(dir)<=0.01) {
-                                 dir=0.000001f;
-                              } else {
-                                 dir = (float)fabs(VectorScalMult(r,gradI)/sqrt(VectorLength(r)*VectorLength(gradI)));
-                              }
-                              w = dst*dir;
-                              Ia += (float)w * (float)(CV_MAT_3COLOR_ELEM(*out,uchar,km,lm,color));
-                              s  += w;
-                           }
+      for (color=0; color<=2; color++) {
+         CvPoint2D32f gradI,r;
+         float Ia=0,s=1.0e-20f,w,dst,dir;
+
+         for (k=i-range; k<=i+range; k++) {
+            int km=k-1+(k==1),kp=k-1-(k==f->rows-2);
+            for (l=j-range; l<=j+range; l++) {
+               int lm=l-1+(l==1),lp=l-1-(l==f->cols-2);
+               if (k>0&&l>0&&k<f->rows-1&&l<f->cols-1) {
+                  if ((CV_MAT_ELEM(*f,uchar,k,l)!=INSIDE)&&
+                      ((l-j)*(l-j)+(k-i)*(k-i)<=range*range)) {
+                     r.y=(float)(k-i);
+                     r.x=(float)(l-j);
+
+                     dst = 1/(VectorLength(r)*VectorLength(r)+1);
+
+                     if (CV_MAT_ELEM(*f,uchar,k+1,l)!=INSIDE) {
+                        if (CV_MAT_ELEM(*f,uchar,k-1,l)!=INSIDE) {
+                           gradI.x=(float)(abs(CV_MAT_3COLOR_ELEM(*out,uchar,kp+1,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,kp,lm,color))+
+                                           abs(CV_MAT_3COLOR_ELEM(*out,uchar,kp,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km-1,lm,color)));
+                        } else {
+                           gradI.x=(float)(abs(CV_MAT_3COLOR_ELEM(*out,uchar,kp+1,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,kp,lm,color)))*2.0f;
+                        }
+                     } else {
+                        if (CV_MAT_ELEM(*f,uchar,k-1,l)!=INSIDE) {
+                           gradI.x=(float)(abs(CV_MAT_3COLOR_ELEM(*out,uchar,kp,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km-1,lm,color)))*2.0f;
+                        } else {
+                           gradI.x=0;
+                        }
+                     }
+                     if (CV_MAT_ELEM(*f,uchar,k,l+1)!=INSIDE) {
+                        if (CV_MAT_ELEM(*f,uchar,k,l-1)!=INSIDE) {
+                           gradI.y=(float)(abs(CV_MAT_3COLOR_ELEM(*out,uchar,km,lp+1,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km,lm,color))+
+                                           abs(CV_MAT_3COLOR_ELEM(*out,uchar,km,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km,lm-1,color)));
+                        } else {
+                           gradI.y=(float)(abs(CV_MAT_3COLOR_ELEM(*out,uchar,km,lp+1,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km,lm,color)))*2.0f;
+                        }
+                     } else {
+                        if (CV_MAT_ELEM(*f,uchar,k,l-1)!=INSIDE) {
+                           gradI.y=(float)(abs(CV_MAT_3COLOR_ELEM(*out,uchar,km,lm,color)-CV_MAT_3COLOR_ELEM(*out,uchar,km,lm-1,color)))*2.0f;
+                        } else {
+                           gradI.y=0;
                         }
                      }
+
+                     gradI.x=-gradI.x;
+                     dir=VectorScalMult(r,gradI);
+
+                     if (fabs(dir)<=0.01) {
+                        dir=0.000001f;
+                     } else {
+                        dir = (float)fabs(VectorScalMult(r,gradI)/sqrt(VectorLength(r)*VectorLength(gradI)));
+                     }
+                     w = dst*dir;
+                     Ia += (float)w * (float)(CV_MAT_3COLOR_ELEM(*out,uchar,km,lm,color));
+                     s  += w;
                   }
-                  CV_MAT_3COLOR_ELEM(*out,uchar,i-1,j-1,color) = cv::saturate_cast<uchar>((double)Ia/s);
                }
-
-               CV_MAT_ELEM(*f,uchar,i,j) = BAND;
-               Heap->Push(i,j,dist);
             }
          }
+         CV_MAT_3COLOR_ELEM(*out,uchar,i-1,j-1,color) = cv::saturate_cast<uchar>((double)Ia/s);
       }
-
    } else if (CV_MAT_CN(out->type)==1) {
-
-      while (Heap->Pop(&ii,&jj)) {
-
-         CV_MAT_ELEM(*f,uchar,ii,jj) = KNOWN;
-         for(q=0; q<4; q++) {
-            if     (q==0) {i=ii-1; j=jj;}
-            else if(q==1) {i=ii;   j=jj-1;}
-            else if(q==2) {i=ii+1; j=jj;}
-            else if(q==3) {i=ii;   j=jj+1;}
-            if ((i<=1)||(j<=1)||(i>t->rows-1)||(j>t->cols-1)) continue;
-
-            if (CV_MAT_ELEM(*f,uchar,i,j)==INSIDE) {
-               dist = min4(FastMarching_solve(i-1,j,i,j-1,f,t),
-                           FastMarching_solve(i+1,j,i,j-1,f,t),
-                           FastMarching_solve(i-1,j,i,j+1,f,t),
-                           FastMarching_solve(i+1,j,i,j+1,f,t));
-               CV_MAT_ELEM(*t,float,i,j) = dist;
-
-               {
-                  CvPoint2D32f gradI,r;
-                  float Ia=0,s=1.0e-20f,w,dst,dir;
-
-                  for (k=i-range; k<=i+range; k++) {
-                     int km=k-1+(k==1),kp=k-1-(k==t->rows-2);
-                     for (l=j-range; l<=j+range; l++) {
-                        int lm=l-1+(l==1),lp=l-1-(l==t->cols-2);
-                        if (k>0&&l>0&&k<t->rows-1&&l<t->cols-1) {
-                           if ((CV_MAT_ELEM(*f,uchar,k,l)!=INSIDE)&&
-                               ((l-j)*(l-j)+(k-i)*(k-i)<=range*range)) {
-                              r.y=(float)(i-k);
-                              r.x=(float)(j-l);
-
-                              dst = 1/(VectorLength(r)*VectorLength(r)+1);
-
-                              if (CV_MAT_ELEM(*f,uchar,k+1,l)!=INSIDE) {
-                                 if (CV_MAT_ELEM(*f,uchar,k-1,l)!=INSIDE) {
-                                    gradI.x=(float)(std::abs(CV_MAT_ELEM(*out,data_type,kp+1,lm)-CV_MAT_ELEM(*out,data_type,kp,lm))+
-                                                    std::abs(CV_MAT_ELEM(*out,data_type,kp,lm)-CV_MAT_ELEM(*out,data_type,km-1,lm)));
-                                 } else {
-                                    gradI.x=(float)(std::abs(CV_MAT_ELEM(*out,data_type,kp+1,lm)-CV_MAT_ELEM(*out,data_type,kp,lm)))*2.0f;
-                                 }
-                              } else {
-                                 if (CV_MAT_ELEM(*f,uchar,k-1,l)!=INSIDE) {
-                                    gradI.x=(float)(std::abs(CV_MAT_ELEM(*out,data_type,kp,lm)-CV_MAT_ELEM(*out,data_type,km-1,lm)))*2.0f;
-                                 } else {
-                                    gradI.x=0;
-                                 }
-                              }
-                              if (CV_MAT_ELEM(*f,uchar,k,l+1)!=INSIDE) {
-                                 if (CV_MAT_ELEM(*f,uchar,k,l-1)!=INSIDE) {
-                                    gradI.y=(float)(std::abs(CV_MAT_ELEM(*out,data_type,km,lp+1)-CV_MAT_ELEM(*out,data_type,km,lm))+
-                                                    std::abs(CV_MAT_ELEM(*out,data_type,km,lm)-CV_MAT_ELEM(*out,data_type,km,lm-1)));
-                                 } else {
-                                    gradI.y=(float)(std::abs(CV_MAT_ELEM(*out,data_type,km,lp+1)-CV_MAT_ELEM(*out,data_type,km,lm)))*2.0f;
-                                 }
-                              } else {
-                                 if (CV_MAT_ELEM(*f,uchar,k,l-1)!=INSIDE) {
-                                    gradI.y=(float)(std::abs(CV_MAT_ELEM(*out,data_type,km,lm)-CV_MAT_ELEM(*out,data_type,km,lm-1)))*2.0f;
-                                 } else {
-                                    gradI.y=0;
-                                 }
-                              }
-
-                              gradI.x=-gradI.x;
-                              dir=VectorScalMult(r,gradI);
-
-                              if (fabs(dir)<=0.01) {
-                                 dir=0.000001f;
-                              } else {
-                                 dir = (float)fabs(VectorScalMult(r,gradI)/sqrt(VectorLength(r)*VectorLength(gradI)));
-                              }
-                              w = dst*dir;
-                              Ia += (float)w * (float)(CV_MAT_ELEM(*out,data_type,km,lm));
-                              s  += w;
-                           }
+      {
+         CvPoint2D32f gradI,r;
+         float Ia=0,s=1.0e-20f,w,dst,dir;
+
+         for (k=i-range; k<=i+range; k++) {
+            int km=k-1+(k==1),kp=k-1-(k==t->rows-2);
+            for (l=j-range; l<=j+range; l++) {
+               int lm=l-1+(l==1),lp=l-1-(l==t->cols-2);
+               if (k>0&&l>0&&k<t->rows-1&&l<t->cols-1) {
+                  if ((CV_MAT_ELEM(*f,uchar,k,l)!=INSIDE)&&
+                      ((l-j)*(l-j)+(k-i)*(k-i)<=range*range)) {
+                     r.y=(float)(i-k);
+                     r.x=(float)(j-l);
+
+                     dst = 1/(VectorLength(r)*VectorLength(r)+1);
+
+                     if (CV_MAT_ELEM(*f,uchar,k+1,l)!=INSIDE) {
+                        if (CV_MAT_ELEM(*f,uchar,k-1,l)!=INSIDE) {
+                           gradI.x=(float)(std::abs(CV_MAT_ELEM(*out,data_type,kp+1,lm)-CV_MAT_ELEM(*out,data_type,kp,lm))+
+                                           std::abs(CV_MAT_ELEM(*out,data_type,kp,lm)-CV_MAT_ELEM(*out,data_type,km-1,lm)));
+                        } else {
+                           gradI.x=(float)(std::abs(CV_MAT_ELEM(*out,data_type,kp+1,lm)-CV_MAT_ELEM(*out,data_type,kp,lm)))*2.0f;
+                        }
+                     } else {
+                        if (CV_MAT_ELEM(*f,uchar,k-1,l)!=INSIDE) {
+                           gradI.x=(float)(std::abs(CV_MAT_ELEM(*out,data_type,kp,lm)-CV_MAT_ELEM(*out,data_type,km-1,lm)))*2.0f;
+                        } else {
+                           gradI.x=0;
                         }
                      }
+                     if (CV_MAT_ELEM(*f,uchar,k,l+1)!=INSIDE) {
+                        if (CV_MAT_ELEM(*f,uchar,k,l-1)!=INSIDE) {
+                           gradI.y=(float)(std::abs(CV_MAT_ELEM(*out,data_type,km,lp+1)-CV_MAT_ELEM(*out,data_type,km,lm))+
+                                           std::abs(CV_MAT_ELEM(*out,data_type,km,lm)-CV_MAT_ELEM(*out,data_type,km,lm-1)));
+                        } else {
+                           gradI.y=(float)(std::abs(CV_MAT_ELEM(*out,data_type,km,lp+1)-CV_MAT_ELEM(*out,data_type,km,lm)))*2.0f;
+                        }
+                     } else {
+                        if (CV_MAT_ELEM(*f,uchar,k,l-1)!=INSIDE) {
+                           gradI.y=(float)(std::abs(CV_MAT_ELEM(*out,data_type,km,lm)-CV_MAT_ELEM(*out,data_type,km,lm-1)))*2.0f;
+                        } else {
+                           gradI.y=0;
+                        }
+                     }
+
+                     gradI.x=-gradI.x;
+                     dir=VectorScalMult(r,gradI);
+
+                     if (fabs(dir)<=0.01) {
+                        dir=0.000001f;
+                     } else {
+                        dir = (float)fabs(VectorScalMult(r,gradI)/sqrt(VectorLength(r)*VectorLength(gradI)));
+                     }
+                     w = dst*dir;
+                     Ia += (float)w * (float)(CV_MAT_ELEM(*out,data_type,km,lm));
+                     s  += w;
                   }
-                  CV_MAT_ELEM(*out,data_type,i-1,j-1) = cv::saturate_cast<data_type>((double)Ia/s);
                }
-
-               CV_MAT_ELEM(*f,uchar,i,j) = BAND;
-               Heap->Push(i,j,dist);
             }
          }
+         CV_MAT_ELEM(*out,data_type,i-1,j-1) = cv::saturate_cast<data_type>((double)Ia/s);
       }
+   }
+}
 
+// inpaints the pixels in the order of the fast marching, the states of the pixels and their distances
+// to the band change as they did in the marching
+template <typename data_type, bool telea>
+static void
+icvInpaintInOrder(const CvMat *f, CvMat *t, CvMat *out, int range, const std::vector<CvInpaintStep>& order) {
+   for (size_t n = 0; n < order.size(); n++) {
+      int i = order[n].i, j = order[n].j;
+      CV_MAT_ELEM(*t,float,i,j) = order[n].T;
+      if (telea)
+         icvTeleaInpaintPoint<data_type>(f,t,out,range,i,j);
+      else
+         icvNSInpaintPoint<data_type>(f,t,out,range,i,j);
+      CV_MAT_ELEM(*f,uchar,i,j) = BAND;
    }
 }
 
@@ -728,13 +633,109 @@ template<> void cv::DefaultDeleter<IplConvKernel>::operator ()(IplConvKernel* ob
 }
 }
 
+// the inpainting order of the last mask
+struct CvInpaintOrder
+{
+    CvInpaintOrder() : range(-1), flags(-1) {}
+
+    int range, flags;
+    cv::Mat f, t;   // the states of the pixels and their distances to the band before the inpainting
+    std::vector<std::vector<CvInpaintStep> > groups;
+};
+
+// every thread keeps the states and the distances of all the pixels of its last mask (5 bytes per pixel)
+// and the marching order, so the order of larger images is not cached
+static const int INPAINT_ORDER_CACHE_MAX_PIXELS = 1 << 21;
+
+static cv::TLSData<CvInpaintOrder>& getInpaintOrderCache()
+{
+    static cv::TLSData<CvInpaintOrder>* instance = new cv::TLSData<CvInpaintOrder>();
+    return *instance;
+}
+
+// marches through the unknown pixels of every group of the mask regions, the pixels of different
+// groups are more than 2*(range+2) pixels apart, so their inpainting never reads each other's results
+static bool
+icvPrepareInpaintOrder(const CvMat* mask, int range, int flags, CvInpaintOrder& order)
+{
+    cv::Ptr<CvMat> band, t, out;
+    cv::Ptr<CvPriorityQueueFloat> Out;
+    cv::Ptr<IplConvKernel> el_cross, el_range;
+    int erows = mask->rows, ecols = mask->cols;
+
+    order.groups.clear();
+
+    t.reset(cvCreateMat(erows, ecols, CV_32FC1));
+    band.reset(cvCreateMat(erows, ecols, CV_8UC1));
+    el_cross.reset(cvCreateStructuringElementEx(3,3,1,1,CV_SHAPE_CROSS,NULL));
+
+    cvSet(t,cvScalar(1.0e6f,0,0,0));
+    cvDilate(mask,band,el_cross,1);   // image with narrow band
+    if (cvCountNonZero(band) == 0)
+        return false;
+    cvSub(band,mask,band,NULL);
+    SET_BORDER1_C1(band,uchar,0);
+    cvSet(t,cvScalar(0,0,0,0),band);
+
+    if( flags == cv::INPAINT_TELEA )
+    {
+        out.reset(cvCreateMat(erows, ecols, CV_8UC1));
+        el_range.reset(cvCreateStructuringElementEx(2*range+1,2*range+1,
+            range,range,CV_SHAPE_RECT,NULL));
+        cvDilate(mask,out,el_range,1);
+        cvSub(out,mask,out,NULL);
+        Out=cv::makePtr<CvPriorityQueueFloat>();
+        if (!Out->Init(out))
+            return false;
+        if (!Out->Add(band))
+            return false;
+        cvSub(out,band,out,NULL);
+        SET_BORDER1_C1(out,uchar,0);
+        icvCalcFMM(out,t,Out,true);
+    }
+
+    cv::Mat mask_mat = cv::cvarrToMat(mask), band_mat = cv::cvarrToMat(band);
+    order.f = mask_mat.clone();
+    order.t = cv::cvarrToMat(t).clone();
+
+    int gap = range + 2;
+    cv::Mat near_mask, labels;
+    cv::dilate(mask_mat, near_mask, cv::getStructuringElement(cv::MORPH_RECT, cv::Size(2*gap+1, 2*gap+1)));
+    int ngroups = cv::connectedComponents(near_mask, labels, 8, CV_32S) - 1;
+
+    // the band of every group in the raster order, as the whole band is pushed to the heap
+    std::vector<std::vector<cv::Point> > group_bands(ngroups);
+    for( int i = 0; i < erows; i++ )
+    {
+        const uchar* band_row = band_mat.ptr<uchar>(i);
+        const int* label_row = labels.ptr<int>(i);
+        for( int j = 0; j < ecols; j++ )
+            if( band_row[j] != 0 )
+                group_bands[label_row[j] - 1].push_back(cv::Point(j, i));
+    }
+
+    // the marching changes the states and the distances of the pixels of its own group only
+    cv::Mat f_mat = order.f.clone();
+    CvMat f_hdr = f_mat;
+    order.groups.resize(ngroups);
+    cv::parallel_for_(cv::Range(0, ngroups), [&](const cv::Range& r)
+    {
+        for( int g = r.start; g < r.end; g++ )
+        {
+            CvPriorityQueueFloat GroupHeap;
+            for( size_t n = 0; n < group_bands[g].size(); n++ )
+                GroupHeap.Push(group_bands[g][n].y, group_bands[g][n].x, 0);
+            icvCalcInpaintOrder(&f_hdr, t, &GroupHeap, order.groups[g]);
+        }
+    }, (double)ngroups);
+    return true;
+}
+
 void
 cvInpaint( const CvArr* _input_img, const CvArr* _inpaint_mask, CvArr* _output_img,
            double inpaintRange, int flags )
 {
-    cv::Ptr<CvMat> mask, band, f, t, out;
-    cv::Ptr<CvPriorityQueueFloat> Heap, Out;
-    cv::Ptr<IplConvKernel> el_cross, el_range;
+    cv::Ptr<CvMat> mask;
 
     CvMat input_hdr, mask_hdr, output_hdr;
     CvMat* input_img, *inpaint_mask, *output_img;
@@ -765,78 +766,65 @@ cvInpaint( const CvArr* _input_img, const CvArr* _inpaint_mask, CvArr* _output_i
     ecols = input_img->cols + 2;
     erows = input_img->rows + 2;
 
-    f.reset(cvCreateMat(erows, ecols, CV_8UC1));
-    t.reset(cvCreateMat(erows, ecols, CV_32FC1));
-    band.reset(cvCreateMat(erows, ecols, CV_8UC1));
+    if( flags != cv::INPAINT_TELEA && flags != cv::INPAINT_NS )
+        CV_Error( cv::Error::StsBadArg, "The flags argument must be one of CV_INPAINT_TELEA or CV_INPAINT_NS" );
+
     mask.reset(cvCreateMat(erows, ecols, CV_8UC1));
-    el_cross.reset(cvCreateStructuringElementEx(3,3,1,1,CV_SHAPE_CROSS,NULL));
 
     cvCopy( input_img, output_img );
     cvSet(mask,cvScalar(KNOWN,0,0,0));
     COPY_MASK_BORDER1_C1(inpaint_mask,mask,uchar);
     SET_BORDER1_C1(mask,uchar,0);
-    cvSet(f,cvScalar(KNOWN,0,0,0));
-    cvSet(t,cvScalar(1.0e6f,0,0,0));
-    cvDilate(mask,band,el_cross,1);   // image with narrow band
-    Heap=cv::makePtr<CvPriorityQueueFloat>();
-    if (!Heap->Init(band))
-        return;
-    cvSub(band,mask,band,NULL);
-    SET_BORDER1_C1(band,uchar,0);
-    if (!Heap->Add(band))
-        return;
-    cvSet(f,cvScalar(BAND,0,0,0),band);
-    cvSet(f,cvScalar(INSIDE,0,0,0),mask);
-    cvSet(t,cvScalar(0,0,0,0),band);
 
-    if( flags == cv::INPAINT_TELEA )
+    // the marching only depends on the mask, so it is skipped when the same mask is inpainted again
+    CvInpaintOrder& cached_order = getInpaintOrderCache().getRef(), local_order;
+    bool use_cache = (int64)erows * ecols <= INPAINT_ORDER_CACHE_MAX_PIXELS;
+    if( !use_cache )
+        cached_order = CvInpaintOrder();
+    CvInpaintOrder& order = use_cache ? cached_order : local_order;
+    cv::Mat mask_mat = cv::cvarrToMat(mask);
+    if( order.range != range || order.flags != flags || order.f.size() != mask_mat.size() ||
+        cv::norm(order.f, mask_mat, cv::NORM_INF) != 0 )
     {
-        out.reset(cvCreateMat(erows, ecols, CV_8UC1));
-        el_range.reset(cvCreateStructuringElementEx(2*range+1,2*range+1,
-            range,range,CV_SHAPE_RECT,NULL));
-        cvDilate(mask,out,el_range,1);
-        cvSub(out,mask,out,NULL);
-        Out=cv::makePtr<CvPriorityQueueFloat>();
-        if (!Out->Init(out))
-            return;
-        if (!Out->Add(band))
+        order.range = -1;
+        if( !icvPrepareInpaintOrder(mask, range, flags, order) )
             return;
-        cvSub(out,band,out,NULL);
-        SET_BORDER1_C1(out,uchar,0);
-        icvCalcFMM(out,t,Out,true);
-        switch(CV_MAT_DEPTH(output_img->type))
-        {
-            case CV_8U:
-                icvTeleaInpaintFMM<uchar>(mask,t,output_img,range,Heap);
-                break;
-            case CV_16U:
-                icvTeleaInpaintFMM<ushort>(mask,t,output_img,range,Heap);
-                break;
-            case CV_32F:
-                icvTeleaInpaintFMM<float>(mask,t,output_img,range,Heap);
-                break;
-            default:
-                CV_Error( cv::Error::StsBadArg, "Unsupportedformat of the input image" );
-        }
+        order.range = range;
+        order.flags = flags;
     }
-    else if (flags == cv::INPAINT_NS) {
-        switch(CV_MAT_DEPTH(output_img->type))
+    if( order.groups.empty() )
+        return;
+
+    cv::Mat f_mat = order.f.clone(), t_mat = order.t.clone();
+    CvMat f_hdr = f_mat, t_hdr = t_mat;
+    const std::vector<std::vector<CvInpaintStep> >& groups = order.groups;
+    int depth = CV_MAT_DEPTH(output_img->type);
+
+    // the groups are far enough from each other to be inpainted independently
+    cv::parallel_for_(cv::Range(0, (int)groups.size()), [&](const cv::Range& r)
+    {
+        for( int g = r.start; g < r.end; g++ )
         {
-            case CV_8U:
-                icvNSInpaintFMM<uchar>(mask,t,output_img,range,Heap);
-                break;
-            case CV_16U:
-                icvNSInpaintFMM<ushort>(mask,t,output_img,range,Heap);
-                break;
-            case CV_32F:
-                icvNSInpaintFMM<float>(mask,t,output_img,range,Heap);
-                break;
-            default:
-                CV_Error( cv::Error::StsBadArg, "Unsupported format of the input image" );
+            if( flags == cv::INPAINT_TELEA )
+            {
+                if( depth == CV_8U )
+                    icvInpaintInOrder<uchar,true>(&f_hdr,&t_hdr,output_img,range,groups[g]);
+                else if( depth == CV_16U )
+                    icvInpaintInOrder<ushort,true>(&f_hdr,&t_hdr,output_img,range,groups[g]);
+                else
+                    icvInpaintInOrder<float,true>(&f_hdr,&t_hdr,output_img,range,groups[g]);
+            }
+            else
+            {
+                if( depth == CV_8U )
+                    icvInpaintInOrder<uchar,false>(&f_hdr,&t_hdr,output_img,range,groups[g]);
+                else if( depth == CV_16U )
+                    icvInpaintInOrder<ushort,false>(&f_hdr,&t_hdr,output_img,range,groups[g]);
+                else
+                    icvInpaintInOrder<float,false>(&f_hdr,&t_hdr,output_img,range,groups[g]);
+            }
         }
-    } else {
-        CV_Error( cv::Error::StsBadArg, "The flags argument must be one of CV_INPAINT_TELEA or CV_INPAINT_NS" );
-    }
+    }, (double)groups.size());
 }
 
 void cv::inpaint( InputArray _src, InputArray _mask, OutputArray _dst,
@@ -47,6 +47,88 @@
 namespace cv
 {
 
+// the images are processed in parallel stripes of rows of about this many pixels
+static double mergeStripes(const Size& size)
+{
+    return std::max(1.0, size.area() / (double)(1 << 16));
+}
+
+// the rows of pyrDown(src) computed from the source rows they depend on, dst has the size of the whole result
+// when all its rows are computed
+static void pyrDownRows(const Mat& src, const Range& rows, Mat& dst)
+{
+    if(rows.start == 0 && rows.end == dst.rows) {
+        pyrDown(src, dst, dst.size());
+        return;
+    }
+    int y0 = std::max(rows.start*2 - 2, 0), y1 = std::min(rows.end*2 + 1, src.rows);
+    Mat stripe;
+    pyrDown(src.rowRange(y0, y1), stripe);
+    stripe.rowRange(rows.start - y0/2, rows.end - y0/2).copyTo(dst);
+}
+
+// the rows of pyrUp(src, dsize) computed from the source rows they depend on
+static void pyrUpRows(const Mat& src, const Size& dsize, const Range& rows, Mat& dst)
+{
+    if(rows.start == 0 && rows.end == dsize.height) {
+        pyrUp(src, dst, dsize);
+        return;
+    }
+    int y0 = std::max(rows.start/2 - 1, 0), y1 = std::min((rows.end - 1)/2 + 2, src.rows);
+    int height = y1 == src.rows ? dsize.height - y0*2 : (y1 - y0)*2;
+    Mat stripe;
+    pyrUp(src.rowRange(y0, y1), stripe, Size(dsize.width, height));
+    stripe.rowRange(rows.start - y0*2, rows.end - y0*2).copyTo(dst);
+}
+
+static void buildPyramidStripes(const Mat& src, std::vector<Mat>& pyr, int maxlevel)
+{
+    pyr.resize(maxlevel + 1);
+    pyr[0] = src;
+    for(int lvl = 1; lvl <= maxlevel; lvl++) {
+        const Mat& prev = pyr[lvl - 1];
+        Mat& cur = pyr[lvl];
+        cur.create((prev.rows + 1)/2, (prev.cols + 1)/2, prev.type());
+        parallel_for_(Range(0, cur.rows), [&](const Range& r) {
+            Mat dst = cur.rowRange(r);
+            pyrDownRows(prev, r, dst);
+        }, mergeStripes(cur.size()));
+    }
+}
+
+// calls body(lvl, rows) for the stripes of rows of all the pyramid levels at once
+template<typename Body>
+static void parallelForPyramid(const std::vector<Mat>& pyr, const Body& body)
+{
+    int nlevels = (int)pyr.size();
+    std::vector<int> offsets(nlevels + 1, 0);
+    Size total(pyr[0].cols, 0);
+    for(int lvl = 0; lvl < nlevels; lvl++) {
+        offsets[lvl + 1] = offsets[lvl] + pyr[lvl].rows;
+        total.height += pyr[lvl].rows;
+    }
+    parallel_for_(Range(0, offsets[nlevels]), [&](const Range& r) {
+        for(int lvl = 0; lvl < nlevels; lvl++) {
+            int y0 = std::max(r.start, offsets[lvl]), y1 = std::min(r.end, offsets[lvl + 1]);
+            if(y0 < y1) {
+                body(lvl, Range(y0 - offsets[lvl], y1 - offsets[lvl]));
+            }
+        }
+    }, mergeStripes(total));
+}
+
+// adds the upsampled coarser levels to the finer ones, starting from the coarsest level
+static void collapsePyramid(std::vector<Mat>& pyr)
+{
+    for(int lvl = (int)pyr.size() - 1; lvl > 0; lvl--) {
+        parallel_for_(Range(0, pyr[lvl - 1].rows), [&](const Range& r) {
+            Mat up, dst = pyr[lvl - 1].rowRange(r);
+            pyrUpRows(pyr[lvl], pyr[lvl - 1].size(), r, up);
+            dst += up;
+        }, mergeStripes(pyr[lvl - 1].size()));
+    }
+}
+
 class MergeDebevecImpl CV_FINAL : public MergeDebevec
 {
 public:
@@ -68,13 +150,66 @@ public:
         checkImageDimensions(images);
         CV_Assert(images[0].depth() == CV_8U);
 
-        int channels = images[0].channels();
-        Size size = images[0].size();
-        int CV_32FCC = CV_MAKETYPE(CV_32F, channels);
+        Mat log_response = logResponse(input_response, images[0].channels());
 
-        dst.create(images[0].size(), CV_32FCC);
+        Mat exp_values(times.clone());
+        log(exp_values, exp_values);
+
+        clear();
+        for(size_t i = 0; i < images.size(); i++) {
+            accumulate(images[i], exp_values.at<float>((int)i), log_response);
+        }
+        finish(dst);
+    }
+
+    void process(InputArrayOfArrays src, OutputArray dst, InputArray times) CV_OVERRIDE
+    {
+        CV_INSTRUMENT_REGION()
+
+        process(src, dst, times, Mat());
+    }
+
+    void feed(InputArray src, float time, InputArray input_response) CV_OVERRIDE
+    {
+        CV_INSTRUMENT_REGION()
+
+        Mat image = src.getMat();
+        CV_Assert(image.depth() == CV_8U);
+        if(!weight_sum.empty()) {
+            CV_Assert(image.size() == weight_sum.size() && image.channels() == (int)result_split.size());
+        }
+
+        Mat exp_value(1, 1, CV_32F, Scalar(time));
+        log(exp_value, exp_value);
+        accumulate(image, exp_value.at<float>(0), logResponse(input_response, image.channels()));
+    }
+
+    void finish(OutputArray dst) CV_OVERRIDE
+    {
+        CV_INSTRUMENT_REGION()
+
+        CV_Assert(!weight_sum.empty());
+        int channels = (int)result_split.size();
+
+        weight_sum = 1.0f / weight_sum;
+        for(int c = 0; c < channels; c++) {
+            result_split[c] = result_split[c].mul(weight_sum);
+        }
+        dst.create(weight_sum.size(), CV_MAKETYPE(CV_32F, channels));
         Mat result = dst.getMat();
+        merge(result_split, result);
+        exp(result, result);
+        clear();
+    }
 
+protected:
+    String name;
+    Mat weights;
+    std::vector<Mat> result_split;   // the weighted sums of the log irradiances of the burst
+    Mat weight_sum;
+
+    Mat logResponse(InputArray input_response, int channels) const
+    {
         Mat response = input_response.getMat();
 
         if(response.empty()) {
@@ -86,20 +221,34 @@ public:
         log(response, log_response);
         CV_Assert(log_response.rows == LDR_SIZE && log_response.cols == 1 &&
                   log_response.channels() == channels);
+        return log_response;
+    }
 
-        Mat exp_values(times.clone());
-        log(exp_values, exp_values);
+    void clear()
+    {
+        result_split.clear();
+        weight_sum.release();
+    }
 
-        result = Mat::zeros(size, CV_32FCC);
-        std::vector<Mat> result_split;
-        split(result, result_split);
-        Mat weight_sum = Mat::zeros(size, CV_32F);
+    void accumulate(const Mat& image, float exp_value, const Mat& log_response)
+    {
+        int channels = image.channels();
+        Size size = image.size();
 
-        for(size_t i = 0; i < images.size(); i++) {
+        if(weight_sum.empty()) {
+            result_split.resize(channels);
+            for(int c = 0; c < channels; c++) {
+                result_split[c] = Mat::zeros(size, CV_32F);
+            }
+            weight_sum = Mat::zeros(size, CV_32F);
+        }
+
+        parallel_for_(Range(0, size.height), [&](const Range& r) {
+            Mat img = image.rowRange(r);
             std::vector<Mat> splitted;
-            split(images[i], splitted);
+            split(img, splitted);
 
-            Mat w = Mat::zeros(size, CV_32F);
+            Mat w = Mat::zeros(img.size(), CV_32F);
             for(int c = 0; c < channels; c++) {
                 LUT(splitted[c], weights, splitted[c]);
                 w += splitted[c];
@@ -107,31 +256,16 @@ public:
             w /= channels;
 
             Mat response_img;
-            LUT(images[i], log_response, response_img);
+            LUT(img, log_response, response_img);
             split(response_img, splitted);
             for(int c = 0; c < channels; c++) {
-                result_split[c] += w.mul(splitted[c] - exp_values.at<float>((int)i));
+                Mat result_c = result_split[c].rowRange(r);
+                result_c += w.mul(splitted[c] - exp_value);
             }
-            weight_sum += w;
-        }
-        weight_sum = 1.0f / weight_sum;
-        for(int c = 0; c < channels; c++) {
-            result_split[c] = result_split[c].mul(weight_sum);
-        }
-        merge(result_split, result);
-        exp(result, result);
-    }
-
-    void process(InputArrayOfArrays src, OutputArray dst, InputArray times) CV_OVERRIDE
-    {
-        CV_INSTRUMENT_REGION()
-
-        process(src, dst, times, Mat());
+            Mat weight_sum_r = weight_sum.rowRange(r);
+            weight_sum_r += w;
+        }, mergeStripes(size));
     }
-
-protected:
-    String name;
-    Mat weights;
 };
 
 Ptr<MergeDebevec> createMergeDebevec()
@@ -168,33 +302,143 @@ public:
         int channels = images[0].channels();
         CV_Assert(channels == 1 || channels == 3);
         Size size = images[0].size();
-        int CV_32FCC = CV_MAKETYPE(CV_32F, channels);
 
         std::vector<Mat> weights(images.size());
         Mat weight_sum = Mat::zeros(size, CV_32F);
 
         for(size_t i = 0; i < images.size(); i++) {
-            Mat img, gray, contrast, saturation, wellexp;
-            std::vector<Mat> splitted(channels);
+            Mat img;
+            exposureWeights(images[i], img, weights[i]);
+            weight_sum += weights[i];
+        }
+        blend(images, weights, weight_sum, dst);
+    }
+
+    float getContrastWeight() const CV_OVERRIDE { return wcon; }
+    void setContrastWeight(float val) CV_OVERRIDE { wcon = val; }
 
+    float getSaturationWeight() const CV_OVERRIDE { return wsat; }
+    void setSaturationWeight(float val) CV_OVERRIDE { wsat = val; }
+
+    float getExposureWeight() const CV_OVERRIDE { return wexp; }
+    void setExposureWeight(float val) CV_OVERRIDE { wexp = val; }
+
+    void write(FileStorage& fs) const CV_OVERRIDE
+    {
+        writeFormat(fs);
+        fs << "name" << name
+           << "contrast_weight" << wcon
+           << "saturation_weight" << wsat
+           << "exposure_weight" << wexp;
+    }
+
+    void read(const FileNode& fn) CV_OVERRIDE
+    {
+        FileNode n = fn["name"];
+        CV_Assert(n.isString() && String(n) == name);
+        wcon = fn["contrast_weight"];
+        wsat = fn["saturation_weight"];
+        wexp = fn["exposure_weight"];
+    }
+
+protected:
+    String name;
+    float wcon, wsat, wexp;
+
+    // blends the Laplacian pyramids of the images with the Gaussian pyramids of their normalized weights,
+    // one image at a time. The images and weights that are no longer needed are released.
+    void blend(std::vector<Mat>& images, std::vector<Mat>& weights, const Mat& weight_sum, OutputArray dst) const
+    {
+        Size size = images[0].size();
+        int CV_32FCC = CV_MAKETYPE(CV_32F, images[0].channels());
+        int maxlevel = static_cast<int>(logf(static_cast<float>(min(size.width, size.height))) / logf(2.0f));
+        std::vector<Mat> res_pyr(maxlevel + 1);
+
+        for(size_t i = 0; i < images.size(); i++) {
+            Mat img, weight = weights[i];
             images[i].convertTo(img, CV_32F, 1.0f/255.0f);
+            images[i].release();
+            weights[i].release();
+            weight /= weight_sum;
+
+            std::vector<Mat> img_pyr, weight_pyr;
+            buildPyramidStripes(img, img_pyr, maxlevel);
+            buildPyramidStripes(weight, weight_pyr, maxlevel);
+
+            bool first = i == 0;
+            if(first) {
+                for(int lvl = 0; lvl <= maxlevel; lvl++) {
+                    res_pyr[lvl].create(img_pyr[lvl].size(), CV_32FCC);
+                }
+            }
+            parallelForPyramid(img_pyr, [&](int lvl, const Range& rows) {
+                Mat up;
+                if(lvl < maxlevel) {
+                    pyrUpRows(img_pyr[lvl + 1], img_pyr[lvl].size(), rows, up);
+                }
+                Mat res = res_pyr[lvl].rowRange(rows);
+                addWeightedLaplacian(img_pyr[lvl].rowRange(rows), up, weight_pyr[lvl].rowRange(rows), first, res);
+            });
+        }
+        collapsePyramid(res_pyr);
+        dst.create(size, CV_32FCC);
+        res_pyr[0].copyTo(dst);
+    }
+
+    // sum = (img - up) * weight, or sum += (img - up) * weight, per channel, where up is the upsampled coarser
+    // level or empty at the coarsest one
+    static void addWeightedLaplacian(const Mat& img, const Mat& up, const Mat& weight, bool first, Mat& sum)
+    {
+        int channels = img.channels();
+        for(int y = 0; y < img.rows; y++) {
+            const float* l = img.ptr<float>(y);
+            const float* u = up.empty() ? 0 : up.ptr<float>(y);
+            const float* w = weight.ptr<float>(y);
+            float* s = sum.ptr<float>(y);
+            for(int x = 0; x < img.cols; x++, l += channels, s += channels) {
+                for(int c = 0; c < channels; c++) {
+                    float v = (u ? l[c] - u[x*channels + c] : l[c]) * w[x];
+                    s[c] = first ? v : s[c] + v;
+                }
+            }
+        }
+    }
+
+    // the contrast, saturation and well-exposedness weight of every pixel, computed in stripes of rows
+    void exposureWeights(const Mat& image, Mat& img, Mat& weight) const
+    {
+        int channels = image.channels();
+        Size size = image.size();
+        img.create(size, CV_MAKETYPE(CV_32F, channels));
+        weight.create(size, CV_32F);
+
+        parallel_for_(Range(0, size.height), [&](const Range& r) {
+            // one more row on each side for the Laplacian
+            int top = std::max(r.start - 1, 0), bottom = std::min(r.end + 1, size.height);
+            Mat img_ext, gray_ext, contrast, saturation, wellexp;
+            std::vector<Mat> splitted(channels);
+
+            image.rowRange(top, bottom).convertTo(img_ext, CV_32F, 1.0f/255.0f);
             if(channels == 3) {
-                cvtColor(img, gray, COLOR_RGB2GRAY);
+                cvtColor(img_ext, gray_ext, COLOR_RGB2GRAY);
             } else {
-                img.copyTo(gray);
+                gray_ext = img_ext;
             }
-            split(img, splitted);
+            Mat stripe = img_ext.rowRange(r.start - top, r.end - top);
+            stripe.copyTo(img.rowRange(r));
+            split(stripe, splitted);
+            Size ssize = stripe.size();
 
-            Laplacian(gray, contrast, CV_32F);
+            Laplacian(gray_ext.rowRange(r.start - top, r.end - top), contrast, CV_32F);
             contrast = abs(contrast);
 
-            Mat mean = Mat::zeros(size, CV_32F);
+            Mat mean = Mat::zeros(ssize, CV_32F);
             for(int c = 0; c < channels; c++) {
                 mean += splitted[c];
             }
             mean /= channels;
 
-            saturation = Mat::zeros(size, CV_32F);
+            saturation = Mat::zeros(ssize, CV_32F);
             for(int c = 0; c < channels;  c++) {
                 Mat deviation = splitted[c] - mean;
                 pow(deviation, 2.0f, deviation);
@@ -202,7 +446,7 @@ public:
             }
             sqrt(saturation, saturation);
 
-            wellexp = Mat::ones(size, CV_32F);
+            wellexp = Mat::ones(ssize, CV_32F);
             for(int c = 0; c < channels; c++) {
                 Mat expo = splitted[c] - 0.5f;
                 pow(expo, 2.0f, expo);
@@ -215,83 +459,14 @@ public:
             pow(saturation, wsat, saturation);
             pow(wellexp, wexp, wellexp);
 
-            weights[i] = contrast;
+            Mat w = contrast;
             if(channels == 3) {
-                weights[i] = weights[i].mul(saturation);
-            }
-            weights[i] = weights[i].mul(wellexp) + 1e-12f;
-            weight_sum += weights[i];
-        }
-        int maxlevel = static_cast<int>(logf(static_cast<float>(min(size.width, size.height))) / logf(2.0f));
-        std::vector<Mat> res_pyr(maxlevel + 1);
-
-        for(size_t i = 0; i < images.size(); i++) {
-            weights[i] /= weight_sum;
-            Mat img;
-            images[i].convertTo(img, CV_32F, 1.0f/255.0f);
-
-            std::vector<Mat> img_pyr, weight_pyr;
-            buildPyramid(img, img_pyr, maxlevel);
-            buildPyramid(weights[i], weight_pyr, maxlevel);
-
-            for(int lvl = 0; lvl < maxlevel; lvl++) {
-                Mat up;
-                pyrUp(img_pyr[lvl + 1], up, img_pyr[lvl].size());
-                img_pyr[lvl] -= up;
+                w = w.mul(saturation);
             }
-            for(int lvl = 0; lvl <= maxlevel; lvl++) {
-                std::vector<Mat> splitted(channels);
-                split(img_pyr[lvl], splitted);
-                for(int c = 0; c < channels; c++) {
-                    splitted[c] = splitted[c].mul(weight_pyr[lvl]);
-                }
-                merge(splitted, img_pyr[lvl]);
-                if(res_pyr[lvl].empty()) {
-                    res_pyr[lvl] = img_pyr[lvl];
-                } else {
-                    res_pyr[lvl] += img_pyr[lvl];
-                }
-            }
-        }
-        for(int lvl = maxlevel; lvl > 0; lvl--) {
-            Mat up;
-            pyrUp(res_pyr[lvl], up, res_pyr[lvl - 1].size());
-            res_pyr[lvl - 1] += up;
-        }
-        dst.create(size, CV_32FCC);
-        res_pyr[0].copyTo(dst);
+            w = w.mul(wellexp) + 1e-12f;
+            w.copyTo(weight.rowRange(r));
+        }, mergeStripes(size));
     }
-
-    float getContrastWeight() const CV_OVERRIDE { return wcon; }
-    void setContrastWeight(float val) CV_OVERRIDE { wcon = val; }
-
-    float getSaturationWeight() const CV_OVERRIDE { return wsat; }
-    void setSaturationWeight(float val) CV_OVERRIDE { wsat = val; }
-
-    float getExposureWeight() const CV_OVERRIDE { return wexp; }
-    void setExposureWeight(float val) CV_OVERRIDE { wexp = val; }
-
-    void write(FileStorage& fs) const CV_OVERRIDE
-    {
-        writeFormat(fs);
-        fs << "name" << name
-           << "contrast_weight" << wcon
-           << "saturation_weight" << wsat
-           << "exposure_weight" << wexp;
-    }
-
-    void read(const FileNode& fn) CV_OVERRIDE
-    {
-        FileNode n = fn["name"];
-        CV_Assert(n.isString() && String(n) == name);
-        wcon = fn["contrast_weight"];
-        wsat = fn["saturation_weight"];
-        wexp = fn["exposure_weight"];
-    }
-
-protected:
-    String name;
-    float wcon, wsat, wexp;
 };
 
 Ptr<MergeMertens> createMergeMertens(float wcon, float wsat, float wexp)
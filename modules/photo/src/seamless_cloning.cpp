@@ -47,6 +47,40 @@
 using namespace std;
 using namespace cv;
 
+// a private copy of the mask, the cloning erodes and inverts it in place
+static Mat cloningMask(const Mat& mask)
+{
+    Mat gray;
+    if(mask.channels() == 3)
+        cvtColor(mask, gray, COLOR_BGR2GRAY );
+    else
+        mask.copyTo(gray);
+    return gray;
+}
+
+// bounding boxes of the patch in the source and the destination images
+static void cloningRois(const Mat& gray, Point p, Rect& roi_s, Rect& roi_d)
+{
+    roi_s = boundingRect(gray == 255);
+    roi_d = Rect(p.x - roi_s.width/2, p.y - roi_s.height/2, roi_s.width, roi_s.height);
+}
+
+// clones the patch into blend in place, only the pixels of roi_d are read and written
+static void seamlessCloneRoi(const Mat& src, const Mat& gray, const Rect& roi_s, const Rect& roi_d,
+                             Mat& blend, int flags)
+{
+    Mat destinationROI = blend(roi_d).clone();
+
+    Mat sourceROI = Mat::zeros(roi_s.height, roi_s.width, src.type());
+    src(roi_s).copyTo(sourceROI,gray(roi_s));
+
+    Mat maskROI = gray(roi_s);
+    Mat recoveredROI = blend(roi_d);
+
+    Cloning obj;
+    obj.normalClone(destinationROI,sourceROI,maskROI,recoveredROI,flags);
+}
+
 void cv::seamlessClone(InputArray _src, InputArray _dst, InputArray _mask, Point p, OutputArray _blend, int flags)
 {
     CV_INSTRUMENT_REGION()
@@ -58,51 +92,65 @@ void cv::seamlessClone(InputArray _src, InputArray _dst, InputArray _mask, Point
     Mat blend = _blend.getMat();
     dest.copyTo(blend);
 
-    int minx = INT_MAX, miny = INT_MAX, maxx = INT_MIN, maxy = INT_MIN;
-    int h = mask.size().height;
-    int w = mask.size().width;
-
-    Mat gray = Mat(mask.size(),CV_8UC1);
-
-    if(mask.channels() == 3)
-        cvtColor(mask, gray, COLOR_BGR2GRAY );
-    else
-        gray = mask;
-
-    for(int i=0;i<h;i++)
-    {
-        for(int j=0;j<w;j++)
-        {
-            if(gray.at<uchar>(i,j) == 255)
-            {
-                miny = std::min(miny,i);
-                maxy = std::max(maxy,i);
-                minx = std::min(minx,j);
-                maxx = std::max(maxx,j);
-            }
-        }
-    }
+    Mat gray = cloningMask(mask);
+    Rect roi_s, roi_d;
+    cloningRois(gray, p, roi_s, roi_d);
 
-    int lenx = maxx - minx + 1;
-    int leny = maxy - miny + 1;
+    seamlessCloneRoi(src, gray, roi_s, roi_d, blend, flags);
+}
 
-    int minxd = p.x - lenx/2;
-    int minyd = p.y - leny/2;
+void cv::seamlessCloneMulti(InputArrayOfArrays _src, InputArray _dst, InputArrayOfArrays _mask,
+                            const std::vector<Point>& p, OutputArray _blend, int flags)
+{
+    CV_INSTRUMENT_REGION()
 
-    Rect roi_d(minxd,minyd,lenx,leny);
-    Rect roi_s(minx,miny,lenx,leny);
+    std::vector<Mat> src, mask;
+    _src.getMatVector(src);
+    _mask.getMatVector(mask);
+    CV_Assert(src.size() == mask.size() && src.size() == p.size());
 
-    Mat destinationROI = dest(roi_d).clone();
+    const Mat dest = _dst.getMat();
+    _blend.create(dest.size(), CV_8UC3);
+    Mat blend = _blend.getMat();
+    dest.copyTo(blend);
 
-    Mat sourceROI = Mat::zeros(leny, lenx, src.type());
-    src(roi_s).copyTo(sourceROI,gray(roi_s));
+    const int n = (int)src.size();
+    std::vector<Mat> gray(n);
+    std::vector<Rect> roi_s(n), roi_d(n);
+    for (int i = 0; i < n; i++)
+    {
+        gray[i] = cloningMask(mask[i]);
+        cloningRois(gray[i], p[i], roi_s[i], roi_d[i]);
+    }
 
-    Mat maskROI = gray(roi_s);
-    Mat recoveredROI = blend(roi_d);
+    // a patch is cloned after all the preceding ones overlapping it, the patches of a round are disjoint
+    std::vector<int> round(n, 0);
+    int rounds = 0;
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < i; j++)
+            if ((roi_d[i] & roi_d[j]).area() > 0)
+                round[i] = std::max(round[i], round[j] + 1);
+        rounds = std::max(rounds, round[i] + 1);
+    }
 
-    Cloning obj;
-    obj.normalClone(destinationROI,sourceROI,maskROI,recoveredROI,flags);
+    std::vector<int> patches;
+    for (int r = 0; r < rounds; r++)
+    {
+        patches.clear();
+        for (int i = 0; i < n; i++)
+            if (round[i] == r)
+                patches.push_back(i);
 
+        parallel_for_(Range(0, (int)patches.size()), [&](const Range& range)
+        {
+            for (int k = range.start; k < range.end; k++)
+            {
+                int i = patches[k];
+                seamlessCloneRoi(src[i], gray[i], roi_s[i], roi_d[i], blend, flags);
+            }
+        });
+    }
 }
 
 void cv::colorChange(InputArray _src, InputArray _mask, OutputArray _dst, float r, float g, float b)
@@ -118,12 +166,7 @@ void cv::colorChange(InputArray _src, InputArray _mask, OutputArray _dst, float
     float green = g;
     float blue = b;
 
-    Mat gray = Mat::zeros(mask.size(),CV_8UC1);
-
-    if(mask.channels() == 3)
-        cvtColor(mask, gray, COLOR_BGR2GRAY );
-    else
-        gray = mask;
+    Mat gray = cloningMask(mask);
 
     Mat cs_mask = Mat::zeros(src.size(),CV_8UC3);
 
@@ -145,12 +188,7 @@ void cv::illuminationChange(InputArray _src, InputArray _mask, OutputArray _dst,
     float alpha = a;
     float beta = b;
 
-    Mat gray = Mat::zeros(mask.size(),CV_8UC1);
-
-    if(mask.channels() == 3)
-        cvtColor(mask, gray, COLOR_BGR2GRAY );
-    else
-        gray = mask;
+    Mat gray = cloningMask(mask);
 
     Mat cs_mask = Mat::zeros(src.size(),CV_8UC3);
 
@@ -172,12 +210,7 @@ void cv::textureFlattening(InputArray _src, InputArray _mask, OutputArray _dst,
     _dst.create(src.size(), src.type());
     Mat blend = _dst.getMat();
 
-    Mat gray = Mat::zeros(mask.size(),CV_8UC1);
-
-    if(mask.channels() == 3)
-        cvtColor(mask, gray, COLOR_BGR2GRAY );
-    else
-        gray = mask;
+    Mat gray = cloningMask(mask);
 
     Mat cs_mask = Mat::zeros(src.size(),CV_8UC3);
 
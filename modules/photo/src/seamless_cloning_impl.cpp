@@ -103,52 +103,56 @@ void Cloning::computeLaplacianY( const Mat &img, Mat &laplacianY)
     filter2D(img, laplacianY, CV_32F, kernel);
 }
 
-void Cloning::dst(const Mat& src, Mat& dest, bool invert)
+// Imaginary parts of the DFT of the odd extensions of the rows of src, that is the DST-I of the rows.
+// The DFT of an odd real row is imaginary, so two rows are transformed at once as the real and the
+// imaginary parts of one complex row. The stripes of the rows are transformed in parallel.
+static void dstRows(const Mat& src, Mat& dest, bool invert)
 {
-    Mat temp = Mat::zeros(src.rows, 2 * src.cols + 2, CV_32F);
-
-    int flag = invert ? DFT_ROWS + DFT_SCALE + DFT_INVERSE: DFT_ROWS;
+    const int n = src.cols, len = 2 * n + 2;
+    const int pairs = (src.rows + 1) / 2;
+    const int flag = invert ? DFT_ROWS + DFT_SCALE + DFT_INVERSE : DFT_ROWS;
+    dest.create(src.size(), CV_32F);
 
-    src.copyTo(temp(Rect(1,0, src.cols, src.rows)));
-
-    for(int j = 0 ; j < src.rows ; ++j)
+    parallel_for_(Range(0, pairs), [&](const Range& range)
     {
-        float * tempLinePtr = temp.ptr<float>(j);
-        const float * srcLinePtr = src.ptr<float>(j);
-        for(int i = 0 ; i < src.cols ; ++i)
+        Mat complex = Mat::zeros(range.size(), len, CV_32FC2);
+        for (int k = range.start; k < range.end; ++k)
         {
-            tempLinePtr[src.cols + 2 + i] = - srcLinePtr[src.cols - 1 - i];
+            const float * aLinePtr = src.ptr<float>(2 * k);
+            const float * bLinePtr = 2 * k + 1 < src.rows ? src.ptr<float>(2 * k + 1) : NULL;
+            Vec2f * complexLinePtr = complex.ptr<Vec2f>(k - range.start);
+            for (int i = 0 ; i < n ; ++i)
+            {
+                Vec2f val(aLinePtr[i], bLinePtr ? bLinePtr[i] : 0.f);
+                complexLinePtr[i + 1] = val;
+                complexLinePtr[len - 1 - i] = -val;
+            }
         }
-    }
 
-    Mat planes[] = {temp, Mat::zeros(temp.size(), CV_32F)};
-    Mat complex;
+        dft(complex, complex, flag);
 
-    merge(planes, 2, complex);
-    dft(complex, complex, flag);
-    split(complex, planes);
-    temp = Mat::zeros(src.cols, 2 * src.rows + 2, CV_32F);
-
-    for(int j = 0 ; j < src.cols ; ++j)
-    {
-        float * tempLinePtr = temp.ptr<float>(j);
-        for(int i = 0 ; i < src.rows ; ++i)
+        for (int k = range.start; k < range.end; ++k)
         {
-            float val = planes[1].ptr<float>(i)[j + 1];
-            tempLinePtr[i + 1] = val;
-            tempLinePtr[temp.cols - 1 - i] = - val;
+            const Vec2f * complexLinePtr = complex.ptr<Vec2f>(k - range.start);
+            float * aLinePtr = dest.ptr<float>(2 * k);
+            for (int i = 0 ; i < n ; ++i)
+                aLinePtr[i] = complexLinePtr[i + 1][1];
+            if (2 * k + 1 < src.rows)
+            {
+                float * bLinePtr = dest.ptr<float>(2 * k + 1);
+                for (int i = 0 ; i < n ; ++i)
+                    bLinePtr[i] = -complexLinePtr[i + 1][0];
+            }
         }
-    }
-
-    Mat planes2[] = {temp, Mat::zeros(temp.size(), CV_32F)};
-
-    merge(planes2, 2, complex);
-    dft(complex, complex, flag);
-    split(complex, planes2);
+    }, std::max(1., pairs / 16.));
+}
 
-    temp = planes2[1].t();
-    dest = Mat::zeros(src.size(), CV_32F);
-    temp(Rect( 0, 1, src.cols, src.rows)).copyTo(dest);
+void Cloning::dst(const Mat& src, Mat& dest, bool invert)
+{
+    Mat rowsDst, colsDst;
+    dstRows(src, rowsDst, invert);
+    dstRows(rowsDst.t(), colsDst, invert);
+    transpose(colsDst, dest);
 }
 
 void Cloning::idst(const Mat& src, Mat& dest)
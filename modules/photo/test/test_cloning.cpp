@@ -235,4 +235,61 @@ TEST(Photo_SeamlessClone_textureFlattening, regression)
     EXPECT_LE(errorL1, reference.total() * numerical_precision) << "size=" << reference.size();
 }
 
+static Mat smoothNoise(Size size, RNG& rng)
+{
+    Mat noise(size / 16, CV_8UC3), image;
+    rng.fill(noise, RNG::UNIFORM, 0, 255);
+    resize(noise, image, size, 0, 0, INTER_CUBIC);
+    return image;
+}
+
+TEST(Photo_SeamlessClone, same_gradients)
+{
+    RNG rng(0);
+    Mat destination = smoothNoise(Size(320, 240), rng);
+
+    // the odd and the even sizes of the bounding box of the mask
+    const Size axes[] = { Size(60, 45), Size(81, 50) };
+    for (int k = 0; k < 2; k++)
+    {
+        Mat mask(destination.size(), CV_8U, Scalar(0));
+        ellipse(mask, Point(160, 120), axes[k], 0, 0, 360, Scalar(255), -1);
+        Mat mask_copy = mask.clone();
+        Rect roi = boundingRect(mask);
+        Point center(roi.x + roi.width / 2, roi.y + roi.height / 2);
+
+        // the patch has the gradients of the destination, so the Poisson equation gives it back
+        // up to the truncation of the solution
+        Mat result;
+        seamlessClone(destination, destination, mask, center, result, NORMAL_CLONE);
+        EXPECT_LE(cvtest::norm(destination, result, NORM_INF), 1);
+        EXPECT_EQ(0, cvtest::norm(mask, mask_copy, NORM_INF));
+    }
+}
+
+TEST(Photo_SeamlessCloneMulti, matches_sequential)
+{
+    RNG rng(0);
+    Mat destination = smoothNoise(Size(400, 300), rng);
+    std::vector<Mat> sources, masks;
+    std::vector<Point> points;
+    Mat mask(Size(100, 80), CV_8U, Scalar(0));
+    ellipse(mask, Point(50, 40), Size(40, 30), 0, 0, 360, Scalar(255), -1);
+    const Point centers[] = { Point(80, 70), Point(300, 70), Point(120, 100), Point(300, 220), Point(100, 220) };
+    for (int i = 0; i < 5; i++)
+    {
+        sources.push_back(smoothNoise(mask.size(), rng));
+        masks.push_back(mask);
+        points.push_back(centers[i]);
+    }
+
+    Mat expected = destination.clone();
+    for (size_t i = 0; i < sources.size(); i++)
+        seamlessClone(sources[i], expected, masks[i], points[i], expected, MIXED_CLONE);
+
+    Mat result;
+    seamlessCloneMulti(sources, destination, masks, points, result, MIXED_CLONE);
+    EXPECT_EQ(0, cvtest::norm(expected, result, NORM_INF));
+}
+
 }} // namespace
@@ -165,4 +165,190 @@ TEST(Photo_Denoising, speed)
     printf("execution time: %gms\n", t*1000./getTickFrequency());
 }
 
+// a smooth image with gaussian noise, the sizes are not multiples of the tiles of the denoising
+static void makeNoisyFrames(int type, int count, Mat& clean, std::vector<Mat>& frames)
+{
+    RNG rng(0);
+    Size size(101, 77);
+    Mat noise(size / 8, CV_MAKETYPE(CV_32F, CV_MAT_CN(type)));
+    rng.fill(noise, RNG::UNIFORM, 0, CV_MAT_DEPTH(type) == CV_16U ? 4000 : 200);
+    resize(noise, noise, size, 0, 0, INTER_CUBIC);
+    noise.convertTo(clean, type);
+
+    frames.clear();
+    for (int i = 0; i < count; i++)
+    {
+        Mat n(size, noise.type()), frame;
+        rng.fill(n, RNG::NORMAL, 0, CV_MAT_DEPTH(type) == CV_16U ? 200 : 10);
+        cv::add(noise, n, frame);
+        frame.convertTo(frame, type);
+        frames.push_back(frame);
+    }
+}
+
+// the non-local means of srcImgs[index] computed pixel by pixel with the fixed-point weights of the
+// template window distances averaged by a binary shift, as the implementation does
+template <typename ST, typename IT>
+static Mat referenceNlMeans(const std::vector<Mat>& srcImgs, int index, int temporalWindowSize,
+                            const std::vector<float>& h, int templateWindowSize, int searchWindowSize,
+                            int normType)
+{
+    const int cn = srcImgs[0].channels(), hn = (int)h.size();
+    const int thalf = templateWindowSize / 2, shalf = searchWindowSize / 2, twhalf = temporalWindowSize / 2;
+    const int border = thalf + shalf;
+    std::vector<Mat> ext(srcImgs.size());
+    for (size_t i = 0; i < srcImgs.size(); i++)
+        cv::copyMakeBorder(srcImgs[i], ext[i], border, border, border, border, BORDER_REFLECT_101);
+
+    int shift = 0;
+    while (1 << shift < templateWindowSize * templateWindowSize)
+        shift++;
+    double almost_dist_mult = (double)(1 << shift) / (templateWindowSize * templateWindowSize);
+    IT max_sum = (IT)temporalWindowSize * searchWindowSize * searchWindowSize * std::numeric_limits<ST>::max();
+    int fixed_point_mult = (int)std::min<IT>(std::numeric_limits<IT>::max() / max_sum,
+                                             std::numeric_limits<int>::max());
+
+    Mat dst(srcImgs[0].size(), srcImgs[0].type());
+    for (int y = 0; y < dst.rows; y++)
+    {
+        for (int x = 0; x < dst.cols; x++)
+        {
+            std::vector<IT> est(cn, 0), wsum(cn, 0);
+            for (int d = index - twhalf; d <= index + twhalf; d++)
+            {
+                for (int oy = -shalf; oy <= shalf; oy++)
+                {
+                    for (int ox = -shalf; ox <= shalf; ox++)
+                    {
+                        int dist = 0;
+                        for (int ty = -thalf; ty <= thalf; ty++)
+                        {
+                            const ST* a = ext[index].ptr<ST>(border + y + ty) + (border + x - thalf) * cn;
+                            const ST* b = ext[d].ptr<ST>(border + y + oy + ty) + (border + x + ox - thalf) * cn;
+                            for (int i = 0; i < templateWindowSize * cn; i++)
+                            {
+                                int diff = (int)a[i] - (int)b[i];
+                                dist += normType == NORM_L1 ? std::abs(diff) : diff * diff;
+                            }
+                        }
+
+                        double almost_dist = (dist >> shift) * almost_dist_mult;
+                        const ST* p = ext[d].ptr<ST>(border + y + oy) + (border + x + ox) * cn;
+                        for (int c = 0; c < cn; c++)
+                        {
+                            float hc = h[hn == 1 ? 0 : c];
+                            double w = std::exp(-(normType == NORM_L1 ? almost_dist * almost_dist : almost_dist) /
+                                                (hc * hc * cn));
+                            IT weight = (IT)cvRound(fixed_point_mult * w);
+                            if (weight < 0.001 * fixed_point_mult)
+                                weight = 0;
+                            est[c] += weight * p[c];
+                            wsum[c] += weight;
+                        }
+                    }
+                }
+            }
+            ST* dst_ptr = dst.ptr<ST>(y) + x * cn;
+            for (int c = 0; c < cn; c++)
+                dst_ptr[c] = saturate_cast<ST>((est[c] + wsum[c] / 2) / wsum[c]);
+        }
+    }
+    return dst;
+}
+
+static Mat referenceNlMeans(const std::vector<Mat>& srcImgs, int index, int temporalWindowSize,
+                            const std::vector<float>& h, int templateWindowSize, int searchWindowSize,
+                            int normType)
+{
+    if (srcImgs[0].depth() == CV_16U)
+        return referenceNlMeans<ushort, int64>(srcImgs, index, temporalWindowSize, h,
+                                               templateWindowSize, searchWindowSize, normType);
+    return referenceNlMeans<uchar, int>(srcImgs, index, temporalWindowSize, h,
+                                        templateWindowSize, searchWindowSize, normType);
+}
+
+TEST(Photo_DenoisingMulti, reference)
+{
+    const int types[] = { CV_8UC1, CV_8UC2, CV_8UC3, CV_8UC4, CV_16UC1, CV_16UC3 };
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+    {
+        Mat clean;
+        std::vector<Mat> frames;
+        makeNoisyFrames(types[i], 3, clean, frames);
+        bool is16u = CV_MAT_DEPTH(types[i]) == CV_16U;
+        std::vector<float> h(1, is16u ? 300.f : 10.f);
+        const int norms[] = { NORM_L1, NORM_L2 };
+        for (int j = 0; j < (is16u ? 1 : 2); j++)
+        {
+            int norm = norms[j];
+            Mat single, multi;
+            fastNlMeansDenoising(frames[1], single, h, 5, 9, norm);
+            EXPECT_EQ(0, cvtest::norm(single, referenceNlMeans(frames, 1, 1, h, 5, 9, norm), NORM_INF))
+                << "type " << types[i] << ", norm " << norm;
+            fastNlMeansDenoisingMulti(frames, multi, 1, 3, h, 5, 9, norm);
+            EXPECT_EQ(0, cvtest::norm(multi, referenceNlMeans(frames, 1, 3, h, 5, 9, norm), NORM_INF))
+                << "type " << types[i] << ", norm " << norm;
+        }
+    }
+
+    // a parameter per channel
+    Mat clean, multi;
+    std::vector<Mat> frames;
+    makeNoisyFrames(CV_8UC3, 3, clean, frames);
+    std::vector<float> h;
+    h.push_back(5);
+    h.push_back(10);
+    h.push_back(20);
+    fastNlMeansDenoisingMulti(frames, multi, 1, 3, h, 5, 9, NORM_L2);
+    EXPECT_EQ(0, cvtest::norm(multi, referenceNlMeans(frames, 1, 3, h, 5, 9, NORM_L2), NORM_INF));
+}
+
+TEST(Photo_DenoisingSequence, same_as_multi)
+{
+    struct
+    {
+        int type, count, temporalWindowSize, templateWindowSize, searchWindowSize, norm;
+        float h;
+    } params[] = {
+        { CV_8UC1, 6, 3, 7, 21, NORM_L2, 10.f },
+        { CV_8UC3, 6, 5, 5, 11, NORM_L1, 10.f },
+        { CV_16UC1, 6, 3, 5, 11, NORM_L1, 300.f },
+        // vertical offsets as long as the tiles
+        { CV_8UC1, 4, 3, 1, 129, NORM_L2, 10.f }
+    };
+    for (size_t i = 0; i < sizeof(params) / sizeof(params[0]); i++)
+    {
+        Mat clean;
+        std::vector<Mat> frames, dst;
+        makeNoisyFrames(params[i].type, params[i].count, clean, frames);
+        std::vector<float> h(1, params[i].h);
+        int twin = params[i].temporalWindowSize;
+        fastNlMeansDenoisingSequence(frames, dst, twin, h, params[i].templateWindowSize,
+                                     params[i].searchWindowSize, params[i].norm);
+        ASSERT_EQ(frames.size() - twin + 1, dst.size());
+        for (size_t j = 0; j < dst.size(); j++)
+        {
+            Mat multi;
+            fastNlMeansDenoisingMulti(frames, multi, (int)j + twin / 2, twin, h, params[i].templateWindowSize,
+                                      params[i].searchWindowSize, params[i].norm);
+            EXPECT_EQ(0, cvtest::norm(dst[j], multi, NORM_INF)) << "params " << i << ", frame " << j;
+        }
+    }
+}
+
+TEST(Photo_DenoisingMulti, reduces_noise)
+{
+    Mat clean, single, multi;
+    std::vector<Mat> frames;
+    makeNoisyFrames(CV_8UC1, 5, clean, frames);
+    fastNlMeansDenoising(frames[2], single, 10, 7, 21);
+    fastNlMeansDenoisingMulti(frames, multi, 2, 5, 10, 7, 21);
+
+    double noisy_err = cvtest::norm(frames[2], clean, NORM_L2);
+    double single_err = cvtest::norm(single, clean, NORM_L2);
+    double multi_err = cvtest::norm(multi, clean, NORM_L2);
+    EXPECT_LT(single_err, noisy_err * 0.6);
+    EXPECT_LT(multi_err, single_err);
+}
+
 }} // namespace
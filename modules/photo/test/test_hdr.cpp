@@ -201,6 +201,60 @@ TEST(Photo_MergeDebevec, regression)
     checkEqual(expected, result, 1e-2f, "Debevec");
 }
 
+// an exposure sequence of a smooth synthetic scene
+static void makeExposures(Size size, int channels, vector<Mat>& images, vector<float>& times)
+{
+    RNG rng(0);
+    Mat scene(size / 8, CV_32FC(channels));
+    rng.fill(scene, RNG::UNIFORM, 0.05, 1.0);
+    resize(scene, scene, size, 0, 0, INTER_CUBIC);
+    images.clear();
+    times.clear();
+    for(int i = 0; i < 6; i++) {
+        float time = 0.25f * (float)(1 << i);
+        Mat img;
+        scene.convertTo(img, CV_8U, 100 * time);
+        images.push_back(img);
+        times.push_back(time);
+    }
+}
+
+TEST(Photo_MergeDebevec, feed)
+{
+    vector<Mat> images;
+    vector<float> times;
+    makeExposures(Size(320, 240), 3, images, times);
+
+    Ptr<MergeDebevec> merge = createMergeDebevec();
+    Mat expected, result;
+    merge->process(images, expected, times);
+    for(int k = 0; k < 2; k++) {
+        for(size_t i = 0; i < images.size(); i++)
+            merge->feed(images[i], times[i]);
+        merge->finish(result);
+        EXPECT_EQ(0, cvtest::norm(expected, result, NORM_INF));
+    }
+}
+
+TEST(Photo_MergeMertens, stripes)
+{
+    for(int channels = 1; channels <= 3; channels += 2) {
+        vector<Mat> images;
+        vector<float> times;
+        makeExposures(Size(320, 240), channels, images, times);
+
+        // the result of the parallel pyramids doesn't depend on the stripes
+        Ptr<MergeMertens> merge = createMergeMertens();
+        Mat expected, sequential;
+        merge->process(images, expected);
+        int threads = getNumThreads();
+        setNumThreads(1);
+        merge->process(images, sequential);
+        setNumThreads(threads);
+        EXPECT_EQ(0, cvtest::norm(expected, sequential, NORM_INF));
+    }
+}
+
 TEST(Photo_MergeRobertson, regression)
 {
     string test_path = string(cvtest::TS::ptr()->get_data_path()) + "hdr/";
@@ -139,4 +139,92 @@ TEST_P(formats, 1c)
 
 INSTANTIATE_TEST_CASE_P(Photo_Inpaint, formats, testing::Values(CV_32F, CV_16U, CV_8U));
 
+typedef testing::TestWithParam<int> Photo_InpaintDefects;
+
+// scratches and dust spots spread over the whole image
+TEST_P(Photo_InpaintDefects, parallel_and_repeated)
+{
+    const int flags = GetParam();
+    RNG rng(0);
+    Mat src(240, 320, CV_8UC3), mask = Mat::zeros(src.size(), CV_8U);
+    rng.fill(src, RNG::UNIFORM, 0, 255);
+    GaussianBlur(src, src, Size(9, 9), 3);
+    for (int k = 0; k < 12; k++)
+    {
+        Point p(rng.uniform(0, src.cols), rng.uniform(0, src.rows));
+        if (k % 2)
+            line(mask, p, p + Point(rng.uniform(-40, 40), rng.uniform(-40, 40)), Scalar(255), 2);
+        else
+            circle(mask, p, rng.uniform(1, 6), Scalar(255), -1);
+    }
+
+    Mat dst, dst_again, dst_sequential;
+    inpaint(src, mask, dst, 3, flags);
+    inpaint(src, mask, dst_again, 3, flags);
+    int threads = getNumThreads();
+    setNumThreads(1);
+    inpaint(src, mask, dst_sequential, 3, flags);
+    setNumThreads(threads);
+
+    EXPECT_EQ(0, cvtest::norm(dst, dst_again, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(dst, dst_sequential, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(dst, src, NORM_INF, ~mask));
+
+    // another mask with the same image is not served with the previous marching order
+    Mat mask2 = mask.clone(), dst2, dst2_expected;
+    mask2(Rect(10, 10, 20, 20)).setTo(255);
+    inpaint(src, mask2, dst2, 3, flags);
+    inpaint(src, mask2, dst2_expected, 5, flags);
+    inpaint(src, mask2, dst2_expected, 3, flags);
+    EXPECT_EQ(0, cvtest::norm(dst2, dst2_expected, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(dst, dst2, NORM_INF, ~mask2));
+}
+
+INSTANTIATE_TEST_CASE_P(Photo_Inpaint, Photo_InpaintDefects, testing::Values(INPAINT_NS, INPAINT_TELEA));
+
+TEST(Photo_Inpaint, fixed_mask)
+{
+    Mat src(32, 48, CV_8UC1);
+    for (int y = 0; y < src.rows; y++)
+        for (int x = 0; x < src.cols; x++)
+            src.at<uchar>(y, x) = saturate_cast<uchar>(4 * x + 3 * y + (x * y) % 7 * 5);
+    Mat mask = Mat::zeros(src.size(), CV_8U);
+    mask(Rect(10, 8, 4, 3)).setTo(255);
+    mask(Rect(30, 20, 2, 6)).setTo(255);
+
+    // the inpainted pixels in the raster order, as given by the implementation with the sorted list band
+    const uchar expected_ns[] = { 70, 70, 71, 76, 80, 82, 81, 82, 89, 90, 94, 95,
+                                  192, 198, 188, 195, 191, 199, 196, 201, 202, 208, 210, 212 };
+    const uchar expected_telea[] = { 67, 70, 75, 79, 75, 81, 83, 84, 83, 84, 89, 90,
+                                     194, 197, 191, 196, 194, 199, 199, 202, 202, 207, 208, 209 };
+
+    // a large image is marched again on every call, the small one once
+    Mat large_src = Mat::zeros(1500, 1500, CV_8UC1), large_mask = Mat::zeros(large_src.size(), CV_8U);
+    src.copyTo(large_src(Rect(0, 0, src.cols, src.rows)));
+    mask.copyTo(large_mask(Rect(0, 0, src.cols, src.rows)));
+
+    for (int method = 0; method < 2; method++)
+    {
+        int flags = method == 0 ? INPAINT_NS : INPAINT_TELEA;
+        const uchar* expected = method == 0 ? expected_ns : expected_telea;
+        for (int k = 0; k < 4; k++)
+        {
+            Mat dst;
+            if (k < 2)
+                inpaint(src, mask, dst, 3, flags);
+            else
+                inpaint(large_src, large_mask, dst, 3, flags);
+            int n = 0;
+            for (int y = 0; y < src.rows; y++)
+                for (int x = 0; x < src.cols; x++)
+                    if (mask.at<uchar>(y, x))
+                    {
+                        EXPECT_EQ(expected[n], dst.at<uchar>(y, x)) << "flags " << flags << ", call " << k
+                                                                    << ", pixel " << Point(x, y);
+                        n++;
+                    }
+        }
+    }
+}
+
 }} // namespace
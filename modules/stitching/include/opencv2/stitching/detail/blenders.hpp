@@ -162,6 +162,69 @@ private:
 };
 
 
+/** @brief Receives the panorama blended by TiledMultiBandBlender stripe by stripe.
+ */
+class CV_EXPORTS BlendedStripeWriter
+{
+public:
+    virtual ~BlendedStripeWriter() {}
+
+    /** @brief Processes the next stripe of the panorama.
+
+    @param y Row of the panorama where the stripe starts
+    @param stripe Rows of the panorama of the type CV_16SC3
+    @param stripe_mask Mask of the stripe
+     */
+    virtual void write(int y, const Mat &stripe, const Mat &stripe_mask) = 0;
+};
+
+/** @brief Multi-band blender which processes the panorama in tiles.
+
+The result is close to the one of MultiBandBlender, but the Laplacian pyramids of the whole panorama
+are never kept in memory. feed() only stores the source images, blend() processes the panorama in
+overlapping tiles in parallel, building the pyramids of each tile only from the sources intersecting
+it. The tiles are produced by horizontal stripes from top to bottom, so the panorama can be written
+to a file stripe by stripe without holding all of it in memory.
+ */
+class CV_EXPORTS TiledMultiBandBlender : public Blender
+{
+public:
+    TiledMultiBandBlender(int num_bands = 5, Size tile_size = Size(2048, 2048), int weight_type = CV_32F);
+
+    int numBands() const { return actual_num_bands_; }
+    void setNumBands(int val) { actual_num_bands_ = val; }
+
+    Size tileSize() const { return tile_size_; }
+    void setTileSize(Size val) { tile_size_ = val; }
+
+    void prepare(Rect dst_roi) CV_OVERRIDE;
+    void feed(InputArray img, InputArray mask, Point tl) CV_OVERRIDE;
+    void blend(InputOutputArray dst, InputOutputArray dst_mask) CV_OVERRIDE;
+
+    /** @brief Blends the panorama and passes it to the writer by stripes of the tile height.
+
+    @param writer Receiver of the stripes, it is called from the calling thread in the top-to-bottom order
+     */
+    void blend(BlendedStripeWriter &writer);
+
+private:
+    struct Source
+    {
+        Mat img, mask;
+        Point tl;
+        Rect roi; // bordered and aligned area of the source in the panorama
+    };
+
+    void blendTile(Rect tile, Mat &dst, Mat &dst_mask) const;
+
+    int actual_num_bands_, num_bands_;
+    Size tile_size_;
+    int weight_type_; //CV_32F or CV_16S
+    Rect dst_roi_final_;
+    std::vector<Source> sources_;
+};
+
+
 //////////////////////////////////////////////////////////////////////////////
 // Auxiliary functions
 
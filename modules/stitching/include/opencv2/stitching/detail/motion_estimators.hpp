@@ -186,6 +186,37 @@ protected:
      */
     virtual void calcJacobian(Mat &jac) = 0;
 
+    /** @brief Calculates error vector of one image pair.
+
+    When it's implemented, estimate() solves the problem with SparseLMSolver: each pair of images is
+    a residual block depending on the parameters of its two cameras. The method is called concurrently
+    for different pairs.
+
+    @param edge_idx Index of the image pair in edges_
+    @param cam_params Camera parameters of all the images
+    @param err Error column-vector of length num_inliers \* num_errs_per_measurement
+    @return false if the adjuster computes the error of all the pairs at once only, the default
+     */
+    virtual bool calcPairError(int edge_idx, const Mat &cam_params, Mat &err) const;
+    /** @brief Calculates jacobian of the error of one image pair.
+
+    The default implementation uses central differences with step 1e-4.
+
+    @param edge_idx Index of the image pair in edges_
+    @param cam_params Camera parameters of all the images
+    @param jac Jacobian matrix of dimensions (num_inliers \* num_errs_per_measurement) x
+    (2 \* num_params_per_cam), the parameters of the first camera of the pair go first
+     */
+    virtual void calcPairJacobian(int edge_idx, const Mat &cam_params, Mat &jac) const;
+
+    // Numeric pair jacobian, the parameters with zero refine[] (if not NULL) get zero columns
+    void calcPairJacobianNumeric(int edge_idx, const Mat &cam_params, double step,
+                                 const uchar *refine, Mat &jac) const;
+    // Error vector of all the pairs gathered with calcPairError()
+    void calcErrorByPairs(Mat &err) const;
+
+    class PairErrorCallback;
+
     // 3x3 8U mask, where 0 means don't refine respective parameter, != 0 means refine
     Mat refinement_mask_;
 
@@ -248,6 +279,8 @@ private:
     void obtainRefinedCameraParams(std::vector<CameraParams> &cameras) const CV_OVERRIDE;
     void calcError(Mat &err) CV_OVERRIDE;
     void calcJacobian(Mat &jac) CV_OVERRIDE;
+    bool calcPairError(int edge_idx, const Mat &cam_params, Mat &err) const CV_OVERRIDE;
+    void calcPairJacobian(int edge_idx, const Mat &cam_params, Mat &jac) const CV_OVERRIDE;
 
     Mat err1_, err2_;
 };
@@ -268,6 +301,8 @@ private:
     void obtainRefinedCameraParams(std::vector<CameraParams> &cameras) const CV_OVERRIDE;
     void calcError(Mat &err) CV_OVERRIDE;
     void calcJacobian(Mat &jac) CV_OVERRIDE;
+    bool calcPairError(int edge_idx, const Mat &cam_params, Mat &err) const CV_OVERRIDE;
+    void calcPairJacobian(int edge_idx, const Mat &cam_params, Mat &jac) const CV_OVERRIDE;
 
     Mat err1_, err2_;
 };
@@ -292,6 +327,7 @@ private:
     void obtainRefinedCameraParams(std::vector<CameraParams> &cameras) const CV_OVERRIDE;
     void calcError(Mat &err) CV_OVERRIDE;
     void calcJacobian(Mat &jac) CV_OVERRIDE;
+    bool calcPairError(int edge_idx, const Mat &cam_params, Mat &err) const CV_OVERRIDE;
 
     Mat err1_, err2_;
 };
@@ -316,6 +352,7 @@ private:
     void obtainRefinedCameraParams(std::vector<CameraParams> &cameras) const CV_OVERRIDE;
     void calcError(Mat &err) CV_OVERRIDE;
     void calcJacobian(Mat &jac) CV_OVERRIDE;
+    bool calcPairError(int edge_idx, const Mat &cam_params, Mat &err) const CV_OVERRIDE;
 
     Mat err1_, err2_;
 };
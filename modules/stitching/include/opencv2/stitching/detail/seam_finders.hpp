@@ -95,6 +95,14 @@ protected:
      */
     virtual void findInPair(size_t first, size_t second, Rect roi) = 0;
 
+    /** @brief Returns how far outside of the given ROI findInPair() accesses the masks, or a negative value
+    if findInPair() can't run concurrently for different pairs.
+
+    When the margin is known, run() processes the pairs whose extended ROIs don't intersect in parallel,
+    while the pairs sharing a part of the same mask keep their order.
+     */
+    virtual int pairMargin() const { return -1; }
+
     std::vector<UMat> images_;
     std::vector<Size> sizes_;
     std::vector<Point> corners_;
@@ -112,6 +120,7 @@ public:
                       std::vector<UMat> &masks);
 private:
     void findInPair(size_t first, size_t second, Rect roi) CV_OVERRIDE;
+    int pairMargin() const CV_OVERRIDE;
 };
 
 
@@ -244,10 +253,21 @@ public:
     void find(const std::vector<UMat> &src, const std::vector<Point> &corners,
               std::vector<UMat> &masks) CV_OVERRIDE;
 
+    /** @brief Downscale factor of the coarse-to-fine mode, 1 (default) if the seams are found at the full resolution.
+
+    With a factor greater than 1 each seam is found on the images downscaled by this factor first, then it's
+    refined at the full resolution only within refineBandWidth() pixels of the upscaled coarse seam.
+     */
+    int coarseScale() const;
+    void setCoarseScale(int scale);
+
+    int refineBandWidth() const;
+    void setRefineBandWidth(int width);
+
 private:
     // To avoid GCGraph dependency
     class Impl;
-    Ptr<PairwiseSeamFinder> impl_;
+    Ptr<Impl> impl_;
 };
 
 
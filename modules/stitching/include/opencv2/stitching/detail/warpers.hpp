@@ -47,6 +47,7 @@
 #include "opencv2/core/cuda.hpp"
 #include "opencv2/imgproc.hpp"
 #include "opencv2/opencv_modules.hpp"
+#include <list>
 
 namespace cv {
 namespace detail {
@@ -606,6 +607,84 @@ protected:
     }
 };
 
+/** @brief Warper which keeps the projection maps of another warper for the repeated camera parameters.
+
+Rigs with fixed geometry warp every frame of a camera with the same parameters. The maps are built once per
+source size, camera parameters and interpolation mode, and kept in the fixed-point form used by remap().
+At most capacity() sets of maps are kept, the least recently used one is dropped first.
+The warped images are identical to the ones of the wrapped warper.
+
+@note The cache isn't synchronized, so one instance shouldn't be used from several threads at once.
+ */
+class CV_EXPORTS CachedRotationWarper : public RotationWarper
+{
+public:
+    /** @brief Construct a caching wrapper of the warper.
+
+    @param warper Warper building the projection maps
+    @param capacity Maximum number of the kept sets of maps, e.g. the number of cameras of the rig
+     */
+    explicit CachedRotationWarper(const Ptr<RotationWarper> &warper, int capacity = 16);
+
+    Point2f warpPoint(const Point2f &pt, InputArray K, InputArray R) CV_OVERRIDE;
+
+    Rect buildMaps(Size src_size, InputArray K, InputArray R, OutputArray xmap, OutputArray ymap) CV_OVERRIDE;
+
+    Point warp(InputArray src, InputArray K, InputArray R, int interp_mode, int border_mode,
+               OutputArray dst) CV_OVERRIDE;
+
+    void warpBackward(InputArray src, InputArray K, InputArray R, int interp_mode, int border_mode,
+                      Size dst_size, OutputArray dst) CV_OVERRIDE;
+
+    Rect warpRoi(Size src_size, InputArray K, InputArray R) CV_OVERRIDE;
+
+    float getScale() const CV_OVERRIDE;
+    void setScale(float val) CV_OVERRIDE;
+
+    /** @brief Projects the image, applies the exposure gain and converts the result for blending in one pass.
+
+    @param src Source image
+    @param K Camera intrinsic parameters
+    @param R Camera rotation matrix
+    @param interp_mode Interpolation mode
+    @param border_mode Border extrapolation mode
+    @param gain Gain of the image, e.g. from GainCompensator::gains(), a gain per channel of the image
+    (e.g. a Scalar), or a single-channel CV_32F map of per-pixel gains of the projected image size. Empty
+    if the image isn't compensated. Other gains are rejected.
+    @param dst Projected image, saturate_cast<dtype>(warped * gain)
+    @param mask Mask of the projected pixels. It's built once for the camera parameters as well.
+    @param dtype Depth of the projected image
+    @return Projected image top-left corner
+     */
+    Point warpCompensated(InputArray src, InputArray K, InputArray R, int interp_mode, int border_mode,
+                          InputArray gain, OutputArray dst, OutputArray mask, int dtype = CV_16S);
+
+    //! Drops all the cached maps
+    void clear();
+
+    int capacity() const { return capacity_; }
+    //! Sets the maximum number of the kept sets of maps, the least recently used ones above it are dropped
+    void setCapacity(int capacity);
+
+private:
+    struct Maps
+    {
+        Size src_size;
+        Mat K, R;
+        int interp_mode;
+        Rect dst_roi;
+        Mat map1, map2;
+        Mat mask;
+    };
+
+    Maps &maps(Size src_size, InputArray K, InputArray R, int interp_mode);
+
+    Ptr<RotationWarper> warper_;
+    int capacity_;
+    // the most recently used maps first
+    std::list<Maps> maps_;
+};
+
 //! @} stitching_warp
 
 } // namespace detail
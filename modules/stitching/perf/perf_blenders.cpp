@@ -0,0 +1,57 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+#include "opencv2/imgproc.hpp"
+
+namespace opencv_test
+{
+using namespace perf;
+
+typedef TestBaseWithParam<string> multiBandBlender;
+
+// a row of 8 overlapping images of 1280x960 pixels
+PERF_TEST_P(multiBandBlender, panorama, testing::Values("full", "tiled"))
+{
+    const int num_images = 8;
+    const Size size(1280, 960);
+    RNG rng(0);
+    std::vector<Mat> images(num_images), masks(num_images);
+    std::vector<Point> corners(num_images);
+    std::vector<Size> sizes(num_images, size);
+    for (int i = 0; i < num_images; ++i)
+    {
+        Mat noise(size / 8, CV_8UC3);
+        rng.fill(noise, RNG::UNIFORM, 0, 255);
+        resize(noise, images[i], size, 0, 0, INTER_LINEAR);
+        masks[i].create(size, CV_8U);
+        masks[i].setTo(255);
+        if (i > 0)
+            masks[i].colRange(0, size.width / 8).setTo(0);
+        corners[i] = Point(i * size.width * 3 / 4, rng.uniform(-50, 50));
+    }
+    Rect dst_roi = detail::resultRoi(corners, sizes);
+
+    Ptr<detail::Blender> blender;
+    if (GetParam() == "full")
+        blender = makePtr<detail::MultiBandBlender>(false, 5);
+    else
+        blender = makePtr<detail::TiledMultiBandBlender>(5);
+
+    Mat pano, pano_mask;
+
+    declare.time(60);
+
+    TEST_CYCLE()
+    {
+        blender->prepare(dst_roi);
+        for (int i = 0; i < num_images; ++i)
+            blender->feed(images[i], masks[i], corners[i]);
+        blender->blend(pano, pano_mask);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+} // namespace
@@ -1,4 +1,5 @@
 #include "perf_precomp.hpp"
+#include "opencv2/calib3d.hpp"
 #include "opencv2/imgcodecs.hpp"
 #include "opencv2/opencv_modules.hpp"
 
@@ -97,4 +98,112 @@ PERF_TEST_P(bundleAdjuster, affine, testing::Combine(TEST_DETECTORS, AFFINE_FUNC
     EXPECT_FLOAT_EQ(h.at<float>(2), 1.f);
 }
 
+typedef TestBaseWithParam<tuple<int, string> > bundleAdjusterSynthetic;
+
+// spherical panorama of rows of 18 images taken with 20 degrees yaw step and exact features
+static void makeSyntheticPanorama(int num_images, std::vector<detail::ImageFeatures> &features,
+                                  std::vector<detail::MatchesInfo> &pairwise_matches,
+                                  std::vector<detail::CameraParams> &cameras)
+{
+    const Size img_size(640, 480);
+    const int num_rows = (num_images + 17) / 18;
+    RNG rng(12345);
+
+    cameras.resize(num_images);
+    for (int i = 0; i < num_images; ++i)
+    {
+        cameras[i].focal = 600;
+        cameras[i].ppx = img_size.width * 0.5;
+        cameras[i].ppy = img_size.height * 0.5;
+        Matx33d Ryaw, Rpitch;
+        cv::Rodrigues(Vec3d(0, (i % 18) * CV_PI / 9, 0), Ryaw);
+        cv::Rodrigues(Vec3d(((i / 18) - (num_rows - 1) * 0.5) * 0.5, 0, 0), Rpitch);
+        Mat(Ryaw * Rpitch).convertTo(cameras[i].R, CV_32F);
+    }
+
+    const int num_rays = 60 * num_images;
+    std::vector<std::vector<int> > visible(num_images, std::vector<int>(num_rays, -1));
+    features.resize(num_images);
+    for (int i = 0; i < num_images; ++i)
+    {
+        features[i].img_idx = i;
+        features[i].img_size = img_size;
+    }
+    for (int k = 0; k < num_rays; ++k)
+    {
+        double yaw = rng.uniform(0., 2 * CV_PI), pitch = rng.uniform(-0.25, 0.25) * (num_rows + 1);
+        Matx31d X(std::sin(yaw) * std::cos(pitch), std::sin(pitch), std::cos(yaw) * std::cos(pitch));
+        for (int i = 0; i < num_images; ++i)
+        {
+            Matx31d p = Matx33d(cameras[i].K()) * Matx33d(cameras[i].R).t() * X;
+            Point2f pt((float)(p(0) / p(2)), (float)(p(1) / p(2)));
+            if (p(2) <= 0 || !Rect(0, 0, img_size.width, img_size.height).contains(pt))
+                continue;
+            visible[i][k] = (int)features[i].keypoints.size();
+            features[i].keypoints.push_back(KeyPoint(pt, 1.f));
+        }
+    }
+
+    pairwise_matches.assign(num_images * num_images, detail::MatchesInfo());
+    for (int i = 0; i < num_images; ++i)
+        for (int j = 0; j < num_images; ++j)
+        {
+            detail::MatchesInfo &info = pairwise_matches[i * num_images + j];
+            info.src_img_idx = i;
+            info.dst_img_idx = j;
+            for (int k = 0; i != j && k < num_rays; ++k)
+                if (visible[i][k] >= 0 && visible[j][k] >= 0)
+                    info.matches.push_back(DMatch(visible[i][k], visible[j][k], 0.f));
+            info.inliers_mask.assign(info.matches.size(), (uchar)1);
+            info.num_inliers = (int)info.matches.size();
+            if (info.num_inliers < 20)
+                continue;
+            info.confidence = info.num_inliers / (8 + 0.3 * info.num_inliers);
+            Matx33d Ki(cameras[i].K()), Kj(cameras[j].K()), Ri(cameras[i].R), Rj(cameras[j].R);
+            info.H = Mat(Kj * Rj.t() * Ri * Ki.inv());
+        }
+}
+
+PERF_TEST_P(bundleAdjusterSynthetic, rotation,
+            testing::Combine(testing::Values(18, 54), testing::Values("ray", "reproj")))
+{
+    int num_images = get<0>(GetParam());
+    string adjuster_fun = get<1>(GetParam());
+
+    std::vector<detail::ImageFeatures> features;
+    std::vector<detail::MatchesInfo> pairwise_matches;
+    std::vector<detail::CameraParams> gt, cameras;
+    makeSyntheticPanorama(num_images, features, pairwise_matches, gt);
+
+    Ptr<detail::BundleAdjusterBase> bundle_adjuster;
+    if (adjuster_fun == "ray")
+        bundle_adjuster = makePtr<detail::BundleAdjusterRay>();
+    else
+        bundle_adjuster = makePtr<detail::BundleAdjusterReproj>();
+    // exact features: the fixed number of iterations, otherwise the adjuster follows the gauge
+    // freedom down to the rounding errors
+    bundle_adjuster->setTermCriteria(TermCriteria(TermCriteria::COUNT, 10, 0));
+
+    RNG rng(0);
+    for (size_t i = 0; i < gt.size(); ++i)
+    {
+        gt[i].focal *= 1.05;
+        Matx33d dR;
+        cv::Rodrigues(Vec3d(rng.uniform(-0.01, 0.01), rng.uniform(-0.01, 0.01), rng.uniform(-0.01, 0.01)), dR);
+        Mat(dR * Matx33d(gt[i].R)).convertTo(gt[i].R, CV_32F);
+    }
+
+    bool success = true;
+    while(next())
+    {
+        cameras = gt; // revert cameras back to original initial guess
+        startTimer();
+        success = (*bundle_adjuster)(features, pairwise_matches, cameras);
+        stopTimer();
+    }
+
+    EXPECT_TRUE(success);
+    SANITY_CHECK_NOTHING();
+}
+
 } // namespace
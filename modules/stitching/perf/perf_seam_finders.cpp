@@ -0,0 +1,52 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+#include "opencv2/imgproc.hpp"
+
+namespace opencv_test
+{
+using namespace perf;
+
+typedef TestBaseWithParam<string> graphCutSeamFinder;
+
+// two rows of 8 overlapping images of 480x360 pixels
+PERF_TEST_P(graphCutSeamFinder, panorama, testing::Values("full", "coarse"))
+{
+    const int cols = 8, rows = 2;
+    const Size size(480, 360);
+    RNG rng(0);
+    Mat noise(Size(size.width * cols, size.height * rows) / 8, CV_8UC3), scene;
+    rng.fill(noise, RNG::UNIFORM, 0, 255);
+    resize(noise, scene, noise.size() * 8, 0, 0, INTER_LINEAR);
+
+    std::vector<UMat> images, masks(cols * rows);
+    std::vector<Point> corners;
+    for (int r = 0; r < rows; ++r)
+        for (int c = 0; c < cols; ++c)
+        {
+            Point tl(c * size.width * 3 / 4 + rng.uniform(0, 20), r * size.height * 3 / 4 + rng.uniform(0, 20));
+            UMat image;
+            scene(Rect(tl, size)).convertTo(image, CV_32FC3, rng.uniform(0.8, 1.2));
+            images.push_back(image);
+            corners.push_back(tl);
+        }
+
+    detail::GraphCutSeamFinder finder(detail::GraphCutSeamFinderBase::COST_COLOR_GRAD);
+    if (GetParam() == "coarse")
+        finder.setCoarseScale(4);
+
+    declare.time(120);
+
+    TEST_CYCLE()
+    {
+        for (size_t i = 0; i < masks.size(); ++i)
+            masks[i].create(size, CV_8U), masks[i].setTo(Scalar::all(255));
+        finder.find(images, corners, masks);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+} // namespace
@@ -0,0 +1,65 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+#include "opencv2/imgproc.hpp"
+
+namespace opencv_test
+{
+using namespace perf;
+
+typedef TestBaseWithParam<string> cachedRotationWarper;
+
+// a frame of a rig of 6 cameras of 1920x1080 pixels around the vertical axis,
+// warped, compensated and converted for blending
+PERF_TEST_P(cachedRotationWarper, rig_frame, testing::Values("direct", "cached"))
+{
+    const int num_cameras = 6;
+    const Size size(1920, 1080);
+    const float focal = 1200.f;
+
+    std::vector<Mat> frames(num_cameras), rotations(num_cameras);
+    std::vector<double> gains(num_cameras);
+    Mat K = (Mat_<float>(3, 3) << focal, 0, size.width / 2.f, 0, focal, size.height / 2.f, 0, 0, 1);
+    RNG rng(0);
+    for (int i = 0; i < num_cameras; ++i)
+    {
+        frames[i].create(size, CV_8UC3);
+        rng.fill(frames[i], RNG::UNIFORM, 0, 255);
+        float angle = (float)(CV_2PI * i / num_cameras);
+        rotations[i] = (Mat_<float>(3, 3) << std::cos(angle), 0, std::sin(angle),
+                                             0, 1, 0,
+                                             -std::sin(angle), 0, std::cos(angle));
+        gains[i] = rng.uniform(0.8, 1.2);
+    }
+
+    Ptr<detail::RotationWarper> spherical = makePtr<detail::SphericalWarper>(focal);
+    detail::CachedRotationWarper cached(makePtr<detail::SphericalWarper>(focal));
+    std::vector<Mat> warped(num_cameras), masks(num_cameras);
+    Mat full_mask(size, CV_8U, Scalar::all(255)), tmp;
+    const bool use_cache = GetParam() == "cached";
+
+    declare.time(60);
+
+    TEST_CYCLE()
+    {
+        for (int i = 0; i < num_cameras; ++i)
+        {
+            if (use_cache)
+            {
+                cached.warpCompensated(frames[i], K, rotations[i], INTER_LINEAR, BORDER_REFLECT, gains[i],
+                                       warped[i], masks[i]);
+                continue;
+            }
+            spherical->warp(frames[i], K, rotations[i], INTER_LINEAR, BORDER_REFLECT, tmp);
+            spherical->warp(full_mask, K, rotations[i], INTER_NEAREST, BORDER_CONSTANT, masks[i]);
+            cv::multiply(tmp, gains[i], tmp);
+            tmp.convertTo(warped[i], CV_16S);
+        }
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+} // namespace
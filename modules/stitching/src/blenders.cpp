@@ -65,6 +65,88 @@ namespace detail {
 
 static const float WEIGHT_EPS = 1e-5f;
 
+// Returns the area of the panorama covered by the pyramids of the source image. The source is kept
+// with a small border and the corners of the area are aligned to (1 << num_bands) in the panorama.
+static Rect sourceRoiWithBorder(Rect dst_roi, Point tl, Size size, int num_bands)
+{
+    // Keep source image in memory with small border
+    int gap = 3 * (1 << num_bands);
+    Point tl_new(std::max(dst_roi.x, tl.x - gap),
+                 std::max(dst_roi.y, tl.y - gap));
+    Point br_new(std::min(dst_roi.br().x, tl.x + size.width + gap),
+                 std::min(dst_roi.br().y, tl.y + size.height + gap));
+
+    // Ensure coordinates of top-left, bottom-right corners are divided by (1 << num_bands).
+    // After that scale between layers is exactly 2.
+    //
+    // We do it to avoid interpolation problems when keeping sub-images only. There is no such problem when
+    // image is bordered to have size equal to the final image size, but this is too memory hungry approach.
+    tl_new.x = dst_roi.x + (((tl_new.x - dst_roi.x) >> num_bands) << num_bands);
+    tl_new.y = dst_roi.y + (((tl_new.y - dst_roi.y) >> num_bands) << num_bands);
+    int width = br_new.x - tl_new.x;
+    int height = br_new.y - tl_new.y;
+    width += ((1 << num_bands) - width % (1 << num_bands)) % (1 << num_bands);
+    height += ((1 << num_bands) - height % (1 << num_bands)) % (1 << num_bands);
+    br_new.x = tl_new.x + width;
+    br_new.y = tl_new.y + height;
+    int dy = std::max(br_new.y - dst_roi.br().y, 0);
+    int dx = std::max(br_new.x - dst_roi.br().x, 0);
+    tl_new.x -= dx; br_new.x -= dx;
+    tl_new.y -= dy; br_new.y -= dy;
+
+    return Rect(tl_new, br_new);
+}
+
+// Adds the weighted layer of the source Laplacian pyramid to the layer of the final pyramid
+static void addWeightedLayer(const Mat &src, const Mat &weight, Mat &dst, Mat &dst_weight)
+{
+    if (weight.type() == CV_32F)
+    {
+        for (int y = 0; y < dst.rows; ++y)
+        {
+            const Point3_<short>* src_row = src.ptr<Point3_<short> >(y);
+            Point3_<short>* dst_row = dst.ptr<Point3_<short> >(y);
+            const float* weight_row = weight.ptr<float>(y);
+            float* dst_weight_row = dst_weight.ptr<float>(y);
+
+            for (int x = 0; x < dst.cols; ++x)
+            {
+                dst_row[x].x += static_cast<short>(src_row[x].x * weight_row[x]);
+                dst_row[x].y += static_cast<short>(src_row[x].y * weight_row[x]);
+                dst_row[x].z += static_cast<short>(src_row[x].z * weight_row[x]);
+                dst_weight_row[x] += weight_row[x];
+            }
+        }
+    }
+    else // weight_type_ == CV_16S
+    {
+        for (int y = 0; y < dst.rows; ++y)
+        {
+            const Point3_<short>* src_row = src.ptr<Point3_<short> >(y);
+            Point3_<short>* dst_row = dst.ptr<Point3_<short> >(y);
+            const short* weight_row = weight.ptr<short>(y);
+            short* dst_weight_row = dst_weight.ptr<short>(y);
+
+            for (int x = 0; x < dst.cols; ++x)
+            {
+                dst_row[x].x += short((src_row[x].x * weight_row[x]) >> 8);
+                dst_row[x].y += short((src_row[x].y * weight_row[x]) >> 8);
+                dst_row[x].z += short((src_row[x].z * weight_row[x]) >> 8);
+                dst_weight_row[x] += weight_row[x];
+            }
+        }
+    }
+}
+
+static inline void getArr(InputArray arr, Mat &m) { m = arr.getMat(); }
+static inline void getArr(InputArray arr, UMat &m) { m = arr.getUMat(); }
+
+template <typename M>
+static void createLaplacePyr_(InputArray img, int num_levels, std::vector<M> &pyr);
+template <typename M>
+static void restoreImageFromLaplacePyr_(std::vector<M> &pyr);
+static void normalizeUsingWeightMap_(const Mat &weight, Mat &src);
+
 Ptr<Blender> Blender::createDefault(int type, bool try_gpu)
 {
     if (type == NO)
@@ -364,30 +446,8 @@ void MultiBandBlender::feed(InputArray _img, InputArray mask, Point tl)
     CV_Assert(img.type() == CV_16SC3 || img.type() == CV_8UC3);
     CV_Assert(mask.type() == CV_8U);
 
-    // Keep source image in memory with small border
-    int gap = 3 * (1 << num_bands_);
-    Point tl_new(std::max(dst_roi_.x, tl.x - gap),
-                 std::max(dst_roi_.y, tl.y - gap));
-    Point br_new(std::min(dst_roi_.br().x, tl.x + img.cols + gap),
-                 std::min(dst_roi_.br().y, tl.y + img.rows + gap));
-
-    // Ensure coordinates of top-left, bottom-right corners are divided by (1 << num_bands_).
-    // After that scale between layers is exactly 2.
-    //
-    // We do it to avoid interpolation problems when keeping sub-images only. There is no such problem when
-    // image is bordered to have size equal to the final image size, but this is too memory hungry approach.
-    tl_new.x = dst_roi_.x + (((tl_new.x - dst_roi_.x) >> num_bands_) << num_bands_);
-    tl_new.y = dst_roi_.y + (((tl_new.y - dst_roi_.y) >> num_bands_) << num_bands_);
-    int width = br_new.x - tl_new.x;
-    int height = br_new.y - tl_new.y;
-    width += ((1 << num_bands_) - width % (1 << num_bands_)) % (1 << num_bands_);
-    height += ((1 << num_bands_) - height % (1 << num_bands_)) % (1 << num_bands_);
-    br_new.x = tl_new.x + width;
-    br_new.y = tl_new.y + height;
-    int dy = std::max(br_new.y - dst_roi_.br().y, 0);
-    int dx = std::max(br_new.x - dst_roi_.br().x, 0);
-    tl_new.x -= dx; br_new.x -= dx;
-    tl_new.y -= dy; br_new.y -= dy;
+    Rect src_roi = sourceRoiWithBorder(dst_roi_, tl, img.size(), num_bands_);
+    Point tl_new = src_roi.tl(), br_new = src_roi.br();
 
     int top = tl.y - tl_new.y;
     int left = tl.x - tl_new.x;
@@ -548,42 +608,7 @@ void MultiBandBlender::feed(InputArray _img, InputArray mask, Point tl)
             Mat _dst_pyr_laplace = dst_pyr_laplace_[i](rc).getMat(ACCESS_RW);
             Mat _weight_pyr_gauss = weight_pyr_gauss[i].getMat(ACCESS_READ);
             Mat _dst_band_weights = dst_band_weights_[i](rc).getMat(ACCESS_RW);
-            if (weight_type_ == CV_32F)
-            {
-                for (int y = 0; y < rc.height; ++y)
-                {
-                    const Point3_<short>* src_row = _src_pyr_laplace.ptr<Point3_<short> >(y);
-                    Point3_<short>* dst_row = _dst_pyr_laplace.ptr<Point3_<short> >(y);
-                    const float* weight_row = _weight_pyr_gauss.ptr<float>(y);
-                    float* dst_weight_row = _dst_band_weights.ptr<float>(y);
-
-                    for (int x = 0; x < rc.width; ++x)
-                    {
-                        dst_row[x].x += static_cast<short>(src_row[x].x * weight_row[x]);
-                        dst_row[x].y += static_cast<short>(src_row[x].y * weight_row[x]);
-                        dst_row[x].z += static_cast<short>(src_row[x].z * weight_row[x]);
-                        dst_weight_row[x] += weight_row[x];
-                    }
-                }
-            }
-            else // weight_type_ == CV_16S
-            {
-                for (int y = 0; y < y_br - y_tl; ++y)
-                {
-                    const Point3_<short>* src_row = _src_pyr_laplace.ptr<Point3_<short> >(y);
-                    Point3_<short>* dst_row = _dst_pyr_laplace.ptr<Point3_<short> >(y);
-                    const short* weight_row = _weight_pyr_gauss.ptr<short>(y);
-                    short* dst_weight_row = _dst_band_weights.ptr<short>(y);
-
-                    for (int x = 0; x < x_br - x_tl; ++x)
-                    {
-                        dst_row[x].x += short((src_row[x].x * weight_row[x]) >> 8);
-                        dst_row[x].y += short((src_row[x].y * weight_row[x]) >> 8);
-                        dst_row[x].z += short((src_row[x].z * weight_row[x]) >> 8);
-                        dst_weight_row[x] += weight_row[x];
-                    }
-                }
-            }
+            addWeightedLayer(_src_pyr_laplace, _weight_pyr_gauss, _dst_pyr_laplace, _dst_band_weights);
         }
 #ifdef HAVE_OPENCL
         else
@@ -692,6 +717,198 @@ void MultiBandBlender::blend(InputOutputArray dst, InputOutputArray dst_mask)
 }
 
 
+TiledMultiBandBlender::TiledMultiBandBlender(int num_bands, Size tile_size, int weight_type)
+{
+    num_bands_ = 0;
+    setNumBands(num_bands);
+    setTileSize(tile_size);
+
+    CV_Assert(weight_type == CV_32F || weight_type == CV_16S);
+    weight_type_ = weight_type;
+}
+
+
+void TiledMultiBandBlender::prepare(Rect dst_roi)
+{
+    dst_roi_final_ = dst_roi;
+
+    // Crop unnecessary bands
+    double max_len = static_cast<double>(std::max(dst_roi.width, dst_roi.height));
+    num_bands_ = std::min(actual_num_bands_, static_cast<int>(ceil(std::log(max_len) / std::log(2.0))));
+
+    // Add border to the final image, to ensure sizes are divided by (1 << num_bands_)
+    dst_roi.width += ((1 << num_bands_) - dst_roi.width % (1 << num_bands_)) % (1 << num_bands_);
+    dst_roi.height += ((1 << num_bands_) - dst_roi.height % (1 << num_bands_)) % (1 << num_bands_);
+
+    // The panorama itself is never allocated, only the sources are kept until blend()
+    dst_roi_ = dst_roi;
+    sources_.clear();
+}
+
+
+void TiledMultiBandBlender::feed(InputArray img, InputArray mask, Point tl)
+{
+    CV_Assert(img.type() == CV_16SC3 || img.type() == CV_8UC3);
+    CV_Assert(mask.type() == CV_8U && mask.size() == img.size());
+
+    Source src;
+    img.copyTo(src.img);
+    mask.copyTo(src.mask);
+    src.tl = tl;
+    src.roi = sourceRoiWithBorder(dst_roi_, tl, src.img.size(), num_bands_) - dst_roi_.tl();
+    sources_.push_back(src);
+}
+
+
+// Blends the tile of the panorama given in the coordinates of the bordered panorama. The pyramids are
+// built for the tile with a margin, which hides the difference from the pyramids of the whole panorama
+// at the borders of the tile.
+void TiledMultiBandBlender::blendTile(Rect tile, Mat &dst, Mat &dst_mask) const
+{
+    int margin = 4 << num_bands_;
+    Rect area(tile.x - margin, tile.y - margin, tile.width + 2 * margin, tile.height + 2 * margin);
+    area &= Rect(Point(), dst_roi_.size());
+
+    std::vector<Mat> dst_pyr_laplace(num_bands_ + 1), dst_band_weights(num_bands_ + 1);
+    for (int i = 0; i <= num_bands_; ++i)
+    {
+        dst_pyr_laplace[i] = Mat::zeros(area.height >> i, area.width >> i, CV_16SC3);
+        dst_band_weights[i] = Mat::zeros(area.height >> i, area.width >> i, weight_type_);
+    }
+
+    std::vector<int> xofs;
+    std::vector<Mat> src_pyr_laplace, weight_pyr_gauss(num_bands_ + 1);
+    for (size_t k = 0; k < sources_.size(); ++k)
+    {
+        const Source &src = sources_[k];
+        Rect rc = src.roi & area;
+        if (rc.empty())
+            continue;
+
+        // Cut the part of the bordered source image and of its mask, as they are created by MultiBandBlender::feed
+        Point ofs = rc.tl() + dst_roi_.tl() - src.tl;
+        Mat img_with_border(rc.size(), src.img.type()), mask_with_border(rc.size(), CV_8U, Scalar::all(0));
+        size_t esz = src.img.elemSize();
+        xofs.resize(rc.width);
+        for (int x = 0; x < rc.width; ++x)
+            xofs[x] = borderInterpolate(ofs.x + x, src.img.cols, BORDER_REFLECT);
+        // [x0, x1) is the part of the row inside the source
+        int x0 = std::min(std::max(-ofs.x, 0), rc.width), x1 = std::max(std::min(src.img.cols - ofs.x, rc.width), x0);
+        for (int y = 0; y < rc.height; ++y)
+        {
+            const uchar *src_row = src.img.ptr(borderInterpolate(ofs.y + y, src.img.rows, BORDER_REFLECT));
+            uchar *dst_row = img_with_border.ptr(y);
+            for (int x = 0; x < x0; ++x)
+                memcpy(dst_row + x * esz, src_row + xofs[x] * esz, esz);
+            if (x0 < x1)
+                memcpy(dst_row + x0 * esz, src_row + (ofs.x + x0) * esz, (x1 - x0) * esz);
+            for (int x = x1; x < rc.width; ++x)
+                memcpy(dst_row + x * esz, src_row + xofs[x] * esz, esz);
+
+            int sy = ofs.y + y;
+            if (sy >= 0 && sy < src.mask.rows && x0 < x1)
+                memcpy(mask_with_border.ptr(y) + x0, src.mask.ptr(sy) + ofs.x + x0, x1 - x0);
+        }
+
+        createLaplacePyr_(img_with_border, num_bands_, src_pyr_laplace);
+
+        if (weight_type_ == CV_32F)
+        {
+            mask_with_border.convertTo(weight_pyr_gauss[0], CV_32F, 1./255.);
+        }
+        else // weight_type_ == CV_16S
+        {
+            mask_with_border.convertTo(weight_pyr_gauss[0], CV_16S);
+            Mat add_mask;
+            compare(mask_with_border, 0, add_mask, CMP_NE);
+            add(weight_pyr_gauss[0], Scalar::all(1), weight_pyr_gauss[0], add_mask);
+        }
+        for (int i = 0; i < num_bands_; ++i)
+            pyrDown(weight_pyr_gauss[i], weight_pyr_gauss[i + 1]);
+
+        for (int i = 0; i <= num_bands_; ++i)
+        {
+            Rect lrc((rc.x - area.x) >> i, (rc.y - area.y) >> i, rc.width >> i, rc.height >> i);
+            Mat dst_layer = dst_pyr_laplace[i](lrc), dst_weights = dst_band_weights[i](lrc);
+            addWeightedLayer(src_pyr_laplace[i], weight_pyr_gauss[i], dst_layer, dst_weights);
+        }
+    }
+
+    for (int i = 0; i <= num_bands_; ++i)
+        normalizeUsingWeightMap_(dst_band_weights[i], dst_pyr_laplace[i]);
+
+    restoreImageFromLaplacePyr_(dst_pyr_laplace);
+
+    Rect inner(tile.tl() - area.tl(), tile.size());
+    compare(dst_band_weights[0](inner), WEIGHT_EPS, dst_mask, CMP_GT);
+    dst.setTo(Scalar::all(0));
+    dst_pyr_laplace[0](inner).copyTo(dst, dst_mask);
+}
+
+
+void TiledMultiBandBlender::blend(BlendedStripeWriter &writer)
+{
+    CV_Assert(tile_size_.width > 0 && tile_size_.height > 0);
+
+    // The tiles are aligned as the sources, so the layers of the tile pyramids are exactly 2 times smaller
+    int align = 1 << num_bands_;
+    Size tile_size((tile_size_.width + align - 1) / align * align, (tile_size_.height + align - 1) / align * align);
+    int ntiles = (dst_roi_.width + tile_size.width - 1) / tile_size.width;
+
+    Mat stripe, stripe_mask;
+    for (int y = 0; y < dst_roi_final_.height; y += tile_size.height)
+    {
+        int height = std::min(tile_size.height, dst_roi_.height - y);
+        stripe.create(height, dst_roi_.width, CV_16SC3);
+        stripe_mask.create(height, dst_roi_.width, CV_8U);
+
+        parallel_for_(Range(0, ntiles), [&](const Range &range)
+        {
+            for (int i = range.start; i < range.end; ++i)
+            {
+                int x = i * tile_size.width;
+                Rect tile(x, y, std::min(tile_size.width, dst_roi_.width - x), height);
+                Mat dst = stripe.colRange(x, x + tile.width), dst_mask = stripe_mask.colRange(x, x + tile.width);
+                blendTile(tile, dst, dst_mask);
+            }
+        });
+
+        Rect rc(0, 0, dst_roi_final_.width, std::min(height, dst_roi_final_.height - y));
+        writer.write(y, stripe(rc), stripe_mask(rc));
+    }
+
+    sources_.clear();
+}
+
+
+namespace {
+class PanoramaStripeWriter : public BlendedStripeWriter
+{
+public:
+    PanoramaStripeWriter(Mat &dst, Mat &dst_mask) : dst_(dst), dst_mask_(dst_mask) {}
+
+    void write(int y, const Mat &stripe, const Mat &stripe_mask) CV_OVERRIDE
+    {
+        stripe.copyTo(dst_.rowRange(y, y + stripe.rows));
+        stripe_mask.copyTo(dst_mask_.rowRange(y, y + stripe.rows));
+    }
+
+private:
+    Mat &dst_, &dst_mask_;
+};
+}
+
+
+void TiledMultiBandBlender::blend(InputOutputArray dst, InputOutputArray dst_mask)
+{
+    Mat pano(dst_roi_final_.size(), CV_16SC3), pano_mask(dst_roi_final_.size(), CV_8U);
+    PanoramaStripeWriter writer(pano, pano_mask);
+    blend(writer);
+    dst.assign(pano);
+    dst_mask.assign(pano_mask);
+}
+
+
 //////////////////////////////////////////////////////////////////////////////
 // Auxiliary functions
 
@@ -716,55 +933,59 @@ static bool ocl_normalizeUsingWeightMap(InputArray _weight, InputOutputArray _ma
 }
 #endif
 
-void normalizeUsingWeightMap(InputArray _weight, InputOutputArray _src)
+static void normalizeUsingWeightMap_(const Mat &weight, Mat &src)
 {
-    Mat src;
-    Mat weight;
+    CV_Assert(src.type() == CV_16SC3);
 
-#ifdef HAVE_OPENCL
-    if ( !cv::ocl::isOpenCLActivated() ||
-            !ocl_normalizeUsingWeightMap(_weight, _src) )
-#endif
+    if (weight.type() == CV_32FC1)
     {
-        src = _src.getMat();
-        weight = _weight.getMat();
-
-        CV_Assert(src.type() == CV_16SC3);
-
-        if (weight.type() == CV_32FC1)
+        for (int y = 0; y < src.rows; ++y)
         {
-            for (int y = 0; y < src.rows; ++y)
+            Point3_<short> *row = src.ptr<Point3_<short> >(y);
+            const float *weight_row = weight.ptr<float>(y);
+
+            for (int x = 0; x < src.cols; ++x)
             {
-                Point3_<short> *row = src.ptr<Point3_<short> >(y);
-                const float *weight_row = weight.ptr<float>(y);
-
-                for (int x = 0; x < src.cols; ++x)
-                {
-                    row[x].x = static_cast<short>(row[x].x / (weight_row[x] + WEIGHT_EPS));
-                    row[x].y = static_cast<short>(row[x].y / (weight_row[x] + WEIGHT_EPS));
-                    row[x].z = static_cast<short>(row[x].z / (weight_row[x] + WEIGHT_EPS));
-                }
+                row[x].x = static_cast<short>(row[x].x / (weight_row[x] + WEIGHT_EPS));
+                row[x].y = static_cast<short>(row[x].y / (weight_row[x] + WEIGHT_EPS));
+                row[x].z = static_cast<short>(row[x].z / (weight_row[x] + WEIGHT_EPS));
             }
         }
-        else
+    }
+    else
+    {
+        CV_Assert(weight.type() == CV_16SC1);
+
+        for (int y = 0; y < src.rows; ++y)
         {
-            CV_Assert(weight.type() == CV_16SC1);
+            const short *weight_row = weight.ptr<short>(y);
+            Point3_<short> *row = src.ptr<Point3_<short> >(y);
 
-            for (int y = 0; y < src.rows; ++y)
+            for (int x = 0; x < src.cols; ++x)
             {
-                const short *weight_row = weight.ptr<short>(y);
-                Point3_<short> *row = src.ptr<Point3_<short> >(y);
-
-                for (int x = 0; x < src.cols; ++x)
-                {
-                    int w = weight_row[x] + 1;
-                    row[x].x = static_cast<short>((row[x].x << 8) / w);
-                    row[x].y = static_cast<short>((row[x].y << 8) / w);
-                    row[x].z = static_cast<short>((row[x].z << 8) / w);
-                }
+                int w = weight_row[x] + 1;
+                row[x].x = static_cast<short>((row[x].x << 8) / w);
+                row[x].y = static_cast<short>((row[x].y << 8) / w);
+                row[x].z = static_cast<short>((row[x].z << 8) / w);
             }
         }
     }
+}
+
+void normalizeUsingWeightMap(InputArray _weight, InputOutputArray _src)
+{
+    Mat src;
+    Mat weight;
+
+#ifdef HAVE_OPENCL
+    if ( !cv::ocl::isOpenCLActivated() ||
+            !ocl_normalizeUsingWeightMap(_weight, _src) )
+#endif
+    {
+        src = _src.getMat();
+        weight = _weight.getMat();
+        normalizeUsingWeightMap_(weight, src);
+    }
 #ifdef HAVE_OPENCL
     else
     {
@@ -784,7 +1005,8 @@ void createWeightMap(InputArray mask, float sharpness, InputOutputArray weight)
 }
 
 
-void createLaplacePyr(InputArray img, int num_levels, std::vector<UMat> &pyr)
+template <typename M>
+static void createLaplacePyr_(InputArray img, int num_levels, std::vector<M> &pyr)
 {
     pyr.resize(num_levels + 1);
 
@@ -792,18 +1014,21 @@ void createLaplacePyr(InputArray img, int num_levels, std::vector<UMat> &pyr)
     {
         if(num_levels == 0)
         {
-            img.getUMat().convertTo(pyr[0], CV_16S);
+            M src;
+            getArr(img, src);
+            src.convertTo(pyr[0], CV_16S);
             return;
         }
 
-        UMat downNext;
-        UMat current = img.getUMat();
+        M downNext;
+        M current;
+        getArr(img, current);
         pyrDown(img, downNext);
 
         for(int i = 1; i < num_levels; ++i)
         {
-            UMat lvl_up;
-            UMat lvl_down;
+            M lvl_up;
+            M lvl_down;
 
             pyrDown(downNext, lvl_down);
             pyrUp(downNext, lvl_up, current.size());
@@ -814,7 +1039,7 @@ void createLaplacePyr(InputArray img, int num_levels, std::vector<UMat> &pyr)
         }
 
         {
-            UMat lvl_up;
+            M lvl_up;
             pyrUp(downNext, lvl_up, current.size());
             subtract(current, lvl_up, pyr[num_levels-1], noArray(), CV_16S);
 
@@ -823,10 +1048,10 @@ void createLaplacePyr(InputArray img, int num_levels, std::vector<UMat> &pyr)
     }
     else
     {
-        pyr[0] = img.getUMat();
+        getArr(img, pyr[0]);
         for (int i = 0; i < num_levels; ++i)
             pyrDown(pyr[i], pyr[i + 1]);
-        UMat tmp;
+        M tmp;
         for (int i = 0; i < num_levels; ++i)
         {
             pyrUp(pyr[i + 1], tmp, pyr[i].size());
@@ -836,6 +1061,12 @@ void createLaplacePyr(InputArray img, int num_levels, std::vector<UMat> &pyr)
 }
 
 
+void createLaplacePyr(InputArray img, int num_levels, std::vector<UMat> &pyr)
+{
+    createLaplacePyr_(img, num_levels, pyr);
+}
+
+
 void createLaplacePyrGpu(InputArray img, int num_levels, std::vector<UMat> &pyr)
 {
 #if defined(HAVE_OPENCV_CUDAARITHM) && defined(HAVE_OPENCV_CUDAWARPING)
@@ -864,11 +1095,12 @@ void createLaplacePyrGpu(InputArray img, int num_levels, std::vector<UMat> &pyr)
 }
 
 
-void restoreImageFromLaplacePyr(std::vector<UMat> &pyr)
+template <typename M>
+static void restoreImageFromLaplacePyr_(std::vector<M> &pyr)
 {
     if (pyr.empty())
         return;
-    UMat tmp;
+    M tmp;
     for (size_t i = pyr.size() - 1; i > 0; --i)
     {
         pyrUp(pyr[i], tmp, pyr[i - 1].size());
@@ -877,6 +1109,12 @@ void restoreImageFromLaplacePyr(std::vector<UMat> &pyr)
 }
 
 
+void restoreImageFromLaplacePyr(std::vector<UMat> &pyr)
+{
+    restoreImageFromLaplacePyr_(pyr);
+}
+
+
 void restoreImageFromLaplacePyrGpu(std::vector<UMat> &pyr)
 {
 #if defined(HAVE_OPENCV_CUDAARITHM) && defined(HAVE_OPENCV_CUDAWARPING)
@@ -253,42 +253,64 @@ bool BundleAdjusterBase::estimate(const std::vector<ImageFeatures> &features,
         total_num_matches_ += static_cast<int>(pairwise_matches[edges_[i].first * num_images_ +
                                                                 edges_[i].second].num_inliers);
 
-    CvLevMarq solver(num_images_ * num_params_per_cam_,
-                     total_num_matches_ * num_errs_per_measurement_,
-                     term_criteria_);
-
     Mat err, jac;
-    CvMat matParams = cam_params_;
-    cvCopy(&matParams, solver.param);
-
     int iter = 0;
-    for(;;)
+    if (!edges_.empty() && calcPairError(0, cam_params_, err))
     {
-        const CvMat* _param = 0;
-        CvMat* _jac = 0;
-        CvMat* _err = 0;
+        // every image pair depends on its two cameras only
+        Ptr<SparseLMSolver> solver = SparseLMSolver::create(makePtr<PairErrorCallback>(*this), term_criteria_);
+        for (int i = 0; i < num_images_; ++i)
+            solver->addParamBlock(num_params_per_cam_);
+        for (size_t i = 0; i < edges_.size(); ++i)
+        {
+            const MatchesInfo& matches_info = pairwise_matches[edges_[i].first * num_images_ + edges_[i].second];
+            std::vector<int> blocks(2);
+            blocks[0] = edges_[i].first;
+            blocks[1] = edges_[i].second;
+            solver->addResidualBlock(matches_info.num_inliers * num_errs_per_measurement_, blocks);
+        }
+        // the damped normal equations are positive definite, SVD is the fallback
+        solver->setDecompositionType(DECOMP_CHOLESKY);
+        iter = solver->run(cam_params_);
+        calcErrorByPairs(err);
+    }
+    else
+    {
+        CvLevMarq solver(num_images_ * num_params_per_cam_,
+                         total_num_matches_ * num_errs_per_measurement_,
+                         term_criteria_);
 
-        bool proceed = solver.update(_param, _jac, _err);
+        CvMat matParams = cam_params_;
+        cvCopy(&matParams, solver.param);
 
-        cvCopy(_param, &matParams);
+        for(;;)
+        {
+            const CvMat* _param = 0;
+            CvMat* _jac = 0;
+            CvMat* _err = 0;
 
-        if (!proceed || !_err)
-            break;
+            bool proceed = solver.update(_param, _jac, _err);
 
-        if (_jac)
-        {
-            calcJacobian(jac);
-            CvMat tmp = jac;
-            cvCopy(&tmp, _jac);
-        }
+            cvCopy(_param, &matParams);
 
-        if (_err)
-        {
-            calcError(err);
-            LOG_CHAT(".");
-            iter++;
-            CvMat tmp = err;
-            cvCopy(&tmp, _err);
+            if (!proceed || !_err)
+                break;
+
+            if (_jac)
+            {
+                calcJacobian(jac);
+                CvMat tmp = jac;
+                cvCopy(&tmp, _jac);
+            }
+
+            if (_err)
+            {
+                calcError(err);
+                LOG_CHAT(".");
+                iter++;
+                CvMat tmp = err;
+                cvCopy(&tmp, _err);
+            }
         }
     }
 
@@ -324,6 +346,87 @@ bool BundleAdjusterBase::estimate(const std::vector<ImageFeatures> &features,
 }
 
 
+class BundleAdjusterBase::PairErrorCallback : public SparseLMSolver::Callback
+{
+public:
+    PairErrorCallback(const BundleAdjusterBase &adjuster) : adjuster_(adjuster) {}
+
+    bool compute(int edge_idx, InputArray param, OutputArray err, OutputArray J) const CV_OVERRIDE
+    {
+        Mat cam_params = param.getMat(), pair_err, pair_jac;
+        if (!adjuster_.calcPairError(edge_idx, cam_params, pair_err))
+            return false;
+        // one progress dot per evaluation of the error, as with CvLevMarq
+        if (edge_idx == 0)
+            LOG_CHAT(".");
+        pair_err.copyTo(err);
+        if (J.needed())
+        {
+            adjuster_.calcPairJacobian(edge_idx, cam_params, pair_jac);
+            pair_jac.copyTo(J);
+        }
+        return true;
+    }
+
+private:
+    const BundleAdjusterBase &adjuster_;
+};
+
+
+bool BundleAdjusterBase::calcPairError(int, const Mat &, Mat &) const
+{
+    return false;
+}
+
+
+void BundleAdjusterBase::calcPairJacobian(int edge_idx, const Mat &cam_params, Mat &jac) const
+{
+    calcPairJacobianNumeric(edge_idx, cam_params, 1e-4, 0, jac);
+}
+
+
+void BundleAdjusterBase::calcPairJacobianNumeric(int edge_idx, const Mat &cam_params, double step,
+                                                 const uchar *refine, Mat &jac) const
+{
+    Mat params = cam_params.clone(), err1, err2;
+    const int cams[2] = { edges_[edge_idx].first, edges_[edge_idx].second };
+    for (int c = 0; c < 2; ++c)
+    {
+        for (int j = 0; j < num_params_per_cam_; ++j)
+        {
+            int col = c * num_params_per_cam_ + j;
+            double &val = params.at<double>(cams[c] * num_params_per_cam_ + j, 0);
+            double val0 = val;
+            val = val0 - step;
+            calcPairError(edge_idx, params, err1);
+            val = val0 + step;
+            calcPairError(edge_idx, params, err2);
+            val = val0;
+            if (col == 0)
+                jac.create(err1.rows, 2 * num_params_per_cam_, CV_64F);
+            if (refine && !refine[j])
+                jac.col(col).setTo(0);
+            else
+                calcDeriv(err1, err2, 2 * step, jac.col(col));
+        }
+    }
+}
+
+
+void BundleAdjusterBase::calcErrorByPairs(Mat &err) const
+{
+    err.create(total_num_matches_ * num_errs_per_measurement_, 1, CV_64F);
+    Mat pair_err;
+    int ofs = 0;
+    for (size_t edge_idx = 0; edge_idx < edges_.size(); ++edge_idx)
+    {
+        calcPairError(static_cast<int>(edge_idx), cam_params_, pair_err);
+        pair_err.copyTo(err.rowRange(ofs, ofs + pair_err.rows));
+        ofs += pair_err.rows;
+    }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////
 
 void BundleAdjusterReproj::setUpInitialCameraParams(const std::vector<CameraParams> &cameras)
@@ -374,70 +477,84 @@ void BundleAdjusterReproj::obtainRefinedCameraParams(std::vector<CameraParams> &
 }
 
 
-void BundleAdjusterReproj::calcError(Mat &err)
+bool BundleAdjusterReproj::calcPairError(int edge_idx, const Mat &cam_params, Mat &err) const
 {
-    err.create(total_num_matches_ * 2, 1, CV_64F);
+    int i = edges_[edge_idx].first;
+    int j = edges_[edge_idx].second;
+    double f1 = cam_params.at<double>(i * 7, 0);
+    double f2 = cam_params.at<double>(j * 7, 0);
+    double ppx1 = cam_params.at<double>(i * 7 + 1, 0);
+    double ppx2 = cam_params.at<double>(j * 7 + 1, 0);
+    double ppy1 = cam_params.at<double>(i * 7 + 2, 0);
+    double ppy2 = cam_params.at<double>(j * 7 + 2, 0);
+    double a1 = cam_params.at<double>(i * 7 + 3, 0);
+    double a2 = cam_params.at<double>(j * 7 + 3, 0);
+
+    double R1[9];
+    Mat R1_(3, 3, CV_64F, R1);
+    Mat rvec(3, 1, CV_64F);
+    rvec.at<double>(0, 0) = cam_params.at<double>(i * 7 + 4, 0);
+    rvec.at<double>(1, 0) = cam_params.at<double>(i * 7 + 5, 0);
+    rvec.at<double>(2, 0) = cam_params.at<double>(i * 7 + 6, 0);
+    Rodrigues(rvec, R1_);
+
+    double R2[9];
+    Mat R2_(3, 3, CV_64F, R2);
+    rvec.at<double>(0, 0) = cam_params.at<double>(j * 7 + 4, 0);
+    rvec.at<double>(1, 0) = cam_params.at<double>(j * 7 + 5, 0);
+    rvec.at<double>(2, 0) = cam_params.at<double>(j * 7 + 6, 0);
+    Rodrigues(rvec, R2_);
+
+    const ImageFeatures& features1 = features_[i];
+    const ImageFeatures& features2 = features_[j];
+    const MatchesInfo& matches_info = pairwise_matches_[i * num_images_ + j];
+    err.create(matches_info.num_inliers * 2, 1, CV_64F);
+
+    Mat_<double> K1 = Mat::eye(3, 3, CV_64F);
+    K1(0,0) = f1; K1(0,2) = ppx1;
+    K1(1,1) = f1*a1; K1(1,2) = ppy1;
+
+    Mat_<double> K2 = Mat::eye(3, 3, CV_64F);
+    K2(0,0) = f2; K2(0,2) = ppx2;
+    K2(1,1) = f2*a2; K2(1,2) = ppy2;
+
+    Mat_<double> H = K2 * R2_.inv() * R1_ * K1.inv();
 
     int match_idx = 0;
-    for (size_t edge_idx = 0; edge_idx < edges_.size(); ++edge_idx)
+    for (size_t k = 0; k < matches_info.matches.size(); ++k)
     {
-        int i = edges_[edge_idx].first;
-        int j = edges_[edge_idx].second;
-        double f1 = cam_params_.at<double>(i * 7, 0);
-        double f2 = cam_params_.at<double>(j * 7, 0);
-        double ppx1 = cam_params_.at<double>(i * 7 + 1, 0);
-        double ppx2 = cam_params_.at<double>(j * 7 + 1, 0);
-        double ppy1 = cam_params_.at<double>(i * 7 + 2, 0);
-        double ppy2 = cam_params_.at<double>(j * 7 + 2, 0);
-        double a1 = cam_params_.at<double>(i * 7 + 3, 0);
-        double a2 = cam_params_.at<double>(j * 7 + 3, 0);
-
-        double R1[9];
-        Mat R1_(3, 3, CV_64F, R1);
-        Mat rvec(3, 1, CV_64F);
-        rvec.at<double>(0, 0) = cam_params_.at<double>(i * 7 + 4, 0);
-        rvec.at<double>(1, 0) = cam_params_.at<double>(i * 7 + 5, 0);
-        rvec.at<double>(2, 0) = cam_params_.at<double>(i * 7 + 6, 0);
-        Rodrigues(rvec, R1_);
-
-        double R2[9];
-        Mat R2_(3, 3, CV_64F, R2);
-        rvec.at<double>(0, 0) = cam_params_.at<double>(j * 7 + 4, 0);
-        rvec.at<double>(1, 0) = cam_params_.at<double>(j * 7 + 5, 0);
-        rvec.at<double>(2, 0) = cam_params_.at<double>(j * 7 + 6, 0);
-        Rodrigues(rvec, R2_);
-
-        const ImageFeatures& features1 = features_[i];
-        const ImageFeatures& features2 = features_[j];
-        const MatchesInfo& matches_info = pairwise_matches_[i * num_images_ + j];
-
-        Mat_<double> K1 = Mat::eye(3, 3, CV_64F);
-        K1(0,0) = f1; K1(0,2) = ppx1;
-        K1(1,1) = f1*a1; K1(1,2) = ppy1;
-
-        Mat_<double> K2 = Mat::eye(3, 3, CV_64F);
-        K2(0,0) = f2; K2(0,2) = ppx2;
-        K2(1,1) = f2*a2; K2(1,2) = ppy2;
+        if (!matches_info.inliers_mask[k])
+            continue;
+
+        const DMatch& m = matches_info.matches[k];
+        Point2f p1 = features1.keypoints[m.queryIdx].pt;
+        Point2f p2 = features2.keypoints[m.trainIdx].pt;
+        double x = H(0,0)*p1.x + H(0,1)*p1.y + H(0,2);
+        double y = H(1,0)*p1.x + H(1,1)*p1.y + H(1,2);
+        double z = H(2,0)*p1.x + H(2,1)*p1.y + H(2,2);
+
+        err.at<double>(2 * match_idx, 0) = p2.x - x/z;
+        err.at<double>(2 * match_idx + 1, 0) = p2.y - y/z;
+        match_idx++;
+    }
+    return true;
+}
 
-        Mat_<double> H = K2 * R2_.inv() * R1_ * K1.inv();
 
-        for (size_t k = 0; k < matches_info.matches.size(); ++k)
-        {
-            if (!matches_info.inliers_mask[k])
-                continue;
+void BundleAdjusterReproj::calcError(Mat &err)
+{
+    calcErrorByPairs(err);
+}
 
-            const DMatch& m = matches_info.matches[k];
-            Point2f p1 = features1.keypoints[m.queryIdx].pt;
-            Point2f p2 = features2.keypoints[m.trainIdx].pt;
-            double x = H(0,0)*p1.x + H(0,1)*p1.y + H(0,2);
-            double y = H(1,0)*p1.x + H(1,1)*p1.y + H(1,2);
-            double z = H(2,0)*p1.x + H(2,1)*p1.y + H(2,2);
 
-            err.at<double>(2 * match_idx, 0) = p2.x - x/z;
-            err.at<double>(2 * match_idx + 1, 0) = p2.y - y/z;
-            match_idx++;
-        }
-    }
+void BundleAdjusterReproj::calcPairJacobian(int edge_idx, const Mat &cam_params, Mat &jac) const
+{
+    const uchar refine[7] =
+    {
+        refinement_mask_.at<uchar>(0, 0), refinement_mask_.at<uchar>(0, 2),
+        refinement_mask_.at<uchar>(1, 2), refinement_mask_.at<uchar>(1, 1), 1, 1, 1
+    };
+    calcPairJacobianNumeric(edge_idx, cam_params, 1e-4, refine, jac);
 }
 
 
@@ -549,77 +666,86 @@ void BundleAdjusterRay::obtainRefinedCameraParams(std::vector<CameraParams> &cam
 }
 
 
-void BundleAdjusterRay::calcError(Mat &err)
+bool BundleAdjusterRay::calcPairError(int edge_idx, const Mat &cam_params, Mat &err) const
 {
-    err.create(total_num_matches_ * 3, 1, CV_64F);
+    int i = edges_[edge_idx].first;
+    int j = edges_[edge_idx].second;
+    double f1 = cam_params.at<double>(i * 4, 0);
+    double f2 = cam_params.at<double>(j * 4, 0);
+
+    double R1[9];
+    Mat R1_(3, 3, CV_64F, R1);
+    Mat rvec(3, 1, CV_64F);
+    rvec.at<double>(0, 0) = cam_params.at<double>(i * 4 + 1, 0);
+    rvec.at<double>(1, 0) = cam_params.at<double>(i * 4 + 2, 0);
+    rvec.at<double>(2, 0) = cam_params.at<double>(i * 4 + 3, 0);
+    Rodrigues(rvec, R1_);
+
+    double R2[9];
+    Mat R2_(3, 3, CV_64F, R2);
+    rvec.at<double>(0, 0) = cam_params.at<double>(j * 4 + 1, 0);
+    rvec.at<double>(1, 0) = cam_params.at<double>(j * 4 + 2, 0);
+    rvec.at<double>(2, 0) = cam_params.at<double>(j * 4 + 3, 0);
+    Rodrigues(rvec, R2_);
+
+    const ImageFeatures& features1 = features_[i];
+    const ImageFeatures& features2 = features_[j];
+    const MatchesInfo& matches_info = pairwise_matches_[i * num_images_ + j];
+    err.create(matches_info.num_inliers * 3, 1, CV_64F);
+
+    Mat_<double> K1 = Mat::eye(3, 3, CV_64F);
+    K1(0,0) = f1; K1(0,2) = features1.img_size.width * 0.5;
+    K1(1,1) = f1; K1(1,2) = features1.img_size.height * 0.5;
+
+    Mat_<double> K2 = Mat::eye(3, 3, CV_64F);
+    K2(0,0) = f2; K2(0,2) = features2.img_size.width * 0.5;
+    K2(1,1) = f2; K2(1,2) = features2.img_size.height * 0.5;
+
+    Mat_<double> H1 = R1_ * K1.inv();
+    Mat_<double> H2 = R2_ * K2.inv();
 
     int match_idx = 0;
-    for (size_t edge_idx = 0; edge_idx < edges_.size(); ++edge_idx)
+    for (size_t k = 0; k < matches_info.matches.size(); ++k)
     {
-        int i = edges_[edge_idx].first;
-        int j = edges_[edge_idx].second;
-        double f1 = cam_params_.at<double>(i * 4, 0);
-        double f2 = cam_params_.at<double>(j * 4, 0);
-
-        double R1[9];
-        Mat R1_(3, 3, CV_64F, R1);
-        Mat rvec(3, 1, CV_64F);
-        rvec.at<double>(0, 0) = cam_params_.at<double>(i * 4 + 1, 0);
-        rvec.at<double>(1, 0) = cam_params_.at<double>(i * 4 + 2, 0);
-        rvec.at<double>(2, 0) = cam_params_.at<double>(i * 4 + 3, 0);
-        Rodrigues(rvec, R1_);
-
-        double R2[9];
-        Mat R2_(3, 3, CV_64F, R2);
-        rvec.at<double>(0, 0) = cam_params_.at<double>(j * 4 + 1, 0);
-        rvec.at<double>(1, 0) = cam_params_.at<double>(j * 4 + 2, 0);
-        rvec.at<double>(2, 0) = cam_params_.at<double>(j * 4 + 3, 0);
-        Rodrigues(rvec, R2_);
-
-        const ImageFeatures& features1 = features_[i];
-        const ImageFeatures& features2 = features_[j];
-        const MatchesInfo& matches_info = pairwise_matches_[i * num_images_ + j];
-
-        Mat_<double> K1 = Mat::eye(3, 3, CV_64F);
-        K1(0,0) = f1; K1(0,2) = features1.img_size.width * 0.5;
-        K1(1,1) = f1; K1(1,2) = features1.img_size.height * 0.5;
-
-        Mat_<double> K2 = Mat::eye(3, 3, CV_64F);
-        K2(0,0) = f2; K2(0,2) = features2.img_size.width * 0.5;
-        K2(1,1) = f2; K2(1,2) = features2.img_size.height * 0.5;
-
-        Mat_<double> H1 = R1_ * K1.inv();
-        Mat_<double> H2 = R2_ * K2.inv();
-
-        for (size_t k = 0; k < matches_info.matches.size(); ++k)
-        {
-            if (!matches_info.inliers_mask[k])
-                continue;
-
-            const DMatch& m = matches_info.matches[k];
+        if (!matches_info.inliers_mask[k])
+            continue;
+
+        const DMatch& m = matches_info.matches[k];
+
+        Point2f p1 = features1.keypoints[m.queryIdx].pt;
+        double x1 = H1(0,0)*p1.x + H1(0,1)*p1.y + H1(0,2);
+        double y1 = H1(1,0)*p1.x + H1(1,1)*p1.y + H1(1,2);
+        double z1 = H1(2,0)*p1.x + H1(2,1)*p1.y + H1(2,2);
+        double len = std::sqrt(x1*x1 + y1*y1 + z1*z1);
+        x1 /= len; y1 /= len; z1 /= len;
+
+        Point2f p2 = features2.keypoints[m.trainIdx].pt;
+        double x2 = H2(0,0)*p2.x + H2(0,1)*p2.y + H2(0,2);
+        double y2 = H2(1,0)*p2.x + H2(1,1)*p2.y + H2(1,2);
+        double z2 = H2(2,0)*p2.x + H2(2,1)*p2.y + H2(2,2);
+        len = std::sqrt(x2*x2 + y2*y2 + z2*z2);
+        x2 /= len; y2 /= len; z2 /= len;
+
+        double mult = std::sqrt(f1 * f2);
+        err.at<double>(3 * match_idx, 0) = mult * (x1 - x2);
+        err.at<double>(3 * match_idx + 1, 0) = mult * (y1 - y2);
+        err.at<double>(3 * match_idx + 2, 0) = mult * (z1 - z2);
+
+        match_idx++;
+    }
+    return true;
+}
 
-            Point2f p1 = features1.keypoints[m.queryIdx].pt;
-            double x1 = H1(0,0)*p1.x + H1(0,1)*p1.y + H1(0,2);
-            double y1 = H1(1,0)*p1.x + H1(1,1)*p1.y + H1(1,2);
-            double z1 = H1(2,0)*p1.x + H1(2,1)*p1.y + H1(2,2);
-            double len = std::sqrt(x1*x1 + y1*y1 + z1*z1);
-            x1 /= len; y1 /= len; z1 /= len;
 
-            Point2f p2 = features2.keypoints[m.trainIdx].pt;
-            double x2 = H2(0,0)*p2.x + H2(0,1)*p2.y + H2(0,2);
-            double y2 = H2(1,0)*p2.x + H2(1,1)*p2.y + H2(1,2);
-            double z2 = H2(2,0)*p2.x + H2(2,1)*p2.y + H2(2,2);
-            len = std::sqrt(x2*x2 + y2*y2 + z2*z2);
-            x2 /= len; y2 /= len; z2 /= len;
+void BundleAdjusterRay::calcError(Mat &err)
+{
+    calcErrorByPairs(err);
+}
 
-            double mult = std::sqrt(f1 * f2);
-            err.at<double>(3 * match_idx, 0) = mult * (x1 - x2);
-            err.at<double>(3 * match_idx + 1, 0) = mult * (y1 - y2);
-            err.at<double>(3 * match_idx + 2, 0) = mult * (z1 - z2);
 
-            match_idx++;
-        }
-    }
+void BundleAdjusterRay::calcPairJacobian(int edge_idx, const Mat &cam_params, Mat &jac) const
+{
+    calcPairJacobianNumeric(edge_idx, cam_params, 1e-3, 0, jac);
 }
 
 
@@ -680,53 +806,56 @@ void BundleAdjusterAffine::obtainRefinedCameraParams(std::vector<CameraParams> &
 }
 
 
-void BundleAdjusterAffine::calcError(Mat &err)
+bool BundleAdjusterAffine::calcPairError(int edge_idx, const Mat &cam_params, Mat &err) const
 {
-    err.create(total_num_matches_ * 2, 1, CV_64F);
+    size_t i = edges_[edge_idx].first;
+    size_t j = edges_[edge_idx].second;
 
-    int match_idx = 0;
-    for (size_t edge_idx = 0; edge_idx < edges_.size(); ++edge_idx)
-    {
-        size_t i = edges_[edge_idx].first;
-        size_t j = edges_[edge_idx].second;
+    const ImageFeatures& features1 = features_[i];
+    const ImageFeatures& features2 = features_[j];
+    const MatchesInfo& matches_info = pairwise_matches_[i * num_images_ + j];
+    err.create(matches_info.num_inliers * 2, 1, CV_64F);
 
-        const ImageFeatures& features1 = features_[i];
-        const ImageFeatures& features2 = features_[j];
-        const MatchesInfo& matches_info = pairwise_matches_[i * num_images_ + j];
+    Mat H1 (2, 3, CV_64F, const_cast<double*>(cam_params.ptr<double>()) + i * 6);
+    Mat H2 (2, 3, CV_64F, const_cast<double*>(cam_params.ptr<double>()) + j * 6);
 
-        Mat H1 (2, 3, CV_64F, cam_params_.ptr<double>() + i * 6);
-        Mat H2 (2, 3, CV_64F, cam_params_.ptr<double>() + j * 6);
+    // invert H1
+    Mat H1_inv;
+    invertAffineTransform(H1, H1_inv);
 
-        // invert H1
-        Mat H1_inv;
-        invertAffineTransform(H1, H1_inv);
+    // convert to representation in homogeneous coordinates
+    Mat last_row = Mat::zeros(1, 3, CV_64F);
+    last_row.at<double>(2) = 1.;
+    H1_inv.push_back(last_row);
+    H2.push_back(last_row);
 
-        // convert to representation in homogeneous coordinates
-        Mat last_row = Mat::zeros(1, 3, CV_64F);
-        last_row.at<double>(2) = 1.;
-        H1_inv.push_back(last_row);
-        H2.push_back(last_row);
+    Mat_<double> H = H1_inv * H2;
 
-        Mat_<double> H = H1_inv * H2;
-
-        for (size_t k = 0; k < matches_info.matches.size(); ++k)
-        {
-            if (!matches_info.inliers_mask[k])
-                continue;
+    int match_idx = 0;
+    for (size_t k = 0; k < matches_info.matches.size(); ++k)
+    {
+        if (!matches_info.inliers_mask[k])
+            continue;
 
-            const DMatch& m = matches_info.matches[k];
-            const Point2f& p1 = features1.keypoints[m.queryIdx].pt;
-            const Point2f& p2 = features2.keypoints[m.trainIdx].pt;
+        const DMatch& m = matches_info.matches[k];
+        const Point2f& p1 = features1.keypoints[m.queryIdx].pt;
+        const Point2f& p2 = features2.keypoints[m.trainIdx].pt;
 
-            double x = H(0,0)*p1.x + H(0,1)*p1.y + H(0,2);
-            double y = H(1,0)*p1.x + H(1,1)*p1.y + H(1,2);
+        double x = H(0,0)*p1.x + H(0,1)*p1.y + H(0,2);
+        double y = H(1,0)*p1.x + H(1,1)*p1.y + H(1,2);
 
-            err.at<double>(2 * match_idx + 0, 0) = p2.x - x;
-            err.at<double>(2 * match_idx + 1, 0) = p2.y - y;
+        err.at<double>(2 * match_idx + 0, 0) = p2.x - x;
+        err.at<double>(2 * match_idx + 1, 0) = p2.y - y;
 
-            ++match_idx;
-        }
+        ++match_idx;
     }
+    return true;
+}
+
+
+void BundleAdjusterAffine::calcError(Mat &err)
+{
+    calcErrorByPairs(err);
 }
 
 
@@ -799,64 +928,67 @@ void BundleAdjusterAffinePartial::obtainRefinedCameraParams(std::vector<CameraPa
 }
 
 
-void BundleAdjusterAffinePartial::calcError(Mat &err)
+bool BundleAdjusterAffinePartial::calcPairError(int edge_idx, const Mat &cam_params, Mat &err) const
 {
-    err.create(total_num_matches_ * 2, 1, CV_64F);
+    size_t i = edges_[edge_idx].first;
+    size_t j = edges_[edge_idx].second;
 
-    int match_idx = 0;
-    for (size_t edge_idx = 0; edge_idx < edges_.size(); ++edge_idx)
+    const ImageFeatures& features1 = features_[i];
+    const ImageFeatures& features2 = features_[j];
+    const MatchesInfo& matches_info = pairwise_matches_[i * num_images_ + j];
+    err.create(matches_info.num_inliers * 2, 1, CV_64F);
+
+    const double *H1_ptr = cam_params.ptr<double>() + i * 4;
+    double H1_buf[9] =
+    {
+        H1_ptr[0], -H1_ptr[1], H1_ptr[2],
+        H1_ptr[1],  H1_ptr[0], H1_ptr[3],
+        0., 0., 1.
+    };
+    Mat H1 (3, 3, CV_64F, H1_buf);
+    const double *H2_ptr = cam_params.ptr<double>() + j * 4;
+    double H2_buf[9] =
     {
-        size_t i = edges_[edge_idx].first;
-        size_t j = edges_[edge_idx].second;
+        H2_ptr[0], -H2_ptr[1], H2_ptr[2],
+        H2_ptr[1],  H2_ptr[0], H2_ptr[3],
+        0., 0., 1.
+    };
+    Mat H2 (3, 3, CV_64F, H2_buf);
 
-        const ImageFeatures& features1 = features_[i];
-        const ImageFeatures& features2 = features_[j];
-        const MatchesInfo& matches_info = pairwise_matches_[i * num_images_ + j];
+    // invert H1
+    Mat H1_aff (H1, Range(0, 2));
+    double H1_inv_buf[6];
+    Mat H1_inv (2, 3, CV_64F, H1_inv_buf);
+    invertAffineTransform(H1_aff, H1_inv);
+    H1_inv.copyTo(H1_aff);
 
-        const double *H1_ptr = cam_params_.ptr<double>() + i * 4;
-        double H1_buf[9] =
-        {
-            H1_ptr[0], -H1_ptr[1], H1_ptr[2],
-            H1_ptr[1],  H1_ptr[0], H1_ptr[3],
-            0., 0., 1.
-        };
-        Mat H1 (3, 3, CV_64F, H1_buf);
-        const double *H2_ptr = cam_params_.ptr<double>() + j * 4;
-        double H2_buf[9] =
-        {
-            H2_ptr[0], -H2_ptr[1], H2_ptr[2],
-            H2_ptr[1],  H2_ptr[0], H2_ptr[3],
-            0., 0., 1.
-        };
-        Mat H2 (3, 3, CV_64F, H2_buf);
+    Mat_<double> H = H1 * H2;
 
-        // invert H1
-        Mat H1_aff (H1, Range(0, 2));
-        double H1_inv_buf[6];
-        Mat H1_inv (2, 3, CV_64F, H1_inv_buf);
-        invertAffineTransform(H1_aff, H1_inv);
-        H1_inv.copyTo(H1_aff);
+    int match_idx = 0;
+    for (size_t k = 0; k < matches_info.matches.size(); ++k)
+    {
+        if (!matches_info.inliers_mask[k])
+            continue;
 
-        Mat_<double> H = H1 * H2;
+        const DMatch& m = matches_info.matches[k];
+        const Point2f& p1 = features1.keypoints[m.queryIdx].pt;
+        const Point2f& p2 = features2.keypoints[m.trainIdx].pt;
 
-        for (size_t k = 0; k < matches_info.matches.size(); ++k)
-        {
-            if (!matches_info.inliers_mask[k])
-                continue;
+        double x = H(0,0)*p1.x + H(0,1)*p1.y + H(0,2);
+        double y = H(1,0)*p1.x + H(1,1)*p1.y + H(1,2);
 
-            const DMatch& m = matches_info.matches[k];
-            const Point2f& p1 = features1.keypoints[m.queryIdx].pt;
-            const Point2f& p2 = features2.keypoints[m.trainIdx].pt;
+        err.at<double>(2 * match_idx + 0, 0) = p2.x - x;
+        err.at<double>(2 * match_idx + 1, 0) = p2.y - y;
 
-            double x = H(0,0)*p1.x + H(0,1)*p1.y + H(0,2);
-            double y = H(1,0)*p1.x + H(1,1)*p1.y + H(1,2);
+        ++match_idx;
+    }
+    return true;
+}
 
-            err.at<double>(2 * match_idx + 0, 0) = p2.x - x;
-            err.at<double>(2 * match_idx + 1, 0) = p2.y - y;
 
-            ++match_idx;
-        }
-    }
+void BundleAdjusterAffinePartial::calcError(Mat &err)
+{
+    calcErrorByPairs(err);
 }
 
 
@@ -69,17 +69,75 @@ void PairwiseSeamFinder::find(const std::vector<UMat> &src, const std::vector<Po
 }
 
 
+// Splits the pairs into rounds which can be processed in parallel. A pair goes to the round after the
+// last preceding pair sharing an image with it within an intersecting region, so the pairs touching
+// the same pixels of a mask are processed in their original order.
+static void schedulePairs(const std::vector<std::pair<size_t, size_t> > &pairs, const std::vector<Rect> &regions,
+                          std::vector<std::vector<size_t> > &rounds)
+{
+    std::vector<size_t> round(pairs.size());
+    rounds.clear();
+    for (size_t p = 0; p < pairs.size(); ++p)
+    {
+        size_t r = 0;
+        for (size_t q = 0; q < p; ++q)
+        {
+            if (round[q] < r)
+                continue;
+            bool shared = pairs[q].first == pairs[p].first || pairs[q].first == pairs[p].second ||
+                          pairs[q].second == pairs[p].first || pairs[q].second == pairs[p].second;
+            if (shared && (regions[q] & regions[p]).area() > 0)
+                r = round[q] + 1;
+        }
+        round[p] = r;
+        if (r == rounds.size())
+            rounds.push_back(std::vector<size_t>());
+        rounds[r].push_back(p);
+    }
+}
+
+
 void PairwiseSeamFinder::run()
 {
+    std::vector<std::pair<size_t, size_t> > pairs;
+    std::vector<Rect> rois;
     for (size_t i = 0; i < sizes_.size() - 1; ++i)
     {
         for (size_t j = i + 1; j < sizes_.size(); ++j)
         {
             Rect roi;
             if (overlapRoi(corners_[i], corners_[j], sizes_[i], sizes_[j], roi))
-                findInPair(i, j, roi);
+            {
+                pairs.push_back(std::make_pair(i, j));
+                rois.push_back(roi);
+            }
         }
     }
+
+    const int margin = pairMargin();
+    if (margin < 0 || pairs.size() < 2)
+    {
+        for (size_t k = 0; k < pairs.size(); ++k)
+            findInPair(pairs[k].first, pairs[k].second, rois[k]);
+        return;
+    }
+
+    std::vector<Rect> regions(rois.size());
+    for (size_t k = 0; k < rois.size(); ++k)
+        regions[k] = Rect(rois[k].x - margin, rois[k].y - margin,
+                          rois[k].width + 2 * margin, rois[k].height + 2 * margin);
+
+    std::vector<std::vector<size_t> > rounds;
+    schedulePairs(pairs, regions, rounds);
+    for (size_t r = 0; r < rounds.size(); ++r)
+    {
+        const std::vector<size_t> &round = rounds[r];
+        parallel_for_(Range(0, (int)round.size()), [&](const Range &range)
+        {
+            for (int k = range.start; k < range.end; ++k)
+                findInPair(pairs[round[k]].first, pairs[round[k]].second, rois[round[k]]);
+        });
+    }
 }
 
 void VoronoiSeamFinder::find(const std::vector<UMat> &src, const std::vector<Point> &corners,
@@ -108,9 +166,18 @@ void VoronoiSeamFinder::find(const std::vector<Size> &sizes, const std::vector<P
 }
 
 
+// submasks are cut with this gap around the overlap of two images
+static const int voronoiGap = 10;
+
+int VoronoiSeamFinder::pairMargin() const
+{
+    return voronoiGap;
+}
+
+
 void VoronoiSeamFinder::findInPair(size_t first, size_t second, Rect roi)
 {
-    const int gap = 10;
+    const int gap = voronoiGap;
     Mat submask1(roi.height + 2 * gap, roi.width + 2 * gap, CV_8U);
     Mat submask2(roi.height + 2 * gap, roi.width + 2 * gap, CV_8U);
 
@@ -188,11 +255,45 @@ void DpSeamFinder::find(const std::vector<UMat> &src, const std::vector<Point> &
     }
     std::reverse(pairs.begin(), pairs.end());
 
+    // process() works on the whole masks of both images, but skips the images which don't intersect
+    std::vector<std::pair<size_t, size_t> > overlapping;
+    std::vector<Rect> regions;
     for (size_t i = 0; i < pairs.size(); ++i)
     {
         size_t i0 = pairs[i].first, i1 = pairs[i].second;
-        Mat mask0 = masks[i0].getMat(ACCESS_RW), mask1 = masks[i1].getMat(ACCESS_RW);
-        process(src[i0].getMat(ACCESS_READ), src[i1].getMat(ACCESS_READ), corners[i0], corners[i1], mask0, mask1);
+        Rect r0(corners[i0], src[i0].size()), r1(corners[i1], src[i1].size());
+        if ((r0 & r1).area() > 0)
+        {
+            overlapping.push_back(pairs[i]);
+            regions.push_back(r0 | r1);
+        }
+    }
+
+    std::vector<std::vector<size_t> > rounds;
+    schedulePairs(overlapping, regions, rounds);
+    for (size_t r = 0; r < rounds.size(); ++r)
+    {
+        const std::vector<size_t> &round = rounds[r];
+        if (round.size() == 1)
+        {
+            size_t i0 = overlapping[round[0]].first, i1 = overlapping[round[0]].second;
+            Mat mask0 = masks[i0].getMat(ACCESS_RW), mask1 = masks[i1].getMat(ACCESS_RW);
+            process(src[i0].getMat(ACCESS_READ), src[i1].getMat(ACCESS_READ), corners[i0], corners[i1], mask0, mask1);
+            continue;
+        }
+
+        // the pair data is kept in the finder, so each task uses its own one
+        parallel_for_(Range(0, (int)round.size()), [&](const Range &range)
+        {
+            DpSeamFinder worker(costFunc_);
+            for (int k = range.start; k < range.end; ++k)
+            {
+                size_t i0 = overlapping[round[k]].first, i1 = overlapping[round[k]].second;
+                Mat mask0 = masks[i0].getMat(ACCESS_RW), mask1 = masks[i1].getMat(ACCESS_RW);
+                worker.process(src[i0].getMat(ACCESS_READ), src[i1].getMat(ACCESS_READ),
+                               corners[i0], corners[i1], mask0, mask1);
+            }
+        });
     }
 
     LOGLN("Finding seams, time: " << ((getTickCount() - t) / getTickFrequency()) << " sec");
@@ -1072,19 +1173,26 @@ class GraphCutSeamFinder::Impl CV_FINAL : public PairwiseSeamFinder
 {
 public:
     Impl(int cost_type, float terminal_cost, float bad_region_penalty)
-        : cost_type_(cost_type), terminal_cost_(terminal_cost), bad_region_penalty_(bad_region_penalty) {}
+        : coarse_scale_(1), refine_band_width_(8), cost_type_(cost_type), terminal_cost_(terminal_cost),
+          bad_region_penalty_(bad_region_penalty) {}
 
     ~Impl() {}
 
     void find(const std::vector<UMat> &src, const std::vector<Point> &corners, std::vector<UMat> &masks) CV_OVERRIDE;
     void findInPair(size_t first, size_t second, Rect roi) CV_OVERRIDE;
+    int pairMargin() const CV_OVERRIDE;
+
+    int coarse_scale_;
+    int refine_band_width_;
 
 private:
-    void setGraphWeightsColor(const Mat &img1, const Mat &img2,
-                              const Mat &mask1, const Mat &mask2, GCGraph<float> &graph);
-    void setGraphWeightsColorGrad(const Mat &img1, const Mat &img2, const Mat &dx1, const Mat &dx2,
-                                  const Mat &dy1, const Mat &dy2, const Mat &mask1, const Mat &mask2,
-                                  GCGraph<float> &graph);
+    float edgeWeight(const Mat &img1, const Mat &img2, const Mat &grad1, const Mat &grad2,
+                     const Mat &mask1, const Mat &mask2, Point p, Point q) const;
+    void findLabels(const Mat &img1, const Mat &img2, const Mat &dx1, const Mat &dx2,
+                    const Mat &dy1, const Mat &dy2, const Mat &mask1, const Mat &mask2, Mat &labels);
+    void refineLabels(const Mat &img1, const Mat &img2, const Mat &dx1, const Mat &dx2,
+                      const Mat &dy1, const Mat &dy2, const Mat &mask1, const Mat &mask2,
+                      const Mat &band, Mat &labels);
 
     std::vector<Mat> dx_, dy_;
     int cost_type_;
@@ -1093,6 +1201,8 @@ private:
 };
 
 
+
+
 void GraphCutSeamFinder::Impl::find(const std::vector<UMat> &src, const std::vector<Point> &corners,
                                     std::vector<UMat> &masks)
 {
@@ -1124,10 +1234,52 @@ void GraphCutSeamFinder::Impl::find(const std::vector<UMat> &src, const std::vec
 }
 
 
-void GraphCutSeamFinder::Impl::setGraphWeightsColor(const Mat &img1, const Mat &img2,
-                                                    const Mat &mask1, const Mat &mask2, GCGraph<float> &graph)
+// subimages are cut with this gap around the overlap of two images
+static const int graphCutGap = 10;
+
+int GraphCutSeamFinder::Impl::pairMargin() const
+{
+    return graphCutGap;
+}
+
+
+float GraphCutSeamFinder::Impl::edgeWeight(const Mat &img1, const Mat &img2, const Mat &grad1, const Mat &grad2,
+                                           const Mat &mask1, const Mat &mask2, Point p, Point q) const
 {
+    const float weight_eps = 1.f;
+    float weight;
+    if (cost_type_ == GraphCutSeamFinder::COST_COLOR_GRAD)
+    {
+        float grad = grad1.at<float>(p) + grad1.at<float>(q) +
+                     grad2.at<float>(p) + grad2.at<float>(q) + weight_eps;
+        weight = (normL2(img1.at<Point3f>(p), img2.at<Point3f>(p)) +
+                  normL2(img1.at<Point3f>(q), img2.at<Point3f>(q))) / grad +
+                 weight_eps;
+    }
+    else
+    {
+        weight = normL2(img1.at<Point3f>(p), img2.at<Point3f>(p)) +
+                 normL2(img1.at<Point3f>(q), img2.at<Point3f>(q)) +
+                 weight_eps;
+    }
+    if (!mask1.at<uchar>(p) || !mask1.at<uchar>(q) ||
+        !mask2.at<uchar>(p) || !mask2.at<uchar>(q))
+        weight += bad_region_penalty_;
+    return weight;
+}
+
+
+void GraphCutSeamFinder::Impl::findLabels(const Mat &img1, const Mat &img2, const Mat &dx1, const Mat &dx2,
+                                          const Mat &dy1, const Mat &dy2, const Mat &mask1, const Mat &mask2,
+                                          Mat &labels)
+{
+    if (cost_type_ != GraphCutSeamFinder::COST_COLOR && cost_type_ != GraphCutSeamFinder::COST_COLOR_GRAD)
+        CV_Error(Error::StsBadArg, "unsupported pixel similarity measure");
+
     const Size img_size = img1.size();
+    const int vertex_count = img_size.area();
+    const int edge_count = (img_size.height - 1) * img_size.width + (img_size.width - 1) * img_size.height;
+    GCGraph<float> graph(vertex_count, edge_count);
 
     // Set terminal weights
     for (int y = 0; y < img_size.height; ++y)
@@ -1141,7 +1293,6 @@ void GraphCutSeamFinder::Impl::setGraphWeightsColor(const Mat &img1, const Mat &
     }
 
     // Set regular edge weights
-    const float weight_eps = 1.f;
     for (int y = 0; y < img_size.height; ++y)
     {
         for (int x = 0; x < img_size.width; ++x)
@@ -1149,80 +1300,89 @@ void GraphCutSeamFinder::Impl::setGraphWeightsColor(const Mat &img1, const Mat &
             int v = y * img_size.width + x;
             if (x < img_size.width - 1)
             {
-                float weight = normL2(img1.at<Point3f>(y, x), img2.at<Point3f>(y, x)) +
-                               normL2(img1.at<Point3f>(y, x + 1), img2.at<Point3f>(y, x + 1)) +
-                               weight_eps;
-                if (!mask1.at<uchar>(y, x) || !mask1.at<uchar>(y, x + 1) ||
-                    !mask2.at<uchar>(y, x) || !mask2.at<uchar>(y, x + 1))
-                    weight += bad_region_penalty_;
+                float weight = edgeWeight(img1, img2, dx1, dx2, mask1, mask2, Point(x, y), Point(x + 1, y));
                 graph.addEdges(v, v + 1, weight, weight);
             }
             if (y < img_size.height - 1)
             {
-                float weight = normL2(img1.at<Point3f>(y, x), img2.at<Point3f>(y, x)) +
-                               normL2(img1.at<Point3f>(y + 1, x), img2.at<Point3f>(y + 1, x)) +
-                               weight_eps;
-                if (!mask1.at<uchar>(y, x) || !mask1.at<uchar>(y + 1, x) ||
-                    !mask2.at<uchar>(y, x) || !mask2.at<uchar>(y + 1, x))
-                    weight += bad_region_penalty_;
+                float weight = edgeWeight(img1, img2, dy1, dy2, mask1, mask2, Point(x, y), Point(x, y + 1));
                 graph.addEdges(v, v + img_size.width, weight, weight);
             }
         }
     }
+
+    graph.maxFlow();
+
+    labels.create(img_size, CV_8U);
+    for (int y = 0; y < img_size.height; ++y)
+        for (int x = 0; x < img_size.width; ++x)
+            labels.at<uchar>(y, x) = graph.inSourceSegment(y * img_size.width + x) ? 255 : 0;
 }
 
 
-void GraphCutSeamFinder::Impl::setGraphWeightsColorGrad(
-        const Mat &img1, const Mat &img2, const Mat &dx1, const Mat &dx2,
-        const Mat &dy1, const Mat &dy2, const Mat &mask1, const Mat &mask2,
-        GCGraph<float> &graph)
+void GraphCutSeamFinder::Impl::refineLabels(const Mat &img1, const Mat &img2, const Mat &dx1, const Mat &dx2,
+                                            const Mat &dy1, const Mat &dy2, const Mat &mask1, const Mat &mask2,
+                                            const Mat &band, Mat &labels)
 {
     const Size img_size = img1.size();
 
-    // Set terminal weights
+    // only the pixels of the band get vertices, the others keep their labels
+    Mat_<int> vertices(img_size, -1);
+    int vertex_count = 0;
     for (int y = 0; y < img_size.height; ++y)
-    {
         for (int x = 0; x < img_size.width; ++x)
-        {
-            int v = graph.addVtx();
-            graph.addTermWeights(v, mask1.at<uchar>(y, x) ? terminal_cost_ : 0.f,
-                                    mask2.at<uchar>(y, x) ? terminal_cost_ : 0.f);
-        }
-    }
+            if (band.at<uchar>(y, x))
+                vertices(y, x) = vertex_count++;
+    if (vertex_count == 0)
+        return;
 
-    // Set regular edge weights
-    const float weight_eps = 1.f;
+    GCGraph<float> graph(vertex_count, 2 * vertex_count);
+    for (int v = 0; v < vertex_count; ++v)
+        graph.addVtx();
+
+    static const int nbx[] = { 1, 0, -1, 0 };
+    static const int nby[] = { 0, 1, 0, -1 };
     for (int y = 0; y < img_size.height; ++y)
     {
         for (int x = 0; x < img_size.width; ++x)
         {
-            int v = y * img_size.width + x;
-            if (x < img_size.width - 1)
-            {
-                float grad = dx1.at<float>(y, x) + dx1.at<float>(y, x + 1) +
-                             dx2.at<float>(y, x) + dx2.at<float>(y, x + 1) + weight_eps;
-                float weight = (normL2(img1.at<Point3f>(y, x), img2.at<Point3f>(y, x)) +
-                                normL2(img1.at<Point3f>(y, x + 1), img2.at<Point3f>(y, x + 1))) / grad +
-                               weight_eps;
-                if (!mask1.at<uchar>(y, x) || !mask1.at<uchar>(y, x + 1) ||
-                    !mask2.at<uchar>(y, x) || !mask2.at<uchar>(y, x + 1))
-                    weight += bad_region_penalty_;
-                graph.addEdges(v, v + 1, weight, weight);
-            }
-            if (y < img_size.height - 1)
+            int v = vertices(y, x);
+            if (v < 0)
+                continue;
+
+            float source_weight = mask1.at<uchar>(y, x) ? terminal_cost_ : 0.f;
+            float sink_weight = mask2.at<uchar>(y, x) ? terminal_cost_ : 0.f;
+            for (int k = 0; k < 4; ++k)
             {
-                float grad = dy1.at<float>(y, x) + dy1.at<float>(y + 1, x) +
-                             dy2.at<float>(y, x) + dy2.at<float>(y + 1, x) + weight_eps;
-                float weight = (normL2(img1.at<Point3f>(y, x), img2.at<Point3f>(y, x)) +
-                                normL2(img1.at<Point3f>(y + 1, x), img2.at<Point3f>(y + 1, x))) / grad +
-                               weight_eps;
-                if (!mask1.at<uchar>(y, x) || !mask1.at<uchar>(y + 1, x) ||
-                    !mask2.at<uchar>(y, x) || !mask2.at<uchar>(y + 1, x))
-                    weight += bad_region_penalty_;
-                graph.addEdges(v, v + img_size.width, weight, weight);
+                Point p(x, y), q(x + nbx[k], y + nby[k]);
+                if (q.x < 0 || q.y < 0 || q.x >= img_size.width || q.y >= img_size.height)
+                    continue;
+
+                Point a = k < 2 ? p : q, b = k < 2 ? q : p;
+                float weight = k % 2 == 0 ? edgeWeight(img1, img2, dx1, dx2, mask1, mask2, a, b)
+                                          : edgeWeight(img1, img2, dy1, dy2, mask1, mask2, a, b);
+                int u = vertices(q.y, q.x);
+                if (u >= 0)
+                {
+                    if (k < 2)
+                        graph.addEdges(v, u, weight, weight);
+                }
+                // an edge to a fixed pixel is cut when the pixel gets the other label
+                else if (labels.at<uchar>(q))
+                    source_weight += weight;
+                else
+                    sink_weight += weight;
             }
+            graph.addTermWeights(v, source_weight, sink_weight);
         }
     }
+
+    graph.maxFlow();
+
+    for (int y = 0; y < img_size.height; ++y)
+        for (int x = 0; x < img_size.width; ++x)
+            if (vertices(y, x) >= 0)
+                labels.at<uchar>(y, x) = graph.inSourceSegment(vertices(y, x)) ? 255 : 0;
 }
 
 
@@ -1234,7 +1394,7 @@ void GraphCutSeamFinder::Impl::findInPair(size_t first, size_t second, Rect roi)
     Mat mask1 = masks_[first].getMat(ACCESS_RW), mask2 = masks_[second].getMat(ACCESS_RW);
     Point tl1 = corners_[first], tl2 = corners_[second];
 
-    const int gap = 10;
+    const int gap = graphCutGap;
     Mat subimg1(roi.height + 2 * gap, roi.width + 2 * gap, CV_32FC3);
     Mat subimg2(roi.height + 2 * gap, roi.width + 2 * gap, CV_32FC3);
     Mat submask1(roi.height + 2 * gap, roi.width + 2 * gap, CV_8U);
@@ -1285,31 +1445,57 @@ void GraphCutSeamFinder::Impl::findInPair(size_t first, size_t second, Rect roi)
         }
     }
 
-    const int vertex_count = (roi.height + 2 * gap) * (roi.width + 2 * gap);
-    const int edge_count = (roi.height - 1 + 2 * gap) * (roi.width + 2 * gap) +
-                           (roi.width - 1 + 2 * gap) * (roi.height + 2 * gap);
-    GCGraph<float> graph(vertex_count, edge_count);
-
-    switch (cost_type_)
+    Mat labels;
+    const int scale = coarse_scale_;
+    if (scale > 1 && std::min(subimg1.rows, subimg1.cols) >= 16 * scale)
     {
-    case GraphCutSeamFinder::COST_COLOR:
-        setGraphWeightsColor(subimg1, subimg2, submask1, submask2, graph);
-        break;
-    case GraphCutSeamFinder::COST_COLOR_GRAD:
-        setGraphWeightsColorGrad(subimg1, subimg2, subdx1, subdx2, subdy1, subdy2,
-                                 submask1, submask2, graph);
-        break;
-    default:
-        CV_Error(Error::StsBadArg, "unsupported pixel similarity measure");
+        // solve at the low resolution first
+        Size small_size((subimg1.cols + scale - 1) / scale, (subimg1.rows + scale - 1) / scale);
+        Mat small_img1, small_img2, small_dx1, small_dx2, small_dy1, small_dy2, small_mask1, small_mask2;
+        resize(subimg1, small_img1, small_size, 0, 0, INTER_AREA);
+        resize(subimg2, small_img2, small_size, 0, 0, INTER_AREA);
+        resize(subdx1, small_dx1, small_size, 0, 0, INTER_AREA);
+        resize(subdx2, small_dx2, small_size, 0, 0, INTER_AREA);
+        resize(subdy1, small_dy1, small_size, 0, 0, INTER_AREA);
+        resize(subdy2, small_dy2, small_size, 0, 0, INTER_AREA);
+        resize(submask1 != 0, small_mask1, small_size, 0, 0, INTER_AREA);
+        resize(submask2 != 0, small_mask2, small_size, 0, 0, INTER_AREA);
+        small_mask1 = small_mask1 > 127;
+        small_mask2 = small_mask2 > 127;
+
+        Mat small_labels;
+        findLabels(small_img1, small_img2, small_dx1, small_dx2, small_dy1, small_dy2,
+                   small_mask1, small_mask2, small_labels);
+        resize(small_labels, labels, subimg1.size(), 0, 0, INTER_NEAREST);
+
+        // then cut again only around the upscaled seam
+        Mat seam = Mat::zeros(labels.size(), CV_8U);
+        for (int y = 0; y < labels.rows; ++y)
+        {
+            for (int x = 0; x < labels.cols; ++x)
+            {
+                uchar l = labels.at<uchar>(y, x);
+                if (x < labels.cols - 1 && labels.at<uchar>(y, x + 1) != l)
+                    seam.at<uchar>(y, x) = seam.at<uchar>(y, x + 1) = 255;
+                if (y < labels.rows - 1 && labels.at<uchar>(y + 1, x) != l)
+                    seam.at<uchar>(y, x) = seam.at<uchar>(y + 1, x) = 255;
+            }
+        }
+        Mat band;
+        int width = std::max(refine_band_width_, 1);
+        dilate(seam, band, getStructuringElement(MORPH_RECT, Size(2 * width + 1, 2 * width + 1)));
+        refineLabels(subimg1, subimg2, subdx1, subdx2, subdy1, subdy2, submask1, submask2, band, labels);
+    }
+    else
+    {
+        findLabels(subimg1, subimg2, subdx1, subdx2, subdy1, subdy2, submask1, submask2, labels);
     }
-
-    graph.maxFlow();
 
     for (int y = 0; y < roi.height; ++y)
     {
         for (int x = 0; x < roi.width; ++x)
         {
-            if (graph.inSourceSegment((y + gap) * (roi.width + 2 * gap) + x + gap))
+            if (labels.at<uchar>(y + gap, x + gap))
             {
                 if (mask1.at<uchar>(roi.y - tl1.y + y, roi.x - tl1.x + x))
                     mask2.at<uchar>(roi.y - tl2.y + y, roi.x - tl2.x + x) = 0;
@@ -1337,6 +1523,23 @@ void GraphCutSeamFinder::find(const std::vector<UMat> &src, const std::vector<Po
 }
 
 
+int GraphCutSeamFinder::coarseScale() const { return impl_->coarse_scale_; }
+
+void GraphCutSeamFinder::setCoarseScale(int scale)
+{
+    CV_Assert(scale >= 1);
+    impl_->coarse_scale_ = scale;
+}
+
+int GraphCutSeamFinder::refineBandWidth() const { return impl_->refine_band_width_; }
+
+void GraphCutSeamFinder::setRefineBandWidth(int width)
+{
+    CV_Assert(width >= 1);
+    impl_->refine_band_width_ = width;
+}
+
+
 #ifdef HAVE_OPENCV_CUDALEGACY
 void GraphCutSeamFinderGpu::find(const std::vector<UMat> &src, const std::vector<Point> &corners,
                                  std::vector<UMat> &masks)
@@ -459,5 +459,186 @@ Point CylindricalWarper::warp(InputArray src, InputArray K, InputArray R, int in
     return dst_roi.tl();
 }
 
+
+CachedRotationWarper::CachedRotationWarper(const Ptr<RotationWarper> &warper, int capacity)
+    : warper_(warper), capacity_(capacity)
+{
+    CV_Assert(warper_);
+    CV_Assert(capacity_ > 0);
+}
+
+Point2f CachedRotationWarper::warpPoint(const Point2f &pt, InputArray K, InputArray R)
+{
+    return warper_->warpPoint(pt, K, R);
+}
+
+Rect CachedRotationWarper::buildMaps(Size src_size, InputArray K, InputArray R, OutputArray xmap, OutputArray ymap)
+{
+    return warper_->buildMaps(src_size, K, R, xmap, ymap);
+}
+
+void CachedRotationWarper::warpBackward(InputArray src, InputArray K, InputArray R, int interp_mode, int border_mode,
+                                        Size dst_size, OutputArray dst)
+{
+    warper_->warpBackward(src, K, R, interp_mode, border_mode, dst_size, dst);
+}
+
+Rect CachedRotationWarper::warpRoi(Size src_size, InputArray K, InputArray R)
+{
+    return warper_->warpRoi(src_size, K, R);
+}
+
+float CachedRotationWarper::getScale() const
+{
+    return warper_->getScale();
+}
+
+void CachedRotationWarper::setScale(float val)
+{
+    if (val != warper_->getScale())
+        clear();
+    warper_->setScale(val);
+}
+
+void CachedRotationWarper::clear()
+{
+    maps_.clear();
+}
+
+void CachedRotationWarper::setCapacity(int capacity)
+{
+    CV_Assert(capacity > 0);
+    capacity_ = capacity;
+    while ((int)maps_.size() > capacity_)
+        maps_.pop_back();
+}
+
+CachedRotationWarper::Maps &CachedRotationWarper::maps(Size src_size, InputArray _K, InputArray _R, int interp_mode)
+{
+    Mat K, R;
+    _K.getMat().convertTo(K, CV_32F);
+    _R.getMat().convertTo(R, CV_32F);
+    CV_Assert(K.size() == Size(3, 3) && R.size() == Size(3, 3));
+
+    // the nearest neighbor maps are rounded, the others keep the fractional part of the coordinates
+    bool nearest = interp_mode == INTER_NEAREST;
+    for (std::list<Maps>::iterator it = maps_.begin(); it != maps_.end(); ++it)
+    {
+        if (it->src_size == src_size && (it->interp_mode == INTER_NEAREST) == nearest &&
+            memcmp(it->K.ptr(), K.ptr(), 9 * sizeof(float)) == 0 &&
+            memcmp(it->R.ptr(), R.ptr(), 9 * sizeof(float)) == 0)
+        {
+            maps_.splice(maps_.begin(), maps_, it);
+            return maps_.front();
+        }
+    }
+
+    if ((int)maps_.size() >= capacity_)
+        maps_.pop_back();
+
+    Maps m;
+    m.src_size = src_size;
+    m.K = K;
+    m.R = R;
+    m.interp_mode = interp_mode;
+    Mat xmap, ymap;
+    m.dst_roi = warper_->buildMaps(src_size, K, R, xmap, ymap);
+    convertMaps(xmap, ymap, m.map1, m.map2, CV_16SC2, nearest);
+    maps_.push_front(m);
+    return maps_.front();
+}
+
+Point CachedRotationWarper::warp(InputArray src, InputArray K, InputArray R, int interp_mode, int border_mode,
+                                 OutputArray dst)
+{
+    CV_INSTRUMENT_REGION()
+
+    Maps &m = maps(src.size(), K, R, interp_mode);
+    dst.create(m.map1.size(), src.type());
+    remap(src, dst, m.map1, m.map2, interp_mode, border_mode);
+    return m.dst_roi.tl();
+}
+
+Point CachedRotationWarper::warpCompensated(InputArray _src, InputArray K, InputArray R, int interp_mode,
+                                            int border_mode, InputArray _gain, OutputArray _dst, OutputArray _mask,
+                                            int dtype)
+{
+    CV_INSTRUMENT_REGION()
+
+    Mat src = _src.getMat();
+    Maps &m = maps(src.size(), K, R, interp_mode);
+    const int cn = src.channels();
+
+    // a gain map, a gain per channel or a gain of the whole image
+    Mat gain = _gain.getMat();
+    const bool gain_map = gain.type() == CV_32F && gain.size() == m.map1.size() && gain.total() > 1;
+    Scalar channel_gains = Scalar::all(1.);
+    bool channel_gain = false;
+    if (!gain_map && !gain.empty())
+    {
+        Mat gain64;
+        gain.convertTo(gain64, CV_64F);
+        gain64 = gain64.reshape(1, (int)gain64.total() * gain64.channels());
+        const int ngains = gain64.rows;
+        if (ngains != 1 && !(cn > 1 && (ngains == cn || ngains == 4) && cn <= 4))
+            CV_Error(Error::StsBadArg, "The gain must be a single value, a value per channel of the image "
+                                       "or a CV_32F map of the projected image size");
+        for (int c = 0; c < cn && c < 4; ++c)
+            channel_gains[c] = gain64.at<double>(ngains == 1 ? 0 : c);
+        for (int c = 1; c < cn; ++c)
+            channel_gain |= channel_gains[c] != channel_gains[0];
+    }
+    const double scale = channel_gains[0];
+
+    _dst.create(m.map1.size(), CV_MAKETYPE(CV_MAT_DEPTH(dtype), cn));
+    Mat dst = _dst.getMat();
+
+    // each stripe is converted while its warped rows are still in the cache
+    const int stripe = 16;
+    parallel_for_(Range(0, (dst.rows + stripe - 1) / stripe), [&](const Range &range)
+    {
+        Mat warped, warped32f;
+        for (int i = range.start; i < range.end; ++i)
+        {
+            Range rows(i * stripe, std::min((i + 1) * stripe, dst.rows));
+            remap(src, warped, m.map1.rowRange(rows), m.map2.empty() ? Mat() : m.map2.rowRange(rows),
+                  interp_mode, border_mode);
+            if (!gain_map && !channel_gain)
+            {
+                warped.convertTo(dst.rowRange(rows), dst.type(), scale);
+                continue;
+            }
+
+            warped.convertTo(warped32f, CV_32F);
+            if (channel_gain)
+            {
+                multiply(warped32f, channel_gains, warped32f);
+                warped32f.convertTo(dst.rowRange(rows), dst.type());
+                continue;
+            }
+            for (int y = 0; y < warped32f.rows; ++y)
+            {
+                float *row = warped32f.ptr<float>(y);
+                const float *gain_row = gain.ptr<float>(rows.start + y);
+                for (int x = 0; x < warped32f.cols; ++x)
+                    for (int c = 0; c < cn; ++c)
+                        row[x * cn + c] *= gain_row[x];
+            }
+            warped32f.convertTo(dst.rowRange(rows), dst.type());
+        }
+    });
+
+    if (_mask.needed())
+    {
+        if (m.mask.empty())
+        {
+            Mat full_mask(src.size(), CV_8U, Scalar::all(255));
+            warper_->warp(full_mask, K, R, INTER_NEAREST, BORDER_CONSTANT, m.mask);
+        }
+        m.mask.copyTo(_mask);
+    }
+    return m.dst_roi.tl();
+}
+
 } // namespace detail
 } // namespace cv
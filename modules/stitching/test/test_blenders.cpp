@@ -76,4 +76,115 @@ TEST(MultiBandBlender, CanBlendTwoImages)
     EXPECT_GE(psnr, 50);
 }
 
+// smooth random images overlapping each other, the masks split the overlaps by vertical seams
+static void makeOverlappingImages(int type, std::vector<Mat> &images, std::vector<Mat> &masks,
+                                  std::vector<Point> &corners)
+{
+    RNG rng(0);
+    const Point tls[] = { Point(-20, 5), Point(230, 0), Point(470, 31), Point(100, 180) };
+    const Size size(320, 240);
+    images.clear(); masks.clear(); corners.clear();
+    for (int i = 0; i < 4; ++i)
+    {
+        Mat noise(size, CV_8UC3), img;
+        rng.fill(noise, RNG::UNIFORM, 0, 255);
+        GaussianBlur(noise, img, Size(0, 0), 4);
+        img.convertTo(img, type, 2, -128);
+        images.push_back(img);
+
+        Mat mask(size, CV_8U, Scalar::all(255));
+        if (i > 0 && i < 3)
+            mask.colRange(0, 40).setTo(0);
+        if (i == 3)
+            mask.rowRange(0, 60).setTo(0);
+        masks.push_back(mask);
+        corners.push_back(tls[i]);
+    }
+}
+
+typedef testing::TestWithParam<tuple<int, int> > TiledMultiBandBlenderTest;
+
+TEST_P(TiledMultiBandBlenderTest, matches_MultiBandBlender)
+{
+    int weight_type = get<0>(GetParam()), img_type = get<1>(GetParam());
+    std::vector<Mat> images, masks;
+    std::vector<Point> corners;
+    makeOverlappingImages(img_type, images, masks, corners);
+    std::vector<Size> sizes;
+    for (size_t i = 0; i < images.size(); ++i)
+        sizes.push_back(images[i].size());
+
+    detail::MultiBandBlender blender(false, 5, weight_type);
+    detail::TiledMultiBandBlender tiled(5, Size(100, 70), weight_type);
+    blender.prepare(detail::resultRoi(corners, sizes));
+    tiled.prepare(detail::resultRoi(corners, sizes));
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        blender.feed(images[i], masks[i], corners[i]);
+        tiled.feed(images[i], masks[i], corners[i]);
+    }
+
+    Mat expected, expected_mask, result, result_mask;
+    blender.blend(expected, expected_mask);
+    tiled.blend(result, result_mask);
+
+    ASSERT_EQ(expected.size(), result.size());
+    ASSERT_EQ(expected.type(), result.type());
+    EXPECT_EQ(0, cvtest::norm(expected_mask, result_mask, NORM_INF));
+    EXPECT_LE(cvtest::norm(expected, result, NORM_INF), 1);
+}
+
+INSTANTIATE_TEST_CASE_P(Stitching, TiledMultiBandBlenderTest,
+                        testing::Combine(testing::Values(CV_32F, CV_16S), testing::Values(CV_8UC3, CV_16SC3)));
+
+class CollectingStripeWriter : public detail::BlendedStripeWriter
+{
+public:
+    void write(int y, const Mat &stripe, const Mat &stripe_mask) CV_OVERRIDE
+    {
+        ys.push_back(y);
+        stripes.push_back(stripe.clone());
+        stripe_masks.push_back(stripe_mask.clone());
+    }
+
+    std::vector<int> ys;
+    std::vector<Mat> stripes, stripe_masks;
+};
+
+TEST(TiledMultiBandBlender, streams_stripes_in_order)
+{
+    std::vector<Mat> images, masks;
+    std::vector<Point> corners;
+    makeOverlappingImages(CV_8UC3, images, masks, corners);
+    std::vector<Size> sizes;
+    for (size_t i = 0; i < images.size(); ++i)
+        sizes.push_back(images[i].size());
+
+    detail::TiledMultiBandBlender tiled(4, Size(128, 96));
+    Mat pano, pano_mask;
+    tiled.prepare(detail::resultRoi(corners, sizes));
+    for (size_t i = 0; i < images.size(); ++i)
+        tiled.feed(images[i], masks[i], corners[i]);
+    tiled.blend(pano, pano_mask);
+
+    CollectingStripeWriter writer;
+    tiled.prepare(detail::resultRoi(corners, sizes));
+    for (size_t i = 0; i < images.size(); ++i)
+        tiled.feed(images[i], masks[i], corners[i]);
+    tiled.blend(writer);
+
+    ASSERT_FALSE(writer.ys.empty());
+    int y = 0;
+    for (size_t i = 0; i < writer.ys.size(); ++i)
+    {
+        ASSERT_EQ(y, writer.ys[i]);
+        ASSERT_EQ(pano.cols, writer.stripes[i].cols);
+        Range rows(y, y + writer.stripes[i].rows);
+        EXPECT_EQ(0, cvtest::norm(pano.rowRange(rows), writer.stripes[i], NORM_INF));
+        EXPECT_EQ(0, cvtest::norm(pano_mask.rowRange(rows), writer.stripe_masks[i], NORM_INF));
+        y = rows.end;
+    }
+    EXPECT_EQ(pano.rows, y);
+}
+
 }} // namespace
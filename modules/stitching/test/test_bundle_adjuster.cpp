@@ -0,0 +1,124 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+#include "opencv2/calib3d.hpp"
+
+namespace opencv_test { namespace {
+
+// Rotating camera panorama: the images are taken with the yaw step of 20 degrees,
+// the features are exact projections of random rays
+static void makeSyntheticPanorama(int num_images, std::vector<detail::ImageFeatures> &features,
+                                  std::vector<detail::MatchesInfo> &pairwise_matches,
+                                  std::vector<detail::CameraParams> &cameras)
+{
+    const Size img_size(640, 480);
+    const double focal = 600;
+    RNG rng(12345);
+
+    cameras.resize(num_images);
+    for (int i = 0; i < num_images; ++i)
+    {
+        cameras[i].focal = focal;
+        cameras[i].ppx = img_size.width * 0.5;
+        cameras[i].ppy = img_size.height * 0.5;
+        cameras[i].aspect = 1;
+        Mat R;
+        cv::Rodrigues(Vec3d(rng.uniform(-0.02, 0.02), i * CV_PI / 9, rng.uniform(-0.02, 0.02)), R);
+        R.convertTo(cameras[i].R, CV_32F);
+    }
+
+    // visible[i][k] is the index of the keypoint of the ray k in the image i or -1
+    const int num_rays = 60 * num_images;
+    std::vector<std::vector<int> > visible(num_images, std::vector<int>(num_rays, -1));
+    features.resize(num_images);
+    for (int i = 0; i < num_images; ++i)
+    {
+        features[i].img_idx = i;
+        features[i].img_size = img_size;
+        features[i].keypoints.clear();
+    }
+    for (int k = 0; k < num_rays; ++k)
+    {
+        double yaw = rng.uniform(-0.5, (num_images - 1) * CV_PI / 9 + 0.5), pitch = rng.uniform(-0.3, 0.3);
+        Matx31d X(std::sin(yaw) * std::cos(pitch), std::sin(pitch), std::cos(yaw) * std::cos(pitch));
+        for (int i = 0; i < num_images; ++i)
+        {
+            Matx33d K(cameras[i].K()), R(cameras[i].R);
+            Matx31d p = K * R.t() * X;
+            if (p(2) <= 0)
+                continue;
+            Point2f pt((float)(p(0) / p(2)), (float)(p(1) / p(2)));
+            if (!Rect(0, 0, img_size.width, img_size.height).contains(pt))
+                continue;
+            visible[i][k] = (int)features[i].keypoints.size();
+            features[i].keypoints.push_back(KeyPoint(pt, 1.f));
+        }
+    }
+
+    pairwise_matches.assign(num_images * num_images, detail::MatchesInfo());
+    for (int i = 0; i < num_images; ++i)
+        for (int j = 0; j < num_images; ++j)
+        {
+            detail::MatchesInfo &info = pairwise_matches[i * num_images + j];
+            info.src_img_idx = i;
+            info.dst_img_idx = j;
+            if (i == j)
+                continue;
+            for (int k = 0; k < num_rays; ++k)
+                if (visible[i][k] >= 0 && visible[j][k] >= 0)
+                    info.matches.push_back(DMatch(visible[i][k], visible[j][k], 0.f));
+            info.inliers_mask.assign(info.matches.size(), (uchar)1);
+            info.num_inliers = (int)info.matches.size();
+            info.confidence = info.num_inliers >= 20 ? info.num_inliers / (8 + 0.3 * info.num_inliers) : 0;
+            if (info.confidence > 0)
+            {
+                Matx33d Ki(cameras[i].K()), Kj(cameras[j].K()), Ri(cameras[i].R), Rj(cameras[j].R);
+                info.H = Mat(Kj * Rj.t() * Ri * Ki.inv());
+            }
+        }
+}
+
+typedef testing::TestWithParam<string> BundleAdjusterSynthetic;
+
+TEST_P(BundleAdjusterSynthetic, recovers_cameras)
+{
+    std::vector<detail::ImageFeatures> features;
+    std::vector<detail::MatchesInfo> pairwise_matches;
+    std::vector<detail::CameraParams> gt;
+    makeSyntheticPanorama(8, features, pairwise_matches, gt);
+
+    Ptr<detail::BundleAdjusterBase> adjuster;
+    if (GetParam() == "ray")
+        adjuster = makePtr<detail::BundleAdjusterRay>();
+    else
+        adjuster = makePtr<detail::BundleAdjusterReproj>();
+
+    RNG rng(0);
+    std::vector<detail::CameraParams> cameras = gt;
+    for (size_t i = 0; i < cameras.size(); ++i)
+    {
+        cameras[i].focal *= 1.05;
+        Mat dR;
+        cv::Rodrigues(Vec3d(rng.uniform(-0.01, 0.01), rng.uniform(-0.01, 0.01), rng.uniform(-0.01, 0.01)), dR);
+        dR.convertTo(dR, CV_32F);
+        cameras[i].R = dR * cameras[i].R;
+    }
+
+    ASSERT_TRUE((*adjuster)(features, pairwise_matches, cameras));
+
+    for (size_t i = 0; i < cameras.size(); ++i)
+    {
+        EXPECT_NEAR(cameras[i].focal, gt[i].focal, 1.);
+        if (i == 0)
+            continue;
+        // the result is defined up to a common rotation
+        Mat rel = cameras[i - 1].R.t() * cameras[i].R, rel_gt = gt[i - 1].R.t() * gt[i].R;
+        EXPECT_LE(cvtest::norm(rel, rel_gt, NORM_INF), 1e-3);
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(Stitching, BundleAdjusterSynthetic, testing::Values("ray", "reproj"));
+
+}} // namespace
@@ -0,0 +1,199 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+// a grid of overlapping views of one textured scene, each with its own exposure
+static void makeSeamGrid(int cols, int rows, Size size, std::vector<UMat> &images,
+                         std::vector<Point> &corners, std::vector<UMat> &masks)
+{
+    RNG rng(0);
+    Size scene_size(size.width * (cols + 1), size.height * (rows + 1));
+    Mat noise(scene_size / 8, CV_8UC3), scene;
+    rng.fill(noise, RNG::UNIFORM, 0, 255);
+    resize(noise, scene, scene_size, 0, 0, INTER_CUBIC);
+
+    images.clear();
+    corners.clear();
+    masks.clear();
+    for (int r = 0; r < rows; ++r)
+    {
+        for (int c = 0; c < cols; ++c)
+        {
+            Point tl(c * size.width * 2 / 3 + rng.uniform(0, 10), r * size.height * 2 / 3 + rng.uniform(0, 10));
+            Mat image;
+            scene(Rect(tl, size)).convertTo(image, CV_32FC3, rng.uniform(0.8, 1.2));
+            images.push_back(image.getUMat(ACCESS_READ).clone());
+            corners.push_back(tl);
+            masks.push_back(UMat(size, CV_8U, Scalar(255)));
+        }
+    }
+}
+
+static std::vector<UMat> cloneMasks(const std::vector<UMat> &masks)
+{
+    std::vector<UMat> result(masks.size());
+    for (size_t i = 0; i < masks.size(); ++i)
+        result[i] = masks[i].clone();
+    return result;
+}
+
+static Ptr<detail::SeamFinder> createSeamFinder(const std::string &name)
+{
+    if (name == "voronoi")
+        return makePtr<detail::VoronoiSeamFinder>();
+    if (name == "dp")
+        return makePtr<detail::DpSeamFinder>(detail::DpSeamFinder::COLOR_GRAD);
+    return makePtr<detail::GraphCutSeamFinder>(detail::GraphCutSeamFinderBase::COST_COLOR_GRAD);
+}
+
+// the Voronoi seam finder that processes all the pairs in their original order, without the rounds
+class SequentialVoronoiSeamFinder : public detail::VoronoiSeamFinder
+{
+    int pairMargin() const CV_OVERRIDE { return -1; }
+};
+
+static bool fartherPair(const std::vector<UMat> &images, const std::vector<Point> &corners,
+                        const std::pair<size_t, size_t> &l, const std::pair<size_t, size_t> &r)
+{
+    Point c1 = corners[l.first] + Point(images[l.first].cols / 2, images[l.first].rows / 2);
+    Point c2 = corners[l.second] + Point(images[l.second].cols / 2, images[l.second].rows / 2);
+    int d1 = (c1 - c2).dot(c1 - c2);
+    c1 = corners[r.first] + Point(images[r.first].cols / 2, images[r.first].rows / 2);
+    c2 = corners[r.second] + Point(images[r.second].cols / 2, images[r.second].rows / 2);
+    return d1 < (c1 - c2).dot(c1 - c2);
+}
+
+// the reference seams: the pairs are passed to the finder one by one, in the order of the sequential
+// implementation, so no scheduling is involved
+static void findSeamsSequentially(const std::string &name, const std::vector<UMat> &images,
+                                  const std::vector<Point> &corners, std::vector<UMat> &masks)
+{
+    if (name == "voronoi")
+    {
+        SequentialVoronoiSeamFinder().find(images, corners, masks);
+        return;
+    }
+
+    std::vector<std::pair<size_t, size_t> > pairs;
+    for (size_t i = 0; i + 1 < images.size(); ++i)
+        for (size_t j = i + 1; j < images.size(); ++j)
+            pairs.push_back(std::make_pair(i, j));
+    if (name == "dp")
+    {
+        // the closest pairs go last
+        std::sort(pairs.begin(), pairs.end(), [&](const std::pair<size_t, size_t> &l, const std::pair<size_t, size_t> &r)
+        {
+            return fartherPair(images, corners, l, r);
+        });
+        std::reverse(pairs.begin(), pairs.end());
+    }
+
+    for (size_t k = 0; k < pairs.size(); ++k)
+    {
+        size_t i = pairs[k].first, j = pairs[k].second;
+        if ((Rect(corners[i], images[i].size()) & Rect(corners[j], images[j].size())).area() == 0)
+            continue;
+        std::vector<UMat> pair_images(1, images[i]), pair_masks(1, masks[i]);
+        std::vector<Point> pair_corners(1, corners[i]);
+        pair_images.push_back(images[j]);
+        pair_masks.push_back(masks[j]);
+        pair_corners.push_back(corners[j]);
+        createSeamFinder(name)->find(pair_images, pair_corners, pair_masks);
+    }
+}
+
+typedef testing::TestWithParam<std::string> SeamFinderTest;
+
+TEST_P(SeamFinderTest, parallel_matches_sequential)
+{
+    std::vector<UMat> images, masks;
+    std::vector<Point> corners;
+    makeSeamGrid(4, 3, Size(120, 90), images, corners, masks);
+
+    std::vector<UMat> parallel_masks = cloneMasks(masks);
+    createSeamFinder(GetParam())->find(images, corners, parallel_masks);
+
+    std::vector<UMat> sequential_masks = cloneMasks(masks);
+    findSeamsSequentially(GetParam(), images, corners, sequential_masks);
+
+    for (size_t i = 0; i < images.size(); ++i)
+        EXPECT_EQ(0, cvtest::norm(parallel_masks[i], sequential_masks[i], NORM_INF)) << "image " << i;
+}
+
+INSTANTIATE_TEST_CASE_P(Stitching, SeamFinderTest, testing::Values("voronoi", "dp", "graphcut"));
+
+// sum of the color differences of the images on both sides of the seams
+static double seamCost(const std::vector<UMat> &images, const std::vector<Point> &corners,
+                       const std::vector<UMat> &masks, Mat &owners)
+{
+    Rect dst_roi = detail::resultRoi(corners, images);
+    owners.create(dst_roi.size(), CV_32S);
+    owners.setTo(-1);
+    std::vector<Mat> imgs(images.size());
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        imgs[i] = images[i].getMat(ACCESS_READ);
+        owners(Rect(corners[i] - dst_roi.tl(), imgs[i].size())).setTo((int)i, masks[i]);
+    }
+
+    double cost = 0;
+    for (int y = 0; y < owners.rows; ++y)
+        for (int x = 0; x < owners.cols; ++x)
+            for (int k = 0; k < 2; ++k)
+            {
+                Point p(x, y), q(x + 1 - k, y + k);
+                if (q.x >= owners.cols || q.y >= owners.rows)
+                    continue;
+                int a = owners.at<int>(p), b = owners.at<int>(q);
+                if (a < 0 || b < 0 || a == b)
+                    continue;
+                for (int t = 0; t < 2; ++t)
+                {
+                    Point pa = (t ? q : p) + dst_roi.tl() - corners[a], pb = (t ? q : p) + dst_roi.tl() - corners[b];
+                    if (Rect(Point(), imgs[a].size()).contains(pa) && Rect(Point(), imgs[b].size()).contains(pb))
+                        cost += cv::norm(imgs[a].at<Vec3f>(pa) - imgs[b].at<Vec3f>(pb));
+                }
+            }
+    return cost;
+}
+
+TEST(GraphCutSeamFinderTest, coarse_to_fine)
+{
+    std::vector<UMat> images, masks;
+    std::vector<Point> corners;
+    makeSeamGrid(3, 2, Size(240, 180), images, corners, masks);
+
+    std::vector<UMat> full_masks = cloneMasks(masks), coarse_masks = cloneMasks(masks);
+    detail::GraphCutSeamFinder full_finder(detail::GraphCutSeamFinderBase::COST_COLOR);
+    full_finder.find(images, corners, full_masks);
+
+    detail::GraphCutSeamFinder coarse_finder(detail::GraphCutSeamFinderBase::COST_COLOR);
+    coarse_finder.setCoarseScale(4);
+    EXPECT_EQ(4, coarse_finder.coarseScale());
+    coarse_finder.find(images, corners, coarse_masks);
+
+    // every pixel of the panorama is still covered by exactly one image
+    for (size_t i = 0; i < images.size(); ++i)
+        for (size_t j = i + 1; j < images.size(); ++j)
+        {
+            Rect roi;
+            if (!detail::overlapRoi(corners[i], corners[j], images[i].size(), images[j].size(), roi))
+                continue;
+            Mat mask_i = coarse_masks[i].getMat(ACCESS_READ)(Rect(roi.tl() - corners[i], roi.size()));
+            Mat mask_j = coarse_masks[j].getMat(ACCESS_READ)(Rect(roi.tl() - corners[j], roi.size()));
+            EXPECT_EQ(0, countNonZero(mask_i & mask_j)) << i << " " << j;
+        }
+    Mat full_owners, coarse_owners;
+    double full_cost = seamCost(images, corners, full_masks, full_owners);
+    double coarse_cost = seamCost(images, corners, coarse_masks, coarse_owners);
+    EXPECT_EQ(countNonZero(full_owners >= 0), countNonZero(coarse_owners >= 0));
+
+    // the refined seams are nearly as good as the ones found at the full resolution
+    EXPECT_LE(coarse_cost, full_cost * 1.15);
+}
+
+}} // namespace
@@ -0,0 +1,152 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+#include "opencv2/calib3d.hpp"
+
+namespace opencv_test { namespace {
+
+static Ptr<detail::RotationWarper> createRotationWarper(const std::string &name, float scale)
+{
+    if (name == "spherical")
+        return makePtr<detail::SphericalWarper>(scale);
+    if (name == "cylindrical")
+        return makePtr<detail::CylindricalWarper>(scale);
+    return makePtr<detail::PlaneWarper>(scale);
+}
+
+static Mat cameraMatrix(Size size)
+{
+    return (Mat_<float>(3, 3) << size.width, 0, size.width / 2.f,
+                                 0, size.width, size.height / 2.f,
+                                 0, 0, 1);
+}
+
+typedef testing::TestWithParam<std::string> CachedRotationWarperTest;
+
+TEST_P(CachedRotationWarperTest, matches_warper)
+{
+    const Size size(320, 240);
+    Mat src(size, CV_8UC3);
+    randu(src, 0, 255);
+    Mat K = cameraMatrix(size);
+    Mat R1, R2;
+    Rodrigues(Vec3f(0.05f, 0.2f, 0.f), R1);
+    Rodrigues(Vec3f(-0.1f, -0.3f, 0.02f), R2);
+    R1.convertTo(R1, CV_32F);
+    R2.convertTo(R2, CV_32F);
+
+    Ptr<detail::RotationWarper> warper = createRotationWarper(GetParam(), 320.f);
+    detail::CachedRotationWarper cached(createRotationWarper(GetParam(), 320.f));
+
+    // the second round of frames is warped with the cached maps
+    for (int frame = 0; frame < 2; ++frame)
+    {
+        const Mat *rotations[] = { &R1, &R2 };
+        for (int i = 0; i < 2; ++i)
+        {
+            const Mat &R = *rotations[i];
+            const int interp_modes[] = { INTER_LINEAR, INTER_NEAREST, INTER_CUBIC };
+            for (int k = 0; k < 3; ++k)
+            {
+                Mat expected, actual;
+                Point expected_tl = warper->warp(src, K, R, interp_modes[k], BORDER_REFLECT, expected);
+                Point actual_tl = cached.warp(src, K, R, interp_modes[k], BORDER_REFLECT, actual);
+                EXPECT_EQ(expected_tl, actual_tl);
+                ASSERT_EQ(expected.size(), actual.size());
+                EXPECT_EQ(0, cvtest::norm(expected, actual, NORM_INF)) << "rotation " << i << ", interpolation " << k;
+            }
+        }
+    }
+}
+
+TEST_P(CachedRotationWarperTest, warpCompensated)
+{
+    const Size size(320, 240);
+    Mat src(size, CV_8UC3);
+    randu(src, 0, 255);
+    Mat K = cameraMatrix(size);
+    Mat R;
+    Rodrigues(Vec3f(0.1f, -0.2f, 0.f), R);
+    R.convertTo(R, CV_32F);
+
+    Ptr<detail::RotationWarper> warper = createRotationWarper(GetParam(), 320.f);
+    detail::CachedRotationWarper cached(createRotationWarper(GetParam(), 320.f));
+
+    Mat warped, warped_mask;
+    Point tl = warper->warp(src, K, R, INTER_LINEAR, BORDER_REFLECT, warped);
+    warper->warp(Mat(size, CV_8U, Scalar::all(255)), K, R, INTER_NEAREST, BORDER_CONSTANT, warped_mask);
+
+    // a gain of the whole image
+    Mat dst, mask;
+    EXPECT_EQ(tl, cached.warpCompensated(src, K, R, INTER_LINEAR, BORDER_REFLECT, 1.25, dst, mask));
+    Mat expected;
+    warped.convertTo(expected, CV_16S, 1.25);
+    EXPECT_EQ(0, cvtest::norm(expected, dst, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(warped_mask, mask, NORM_INF));
+
+    // a gain map of the projected image
+    Mat gain(warped.size(), CV_32F);
+    randu(gain, 0.5, 1.5);
+    cached.warpCompensated(src, K, R, INTER_LINEAR, BORDER_REFLECT, gain, dst, noArray(), CV_32F);
+    std::vector<Mat> channels;
+    split(warped, channels);
+    for (size_t c = 0; c < channels.size(); ++c)
+    {
+        channels[c].convertTo(channels[c], CV_32F);
+        channels[c] = channels[c].mul(gain);
+    }
+    merge(channels, expected);
+    EXPECT_LE(cvtest::norm(expected, dst, NORM_INF), 1e-3);
+
+    // a gain per channel
+    cached.warpCompensated(src, K, R, INTER_LINEAR, BORDER_REFLECT, Scalar(0.5, 1.0, 1.5), dst, noArray(), CV_32F);
+    warped.convertTo(expected, CV_32F);
+    cv::multiply(expected, Scalar(0.5, 1.0, 1.5), expected);
+    EXPECT_LE(cvtest::norm(expected, dst, NORM_INF), 1e-3);
+
+    // neither a gain per channel nor a map of the projected image size
+    EXPECT_THROW(cached.warpCompensated(src, K, R, INTER_LINEAR, BORDER_REFLECT, Vec2d(1, 2), dst, noArray()),
+                 cv::Exception);
+    EXPECT_THROW(cached.warpCompensated(src, K, R, INTER_LINEAR, BORDER_REFLECT, Mat(size, CV_32F, Scalar(1)),
+                                        dst, noArray()), cv::Exception);
+}
+
+TEST_P(CachedRotationWarperTest, capacity)
+{
+    const Size size(160, 120);
+    Mat src(size, CV_8UC3);
+    randu(src, 0, 255);
+    Mat K = cameraMatrix(size);
+    std::vector<Mat> rotations(5);
+    for (size_t i = 0; i < rotations.size(); ++i)
+    {
+        Rodrigues(Vec3f(0.f, 0.1f * i, 0.f), rotations[i]);
+        rotations[i].convertTo(rotations[i], CV_32F);
+    }
+
+    Ptr<detail::RotationWarper> warper = createRotationWarper(GetParam(), 160.f);
+    detail::CachedRotationWarper cached(createRotationWarper(GetParam(), 160.f), 2);
+    EXPECT_EQ(2, cached.capacity());
+
+    // the maps of more cameras than the capacity are rebuilt, the result is the same
+    for (int frame = 0; frame < 2; ++frame)
+    {
+        for (size_t i = 0; i < rotations.size(); ++i)
+        {
+            Mat expected, actual;
+            Point expected_tl = warper->warp(src, K, rotations[i], INTER_LINEAR, BORDER_REFLECT, expected);
+            EXPECT_EQ(expected_tl, cached.warp(src, K, rotations[i], INTER_LINEAR, BORDER_REFLECT, actual));
+            EXPECT_EQ(0, cvtest::norm(expected, actual, NORM_INF)) << "rotation " << i;
+        }
+    }
+
+    cached.setCapacity(1);
+    EXPECT_EQ(1, cached.capacity());
+    EXPECT_THROW(cached.setCapacity(0), cv::Exception);
+}
+
+INSTANTIATE_TEST_CASE_P(Stitching, CachedRotationWarperTest, testing::Values("spherical", "cylindrical", "plane"));
+
+}} // namespace
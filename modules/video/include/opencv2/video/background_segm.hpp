@@ -196,6 +196,19 @@ public:
     */
     CV_WRAP virtual void setShadowThreshold(double threshold) = 0;
 
+    /** @brief Returns true if the model of 8-bit frames is kept in the compact 16-bit form
+    */
+    CV_WRAP virtual bool getCompactModel() const = 0;
+    /** @brief Enables or disables the compact model
+
+    In the compact form the weights, the variances and the means of the mixture components are
+    stored as 16-bit fixed-point numbers instead of 32-bit floats, which halves the memory used per
+    pixel. The means are kept with the precision of 1/256 and the variances are limited by 255. The
+    compact form is only used for 8-bit frames and is processed on the CPU. Changing the parameter
+    resets the model.
+    */
+    CV_WRAP virtual void setCompactModel(bool compactModel) = 0;
+
     /** @brief Computes a foreground mask.
 
     @param image Next video frame. Floating point frame will be used without scaling and should be in range \f$[0,255]\f$.
@@ -310,6 +323,25 @@ CV_EXPORTS_W Ptr<BackgroundSubtractorKNN>
     createBackgroundSubtractorKNN(int history=500, double dist2Threshold=400.0,
                                    bool detectShadows=true);
 
+/** @brief Updates several background subtractors with their frames as one parallel job.
+
+The function is equivalent to calling subtractors[i % n].apply(frames[i], fgmasks[i], learningRate)
+for all the frames in order, where n is the number of the subtractors, so the frames are given
+time-major: the first frame of every stream, then the second frame of every stream and so on. The
+rows of all the streams of one time step are processed by a single parallel loop, which keeps all
+the cores busy even when the frames are small and removes the per-call scheduling cost of
+processing many streams one by one. The subtractors created by createBackgroundSubtractorMOG2 and
+createBackgroundSubtractorKNN are processed this way, any other subtractor is updated with apply().
+
+@param subtractors The background subtractors, one per stream.
+@param frames The frames, the number of the frames should be a multiple of the number of the subtractors.
+@param fgmasks The output foreground masks, one per frame.
+@param learningRate The learning rate passed to every update, see BackgroundSubtractor::apply.
+ */
+CV_EXPORTS void applyBackgroundSubtractors(const std::vector<Ptr<BackgroundSubtractor> >& subtractors,
+                                           InputArrayOfArrays frames, OutputArrayOfArrays fgmasks,
+                                           double learningRate = -1);
+
 //! @} video_motion
 
 } // cv
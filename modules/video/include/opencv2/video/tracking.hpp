@@ -55,6 +55,7 @@ namespace cv
 
 enum { OPTFLOW_USE_INITIAL_FLOW     = 4,
        OPTFLOW_LK_GET_MIN_EIGENVALS = 8,
+       OPTFLOW_LK_EARLY_EXIT        = 16,
        OPTFLOW_FARNEBACK_GAUSSIAN   = 256
      };
 
@@ -155,6 +156,9 @@ moves by less than criteria.epsilon.
      minEigThreshold description); if the flag is not set, then L1 distance between patches
      around the original and a moved point, divided by number of pixels in a window, is used as a
      error measure.
+ -   **OPTFLOW_LK_EARLY_EXIT** stops the iterations on the pyramid levels above 0 once the point
+     moves by less than a quarter of a pixel of the level (or less than criteria.epsilon if it is
+     larger); the position found there is refined on the finer levels anyway.
 @param minEigThreshold the algorithm calculates the minimum eigen value of a 2x2 normal matrix of
 optical flow equations (this matrix is called a spatial gradient matrix in @cite Bouguet00), divided
 by number of pixels in a window; if this value is less than minEigThreshold, then a corresponding
@@ -577,6 +581,16 @@ public:
     CV_WRAP virtual int getFlags() const = 0;
     CV_WRAP virtual void setFlags(int flags) = 0;
 
+    /** @brief Enables reusing the buffers between the frames of a video sequence.
+
+    When enabled, the polynomial expansion of the second frame is kept after calc() and reused
+    when the next call gets the same image as its first frame, so a sequence of calls
+    calc(f0, f1), calc(f1, f2), ... expands every frame only once. The result is the same as with
+    the mode disabled. The mode is disabled by default.
+     */
+    CV_WRAP virtual bool getReuseBuffers() const = 0;
+    CV_WRAP virtual void setReuseBuffers(bool reuseBuffers) = 0;
+
     CV_WRAP static Ptr<FarnebackOpticalFlow> create(
             int numLevels = 5,
             double pyrScale = 0.5,
@@ -615,6 +629,16 @@ public:
     CV_WRAP virtual double getMinEigThreshold() const = 0;
     CV_WRAP virtual void setMinEigThreshold(double minEigThreshold) = 0;
 
+    /** @brief Enables reusing the image pyramids between the frames of a video sequence.
+
+    When enabled, the pyramid of the second image is built together with its derivatives and kept
+    after calc(). If the next call gets the same image as its first image, the kept pyramid is used
+    instead of building a new one. The result is the same as with the mode disabled. The mode has
+    no effect when the pyramids are passed to calc() and is disabled by default.
+     */
+    CV_WRAP virtual bool getReuseBuffers() const = 0;
+    CV_WRAP virtual void setReuseBuffers(bool reuseBuffers) = 0;
+
     CV_WRAP static Ptr<SparsePyrLKOpticalFlow> create(
             Size winSize = Size(21, 21),
             int maxLevel = 3, TermCriteria crit =
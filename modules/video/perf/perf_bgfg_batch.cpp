@@ -0,0 +1,64 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+using namespace perf;
+
+// many low-resolution cameras looking at static noisy scenes
+static void makeStreams(int nstreams, int nsteps, const Size& sz, std::vector<Mat>& frames)
+{
+    RNG rng(0);
+    std::vector<Mat> backgrounds(nstreams);
+    for (int s = 0; s < nstreams; s++)
+    {
+        backgrounds[s].create(sz, CV_8UC3);
+        rng.fill(backgrounds[s], RNG::UNIFORM, 0, 255);
+        GaussianBlur(backgrounds[s], backgrounds[s], Size(5, 5), 1.5);
+    }
+    frames.clear();
+    for (int t = 0; t < nsteps; t++)
+        for (int s = 0; s < nstreams; s++)
+        {
+            Mat noise(sz, CV_16SC3), frame;
+            rng.fill(noise, RNG::NORMAL, 0, 3);
+            cv::add(backgrounds[s], noise, frame, noArray(), CV_8U);
+            frames.push_back(frame);
+        }
+}
+
+typedef tuple<std::string, bool> Algo_Batch_t;
+typedef TestBaseWithParam<Algo_Batch_t> Algo_Batch;
+
+PERF_TEST_P(Algo_Batch, BackgroundSubtractor_streams,
+            testing::Combine(testing::Values("MOG2", "KNN"), testing::Bool()))
+{
+    const int nstreams = 48, nsteps = 4;
+    std::string algo = get<0>(GetParam());
+    bool batch = get<1>(GetParam());
+
+    std::vector<Mat> frames, masks(nstreams * nsteps);
+    makeStreams(nstreams, nsteps, Size(320, 240), frames);
+
+    std::vector<Ptr<BackgroundSubtractor> > subtractors(nstreams);
+
+    TEST_CYCLE()
+    {
+        for (int s = 0; s < nstreams; s++)
+            subtractors[s] = algo == "MOG2" ? Ptr<BackgroundSubtractor>(createBackgroundSubtractorMOG2())
+                                            : Ptr<BackgroundSubtractor>(createBackgroundSubtractorKNN());
+        if (batch)
+            applyBackgroundSubtractors(subtractors, frames, masks);
+        else
+        {
+            for (size_t i = 0; i < frames.size(); i++)
+                subtractors[i % nstreams]->apply(frames[i], masks[i]);
+        }
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
@@ -0,0 +1,72 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "perf_precomp.hpp"
+
+namespace opencv_test { namespace {
+using namespace perf;
+
+// smooth random texture moving along a straight line with the sub-pixel step (dx, dy) per frame
+static void makeMovingTexture(const Size& sz, int nframes, double dx, double dy, std::vector<Mat>& frames)
+{
+    RNG rng(0);
+    Mat noise(sz.height + 64, sz.width + 64, CV_32F), texture;
+    rng.fill(noise, RNG::UNIFORM, 0, 255);
+    GaussianBlur(noise, texture, Size(0, 0), 2.);
+    normalize(texture, texture, 0, 255, NORM_MINMAX);
+
+    frames.resize(nframes);
+    for (int i = 0; i < nframes; i++)
+    {
+        Matx23d A(1, 0, 32 - i*dx, 0, 1, 32 - i*dy);
+        warpAffine(texture, frames[i], A, sz, INTER_LINEAR | WARP_INVERSE_MAP);
+        frames[i].convertTo(frames[i], CV_8U);
+    }
+}
+
+typedef tuple<Size, int> Size_Flags_t;
+typedef TestBaseWithParam<Size_Flags_t> Size_Flags;
+
+PERF_TEST_P(Size_Flags, OpticalFlowFarneback,
+            testing::Combine(testing::Values(sz720p, sz1080p),
+                             testing::Values(0, (int)OPTFLOW_FARNEBACK_GAUSSIAN)))
+{
+    Size sz = get<0>(GetParam());
+    int flags = get<1>(GetParam());
+
+    std::vector<Mat> frames;
+    makeMovingTexture(sz, 2, 2.5, -1.25, frames);
+    Mat flow(sz, CV_32FC2);
+
+    declare.in(frames[0], frames[1]).out(flow).time(60);
+
+    TEST_CYCLE() calcOpticalFlowFarneback(frames[0], frames[1], flow, 0.5, 3, 15, 3, 5, 1.2, flags);
+
+    SANITY_CHECK_NOTHING();
+}
+
+typedef TestBaseWithParam<bool> ReuseBuffers;
+
+PERF_TEST_P(ReuseBuffers, OpticalFlowFarneback_video, testing::Bool())
+{
+    const int nframes = 5;
+    std::vector<Mat> frames;
+    makeMovingTexture(sz720p, nframes, 2.5, -1.25, frames);
+    Mat flow;
+
+    Ptr<FarnebackOpticalFlow> fb = FarnebackOpticalFlow::create(3, 0.5, false, 15, 3, 5, 1.2, 0);
+    fb->setReuseBuffers(GetParam());
+
+    declare.time(60);
+
+    TEST_CYCLE()
+    {
+        for (int i = 0; i < nframes - 1; i++)
+            fb->calc(frames[i], frames[i + 1], flow);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
+}} // namespace
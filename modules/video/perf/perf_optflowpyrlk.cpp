@@ -269,4 +269,46 @@ PERF_TEST_P(Path_Win_Deriv_Border_Reuse, OpticalFlowPyrLK_pyr, testing::Combine(
     SANITY_CHECK(pyramid);
 }
 
+typedef tuple<bool, int> ReuseBuffers_Flags_t;
+typedef TestBaseWithParam<ReuseBuffers_Flags_t> ReuseBuffers_Flags;
+
+PERF_TEST_P(ReuseBuffers_Flags, OpticalFlowPyrLK_video,
+            testing::Combine(testing::Bool(), testing::Values(0, (int)OPTFLOW_LK_EARLY_EXIT)))
+{
+    const int nframes = 5;
+    RNG rng(0);
+    Mat noise(sz720p.height + 80, sz720p.width + 80, CV_32F), texture;
+    rng.fill(noise, RNG::UNIFORM, 0, 255);
+    GaussianBlur(noise, texture, Size(0, 0), 2.5);
+    normalize(texture, texture, 0, 255, NORM_MINMAX);
+
+    std::vector<Mat> frames(nframes);
+    for (int i = 0; i < nframes; i++)
+    {
+        Matx23d A = getRotationMatrix2D(Point2f(640, 360), 0.3*i, 1.0);
+        A(0, 2) += 4.3*i + 40; A(1, 2) += -3.1*i + 40;
+        warpAffine(texture, frames[i], A, sz720p, INTER_LINEAR | WARP_INVERSE_MAP);
+        frames[i].convertTo(frames[i], CV_8U);
+    }
+
+    vector<Point2f> points;
+    FormTrackingPointsArray(points, sz720p.width, sz720p.height, 50, 40);
+
+    Ptr<SparsePyrLKOpticalFlow> lk = SparsePyrLKOpticalFlow::create(Size(21, 21), 3);
+    lk->setReuseBuffers(get<0>(GetParam()));
+    lk->setFlags(get<1>(GetParam()));
+
+    vector<Point2f> nextPoints;
+    vector<uchar> status;
+    vector<float> err;
+
+    TEST_CYCLE()
+    {
+        for (int i = 0; i < nframes - 1; i++)
+            lk->calc(frames[i], frames[i + 1], points, nextPoints, status, err);
+    }
+
+    SANITY_CHECK_NOTHING();
+}
+
 }} // namespace
@@ -43,6 +43,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_video.hpp"
+#include "bgfg_batch.hpp"
 
 namespace cv
 {
@@ -64,7 +65,7 @@ static const float defaultDist2Threshold = 20.0f*20.0f;//threshold on distance f
 static const unsigned char defaultnShadowDetection2 = (unsigned char)127; // value to use in the segmentation mask for shadows, set 0 not to do shadow detection
 static const float defaultfTau = 0.5f; // Tau - shadow threshold, see the paper for explanation
 
-class BackgroundSubtractorKNNImpl CV_FINAL : public BackgroundSubtractorKNN
+class BackgroundSubtractorKNNImpl CV_FINAL : public BackgroundSubtractorKNN, public detail::BackgroundSubtractorRowUpdate
 {
 public:
     //! the default constructor
@@ -93,6 +94,7 @@ public:
     nLongCounter = 0;
     nMidCounter = 0;
     nShortCounter = 0;
+    nLongRefresh = nMidRefresh = nShortRefresh = 1;
 #ifdef HAVE_OPENCL
     opencl_ON = true;
 #endif
@@ -123,6 +125,7 @@ public:
     nLongCounter = 0;
     nMidCounter = 0;
     nShortCounter = 0;
+    nLongRefresh = nMidRefresh = nShortRefresh = 1;
 #ifdef HAVE_OPENCL
     opencl_ON = true;
 #endif
@@ -132,6 +135,9 @@ public:
     //! the update operator
     void apply(InputArray image, OutputArray fgmask, double learningRate) CV_OVERRIDE;
 
+    Ptr<ParallelLoopBody> prepareUpdate(InputArray image, OutputArray fgmask, double learningRate) CV_OVERRIDE;
+    void finishUpdate() CV_OVERRIDE;
+
     //! computes a background image which are the mean of all background gaussians
     virtual void getBackgroundImage(OutputArray backgroundImage) const CV_OVERRIDE;
 
@@ -307,6 +313,9 @@ protected:
     int nLongCounter;//circular counter
     int nMidCounter;
     int nShortCounter;
+    int nLongRefresh;//refresh rates of the update in progress
+    int nMidRefresh;
+    int nShortRefresh;
     Mat bgmodel; // model data pixel values
     Mat aModelIndexShort;// index into the models
     Mat aModelIndexMid;
@@ -508,7 +517,7 @@ CV_INLINE int
 class KNNInvoker : public ParallelLoopBody
 {
 public:
-    KNNInvoker(const Mat& _src, Mat& _dst,
+    KNNInvoker(const Mat& _src, const Mat& _dst,
                uchar* _bgmodel,
                uchar* _nNextLongUpdate,
                uchar* _nNextMidUpdate,
@@ -526,8 +535,8 @@ public:
                bool _bShadowDetection,
                uchar _nShadowDetection)
     {
-        src = &_src;
-        dst = &_dst;
+        src = _src;
+        dst = _dst;
         m_aModel0 = _bgmodel;
         m_nNextLongUpdate0 = _nNextLongUpdate;
         m_nNextMidUpdate0 = _nNextMidUpdate;
@@ -549,12 +558,12 @@ public:
     void operator()(const Range& range) const CV_OVERRIDE
     {
         int y0 = range.start, y1 = range.end;
-        int ncols = src->cols, nchannels = src->channels();
+        int ncols = src.cols, nchannels = src.channels();
         int ndata=nchannels+1;
 
         for ( int y = y0; y < y1; y++ )
         {
-            const uchar* data = src->ptr(y);
+            const uchar* data = src.ptr(y);
             uchar* m_aModel = m_aModel0 + ncols*m_nN*3*ndata*y;
             uchar* m_nNextLongUpdate = m_nNextLongUpdate0 + ncols*y;
             uchar* m_nNextMidUpdate = m_nNextMidUpdate0 + ncols*y;
@@ -562,7 +571,7 @@ public:
             uchar* m_aModelIndexLong = m_aModelIndexLong0 + ncols*y;
             uchar* m_aModelIndexMid = m_aModelIndexMid0 + ncols*y;
             uchar* m_aModelIndexShort = m_aModelIndexShort0 + ncols*y;
-            uchar* mask = dst->ptr(y);
+            uchar* mask = dst.ptr(y);
 
             for ( int x = 0; x < ncols; x++ )
             {
@@ -606,8 +615,8 @@ public:
         }
     }
 
-    const Mat* src;
-    Mat* dst;
+    Mat src;
+    mutable Mat dst;
     uchar* m_aModel0;
     uchar* m_nNextLongUpdate0;
     uchar* m_nNextMidUpdate0;
@@ -730,15 +739,25 @@ void BackgroundSubtractorKNNImpl::apply(InputArray _image, OutputArray _fgmask,
 {
     CV_INSTRUMENT_REGION()
 
+    Ptr<ParallelLoopBody> update = prepareUpdate(_image, _fgmask, learningRate);
+    if (update)
+    {
+        parallel_for_(Range(0, _image.rows()), *update, _image.total()/(double)(1 << 16));
+        finishUpdate();
+    }
+}
+
+Ptr<ParallelLoopBody> BackgroundSubtractorKNNImpl::prepareUpdate(InputArray _image, OutputArray _fgmask, double learningRate)
+{
 #ifdef HAVE_OPENCL
     if (opencl_ON)
     {
 #ifndef __APPLE__
-        CV_OCL_RUN(_fgmask.isUMat() && OCL_PERFORMANCE_CHECK(!ocl::Device::getDefault().isIntel() || _image.channels() == 1),
-                   ocl_apply(_image, _fgmask, learningRate))
+        CV_OCL_RUN_(_fgmask.isUMat() && OCL_PERFORMANCE_CHECK(!ocl::Device::getDefault().isIntel() || _image.channels() == 1),
+                    ocl_apply(_image, _fgmask, learningRate), Ptr<ParallelLoopBody>())
 #else
-        CV_OCL_RUN(_fgmask.isUMat() && OCL_PERFORMANCE_CHECK(!ocl::Device::getDefault().isIntel()),
-                   ocl_apply(_image, _fgmask, learningRate))
+        CV_OCL_RUN_(_fgmask.isUMat() && OCL_PERFORMANCE_CHECK(!ocl::Device::getDefault().isIntel()),
+                    ocl_apply(_image, _fgmask, learningRate), Ptr<ParallelLoopBody>())
 #endif
 
         opencl_ON = false;
@@ -768,47 +787,48 @@ void BackgroundSubtractorKNNImpl::apply(InputArray _image, OutputArray _fgmask,
     Klong=(int)(log(0.1)/log(1-learningRate))-Kshort-Kmid+1;//Klong
 
     //refresh rates
-    int nShortUpdate = (Kshort/nN)+1;
-    int nMidUpdate = (Kmid/nN)+1;
-    int nLongUpdate = (Klong/nN)+1;
-
-    parallel_for_(Range(0, image.rows),
-                  KNNInvoker(image, fgmask,
-                             bgmodel.ptr(),
-                             nNextLongUpdate.ptr(),
-                             nNextMidUpdate.ptr(),
-                             nNextShortUpdate.ptr(),
-                             aModelIndexLong.ptr(),
-                             aModelIndexMid.ptr(),
-                             aModelIndexShort.ptr(),
-                             nLongCounter,
-                             nMidCounter,
-                             nShortCounter,
-                             nN,
-                             fTb,
-                             nkNN,
-                             fTau,
-                             bShadowDetection,
-                             nShadowDetection),
-                             image.total()/(double)(1 << 16));
+    nShortRefresh = (Kshort/nN)+1;
+    nMidRefresh = (Kmid/nN)+1;
+    nLongRefresh = (Klong/nN)+1;
+
+    return Ptr<ParallelLoopBody>(new KNNInvoker(image, fgmask,
+                                                bgmodel.ptr(),
+                                                nNextLongUpdate.ptr(),
+                                                nNextMidUpdate.ptr(),
+                                                nNextShortUpdate.ptr(),
+                                                aModelIndexLong.ptr(),
+                                                aModelIndexMid.ptr(),
+                                                aModelIndexShort.ptr(),
+                                                nLongCounter,
+                                                nMidCounter,
+                                                nShortCounter,
+                                                nN,
+                                                fTb,
+                                                nkNN,
+                                                fTau,
+                                                bShadowDetection,
+                                                nShadowDetection));
+}
 
+void BackgroundSubtractorKNNImpl::finishUpdate()
+{
     nShortCounter++;//0,1,...,nShortUpdate-1
     nMidCounter++;
     nLongCounter++;
-    if (nShortCounter >= nShortUpdate)
+    if (nShortCounter >= nShortRefresh)
     {
         nShortCounter = 0;
-        randu(nNextShortUpdate, Scalar::all(0),  Scalar::all(nShortUpdate));
+        randu(nNextShortUpdate, Scalar::all(0),  Scalar::all(nShortRefresh));
     }
-    if (nMidCounter >= nMidUpdate)
+    if (nMidCounter >= nMidRefresh)
     {
         nMidCounter = 0;
-        randu(nNextMidUpdate, Scalar::all(0),  Scalar::all(nMidUpdate));
+        randu(nNextMidUpdate, Scalar::all(0),  Scalar::all(nMidRefresh));
     }
-    if (nLongCounter >= nLongUpdate)
+    if (nLongCounter >= nLongRefresh)
     {
         nLongCounter = 0;
-        randu(nNextLongUpdate, Scalar::all(0),  Scalar::all(nLongUpdate));
+        randu(nNextLongUpdate, Scalar::all(0),  Scalar::all(nLongRefresh));
     }
 }
 
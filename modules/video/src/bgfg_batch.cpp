@@ -0,0 +1,92 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+#include "bgfg_batch.hpp"
+
+namespace cv
+{
+
+// the number of pixels updated by one task of the batch
+static const int batchStripeSize = 1 << 14;
+
+class BatchUpdateInvoker : public ParallelLoopBody
+{
+public:
+    BatchUpdateInvoker(const std::vector<Ptr<ParallelLoopBody> >& _updates,
+                       const std::vector<std::pair<int, Range> >& _stripes)
+        : updates(_updates), stripes(_stripes)
+    {
+    }
+
+    void operator()(const Range& range) const CV_OVERRIDE
+    {
+        for (int i = range.start; i < range.end; i++)
+            (*updates[stripes[i].first])(stripes[i].second);
+    }
+
+private:
+    const std::vector<Ptr<ParallelLoopBody> >& updates;
+    const std::vector<std::pair<int, Range> >& stripes;
+};
+
+void applyBackgroundSubtractors(const std::vector<Ptr<BackgroundSubtractor> >& subtractors,
+                                InputArrayOfArrays frames, OutputArrayOfArrays fgmasks,
+                                double learningRate)
+{
+    CV_INSTRUMENT_REGION()
+
+    int nstreams = (int)subtractors.size();
+    int nframes = (int)frames.total();
+    CV_Assert(nstreams > 0 && nframes % nstreams == 0);
+
+    std::vector<detail::BackgroundSubtractorRowUpdate*> rowUpdates(nstreams);
+    for (int s = 0; s < nstreams; s++)
+    {
+        CV_Assert(subtractors[s]);
+        for (int j = 0; j < s; j++)
+            CV_Assert(subtractors[j] != subtractors[s]);
+        rowUpdates[s] = dynamic_cast<detail::BackgroundSubtractorRowUpdate*>(subtractors[s].get());
+    }
+
+    fgmasks.create(nframes, 1, CV_8U);
+
+    std::vector<Ptr<ParallelLoopBody> > updates(nstreams);
+    std::vector<std::pair<int, Range> > stripes;
+
+    for (int t = 0; t < nframes; t += nstreams)
+    {
+        stripes.clear();
+        for (int s = 0; s < nstreams; s++)
+        {
+            Mat frame = frames.getMat(t + s);
+            fgmasks.create(frame.size(), CV_8U, t + s);
+            Mat fgmask = fgmasks.getMat(t + s);
+
+            updates[s].release();
+            if (!rowUpdates[s])
+            {
+                subtractors[s]->apply(frame, fgmask, learningRate);
+                continue;
+            }
+
+            updates[s] = rowUpdates[s]->prepareUpdate(frame, fgmask, learningRate);
+            if (!updates[s])
+                continue;
+
+            int n = std::max((int)((frame.total() + batchStripeSize - 1) / batchStripeSize), 1);
+            int step = (frame.rows + n - 1) / n;
+            for (int y = 0; y < frame.rows; y += step)
+                stripes.push_back(std::make_pair(s, Range(y, std::min(y + step, frame.rows))));
+        }
+
+        parallel_for_(Range(0, (int)stripes.size()), BatchUpdateInvoker(updates, stripes));
+
+        for (int s = 0; s < nstreams; s++)
+            if (updates[s])
+                rowUpdates[s]->finishUpdate();
+    }
+}
+
+}
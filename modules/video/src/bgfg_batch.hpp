@@ -0,0 +1,31 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef OPENCV_VIDEO_BGFG_BATCH_HPP
+#define OPENCV_VIDEO_BGFG_BATCH_HPP
+
+namespace cv
+{
+namespace detail
+{
+
+//! Background subtractor which splits apply() into the serial steps and the update of the rows,
+//! so the updates of several subtractors can be scheduled by one parallel loop.
+class BackgroundSubtractorRowUpdate
+{
+public:
+    virtual ~BackgroundSubtractorRowUpdate() {}
+
+    //! does everything apply() does before the update of the model and returns the update of
+    //! the rows [0, image.rows). Returns an empty pointer if the frame has been processed already.
+    virtual Ptr<ParallelLoopBody> prepareUpdate(InputArray image, OutputArray fgmask, double learningRate) = 0;
+
+    //! does everything apply() does after the update of the rows returned by prepareUpdate()
+    virtual void finishUpdate() = 0;
+};
+
+}
+}
+
+#endif
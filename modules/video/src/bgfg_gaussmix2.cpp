@@ -84,6 +84,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_video.hpp"
+#include "bgfg_batch.hpp"
 
 namespace cv
 {
@@ -117,8 +118,12 @@ static const float defaultfCT2 = 0.05f; // complexity reduction prior constant 0
 static const unsigned char defaultnShadowDetection2 = (unsigned char)127; // value to use in the segmentation mask for shadows, set 0 not to do shadow detection
 static const float defaultfTau = 0.5f; // Tau - shadow threshold, see the paper for explanation
 
+// fixed-point scales of the compact model of 8-bit frames
+static const float compactWeightScale = 65535.f; // weights are in [0,1]
+static const float compactValueScale = 256.f; // variances and means are 8.8 numbers
 
-class BackgroundSubtractorMOG2Impl CV_FINAL : public BackgroundSubtractorMOG2
+
+class BackgroundSubtractorMOG2Impl CV_FINAL : public BackgroundSubtractorMOG2, public detail::BackgroundSubtractorRowUpdate
 {
 public:
     //! the default constructor
@@ -142,6 +147,7 @@ public:
         fCT = defaultfCT2;
         nShadowDetection =  defaultnShadowDetection2;
         fTau = defaultfTau;
+        compactModel = false;
 #ifdef HAVE_OPENCL
         opencl_ON = true;
 #endif
@@ -169,6 +175,7 @@ public:
         nShadowDetection =  defaultnShadowDetection2;
         fTau = defaultfTau;
         name_ = "BackgroundSubtractor.MOG2";
+        compactModel = false;
 #ifdef HAVE_OPENCL
         opencl_ON = true;
 #endif
@@ -178,6 +185,9 @@ public:
     //! the update operator
     void apply(InputArray image, OutputArray fgmask, double learningRate) CV_OVERRIDE;
 
+    Ptr<ParallelLoopBody> prepareUpdate(InputArray image, OutputArray fgmask, double learningRate) CV_OVERRIDE;
+    void finishUpdate() CV_OVERRIDE {}
+
     //! computes a background image which are the mean of all background gaussians
     virtual void getBackgroundImage(OutputArray backgroundImage) const CV_OVERRIDE;
 
@@ -193,7 +203,7 @@ public:
         CV_Assert( nmixtures <= 255);
 
 #ifdef HAVE_OPENCL
-        if (ocl::isOpenCLActivated() && opencl_ON)
+        if (ocl::isOpenCLActivated() && opencl_ON && !isCompact(frameType))
         {
             create_ocl_apply_kernel();
 
@@ -229,7 +239,8 @@ public:
             // the mixture weight (w),
             // the mean (nchannels values) and
             // the covariance
-            bgmodel.create( 1, frameSize.height*frameSize.width*nmixtures*(2 + nchannels), CV_32F );
+            bgmodel.create( 1, frameSize.height*frameSize.width*nmixtures*(2 + nchannels),
+                            isCompact(frameType) ? CV_16U : CV_32F );
             //make the array for keeping track of the used modes per pixel - all zeros at start
             bgmodelUsedModes.create(frameSize,CV_8U);
             bgmodelUsedModes = Scalar::all(0);
@@ -284,6 +295,15 @@ public:
     virtual double getShadowThreshold() const CV_OVERRIDE { return fTau; }
     virtual void setShadowThreshold(double value) CV_OVERRIDE { fTau = (float)value; }
 
+    virtual bool getCompactModel() const CV_OVERRIDE { return compactModel; }
+    virtual void setCompactModel(bool _compactModel) CV_OVERRIDE
+    {
+        if (compactModel == _compactModel)
+            return;
+        compactModel = _compactModel;
+        nframes = 0;
+    }
+
     virtual void write(FileStorage& fs) const CV_OVERRIDE
     {
         writeFormat(fs);
@@ -299,7 +319,8 @@ public:
         << "complexityReductionThreshold" << fCT
         << "detectShadows" << (int)bShadowDetection
         << "shadowValue" << (int)nShadowDetection
-        << "shadowThreshold" << fTau;
+        << "shadowThreshold" << fTau
+        << "compactModel" << (int)compactModel;
     }
 
     virtual void read(const FileNode& fn) CV_OVERRIDE
@@ -317,6 +338,7 @@ public:
         bShadowDetection = (int)fn["detectShadows"] != 0;
         nShadowDetection = saturate_cast<uchar>((int)fn["shadowValue"]);
         fTau = (float)fn["shadowThreshold"];
+        setCompactModel((int)fn["compactModel"] != 0);
     }
 
 protected:
@@ -388,8 +410,12 @@ protected:
     //Tau= 0.5 means that if pixel is more than 2 times darker then it is not shadow
     //See: Prati,Mikic,Trivedi,Cucchiara,"Detecting Moving Shadows...",IEEE PAMI,2003.
 
+    bool compactModel; // keep the model of 8-bit frames in 16-bit fixed-point numbers
+
     String name_;
 
+    bool isCompact(int type) const { return compactModel && CV_MAT_DEPTH(type) == CV_8U; }
+
     template <typename T, int CN>
     void getBackgroundImage_intern(OutputArray backgroundImage) const;
 
@@ -537,20 +563,19 @@ detectShadowGMM(const float* data, int nchannels, int nmodes,
 class MOG2Invoker : public ParallelLoopBody
 {
 public:
-    MOG2Invoker(const Mat& _src, Mat& _dst,
-                GMM* _gmm, float* _mean,
-                uchar* _modesUsed,
+    MOG2Invoker(const Mat& _src, const Mat& _dst,
+                const Mat& _bgmodel, const Mat& _modesUsed,
                 int _nmixtures, float _alphaT,
                 float _Tb, float _TB, float _Tg,
                 float _varInit, float _varMin, float _varMax,
                 float _prune, float _tau, bool _detectShadows,
                 uchar _shadowVal)
     {
-        src = &_src;
-        dst = &_dst;
-        gmm0 = _gmm;
-        mean0 = _mean;
-        modesUsed0 = _modesUsed;
+        src = _src;
+        dst = _dst;
+        model0 = _bgmodel.data;
+        compact = _bgmodel.depth() == CV_16U;
+        modesUsed0 = _modesUsed.data;
         nmixtures = _nmixtures;
         alphaT = _alphaT;
         Tb = _Tb;
@@ -568,26 +593,55 @@ public:
     void operator()(const Range& range) const CV_OVERRIDE
     {
         int y0 = range.start, y1 = range.end;
-        int ncols = src->cols, nchannels = src->channels();
-        AutoBuffer<float> buf(src->cols*nchannels);
+        int ncols = src.cols, nchannels = src.channels();
+        AutoBuffer<float> buf(src.cols*nchannels);
         float alpha1 = 1.f - alphaT;
         float dData[CV_CN_MAX];
 
+        // the compact model is stored as (weight, variance) pairs followed by the means, as the float one;
+        // the modes of a pixel are unpacked to the local buffer, updated and packed back
+        size_t modelSize = (size_t)src.rows*ncols*nmixtures;
+        AutoBuffer<float> pixelModel(compact ? nmixtures*(2 + nchannels) : 1);
+        float wscale = 1.f/compactWeightScale, vscale = 1.f/compactValueScale;
+
         for( int y = y0; y < y1; y++ )
         {
             const float* data = buf.data();
-            if( src->depth() != CV_32F )
-                src->row(y).convertTo(Mat(1, ncols, CV_32FC(nchannels), (void*)data), CV_32F);
+            if( src.depth() != CV_32F )
+                src.row(y).convertTo(Mat(1, ncols, CV_32FC(nchannels), (void*)data), CV_32F);
             else
-                data = src->ptr<float>(y);
+                data = src.ptr<float>(y);
 
-            float* mean = mean0 + ncols*nmixtures*nchannels*y;
-            GMM* gmm = gmm0 + ncols*nmixtures*y;
+            size_t rowOfs = (size_t)ncols*nmixtures*y;
             uchar* modesUsed = modesUsed0 + ncols*y;
-            uchar* mask = dst->ptr(y);
+            uchar* mask = dst.ptr(y);
 
-            for( int x = 0; x < ncols; x++, data += nchannels, gmm += nmixtures, mean += nmixtures*nchannels )
+            for( int x = 0; x < ncols; x++, data += nchannels )
             {
+                GMM* gmm;
+                float* mean;
+                ushort* cgmm = 0;
+                ushort* cmean = 0;
+                if( compact )
+                {
+                    cgmm = (ushort*)model0 + (rowOfs + x*nmixtures)*2;
+                    cmean = (ushort*)model0 + modelSize*2 + (rowOfs + x*nmixtures)*nchannels;
+                    gmm = (GMM*)pixelModel.data();
+                    mean = pixelModel.data() + nmixtures*2;
+                    for( int mode = 0, nused = modesUsed[x]; mode < nused; mode++ )
+                    {
+                        gmm[mode].weight = cgmm[mode*2]*wscale;
+                        gmm[mode].variance = cgmm[mode*2 + 1]*vscale;
+                        for( int c = 0; c < nchannels; c++ )
+                            mean[mode*nchannels + c] = cmean[mode*nchannels + c]*vscale;
+                    }
+                }
+                else
+                {
+                    gmm = (GMM*)model0 + rowOfs + x*nmixtures;
+                    mean = (float*)((GMM*)model0 + modelSize) + (rowOfs + x*nmixtures)*nchannels;
+                }
+
                 //calculate distances to the modes (+ sort)
                 //here we need to go in descending order!!!
                 bool background = false;//return value -> true - the pixel classified as background
@@ -748,14 +802,25 @@ public:
                 mask[x] = background ? 0 :
                     detectShadows && detectShadowGMM(data, nchannels, nmodes, gmm, mean, Tb, TB, tau) ?
                     shadowVal : 255;
+
+                if( compact )
+                {
+                    for( int mode = 0; mode < nmodes; mode++ )
+                    {
+                        cgmm[mode*2] = saturate_cast<ushort>(gmm[mode].weight*compactWeightScale);
+                        cgmm[mode*2 + 1] = saturate_cast<ushort>(gmm[mode].variance*compactValueScale);
+                        for( int c = 0; c < nchannels; c++ )
+                            cmean[mode*nchannels + c] = saturate_cast<ushort>(mean[mode*nchannels + c]*compactValueScale);
+                    }
+                }
             }
         }
     }
 
-    const Mat* src;
-    Mat* dst;
-    GMM* gmm0;
-    float* mean0;
+    Mat src;
+    mutable Mat dst;
+    uchar* model0;
+    bool compact;
     uchar* modesUsed0;
 
     int nmixtures;
@@ -846,10 +911,18 @@ void BackgroundSubtractorMOG2Impl::apply(InputArray _image, OutputArray _fgmask,
 {
     CV_INSTRUMENT_REGION()
 
+    Ptr<ParallelLoopBody> update = prepareUpdate(_image, _fgmask, learningRate);
+    if (update)
+        parallel_for_(Range(0, _image.rows()), *update, _image.total()/(double)(1 << 16));
+}
+
+Ptr<ParallelLoopBody> BackgroundSubtractorMOG2Impl::prepareUpdate(InputArray _image, OutputArray _fgmask, double learningRate)
+{
 #ifdef HAVE_OPENCL
     if (opencl_ON)
     {
-        CV_OCL_RUN(_fgmask.isUMat(), ocl_apply(_image, _fgmask, learningRate))
+        CV_OCL_RUN_(_fgmask.isUMat() && !isCompact(_image.type()), ocl_apply(_image, _fgmask, learningRate),
+                    Ptr<ParallelLoopBody>())
 
         opencl_ON = false;
         nframes = 0;
@@ -869,16 +942,11 @@ void BackgroundSubtractorMOG2Impl::apply(InputArray _image, OutputArray _fgmask,
     learningRate = learningRate >= 0 && nframes > 1 ? learningRate : 1./std::min( 2*nframes, history );
     CV_Assert(learningRate >= 0);
 
-    parallel_for_(Range(0, image.rows),
-                  MOG2Invoker(image, fgmask,
-                              bgmodel.ptr<GMM>(),
-                              (float*)(bgmodel.ptr() + sizeof(GMM)*nmixtures*image.rows*image.cols),
-                              bgmodelUsedModes.ptr(), nmixtures, (float)learningRate,
-                              (float)varThreshold,
-                              backgroundRatio, varThresholdGen,
-                              fVarInit, fVarMin, fVarMax, float(-learningRate*fCT), fTau,
-                              bShadowDetection, nShadowDetection),
-                              image.total()/(double)(1 << 16));
+    return Ptr<ParallelLoopBody>(new MOG2Invoker(image, fgmask, bgmodel, bgmodelUsedModes, nmixtures, (float)learningRate,
+                                                 (float)varThreshold,
+                                                 backgroundRatio, varThresholdGen,
+                                                 fVarInit, fVarMin, fVarMax, float(-learningRate*fCT), fTau,
+                                                 bShadowDetection, nShadowDetection));
 }
 
 template <typename T, int CN>
@@ -888,8 +956,23 @@ void BackgroundSubtractorMOG2Impl::getBackgroundImage_intern(OutputArray backgro
 
     Mat meanBackground(frameSize, frameType, Scalar::all(0));
     int firstGaussianIdx = 0;
-    const GMM* gmm = bgmodel.ptr<GMM>();
-    const float* mean = reinterpret_cast<const float*>(gmm + frameSize.width*frameSize.height*nmixtures);
+    size_t modelSize = (size_t)frameSize.width*frameSize.height*nmixtures;
+    Mat model = bgmodel;
+    if (model.depth() == CV_16U)
+    {
+        model.create(1, bgmodel.cols, CV_32F);
+        GMM* cvtgmm = model.ptr<GMM>();
+        const ushort* cgmm = bgmodel.ptr<ushort>();
+        for (size_t i = 0; i < modelSize; i++)
+        {
+            cvtgmm[i].weight = cgmm[i*2]*(1.f/compactWeightScale);
+            cvtgmm[i].variance = cgmm[i*2 + 1]*(1.f/compactValueScale);
+        }
+        bgmodel.colRange((int)modelSize*2, bgmodel.cols).convertTo(
+            model.colRange((int)modelSize*2, model.cols), CV_32F, 1./compactValueScale);
+    }
+    const GMM* gmm = model.ptr<GMM>();
+    const float* mean = reinterpret_cast<const float*>(gmm + modelSize);
     Vec<float,CN> meanVal(0.f);
     for(int row=0; row<meanBackground.rows; row++)
     {
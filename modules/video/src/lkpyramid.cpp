@@ -545,6 +545,12 @@ void cv::detail::LKTrackerInvoker::operator()(const Range& range) const
         nextPt -= halfWin;
         Point2f prevDelta;
 
+        // the position found on a coarse level is only the initial estimation for the next one,
+        // where a quarter of a pixel becomes a half, well inside the window
+        double epsilon = criteria.epsilon;
+        if( level > 0 && (flags & OPTFLOW_LK_EARLY_EXIT) != 0 )
+            epsilon = std::max(epsilon, 0.25*0.25);
+
         for( j = 0; j < criteria.maxCount; j++ )
         {
             inextPt.x = cvFloor(nextPt.x);
@@ -623,6 +629,28 @@ void cv::detail::LKTrackerInvoker::operator()(const Range& range) const
                     qb0 = _mm_add_ps(qb0, _mm_cvtepi32_ps(v00));
                     qb1 = _mm_add_ps(qb1, _mm_cvtepi32_ps(v11));
                 }
+
+                // the rest of the window row, 4 pixels at a time; the float sums are rounded in another
+                // order than in the scalar loop, so the results may differ from it in the last bits
+                for( ; x <= winSize.width*cn - 4; x += 4, dIptr += 4*2 )
+                {
+                    __m128i diff0 = _mm_loadl_epi64((const __m128i*)(Iptr + x));
+                    __m128i v00 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(*(const int*)(Jptr + x)), z);
+                    __m128i v01 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(*(const int*)(Jptr + x + cn)), z);
+                    __m128i v10 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(*(const int*)(Jptr + x + stepJ)), z);
+                    __m128i v11 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(*(const int*)(Jptr + x + stepJ + cn)), z);
+
+                    __m128i t0 = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(v00, v01), qw0),
+                                               _mm_madd_epi16(_mm_unpacklo_epi16(v10, v11), qw1));
+                    t0 = _mm_srai_epi32(_mm_add_epi32(t0, qdelta), W_BITS1-5);
+                    diff0 = _mm_subs_epi16(_mm_packs_epi32(t0, t0), diff0);
+                    diff0 = _mm_unpacklo_epi16(diff0, diff0); // It0 It0 It1 It1 ...
+                    v00 = _mm_loadu_si128((const __m128i*)(dIptr)); // Ix0 Iy0 Ix1 Iy1 ...
+                    v01 = _mm_mullo_epi16(diff0, v00);
+                    v10 = _mm_mulhi_epi16(diff0, v00);
+                    v00 = _mm_add_epi32(_mm_unpacklo_epi16(v01, v10), _mm_unpackhi_epi16(v01, v10));
+                    qb0 = _mm_add_ps(qb0, _mm_cvtepi32_ps(v00));
+                }
 #endif
 
 #if CV_NEON
@@ -791,7 +819,7 @@ void cv::detail::LKTrackerInvoker::operator()(const Range& range) const
             nextPt += delta;
             nextPts[ptidx] = nextPt + halfWin;
 
-            if( delta.ddot(delta) <= criteria.epsilon )
+            if( delta.ddot(delta) <= epsilon )
                 break;
 
             if( j > 0 && std::abs(delta.x + prevDelta.x) < 0.01 &&
@@ -827,13 +855,44 @@ void cv::detail::LKTrackerInvoker::operator()(const Range& range) const
             iw10 = cvRound((1.f - aa)*bb*(1 << W_BITS));
             iw11 = (1 << W_BITS) - iw00 - iw01 - iw10;
             float errval = 0.f;
+#if CV_SIMD128
+            v_int16x8 ew0 = v_reinterpret_as_s16(v_setall_s32(iw00 + (iw01 << 16)));
+            v_int16x8 ew1 = v_reinterpret_as_s16(v_setall_s32(iw10 + (iw11 << 16)));
+            v_int32x4 edelta = v_setall_s32(1 << (W_BITS1-5-1));
+#endif
 
             for( y = 0; y < winSize.height; y++ )
             {
                 const uchar* Jptr = J.ptr() + (y + inextPoint.y)*stepJ + inextPoint.x*cn;
                 const deriv_type* Iptr = IWinBuf.ptr<deriv_type>(y);
 
-                for( x = 0; x < winSize.width*cn; x++ )
+                x = 0;
+#if CV_SIMD128
+                // the sums of the absolute differences are exact in float, as the scalar ones,
+                // while the window has less than 2^24/(255 << 5) pixels
+                v_float32x4 qerr = v_setzero_f32();
+                for( ; x <= winSize.width*cn - 8; x += 8 )
+                {
+                    v_int16x8 v00 = v_reinterpret_as_s16(v_load_expand(Jptr + x));
+                    v_int16x8 v01 = v_reinterpret_as_s16(v_load_expand(Jptr + x + cn));
+                    v_int16x8 v10 = v_reinterpret_as_s16(v_load_expand(Jptr + x + stepJ));
+                    v_int16x8 v11 = v_reinterpret_as_s16(v_load_expand(Jptr + x + stepJ + cn));
+                    v_int16x8 t00, t01, t10, t11;
+                    v_zip(v00, v01, t00, t01);
+                    v_zip(v10, v11, t10, t11);
+
+                    v_int32x4 t0 = v_dotprod(t00, ew0) + v_dotprod(t10, ew1);
+                    v_int32x4 t1 = v_dotprod(t01, ew0) + v_dotprod(t11, ew1);
+                    t0 = (t0 + edelta) >> (W_BITS1-5);
+                    t1 = (t1 + edelta) >> (W_BITS1-5);
+
+                    v_uint32x4 e0, e1;
+                    v_expand(v_abs(v_pack(t0, t1) - v_load(Iptr + x)), e0, e1);
+                    qerr += v_cvt_f32(v_reinterpret_as_s32(e0 + e1));
+                }
+                errval += v_reduce_sum(qerr);
+#endif
+                for( ; x < winSize.width*cn; x++ )
                 {
                     int diff = CV_DESCALE(Jptr[x]*iw00 + Jptr[x+cn]*iw01 +
                                           Jptr[x+stepJ]*iw10 + Jptr[x+stepJ+cn]*iw11,
@@ -961,7 +1020,8 @@ namespace
                          TermCriteria criteria_ = TermCriteria(TermCriteria::COUNT+TermCriteria::EPS, 30, 0.01),
                          int flags_ = 0,
                          double minEigThreshold_ = 1e-4) :
-          winSize(winSize_), maxLevel(maxLevel_), criteria(criteria_), flags(flags_), minEigThreshold(minEigThreshold_)
+          winSize(winSize_), maxLevel(maxLevel_), criteria(criteria_), flags(flags_), minEigThreshold(minEigThreshold_),
+          reuseBuffers(false), cachedMaxLevel(-1)
 #ifdef HAVE_OPENCL
           , iters(criteria_.maxCount), derivLambda(criteria_.epsilon), useInitialFlow(0 != (flags_ & OPTFLOW_LK_GET_MIN_EIGENVALS)), waveSize(0)
 #endif
@@ -983,6 +1043,14 @@ namespace
         virtual double getMinEigThreshold() const CV_OVERRIDE { return minEigThreshold;}
         virtual void setMinEigThreshold(double minEigThreshold_) CV_OVERRIDE { minEigThreshold=minEigThreshold_;}
 
+        virtual bool getReuseBuffers() const CV_OVERRIDE { return reuseBuffers; }
+        virtual void setReuseBuffers(bool reuseBuffers_) CV_OVERRIDE
+        {
+            reuseBuffers = reuseBuffers_;
+            if( !reuseBuffers )
+                releaseCache();
+        }
+
         virtual void calc(InputArray prevImg, InputArray nextImg,
                           InputArray prevPts, InputOutputArray nextPts,
                           OutputArray status,
@@ -1071,6 +1139,28 @@ namespace
         TermCriteria criteria;
         int flags;
         double minEigThreshold;
+        bool reuseBuffers;
+
+        // pyramid with derivatives of the last "next" image, used when the following call gets
+        // the same image as "prev"; the other buffer keeps the storage of the previous one
+        std::vector<Mat> cachedPyr, freePyr;
+        Size cachedWinSize;
+        int cachedMaxLevel;
+
+        void releaseCache()
+        {
+            cachedPyr.clear();
+            freePyr.clear();
+        }
+
+        bool isCached(const Mat& img) const
+        {
+            if( cachedPyr.empty() || cachedWinSize != winSize || cachedMaxLevel != maxLevel )
+                return false;
+            const Mat& lvl0 = cachedPyr[0];
+            return lvl0.size() == img.size() && lvl0.type() == img.type() &&
+                   norm(lvl0, img, NORM_INF) == 0;
+        }
 #ifdef HAVE_OPENCL
         int iters;
         double derivLambda;
@@ -1387,7 +1477,11 @@ void SparsePyrLKOpticalFlowImpl::calc( InputArray _prevImg, InputArray _nextImg,
     Mat prevPtsMat = _prevPts.getMat();
     const int derivDepth = DataType<cv::detail::deriv_type>::depth;
 
-    CV_Assert( maxLevel >= 0 && winSize.width > 2 && winSize.height > 2 );
+    // the parameters are adjusted to the input below, the object keeps the requested ones
+    int curMaxLevel = maxLevel;
+    TermCriteria crit = criteria;
+
+    CV_Assert( curMaxLevel >= 0 && winSize.width > 2 && winSize.height > 2 );
 
     int level=0, i, npoints;
     CV_Assert( (npoints = prevPtsMat.checkVector(2, CV_32F, true)) >= 0 );
@@ -1456,8 +1550,8 @@ void SparsePyrLKOpticalFlowImpl::calc( InputArray _prevImg, InputArray _nextImg,
                 && ofs.y + prevPyr[lvlStep1].rows + winSize.height <= fullSize.height);
         }
 
-        if(levels1 < maxLevel)
-            maxLevel = levels1;
+        if(levels1 < curMaxLevel)
+            curMaxLevel = levels1;
     }
 
     if(_nextImg.kind() == _InputArray::STD_VECTOR_MAT)
@@ -1484,32 +1578,53 @@ void SparsePyrLKOpticalFlowImpl::calc( InputArray _prevImg, InputArray _nextImg,
                 && ofs.y + nextPyr[lvlStep2].rows + winSize.height <= fullSize.height);
         }
 
-        if(levels2 < maxLevel)
-            maxLevel = levels2;
+        if(levels2 < curMaxLevel)
+            curMaxLevel = levels2;
+    }
+
+    bool reuse = reuseBuffers && levels1 < 0 && levels2 < 0;
+    if (reuse)
+    {
+        // both pyramids are built with the derivatives, the one of nextImg is kept for the next call
+        Mat prevImg = _prevImg.getMat();
+        if (isCached(prevImg))
+        {
+            prevPyr = cachedPyr;
+            curMaxLevel = (int)prevPyr.size()/2 - 1;
+        }
+        else
+            curMaxLevel = buildOpticalFlowPyramid(prevImg, prevPyr, winSize, curMaxLevel, true,
+                                               BORDER_REFLECT_101, BORDER_CONSTANT, false);
+
+        nextPyr.swap(freePyr);
+        curMaxLevel = buildOpticalFlowPyramid(_nextImg, nextPyr, winSize, curMaxLevel, true,
+                                           BORDER_REFLECT_101, BORDER_CONSTANT, false);
+        levels1 = levels2 = curMaxLevel;
+        lvlStep1 = lvlStep2 = 2;
     }
 
     if (levels1 < 0)
-        maxLevel = buildOpticalFlowPyramid(_prevImg, prevPyr, winSize, maxLevel, false);
+        curMaxLevel = buildOpticalFlowPyramid(_prevImg, prevPyr, winSize, curMaxLevel, false);
 
     if (levels2 < 0)
-        maxLevel = buildOpticalFlowPyramid(_nextImg, nextPyr, winSize, maxLevel, false);
+        curMaxLevel = buildOpticalFlowPyramid(_nextImg, nextPyr, winSize, curMaxLevel, false);
 
-    if( (criteria.type & TermCriteria::COUNT) == 0 )
-        criteria.maxCount = 30;
+    if( (crit.type & TermCriteria::COUNT) == 0 )
+        crit.maxCount = 30;
     else
-        criteria.maxCount = std::min(std::max(criteria.maxCount, 0), 100);
-    if( (criteria.type & TermCriteria::EPS) == 0 )
-        criteria.epsilon = 0.01;
+        crit.maxCount = std::min(std::max(crit.maxCount, 0), 100);
+    if( (crit.type & TermCriteria::EPS) == 0 )
+        crit.epsilon = 0.01;
     else
-        criteria.epsilon = std::min(std::max(criteria.epsilon, 0.), 10.);
-    criteria.epsilon *= criteria.epsilon;
+        crit.epsilon = std::min(std::max(crit.epsilon, 0.), 10.);
+    crit.epsilon *= crit.epsilon;
 
     // dI/dx ~ Ix, dI/dy ~ Iy
     Mat derivIBuf;
     if(lvlStep1 == 1)
         derivIBuf.create(prevPyr[0].rows + winSize.height*2, prevPyr[0].cols + winSize.width*2, CV_MAKETYPE(derivDepth, prevPyr[0].channels() * 2));
 
-    for( level = maxLevel; level >= 0; level-- )
+    for( level = curMaxLevel; level >= 0; level-- )
     {
         Mat derivI;
         if(lvlStep1 == 1)
@@ -1531,9 +1646,17 @@ void SparsePyrLKOpticalFlowImpl::calc( InputArray _prevImg, InputArray _nextImg,
         parallel_for_(Range(0, npoints), LKTrackerInvoker(prevPyr[level * lvlStep1], derivI,
                                                           nextPyr[level * lvlStep2], prevPts, nextPts,
                                                           status, err,
-                                                          winSize, criteria, level, maxLevel,
+                                                          winSize, crit, level, curMaxLevel,
                                                           flags, (float)minEigThreshold));
     }
+
+    if (reuse)
+    {
+        cachedPyr.swap(nextPyr);
+        freePyr.swap(prevPyr);
+        cachedWinSize = winSize;
+        cachedMaxLevel = maxLevel;
+    }
 }
 
 } // namespace
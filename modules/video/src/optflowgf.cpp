@@ -113,93 +113,167 @@ FarnebackPrepareGaussian(int n, double sigma, float *g, float *xg, float *xxg,
     ig55 = invG(5,5);
 }
 
-static void
-FarnebackPolyExp( const Mat& src, Mat& dst, int n, double sigma )
+class FarnebackPolyExpInvoker : public ParallelLoopBody
 {
-    int k, x, y;
-
-    CV_Assert( src.type() == CV_32FC1 );
-    int width = src.cols;
-    int height = src.rows;
-    AutoBuffer<float> kbuf(n*6 + 3), _row((width + n*2)*3);
-    float* g = kbuf.data() + n;
-    float* xg = g + n*2 + 1;
-    float* xxg = xg + n*2 + 1;
-    float *row = _row.data() + n*3;
-    double ig11, ig03, ig33, ig55;
-
-    FarnebackPrepareGaussian(n, sigma, g, xg, xxg, ig11, ig03, ig33, ig55);
-
-    dst.create( height, width, CV_32FC(5));
-
-    for( y = 0; y < height; y++ )
+public:
+    FarnebackPolyExpInvoker( const Mat& _src, Mat& _dst, int _n, const float* _g, const float* _xg,
+                             const float* _xxg, double _ig11, double _ig03, double _ig33, double _ig55 )
+        : src(&_src), dst(&_dst), n(_n), g(_g), xg(_xg), xxg(_xxg),
+          ig11(_ig11), ig03(_ig03), ig33(_ig33), ig55(_ig55)
     {
-        float g0 = g[0], g1, g2;
-        const float *srow0 = src.ptr<float>(y), *srow1 = 0;
-        float *drow = dst.ptr<float>(y);
+    }
 
-        // vertical part of convolution
-        for( x = 0; x < width; x++ )
-        {
-            row[x*3] = srow0[x]*g0;
-            row[x*3+1] = row[x*3+2] = 0.f;
-        }
+    void operator()( const Range& range ) const CV_OVERRIDE
+    {
+        int k, x, y, width = src->cols, height = src->rows;
+        AutoBuffer<float> _row((width + n*2)*3);
+        float *row = _row.data() + n*3;
 
-        for( k = 1; k <= n; k++ )
+        for( y = range.start; y < range.end; y++ )
         {
-            g0 = g[k]; g1 = xg[k]; g2 = xxg[k];
-            srow0 = src.ptr<float>(std::max(y-k,0));
-            srow1 = src.ptr<float>(std::min(y+k,height-1));
-
-            for( x = 0; x < width; x++ )
+            float g0 = g[0];
+            const float *srow0 = src->ptr<float>(y), *srow1 = 0;
+            float *drow = dst->ptr<float>(y);
+
+            // vertical part of convolution
+            x = 0;
+#if CV_SIMD128
+            for( ; x <= width - 4; x += 4 )
             {
-                float p = srow0[x] + srow1[x];
-                float t0 = row[x*3] + g0*p;
-                float t1 = row[x*3+1] + g1*(srow1[x] - srow0[x]);
-                float t2 = row[x*3+2] + g2*p;
-
+                v_float32x4 t0 = v_load(srow0 + x)*v_setall_f32(g0);
+                v_float32x4 t1 = v_setzero_f32(), t2 = v_setzero_f32();
+                for( k = 1; k <= n; k++ )
+                {
+                    v_float32x4 s0 = v_load(src->ptr<float>(std::max(y-k,0)) + x);
+                    v_float32x4 s1 = v_load(src->ptr<float>(std::min(y+k,height-1)) + x);
+                    v_float32x4 p = s0 + s1;
+                    t0 += v_setall_f32(g[k])*p;
+                    t1 += v_setall_f32(xg[k])*(s1 - s0);
+                    t2 += v_setall_f32(xxg[k])*p;
+                }
+                v_store_interleave(row + x*3, t0, t1, t2);
+            }
+#endif
+            for( ; x < width; x++ )
+            {
+                float t0 = srow0[x]*g0, t1 = 0.f, t2 = 0.f;
+                for( k = 1; k <= n; k++ )
+                {
+                    srow0 = src->ptr<float>(std::max(y-k,0));
+                    srow1 = src->ptr<float>(std::min(y+k,height-1));
+                    float p = srow0[x] + srow1[x];
+                    t0 += g[k]*p;
+                    t1 += xg[k]*(srow1[x] - srow0[x]);
+                    t2 += xxg[k]*p;
+                }
+                srow0 = src->ptr<float>(y);
                 row[x*3] = t0;
                 row[x*3+1] = t1;
                 row[x*3+2] = t2;
             }
-        }
-
-        // horizontal part of convolution
-        for( x = 0; x < n*3; x++ )
-        {
-            row[-1-x] = row[2-x];
-            row[width*3+x] = row[width*3+x-3];
-        }
 
-        for( x = 0; x < width; x++ )
-        {
-            g0 = g[0];
-            // r1 ~ 1, r2 ~ x, r3 ~ y, r4 ~ x^2, r5 ~ y^2, r6 ~ xy
-            double b1 = row[x*3]*g0, b2 = 0, b3 = row[x*3+1]*g0,
-                b4 = 0, b5 = row[x*3+2]*g0, b6 = 0;
+            // horizontal part of convolution
+            for( x = 0; x < n*3; x++ )
+            {
+                row[-1-x] = row[2-x];
+                row[width*3+x] = row[width*3+x-3];
+            }
 
-            for( k = 1; k <= n; k++ )
+            x = 0;
+#if CV_SIMD128
             {
-                double tg = row[(x+k)*3] + row[(x-k)*3];
-                g0 = g[k];
-                b1 += tg*g0;
-                b4 += tg*xxg[k];
-                b2 += (row[(x+k)*3] - row[(x-k)*3])*xg[k];
-                b3 += (row[(x+k)*3+1] + row[(x-k)*3+1])*g0;
-                b6 += (row[(x+k)*3+1] - row[(x-k)*3+1])*xg[k];
-                b5 += (row[(x+k)*3+2] + row[(x-k)*3+2])*g0;
+                v_float32x4 vig11 = v_setall_f32((float)ig11), vig03 = v_setall_f32((float)ig03);
+                v_float32x4 vig33 = v_setall_f32((float)ig33), vig55 = v_setall_f32((float)ig55);
+                for( ; x <= width - 4; x += 4 )
+                {
+                    // r1 ~ 1, r2 ~ x, r3 ~ y, r4 ~ x^2, r5 ~ y^2, r6 ~ xy
+                    v_float32x4 c0, c1, c2, l0, l1, l2;
+                    v_load_deinterleave(row + x*3, c0, c1, c2);
+                    v_float32x4 vg0 = v_setall_f32(g[0]);
+                    v_float32x4 b1 = c0*vg0, b2 = v_setzero_f32(), b3 = c1*vg0,
+                        b4 = v_setzero_f32(), b5 = c2*vg0, b6 = v_setzero_f32();
+
+                    for( k = 1; k <= n; k++ )
+                    {
+                        v_load_deinterleave(row + (x+k)*3, c0, c1, c2);
+                        v_load_deinterleave(row + (x-k)*3, l0, l1, l2);
+                        v_float32x4 tg = c0 + l0, vg = v_setall_f32(g[k]), vxg = v_setall_f32(xg[k]);
+                        b1 += tg*vg;
+                        b4 += tg*v_setall_f32(xxg[k]);
+                        b2 += (c0 - l0)*vxg;
+                        b3 += (c1 + l1)*vg;
+                        b6 += (c1 - l1)*vxg;
+                        b5 += (c2 + l2)*vg;
+                    }
+
+                    // do not store r1
+                    v_float32x4 v0 = b3*vig11, v1 = b2*vig11, v2 = b1*vig03 + b5*vig33,
+                        v3 = b1*vig03 + b4*vig33, v4 = b6*vig55;
+                    float buf[20];
+                    v_store_interleave(buf, v0, v1, v2, v3);
+                    v_store(buf + 16, v4);
+                    for( int j = 0; j < 4; j++ )
+                    {
+                        float* d = drow + (x + j)*5;
+                        d[0] = buf[j*4]; d[1] = buf[j*4+1]; d[2] = buf[j*4+2]; d[3] = buf[j*4+3];
+                        d[4] = buf[16+j];
+                    }
+                }
             }
+#endif
+            for( ; x < width; x++ )
+            {
+                g0 = g[0];
+                // r1 ~ 1, r2 ~ x, r3 ~ y, r4 ~ x^2, r5 ~ y^2, r6 ~ xy
+                double b1 = row[x*3]*g0, b2 = 0, b3 = row[x*3+1]*g0,
+                    b4 = 0, b5 = row[x*3+2]*g0, b6 = 0;
 
-            // do not store r1
-            drow[x*5+1] = (float)(b2*ig11);
-            drow[x*5] = (float)(b3*ig11);
-            drow[x*5+3] = (float)(b1*ig03 + b4*ig33);
-            drow[x*5+2] = (float)(b1*ig03 + b5*ig33);
-            drow[x*5+4] = (float)(b6*ig55);
+                for( k = 1; k <= n; k++ )
+                {
+                    double tg = row[(x+k)*3] + row[(x-k)*3];
+                    g0 = g[k];
+                    b1 += tg*g0;
+                    b4 += tg*xxg[k];
+                    b2 += (row[(x+k)*3] - row[(x-k)*3])*xg[k];
+                    b3 += (row[(x+k)*3+1] + row[(x-k)*3+1])*g0;
+                    b6 += (row[(x+k)*3+1] - row[(x-k)*3+1])*xg[k];
+                    b5 += (row[(x+k)*3+2] + row[(x-k)*3+2])*g0;
+                }
+
+                // do not store r1
+                drow[x*5+1] = (float)(b2*ig11);
+                drow[x*5] = (float)(b3*ig11);
+                drow[x*5+3] = (float)(b1*ig03 + b4*ig33);
+                drow[x*5+2] = (float)(b1*ig03 + b5*ig33);
+                drow[x*5+4] = (float)(b6*ig55);
+            }
         }
     }
 
-    row -= n*3;
+private:
+    const Mat* src;
+    Mat* dst;
+    int n;
+    const float *g, *xg, *xxg;
+    double ig11, ig03, ig33, ig55;
+};
+
+static void
+FarnebackPolyExp( const Mat& src, Mat& dst, int n, double sigma )
+{
+    CV_Assert( src.type() == CV_32FC1 );
+    AutoBuffer<float> kbuf(n*6 + 3);
+    float* g = kbuf.data() + n;
+    float* xg = g + n*2 + 1;
+    float* xxg = xg + n*2 + 1;
+    double ig11, ig03, ig33, ig55;
+
+    FarnebackPrepareGaussian(n, sigma, g, xg, xxg, ig11, ig03, ig33, ig55);
+
+    dst.create( src.rows, src.cols, CV_32FC(5));
+    parallel_for_(Range(0, src.rows),
+                  FarnebackPolyExpInvoker(src, dst, n, g, xg, xxg, ig11, ig03, ig33, ig55),
+                  src.total()/(1 << 14));
 }
 
 
@@ -214,315 +288,274 @@ FarnebackPolyExpPyr( const Mat& src0, Vector<Mat>& pyr, int maxlevel, int n, dou
 }*/
 
 
-static void
-FarnebackUpdateMatrices( const Mat& _R0, const Mat& _R1, const Mat& _flow, Mat& matM, int _y0, int _y1 )
+class FarnebackUpdateMatricesInvoker : public ParallelLoopBody
 {
-    const int BORDER = 5;
-    static const float border[BORDER] = {0.14f, 0.14f, 0.4472f, 0.4472f, 0.4472f};
-
-    int x, y, width = _flow.cols, height = _flow.rows;
-    const float* R1 = _R1.ptr<float>();
-    size_t step1 = _R1.step/sizeof(R1[0]);
-
-    matM.create(height, width, CV_32FC(5));
+public:
+    FarnebackUpdateMatricesInvoker( const Mat& _R0, const Mat& _R1, const Mat& _flow, Mat& _matM )
+        : R0mat(&_R0), R1mat(&_R1), flowmat(&_flow), matM(&_matM)
+    {
+    }
 
-    for( y = _y0; y < _y1; y++ )
+    void operator()( const Range& range ) const CV_OVERRIDE
     {
-        const float* flow = _flow.ptr<float>(y);
-        const float* R0 = _R0.ptr<float>(y);
-        float* M = matM.ptr<float>(y);
+        const int BORDER = 5;
+        static const float border[BORDER] = {0.14f, 0.14f, 0.4472f, 0.4472f, 0.4472f};
 
-        for( x = 0; x < width; x++ )
+        int x, y, width = flowmat->cols, height = flowmat->rows;
+        const float* R1 = R1mat->ptr<float>();
+        size_t step1 = R1mat->step/sizeof(R1[0]);
+
+        for( y = range.start; y < range.end; y++ )
         {
-            float dx = flow[x*2], dy = flow[x*2+1];
-            float fx = x + dx, fy = y + dy;
+            const float* flow = flowmat->ptr<float>(y);
+            const float* R0 = R0mat->ptr<float>(y);
+            float* M = matM->ptr<float>(y);
 
-#if 1
-            int x1 = cvFloor(fx), y1 = cvFloor(fy);
-            const float* ptr = R1 + y1*step1 + x1*5;
-            float r2, r3, r4, r5, r6;
+            for( x = 0; x < width; x++ )
+            {
+                float dx = flow[x*2], dy = flow[x*2+1];
+                float fx = x + dx, fy = y + dy;
 
-            fx -= x1; fy -= y1;
+                int x1 = cvFloor(fx), y1 = cvFloor(fy);
+                const float* ptr = R1 + y1*step1 + x1*5;
+                float r2, r3, r4, r5, r6;
 
-            if( (unsigned)x1 < (unsigned)(width-1) &&
-                (unsigned)y1 < (unsigned)(height-1) )
-            {
-                float a00 = (1.f-fx)*(1.f-fy), a01 = fx*(1.f-fy),
-                      a10 = (1.f-fx)*fy, a11 = fx*fy;
-
-                r2 = a00*ptr[0] + a01*ptr[5] + a10*ptr[step1] + a11*ptr[step1+5];
-                r3 = a00*ptr[1] + a01*ptr[6] + a10*ptr[step1+1] + a11*ptr[step1+6];
-                r4 = a00*ptr[2] + a01*ptr[7] + a10*ptr[step1+2] + a11*ptr[step1+7];
-                r5 = a00*ptr[3] + a01*ptr[8] + a10*ptr[step1+3] + a11*ptr[step1+8];
-                r6 = a00*ptr[4] + a01*ptr[9] + a10*ptr[step1+4] + a11*ptr[step1+9];
-
-                r4 = (R0[x*5+2] + r4)*0.5f;
-                r5 = (R0[x*5+3] + r5)*0.5f;
-                r6 = (R0[x*5+4] + r6)*0.25f;
-            }
-#else
-            int x1 = cvRound(fx), y1 = cvRound(fy);
-            const float* ptr = R1 + y1*step1 + x1*5;
-            float r2, r3, r4, r5, r6;
+                fx -= x1; fy -= y1;
 
-            if( (unsigned)x1 < (unsigned)width &&
-                (unsigned)y1 < (unsigned)height )
-            {
-                r2 = ptr[0];
-                r3 = ptr[1];
-                r4 = (R0[x*5+2] + ptr[2])*0.5f;
-                r5 = (R0[x*5+3] + ptr[3])*0.5f;
-                r6 = (R0[x*5+4] + ptr[4])*0.25f;
-            }
-#endif
-            else
-            {
-                r2 = r3 = 0.f;
-                r4 = R0[x*5+2];
-                r5 = R0[x*5+3];
-                r6 = R0[x*5+4]*0.5f;
-            }
+                if( (unsigned)x1 < (unsigned)(width-1) &&
+                    (unsigned)y1 < (unsigned)(height-1) )
+                {
+                    float a00 = (1.f-fx)*(1.f-fy), a01 = fx*(1.f-fy),
+                          a10 = (1.f-fx)*fy, a11 = fx*fy;
+
+                    r2 = a00*ptr[0] + a01*ptr[5] + a10*ptr[step1] + a11*ptr[step1+5];
+                    r3 = a00*ptr[1] + a01*ptr[6] + a10*ptr[step1+1] + a11*ptr[step1+6];
+                    r4 = a00*ptr[2] + a01*ptr[7] + a10*ptr[step1+2] + a11*ptr[step1+7];
+                    r5 = a00*ptr[3] + a01*ptr[8] + a10*ptr[step1+3] + a11*ptr[step1+8];
+                    r6 = a00*ptr[4] + a01*ptr[9] + a10*ptr[step1+4] + a11*ptr[step1+9];
+
+                    r4 = (R0[x*5+2] + r4)*0.5f;
+                    r5 = (R0[x*5+3] + r5)*0.5f;
+                    r6 = (R0[x*5+4] + r6)*0.25f;
+                }
+                else
+                {
+                    r2 = r3 = 0.f;
+                    r4 = R0[x*5+2];
+                    r5 = R0[x*5+3];
+                    r6 = R0[x*5+4]*0.5f;
+                }
 
-            r2 = (R0[x*5] - r2)*0.5f;
-            r3 = (R0[x*5+1] - r3)*0.5f;
+                r2 = (R0[x*5] - r2)*0.5f;
+                r3 = (R0[x*5+1] - r3)*0.5f;
 
-            r2 += r4*dy + r6*dx;
-            r3 += r6*dy + r5*dx;
+                r2 += r4*dy + r6*dx;
+                r3 += r6*dy + r5*dx;
 
-            if( (unsigned)(x - BORDER) >= (unsigned)(width - BORDER*2) ||
-                (unsigned)(y - BORDER) >= (unsigned)(height - BORDER*2))
-            {
-                float scale = (x < BORDER ? border[x] : 1.f)*
-                    (x >= width - BORDER ? border[width - x - 1] : 1.f)*
-                    (y < BORDER ? border[y] : 1.f)*
-                    (y >= height - BORDER ? border[height - y - 1] : 1.f);
+                if( (unsigned)(x - BORDER) >= (unsigned)(width - BORDER*2) ||
+                    (unsigned)(y - BORDER) >= (unsigned)(height - BORDER*2))
+                {
+                    float scale = (x < BORDER ? border[x] : 1.f)*
+                        (x >= width - BORDER ? border[width - x - 1] : 1.f)*
+                        (y < BORDER ? border[y] : 1.f)*
+                        (y >= height - BORDER ? border[height - y - 1] : 1.f);
 
-                r2 *= scale; r3 *= scale; r4 *= scale;
-                r5 *= scale; r6 *= scale;
-            }
+                    r2 *= scale; r3 *= scale; r4 *= scale;
+                    r5 *= scale; r6 *= scale;
+                }
 
-            M[x*5]   = r4*r4 + r6*r6; // G(1,1)
-            M[x*5+1] = (r4 + r5)*r6;  // G(1,2)=G(2,1)
-            M[x*5+2] = r5*r5 + r6*r6; // G(2,2)
-            M[x*5+3] = r4*r2 + r6*r3; // h(1)
-            M[x*5+4] = r6*r2 + r5*r3; // h(2)
+                M[x*5]   = r4*r4 + r6*r6; // G(1,1)
+                M[x*5+1] = (r4 + r5)*r6;  // G(1,2)=G(2,1)
+                M[x*5+2] = r5*r5 + r6*r6; // G(2,2)
+                M[x*5+3] = r4*r2 + r6*r3; // h(1)
+                M[x*5+4] = r6*r2 + r5*r3; // h(2)
+            }
         }
     }
-}
 
+private:
+    const Mat *R0mat, *R1mat, *flowmat;
+    Mat* matM;
+};
 
 static void
-FarnebackUpdateFlow_Blur( const Mat& _R0, const Mat& _R1,
-                          Mat& _flow, Mat& matM, int block_size,
-                          bool update_matrices )
+FarnebackUpdateMatrices( const Mat& _R0, const Mat& _R1, const Mat& _flow, Mat& matM, int _y0, int _y1 )
 {
-    int x, y, width = _flow.cols, height = _flow.rows;
-    int m = block_size/2;
-    int y0 = 0, y1;
-    int min_update_stripe = std::max((1 << 10)/width, block_size);
-    double scale = 1./(block_size*block_size);
+    matM.create(_flow.rows, _flow.cols, CV_32FC(5));
+    parallel_for_(Range(_y0, _y1), FarnebackUpdateMatricesInvoker(_R0, _R1, _flow, matM),
+                  (double)(_y1 - _y0)*_flow.cols/(1 << 14));
+}
 
-    AutoBuffer<double> _vsum((width+m*2+2)*5);
-    double* vsum = _vsum.data() + (m+1)*5;
 
-    // init vsum
-    const float* srow0 = matM.ptr<float>();
-    for( x = 0; x < width*5; x++ )
-        vsum[x] = srow0[x]*(m+2);
+// The flow of a stripe of rows is computed from the matrices of the stripe and its m-row
+// neighbourhood only. The stripes do not depend on the number of threads, so neither does the result.
+static int
+FarnebackFlowStripes( int height, int block_size )
+{
+    return std::max(height/std::max(64, block_size*4), 1);
+}
 
-    for( y = 1; y < m; y++ )
+class FarnebackUpdateFlowBlurInvoker : public ParallelLoopBody
+{
+public:
+    FarnebackUpdateFlowBlurInvoker( const Mat& _matM, Mat& _flow, int _block_size, int _nstripes )
+        : matM(&_matM), flowmat(&_flow), block_size(_block_size), nstripes(_nstripes)
     {
-        srow0 = matM.ptr<float>(std::min(y,height-1));
-        for( x = 0; x < width*5; x++ )
-            vsum[x] += srow0[x];
     }
 
-    // compute blur(G)*flow=blur(h)
-    for( y = 0; y < height; y++ )
+    void operator()( const Range& range ) const CV_OVERRIDE
     {
-        double g11, g12, g22, h1, h2;
-        float* flow = _flow.ptr<float>(y);
+        int x, y, width = flowmat->cols, height = flowmat->rows;
+        int m = block_size/2;
+        double scale = 1./(block_size*block_size);
 
-        srow0 = matM.ptr<float>(std::max(y-m-1,0));
-        const float* srow1 = matM.ptr<float>(std::min(y+m,height-1));
+        AutoBuffer<double> _vsum((width+m*2+2)*5);
+        double* vsum = _vsum.data() + (m+1)*5;
 
-        // vertical blur
-        for( x = 0; x < width*5; x++ )
-            vsum[x] += srow1[x] - srow0[x];
-
-        // update borders
-        for( x = 0; x < (m+1)*5; x++ )
+        for( int stripe = range.start; stripe < range.end; stripe++ )
         {
-            vsum[-1-x] = vsum[4-x];
-            vsum[width*5+x] = vsum[width*5+x-5];
-        }
+            int y0 = height*stripe/nstripes, y1 = height*(stripe + 1)/nstripes;
 
-        // init g** and h*
-        g11 = vsum[0]*(m+2);
-        g12 = vsum[1]*(m+2);
-        g22 = vsum[2]*(m+2);
-        h1 = vsum[3]*(m+2);
-        h2 = vsum[4]*(m+2);
+            // init vsum with the rows [y0-m-1, y0+m-1], the rows above the image replicate the first one
+            int ystart = std::max(y0-m-1, 0);
+            const float* srow0 = matM->ptr<float>(ystart);
+            for( x = 0; x < width*5; x++ )
+                vsum[x] = srow0[x]*(ystart - (y0-m-1) + 1);
 
-        for( x = 1; x < m; x++ )
-        {
-            g11 += vsum[x*5];
-            g12 += vsum[x*5+1];
-            g22 += vsum[x*5+2];
-            h1 += vsum[x*5+3];
-            h2 += vsum[x*5+4];
-        }
+            for( y = ystart + 1; y < y0+m; y++ )
+            {
+                srow0 = matM->ptr<float>(std::min(std::max(y,0),height-1));
+                for( x = 0; x < width*5; x++ )
+                    vsum[x] += srow0[x];
+            }
 
-        // horizontal blur
-        for( x = 0; x < width; x++ )
-        {
-            g11 += vsum[(x+m)*5] - vsum[(x-m)*5 - 5];
-            g12 += vsum[(x+m)*5 + 1] - vsum[(x-m)*5 - 4];
-            g22 += vsum[(x+m)*5 + 2] - vsum[(x-m)*5 - 3];
-            h1 += vsum[(x+m)*5 + 3] - vsum[(x-m)*5 - 2];
-            h2 += vsum[(x+m)*5 + 4] - vsum[(x-m)*5 - 1];
-
-            double g11_ = g11*scale;
-            double g12_ = g12*scale;
-            double g22_ = g22*scale;
-            double h1_ = h1*scale;
-            double h2_ = h2*scale;
-
-            double idet = 1./(g11_*g22_ - g12_*g12_+1e-3);
-
-            flow[x*2] = (float)((g11_*h2_-g12_*h1_)*idet);
-            flow[x*2+1] = (float)((g22_*h1_-g12_*h2_)*idet);
-        }
+            // compute blur(G)*flow=blur(h)
+            for( y = y0; y < y1; y++ )
+            {
+                double g11, g12, g22, h1, h2;
+                float* flow = flowmat->ptr<float>(y);
 
-        y1 = y == height - 1 ? height : y - block_size;
-        if( update_matrices && (y1 == height || y1 >= y0 + min_update_stripe) )
-        {
-            FarnebackUpdateMatrices( _R0, _R1, _flow, matM, y0, y1 );
-            y0 = y1;
+                srow0 = matM->ptr<float>(std::max(y-m-1,0));
+                const float* srow1 = matM->ptr<float>(std::min(y+m,height-1));
+
+                // vertical blur
+                x = 0;
+#if CV_SIMD128_64F
+                for( ; x <= width*5 - 4; x += 4 )
+                {
+                    v_float32x4 d = v_load(srow1 + x) - v_load(srow0 + x);
+                    v_store(vsum + x, v_load(vsum + x) + v_cvt_f64(d));
+                    v_store(vsum + x + 2, v_load(vsum + x + 2) + v_cvt_f64_high(d));
+                }
+#endif
+                for( ; x < width*5; x++ )
+                    vsum[x] += srow1[x] - srow0[x];
+
+                // update borders
+                for( x = 0; x < (m+1)*5; x++ )
+                {
+                    vsum[-1-x] = vsum[4-x];
+                    vsum[width*5+x] = vsum[width*5+x-5];
+                }
+
+                // init g** and h*
+                g11 = vsum[0]*(m+2);
+                g12 = vsum[1]*(m+2);
+                g22 = vsum[2]*(m+2);
+                h1 = vsum[3]*(m+2);
+                h2 = vsum[4]*(m+2);
+
+                for( x = 1; x < m; x++ )
+                {
+                    g11 += vsum[x*5];
+                    g12 += vsum[x*5+1];
+                    g22 += vsum[x*5+2];
+                    h1 += vsum[x*5+3];
+                    h2 += vsum[x*5+4];
+                }
+
+                // horizontal blur
+                for( x = 0; x < width; x++ )
+                {
+                    g11 += vsum[(x+m)*5] - vsum[(x-m)*5 - 5];
+                    g12 += vsum[(x+m)*5 + 1] - vsum[(x-m)*5 - 4];
+                    g22 += vsum[(x+m)*5 + 2] - vsum[(x-m)*5 - 3];
+                    h1 += vsum[(x+m)*5 + 3] - vsum[(x-m)*5 - 2];
+                    h2 += vsum[(x+m)*5 + 4] - vsum[(x-m)*5 - 1];
+
+                    double g11_ = g11*scale;
+                    double g12_ = g12*scale;
+                    double g22_ = g22*scale;
+                    double h1_ = h1*scale;
+                    double h2_ = h2*scale;
+
+                    double idet = 1./(g11_*g22_ - g12_*g12_+1e-3);
+
+                    flow[x*2] = (float)((g11_*h2_-g12_*h1_)*idet);
+                    flow[x*2+1] = (float)((g22_*h1_-g12_*h2_)*idet);
+                }
+            }
         }
     }
-}
 
+private:
+    const Mat* matM;
+    Mat* flowmat;
+    int block_size, nstripes;
+};
 
+// The flow of all the rows is computed from the current matrices first and the matrices are
+// updated afterwards. The single-threaded version interleaved the two passes, updating only
+// the rows that were no longer needed, which gives the same result.
 static void
-FarnebackUpdateFlow_GaussianBlur( const Mat& _R0, const Mat& _R1,
-                                  Mat& _flow, Mat& matM, int block_size,
-                                  bool update_matrices )
+FarnebackUpdateFlow_Blur( const Mat& _R0, const Mat& _R1,
+                          Mat& _flow, Mat& matM, int block_size,
+                          bool update_matrices )
 {
-    int x, y, i, width = _flow.cols, height = _flow.rows;
-    int m = block_size/2;
-    int y0 = 0, y1;
-    int min_update_stripe = std::max((1 << 10)/width, block_size);
-    double sigma = m*0.3, s = 1;
-
-    AutoBuffer<float> _vsum((width+m*2+2)*5 + 16), _hsum(width*5 + 16);
-    AutoBuffer<float> _kernel((m+1)*5 + 16);
-    AutoBuffer<const float*> _srow(m*2+1);
-    float *vsum = alignPtr(_vsum.data() + (m+1)*5, 16), *hsum = alignPtr(_hsum.data(), 16);
-    float* kernel = _kernel.data();
-    const float** srow = _srow.data();
-    kernel[0] = (float)s;
+    int nstripes = FarnebackFlowStripes(_flow.rows, block_size);
+    parallel_for_(Range(0, nstripes), FarnebackUpdateFlowBlurInvoker(matM, _flow, block_size, nstripes));
 
-    for( i = 1; i <= m; i++ )
-    {
-        float t = (float)std::exp(-i*i/(2*sigma*sigma) );
-        kernel[i] = t;
-        s += t*2;
-    }
+    if( update_matrices )
+        FarnebackUpdateMatrices( _R0, _R1, _flow, matM, 0, _flow.rows );
+}
 
-    s = 1./s;
-    for( i = 0; i <= m; i++ )
-        kernel[i] = (float)(kernel[i]*s);
 
-#if CV_SSE2
-    float* simd_kernel = alignPtr(kernel + m+1, 16);
-    volatile bool useSIMD = checkHardwareSupport(CV_CPU_SSE);
-    if( useSIMD )
-    {
-        for( i = 0; i <= m; i++ )
-            _mm_store_ps(simd_kernel + i*4, _mm_set1_ps(kernel[i]));
-    }
-#elif CV_VSX
-    float* simd_kernel = alignPtr(kernel + m+1, 16);
-    volatile bool useSIMD = checkHardwareSupport(CV_CPU_VSX);
-    if( useSIMD )
+class FarnebackUpdateFlowGaussianInvoker : public ParallelLoopBody
+{
+public:
+    FarnebackUpdateFlowGaussianInvoker( const Mat& _matM, Mat& _flow, int _m, const float* _kernel )
+        : matM(&_matM), flowmat(&_flow), m(_m), kernel(_kernel)
     {
-        for( i = 0; i <= m; i++ )
-            v_store(simd_kernel + i*4, v_setall_f32(kernel[i]));
     }
-#endif
 
-    // compute blur(G)*flow=blur(h)
-    for( y = 0; y < height; y++ )
+    void operator()( const Range& range ) const CV_OVERRIDE
     {
-        double g11, g12, g22, h1, h2;
-        float* flow = _flow.ptr<float>(y);
+        int x, y, i, width = flowmat->cols, height = flowmat->rows;
 
-        // vertical blur
-        for( i = 0; i <= m; i++ )
-        {
-            srow[m-i] = matM.ptr<float>(std::max(y-i,0));
-            srow[m+i] = matM.ptr<float>(std::min(y+i,height-1));
-        }
+        AutoBuffer<float> _vsum((width+m*2+2)*5 + 16), _hsum(width*5 + 16);
+        AutoBuffer<const float*> _srow(m*2+1);
+        float *vsum = alignPtr(_vsum.data() + (m+1)*5, 16), *hsum = alignPtr(_hsum.data(), 16);
+        const float** srow = _srow.data();
 
-        x = 0;
-#if CV_SSE2
-        if( useSIMD )
+        // compute blur(G)*flow=blur(h)
+        for( y = range.start; y < range.end; y++ )
         {
-            for( ; x <= width*5 - 16; x += 16 )
-            {
-                const float *sptr0 = srow[m], *sptr1;
-                __m128 g4 = _mm_load_ps(simd_kernel);
-                __m128 s0, s1, s2, s3;
-                s0 = _mm_mul_ps(_mm_loadu_ps(sptr0 + x), g4);
-                s1 = _mm_mul_ps(_mm_loadu_ps(sptr0 + x + 4), g4);
-                s2 = _mm_mul_ps(_mm_loadu_ps(sptr0 + x + 8), g4);
-                s3 = _mm_mul_ps(_mm_loadu_ps(sptr0 + x + 12), g4);
+            double g11, g12, g22, h1, h2;
+            float* flow = flowmat->ptr<float>(y);
 
-                for( i = 1; i <= m; i++ )
-                {
-                    __m128 x0, x1;
-                    sptr0 = srow[m+i], sptr1 = srow[m-i];
-                    g4 = _mm_load_ps(simd_kernel + i*4);
-                    x0 = _mm_add_ps(_mm_loadu_ps(sptr0 + x), _mm_loadu_ps(sptr1 + x));
-                    x1 = _mm_add_ps(_mm_loadu_ps(sptr0 + x + 4), _mm_loadu_ps(sptr1 + x + 4));
-                    s0 = _mm_add_ps(s0, _mm_mul_ps(x0, g4));
-                    s1 = _mm_add_ps(s1, _mm_mul_ps(x1, g4));
-                    x0 = _mm_add_ps(_mm_loadu_ps(sptr0 + x + 8), _mm_loadu_ps(sptr1 + x + 8));
-                    x1 = _mm_add_ps(_mm_loadu_ps(sptr0 + x + 12), _mm_loadu_ps(sptr1 + x + 12));
-                    s2 = _mm_add_ps(s2, _mm_mul_ps(x0, g4));
-                    s3 = _mm_add_ps(s3, _mm_mul_ps(x1, g4));
-                }
-
-                _mm_store_ps(vsum + x, s0);
-                _mm_store_ps(vsum + x + 4, s1);
-                _mm_store_ps(vsum + x + 8, s2);
-                _mm_store_ps(vsum + x + 12, s3);
-            }
-
-            for( ; x <= width*5 - 4; x += 4 )
+            // vertical blur
+            for( i = 0; i <= m; i++ )
             {
-                const float *sptr0 = srow[m], *sptr1;
-                __m128 g4 = _mm_load_ps(simd_kernel);
-                __m128 s0 = _mm_mul_ps(_mm_loadu_ps(sptr0 + x), g4);
-
-                for( i = 1; i <= m; i++ )
-                {
-                    sptr0 = srow[m+i], sptr1 = srow[m-i];
-                    g4 = _mm_load_ps(simd_kernel + i*4);
-                    __m128 x0 = _mm_add_ps(_mm_loadu_ps(sptr0 + x), _mm_loadu_ps(sptr1 + x));
-                    s0 = _mm_add_ps(s0, _mm_mul_ps(x0, g4));
-                }
-                _mm_store_ps(vsum + x, s0);
+                srow[m-i] = matM->ptr<float>(std::max(y-i,0));
+                srow[m+i] = matM->ptr<float>(std::min(y+i,height-1));
             }
-        }
-#elif CV_VSX
-        if( useSIMD )
-        {
+
+            x = 0;
+#if CV_SIMD128
             for( ; x <= width*5 - 16; x += 16 )
             {
                 const float *sptr0 = srow[m], *sptr1;
-                v_float32x4 g4 = v_load(simd_kernel);
+                v_float32x4 g4 = v_setall_f32(kernel[0]);
                 v_float32x4 s0, s1, s2, s3;
                 s0 = v_load(sptr0 + x) * g4;
                 s1 = v_load(sptr0 + x + 4) * g4;
@@ -533,7 +566,7 @@ FarnebackUpdateFlow_GaussianBlur( const Mat& _R0, const Mat& _R1,
                 {
                     v_float32x4 x0, x1;
                     sptr0 = srow[m+i], sptr1 = srow[m-i];
-                    g4 = v_load(simd_kernel + i*4);
+                    g4 = v_setall_f32(kernel[i]);
                     x0 = v_load(sptr0 + x) + v_load(sptr1 + x);
                     x1 = v_load(sptr0 + x + 4) + v_load(sptr1 + x + 4);
                     s0 = v_muladd(x0, g4, s0);
@@ -553,75 +586,48 @@ FarnebackUpdateFlow_GaussianBlur( const Mat& _R0, const Mat& _R1,
             for( ; x <= width*5 - 4; x += 4 )
             {
                 const float *sptr0 = srow[m], *sptr1;
-                v_float32x4 g4 = v_load(simd_kernel);
+                v_float32x4 g4 = v_setall_f32(kernel[0]);
                 v_float32x4 s0 = v_load(sptr0 + x) * g4;
 
                 for( i = 1; i <= m; i++ )
                 {
                     sptr0 = srow[m+i], sptr1 = srow[m-i];
-                    g4 = v_load(simd_kernel + i*4);
+                    g4 = v_setall_f32(kernel[i]);
                     v_float32x4 x0 = v_load(sptr0 + x) + v_load(sptr1 + x);
                     s0 = v_muladd(x0, g4, s0);
                 }
                 v_store(vsum + x, s0);
             }
-        }
 #endif
-        for( ; x < width*5; x++ )
-        {
-            float s0 = srow[m][x]*kernel[0];
-            for( i = 1; i <= m; i++ )
-                s0 += (srow[m+i][x] + srow[m-i][x])*kernel[i];
-            vsum[x] = s0;
-        }
-
-        // update borders
-        for( x = 0; x < m*5; x++ )
-        {
-            vsum[-1-x] = vsum[4-x];
-            vsum[width*5+x] = vsum[width*5+x-5];
-        }
-
-        // horizontal blur
-        x = 0;
-#if CV_SSE2
-        if( useSIMD )
-        {
-            for( ; x <= width*5 - 8; x += 8 )
+            for( ; x < width*5; x++ )
             {
-                __m128 g4 = _mm_load_ps(simd_kernel);
-                __m128 s0 = _mm_mul_ps(_mm_loadu_ps(vsum + x), g4);
-                __m128 s1 = _mm_mul_ps(_mm_loadu_ps(vsum + x + 4), g4);
-
+                float s0 = srow[m][x]*kernel[0];
                 for( i = 1; i <= m; i++ )
-                {
-                    g4 = _mm_load_ps(simd_kernel + i*4);
-                    __m128 x0 = _mm_add_ps(_mm_loadu_ps(vsum + x - i*5),
-                                           _mm_loadu_ps(vsum + x + i*5));
-                    __m128 x1 = _mm_add_ps(_mm_loadu_ps(vsum + x - i*5 + 4),
-                                           _mm_loadu_ps(vsum + x + i*5 + 4));
-                    s0 = _mm_add_ps(s0, _mm_mul_ps(x0, g4));
-                    s1 = _mm_add_ps(s1, _mm_mul_ps(x1, g4));
-                }
+                    s0 += (srow[m+i][x] + srow[m-i][x])*kernel[i];
+                vsum[x] = s0;
+            }
 
-                _mm_store_ps(hsum + x, s0);
-                _mm_store_ps(hsum + x + 4, s1);
+            // update borders
+            for( x = 0; x < m*5; x++ )
+            {
+                vsum[-1-x] = vsum[4-x];
+                vsum[width*5+x] = vsum[width*5+x-5];
             }
-        }
-#elif CV_VSX
-        if( useSIMD )
-        {
+
+            // horizontal blur
+            x = 0;
+#if CV_SIMD128
             for( ; x <= width*5 - 8; x += 8 )
             {
-                v_float32x4 g4 = v_load(simd_kernel);
+                v_float32x4 g4 = v_setall_f32(kernel[0]);
                 v_float32x4 s0 = v_load(vsum + x) * g4;
                 v_float32x4 s1 = v_load(vsum + x + 4) * g4;
 
                 for( i = 1; i <= m; i++ )
                 {
-                    g4 = v_load(simd_kernel + i*4);
-                    v_float32x4 x0 = v_load(vsum + x - i*5) + v_load(vsum + x+ i*5);
-                    v_float32x4 x1 = v_load(vsum + x - i*5 + 4) + v_load(vsum + x+ i*5 + 4);
+                    g4 = v_setall_f32(kernel[i]);
+                    v_float32x4 x0 = v_load(vsum + x - i*5) + v_load(vsum + x + i*5);
+                    v_float32x4 x1 = v_load(vsum + x - i*5 + 4) + v_load(vsum + x + i*5 + 4);
                     s0 = v_muladd(x0, g4, s0);
                     s1 = v_muladd(x1, g4, s1);
                 }
@@ -629,37 +635,66 @@ FarnebackUpdateFlow_GaussianBlur( const Mat& _R0, const Mat& _R1,
                 v_store(hsum + x, s0);
                 v_store(hsum + x + 4, s1);
             }
-        }
 #endif
-        for( ; x < width*5; x++ )
-        {
-            float sum = vsum[x]*kernel[0];
-            for( i = 1; i <= m; i++ )
-                sum += kernel[i]*(vsum[x - i*5] + vsum[x + i*5]);
-            hsum[x] = sum;
-        }
+            for( ; x < width*5; x++ )
+            {
+                float sum = vsum[x]*kernel[0];
+                for( i = 1; i <= m; i++ )
+                    sum += kernel[i]*(vsum[x - i*5] + vsum[x + i*5]);
+                hsum[x] = sum;
+            }
 
-        for( x = 0; x < width; x++ )
-        {
-            g11 = hsum[x*5];
-            g12 = hsum[x*5+1];
-            g22 = hsum[x*5+2];
-            h1 = hsum[x*5+3];
-            h2 = hsum[x*5+4];
+            for( x = 0; x < width; x++ )
+            {
+                g11 = hsum[x*5];
+                g12 = hsum[x*5+1];
+                g22 = hsum[x*5+2];
+                h1 = hsum[x*5+3];
+                h2 = hsum[x*5+4];
 
-            double idet = 1./(g11*g22 - g12*g12 + 1e-3);
+                double idet = 1./(g11*g22 - g12*g12 + 1e-3);
 
-            flow[x*2] = (float)((g11*h2-g12*h1)*idet);
-            flow[x*2+1] = (float)((g22*h1-g12*h2)*idet);
+                flow[x*2] = (float)((g11*h2-g12*h1)*idet);
+                flow[x*2+1] = (float)((g22*h1-g12*h2)*idet);
+            }
         }
+    }
 
-        y1 = y == height - 1 ? height : y - block_size;
-        if( update_matrices && (y1 == height || y1 >= y0 + min_update_stripe) )
-        {
-            FarnebackUpdateMatrices( _R0, _R1, _flow, matM, y0, y1 );
-            y0 = y1;
-        }
+private:
+    const Mat* matM;
+    Mat* flowmat;
+    int m;
+    const float* kernel;
+};
+
+static void
+FarnebackUpdateFlow_GaussianBlur( const Mat& _R0, const Mat& _R1,
+                                  Mat& _flow, Mat& matM, int block_size,
+                                  bool update_matrices )
+{
+    int i, m = block_size/2;
+    double sigma = m*0.3, s = 1;
+
+    AutoBuffer<float> _kernel(m+1);
+    float* kernel = _kernel.data();
+    kernel[0] = (float)s;
+
+    for( i = 1; i <= m; i++ )
+    {
+        float t = (float)std::exp(-i*i/(2*sigma*sigma) );
+        kernel[i] = t;
+        s += t*2;
     }
+
+    s = 1./s;
+    for( i = 0; i <= m; i++ )
+        kernel[i] = (float)(kernel[i]*s);
+
+    parallel_for_(Range(0, _flow.rows), FarnebackUpdateFlowGaussianInvoker(matM, _flow, m, kernel),
+                  _flow.total()/(1 << 14));
+
+    if( update_matrices )
+        FarnebackUpdateMatrices( _R0, _R1, _flow, matM, 0, _flow.rows );
 }
 
 }
@@ -674,7 +709,8 @@ public:
     FarnebackOpticalFlowImpl(int numLevels=5, double pyrScale=0.5, bool fastPyramids=false, int winSize=13,
                              int numIters=10, int polyN=5, double polySigma=1.1, int flags=0) :
         numLevels_(numLevels), pyrScale_(pyrScale), fastPyramids_(fastPyramids), winSize_(winSize),
-        numIters_(numIters), polyN_(polyN), polySigma_(polySigma), flags_(flags)
+        numIters_(numIters), polyN_(polyN), polySigma_(polySigma), flags_(flags),
+        reuseBuffers_(false), cachedPolyN_(0), cachedPolySigma_(0), cachedPyrScale_(0)
     {
     }
 
@@ -702,6 +738,14 @@ public:
     virtual int getFlags() const CV_OVERRIDE { return flags_; }
     virtual void setFlags(int flags) CV_OVERRIDE { flags_ = flags; }
 
+    virtual bool getReuseBuffers() const CV_OVERRIDE { return reuseBuffers_; }
+    virtual void setReuseBuffers(bool reuseBuffers) CV_OVERRIDE
+    {
+        reuseBuffers_ = reuseBuffers;
+        if( !reuseBuffers_ )
+            releaseCache();
+    }
+
     virtual void calc(InputArray I0, InputArray I1, InputOutputArray flow) CV_OVERRIDE;
 
 private:
@@ -713,6 +757,21 @@ private:
     int polyN_;
     double polySigma_;
     int flags_;
+    bool reuseBuffers_;
+
+    // polynomial expansions of the pyramid levels of the last "next" frame, used when the
+    // following call gets the same frame as "prev"
+    Mat cachedFrame_;
+    std::vector<Mat> cachedR_, nextR_;
+    int cachedPolyN_;
+    double cachedPolySigma_, cachedPyrScale_;
+
+    void releaseCache()
+    {
+        cachedFrame_.release();
+        cachedR_.clear();
+        nextR_.clear();
+    }
 
 #ifdef HAVE_OPENCL
     bool operator ()(const UMat &frame0, const UMat &frame1, UMat &flowx, UMat &flowy)
@@ -883,6 +942,7 @@ private:
     }
     virtual void collectGarbage() CV_OVERRIDE {
         releaseMemory();
+        releaseCache();
     }
     void releaseMemory()
     {
@@ -1170,7 +1230,7 @@ private:
         return true;
     }
 #else // HAVE_OPENCL
-    virtual void collectGarbage() CV_OVERRIDE {}
+    virtual void collectGarbage() CV_OVERRIDE { releaseCache(); }
 #endif
 };
 
@@ -1205,6 +1265,13 @@ void FarnebackOpticalFlowImpl::calc(InputArray _prev0, InputArray _next0,
 
     levels = k;
 
+    bool useCache = reuseBuffers_ && !cachedFrame_.empty() &&
+        cachedPolyN_ == polyN_ && cachedPolySigma_ == polySigma_ && cachedPyrScale_ == pyrScale_ &&
+        cachedFrame_.size() == prev0.size() && cachedFrame_.type() == prev0.type() &&
+        norm(cachedFrame_, prev0, NORM_INF) == 0;
+    if( reuseBuffers_ )
+        nextR_.resize(levels + 1);
+
     for( k = levels; k >= 0; k-- )
     {
         for( i = 0, scale = 1; i < k; i++ )
@@ -1239,8 +1306,16 @@ void FarnebackOpticalFlowImpl::calc(InputArray _prev0, InputArray _next0,
         }
 
         Mat R[2], I, M;
+        if( reuseBuffers_ )
+            R[1] = nextR_[k];
         for( i = 0; i < 2; i++ )
         {
+            if( i == 0 && useCache && k < (int)cachedR_.size() &&
+                cachedR_[k].size() == Size(width, height) )
+            {
+                R[0] = cachedR_[k];
+                continue;
+            }
             img[i]->convertTo(fimg, CV_32F);
             GaussianBlur(fimg, fimg, Size(smooth_sz, smooth_sz), sigma, sigma);
             resize( fimg, I, Size(width, height), INTER_LINEAR );
@@ -1258,6 +1333,18 @@ void FarnebackOpticalFlowImpl::calc(InputArray _prev0, InputArray _next0,
         }
 
         prevFlow = flow;
+        if( reuseBuffers_ )
+            nextR_[k] = R[1];
+    }
+
+    if( reuseBuffers_ )
+    {
+        // the expansions of the current "prev" frame become the buffers for the next "next" one
+        std::swap(cachedR_, nextR_);
+        next0.copyTo(cachedFrame_);
+        cachedPolyN_ = polyN_;
+        cachedPolySigma_ = polySigma_;
+        cachedPyrScale_ = pyrScale_;
     }
 }
 } // namespace
@@ -0,0 +1,135 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+// noisy static texture with a bright square moving over it
+static void makeBgfgSequence(Size sz, int type, int nframes, int seed, std::vector<Mat>& frames)
+{
+    RNG rng(seed);
+    Mat background(sz, CV_MAKETYPE(CV_8U, CV_MAT_CN(type)));
+    rng.fill(background, RNG::UNIFORM, 40, 200);
+    GaussianBlur(background, background, Size(5, 5), 1.5);
+
+    frames.resize(nframes);
+    for (int i = 0; i < nframes; i++)
+    {
+        Mat noise(sz, CV_MAKETYPE(CV_16S, CV_MAT_CN(type)));
+        rng.fill(noise, RNG::NORMAL, 0, 2);
+        Mat frame;
+        cv::add(background, noise, frame, noArray(), background.type());
+        Rect square(i * 3 % (sz.width - 20), sz.height / 3, 20, 20);
+        frame(square).setTo(Scalar::all(250));
+        frame.convertTo(frames[i], type);
+    }
+}
+
+static Ptr<BackgroundSubtractor> createSubtractor(const std::string& name)
+{
+    if (name == "MOG2")
+        return createBackgroundSubtractorMOG2();
+    return createBackgroundSubtractorKNN();
+}
+
+typedef testing::TestWithParam<std::string> Video_BackgroundSubtractorBatch;
+
+TEST_P(Video_BackgroundSubtractorBatch, equals_sequential_apply)
+{
+    const int nstreams = 4, nsteps = 12;
+    const Size sizes[nstreams] = { Size(64, 48), Size(160, 120), Size(160, 120), Size(97, 31) };
+    const int types[nstreams] = { CV_8UC1, CV_8UC3, CV_8UC1, CV_8UC3 };
+
+    std::vector<std::vector<Mat> > sequences(nstreams);
+    for (int s = 0; s < nstreams; s++)
+        makeBgfgSequence(sizes[s], types[s], nsteps + 1, s, sequences[s]);
+
+    std::vector<Ptr<BackgroundSubtractor> > batch(nstreams), sequential(nstreams);
+    std::vector<Mat> frames;
+    for (int s = 0; s < nstreams; s++)
+    {
+        batch[s] = createSubtractor(GetParam());
+        sequential[s] = createSubtractor(GetParam());
+
+        // the models are initialized from the first frame, which also consumes the random numbers of KNN
+        Mat mask;
+        batch[s]->apply(sequences[s][0], mask);
+        sequential[s]->apply(sequences[s][0], mask);
+    }
+    for (int t = 1; t <= nsteps; t++)
+        for (int s = 0; s < nstreams; s++)
+            frames.push_back(sequences[s][t]);
+
+    uint64 state = theRNG().state;
+    std::vector<Mat> masks;
+    applyBackgroundSubtractors(batch, frames, masks);
+    ASSERT_EQ(frames.size(), masks.size());
+
+    theRNG().state = state;
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        Mat mask;
+        sequential[i % nstreams]->apply(frames[i], mask);
+        EXPECT_EQ(0, cvtest::norm(mask, masks[i], NORM_INF)) << "frame " << i;
+    }
+
+    for (int s = 0; s < nstreams; s++)
+    {
+        Mat bg1, bg2;
+        batch[s]->getBackgroundImage(bg1);
+        sequential[s]->getBackgroundImage(bg2);
+        EXPECT_EQ(0, cvtest::norm(bg1, bg2, NORM_INF)) << "stream " << s;
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Video_BackgroundSubtractorBatch, testing::Values("MOG2", "KNN"));
+
+TEST(Video_BackgroundSubtractorMOG2, compact_model)
+{
+    std::vector<Mat> frames;
+    makeBgfgSequence(Size(160, 120), CV_8UC3, 40, 0, frames);
+
+    Ptr<BackgroundSubtractorMOG2> full = createBackgroundSubtractorMOG2();
+    Ptr<BackgroundSubtractorMOG2> compact = createBackgroundSubtractorMOG2();
+    compact->setCompactModel(true);
+    EXPECT_TRUE(compact->getCompactModel());
+
+    Mat mask1, mask2;
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        full->apply(frames[i], mask1);
+        compact->apply(frames[i], mask2);
+    }
+    EXPECT_LE(cvtest::norm(mask1, mask2, NORM_L1) / 255, mask1.total() * 0.01);
+
+    // the square is found in the last frame
+    Mat square = mask2(Rect(39 * 3 % 140 + 2, 42, 16, 16));
+    EXPECT_EQ(square.total(), (size_t)countNonZero(square));
+
+    Mat bg1, bg2;
+    full->getBackgroundImage(bg1);
+    compact->getBackgroundImage(bg2);
+    EXPECT_LE(cvtest::norm(bg1, bg2, NORM_INF), 2);
+}
+
+TEST(Video_BackgroundSubtractorMOG2, compact_model_ignores_float_frames)
+{
+    std::vector<Mat> frames;
+    makeBgfgSequence(Size(64, 48), CV_32FC1, 10, 0, frames);
+
+    Ptr<BackgroundSubtractorMOG2> full = createBackgroundSubtractorMOG2();
+    Ptr<BackgroundSubtractorMOG2> compact = createBackgroundSubtractorMOG2();
+    compact->setCompactModel(true);
+
+    Mat mask1, mask2;
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        full->apply(frames[i], mask1);
+        compact->apply(frames[i], mask2);
+        EXPECT_EQ(0, cvtest::norm(mask1, mask2, NORM_INF));
+    }
+}
+
+}} // namespace
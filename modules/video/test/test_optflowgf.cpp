@@ -0,0 +1,102 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "test_precomp.hpp"
+
+namespace opencv_test { namespace {
+
+// smooth random texture shifted by (i*dx, i*dy) in the frame i
+static void makeShiftedFrames(const Size& sz, int nframes, double dx, double dy, std::vector<Mat>& frames)
+{
+    RNG rng(12345);
+    Mat noise(sz.height + 64, sz.width + 64, CV_32F), texture;
+    rng.fill(noise, RNG::UNIFORM, 0, 255);
+    GaussianBlur(noise, texture, Size(0, 0), 2.);
+    normalize(texture, texture, 0, 255, NORM_MINMAX);
+
+    frames.resize(nframes);
+    for (int i = 0; i < nframes; i++)
+    {
+        Matx23d A(1, 0, 32 - i*dx, 0, 1, 32 - i*dy);
+        warpAffine(texture, frames[i], A, sz, INTER_LINEAR | WARP_INVERSE_MAP);
+        frames[i].convertTo(frames[i], CV_8U);
+    }
+}
+
+typedef testing::TestWithParam<int> Video_OpticalFlowFarneback;
+
+TEST_P(Video_OpticalFlowFarneback, synthetic_shift)
+{
+    const int flags = GetParam();
+    const double dx = 3.25, dy = -1.5;
+    std::vector<Mat> frames;
+    makeShiftedFrames(Size(320, 240), 2, dx, dy, frames);
+
+    Mat flow;
+    calcOpticalFlowFarneback(frames[0], frames[1], flow, 0.5, 3, 15, 3, 5, 1.2, flags);
+    ASSERT_EQ(CV_32FC2, flow.type());
+    ASSERT_EQ(frames[0].size(), flow.size());
+
+    // the flow (x, y) -> (x + dx, y + dy) is estimated away from the borders
+    Mat inner = flow(Rect(32, 32, flow.cols - 64, flow.rows - 64));
+    Scalar mean_flow = mean(inner);
+    EXPECT_NEAR(dx, mean_flow[0], 0.05);
+    EXPECT_NEAR(dy, mean_flow[1], 0.05);
+    Mat expected(inner.size(), CV_32FC2, Scalar(dx, dy));
+    EXPECT_LE(cvtest::norm(inner, expected, NORM_L1)/inner.total(), 0.2);
+}
+
+TEST_P(Video_OpticalFlowFarneback, threads_do_not_change_result)
+{
+    const int flags = GetParam();
+    std::vector<Mat> frames;
+    makeShiftedFrames(Size(320, 240), 2, 1.75, 2.5, frames);
+
+    Mat flow, flow_st;
+    calcOpticalFlowFarneback(frames[0], frames[1], flow, 0.5, 3, 15, 3, 5, 1.2, flags);
+
+    int nthreads = getNumThreads();
+    setNumThreads(1);
+    calcOpticalFlowFarneback(frames[0], frames[1], flow_st, 0.5, 3, 15, 3, 5, 1.2, flags);
+    setNumThreads(nthreads);
+
+    EXPECT_EQ(0, cvtest::norm(flow, flow_st, NORM_INF));
+}
+
+TEST_P(Video_OpticalFlowFarneback, reuse_buffers)
+{
+    const int flags = GetParam();
+    std::vector<Mat> frames;
+    makeShiftedFrames(Size(320, 240), 4, 2., -1., frames);
+
+    Ptr<FarnebackOpticalFlow> fb = FarnebackOpticalFlow::create(3, 0.5, false, 15, 3, 5, 1.2, flags);
+    Ptr<FarnebackOpticalFlow> fb_reuse = FarnebackOpticalFlow::create(3, 0.5, false, 15, 3, 5, 1.2, flags);
+    EXPECT_FALSE(fb_reuse->getReuseBuffers());
+    fb_reuse->setReuseBuffers(true);
+    EXPECT_TRUE(fb_reuse->getReuseBuffers());
+
+    for (size_t i = 0; i + 1 < frames.size(); i++)
+    {
+        Mat flow, flow_reuse;
+        fb->calc(frames[i], frames[i + 1], flow);
+        fb_reuse->calc(frames[i], frames[i + 1], flow_reuse);
+        EXPECT_EQ(0, cvtest::norm(flow, flow_reuse, NORM_INF)) << "frame " << i;
+    }
+
+    // a frame which does not continue the sequence and a parameter change invalidate the buffers
+    Mat flow, flow_reuse;
+    fb->calc(frames[0], frames[2], flow);
+    fb_reuse->calc(frames[0], frames[2], flow_reuse);
+    EXPECT_EQ(0, cvtest::norm(flow, flow_reuse, NORM_INF));
+
+    fb->setPolySigma(1.1);
+    fb_reuse->setPolySigma(1.1);
+    fb->calc(frames[2], frames[3], flow);
+    fb_reuse->calc(frames[2], frames[3], flow_reuse);
+    EXPECT_EQ(0, cvtest::norm(flow, flow_reuse, NORM_INF));
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Video_OpticalFlowFarneback, testing::Values(0, (int)OPTFLOW_FARNEBACK_GAUSSIAN));
+
+}} // namespace
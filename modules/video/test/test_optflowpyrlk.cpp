@@ -259,4 +259,154 @@ TEST(Video_OpticalFlowPyrLK, submat)
     ASSERT_NO_THROW(cv::calcOpticalFlowPyrLK(img1, img2, prev, next, status, error));
 }
 
+// smooth random texture rotated and shifted more in every next frame, motion[i] maps the frame i to the texture
+static void makeMovingTexture(int nframes, std::vector<Mat>& frames, std::vector<Point2f>& pts,
+                              std::vector<Matx23d>& motion)
+{
+    RNG rng(4321);
+    Mat noise(420, 680, CV_32F), texture;
+    rng.fill(noise, RNG::UNIFORM, 0, 255);
+    GaussianBlur(noise, texture, Size(0, 0), 2.5);
+    normalize(texture, texture, 0, 255, NORM_MINMAX);
+
+    frames.resize(nframes);
+    motion.resize(nframes);
+    for (int i = 0; i < nframes; i++)
+    {
+        Matx23d A = getRotationMatrix2D(Point2f(320, 180), 0.3*i, 1.0);
+        A(0, 2) += 4.3*i + 20; A(1, 2) += -3.1*i + 20;
+        motion[i] = A;
+        warpAffine(texture, frames[i], A, Size(640, 360), INTER_LINEAR | WARP_INVERSE_MAP);
+        frames[i].convertTo(frames[i], CV_8U);
+    }
+
+    pts.clear();
+    for (int y = 30; y < 330; y += 20)
+        for (int x = 30; x < 610; x += 20)
+            pts.push_back(Point2f((float)x, (float)y));
+}
+
+// maps a point of the frame i to the frame j
+static Point2f transferPoint(const std::vector<Matx23d>& motion, int i, int j, const Point2f& pt)
+{
+    Matx33d Ai = Matx33d::eye(), Aj = Matx33d::eye();
+    for (int k = 0; k < 6; k++)
+    {
+        Ai(k / 3, k % 3) = motion[i](k / 3, k % 3);
+        Aj(k / 3, k % 3) = motion[j](k / 3, k % 3);
+    }
+    Vec3d p = Aj.inv() * Ai * Vec3d(pt.x, pt.y, 1);
+    return Point2f((float)p[0], (float)p[1]);
+}
+
+TEST(Video_OpticalFlowPyrLK, reuse_buffers)
+{
+    std::vector<Mat> frames;
+    std::vector<Point2f> pts;
+    std::vector<Matx23d> motion;
+    makeMovingTexture(4, frames, pts, motion);
+
+    Ptr<SparsePyrLKOpticalFlow> lk = SparsePyrLKOpticalFlow::create();
+    Ptr<SparsePyrLKOpticalFlow> lk_reuse = SparsePyrLKOpticalFlow::create();
+    EXPECT_FALSE(lk_reuse->getReuseBuffers());
+    lk_reuse->setReuseBuffers(true);
+    EXPECT_TRUE(lk_reuse->getReuseBuffers());
+
+    // the last pair does not continue the sequence
+    const int pairs[][2] = { {0, 1}, {1, 2}, {2, 3}, {0, 2} };
+    for (size_t i = 0; i < sizeof(pairs)/sizeof(pairs[0]); i++)
+    {
+        const Mat &prev = frames[pairs[i][0]], &next = frames[pairs[i][1]];
+        std::vector<Point2f> next_pts, next_pts_reuse;
+        std::vector<uchar> status, status_reuse;
+        std::vector<float> err, err_reuse;
+        lk->calc(prev, next, pts, next_pts, status, err);
+        lk_reuse->calc(prev, next, pts, next_pts_reuse, status_reuse, err_reuse);
+
+        ASSERT_EQ(next_pts.size(), next_pts_reuse.size());
+        EXPECT_EQ(0, cvtest::norm(Mat(next_pts), Mat(next_pts_reuse), NORM_INF)) << "pair " << i;
+        EXPECT_EQ(0, cvtest::norm(Mat(status), Mat(status_reuse), NORM_INF)) << "pair " << i;
+        EXPECT_EQ(0, cvtest::norm(Mat(err), Mat(err_reuse), NORM_INF)) << "pair " << i;
+    }
+}
+
+TEST(Video_OpticalFlowPyrLK, repeated_calls)
+{
+    std::vector<Mat> frames;
+    std::vector<Point2f> pts;
+    std::vector<Matx23d> motion;
+    makeMovingTexture(2, frames, pts, motion);
+
+    // the object does not change its parameters in calc()
+    Ptr<SparsePyrLKOpticalFlow> lk = SparsePyrLKOpticalFlow::create();
+    std::vector<Point2f> next_pts, next_pts2, next_pts_fn;
+    std::vector<uchar> status;
+    lk->calc(frames[0], frames[1], pts, next_pts, status);
+    lk->calc(frames[0], frames[1], pts, next_pts2, status);
+    calcOpticalFlowPyrLK(frames[0], frames[1], pts, next_pts_fn, status, noArray());
+
+    EXPECT_EQ(0.01, lk->getTermCriteria().epsilon);
+    EXPECT_EQ(0, cvtest::norm(Mat(next_pts), Mat(next_pts2), NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(Mat(next_pts), Mat(next_pts_fn), NORM_INF));
+}
+
+TEST(Video_OpticalFlowPyrLK, early_exit_accuracy)
+{
+    std::vector<Mat> frames;
+    std::vector<Point2f> pts;
+    std::vector<Matx23d> motion;
+    makeMovingTexture(2, frames, pts, motion);
+
+    for (int flags = 0; flags <= OPTFLOW_LK_EARLY_EXIT; flags += OPTFLOW_LK_EARLY_EXIT)
+    {
+        std::vector<Point2f> next_pts;
+        std::vector<uchar> status;
+        calcOpticalFlowPyrLK(frames[0], frames[1], pts, next_pts, status, noArray(), Size(21, 21), 3,
+                             TermCriteria(TermCriteria::COUNT + TermCriteria::EPS, 30, 0.01), flags);
+
+        int found = 0;
+        double sum_err = 0;
+        for (size_t i = 0; i < pts.size(); i++)
+        {
+            if (!status[i])
+                continue;
+            found++;
+            Point2f d = next_pts[i] - transferPoint(motion, 0, 1, pts[i]);
+            sum_err += std::sqrt(d.dot(d));
+        }
+        EXPECT_GE(found, (int)pts.size()*9/10) << "flags " << flags;
+        EXPECT_LE(sum_err / found, 0.05) << "flags " << flags;
+    }
+}
+
+TEST(Video_OpticalFlowPyrLK, window_width_tails)
+{
+    std::vector<Mat> frames;
+    std::vector<Point2f> pts;
+    std::vector<Matx23d> motion;
+    makeMovingTexture(2, frames, pts, motion);
+
+    // the window rows end with every combination of the 8 and 4 pixel SIMD blocks and the scalar pixels,
+    // their float sums are not bit-exact with the scalar code, the tracked points are as accurate
+    for (int width = 13; width <= 21; width++)
+    {
+        std::vector<Point2f> next_pts;
+        std::vector<uchar> status;
+        calcOpticalFlowPyrLK(frames[0], frames[1], pts, next_pts, status, noArray(), Size(width, 21), 3);
+
+        int found = 0;
+        double sum_err = 0;
+        for (size_t i = 0; i < pts.size(); i++)
+        {
+            if (!status[i])
+                continue;
+            found++;
+            Point2f d = next_pts[i] - transferPoint(motion, 0, 1, pts[i]);
+            sum_err += std::sqrt(d.dot(d));
+        }
+        EXPECT_GE(found, (int)pts.size()*9/10) << "width " << width;
+        EXPECT_LE(sum_err / found, 0.05) << "width " << width;
+    }
+}
+
 }} // namespace